@@ -2,9 +2,9 @@
 
 precision mediump float;
 
-uniform vec4 u_color;
+in vec4 r_color;
 out vec4 o_color;
 
 void main() {
-    o_color = (u_color / 255.0);
+    o_color = (r_color / 255.0);
 }
\ No newline at end of file
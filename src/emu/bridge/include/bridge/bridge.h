@@ -48,6 +48,22 @@ namespace eka2l1 {
             (*export_fn)(data, read<args, indices, args...>(cpu, layout, pr)...);
         }
 
+        template <auto export_fn>
+        struct bridge_entry;
+
+        /*! \brief Bridge a HLE function to guest, as a plain function pointer.
+         *
+         * The function is a template argument, so nothing has to be captured and
+         * &bridge_entry<&fn>::invoke can be stored without a std::function.
+        */
+        template <typename T, typename ret, typename... args, ret (*export_fn)(T *, args...)>
+        struct bridge_entry<export_fn> {
+            static void invoke(T *data, kernel::process *pr, arm::core *cpu) {
+                constexpr args_layout<args...> layouts = lay_out<typename bridge_type<args>::arm_type...>();
+                call(export_fn, layouts, std::index_sequence_for<args...>(), cpu, pr, data);
+            }
+        };
+
         /*! \brief Bridge a HLE function to guest (ARM - Symbian). */
         template <typename T, typename ret, typename... args>
         auto bridge(ret (*export_fn)(T *, args...)) {
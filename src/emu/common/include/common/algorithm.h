@@ -367,6 +367,11 @@ namespace eka2l1 {
          */
         int count_leading_zero(const std::uint32_t v);
 
+        /**
+         * \brief Count the number of trailing zero bits.
+         */
+        int count_trailing_zero(const std::uint32_t v);
+
         /**
          * \brief Get the most significant set bit.
          */
@@ -23,9 +23,11 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace eka2l1::common {
@@ -57,19 +59,88 @@ namespace eka2l1::common {
         }
     };
 
-    class block_allocator : public space_based_allocator {
+    /**
+     * \brief Two-level segregated fit (TLSF) allocator.
+     *
+     * Free blocks are put in lists by size class: the first level is the power of two of the size,
+     * the second level splits that range linearly. A bitmap for each level makes finding a fitting
+     * list a few bit scans, so allocating and freeing are done in constant time. Freed blocks are merged
+     * with their free neighbours.
+     *
+     * Block bookkeeping is kept outside of the managed space, since that space may be written by guest.
+     */
+    class tlsf_allocator : public space_based_allocator {
+    public:
+        static constexpr std::size_t ALIGNMENT_LOG2 = 3;
+        static constexpr std::size_t ALIGNMENT = 1 << ALIGNMENT_LOG2;
+
+        struct statistics {
+            std::size_t total_size_;
+            std::size_t used_size_;
+            std::size_t free_size_;
+            std::size_t largest_free_block_;
+            std::size_t used_block_count_;
+            std::size_t free_block_count_;
+
+            /**
+             * \brief Get how much the free space is split up.
+             *
+             * \returns 0 when all free space is in one block, closer to 1 the more it is split.
+             */
+            double fragmentation() const;
+        };
+
+    private:
+        static constexpr std::uint32_t SL_INDEX_COUNT_LOG2 = 4;
+        static constexpr std::uint32_t SL_INDEX_COUNT = 1 << SL_INDEX_COUNT_LOG2;
+        static constexpr std::uint32_t FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + ALIGNMENT_LOG2;
+        static constexpr std::uint32_t FL_INDEX_COUNT = 32 - FL_INDEX_SHIFT + 1;
+        static constexpr std::size_t SMALL_BLOCK_SIZE = 1 << FL_INDEX_SHIFT;
+        static constexpr std::size_t MAX_ALLOCATION_SIZE = 1U << 31;
+        static constexpr std::uint32_t INVALID_BLOCK = 0xFFFFFFFF;
+
         struct block_info {
-            std::uint64_t offset;
-            std::size_t size;
+            std::size_t offset_;
+            std::size_t size_;
 
-            bool active{ false };
+            std::uint32_t prev_phys_;
+            std::uint32_t next_phys_;
+            std::uint32_t prev_free_;
+            std::uint32_t next_free_;
+
+            bool free_;
         };
 
-        std::vector<block_info> blocks;
-        std::mutex lock;
+        std::vector<block_info> blocks_;
+        std::vector<std::uint32_t> unused_infos_;
+        std::unordered_map<std::size_t, std::uint32_t> used_blocks_;
+
+        std::uint32_t fl_bitmap_;
+        std::array<std::uint32_t, FL_INDEX_COUNT> sl_bitmaps_;
+        std::array<std::array<std::uint32_t, SL_INDEX_COUNT>, FL_INDEX_COUNT> free_heads_;
+
+        std::uint32_t last_block_;
+        std::size_t used_size_;
+        std::size_t free_block_count_;
+
+        std::mutex lock_;
+
+        static void mapping_insert(const std::size_t size, std::uint32_t &fl, std::uint32_t &sl);
+
+        std::uint32_t new_block_info();
+        void release_block_info(const std::uint32_t idx);
+
+        void insert_free_block(const std::uint32_t idx);
+        void remove_free_block(const std::uint32_t idx);
+        std::uint32_t find_free_block(std::size_t size);
+
+        void split_block(const std::uint32_t idx, const std::size_t size);
+        void absorb_next_block(const std::uint32_t idx);
+        std::uint32_t fit_last_block(const std::size_t size);
+        bool grow(const std::size_t size);
 
     public:
-        explicit block_allocator(std::uint8_t *sptr, const std::size_t initial_max_size);
+        explicit tlsf_allocator(std::uint8_t *sptr, const std::size_t initial_max_size);
 
         void *allocate(std::size_t bytes) override;
         bool free(const void *ptr) override;
@@ -77,6 +148,8 @@ namespace eka2l1::common {
         virtual bool expand(std::size_t target) override {
             return false;
         }
+
+        statistics get_statistics();
     };
 
     struct bitmap_allocator {
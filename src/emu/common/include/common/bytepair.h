@@ -45,6 +45,24 @@ namespace eka2l1 {
             BYTEPAIR_PAGE_SIZE = 4096
         };
 
+        /*! \brief Decompress a run of bytepair pages.
+         *
+         * Each page is compressed on its own, so when there are enough of them the work is spread
+         * on a pool of worker threads, which stays alive between calls. Page N is written to
+         * dest + N * BYTEPAIR_PAGE_SIZE.
+         *
+         * \param dest         The destination to write decompressed data to.
+         * \param dest_size    The size of the destination buffer.
+         * \param compressed   The compressed pages, laid out back to back.
+         * \param page_sizes   Compressed size of each page.
+         * \param max_threads  Maximum number of threads to use, counting the caller. 0 to decide
+         *                     from the hardware concurrency.
+         *
+         * \returns Total number of bytes decompressed.
+         */
+        uint32_t bytepair_decompress_pages(char *dest, size_t dest_size, const std::uint8_t *compressed,
+            const std::vector<uint16_t> &page_sizes, const std::uint32_t max_threads = 0);
+
         /*! \brief A read-only bytepair stream. */
         class ibytepair_stream {
             common::ro_stream *compress_stream;
@@ -97,11 +115,61 @@ namespace eka2l1 {
 			 *
 			 *  \param dest The destination to write decompressed data to 
 			 *  \param size The destination size 
+			 *  \param max_threads Maximum number of threads to decompress with. 0 to decide automatically.
 			*/
-            uint32_t read_pages(char *dest, size_t size);
+            uint32_t read_pages(char *dest, size_t size, const std::uint32_t max_threads = 0);
+
+            /*! \brief Read the index table and all compressed pages that follows it, without decompressing.
+             *
+             *  \param compressed Vector to store the compressed pages in.
+             *  \returns False if the stream ended before all pages could be read.
+             */
+            bool read_compressed_pages(std::vector<std::uint8_t> &compressed);
 
             /*! \brief Get all the pages's offsets */
             std::vector<uint32_t> page_offsets(uint32_t initial_off);
         };
+
+        /*! \brief Compressed bytepair pages kept around, so any range can be decompressed later.
+         *
+         * Used to decompress code pages only when the guest first touches them. The store never changes
+         * after loading, so decompressing from multiple threads at once is fine.
+         */
+        class bytepair_page_store {
+            std::vector<std::uint8_t> compressed_;
+            std::vector<std::size_t> offsets_;
+            std::vector<uint16_t> page_sizes_;
+
+            std::size_t decompressed_size_;
+
+        public:
+            bytepair_page_store();
+
+            /*! \brief Load the index table and the compressed pages of the next bytepair section of a stream.
+             *
+             *  \param stream            The stream to read from.
+             *  \param decompressed_size The size of the section once decompressed.
+             *
+             *  \returns False if the section could not be read.
+             */
+            bool load(ibytepair_stream &stream, const std::size_t decompressed_size);
+
+            /*! \brief Decompress all pages overlapping a range.
+             *
+             *  Page N is written to dest + N * BYTEPAIR_PAGE_SIZE, so dest is the start of the whole section,
+             *  not of the range.
+             *
+             *  \param dest   The section's destination buffer.
+             *  \param offset Offset of the range in the section.
+             *  \param size   Size of the range.
+             *
+             *  \returns False if a page is corrupted.
+             */
+            bool decompress(char *dest, const std::size_t offset, const std::size_t size) const;
+
+            std::size_t decompressed_size() const {
+                return decompressed_size_;
+            }
+        };
     }
 }
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace eka2l1::common {
+    /**
+     * \brief Pixel layouts of Symbian display modes.
+     *
+     * Pixels smaller than a byte are packed starting from the lowest bit. Multi-byte pixels
+     * are little-endian.
+     */
+    enum class pixel_format {
+        gray2, ///< 1 bpp, black or white.
+        gray4, ///< 2 bpp, four grayscales.
+        gray16, ///< 4 bpp, 16 grayscales.
+        gray256, ///< 8 bpp, 256 grayscales.
+        color16, ///< 4 bpp, indexed into a 16 colours palette.
+        color256, ///< 8 bpp, indexed into a 256 colours palette.
+        color4k, ///< 12 bpp stored in 16 bits, 0x0RGB.
+        color64k, ///< 16 bpp, RGB565.
+        color16m, ///< 24 bpp, bytes in B, G, R order.
+        color16mu, ///< 32 bpp, 0xXXRRGGBB. Top byte is unused.
+        color16ma, ///< 32 bpp, 0xAARRGGBB.
+        color16map ///< 32 bpp, 0xAARRGGBB with colour premultiplied by alpha.
+    };
+
+    /**
+     * \brief Get the number of bits a pixel of the given format occupies.
+     *
+     * This is the storage size, so color4k pixels count as 16 bits.
+     */
+    std::uint32_t get_pixel_format_bpp(const pixel_format format);
+
+    /**
+     * \brief Convert a row of pixels to 32-bit ARGB words (0xAARRGGBB, same as the color16ma layout).
+     *
+     * Opaque formats get an alpha of 0xFF.
+     *
+     * \param format        The format of the source pixels.
+     * \param source        Pointer to the source row.
+     * \param dest          Pointer to the destination row. Must hold pixel_count words.
+     * \param pixel_count   Number of pixels to convert.
+     * \param palette       For color16 and color256, the palette with entries in 0xAARRGGBB. Unused otherwise.
+     * \param premultiplied True to produce colours premultiplied by alpha, false for straight alpha.
+     */
+    void convert_row_to_argb8888(const pixel_format format, const std::uint8_t *source, std::uint32_t *dest,
+        const std::size_t pixel_count, const std::uint32_t *palette = nullptr, const bool premultiplied = false);
+
+    /**
+     * \brief Convert a 2D block of pixels to 32-bit ARGB words.
+     *
+     * \param source_stride Number of bytes between two source rows.
+     * \param dest_stride   Number of pixels between two destination rows.
+     *
+     * \see convert_row_to_argb8888
+     */
+    void convert_to_argb8888(const pixel_format format, const std::uint8_t *source, const std::size_t source_stride,
+        std::uint32_t *dest, const std::size_t dest_stride, const std::size_t width, const std::size_t height,
+        const std::uint32_t *palette = nullptr, const bool premultiplied = false);
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <common/configure.h>
+
+#include <cstdint>
+#include <string>
+
+#if ENABLE_PROFILING
+#include <microprofile.h>
+
+/**
+ * \brief Time the rest of the enclosing scope.
+ *
+ * Group and name must be string literals. The timer is registered the first time the scope runs.
+ */
+#define EKA2L1_PROFILE_SCOPE(group, name, color) MICROPROFILE_SCOPEI(group, name, color)
+#else
+#define EKA2L1_PROFILE_SCOPE(group, name, color)
+#endif
+
+namespace eka2l1::common {
+    using profile_token = std::uint64_t;
+
+    /**
+     * \brief Register a timer which name is only known at runtime.
+     *
+     * \returns Token to use with profile_scope. Always 0 when profiling is compiled out.
+     */
+    profile_token get_profile_token(const char *group, const std::string &name, const std::uint32_t color);
+
+    /**
+     * \brief Time a scope with a timer registered by get_profile_token.
+     */
+    struct profile_scope {
+#if ENABLE_PROFILING
+        profile_token token_;
+        std::uint64_t start_tick_;
+
+        explicit profile_scope(const profile_token token)
+            : token_(token)
+            , start_tick_(MicroProfileEnter(token)) {
+        }
+
+        ~profile_scope() {
+            MicroProfileLeave(token_, start_tick_);
+        }
+#else
+        explicit profile_scope(const profile_token token) {
+        }
+#endif
+    };
+
+    /**
+     * \brief Start recording every profile group.
+     *
+     * When profiling is compiled in, the live view is also served on the microprofile port (1338 by default).
+     */
+    void init_profiler();
+
+    /**
+     * \brief Shut down the profiler. Nothing can be recorded after this.
+     */
+    void shutdown_profiler();
+
+    /**
+     * \brief Name the caller thread in the timeline.
+     */
+    void profiler_register_thread(const char *name);
+
+    /**
+     * \brief Mark the end of a frame. Call once per frame from a single thread.
+     */
+    void profiler_flip();
+
+    /**
+     * \brief Check if the profiler is compiled in.
+     */
+    bool is_profiler_available();
+
+    /**
+     * \brief Write the recorded timeline to disk.
+     *
+     * \param html_path Path of the HTML capture, which can be opened in a browser.
+     * \param csv_path  Path of a CSV summary. Can be empty.
+     *
+     * \returns False if the profiler is compiled out.
+     */
+    bool dump_profiler_capture(const std::string &html_path, const std::string &csv_path = "");
+}
@@ -3,6 +3,9 @@
 #include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <queue>
@@ -188,6 +191,24 @@ namespace eka2l1 {
             queue_empty_cond_.notify_one();
         }
 
+        void push(T &&item) {
+            {
+                std::unique_lock<std::mutex> ulock(queue_mut_);
+
+                while (!abort_ && queue_.size() == max_pending_count_) {
+                    queue_cond_.wait(ulock);
+                }
+
+                if (abort_) {
+                    return;
+                }
+
+                queue_.push(std::move(item));
+            }
+
+            queue_empty_cond_.notify_one();
+        }
+
         std::optional<T> pop(const int ms = 0) {
             T item{ T() };
 
@@ -208,7 +229,7 @@ namespace eka2l1 {
                     return std::nullopt;
                 }
 
-                item = queue_.front();
+                item = std::move(queue_.front());
                 queue_.pop();
             }
 
@@ -227,4 +248,109 @@ namespace eka2l1 {
             abort_ = false;
         }
     };
+
+    /**
+     * \brief A bounded queue that producers and consumers can use at the same time without locking.
+     *
+     * Each slot carries a sequence number, telling whether it is ready to be written or read in the
+     * current lap around the buffer. Pushing to a full buffer fails instead of waiting.
+     *
+     * \tparam CAPACITY Number of slots. Must be a power of two.
+     */
+    template <typename T, std::size_t CAPACITY>
+    class lockfree_ring_buffer {
+        static_assert((CAPACITY >= 2) && ((CAPACITY & (CAPACITY - 1)) == 0), "Capacity must be a power of two");
+
+        struct slot {
+            std::atomic<std::size_t> sequence_;
+            T data_;
+        };
+
+        std::unique_ptr<slot[]> slots_;
+
+        // Keep the two ends on different cache lines, producers and the consumer touch them separately
+        alignas(64) std::atomic<std::size_t> push_pos_;
+        alignas(64) std::atomic<std::size_t> pop_pos_;
+
+    public:
+        explicit lockfree_ring_buffer()
+            : slots_(new slot[CAPACITY])
+            , push_pos_(0)
+            , pop_pos_(0) {
+            for (std::size_t i = 0; i < CAPACITY; i++) {
+                slots_[i].sequence_.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * \brief Push a value to the back of the buffer.
+         * \returns False if the buffer is full.
+         */
+        bool push(const T &val) {
+            std::size_t pos = push_pos_.load(std::memory_order_relaxed);
+
+            while (true) {
+                slot &target = slots_[pos & (CAPACITY - 1)];
+                const std::size_t sequence = target.sequence_.load(std::memory_order_acquire);
+                const std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+
+                if (diff == 0) {
+                    if (push_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        target.data_ = val;
+                        target.sequence_.store(pos + 1, std::memory_order_release);
+
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    // The slot from the last lap has not been read yet
+                    return false;
+                } else {
+                    pos = push_pos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * \brief Pop a value from the front of the buffer.
+         * \returns False if the buffer is empty.
+         */
+        bool pop(T &val) {
+            std::size_t pos = pop_pos_.load(std::memory_order_relaxed);
+
+            while (true) {
+                slot &target = slots_[pos & (CAPACITY - 1)];
+                const std::size_t sequence = target.sequence_.load(std::memory_order_acquire);
+                const std::intptr_t diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+
+                if (diff == 0) {
+                    if (pop_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        val = target.data_;
+                        target.sequence_.store(pos + CAPACITY, std::memory_order_release);
+
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = pop_pos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * \brief Get the number of values in the buffer.
+         *
+         * Only a hint when other threads are pushing or popping.
+         */
+        std::size_t size() const {
+            const std::size_t pushed = push_pos_.load(std::memory_order_relaxed);
+            const std::size_t popped = pop_pos_.load(std::memory_order_relaxed);
+
+            return (pushed > popped) ? (pushed - popped) : 0;
+        }
+
+        static constexpr std::size_t capacity() {
+            return CAPACITY;
+        }
+    };
 }
@@ -21,6 +21,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 
 namespace eka2l1::common {
@@ -78,4 +79,35 @@ namespace eka2l1::common {
 
         void reset();
     };
-}
\ No newline at end of file
+
+    struct lock_stats {
+        std::uint64_t acquires_ = 0; ///< Total times the lock was taken.
+        std::uint64_t contentions_ = 0; ///< Times the lock was already held by someone else.
+        std::uint64_t wait_ns_ = 0; ///< Total time spent waiting on contention, in nanoseconds.
+    };
+
+    /**
+     * @brief A mutex that counts how often it is contended.
+     * 
+     * Locking first tries to take the mutex without blocking. Only when that fails the wait is timed,
+     * so an uncontended lock costs one extra atomic increment.
+     */
+    class counted_mutex {
+        std::mutex mut_;
+
+        std::atomic<std::uint64_t> acquires_{ 0 };
+        std::atomic<std::uint64_t> contentions_{ 0 };
+        std::atomic<std::uint64_t> wait_ns_{ 0 };
+
+    public:
+        void lock();
+        bool try_lock();
+
+        void unlock() {
+            mut_.unlock();
+        }
+
+        lock_stats stats() const;
+        void reset_stats();
+    };
+}
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <cstdint>
+#include <thread>
 
 namespace eka2l1::common {
     /**
@@ -43,4 +44,19 @@ namespace eka2l1::common {
      * @see   set_thread_name
      */
     void set_thread_priority(const thread_priority pri);
-}
\ No newline at end of file
+
+    /**
+     * @brief Get the CPU time the caller thread has used so far.
+     * 
+     * @returns Time in microseconds, or 0 if the host can not report it.
+     */
+    std::uint64_t get_thread_cpu_time_us();
+
+    /**
+     * @brief Get the CPU time a running thread has used so far.
+     * 
+     * @param thr The thread to query. Must not have been joined or detached.
+     * @returns Time in microseconds, or 0 if the host can not report it.
+     */
+    std::uint64_t get_thread_cpu_time_us(std::thread &thr);
+}
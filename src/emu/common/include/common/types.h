@@ -127,7 +127,9 @@ enum class drive_media {
 
 enum class arm_emulator_type {
     unicorn = 0,
-    dynarmic = 1
+    dynarmic = 1,
+    interpreter = 2,
+    tiered = 3
 };
 
 typedef std::uint32_t vaddress;
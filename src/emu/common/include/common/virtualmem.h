@@ -31,6 +31,38 @@ namespace eka2l1::common {
     */
     void *map_memory(const std::size_t size);
 
+    /**
+     * \brief Map memory with defined size, backed by a shareable memory object.
+     *
+     * The region behaves like one reserved with map_memory, but its pages can later be viewed
+     * at another host address using map_alias.
+     *
+     * \returns A valid pointer on success. Nullptr is fail.
+    */
+    void *map_memory_shareable(const std::size_t size);
+
+    /**
+     * \brief Map the pages backing a shareable region to another host address.
+     *
+     * Both views refer to the same physical memory afterwards. The destination must be page aligned
+     * and lies in a region previously reserved with map_memory.
+     *
+     * \param dest   The host address to map the alias view to.
+     * \param source Pointer inside a region reserved with map_memory_shareable.
+     * \param size   Size of the view.
+     * \param perm   Protection of the alias view.
+     *
+     * \returns False if the source is not shareable or the platform does not support aliasing.
+    */
+    bool map_alias(void *dest, void *source, const std::size_t size, const prot perm);
+
+    /**
+     * \brief Remove an alias view, leaving the destination region reserved but inaccessible.
+     *
+     * \returns True on success.
+    */
+    bool unmap_alias(void *dest, const std::size_t size);
+
     /**
      * \brief Unmap an pointer which points to a mapped region
      *
@@ -89,18 +121,22 @@ namespace eka2l1::common {
      * \param size Total size of the file to be mapped. Use 0 to map the whole file.
      * \param is_private Use this so any write to the mapped regions are abadoned when the mapped file close.
      *                   On Linux this is always private.
+     * \param mapped_size Optional pointer to receive the size of the mapped region.
      *
-     * \returns A valid pointer to the mapped region on success.
+     * \returns A valid pointer to the mapped region on success. Nullptr on failure, or if the file is empty.
     */
     void *map_file(const std::string &file_name, const prot perm = prot::read, const std::size_t size = 0,
-        const bool is_private = false);
+        const bool is_private = false, std::size_t *mapped_size = nullptr);
 
     /**
      * \brief Unmap a file mapped to memory
      *
+     * \param ptr  Pointer returned by map_file.
+     * \param size The size of the mapped region.
+     *
      * \returns True on success.
     */
-    bool unmap_file(void *ptr);
+    bool unmap_file(void *ptr, const std::size_t size);
 
     /**
      * \brief Returns true if the platform doesn't allow write and executable memory at the same time.
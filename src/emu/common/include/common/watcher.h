@@ -75,14 +75,14 @@ namespace eka2l1::common {
         /**
          * \brief   Watch a directory.
          * 
-         * Recurisve and non-recursive currently depends on the behaviour of the implementation :(
+         * Subdirectories are watched too, including ones created later.
          * 
          * \param   folder                The path to the folder
          * \param   callback              The callback which is invoked on folder changes.
          * \param   callback_userdata     The userdata that will be passed to the callback.
          * \param   filters               Bitmask flags to choose what changes to notify us.
          * 
-         * \returns Handle to the watch (> 0), else error code.
+         * \returns Handle to the watch (> 0), 0 if watching is not supported on this host, else error code.
          * 
          * \see     unwatch
          */
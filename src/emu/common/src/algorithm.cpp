@@ -204,6 +204,19 @@ namespace eka2l1 {
 #endif
         }
 
+        int count_trailing_zero(const std::uint32_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctz(v);
+#elif defined(_MSC_VER)
+            DWORD tz = 0;
+
+            if (_BitScanForward(&tz, v))
+                return static_cast<int>(tz);
+
+            return 32;
+#endif
+        }
+
         int find_most_significant_bit_one(const std::uint32_t v) {
             return 32 - count_leading_zero(v);
         }
@@ -27,91 +27,369 @@
 #include <stdexcept>
 
 namespace eka2l1::common {
-    block_allocator::block_allocator(std::uint8_t *sptr, const std::size_t initial_max_size)
-        : space_based_allocator(sptr, initial_max_size) {
-        const auto alignment_needed = (4 - reinterpret_cast<std::uint64_t>(ptr) % 4) % 4;
+    void tlsf_allocator::mapping_insert(const std::size_t size, std::uint32_t &fl, std::uint32_t &sl) {
+        if (size < SMALL_BLOCK_SIZE) {
+            fl = 0;
+            sl = static_cast<std::uint32_t>(size >> ALIGNMENT_LOG2);
 
-        if (alignment_needed > initial_max_size) {
-            if (!expand(alignment_needed)) {
-                throw std::runtime_error("Pointer is not align, expand to align failed!");
-            }
+            return;
         }
 
+        const std::uint32_t msb = static_cast<std::uint32_t>(common::find_most_significant_bit_one(static_cast<std::uint32_t>(size)) - 1);
+
+        sl = static_cast<std::uint32_t>(size >> (msb - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+        fl = msb - FL_INDEX_SHIFT + 1;
+    }
+
+    tlsf_allocator::tlsf_allocator(std::uint8_t *sptr, const std::size_t initial_max_size)
+        : space_based_allocator(sptr, initial_max_size)
+        , fl_bitmap_(0)
+        , last_block_(INVALID_BLOCK)
+        , used_size_(0)
+        , free_block_count_(0) {
+        const std::size_t alignment_needed = (ALIGNMENT - reinterpret_cast<std::uint64_t>(ptr) % ALIGNMENT) % ALIGNMENT;
+
         ptr += alignment_needed;
+        max_size = (alignment_needed > max_size) ? 0 : ((max_size - alignment_needed) & ~(ALIGNMENT - 1));
+
+        sl_bitmaps_.fill(0);
+
+        for (auto &heads : free_heads_) {
+            heads.fill(INVALID_BLOCK);
+        }
+
+        if (max_size != 0) {
+            const std::uint32_t idx = new_block_info();
+            blocks_[idx] = { 0, max_size, INVALID_BLOCK, INVALID_BLOCK, INVALID_BLOCK, INVALID_BLOCK, true };
+
+            last_block_ = idx;
+            insert_free_block(idx);
+        }
     }
 
-    void *block_allocator::allocate(std::size_t bytes) {
-        std::size_t rounded_size = common::next_power_of_two(bytes);
-        std::uint64_t farthest_end_offset = 0;
+    std::uint32_t tlsf_allocator::new_block_info() {
+        if (!unused_infos_.empty()) {
+            const std::uint32_t idx = unused_infos_.back();
+            unused_infos_.pop_back();
+
+            return idx;
+        }
+
+        blocks_.emplace_back();
+        return static_cast<std::uint32_t>(blocks_.size() - 1);
+    }
 
-        const std::lock_guard<std::mutex> guard(lock);
+    void tlsf_allocator::release_block_info(const std::uint32_t idx) {
+        unused_infos_.push_back(idx);
+    }
 
-        for (auto &block : blocks) {
-            farthest_end_offset = common::max(farthest_end_offset, block.offset + block.size);
+    void tlsf_allocator::insert_free_block(const std::uint32_t idx) {
+        block_info &block = blocks_[idx];
+
+        std::uint32_t fl = 0;
+        std::uint32_t sl = 0;
+
+        mapping_insert(block.size_, fl, sl);
+
+        const std::uint32_t head = free_heads_[fl][sl];
+
+        block.free_ = true;
+        block.prev_free_ = INVALID_BLOCK;
+        block.next_free_ = head;
+
+        if (head != INVALID_BLOCK) {
+            blocks_[head].prev_free_ = idx;
+        }
+
+        free_heads_[fl][sl] = idx;
+
+        fl_bitmap_ |= (1U << fl);
+        sl_bitmaps_[fl] |= (1U << sl);
+
+        free_block_count_++;
+    }
+
+    void tlsf_allocator::remove_free_block(const std::uint32_t idx) {
+        block_info &block = blocks_[idx];
+
+        if (block.prev_free_ != INVALID_BLOCK) {
+            blocks_[block.prev_free_].next_free_ = block.next_free_;
+        }
+
+        if (block.next_free_ != INVALID_BLOCK) {
+            blocks_[block.next_free_].prev_free_ = block.prev_free_;
+        }
 
-            if (!block.active && block.size >= rounded_size) {
-                // Gonna use it right away
-                if (block.size == rounded_size) {
-                    block.active = true;
-                    return block.offset + ptr;
+        std::uint32_t fl = 0;
+        std::uint32_t sl = 0;
+
+        mapping_insert(block.size_, fl, sl);
+
+        if (free_heads_[fl][sl] == idx) {
+            free_heads_[fl][sl] = block.next_free_;
+
+            // List is empty now, clear the bits so the search skips it
+            if (block.next_free_ == INVALID_BLOCK) {
+                sl_bitmaps_[fl] &= ~(1U << sl);
+
+                if (sl_bitmaps_[fl] == 0) {
+                    fl_bitmap_ &= ~(1U << fl);
                 }
+            }
+        }
 
-                void *ret_ptr = ptr + block.offset;
+        block.free_ = false;
+        block.prev_free_ = INVALID_BLOCK;
+        block.next_free_ = INVALID_BLOCK;
 
-                // Divide it to two if we can
-                block_info new_block;
-                new_block.active = true;
-                new_block.offset = block.offset;
-                new_block.size = rounded_size;
+        free_block_count_--;
+    }
 
-                // Change our old block
-                block.size -= rounded_size;
-                block.offset += rounded_size;
+    std::uint32_t tlsf_allocator::find_free_block(std::size_t size) {
+        // Round up to the next list, so any block in the found list is large enough
+        if (size >= SMALL_BLOCK_SIZE) {
+            const std::uint32_t msb = static_cast<std::uint32_t>(common::find_most_significant_bit_one(static_cast<std::uint32_t>(size)) - 1);
+            size += (static_cast<std::size_t>(1) << (msb - SL_INDEX_COUNT_LOG2)) - 1;
+        }
 
-                blocks.push_back(std::move(new_block));
-                return ret_ptr;
+        std::uint32_t fl = 0;
+        std::uint32_t sl = 0;
+
+        mapping_insert(size, fl, sl);
+
+        if (fl >= FL_INDEX_COUNT) {
+            return INVALID_BLOCK;
+        }
+
+        std::uint32_t sl_map = sl_bitmaps_[fl] & (~0U << sl);
+
+        if (sl_map == 0) {
+            // Take the smallest list of a larger class
+            const std::uint32_t fl_map = (fl + 1 < 32) ? (fl_bitmap_ & (~0U << (fl + 1))) : 0;
+
+            if (fl_map == 0) {
+                return INVALID_BLOCK;
             }
+
+            fl = static_cast<std::uint32_t>(common::count_trailing_zero(fl_map));
+            sl_map = sl_bitmaps_[fl];
         }
 
-        if (farthest_end_offset + rounded_size > max_size) {
-            // It's time to expand
-            if (!expand(common::max(max_size * 2, max_size + rounded_size))) {
+        sl = static_cast<std::uint32_t>(common::count_trailing_zero(sl_map));
+        return free_heads_[fl][sl];
+    }
+
+    void tlsf_allocator::split_block(const std::uint32_t idx, const std::size_t size) {
+        if (blocks_[idx].size_ - size < ALIGNMENT) {
+            return;
+        }
+
+        // May reallocate the block list, don't hold references across this
+        const std::uint32_t rest_idx = new_block_info();
+
+        block_info &block = blocks_[idx];
+        block_info &rest = blocks_[rest_idx];
+
+        rest.offset_ = block.offset_ + size;
+        rest.size_ = block.size_ - size;
+        rest.prev_phys_ = idx;
+        rest.next_phys_ = block.next_phys_;
+
+        if (block.next_phys_ != INVALID_BLOCK) {
+            blocks_[block.next_phys_].prev_phys_ = rest_idx;
+        } else {
+            last_block_ = rest_idx;
+        }
+
+        block.size_ = size;
+        block.next_phys_ = rest_idx;
+
+        insert_free_block(rest_idx);
+    }
+
+    void tlsf_allocator::absorb_next_block(const std::uint32_t idx) {
+        block_info &block = blocks_[idx];
+        const std::uint32_t next_idx = block.next_phys_;
+        block_info &next = blocks_[next_idx];
+
+        block.size_ += next.size_;
+        block.next_phys_ = next.next_phys_;
+
+        if (next.next_phys_ != INVALID_BLOCK) {
+            blocks_[next.next_phys_].prev_phys_ = idx;
+        } else {
+            last_block_ = idx;
+        }
+
+        release_block_info(next_idx);
+    }
+
+    std::uint32_t tlsf_allocator::fit_last_block(const std::size_t size) {
+        if ((last_block_ != INVALID_BLOCK) && blocks_[last_block_].free_ && (blocks_[last_block_].size_ >= size)) {
+            return last_block_;
+        }
+
+        return INVALID_BLOCK;
+    }
+
+    bool tlsf_allocator::grow(const std::size_t size) {
+        // The free block at the end is merged with the grown part, so only the rest is needed.
+        // It is smaller than the size, else it would have been taken without growing.
+        std::size_t needed = size;
+
+        if ((last_block_ != INVALID_BLOCK) && blocks_[last_block_].free_) {
+            needed -= blocks_[last_block_].size_;
+        }
+
+        std::size_t target = common::max(max_size * 2, max_size + needed);
+
+        if (!expand(target)) {
+            // Doubling may go over the space limit, try with just what we need
+            target = max_size + needed;
+
+            if (!expand(target)) {
+                return false;
+            }
+        }
+
+        const std::size_t grown_size = target - max_size;
+
+        if ((last_block_ != INVALID_BLOCK) && blocks_[last_block_].free_) {
+            remove_free_block(last_block_);
+            blocks_[last_block_].size_ += grown_size;
+
+            insert_free_block(last_block_);
+        } else {
+            const std::uint32_t idx = new_block_info();
+            blocks_[idx] = { max_size, grown_size, last_block_, INVALID_BLOCK, INVALID_BLOCK, INVALID_BLOCK, true };
+
+            if (last_block_ != INVALID_BLOCK) {
+                blocks_[last_block_].next_phys_ = idx;
+            }
+
+            last_block_ = idx;
+            insert_free_block(idx);
+        }
+
+        max_size = target;
+        return true;
+    }
+
+    void *tlsf_allocator::allocate(std::size_t bytes) {
+        if (bytes > MAX_ALLOCATION_SIZE) {
+            return nullptr;
+        }
+
+        const std::size_t size = common::max<std::size_t>(common::align(bytes, ALIGNMENT), ALIGNMENT);
+
+        const std::lock_guard<std::mutex> guard(lock_);
+        std::uint32_t idx = find_free_block(size);
+
+        if (idx == INVALID_BLOCK) {
+            // The list search rounds up to the next class, so it skips a block only slightly larger than
+            // what is asked. The last block is the one growing extends, check it exactly.
+            idx = fit_last_block(size);
+        }
+
+        if (idx == INVALID_BLOCK) {
+            if (!grow(size)) {
                 return nullptr;
             }
 
-            max_size = common::max(max_size * 2, max_size + rounded_size);
+            idx = find_free_block(size);
+
+            if (idx == INVALID_BLOCK) {
+                idx = fit_last_block(size);
+            }
+
+            if (idx == INVALID_BLOCK) {
+                return nullptr;
+            }
         }
 
-        // We try our best, but we can't
-        // We should alloc new block
-        block_info new_block;
-        new_block.active = true;
-        new_block.offset = farthest_end_offset;
-        new_block.size = rounded_size;
+        remove_free_block(idx);
+        split_block(idx, size);
 
-        blocks.push_back(std::move(new_block));
+        const block_info &block = blocks_[idx];
 
-        return farthest_end_offset + ptr;
+        used_blocks_.emplace(block.offset_, idx);
+        used_size_ += block.size_;
+
+        return ptr + block.offset_;
     }
 
-    bool block_allocator::free(const void *tptr) {
-        const std::uint64_t to_free_offset = reinterpret_cast<const std::uint8_t *>(tptr) - ptr;
+    bool tlsf_allocator::free(const void *tptr) {
+        const std::uint8_t *to_free = reinterpret_cast<const std::uint8_t *>(tptr);
 
-        const std::lock_guard<std::mutex> guard(lock);
+        if ((to_free < ptr) || (to_free >= ptr + max_size)) {
+            return false;
+        }
 
-        auto ite = std::find_if(blocks.begin(), blocks.end(),
-            [to_free_offset](const block_info &info) {
-                return info.active && info.offset == to_free_offset;
-            });
+        const std::lock_guard<std::mutex> guard(lock_);
+        auto ite = used_blocks_.find(static_cast<std::size_t>(to_free - ptr));
 
-        if (ite == blocks.end()) {
+        if (ite == used_blocks_.end()) {
             return false;
         }
 
-        ite->active = false;
+        std::uint32_t idx = ite->second;
+        used_blocks_.erase(ite);
+
+        used_size_ -= blocks_[idx].size_;
+
+        // Merge with free neighbours
+        const std::uint32_t prev_idx = blocks_[idx].prev_phys_;
+
+        if ((prev_idx != INVALID_BLOCK) && blocks_[prev_idx].free_) {
+            remove_free_block(prev_idx);
+            absorb_next_block(prev_idx);
+
+            idx = prev_idx;
+        }
+
+        const std::uint32_t next_idx = blocks_[idx].next_phys_;
+
+        if ((next_idx != INVALID_BLOCK) && blocks_[next_idx].free_) {
+            remove_free_block(next_idx);
+            absorb_next_block(idx);
+        }
+
+        insert_free_block(idx);
         return true;
     }
 
+    double tlsf_allocator::statistics::fragmentation() const {
+        if (free_size_ == 0) {
+            return 0.0;
+        }
+
+        return 1.0 - static_cast<double>(largest_free_block_) / static_cast<double>(free_size_);
+    }
+
+    tlsf_allocator::statistics tlsf_allocator::get_statistics() {
+        const std::lock_guard<std::mutex> guard(lock_);
+
+        statistics stats;
+        stats.total_size_ = max_size;
+        stats.used_size_ = used_size_;
+        stats.free_size_ = max_size - used_size_;
+        stats.largest_free_block_ = 0;
+        stats.used_block_count_ = used_blocks_.size();
+        stats.free_block_count_ = free_block_count_;
+
+        if (fl_bitmap_ != 0) {
+            // The largest block is in the highest non-empty list. Lists are not sorted, so walk it
+            const std::uint32_t fl = static_cast<std::uint32_t>(common::find_most_significant_bit_one(fl_bitmap_) - 1);
+            const std::uint32_t sl = static_cast<std::uint32_t>(common::find_most_significant_bit_one(sl_bitmaps_[fl]) - 1);
+
+            for (std::uint32_t idx = free_heads_[fl][sl]; idx != INVALID_BLOCK; idx = blocks_[idx].next_free_) {
+                stats.largest_free_block_ = common::max(stats.largest_free_block_, blocks_[idx].size_);
+            }
+        }
+
+        return stats;
+    }
+
     bitmap_allocator::bitmap_allocator(const std::size_t total_bits)
         : words_((total_bits >> 5) + ((total_bits % 32 != 0) ? 1 : 0), 0xFFFFFFFF) {
     }
@@ -22,10 +22,16 @@
 #include <common/buffer.h>
 #include <common/bytepair.h>
 #include <common/log.h>
+#include <common/thread.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <functional>
-#include <stack>
+#include <mutex>
+#include <thread>
 
 namespace eka2l1 {
     namespace common {
@@ -43,7 +49,10 @@ namespace eka2l1 {
             uint32_t b = 0x03020100;
             uint32_t step = 0x04040404;
 
-            std::stack<uint8_t> sec_stack;
+            // Each level of pending pairs comes from a different table entry, so the depth of a well-formed
+            // page is bounded by the table size. A fixed stack avoids allocating for every page.
+            uint8_t sec_stack[0x100];
+            uint32_t sec_stack_top = 0;
 
             uint8_t *buf_end = reinterpret_cast<uint8_t *>(buffer) + buf_size;
             uint8_t *dest_end = reinterpret_cast<uint8_t *>(destination) + dest_size;
@@ -133,21 +142,30 @@ namespace eka2l1 {
             p2 = lookup_table_second[b];
             b = p1;
             p1 = lookup_table_first[b];
-            sec_stack.push(p2);
+            if (sec_stack_top >= sizeof(sec_stack)) {
+                // Pairs referencing each other in a loop, the data is corrupted
+                return 0;
+            }
+
+            sec_stack[sec_stack_top++] = p2;
 
         recurse:
             if (b != p1) {
                 goto do_pair;
             }
 
-            if (sec_stack.empty()) {
+            if (sec_stack_top == 0) {
                 goto process_replace;
             }
 
-            b = sec_stack.top();
-            sec_stack.pop();
+            b = sec_stack[--sec_stack_top];
 
             *dest++ = p1;
+
+            if (dest >= dest_end) {
+                goto done_dest;
+            }
+
             p1 = lookup_table_first[b];
 
             goto recurse;
@@ -166,6 +184,162 @@ namespace eka2l1 {
             return 1;
         }
 
+        // Threads to decompress pages on. Images are loaded one after another during boot, so the threads
+        // are kept alive between calls instead of being spawned for each one.
+        class bytepair_worker_pool {
+            std::vector<std::thread> workers_;
+            std::deque<std::function<void()>> jobs_;
+
+            std::mutex lock_;
+            std::condition_variable job_cond_;
+
+            bool stop_;
+
+            void worker_loop() {
+                common::set_thread_name("Bytepair worker");
+                std::unique_lock<std::mutex> ulock(lock_);
+
+                while (true) {
+                    job_cond_.wait(ulock, [this]() {
+                        return stop_ || !jobs_.empty();
+                    });
+
+                    if (jobs_.empty()) {
+                        return;
+                    }
+
+                    std::function<void()> job = std::move(jobs_.front());
+                    jobs_.pop_front();
+
+                    ulock.unlock();
+                    job();
+                    ulock.lock();
+                }
+            }
+
+        public:
+            explicit bytepair_worker_pool(const std::uint32_t worker_count)
+                : stop_(false) {
+                for (std::uint32_t i = 0; i < worker_count; i++) {
+                    workers_.emplace_back([this]() {
+                        worker_loop();
+                    });
+                }
+            }
+
+            ~bytepair_worker_pool() {
+                {
+                    const std::lock_guard<std::mutex> guard(lock_);
+                    stop_ = true;
+                }
+
+                job_cond_.notify_all();
+
+                for (auto &worker : workers_) {
+                    worker.join();
+                }
+            }
+
+            std::uint32_t worker_count() const {
+                return static_cast<std::uint32_t>(workers_.size());
+            }
+
+            // Run the job on the caller and on the given number of workers, and wait for all of them to finish
+            void run(const std::function<void()> &job, const std::uint32_t helper_count) {
+                std::mutex done_lock;
+                std::condition_variable done_cond;
+                std::uint32_t pending = helper_count;
+
+                {
+                    const std::lock_guard<std::mutex> guard(lock_);
+
+                    for (std::uint32_t i = 0; i < helper_count; i++) {
+                        jobs_.push_back([&]() {
+                            job();
+
+                            // Notify with the lock held, the caller may return and free these as soon as it is released
+                            const std::lock_guard<std::mutex> done_guard(done_lock);
+                            pending--;
+                            done_cond.notify_one();
+                        });
+                    }
+                }
+
+                job_cond_.notify_all();
+                job();
+
+                std::unique_lock<std::mutex> done_ulock(done_lock);
+                done_cond.wait(done_ulock, [&]() {
+                    return pending == 0;
+                });
+            }
+        };
+
+        static bytepair_worker_pool &get_worker_pool() {
+            // The caller works too, so one thread less than the hardware has
+            static bytepair_worker_pool pool(common::max<std::uint32_t>(std::thread::hardware_concurrency(), 1) - 1);
+            return pool;
+        }
+
+        // Waking workers is not free, don't bother for small images
+        static constexpr std::uint32_t MIN_PAGES_PER_THREAD = 8;
+
+        static std::uint32_t decide_decompress_thread_count(const std::size_t page_count, std::uint32_t max_threads) {
+            if (max_threads == 0) {
+                max_threads = common::max<std::uint32_t>(std::thread::hardware_concurrency(), 1);
+            }
+
+            const std::size_t wanted = page_count / MIN_PAGES_PER_THREAD;
+            return static_cast<std::uint32_t>(common::clamp<std::size_t>(1, max_threads, wanted));
+        }
+
+        uint32_t bytepair_decompress_pages(char *dest, size_t dest_size, const std::uint8_t *compressed,
+            const std::vector<uint16_t> &page_sizes, const std::uint32_t max_threads) {
+            const std::size_t page_count = common::min<std::size_t>(page_sizes.size(),
+                (dest_size + BYTEPAIR_PAGE_SIZE - 1) / BYTEPAIR_PAGE_SIZE);
+
+            std::vector<std::size_t> offsets(page_count);
+            std::vector<uint32_t> decompressed(page_count, 0);
+
+            std::size_t offset = 0;
+
+            for (std::size_t i = 0; i < page_count; i++) {
+                offsets[i] = offset;
+                offset += page_sizes[i];
+            }
+
+            std::atomic<std::size_t> next_page(0);
+
+            auto decompress_worker = [&]() {
+                std::size_t page = 0;
+
+                while ((page = next_page.fetch_add(1, std::memory_order_relaxed)) < page_count) {
+                    const std::size_t dest_offset = page * BYTEPAIR_PAGE_SIZE;
+                    const std::size_t len = common::min<std::size_t>(dest_size - dest_offset, BYTEPAIR_PAGE_SIZE);
+
+                    decompressed[page] = bytepair_decompress(dest + dest_offset, static_cast<unsigned int>(len),
+                        const_cast<std::uint8_t *>(compressed + offsets[page]), page_sizes[page]);
+                }
+            };
+
+            const std::uint32_t thread_count = decide_decompress_thread_count(page_count, max_threads);
+
+            if (thread_count <= 1) {
+                decompress_worker();
+            } else {
+                bytepair_worker_pool &pool = get_worker_pool();
+                pool.run(decompress_worker, common::min<std::uint32_t>(thread_count - 1, pool.worker_count()));
+            }
+
+            uint32_t total = 0;
+
+            for (const uint32_t size : decompressed) {
+                total += size;
+            }
+
+            return total;
+        }
+
         ibytepair_stream::ibytepair_stream(common::ro_stream *stream)
             : compress_stream(stream) {
         }
@@ -204,25 +378,28 @@ namespace eka2l1 {
             return bytepair_decompress(dest, static_cast<int>(len), buf.data(), idx_tab.page_size[page]);
         }
 
-        uint32_t ibytepair_stream::read_pages(char *dest, size_t size) {
-            uint32_t decompressed_size = 0;
+        bool ibytepair_stream::read_compressed_pages(std::vector<std::uint8_t> &compressed) {
             read_table();
 
-            uint64_t tsize = 0;
+            std::size_t total_size = 0;
 
-            for (uint32_t i = 0; i < idx_tab.page_size.size(); i++) {
-                tsize += idx_tab.page_size[i];
+            for (const uint16_t page_size : idx_tab.page_size) {
+                total_size += page_size;
             }
 
-            for (auto i = 0; i < idx_tab.header.number_of_pages; i++) {
-                uint32_t dcs_page = read_page(dest, i, size);
+            compressed.resize(total_size);
+            return compress_stream->read(compressed.data(), total_size) == total_size;
+        }
+
+        uint32_t ibytepair_stream::read_pages(char *dest, size_t size, const std::uint32_t max_threads) {
+            std::vector<std::uint8_t> compressed;
 
-                decompressed_size += dcs_page;
-                dest += dcs_page;
-                size -= dcs_page;
+            if (!read_compressed_pages(compressed)) {
+                LOG_ERROR(COMMON, "Bytepair stream ended before all pages could be read");
+                return 0;
             }
 
-            return decompressed_size;
+            return bytepair_decompress_pages(dest, size, compressed.data(), idx_tab.page_size, max_threads);
         }
 
         std::vector<uint32_t> ibytepair_stream::page_offsets(uint32_t initial_off) {
@@ -231,16 +408,64 @@ namespace eka2l1 {
 
             res.resize(idx_tab.header.number_of_pages + 1);
 
-            size_t bytes = initial_off + 10 + res.size() * sizeof(uint16_t);
+            size_t bytes = initial_off + 10 + idx_tab.page_size.size() * sizeof(uint16_t);
 
-            for (auto i = 0; i < res.size(); ++i) {
+            for (std::size_t i = 0; i < idx_tab.page_size.size(); ++i) {
                 res[i] = static_cast<uint32_t>(bytes);
                 bytes += idx_tab.page_size[i];
             }
 
-            res[res.size()] = static_cast<uint32_t>(bytes);
+            res.back() = static_cast<uint32_t>(bytes);
 
             return res;
         }
+
+        bytepair_page_store::bytepair_page_store()
+            : decompressed_size_(0) {
+        }
+
+        bool bytepair_page_store::load(ibytepair_stream &stream, const std::size_t decompressed_size) {
+            if (!stream.read_compressed_pages(compressed_)) {
+                LOG_ERROR(COMMON, "Bytepair stream ended before all pages could be read");
+                return false;
+            }
+
+            page_sizes_ = stream.table().page_size;
+            offsets_.resize(page_sizes_.size());
+
+            std::size_t offset = 0;
+
+            for (std::size_t i = 0; i < page_sizes_.size(); i++) {
+                offsets_[i] = offset;
+                offset += page_sizes_[i];
+            }
+
+            decompressed_size_ = common::min<std::size_t>(decompressed_size, page_sizes_.size() * BYTEPAIR_PAGE_SIZE);
+            return true;
+        }
+
+        bool bytepair_page_store::decompress(char *dest, const std::size_t offset, const std::size_t size) const {
+            if (!size || (offset >= decompressed_size_)) {
+                return true;
+            }
+
+            const std::size_t first_page = offset / BYTEPAIR_PAGE_SIZE;
+            const std::size_t last_page = (common::min(offset + size, decompressed_size_) - 1) / BYTEPAIR_PAGE_SIZE;
+
+            for (std::size_t page = first_page; page <= last_page; page++) {
+                const std::size_t dest_offset = page * BYTEPAIR_PAGE_SIZE;
+                const std::size_t len = common::min<std::size_t>(decompressed_size_ - dest_offset, BYTEPAIR_PAGE_SIZE);
+
+                const int result = bytepair_decompress(dest + dest_offset, static_cast<unsigned int>(len),
+                    const_cast<std::uint8_t *>(compressed_.data() + offsets_[page]), page_sizes_[page]);
+
+                if (result != static_cast<int>(len)) {
+                    LOG_ERROR(COMMON, "Bytepair page {} is corrupted", page);
+                    return false;
+                }
+            }
+
+            return true;
+        }
     }
 }
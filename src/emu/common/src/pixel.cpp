@@ -0,0 +1,585 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common/pixel.h>
+#include <common/platform.h>
+
+#include <cstring>
+#include <vector>
+
+// The vector paths are picked at compile time. SSE2 is always there on x64, AVX2 needs to be
+// enabled by the compiler flags.
+#if EKA2L1_ARCH(X64) || defined(__SSE2__)
+#define PIXEL_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__)
+#define PIXEL_USE_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define PIXEL_USE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if EKA2L1_ARCH(ARM64) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PIXEL_USE_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace eka2l1::common {
+    static constexpr std::uint32_t OPAQUE_ALPHA = 0xFF000000;
+
+    std::uint32_t get_pixel_format_bpp(const pixel_format format) {
+        switch (format) {
+        case pixel_format::gray2:
+            return 1;
+
+        case pixel_format::gray4:
+            return 2;
+
+        case pixel_format::gray16:
+        case pixel_format::color16:
+            return 4;
+
+        case pixel_format::gray256:
+        case pixel_format::color256:
+            return 8;
+
+        // 12 bits of colour, but each pixel takes a whole 16-bit word
+        case pixel_format::color4k:
+        case pixel_format::color64k:
+            return 16;
+
+        case pixel_format::color16m:
+            return 24;
+
+        default:
+            break;
+        }
+
+        return 32;
+    }
+
+    static inline std::uint32_t div_255(const std::uint32_t value) {
+        // Exact rounded division for value <= 255 * 255
+        const std::uint32_t temp = value + 128;
+        return (temp + (temp >> 8)) >> 8;
+    }
+
+    static inline std::uint32_t gray_to_argb(const std::uint32_t gray) {
+        return OPAQUE_ALPHA | (gray * 0x010101);
+    }
+
+    static inline std::uint32_t premultiply_pixel(const std::uint32_t pixel) {
+        const std::uint32_t alpha = pixel >> 24;
+
+        return (alpha << 24) | (div_255(((pixel >> 16) & 0xFF) * alpha) << 16) | (div_255(((pixel >> 8) & 0xFF) * alpha) << 8)
+            | div_255((pixel & 0xFF) * alpha);
+    }
+
+    // Result of unpremultiplying each channel value (low byte of the index) with each alpha (high byte)
+    static const std::uint8_t *get_unpremultiply_table() {
+        static const std::vector<std::uint8_t> table = []() {
+            std::vector<std::uint8_t> result(256 * 256, 0);
+
+            for (std::uint32_t alpha = 1; alpha < 256; alpha++) {
+                for (std::uint32_t channel = 0; channel < 256; channel++) {
+                    const std::uint32_t value = (channel * 255 + (alpha >> 1)) / alpha;
+                    result[(alpha << 8) | channel] = static_cast<std::uint8_t>((value > 255) ? 255 : value);
+                }
+            }
+
+            return result;
+        }();
+
+        return table.data();
+    }
+
+    static inline std::uint32_t unpremultiply_pixel(const std::uint32_t pixel, const std::uint8_t *table) {
+        const std::uint32_t alpha = pixel >> 24;
+        const std::uint8_t *row = table + (alpha << 8);
+
+        return (alpha << 24) | (row[(pixel >> 16) & 0xFF] << 16) | (row[(pixel >> 8) & 0xFF] << 8) | row[pixel & 0xFF];
+    }
+
+    // Sub-byte formats with a palette: handle a whole source byte at a time, no branching on the format per pixel.
+    template <std::uint32_t BPP, typename F>
+    static void convert_packed_row(const std::uint8_t *source, std::uint32_t *dest, const std::size_t pixel_count, F lookup) {
+        constexpr std::uint32_t PIXELS_PER_BYTE = 8 / BPP;
+        constexpr std::uint32_t MASK = (1 << BPP) - 1;
+
+        const std::size_t full_bytes = pixel_count / PIXELS_PER_BYTE;
+
+        for (std::size_t i = 0; i < full_bytes; i++) {
+            std::uint32_t byte = source[i];
+
+            for (std::uint32_t j = 0; j < PIXELS_PER_BYTE; j++) {
+                *dest++ = lookup(byte & MASK);
+                byte >>= BPP;
+            }
+        }
+
+        const std::size_t remaining = pixel_count - full_bytes * PIXELS_PER_BYTE;
+
+        if (remaining) {
+            std::uint32_t byte = source[full_bytes];
+
+            for (std::size_t j = 0; j < remaining; j++) {
+                *dest++ = lookup(byte & MASK);
+                byte >>= BPP;
+            }
+        }
+    }
+
+    // Expand every possible source byte of a sub-byte format at once, so a byte is converted with one copy
+    template <std::uint32_t BPP, typename F>
+    static std::vector<std::uint32_t> make_packed_byte_table(F lookup) {
+        constexpr std::uint32_t PIXELS_PER_BYTE = 8 / BPP;
+        constexpr std::uint32_t MASK = (1 << BPP) - 1;
+
+        std::vector<std::uint32_t> table(256 * PIXELS_PER_BYTE);
+
+        for (std::uint32_t byte = 0; byte < 256; byte++) {
+            for (std::uint32_t j = 0; j < PIXELS_PER_BYTE; j++) {
+                table[byte * PIXELS_PER_BYTE + j] = lookup((byte >> (j * BPP)) & MASK);
+            }
+        }
+
+        return table;
+    }
+
+    template <std::uint32_t BPP>
+    static void convert_packed_row_with_table(const std::uint8_t *source, std::uint32_t *dest, const std::size_t pixel_count,
+        const std::uint32_t *table) {
+        constexpr std::uint32_t PIXELS_PER_BYTE = 8 / BPP;
+        const std::size_t full_bytes = pixel_count / PIXELS_PER_BYTE;
+
+        for (std::size_t i = 0; i < full_bytes; i++) {
+            std::memcpy(dest + i * PIXELS_PER_BYTE, table + source[i] * PIXELS_PER_BYTE, PIXELS_PER_BYTE * sizeof(std::uint32_t));
+        }
+
+        const std::size_t remaining = pixel_count - full_bytes * PIXELS_PER_BYTE;
+
+        if (remaining) {
+            std::memcpy(dest + full_bytes * PIXELS_PER_BYTE, table + source[full_bytes] * PIXELS_PER_BYTE, remaining * sizeof(std::uint32_t));
+        }
+    }
+
+    static void convert_row_gray256(const std::uint8_t *source, std::uint32_t *dest, const std::size_t pixel_count) {
+        std::size_t i = 0;
+
+#if PIXEL_USE_SSE2
+        const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+
+        for (; i + 16 <= pixel_count; i += 16) {
+            const __m128i gray = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+
+            // Interleave to B, G, R, A
+            const __m128i gray_gray_lo = _mm_unpacklo_epi8(gray, gray);
+            const __m128i gray_gray_hi = _mm_unpackhi_epi8(gray, gray);
+            const __m128i gray_alpha_lo = _mm_unpacklo_epi8(gray, alpha);
+            const __m128i gray_alpha_hi = _mm_unpackhi_epi8(gray, alpha);
+
+            __m128i *out = reinterpret_cast<__m128i *>(dest + i);
+
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(gray_gray_lo, gray_alpha_lo));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(gray_gray_lo, gray_alpha_lo));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(gray_gray_hi, gray_alpha_hi));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(gray_gray_hi, gray_alpha_hi));
+        }
+#elif PIXEL_USE_NEON
+        for (; i + 16 <= pixel_count; i += 16) {
+            uint8x16x4_t result;
+            result.val[0] = vld1q_u8(source + i);
+            result.val[1] = result.val[0];
+            result.val[2] = result.val[0];
+            result.val[3] = vdupq_n_u8(0xFF);
+
+            vst4q_u8(reinterpret_cast<std::uint8_t *>(dest + i), result);
+        }
+#endif
+
+        for (; i < pixel_count; i++) {
+            dest[i] = gray_to_argb(source[i]);
+        }
+    }
+
+    static void convert_row_palette256(const std::uint8_t *source, std::uint32_t *dest, const std::size_t pixel_count,
+        const std::uint32_t *palette) {
+        std::size_t i = 0;
+
+        // Gathers do not beat plain loads here, just unroll
+        for (; i + 4 <= pixel_count; i += 4) {
+            dest[i] = palette[source[i]];
+            dest[i + 1] = palette[source[i + 1]];
+            dest[i + 2] = palette[source[i + 2]];
+            dest[i + 3] = palette[source[i + 3]];
+        }
+
+        for (; i < pixel_count; i++) {
+            dest[i] = palette[source[i]];
+        }
+    }
+
+    static inline std::uint32_t color4k_to_argb(const std::uint16_t pixel) {
+        const std::uint32_t r = (pixel >> 8) & 0xF;
+        const std::uint32_t g = (pixel >> 4) & 0xF;
+        const std::uint32_t b = pixel & 0xF;
+
+        return OPAQUE_ALPHA | ((r * 0x11) << 16) | ((g * 0x11) << 8) | (b * 0x11);
+    }
+
+    static inline std::uint32_t color64k_to_argb(const std::uint16_t pixel) {
+        const std::uint32_t r = pixel >> 11;
+        const std::uint32_t g = (pixel >> 5) & 0x3F;
+        const std::uint32_t b = pixel & 0x1F;
+
+        return OPAQUE_ALPHA | (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+    }
+
+    template <bool IS_64K>
+    static void convert_row_16bit(const std::uint8_t *source, std::uint32_t *dest, const std::size_t pixel_count) {
+        std::size_t i = 0;
+
+#if PIXEL_USE_SSE2
+        const __m128i alpha = _mm_set1_epi16(static_cast<short>(0xFF00));
+        const __m128i low_byte = _mm_set1_epi16(0x00FF);
+
+        for (; i + 8 <= pixel_count; i += 8) {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 2));
+            __m128i r, g, b;
+
+            if (IS_64K) {
+                const __m128i r5 = _mm_srli_epi16(pixels, 11);
+                const __m128i g6 = _mm_and_si128(_mm_srli_epi16(pixels, 5), _mm_set1_epi16(0x3F));
+                const __m128i b5 = _mm_and_si128(pixels, _mm_set1_epi16(0x1F));
+
+                r = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+                g = _mm_or_si128(_mm_slli_epi16(g6, 2), _mm_srli_epi16(g6, 4));
+                b = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+            } else {
+                const __m128i nibble = _mm_set1_epi16(0xF);
+                const __m128i r4 = _mm_and_si128(_mm_srli_epi16(pixels, 8), nibble);
+                const __m128i g4 = _mm_and_si128(_mm_srli_epi16(pixels, 4), nibble);
+                const __m128i b4 = _mm_and_si128(pixels, nibble);
+
+                r = _mm_or_si128(_mm_slli_epi16(r4, 4), r4);
+                g = _mm_or_si128(_mm_slli_epi16(g4, 4), g4);
+                b = _mm_or_si128(_mm_slli_epi16(b4, 4), b4);
+            }
+
+            const __m128i blue_green = _mm_or_si128(_mm_and_si128(b, low_byte), _mm_slli_epi16(g, 8));
+            const __m128i red_alpha = _mm_or_si128(_mm_and_si128(r, low_byte), alpha);
+
+            __m128i *out = reinterpret_cast<__m128i *>(dest + i);
+
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(blue_green, red_alpha));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(blue_green, red_alpha));
+        }
+#elif PIXEL_USE_NEON
+        for (; i + 8 <= pixel_count; i += 8) {
+            const uint16x8_t pixels = vld1q_u16(reinterpret_cast<const std::uint16_t *>(source + i * 2));
+            uint16x8_t r, g, b;
+
+            if (IS_64K) {
+                const uint16x8_t r5 = vshrq_n_u16(pixels, 11);
+                const uint16x8_t g6 = vandq_u16(vshrq_n_u16(pixels, 5), vdupq_n_u16(0x3F));
+                const uint16x8_t b5 = vandq_u16(pixels, vdupq_n_u16(0x1F));
+
+                r = vorrq_u16(vshlq_n_u16(r5, 3), vshrq_n_u16(r5, 2));
+                g = vorrq_u16(vshlq_n_u16(g6, 2), vshrq_n_u16(g6, 4));
+                b = vorrq_u16(vshlq_n_u16(b5, 3), vshrq_n_u16(b5, 2));
+            } else {
+                const uint16x8_t nibble = vdupq_n_u16(0xF);
+                const uint16x8_t r4 = vandq_u16(vshrq_n_u16(pixels, 8), nibble);
+                const uint16x8_t g4 = vandq_u16(vshrq_n_u16(pixels, 4), nibble);
+                const uint16x8_t b4 = vandq_u16(pixels, nibble);
+
+                r = vorrq_u16(vshlq_n_u16(r4, 4), r4);
+                g = vorrq_u16(vshlq_n_u16(g4, 4), g4);
+                b = vorrq_u16(vshlq_n_u16(b4, 4), b4);
+            }
+
+            uint8x8x4_t result;
+            result.val[0] = vmovn_u16(b);
+            result.val[1] = vmovn_u16(g);
+            result.val[2] = vmovn_u16(r);
+            result.val[3] = vdup_n_u8(0xFF);
+
+            vst4_u8(reinterpret_cast<std::uint8_t *>(dest + i), result);
+        }
+#endif
+
+        for (; i < pixel_count; i++) {
+            std::uint16_t pixel = 0;
+            std::memcpy(&pixel, source + i * 2, sizeof(std::uint16_t));
+
+            dest[i] = IS_64K ? color64k_to_argb(pixel) : color4k_to_argb(pixel);
+        }
+    }
+
+    static void convert_row_color16m(const std::uint8_t *source, std::uint32_t *dest, const std::size_t pixel_count) {
+        std::size_t i = 0;
+
+#if PIXEL_USE_SSSE3
+        const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(OPAQUE_ALPHA));
+
+        // Each load reads 16 bytes but only uses 12 of them, keep the last one inside the row
+        for (; i + 6 <= pixel_count; i += 4) {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+        }
+#elif PIXEL_USE_NEON
+        for (; i + 16 <= pixel_count; i += 16) {
+            const uint8x16x3_t pixels = vld3q_u8(source + i * 3);
+
+            uint8x16x4_t result;
+            result.val[0] = pixels.val[0];
+            result.val[1] = pixels.val[1];
+            result.val[2] = pixels.val[2];
+            result.val[3] = vdupq_n_u8(0xFF);
+
+            vst4q_u8(reinterpret_cast<std::uint8_t *>(dest + i), result);
+        }
+#endif
+
+        for (; i < pixel_count; i++) {
+            const std::uint8_t *pixel = source + i * 3;
+            dest[i] = OPAQUE_ALPHA | (pixel[2] << 16) | (pixel[1] << 8) | pixel[0];
+        }
+    }
+
+    static void convert_row_color16mu(const std::uint8_t *source, std::uint32_t *dest, const std::size_t pixel_count) {
+        std::size_t i = 0;
+
+#if PIXEL_USE_AVX2
+        const __m256i alpha_wide = _mm256_set1_epi32(static_cast<int>(OPAQUE_ALPHA));
+
+        for (; i + 8 <= pixel_count; i += 8) {
+            const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i * 4));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest + i), _mm256_or_si256(pixels, alpha_wide));
+        }
+#endif
+
+#if PIXEL_USE_SSE2
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(OPAQUE_ALPHA));
+
+        for (; i + 4 <= pixel_count; i += 4) {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), _mm_or_si128(pixels, alpha));
+        }
+#elif PIXEL_USE_NEON
+        const uint32x4_t alpha = vdupq_n_u32(OPAQUE_ALPHA);
+
+        for (; i + 4 <= pixel_count; i += 4) {
+            const uint32x4_t pixels = vreinterpretq_u32_u8(vld1q_u8(source + i * 4));
+            vst1q_u32(dest + i, vorrq_u32(pixels, alpha));
+        }
+#endif
+
+        for (; i < pixel_count; i++) {
+            std::uint32_t pixel = 0;
+            std::memcpy(&pixel, source + i * 4, sizeof(std::uint32_t));
+
+            dest[i] = pixel | OPAQUE_ALPHA;
+        }
+    }
+
+#if PIXEL_USE_SSE2
+    // Multiply colour channels of 2 pixels, unpacked to 16-bit lanes, with their alpha
+    static inline __m128i premultiply_unpacked(const __m128i pixels) {
+        const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+        // Alpha lane gets multiplied with 255, so it stays the same
+        const __m128i factor = _mm_or_si128(_mm_and_si128(alpha, _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0)),
+            _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255));
+
+        const __m128i product = _mm_add_epi16(_mm_mullo_epi16(pixels, factor), _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+    }
+#endif
+
+#if PIXEL_USE_AVX2
+    static inline __m256i premultiply_unpacked_wide(const __m256i pixels) {
+        const __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        const __m256i factor = _mm256_or_si256(_mm256_and_si256(alpha, _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0)),
+            _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255));
+
+        const __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(pixels, factor), _mm256_set1_epi16(128));
+        return _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+    }
+#endif
+
+    static void premultiply_row(const std::uint8_t *source, std::uint32_t *dest, const std::size_t pixel_count) {
+        std::size_t i = 0;
+
+#if PIXEL_USE_AVX2
+        const __m256i zero_wide = _mm256_setzero_si256();
+
+        for (; i + 8 <= pixel_count; i += 8) {
+            const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i * 4));
+
+            // Unpack and pack both work inside 128-bit lanes, so the pixel order is kept
+            const __m256i lo = premultiply_unpacked_wide(_mm256_unpacklo_epi8(pixels, zero_wide));
+            const __m256i hi = premultiply_unpacked_wide(_mm256_unpackhi_epi8(pixels, zero_wide));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest + i), _mm256_packus_epi16(lo, hi));
+        }
+#endif
+
+#if PIXEL_USE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+
+        for (; i + 4 <= pixel_count; i += 4) {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 4));
+
+            const __m128i lo = premultiply_unpacked(_mm_unpacklo_epi8(pixels, zero));
+            const __m128i hi = premultiply_unpacked(_mm_unpackhi_epi8(pixels, zero));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), _mm_packus_epi16(lo, hi));
+        }
+#elif PIXEL_USE_NEON
+        for (; i + 8 <= pixel_count; i += 8) {
+            uint8x8x4_t pixels = vld4_u8(source + i * 4);
+
+            for (int c = 0; c < 3; c++) {
+                const uint16x8_t product = vmull_u8(pixels.val[c], pixels.val[3]);
+                pixels.val[c] = vrshrn_n_u16(vrsraq_n_u16(product, product, 8), 8);
+            }
+
+            vst4_u8(reinterpret_cast<std::uint8_t *>(dest + i), pixels);
+        }
+#endif
+
+        for (; i < pixel_count; i++) {
+            std::uint32_t pixel = 0;
+            std::memcpy(&pixel, source + i * 4, sizeof(std::uint32_t));
+
+            dest[i] = premultiply_pixel(pixel);
+        }
+    }
+
+    static void unpremultiply_row(const std::uint8_t *source, std::uint32_t *dest, const std::size_t pixel_count) {
+        // Needs a division per channel, which vector units do not have. Look them up instead.
+        const std::uint8_t *table = get_unpremultiply_table();
+
+        for (std::size_t i = 0; i < pixel_count; i++) {
+            std::uint32_t pixel = 0;
+            std::memcpy(&pixel, source + i * 4, sizeof(std::uint32_t));
+
+            dest[i] = unpremultiply_pixel(pixel, table);
+        }
+    }
+
+    void convert_row_to_argb8888(const pixel_format format, const std::uint8_t *source, std::uint32_t *dest,
+        const std::size_t pixel_count, const std::uint32_t *palette, const bool premultiplied) {
+        switch (format) {
+        case pixel_format::gray2: {
+            static const std::vector<std::uint32_t> table = make_packed_byte_table<1>([](const std::uint32_t value) {
+                return value ? 0xFFFFFFFF : OPAQUE_ALPHA;
+            });
+
+            convert_packed_row_with_table<1>(source, dest, pixel_count, table.data());
+            break;
+        }
+
+        case pixel_format::gray4: {
+            static const std::vector<std::uint32_t> table = make_packed_byte_table<2>([](const std::uint32_t value) {
+                return gray_to_argb(value * 0x55);
+            });
+
+            convert_packed_row_with_table<2>(source, dest, pixel_count, table.data());
+            break;
+        }
+
+        case pixel_format::gray16: {
+            static const std::vector<std::uint32_t> table = make_packed_byte_table<4>([](const std::uint32_t value) {
+                return gray_to_argb(value * 0x11);
+            });
+
+            convert_packed_row_with_table<4>(source, dest, pixel_count, table.data());
+            break;
+        }
+
+        case pixel_format::color16:
+            convert_packed_row<4>(source, dest, pixel_count, [palette](const std::uint32_t value) {
+                return palette[value];
+            });
+
+            break;
+
+        case pixel_format::gray256:
+            convert_row_gray256(source, dest, pixel_count);
+            break;
+
+        case pixel_format::color256:
+            convert_row_palette256(source, dest, pixel_count, palette);
+            break;
+
+        case pixel_format::color4k:
+            convert_row_16bit<false>(source, dest, pixel_count);
+            break;
+
+        case pixel_format::color64k:
+            convert_row_16bit<true>(source, dest, pixel_count);
+            break;
+
+        case pixel_format::color16m:
+            convert_row_color16m(source, dest, pixel_count);
+            break;
+
+        case pixel_format::color16mu:
+            convert_row_color16mu(source, dest, pixel_count);
+            break;
+
+        case pixel_format::color16ma:
+            if (premultiplied) {
+                premultiply_row(source, dest, pixel_count);
+            } else {
+                std::memmove(dest, source, pixel_count * sizeof(std::uint32_t));
+            }
+
+            break;
+
+        case pixel_format::color16map:
+            if (premultiplied) {
+                std::memmove(dest, source, pixel_count * sizeof(std::uint32_t));
+            } else {
+                unpremultiply_row(source, dest, pixel_count);
+            }
+
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    void convert_to_argb8888(const pixel_format format, const std::uint8_t *source, const std::size_t source_stride,
+        std::uint32_t *dest, const std::size_t dest_stride, const std::size_t width, const std::size_t height,
+        const std::uint32_t *palette, const bool premultiplied) {
+        for (std::size_t y = 0; y < height; y++) {
+            convert_row_to_argb8888(format, source + y * source_stride, dest + y * dest_stride, width, palette, premultiplied);
+        }
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common/log.h>
+#include <common/profiler.h>
+
+namespace eka2l1::common {
+#if ENABLE_PROFILING
+    profile_token get_profile_token(const char *group, const std::string &name, const std::uint32_t color) {
+        return MicroProfileGetToken(group, name.c_str(), color, MicroProfileTokenTypeCpu);
+    }
+
+    void init_profiler() {
+        MicroProfileInit();
+        MicroProfileSetEnableAllGroups(true);
+
+        LOG_INFO(COMMON, "Profiler enabled, recording all groups");
+    }
+
+    void shutdown_profiler() {
+        MicroProfileShutdown();
+    }
+
+    void profiler_register_thread(const char *name) {
+        MicroProfileOnThreadCreate(name);
+    }
+
+    void profiler_flip() {
+        MicroProfileFlip(nullptr);
+    }
+
+    bool is_profiler_available() {
+        return true;
+    }
+
+    bool dump_profiler_capture(const std::string &html_path, const std::string &csv_path) {
+        MicroProfileDumpFileImmediately(html_path.c_str(), csv_path.empty() ? nullptr : csv_path.c_str(), nullptr);
+        LOG_INFO(COMMON, "Profile capture written to {}", html_path);
+
+        return true;
+    }
+#else
+    profile_token get_profile_token(const char *group, const std::string &name, const std::uint32_t color) {
+        return 0;
+    }
+
+    void init_profiler() {
+    }
+
+    void shutdown_profiler() {
+    }
+
+    void profiler_register_thread(const char *name) {
+    }
+
+    void profiler_flip() {
+    }
+
+    bool is_profiler_available() {
+        return false;
+    }
+
+    bool dump_profiler_capture(const std::string &html_path, const std::string &csv_path) {
+        return false;
+    }
+#endif
+}
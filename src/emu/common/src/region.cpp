@@ -102,7 +102,10 @@ namespace eka2l1::common {
 
         std::size_t limit = rects_.size();
 
-        for (std::size_t i = 0; i < limit; i++) {
+        std::size_t i = 0;
+
+        // Pieces are pushed to the back, past the limit. They don't intersect the rectangle anymore
+        while (i < limit) {
             if ((rect.top == rects_[i].top) && (rect.size == rects_[i].size)) {
                 rects_.erase(rects_.begin() + i);
                 return;
@@ -138,7 +141,12 @@ namespace eka2l1::common {
                 }
 
                 limit--;
+
+                // Another rectangle has taken this slot, check it too
+                continue;
             }
+
+            i++;
         }
     }
 
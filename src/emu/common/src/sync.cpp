@@ -25,6 +25,8 @@
 #include <Windows.h>
 #endif
 
+#include <chrono>
+
 namespace eka2l1::common {
     semaphore::semaphore(const int initial)
         : count_(initial) {
@@ -233,4 +235,42 @@ namespace eka2l1::common {
     void event::reset() {
         return impl_->reset();
     }
-}
\ No newline at end of file
+
+    void counted_mutex::lock() {
+        if (!mut_.try_lock()) {
+            const auto wait_start = std::chrono::steady_clock::now();
+            mut_.lock();
+
+            contentions_.fetch_add(1, std::memory_order_relaxed);
+            wait_ns_.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - wait_start).count()), std::memory_order_relaxed);
+        }
+
+        acquires_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool counted_mutex::try_lock() {
+        if (!mut_.try_lock()) {
+            return false;
+        }
+
+        acquires_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    lock_stats counted_mutex::stats() const {
+        lock_stats result;
+
+        result.acquires_ = acquires_.load(std::memory_order_relaxed);
+        result.contentions_ = contentions_.load(std::memory_order_relaxed);
+        result.wait_ns_ = wait_ns_.load(std::memory_order_relaxed);
+
+        return result;
+    }
+
+    void counted_mutex::reset_stats() {
+        acquires_ = 0;
+        contentions_ = 0;
+        wait_ns_ = 0;
+    }
+}
@@ -23,6 +23,7 @@
 #include <windows.h>
 #else
 #include <pthread.h>
+#include <time.h>
 #endif
 
 #include <common/cvt.h>
@@ -54,6 +55,28 @@ namespace eka2l1::common {
 
         SetThreadPriority(handle, windows_priority);
     }
+
+    static std::uint64_t get_thread_times_us(HANDLE handle) {
+        FILETIME creation_time, exit_time, kernel_time, user_time;
+
+        if (!GetThreadTimes(handle, &creation_time, &exit_time, &kernel_time, &user_time)) {
+            return 0;
+        }
+
+        // Both are in 100 nanoseconds unit
+        const std::uint64_t kernel_ticks = (static_cast<std::uint64_t>(kernel_time.dwHighDateTime) << 32) | kernel_time.dwLowDateTime;
+        const std::uint64_t user_ticks = (static_cast<std::uint64_t>(user_time.dwHighDateTime) << 32) | user_time.dwLowDateTime;
+
+        return (kernel_ticks + user_ticks) / 10;
+    }
+
+    std::uint64_t get_thread_cpu_time_us() {
+        return get_thread_times_us(GetCurrentThread());
+    }
+
+    std::uint64_t get_thread_cpu_time_us(std::thread &thr) {
+        return get_thread_times_us(static_cast<HANDLE>(thr.native_handle()));
+    }
     
 #if defined(_MSC_VER)
     static constexpr const DWORD MS_VC_EXCEPTION = 0x406D1388;
@@ -137,5 +160,34 @@ namespace eka2l1::common {
 
         pthread_setschedparam(this_thread, SCHED_OTHER, &params);
     }
+
+    static std::uint64_t get_clock_time_us(const clockid_t clock) {
+        struct timespec spec;
+
+        if (clock_gettime(clock, &spec) != 0) {
+            return 0;
+        }
+
+        return static_cast<std::uint64_t>(spec.tv_sec) * 1000000 + spec.tv_nsec / 1000;
+    }
+
+    std::uint64_t get_thread_cpu_time_us() {
+        return get_clock_time_us(CLOCK_THREAD_CPUTIME_ID);
+    }
+
+    std::uint64_t get_thread_cpu_time_us(std::thread &thr) {
+#if EKA2L1_PLATFORM(DARWIN)
+        // No CPU clock of other threads here
+        return 0;
+#else
+        clockid_t clock;
+
+        if (pthread_getcpuclockid(thr.native_handle(), &clock) != 0) {
+            return 0;
+        }
+
+        return get_clock_time_us(clock);
+#endif
+    }
 #endif
 }
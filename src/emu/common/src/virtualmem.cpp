@@ -21,6 +21,9 @@
 #include <common/platform.h>
 #include <common/virtualmem.h>
 
+#include <map>
+#include <mutex>
+
 #if EKA2L1_PLATFORM(WIN32)
 #include <Windows.h>
 #elif EKA2L1_PLATFORM(UNIX) || EKA2L1_PLATFORM(DARWIN)
@@ -31,7 +34,55 @@
 #include <unistd.h>
 #endif
 
+#if EKA2L1_PLATFORM(UNIX)
+#include <sys/syscall.h>
+#endif
+
 namespace eka2l1::common {
+#if EKA2L1_PLATFORM(POSIX)
+    struct shareable_region {
+        std::size_t size_;
+        int fd_;
+    };
+
+    // Key is the base address of the region
+    static std::map<std::uint8_t *, shareable_region> shareable_regions;
+    static std::mutex shareable_regions_lock;
+
+    static int create_anonymous_shared_file(const std::size_t size) {
+        int fd = -1;
+
+#if EKA2L1_PLATFORM(UNIX) && defined(SYS_memfd_create)
+        fd = static_cast<int>(syscall(SYS_memfd_create, "eka2l1-shareable", 0));
+#endif
+
+#if !EKA2L1_PLATFORM(ANDROID)
+        if (fd == -1) {
+            // Fallback to POSIX shared memory. Unlink immediately so only the descriptor keeps it alive
+            const std::string shm_name = "/eka2l1-shareable-" + std::to_string(getpid());
+            fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+            if (fd == -1) {
+                return -1;
+            }
+
+            shm_unlink(shm_name.c_str());
+        }
+#endif
+
+        if (fd == -1) {
+            return -1;
+        }
+
+        if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+#endif
+
     void *map_memory(const std::size_t size) {
 #if EKA2L1_PLATFORM(WIN32)
         return VirtualAlloc(nullptr, size,
@@ -42,7 +93,85 @@ namespace eka2l1::common {
 #endif
     }
 
+    void *map_memory_shareable(const std::size_t size) {
+#if EKA2L1_PLATFORM(POSIX)
+        const int fd = create_anonymous_shared_file(size);
+
+        if (fd == -1) {
+            return nullptr;
+        }
+
+        void *result = mmap(nullptr, size, PROT_NONE, MAP_SHARED, fd, 0);
+
+        if (result == MAP_FAILED) {
+            close(fd);
+            return nullptr;
+        }
+
+        const std::lock_guard<std::mutex> guard(shareable_regions_lock);
+        shareable_regions.emplace(reinterpret_cast<std::uint8_t *>(result), shareable_region{ size, fd });
+
+        return result;
+#else
+        // Aliasing reserved memory needs placeholder support, which we don't use yet. Regions
+        // allocated here can't be aliased, and map_alias will report failure.
+        return map_memory(size);
+#endif
+    }
+
+    bool map_alias(void *dest, void *source, const std::size_t size, const prot perm) {
+#if EKA2L1_PLATFORM(POSIX)
+        std::uint8_t *source_ptr = reinterpret_cast<std::uint8_t *>(source);
+        int fd = -1;
+        off_t offset = 0;
+
+        {
+            const std::lock_guard<std::mutex> guard(shareable_regions_lock);
+            auto ite = shareable_regions.upper_bound(source_ptr);
+
+            if (ite == shareable_regions.begin()) {
+                return false;
+            }
+
+            ite--;
+
+            if (source_ptr + size > ite->first + ite->second.size_) {
+                return false;
+            }
+
+            fd = ite->second.fd_;
+            offset = static_cast<off_t>(source_ptr - ite->first);
+        }
+
+        void *result = mmap(dest, size, translate_protection(perm), MAP_SHARED | MAP_FIXED, fd, offset);
+        return (result != MAP_FAILED);
+#else
+        return false;
+#endif
+    }
+
+    bool unmap_alias(void *dest, const std::size_t size) {
+#if EKA2L1_PLATFORM(POSIX)
+        void *result = mmap(dest, size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED, -1, 0);
+        return (result != MAP_FAILED);
+#else
+        return false;
+#endif
+    }
+
     bool unmap_memory(void *ptr, const std::size_t size) {
+#if EKA2L1_PLATFORM(POSIX)
+        {
+            const std::lock_guard<std::mutex> guard(shareable_regions_lock);
+            auto ite = shareable_regions.find(reinterpret_cast<std::uint8_t *>(ptr));
+
+            if (ite != shareable_regions.end()) {
+                close(ite->second.fd_);
+                shareable_regions.erase(ite);
+            }
+        }
+#endif
+
 #if EKA2L1_PLATFORM(WIN32)
         const auto result = VirtualFree(ptr, 0, MEM_RELEASE);
 
@@ -131,7 +260,8 @@ namespace eka2l1::common {
 #endif
     }
 
-    void *map_file(const std::string &file_name, const prot perm, const std::size_t size, const bool is_private) {
+    void *map_file(const std::string &file_name, const prot perm, const std::size_t size, const bool is_private,
+        std::size_t *mapped_size) {
 #if EKA2L1_PLATFORM(WIN32)
         DWORD desired_access = 0;
         DWORD share_mode = 0;
@@ -144,7 +274,7 @@ namespace eka2l1::common {
             desired_access = GENERIC_READ;
             share_mode = FILE_SHARE_READ;
             page_type = PAGE_READONLY;
-            open_type = OPEN_ALWAYS;
+            open_type = OPEN_EXISTING;
             map_type = FILE_MAP_READ;
 
             break;
@@ -194,14 +324,24 @@ namespace eka2l1::common {
             map_size = (static_cast<std::size_t>(size_high) << 32) | size_low;
         }
 
+        if (map_size == 0) {
+            // Empty files can't be mapped
+            CloseHandle(file_handle);
+            return nullptr;
+        }
+
         HANDLE map_file_handle = CreateFileMappingA(file_handle, NULL, page_type,
             map_size >> 32, static_cast<DWORD>(map_size), NULL);
 
+        // The view keeps the mapping alive
+        CloseHandle(file_handle);
+
         if (!map_file_handle || map_file_handle == INVALID_HANDLE_VALUE) {
             return nullptr;
         }
 
         auto map_ptr = MapViewOfFile(map_file_handle, map_type, 0, 0, 0);
+        CloseHandle(map_file_handle);
 #else
         int open_mode = 0;
         const int prot_mode = translate_protection(perm);
@@ -237,22 +377,43 @@ namespace eka2l1::common {
 
         if (perm == prot::read || (perm == prot::read_write && size == 0)) {
             struct stat file_stat;
-            stat(file_name.c_str(), &file_stat);
+
+            if (fstat(file_handle, &file_stat) == -1) {
+                close(file_handle);
+                return nullptr;
+            }
 
             map_size = file_stat.st_size;
         }
 
+        if (map_size == 0) {
+            // Empty files can't be mapped
+            close(file_handle);
+            return nullptr;
+        }
+
         auto map_ptr = mmap(nullptr, map_size, prot_mode, MAP_PRIVATE, file_handle, 0);
+
+        // The mapping keeps a reference to the file by itself
+        close(file_handle);
+
+        if (map_ptr == MAP_FAILED) {
+            return nullptr;
+        }
 #endif
 
+        if (map_ptr && mapped_size) {
+            *mapped_size = map_size;
+        }
+
         return map_ptr;
     }
 
-    bool unmap_file(void *ptr) {
+    bool unmap_file(void *ptr, const std::size_t size) {
 #if EKA2L1_PLATFORM(WIN32)
-        UnmapViewOfFile(ptr);
+        return UnmapViewOfFile(ptr);
+#else
+        return (munmap(ptr, size) == 0);
 #endif
-
-        return true;
     }
 }
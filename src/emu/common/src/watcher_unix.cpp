@@ -20,11 +20,23 @@
 #include "watcher_unix.h"
 #include <common/log.h>
 
+#include <algorithm>
+
+#include <dirent.h>
+#include <poll.h>
 #include <sys/inotify.h>
+#include <sys/stat.h>
 
 namespace eka2l1::common {
     static constexpr std::size_t EVENT_MAX_SIZE = sizeof(struct inotify_event) + 16;
 
+    // Directory creation and moves are always needed, to keep watching new subdirectories
+    static constexpr std::uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO;
+
+    static std::string join_relative_path(const std::string &relative_path, const std::string &name) {
+        return relative_path.empty() ? name : (relative_path + '/' + name);
+    }
+
     directory_watcher_impl::directory_watcher_impl()
         : should_stop(false) {
         instance_ = inotify_init();
@@ -39,96 +51,255 @@ namespace eka2l1::common {
 
         wait_thread_ = std::make_unique<std::thread>([this]() {
             std::vector<directory_change> changes;
+            int changes_handle = -1;
+
+            auto flush_changes = [&]() {
+                if (changes.empty()) {
+                    return;
+                }
 
-            auto flush_changes = [&](const int wd) {
-                // Flush changes
-                auto ite = std::find(container_.begin(), container_.end(), wd);
+                directory_watcher_callback_pair callback_pair;
 
-                if (ite != container_.end()) {
-                    auto &callback = callbacks_[std::distance(container_.begin(), ite)];
-                    callback.callback_pair_.first(callback.callback_pair_.second, changes);
+                {
+                    const std::lock_guard<std::mutex> guard(lock_);
+                    auto ite = std::find(container_.begin(), container_.end(), changes_handle);
 
-                    changes.clear();
+                    if (ite == container_.end()) {
+                        // Unwatched while the events were on the way
+                        changes.clear();
+                        return;
+                    }
+
+                    callback_pair = callbacks_[std::distance(container_.begin(), ite)].callback_pair_;
                 }
+
+                // Callbacks may watch or unwatch, don't hold the lock
+                callback_pair.first(callback_pair.second, changes);
+                changes.clear();
+            };
+
+            auto add_change = [&](const int handle, const std::string &filename, const std::uint32_t action) {
+                if (handle != changes_handle) {
+                    flush_changes();
+                    changes_handle = handle;
+                }
+
+                directory_change change;
+                change.filename_ = filename;
+                change.change_ = action;
+
+                changes.push_back(change);
             };
 
             while (!should_stop) {
+                // Wake up once in a while, so the watcher can stop even when there is nothing being watched
+                struct pollfd poll_fd = { instance_, POLLIN, 0 };
+
+                if (poll(&poll_fd, 1, 200) <= 0) {
+                    continue;
+                }
+
                 const ssize_t length = read(instance_, &events_[0], events_.size());
 
                 if (length == -1) {
                     LOG_ERROR(COMMON, "Error reading notify event!");
                     should_stop = true;
+
+                    break;
                 }
 
                 std::size_t i = 0;
 
-                int last_wd = -1;
-
                 // Parse all event
                 while (i < length) {
                     struct inotify_event *evt = reinterpret_cast<struct inotify_event *>(&events_[i]);
+                    i += evt->len + sizeof(struct inotify_event);
+
+                    if (evt->mask & IN_Q_OVERFLOW) {
+                        // Some events were dropped, we don't know where. Tell every watch something changed.
+                        std::vector<int> handles;
 
-                    directory_change change;
-                    change.change_ = 0;
-                    change.filename_.assign(evt->name, evt->name + evt->len);
+                        {
+                            const std::lock_guard<std::mutex> guard(lock_);
+                            handles = container_;
+                        }
 
-                    // Remove null terminated characters
-                    change.filename_.erase(std::find(change.filename_.begin(), change.filename_.end(), '\0'),
-                        change.filename_.end());
+                        for (const int handle : handles) {
+                            add_change(handle, "", directory_change_action_modified);
+                        }
+
+                        continue;
+                    }
+
+                    std::string name(evt->name, std::find(evt->name, evt->name + evt->len, '\0'));
+
+                    std::uint32_t action = 0;
 
                     if (evt->mask & IN_MOVED_FROM) {
-                        change.change_ |= directory_change_action_moved_from;
+                        action |= directory_change_action_moved_from;
                     }
 
                     if (evt->mask & IN_MOVED_TO) {
-                        change.change_ |= directory_change_action_moved_to;
+                        action |= directory_change_action_moved_to;
                     }
 
-                    if (evt->mask & IN_MODIFY) {
-                        change.change_ |= directory_change_action_modified;
+                    if (evt->mask & (IN_MODIFY | IN_ATTRIB)) {
+                        action |= directory_change_action_modified;
                     }
 
                     if (evt->mask & IN_CREATE) {
-                        change.change_ |= directory_change_action_created;
+                        action |= directory_change_action_created;
                     }
 
                     if (evt->mask & IN_DELETE) {
-                        change.change_ |= directory_change_action_delete;
+                        action |= directory_change_action_delete;
                     }
 
-                    if (evt->mask & IN_ATTRIB) {
-                        change.change_ |= directory_change_action_modified;
-                    }
+                    // A directory can be in more than one watched tree
+                    std::vector<std::pair<int, std::string>> targets;
+
+                    {
+                        const std::lock_guard<std::mutex> guard(lock_);
+                        auto sub_ite = sub_watches_.find(evt->wd);
+
+                        if (sub_ite == sub_watches_.end()) {
+                            continue;
+                        }
+
+                        if (evt->mask & IN_IGNORED) {
+                            // The directory is gone, and so is its watch
+                            sub_watches_.erase(sub_ite);
+                            continue;
+                        }
+
+                        const std::vector<sub_watch> owners = sub_ite->second;
+
+                        for (const sub_watch &owner : owners) {
+                            const std::string relative_name = join_relative_path(owner.relative_path_, name);
 
-                    changes.push_back(change);
+                            if (evt->mask & IN_ISDIR) {
+                                if (evt->mask & IN_MOVED_FROM) {
+                                    remove_sub_watches(owner.root_, relative_name);
+                                }
 
-                    if ((last_wd != -1) && (last_wd != evt->wd)) {
-                        flush_changes(evt->wd);
+                                if (evt->mask & (IN_CREATE | IN_MOVED_TO)) {
+                                    add_sub_watches(owner.root_, owner.path_ + '/' + name, relative_name);
+                                }
+                            }
+
+                            auto root_ite = std::find(container_.begin(), container_.end(), owner.root_);
+
+                            if ((root_ite != container_.end()) && (callbacks_[std::distance(container_.begin(), root_ite)].filters_ & evt->mask)) {
+                                targets.emplace_back(owner.root_, relative_name);
+                            }
+                        }
                     }
 
-                    last_wd = evt->wd;
-                    i += evt->len + sizeof(struct inotify_event);
+                    for (auto &[handle, filename] : targets) {
+                        add_change(handle, filename, action);
+                    }
                 }
 
-                if (changes.size() != 0) {
-                    flush_changes(last_wd);
-                }
+                flush_changes();
             }
         });
     }
 
     directory_watcher_impl::~directory_watcher_impl() {
-        for (auto &wd : container_) {
-            inotify_rm_watch(instance_, wd);
+        if (instance_ == -1) {
+            return;
         }
 
         should_stop = true;
         wait_thread_->join();
 
+        for (auto &[wd, owners] : sub_watches_) {
+            inotify_rm_watch(instance_, wd);
+        }
+
         close(instance_);
     }
 
+    bool directory_watcher_impl::add_sub_watches(const int root, const std::string &folder, const std::string &relative_path) {
+        const int wd = inotify_add_watch(instance_, folder.c_str(), WATCH_MASK);
+
+        if (wd == -1) {
+            LOG_WARN(COMMON, "Unable to watch directory {}, changes in it will not be noticed", folder);
+            return false;
+        }
+
+        std::vector<sub_watch> &owners = sub_watches_[wd];
+        auto owner_ite = std::find_if(owners.begin(), owners.end(), [root](const sub_watch &owner) {
+            return owner.root_ == root;
+        });
+
+        if (owner_ite != owners.end()) {
+            // Moved inside the tree, the watch stays but the path changed
+            owner_ite->path_ = folder;
+            owner_ite->relative_path_ = relative_path;
+        } else {
+            owners.push_back({ root, folder, relative_path });
+        }
+
+        DIR *dir = opendir(folder.c_str());
+
+        if (!dir) {
+            // Removed before we got to it
+            return true;
+        }
+
+        bool result = true;
+
+        while (struct dirent *entry = readdir(dir)) {
+            const std::string name = entry->d_name;
+
+            if ((name == ".") || (name == "..")) {
+                continue;
+            }
+
+            const std::string sub_folder = folder + '/' + name;
+            bool is_dir = (entry->d_type == DT_DIR);
+
+            if (entry->d_type == DT_UNKNOWN) {
+                struct stat sub_stat;
+                is_dir = (lstat(sub_folder.c_str(), &sub_stat) == 0) && S_ISDIR(sub_stat.st_mode);
+            }
+
+            if (is_dir && !add_sub_watches(root, sub_folder, join_relative_path(relative_path, name))) {
+                result = false;
+            }
+        }
+
+        closedir(dir);
+        return result;
+    }
+
+    void directory_watcher_impl::remove_sub_watches(const int root, const std::string &relative_path) {
+        for (auto ite = sub_watches_.begin(); ite != sub_watches_.end();) {
+            std::vector<sub_watch> &owners = ite->second;
+
+            owners.erase(std::remove_if(owners.begin(), owners.end(), [&](const sub_watch &owner) {
+                if (owner.root_ != root) {
+                    return false;
+                }
+
+                // Everything of the watch when no path is given, else the directory and what is under it
+                return relative_path.empty() || (owner.relative_path_ == relative_path)
+                    || (owner.relative_path_.compare(0, relative_path.size() + 1, relative_path + '/') == 0);
+            }), owners.end());
+
+            if (owners.empty()) {
+                inotify_rm_watch(instance_, ite->first);
+                ite = sub_watches_.erase(ite);
+            } else {
+                ite++;
+            }
+        }
+    }
+
     bool directory_watcher_impl::unwatch(const std::int32_t watch_handle) {
+        const std::lock_guard<std::mutex> guard(lock_);
+
         // Find in container
         auto ite = std::find(container_.begin(), container_.end(), watch_handle);
 
@@ -141,12 +312,7 @@ namespace eka2l1::common {
         callbacks_.erase(callback_ite);
         container_.erase(ite);
 
-        const bool remove_result = (inotify_rm_watch(instance_, watch_handle) != -1);
-
-        if (!remove_result) {
-            LOG_WARN(COMMON, "Can not removing watch from inotify!");
-        }
-
+        remove_sub_watches(watch_handle, "");
         return true;
     }
 
@@ -174,16 +340,27 @@ namespace eka2l1::common {
 
     std::int32_t directory_watcher_impl::watch(const std::string &folder, directory_watcher_callback callback,
         void *callback_userdata, const std::uint32_t mask) {
-        const int wd_handle = inotify_add_watch(instance_, folder.c_str(), IN_CREATE | IN_DELETE | IN_MODIFY);
+        const std::lock_guard<std::mutex> guard(lock_);
+        const std::int32_t handle = next_handle_++;
+
+        // Watch the whole tree, like the other platforms do. A partly watched tree would miss changes
+        // silently, so fail instead.
+        std::string root_folder = folder;
+
+        while ((root_folder.size() > 1) && (root_folder.back() == '/')) {
+            root_folder.pop_back();
+        }
+
+        if (!add_sub_watches(handle, root_folder, "")) {
+            LOG_ERROR(COMMON, "Error creating new inotify watch for {}!", folder);
+            remove_sub_watches(handle, "");
 
-        if (wd_handle == -1) {
-            LOG_ERROR(COMMON, "Error creating new inotify watch!");
             return 0;
         }
 
-        container_.push_back(wd_handle);
+        container_.push_back(handle);
         callbacks_.emplace_back(callback, callback_userdata, convert_to_unix_notify_mask(mask));
 
-        return wd_handle;
+        return handle;
     }
-}
\ No newline at end of file
+}
@@ -25,7 +25,9 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <sys/eventfd.h>
@@ -45,8 +47,22 @@ namespace eka2l1::common {
         std::vector<int> container_;
         std::vector<directory_watcher_data> callbacks_;
 
+        // inotify is not recursive. Every directory in a watched tree has its own inotify watch, which maps to
+        // the handle of each tree it is in, and its path relative to the tree's root.
+        struct sub_watch {
+            int root_;
+            std::string path_;
+            std::string relative_path_;
+        };
+
+        std::unordered_map<int, std::vector<sub_watch>> sub_watches_;
+        std::int32_t next_handle_ = 1;
+
         std::mutex lock_;
 
+        bool add_sub_watches(const int root, const std::string &folder, const std::string &relative_path);
+        void remove_sub_watches(const int root, const std::string &relative_path);
+
     public:
         explicit directory_watcher_impl();
         ~directory_watcher_impl();
@@ -55,11 +55,14 @@ namespace eka2l1::config {
         bool log_read{ false };
         bool log_write{ false };
         bool log_svc{ false };
+        bool profile_svc{ false };
         bool log_ipc{ false };
         bool log_passed{ false };
         bool log_exports{ false };
 
         std::string cpu_backend{ "dynarmic" };
+        bool fastmem{ false };
+        int cpu_core_count{ 1 };
         int device{ 0 };
         int language{ -1 };
         int emulator_language{ -1 };
@@ -85,6 +88,7 @@ namespace eka2l1::config {
         bool fbs_enable_compression_queue{ false };
         bool accurate_ipc_timing{ false };
         bool enable_btrace{ false };
+        std::vector<int> btrace_categories; ///< Categories to trace. Empty traces every category.
 
         bool stop_warn_touch_disabled { false };
         bool dump_imb_range_code { false };
@@ -29,9 +29,12 @@ OPTION(log-read, log_read, false)
 OPTION(log-write, log_write, false)
 OPTION(log-ipc, log_ipc, false)
 OPTION(log-svc, log_svc, false)
+OPTION(profile-svc, profile_svc, false)
 OPTION(log-passed, log_passed, false)
 OPTION(log-exports, log_exports, false)
 OPTION(cpu, cpu_backend, 0)
+OPTION(fastmem, fastmem, false)
+OPTION(cpu-core-count, cpu_core_count, 1)
 OPTION(device, device, 0)
 OPTION(language, language, -1)
 OPTION(emulator-language, emulator_language, -1)
@@ -53,6 +56,7 @@ OPTION(enable-srv-socket, enable_srv_socket, false)
 OPTION(fbs-enable-compression-queue, fbs_enable_compression_queue, false)
 OPTION(accurate-ipc-timing, accurate_ipc_timing, false)
 OPTION(enable-btrace, enable_btrace, false)
+OPTION(btrace-categories, btrace_categories, std::vector<int>())
 OPTION(stop-warn-touchscreen-disabled, stop_warn_touch_disabled, false)
 OPTION(dump-imb-range-code, dump_imb_range_code, false)
 OPTION(hide-mouse-in-screen-space, hide_mouse_in_screen_space, false)
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <drivers/input/common.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace eka2l1::desktop {
+    struct emulator;
+
+    /**
+     * \brief An input event to send to the guest at a given emulated time.
+     */
+    struct bench_input {
+        std::uint64_t time_us_;
+        drivers::input_event evt_;
+    };
+
+    /**
+     * \brief Parse a benchmark input script.
+     *
+     * Each line is an event, in the form "<emulated time in ms> <action> <arguments>". Empty lines
+     * and lines starting with # are skipped. Actions are:
+     *
+     * - key_down <key>, key_up <key>: Key code is the host key code, mapped by the key binds in config.
+     * - touch_down <x> <y>, touch_move <x> <y>, touch_up <x> <y>: Position is in screen pixels.
+     *
+     * \param content The script.
+     * \param inputs  Receive the events, sorted by time.
+     * \param err     Set to the reason of the failure.
+     *
+     * \returns True on success.
+     */
+    bool parse_bench_input_script(const std::string &content, std::vector<bench_input> &inputs, std::string *err);
+
+    /**
+     * \brief Entry to the benchmark runner.
+     *
+     * Boots the emulator headless, launches one app, feeds it scripted input and stops after
+     * a fixed amount of emulated time. Emulated time is counted from retired guest instructions at
+     * the emulated clock rate. The OS thread checks it between guest time slices, which is where inputs
+     * are sent and where the run stops, so neither depends on how fast frames are presented. Guest timers
+     * still follow the host clock, so the work done is close but not identical between hosts.
+     * Throughput is written to a JSON report.
+     *
+     * \param state State of the emulator.
+     */
+    int bench_entry(emulator &state, const int argc, const char **argv);
+}
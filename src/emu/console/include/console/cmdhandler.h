@@ -26,6 +26,21 @@ namespace eka2l1::common {
     class arg_parser;
 }
 
+namespace eka2l1::desktop {
+    struct emulator;
+}
+
+/**
+ * \brief Launch an app the same way the --run option does.
+ *
+ * \param specifier  UID starting with 0x, app caption or absolute virtual path to an executable.
+ * \param cmdline    Extra command line passed to the app.
+ * \param err        Set to the reason of the failure.
+ *
+ * \returns True on success.
+ */
+bool launch_app_from_specifier(eka2l1::desktop::emulator *emu, const std::string &specifier, const std::string &cmdline, std::string *err);
+
 bool app_install_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err);
 bool package_remove_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err);
 bool app_specifier_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err);
@@ -34,6 +49,8 @@ bool rpkg_unpack_option_handler(eka2l1::common::arg_parser *parser, void *userda
 bool list_app_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err);
 bool list_devices_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err);
 bool fullscreen_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err);
+bool headless_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err);
+bool profile_capture_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err);
 
 #if ENABLE_SCRIPTING
 bool python_docgen_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err);
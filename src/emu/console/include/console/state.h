@@ -21,6 +21,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -76,9 +77,15 @@ namespace eka2l1::desktop {
 
         bool first_time;
         bool init_fullscreen;
+        bool headless;
+        std::string profile_capture_path;
 
         common::semaphore graphics_sema;
         common::event init_event;
+        common::event os_thread_done_event;
+
+        // Called by the OS thread between guest time slices. Returns false to stop the emulator.
+        std::function<bool()> os_loop_hook;
 
         config::state conf;
         window_server *winserv;
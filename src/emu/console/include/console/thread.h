@@ -19,9 +19,20 @@
 
 #pragma once
 
+#include <functional>
+#include <thread>
+
 namespace eka2l1::desktop {
     struct emulator;
 
+    /**
+     * \brief Called by the headless loop before presenting each frame.
+     *
+     * \param driver_thread Host thread running the graphics driver.
+     * \returns False to shut down the emulator.
+     */
+    using headless_frame_callback = std::function<bool(std::thread &driver_thread)>;
+
     /**
      * \brief Entry point to the graphics driver thread.
      * \param state Emulator state.
@@ -43,6 +54,17 @@ namespace eka2l1::desktop {
      */
     void os_thread(emulator &state);
 
+    /**
+     * \brief Run the emulator without any window, drawing with the software graphics driver.
+     *
+     * The caller thread presents screens to memory at a steady rate until the OS thread ends,
+     * or until the process is asked to stop.
+     *
+     * \param state          Emulator state. The OS thread must already be running.
+     * \param frame_callback Optional hook called on the caller thread every frame.
+     */
+    void headless_main_loop(emulator &state, headless_frame_callback frame_callback = nullptr);
+
     /**
      * @brief Entry to emulator.
      *
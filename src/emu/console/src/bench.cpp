@@ -0,0 +1,441 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common/algorithm.h>
+#include <common/arghandler.h>
+#include <common/log.h>
+#include <common/path.h>
+#include <common/pystr.h>
+#include <common/thread.h>
+#include <console/bench.h>
+#include <console/cmdhandler.h>
+#include <console/state.h>
+#include <console/thread.h>
+
+#include <kernel/kernel.h>
+#include <kernel/timing.h>
+#include <services/window/screen.h>
+#include <services/window/window.h>
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace eka2l1::desktop {
+    struct bench_options {
+        std::string app_;
+        std::string app_cmdline_;
+        std::string input_path_;
+        std::string report_path_ = "bench_report.json";
+        std::uint64_t emulated_time_us_ = 30000000;
+        int device_ = -1;
+        bool show_help_ = false;
+    };
+
+    struct bench_thread_time {
+        std::string name_;
+        std::uint64_t cpu_us_;
+    };
+
+    struct bench_sample {
+        kernel_statistics stats_;
+        std::uint64_t emulated_us_ = 0;
+        std::uint64_t frames_composed_ = 0;
+        std::chrono::steady_clock::time_point host_time_;
+        std::vector<bench_thread_time> threads_;
+    };
+
+    // Retired instructions at the emulated clock rate, as if each took one cycle. Unlike the timer, this
+    // does not depend on how fast the host is, so inputs land at the same point of guest work every run.
+    static std::uint64_t get_emulated_time_us(emulator &state) {
+        const std::uint64_t instructions = state.symsys->get_kernel_system()->get_statistics().instructions_retired_;
+        return instructions / common::max<std::uint32_t>(state.symsys->get_ntimer()->get_clock_frequency_mhz(), 1);
+    }
+
+    // Guest counters and the emulation threads, taken on the OS thread between time slices
+    static bench_sample take_bench_sample(emulator &state, std::thread &os_thread) {
+        bench_sample sample;
+        kernel_system *kern = state.symsys->get_kernel_system();
+
+        kern->lock();
+
+        sample.stats_ = kern->get_statistics();
+        sample.emulated_us_ = get_emulated_time_us(state);
+
+        if (state.winserv) {
+            for (epoc::screen *scr = state.winserv->get_screens(); scr; scr = scr->next) {
+                sample.frames_composed_ += scr->total_compositions;
+            }
+        }
+
+        kern->unlock();
+
+        sample.host_time_ = std::chrono::steady_clock::now();
+        sample.threads_.push_back({ "Symbian OS thread (core 0)", common::get_thread_cpu_time_us(os_thread) });
+
+        const std::vector<std::uint64_t> core_times = state.symsys->get_secondary_core_cpu_times();
+
+        for (std::size_t i = 0; i < core_times.size(); i++) {
+            sample.threads_.push_back({ "Core " + std::to_string(i + 1) + " thread", core_times[i] });
+        }
+
+        return sample;
+    }
+
+    // Taken on the present thread, which only knows of the driver thread
+    static std::vector<bench_thread_time> take_host_thread_times(std::thread &driver_thread) {
+        return {
+            { "Graphics thread", common::get_thread_cpu_time_us(driver_thread) },
+            { "Present thread", common::get_thread_cpu_time_us() }
+        };
+    }
+
+    static double per_second(const std::uint64_t count, const std::uint64_t duration_us) {
+        if (duration_us == 0) {
+            return 0.0;
+        }
+
+        return static_cast<double>(count) * 1000000.0 / static_cast<double>(duration_us);
+    }
+
+    static std::uint64_t get_thread_time_since(const bench_sample &start, const std::string &name, const std::uint64_t end_time) {
+        // Secondary cores may have started after the first sample
+        for (const bench_thread_time &thr : start.threads_) {
+            if (thr.name_ == name) {
+                return end_time - std::min(thr.cpu_us_, end_time);
+            }
+        }
+
+        return end_time;
+    }
+
+    static bool write_bench_report(const bench_options &options, const bench_sample &start, const bench_sample &end) {
+        const std::uint64_t emulated_us = end.emulated_us_ - start.emulated_us_;
+        const std::uint64_t host_us = std::chrono::duration_cast<std::chrono::microseconds>(end.host_time_ - start.host_time_).count();
+
+        const std::uint64_t instructions = end.stats_.instructions_retired_ - start.stats_.instructions_retired_;
+        const std::uint64_t svcs = end.stats_.svc_calls_ - start.stats_.svc_calls_;
+        const std::uint64_t ipc_messages = end.stats_.ipc_messages_ - start.stats_.ipc_messages_;
+        const std::uint64_t context_switches = end.stats_.context_switches_ - start.stats_.context_switches_;
+        const std::uint64_t frames = end.frames_composed_ - start.frames_composed_;
+
+        // Flow collections with quoted strings make the YAML output plain JSON
+        YAML::Emitter emitter;
+        emitter.SetMapFormat(YAML::Flow);
+        emitter.SetSeqFormat(YAML::Flow);
+        emitter.SetStringFormat(YAML::DoubleQuoted);
+
+        emitter << YAML::BeginMap;
+        emitter << YAML::Key << "app" << YAML::Value << options.app_;
+        emitter << YAML::Key << "emulated_time_us" << YAML::Value << emulated_us;
+        emitter << YAML::Key << "host_time_us" << YAML::Value << host_us;
+        emitter << YAML::Key << "instructions_retired" << YAML::Value << instructions;
+        emitter << YAML::Key << "instructions_per_second" << YAML::Value << per_second(instructions, host_us);
+        emitter << YAML::Key << "svc_calls" << YAML::Value << svcs;
+        emitter << YAML::Key << "svc_calls_per_second" << YAML::Value << per_second(svcs, host_us);
+        emitter << YAML::Key << "ipc_messages" << YAML::Value << ipc_messages;
+        emitter << YAML::Key << "ipc_messages_per_second" << YAML::Value << per_second(ipc_messages, host_us);
+        emitter << YAML::Key << "context_switches" << YAML::Value << context_switches;
+        emitter << YAML::Key << "frames_composed" << YAML::Value << frames;
+        emitter << YAML::Key << "frames_per_emulated_second" << YAML::Value << per_second(frames, emulated_us);
+
+        emitter << YAML::Key << "threads" << YAML::Value << YAML::BeginSeq;
+
+        for (const bench_thread_time &thr : end.threads_) {
+            emitter << YAML::BeginMap;
+            emitter << YAML::Key << "name" << YAML::Value << thr.name_;
+            emitter << YAML::Key << "cpu_time_us" << YAML::Value << get_thread_time_since(start, thr.name_, thr.cpu_us_);
+            emitter << YAML::EndMap;
+        }
+
+        emitter << YAML::EndSeq;
+        emitter << YAML::EndMap;
+
+        std::ofstream report(options.report_path_);
+
+        if (!report) {
+            LOG_ERROR(FRONTEND_CMDLINE, "Unable to open benchmark report file {}", options.report_path_);
+            return false;
+        }
+
+        report << emitter.c_str() << std::endl;
+
+        LOG_INFO(FRONTEND_CMDLINE, "Benchmark done: {} instructions, {} SVCs, {} IPC messages, {} frames in {} emulated ms ({} host ms)",
+            instructions, svcs, ipc_messages, frames, emulated_us / 1000, host_us / 1000);
+
+        return true;
+    }
+
+    static bool parse_bench_options(const int argc, const char **argv, bench_options &options, std::string *err) {
+        common::arg_parser parser(argc, argv);
+
+        parser.add("--help, --h", "Display helps menu", [](common::arg_parser *parser, void *userdata, std::string *err) {
+            reinterpret_cast<bench_options *>(userdata)->show_help_ = true;
+            std::cout << parser->get_help_string();
+
+            return false;
+        });
+
+        parser.add("--app, --a, --run", "App to benchmark, given as with the emulator's --run option. Required.",
+            [](common::arg_parser *parser, void *userdata, std::string *err) {
+                bench_options *options = reinterpret_cast<bench_options *>(userdata);
+                const char *tok = parser->next_token();
+
+                if (!tok) {
+                    *err = "No application specified";
+                    return false;
+                }
+
+                options->app_ = tok;
+
+                const char *cmdline = parser->peek_token();
+
+                if (cmdline && (std::string(cmdline).substr(0, 2) != "--")) {
+                    options->app_cmdline_ = cmdline;
+                    parser->next_token();
+                }
+
+                return true;
+            });
+
+        parser.add("--device", "Index of the device to boot. Defaults to the device in the config.",
+            [](common::arg_parser *parser, void *userdata, std::string *err) {
+                const char *tok = parser->next_token();
+
+                if (!tok) {
+                    *err = "No device index specified";
+                    return false;
+                }
+
+                bench_options *options = reinterpret_cast<bench_options *>(userdata);
+                options->device_ = common::pystr(tok).as_int<int>(-1);
+
+                if (options->device_ < 0) {
+                    *err = "Invalid device index: ";
+                    *err += tok;
+
+                    return false;
+                }
+
+                return true;
+            });
+
+        parser.add("--time", "Emulated time to run the app for, in milliseconds. Counted from retired guest instructions\n"
+                             "\t\t\t  at the emulated clock rate, not the host clock. Defaults to 30000.",
+            [](common::arg_parser *parser, void *userdata, std::string *err) {
+                const char *tok = parser->next_token();
+
+                if (!tok) {
+                    *err = "No time specified";
+                    return false;
+                }
+
+                bench_options *options = reinterpret_cast<bench_options *>(userdata);
+                options->emulated_time_us_ = common::pystr(tok).as_int<std::uint64_t>() * 1000;
+
+                if (options->emulated_time_us_ == 0) {
+                    *err = "Invalid benchmark time: ";
+                    *err += tok;
+
+                    return false;
+                }
+
+                return true;
+            });
+
+        parser.add("--input", "Input script to play. One event per line: <emulated ms> <key_down|key_up> <key>,\n"
+                              "\t\t\t  or <emulated ms> <touch_down|touch_move|touch_up> <x> <y>.",
+            [](common::arg_parser *parser, void *userdata, std::string *err) {
+                const char *tok = parser->next_token();
+
+                if (!tok) {
+                    *err = "No input script specified";
+                    return false;
+                }
+
+                reinterpret_cast<bench_options *>(userdata)->input_path_ = tok;
+                return true;
+            });
+
+        parser.add("--report", "Path of the JSON report. Defaults to bench_report.json.",
+            [](common::arg_parser *parser, void *userdata, std::string *err) {
+                const char *tok = parser->next_token();
+
+                if (!tok) {
+                    *err = "No report path specified";
+                    return false;
+                }
+
+                reinterpret_cast<bench_options *>(userdata)->report_path_ = tok;
+                return true;
+            });
+
+        if (!parser.parse(&options, err)) {
+            return false;
+        }
+
+        if (options.app_.empty()) {
+            *err = "An app to benchmark must be given with --run";
+            return false;
+        }
+
+        return true;
+    }
+
+    int bench_entry(emulator &state, const int argc, const char **argv) {
+        bench_options options;
+        std::string err;
+
+        if (!parse_bench_options(argc, argv, options, &err)) {
+            if (!options.show_help_) {
+                std::cout << err << std::endl;
+                return -1;
+            }
+
+            return 0;
+        }
+
+        // Same as the emulator, configs and resources are next to the executable.
+        // Paths given by the user are relative to where the runner was started.
+        std::string start_directory;
+        eka2l1::get_current_directory(start_directory);
+
+        options.report_path_ = eka2l1::absolute_path(options.report_path_, start_directory);
+
+        if (!options.input_path_.empty()) {
+            options.input_path_ = eka2l1::absolute_path(options.input_path_, start_directory);
+        }
+
+        eka2l1::set_current_directory(eka2l1::file_directory(argv[0]));
+
+        std::vector<bench_input> inputs;
+
+        if (!options.input_path_.empty()) {
+            std::ifstream script_file(options.input_path_);
+
+            if (!script_file) {
+                std::cout << "Unable to open input script " << options.input_path_ << std::endl;
+                return -1;
+            }
+
+            std::ostringstream content;
+            content << script_file.rdbuf();
+
+            if (!parse_bench_input_script(content.str(), inputs, &err)) {
+                std::cout << "Invalid input script: " << err << std::endl;
+                return -1;
+            }
+        }
+
+        state.headless = true;
+        state.stage_one();
+
+        if (options.device_ >= 0) {
+            if (!state.symsys->set_device(static_cast<std::uint8_t>(options.device_))) {
+                std::cout << "Device index " << options.device_ << " is out of range" << std::endl;
+                return -1;
+            }
+        }
+
+        std::thread os_thread_obj(os_thread, std::ref(state));
+        state.init_event.wait();
+
+        if (!state.stage_two_inited || !launch_app_from_specifier(&state, options.app_, options.app_cmdline_, &err)) {
+            if (state.stage_two_inited) {
+                std::cout << err << std::endl;
+            }
+
+            state.should_emu_quit = true;
+            state.graphics_sema.notify();
+
+            os_thread_obj.join();
+            return -1;
+        }
+
+        bench_sample start;
+        bench_sample end;
+
+        std::atomic<bool> started(false);
+        std::atomic<bool> finished(false);
+        std::size_t next_input = 0;
+
+        // The time budget and the inputs follow guest progress, so they are handled on the OS thread
+        // between time slices, not at the host paced frame rate.
+        state.os_loop_hook = [&]() {
+            if (!started) {
+                start = take_bench_sample(state, os_thread_obj);
+                started = true;
+            }
+
+            const std::uint64_t elapsed = get_emulated_time_us(state) - start.emulated_us_;
+
+            if (state.winserv) {
+                const std::lock_guard<std::mutex> guard(state.lockdown);
+
+                while ((next_input < inputs.size()) && (inputs[next_input].time_us_ <= elapsed)) {
+                    state.winserv->queue_input_from_driver(inputs[next_input++].evt_);
+                }
+            }
+
+            if (elapsed < options.emulated_time_us_) {
+                return true;
+            }
+
+            end = take_bench_sample(state, os_thread_obj);
+            finished = true;
+
+            return false;
+        };
+
+        std::vector<bench_thread_time> start_host_threads;
+        std::vector<bench_thread_time> end_host_threads;
+
+        // Host threads can only be sampled from here, once a frame, which is precise enough for CPU time
+        headless_main_loop(state, [&](std::thread &driver_thread) {
+            if (started && !finished) {
+                end_host_threads = take_host_thread_times(driver_thread);
+
+                if (start_host_threads.empty()) {
+                    start_host_threads = end_host_threads;
+                }
+            }
+
+            return true;
+        });
+
+        os_thread_obj.join();
+        state.os_loop_hook = nullptr;
+
+        start.threads_.insert(start.threads_.end(), start_host_threads.begin(), start_host_threads.end());
+        end.threads_.insert(end.threads_.end(), end_host_threads.begin(), end_host_threads.end());
+
+        if (!finished) {
+            // A shorter run is not comparable with others, so leave no report
+            LOG_ERROR(FRONTEND_CMDLINE, "Emulator stopped before the benchmark time was reached, no report written");
+            return -1;
+        }
+
+        return write_bench_report(options, start, end) ? 0 : -1;
+    }
+}
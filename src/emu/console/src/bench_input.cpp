@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <console/bench.h>
+
+#include <algorithm>
+#include <sstream>
+
+namespace eka2l1::desktop {
+    bool parse_bench_input_script(const std::string &content, std::vector<bench_input> &inputs, std::string *err) {
+        std::istringstream stream(content);
+        std::string line;
+        int line_number = 0;
+
+        while (std::getline(stream, line)) {
+            line_number++;
+
+            std::istringstream tokens(line);
+            tokens >> std::ws;
+
+            if (tokens.eof() || (tokens.peek() == '#')) {
+                continue;
+            }
+
+            std::uint64_t time_ms = 0;
+            std::string action;
+
+            if (!(tokens >> time_ms >> action)) {
+                *err = "Line " + std::to_string(line_number) + ": expected a time and an action";
+                return false;
+            }
+
+            bench_input input;
+            input.time_us_ = time_ms * 1000;
+
+            if ((action == "key_down") || (action == "key_up")) {
+                int key = 0;
+
+                if (!(tokens >> key)) {
+                    *err = "Line " + std::to_string(line_number) + ": " + action + " needs a key code";
+                    return false;
+                }
+
+                input.evt_.type_ = drivers::input_event_type::key;
+                input.evt_.key_.code_ = key;
+                input.evt_.key_.state_ = (action == "key_down") ? drivers::key_state::pressed : drivers::key_state::released;
+            } else if ((action == "touch_down") || (action == "touch_move") || (action == "touch_up")) {
+                int x = 0;
+                int y = 0;
+
+                if (!(tokens >> x >> y)) {
+                    *err = "Line " + std::to_string(line_number) + ": " + action + " needs a position";
+                    return false;
+                }
+
+                input.evt_.type_ = drivers::input_event_type::touch;
+                input.evt_.mouse_.pos_x_ = x;
+                input.evt_.mouse_.pos_y_ = y;
+                input.evt_.mouse_.button_ = drivers::mouse_button_left;
+
+                if (action == "touch_down") {
+                    input.evt_.mouse_.action_ = drivers::mouse_action_press;
+                } else if (action == "touch_move") {
+                    input.evt_.mouse_.action_ = drivers::mouse_action_repeat;
+                } else {
+                    input.evt_.mouse_.action_ = drivers::mouse_action_release;
+                }
+            } else {
+                *err = "Line " + std::to_string(line_number) + ": unknown action " + action;
+                return false;
+            }
+
+            inputs.push_back(input);
+        }
+
+        // Keep the order of events given at the same time
+        std::stable_sort(inputs.begin(), inputs.end(), [](const bench_input &lhs, const bench_input &rhs) {
+            return lhs.time_us_ < rhs.time_us_;
+        });
+
+        return true;
+    }
+}
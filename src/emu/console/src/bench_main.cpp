@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <console/bench.h>
+#include <console/state.h>
+#include <debugger/imgui_debugger.h>
+#include <debugger/logger.h>
+#include <drivers/audio/audio.h>
+#include <drivers/graphics/graphics.h>
+
+#include <memory>
+
+int main(const int argc, const char **argv) {
+    std::unique_ptr<eka2l1::desktop::emulator> state = std::make_unique<eka2l1::desktop::emulator>();
+    return eka2l1::desktop::bench_entry(*state, argc, argv);
+}
@@ -20,6 +20,7 @@
 #include <common/arghandler.h>
 #include <common/cvt.h>
 #include <common/path.h>
+#include <common/profiler.h>
 #include <common/pystr.h>
 #include <console/cmdhandler.h>
 #include <console/state.h>
@@ -83,32 +84,7 @@ bool package_remove_option_handler(eka2l1::common::arg_parser *parser, void *use
     return true;
 }
 
-bool app_specifier_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err) {
-    const char *tok = parser->next_token();
-
-    if (!tok) {
-        *err = "No application specified";
-        return false;
-    }
-
-    std::string tokstr = tok;
-
-    const char *cmdline = parser->peek_token();
-
-    std::string cmdlinestr = "";
-
-    if (cmdline) {
-        cmdlinestr = cmdline;
-
-        if (cmdlinestr.substr(0, 2) == "--") {
-            cmdlinestr = "";
-        } else {
-            parser->next_token();
-        }
-    }
-
-    desktop::emulator *emu = reinterpret_cast<desktop::emulator *>(userdata);
-
+bool launch_app_from_specifier(eka2l1::desktop::emulator *emu, const std::string &tokstr, const std::string &cmdlinestr, std::string *err) {
     // Get app list server
     kernel_system *kern = emu->symsys->get_kernel_system();
     eka2l1::applist_server *svr = nullptr;
@@ -173,6 +149,34 @@ bool app_specifier_option_handler(eka2l1::common::arg_parser *parser, void *user
     return false;
 }
 
+bool app_specifier_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err) {
+    const char *tok = parser->next_token();
+
+    if (!tok) {
+        *err = "No application specified";
+        return false;
+    }
+
+    std::string tokstr = tok;
+
+    const char *cmdline = parser->peek_token();
+
+    std::string cmdlinestr = "";
+
+    if (cmdline) {
+        cmdlinestr = cmdline;
+
+        if (cmdlinestr.substr(0, 2) == "--") {
+            cmdlinestr = "";
+        } else {
+            parser->next_token();
+        }
+    }
+
+    desktop::emulator *emu = reinterpret_cast<desktop::emulator *>(userdata);
+    return launch_app_from_specifier(emu, tokstr, cmdlinestr, err);
+}
+
 bool help_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err) {
     std::cout << parser->get_help_string();
     return false;
@@ -250,6 +254,34 @@ bool fullscreen_option_handler(eka2l1::common::arg_parser *parser, void *userdat
     return true;
 }
 
+bool headless_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err) {
+    desktop::emulator *emu = reinterpret_cast<desktop::emulator *>(userdata);
+
+    emu->headless = true;
+    *err = "";
+
+    return true;
+}
+
+bool profile_capture_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err) {
+    const char *path = parser->next_token();
+
+    if (!path) {
+        *err = "No path given for the profile capture";
+        return false;
+    }
+
+    if (!common::is_profiler_available()) {
+        *err = "This build has no profiler, rebuild with EKA2L1_ENABLE_PROFILING";
+        return false;
+    }
+
+    desktop::emulator *emu = reinterpret_cast<desktop::emulator *>(userdata);
+    emu->profile_capture_path = path;
+
+    return true;
+}
+
 #if ENABLE_SCRIPTING
 bool python_docgen_option_handler(eka2l1::common::arg_parser *parser, void *userdata, std::string *err) {
     try {
@@ -55,6 +55,7 @@ namespace eka2l1::desktop {
         , stage_two_inited(false)
         , first_time(true)
         , init_fullscreen(false)
+        , headless(false)
         , winserv(nullptr)
         , normal_font(nullptr)
         , sys_reset_cbh(0) {
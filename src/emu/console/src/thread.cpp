@@ -21,6 +21,7 @@
 #include <common/configure.h>
 #include <common/cvt.h>
 #include <common/log.h>
+#include <common/profiler.h>
 #include <common/random.h>
 #include <common/thread.h>
 #include <common/time.h>
@@ -44,6 +45,9 @@
 
 #include <kernel/kernel.h>
 
+#include <atomic>
+#include <csignal>
+
 #if EKA2L1_PLATFORM(WIN32)
 #include <Windows.h>
 #endif
@@ -197,6 +201,7 @@ namespace eka2l1::desktop {
         // Halloween decoration breath of the graphics
         eka2l1::common::set_thread_name(graphics_driver_thread_name);
         eka2l1::common::set_thread_priority(eka2l1::common::thread_priority_high);
+        eka2l1::common::profiler_register_thread(graphics_driver_thread_name);
 
         if (!drivers::init_window_library(drivers::window_api::glfw)) {
             return -1;
@@ -353,6 +358,7 @@ namespace eka2l1::desktop {
     static int ui_thread_initialization(emulator &state) {
         // Breath of the UI
         eka2l1::common::set_thread_name(ui_thread_name);
+        eka2l1::common::profiler_register_thread(ui_thread_name);
 
         ImGui::CreateContext();
 
@@ -581,6 +587,7 @@ namespace eka2l1::desktop {
             state.graphics_driver->submit_command_list(*cmd_list);
             state.graphics_driver->wait_for(&wait_status);
 
+            eka2l1::common::profiler_flip();
             io.MouseWheel = 0;
 
             // Recreate the list and builder
@@ -609,6 +616,7 @@ namespace eka2l1::desktop {
 
         eka2l1::common::set_thread_name(os_thread_name);
         eka2l1::common::set_thread_priority(eka2l1::common::thread_priority_high);
+        eka2l1::common::profiler_register_thread(os_thread_name);
 
         const bool success = state.stage_two();
 
@@ -634,6 +642,10 @@ namespace eka2l1::desktop {
             }
 #endif
 
+            if (state.os_loop_hook && !state.os_loop_hook()) {
+                state.should_emu_quit = true;
+            }
+
             if (state.should_emu_pause && !state.should_emu_quit) {
                 state.debugger->wait_for_debugger();
             }
@@ -644,14 +656,132 @@ namespace eka2l1::desktop {
         }
 
         state.graphics_sema.notify();
+        state.os_thread_done_event.set();
         
 #if EKA2L1_PLATFORM(WIN32)
         CoUninitialize();
 #endif
     }
 
+    static std::atomic<bool> headless_quit_requested(false);
+
+    static void on_headless_quit_signal(int signal) {
+        headless_quit_requested = true;
+    }
+
+    static void headless_present(emulator &state, drivers::graphics_command_list_builder *cmd_builder) {
+        kernel_system *kern = state.symsys->get_kernel_system();
+
+        if (!kern || !state.winserv) {
+            return;
+        }
+
+        kern->lock();
+
+        // Present the first screen as is, so the frame in memory matches what the guest drew
+        epoc::screen *scr = state.winserv->get_screens();
+
+        if (scr && scr->screen_texture) {
+            scr->screen_mutex.lock();
+
+            const eka2l1::vec2 size = scr->current_mode().size;
+            const eka2l1::rect area(eka2l1::vec2(0, 0), size);
+
+            cmd_builder->bind_bitmap(0);
+            cmd_builder->set_swapchain_size(size);
+            cmd_builder->backup_state();
+
+            cmd_builder->clear({ 0xFF, 0xD0, 0xD0, 0xD0 }, drivers::draw_buffer_bit_color_buffer);
+            cmd_builder->set_viewport(area);
+            cmd_builder->draw_bitmap(scr->screen_texture, 0, area, area, eka2l1::vec2(0, 0), 0.0f, drivers::bitmap_draw_flag_no_flip);
+
+            if (scr->dsa_texture) {
+                cmd_builder->draw_bitmap(scr->dsa_texture, 0, area, area, eka2l1::vec2(0, 0), 0.0f, drivers::bitmap_draw_flag_no_flip);
+            }
+
+            cmd_builder->load_backup_state();
+            scr->screen_mutex.unlock();
+        }
+
+        kern->unlock();
+    }
+
+    void headless_main_loop(emulator &state, headless_frame_callback frame_callback) {
+        std::signal(SIGINT, on_headless_quit_signal);
+        std::signal(SIGTERM, on_headless_quit_signal);
+
+        state.graphics_driver = drivers::create_graphics_driver(drivers::graphic_api::software);
+        state.symsys->set_graphics_driver(state.graphics_driver.get());
+
+        std::thread driver_thread_obj([&state]() {
+            eka2l1::common::set_thread_name(graphics_driver_thread_name);
+            eka2l1::common::profiler_register_thread(graphics_driver_thread_name);
+
+            state.graphics_driver->run();
+        });
+
+        // Only the OS thread waits for graphics here, there is no UI thread. Its wait may not have
+        // started yet, so this loop can't share the semaphore with it.
+        state.graphics_sema.notify();
+
+        static constexpr std::size_t HEADLESS_FRAME_US = 16667;
+
+        while (!state.os_thread_done_event.wait_for(HEADLESS_FRAME_US)) {
+            if (state.should_emu_quit) {
+                continue;
+            }
+
+            const bool callback_stop = state.stage_two_inited && frame_callback && !frame_callback(driver_thread_obj);
+
+            if (headless_quit_requested || callback_stop) {
+                LOG_INFO(FRONTEND_CMDLINE, "Stop requested, shutting down the emulator");
+                state.should_emu_quit = true;
+
+                kernel_system *kern = state.symsys->get_kernel_system();
+
+                if (kern) {
+                    kern->stop_cores_idling();
+                }
+
+                continue;
+            }
+
+            if (!state.stage_two_inited) {
+                continue;
+            }
+
+            std::unique_ptr<drivers::graphics_command_list> cmd_list = state.graphics_driver->new_command_list();
+            std::unique_ptr<drivers::graphics_command_list_builder> cmd_builder = state.graphics_driver->new_command_builder(cmd_list.get());
+
+            headless_present(state, cmd_builder.get());
+
+            int wait_status = -100;
+
+            cmd_builder->present(&wait_status);
+
+            state.graphics_driver->submit_command_list(*cmd_list);
+            state.graphics_driver->wait_for(&wait_status);
+
+            eka2l1::common::profiler_flip();
+        }
+
+        state.graphics_driver->abort();
+        driver_thread_obj.join();
+
+        state.graphics_driver.reset();
+    }
+
+    static void finish_profiling(emulator &state) {
+        if (!state.profile_capture_path.empty()) {
+            eka2l1::common::dump_profiler_capture(state.profile_capture_path);
+        }
+
+        eka2l1::common::shutdown_profiler();
+    }
+
     int emulator_entry(emulator &state, const int argc, const char **argv) {
         state.stage_one();
+        eka2l1::common::init_profiler();
 
         // Instantiate UI and High-level interface threads
         std::thread os_thread_obj(os_thread, std::ref(state));
@@ -675,6 +805,9 @@ namespace eka2l1::desktop {
         parser.add("--install, --i", "Install a SIS.", app_install_option_handler);
         parser.add("--remove, --r", "Remove an package.", package_remove_option_handler);
         parser.add("--fullscreen", "Display the emulator in fullscreen.", fullscreen_option_handler);
+        parser.add("--headless", "Run without a window or GPU, drawing on the CPU.", headless_option_handler);
+        parser.add("--profile-capture", "Write the profiler timeline to the given HTML file on exit.\n"
+                                        "\t\t\t  Only available in builds with EKA2L1_ENABLE_PROFILING.", profile_capture_option_handler);
 
 #if ENABLE_SCRIPTING
         parser.add("--gendocs", "Generate Python documentation", python_docgen_option_handler);
@@ -692,10 +825,32 @@ namespace eka2l1::desktop {
                 std::cout << err << std::endl;
                 os_thread_obj.join();
 
+                eka2l1::common::shutdown_profiler();
                 return -1;
             }
         }
 
+#if !ENABLE_WINDOW
+        if (!state.headless) {
+            LOG_INFO(FRONTEND_CMDLINE, "Built without a window, running headless");
+            state.headless = true;
+        }
+#endif
+
+        if (state.headless) {
+            // No window, no UI: nothing touches GLFW or the debugger renderer
+            headless_main_loop(state);
+            os_thread_obj.join();
+
+            finish_profiling(state);
+
+#if EKA2L1_PLATFORM(WIN32)
+            CoUninitialize();
+#endif
+
+            return 0;
+        }
+
         std::thread ui_thread_obj(ui_thread, std::ref(state));
         
         // Run graphics driver on main entry.
@@ -707,6 +862,8 @@ namespace eka2l1::desktop {
         // Wait for the UI to be killed next. Resources of the UI need to be destroyed before ending graphics driver life.
         ui_thread_obj.join();
 
+        finish_profiling(state);
+
 #if EKA2L1_PLATFORM(WIN32)
         CoUninitialize();
 #endif
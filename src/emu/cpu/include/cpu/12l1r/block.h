@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cpu/12l1r/decoder.h>
+#include <cpu/arm_interface.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace eka2l1::arm::r12l1 {
+    enum decoded_inst_flag : std::uint8_t {
+        inst_flag_set_flags = 1 << 0, ///< S bit.
+        inst_flag_pre_index = 1 << 1, ///< P bit.
+        inst_flag_add_offset = 1 << 2, ///< U bit.
+        inst_flag_write_back = 1 << 3, ///< W bit, or the implied writeback of post-indexed addressing.
+        inst_flag_thumb = 1 << 4, ///< The instruction was decoded from Thumb code.
+        inst_flag_double = 1 << 5 ///< VFP operation on double-precision registers.
+    };
+
+    enum shift_type : std::uint8_t {
+        shift_lsl = 0,
+        shift_lsr = 1,
+        shift_asr = 2,
+        shift_ror = 3,
+        shift_rrx = 4
+    };
+
+    /**
+     * \brief An instruction with its operands extracted, ready for the interpreter to execute.
+     * 
+     * Thumb instructions are stored as the ARM operation doing the same thing, so handlers only read
+     * the predecoded fields, never the raw encoding, unless the operation only exists in ARM mode.
+     */
+    struct decoded_inst {
+        const void *handler_; ///< Entry of the operation handler. Filled by the interpreter.
+
+        std::uint32_t pc_read_; ///< Value of PC when it is read as an operand.
+        std::uint32_t imm_; ///< Immediate, or target address for branches and literal loads.
+        std::uint32_t raw_;
+
+        op opcode_;
+        std::uint8_t cond_;
+        std::uint8_t size_; ///< Size of the instruction in bytes.
+
+        std::uint8_t rd_;
+        std::uint8_t rn_;
+        std::uint8_t rm_;
+        std::uint8_t rs_; ///< Shift register, or accumulate register of multiplies.
+
+        std::uint8_t shift_type_;
+        std::uint8_t shift_imm_; ///< Shift amount. For data processing immediates, the rotation.
+        std::uint8_t flags_;
+        std::uint16_t reg_list_;
+
+        address addr() const {
+            return pc_read_ - ((flags_ & inst_flag_thumb) ? 4 : 8);
+        }
+
+        address next_addr() const {
+            return addr() + size_;
+        }
+    };
+
+    /**
+     * \brief A run of guest instructions that ends at the first one that may branch.
+     * 
+     * The last entry is always a block_end, which continues execution at the following address.
+     */
+    struct block {
+        address start_;
+        address end_; ///< Address after the last instruction.
+        std::uint8_t asid_;
+        bool thumb_;
+
+        std::uint32_t hit_count_ = 0;
+        std::vector<decoded_inst> insts_;
+    };
+
+    /**
+     * \brief Predecode an ARM instruction.
+     * 
+     * \param inst Receive the decoded instruction.
+     * \param raw  The instruction word.
+     * \param addr Address of the instruction.
+     * 
+     * \returns True if the instruction may change the flow of execution, and must end its block.
+     */
+    bool predecode_arm(decoded_inst &inst, const std::uint32_t raw, const address addr);
+
+    /**
+     * \brief Predecode a Thumb instruction.
+     * 
+     * BL and BLX in Thumb are a pair of halfwords, which are decoded as one 4 bytes instruction. The size
+     * of the instruction is stored in the decoded instruction.
+     * 
+     * \param inst         Receive the decoded instruction.
+     * \param first        The halfword at the address.
+     * \param second       The halfword after it.
+     * \param second_valid False if the second halfword could not be read.
+     * \param addr         Address of the instruction.
+     * 
+     * \returns True if the instruction may change the flow of execution, and must end its block.
+     */
+    bool predecode_thumb(decoded_inst &inst, const std::uint16_t first, const std::uint16_t second,
+        const bool second_valid, const address addr);
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace eka2l1::arm::r12l1 {
+    /**
+     * \brief Operations the interpreter can execute.
+     */
+    enum class op : std::uint16_t {
+#define OP(name) name,
+#include <cpu/12l1r/ops.def>
+#undef OP
+        total_count
+    };
+
+    /**
+     * \brief Entries of the 16-bit Thumb encoding table.
+     * 
+     * Thumb instructions are translated to the ARM operation with the same behaviour when they are predecoded,
+     * so these are only used by the predecoder.
+     */
+    enum class thumb16_op : std::uint16_t {
+#define INST(fn, name, bitstring) fn
+#include <cpu/12l1r/encoding/thumb16.inc>
+#undef INST
+        unknown
+    };
+
+    /**
+     * \brief Decode an ARM instruction, using the VFP and ARM encoding tables.
+     * 
+     * \param inst The instruction word.
+     * \returns The operation, or op::unimplemented if the interpreter does not handle the instruction.
+     */
+    op decode_arm(const std::uint32_t inst);
+
+    /**
+     * \brief Decode a 16-bit Thumb instruction.
+     * 
+     * \param inst The instruction halfword.
+     * \returns The table entry, or thumb16_op::unknown if no entry matches.
+     */
+    thumb16_op decode_thumb16(const std::uint16_t inst);
+
+    /**
+     * \brief Get the name of an operation, for logging.
+     */
+    const char *op_name(const op target);
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cpu/12l1r/block.h>
+#include <cpu/arm_interface.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace eka2l1::arm::r12l1 {
+    /**
+     * \brief Exclusive monitor for cores that only run through the interpreter.
+     *
+     * Each core holds at most one reservation. A successful exclusive write clears the reservations
+     * of every core on the same address.
+     */
+    class interpreter_exclusive_monitor : public exclusive_monitor {
+        struct reservation {
+            address addr_ = 0;
+            std::uint64_t value_ = 0;
+            bool valid_ = false;
+        };
+
+        std::mutex lock_;
+        std::vector<reservation> reservations_;
+
+        template <typename T, typename F>
+        T read_and_mark(core *cc, const address vaddr, F read_func);
+
+        template <typename T, typename F>
+        bool write_if_marked(core *cc, const address vaddr, F write_func);
+
+    public:
+        explicit interpreter_exclusive_monitor(const std::size_t processor_count);
+
+        std::uint8_t exclusive_read8(core *cc, address vaddr) override;
+        std::uint16_t exclusive_read16(core *cc, address vaddr) override;
+        std::uint32_t exclusive_read32(core *cc, address vaddr) override;
+        std::uint64_t exclusive_read64(core *cc, address vaddr) override;
+        void clear_exclusive() override;
+
+        bool exclusive_write8(core *cc, address vaddr, std::uint8_t value) override;
+        bool exclusive_write16(core *cc, address vaddr, std::uint16_t value) override;
+        bool exclusive_write32(core *cc, address vaddr, std::uint32_t value) override;
+        bool exclusive_write64(core *cc, address vaddr, std::uint64_t value) override;
+    };
+
+    /**
+     * \brief Guest CPU state, as the interpreter keeps it.
+     *
+     * The flags of the CPSR are kept apart, so instructions don't have to pack them back.
+     */
+    struct interpreter_state {
+        std::array<std::uint32_t, 16> regs_{};
+        std::array<std::uint32_t, 64> ext_regs_{};
+
+        std::uint32_t fpscr_ = 0;
+        std::uint32_t cpsr_rest_ = 0x10; ///< Bits of the CPSR that are not kept in the fields below.
+        std::uint32_t wrwr_ = 0;
+
+        bool n_ = false;
+        bool z_ = false;
+        bool c_ = false;
+        bool v_ = false;
+        bool q_ = false;
+        bool t_ = false;
+        std::uint8_t ge_ = 0;
+    };
+
+    /**
+     * \brief ARMv6 interpreter, running guest code predecoded into blocks.
+     *
+     * Blocks are decoded once, then their instructions are dispatched through a handler pointer stored
+     * in each of them. There is no compilation, so running code for the first time costs about the same
+     * as running it again. This makes the interpreter suitable for single stepping, and for code that
+     * only runs a few times.
+     */
+    class interpreter_core : public core {
+    public:
+        static constexpr std::uint32_t PAGE_BITS = 12;
+        static constexpr std::uint32_t PAGE_SIZE = 1 << PAGE_BITS;
+        static constexpr std::uint32_t PAGE_MASK = PAGE_SIZE - 1;
+
+        static constexpr std::size_t MAX_BLOCK_INSTRUCTIONS = 64;
+        static constexpr std::size_t FAST_LOOKUP_SIZE = 4096;
+
+    private:
+        interpreter_state state_;
+
+        exclusive_monitor *monitor_;
+        core *monitor_owner_; ///< Core given to the exclusive monitor, to identify the accessor.
+
+        std::vector<std::uint8_t *> page_table_;
+        std::uint8_t asid_ = 0;
+
+        std::unordered_map<std::uint64_t, std::unique_ptr<block>> blocks_;
+        std::unordered_map<std::uint32_t, std::vector<std::uint64_t>> page_blocks_; ///< Keys of blocks in each page.
+        std::vector<std::unique_ptr<block>> retired_blocks_; ///< Invalidated blocks, freed when none can be executing.
+        std::array<block *, FAST_LOOKUP_SIZE> fast_lookup_;
+
+        block scratch_block_; ///< Holds blocks that are not cached: single steps and fetch faults.
+
+        std::uint32_t ticks_executed_ = 0;
+        std::uint32_t ticks_target_ = 0;
+
+        std::atomic<bool> halt_requested_{ false };
+        bool executing_ = false;
+
+        std::uint32_t hot_block_threshold_ = 0;
+        bool exited_on_hot_block_ = false;
+
+        enum exec_result {
+            exec_next,
+            exec_branch,
+            exec_halt
+        };
+
+        template <typename T>
+        bool read_memory(const address addr, T &value);
+
+        template <typename T>
+        bool write_memory(const address addr, const T value);
+
+        bool raise_memory_fault(const decoded_inst *inst, const exception_type type, const address fault_addr);
+
+        void translate(block &blk, const address pc, const bool thumb, const std::size_t max_insts,
+            const void *const *handlers);
+        block *get_block(const address pc, const bool thumb, const void *const *handlers);
+        void retire_block(const std::uint64_t key);
+
+        exec_result execute_block_transfer(const decoded_inst *inst);
+        exec_result execute_exclusive(const decoded_inst *inst);
+        exec_result execute_coprocessor(const decoded_inst *inst);
+        exec_result execute_vfp_transfer(const decoded_inst *inst);
+
+        void execute(const bool single_step);
+
+    public:
+        explicit interpreter_core(exclusive_monitor *monitor, const std::size_t core_num = 0);
+        ~interpreter_core() override;
+
+        /**
+         * \brief Set the core that is given to the exclusive monitor on exclusive accesses.
+         *
+         * The monitor's memory callbacks find the address space from the core. When the interpreter
+         * runs on behalf of another core, this must be that core.
+         */
+        void set_monitor_owner(core *owner) {
+            monitor_owner_ = owner;
+        }
+
+        /**
+         * \brief Stop running when a block has been entered more than the given number of times.
+         *
+         * Used to hand frequently run code to a faster backend. Zero disables the check.
+         */
+        void set_hot_block_threshold(const std::uint32_t threshold) {
+            hot_block_threshold_ = threshold;
+        }
+
+        /**
+         * \brief Check if the last run stopped at a block that reached the hot threshold.
+         *
+         * When it did, PC is at the start of that block, which has not been executed.
+         */
+        bool exited_on_hot_block() const {
+            return exited_on_hot_block_;
+        }
+
+        void run(const std::uint32_t instruction_count) override;
+        void stop() override;
+        void step() override;
+
+        uint32_t get_reg(size_t idx) override;
+        uint32_t get_sp() override;
+        uint32_t get_pc() override;
+        uint32_t get_vfp(size_t idx) override;
+
+        void set_reg(size_t idx, uint32_t val) override;
+        void set_pc(uint32_t val) override;
+        void set_sp(uint32_t val) override;
+        void set_lr(uint32_t val) override;
+        void set_vfp(size_t idx, uint32_t val) override;
+
+        uint32_t get_cpsr() override;
+        uint32_t get_lr() override;
+        void set_cpsr(uint32_t val) override;
+
+        void save_context(thread_context &ctx) override;
+        void load_context(const thread_context &ctx) override;
+
+        void set_entry_point(address ep) override;
+        address get_entry_point() override;
+
+        void set_stack_top(address addr) override;
+        address get_stack_top() override;
+
+        void prepare_rescheduling() override;
+
+        bool is_thumb_mode() override;
+
+        void page_table_changed() override;
+
+        void map_backing_mem(address vaddr, size_t size, uint8_t *ptr, prot protection) override;
+        void unmap_memory(address addr, size_t size) override;
+
+        void clear_instruction_cache() override;
+        void imb_range(address addr, std::size_t size) override;
+
+        std::uint32_t get_num_instruction_executed() override;
+
+        bool should_clear_old_memory_map() const override {
+            return false;
+        }
+
+        void set_asid(std::uint8_t num) override;
+        std::uint8_t get_asid() const override;
+        std::uint8_t get_max_asid_available() const override;
+    };
+}
@@ -0,0 +1,538 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cpu/12l1r/block.h>
+#include <cpu/12l1r/interpreter.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// Operation semantics shared by the interpreter handlers. They work on plain values, so they can be tested
+// without running guest code.
+namespace eka2l1::arm::r12l1 {
+    static constexpr std::uint32_t CPSR_N = 1U << 31;
+    static constexpr std::uint32_t CPSR_Z = 1U << 30;
+    static constexpr std::uint32_t CPSR_C = 1U << 29;
+    static constexpr std::uint32_t CPSR_V = 1U << 28;
+    static constexpr std::uint32_t CPSR_Q = 1U << 27;
+    static constexpr std::uint32_t CPSR_GE = 0xFU << 16;
+    static constexpr std::uint32_t CPSR_T = 1U << 5;
+
+    static constexpr std::uint32_t FPSCR_ROUND_TO_NEAREST = 0;
+    static constexpr std::uint32_t FPSCR_ROUND_TOWARDS_PLUS_INFINITY = 1;
+    static constexpr std::uint32_t FPSCR_ROUND_TOWARDS_MINUS_INFINITY = 2;
+    static constexpr std::uint32_t FPSCR_ROUND_TOWARDS_ZERO = 3;
+
+    inline std::uint32_t rotate_right(const std::uint32_t value, const std::uint32_t amount) {
+        const std::uint32_t rotation = amount & 31;
+        return rotation ? ((value >> rotation) | (value << (32 - rotation))) : value;
+    }
+
+    /**
+     * \brief Shift a register operand, and give the carry out of the shifter.
+     *
+     * \param type   Type of the shift, from shift_type.
+     * \param amount Amount of the shift. May be bigger than 32 for shifts by register.
+     */
+    inline std::uint32_t shift_with_carry(const std::uint32_t value, const std::uint8_t type, const std::uint32_t amount,
+        const bool carry_in, bool &carry_out) {
+        if (amount == 0) {
+            carry_out = carry_in;
+            return value;
+        }
+
+        switch (type) {
+        case shift_lsl:
+            if (amount < 32) {
+                carry_out = (value >> (32 - amount)) & 1;
+                return value << amount;
+            }
+
+            carry_out = (amount == 32) ? (value & 1) : false;
+            return 0;
+
+        case shift_lsr:
+            if (amount < 32) {
+                carry_out = (value >> (amount - 1)) & 1;
+                return value >> amount;
+            }
+
+            carry_out = (amount == 32) ? (value >> 31) : false;
+            return 0;
+
+        case shift_asr:
+            if (amount < 32) {
+                carry_out = (value >> (amount - 1)) & 1;
+                return static_cast<std::uint32_t>(static_cast<std::int32_t>(value) >> amount);
+            }
+
+            carry_out = value >> 31;
+            return carry_out ? 0xFFFFFFFF : 0;
+
+        case shift_ror: {
+            const std::uint32_t result = rotate_right(value, amount);
+            carry_out = result >> 31;
+
+            return result;
+        }
+
+        default:
+            // RRX
+            carry_out = value & 1;
+            return (value >> 1) | (carry_in ? (1U << 31) : 0);
+        }
+    }
+
+    inline std::uint32_t shift_value(const std::uint32_t value, const std::uint8_t type, const std::uint32_t amount,
+        const bool carry_in) {
+        bool unused = false;
+        return shift_with_carry(value, type, amount, carry_in, unused);
+    }
+
+    inline std::uint32_t add_with_carry(const std::uint32_t a, const std::uint32_t b, const bool carry_in, bool &carry_out,
+        bool &overflow) {
+        const std::uint64_t unsigned_sum = static_cast<std::uint64_t>(a) + b + (carry_in ? 1 : 0);
+        const std::uint32_t result = static_cast<std::uint32_t>(unsigned_sum);
+
+        carry_out = (unsigned_sum >> 32) != 0;
+        overflow = (((a ^ result) & (b ^ result)) >> 31) != 0;
+
+        return result;
+    }
+
+    inline bool condition_passed(const interpreter_state &state, const std::uint8_t cond) {
+        switch (cond) {
+        case 0x0:
+            return state.z_;
+        case 0x1:
+            return !state.z_;
+        case 0x2:
+            return state.c_;
+        case 0x3:
+            return !state.c_;
+        case 0x4:
+            return state.n_;
+        case 0x5:
+            return !state.n_;
+        case 0x6:
+            return state.v_;
+        case 0x7:
+            return !state.v_;
+        case 0x8:
+            return state.c_ && !state.z_;
+        case 0x9:
+            return !state.c_ || state.z_;
+        case 0xA:
+            return state.n_ == state.v_;
+        case 0xB:
+            return state.n_ != state.v_;
+        case 0xC:
+            return !state.z_ && (state.n_ == state.v_);
+        case 0xD:
+            return state.z_ || (state.n_ != state.v_);
+        default:
+            break;
+        }
+
+        return true;
+    }
+
+    inline void set_nzcv(interpreter_state &state, const std::uint32_t value) {
+        state.n_ = value & CPSR_N;
+        state.z_ = value & CPSR_Z;
+        state.c_ = value & CPSR_C;
+        state.v_ = value & CPSR_V;
+    }
+
+    /**
+     * \brief Write the parts of the CPSR that user mode can change.
+     *
+     * \param mask The field mask of MSR. Bit 3 writes the flags, bit 2 the GE bits.
+     */
+    inline void write_apsr(interpreter_state &state, const std::uint32_t value, const std::uint8_t mask) {
+        if (mask & 0b1000) {
+            set_nzcv(state, value);
+            state.q_ = value & CPSR_Q;
+        }
+
+        if (mask & 0b0100) {
+            state.ge_ = static_cast<std::uint8_t>((value >> 16) & 0xF);
+        }
+    }
+
+    /**
+     * \brief Branch to an address, switching to Thumb if the lowest bit is set.
+     */
+    inline void bx_write_pc(interpreter_state &state, const std::uint32_t value) {
+        state.t_ = value & 1;
+        state.regs_[15] = value & (state.t_ ? ~1U : ~3U);
+    }
+
+    /**
+     * \brief Write PC as the result of a data processing instruction.
+     *
+     * ARM code can switch to Thumb this way, like it does on ARMv7 and in the JIT.
+     */
+    inline void alu_write_pc(interpreter_state &state, const std::uint32_t value) {
+        if (state.t_) {
+            state.regs_[15] = value & ~1U;
+        } else {
+            bx_write_pc(state, value);
+        }
+    }
+
+    inline int popcount(const std::uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcount(value);
+#else
+        std::uint32_t v = value - ((value >> 1) & 0x55555555);
+        v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+        return static_cast<int>((((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24);
+#endif
+    }
+
+    inline std::uint32_t count_leading_zeros(const std::uint32_t value) {
+        std::uint32_t count = 0;
+
+        for (std::uint32_t bit = 1U << 31; bit && !(value & bit); bit >>= 1) {
+            count++;
+        }
+
+        return count;
+    }
+
+    inline std::uint32_t reverse_bits(std::uint32_t value) {
+        value = ((value >> 1) & 0x55555555) | ((value & 0x55555555) << 1);
+        value = ((value >> 2) & 0x33333333) | ((value & 0x33333333) << 2);
+        value = ((value >> 4) & 0x0F0F0F0F) | ((value & 0x0F0F0F0F) << 4);
+        value = ((value >> 8) & 0x00FF00FF) | ((value & 0x00FF00FF) << 8);
+
+        return (value >> 16) | (value << 16);
+    }
+
+    inline std::uint32_t byte_swap(const std::uint32_t value) {
+        return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+    }
+
+    inline std::uint32_t sign_extend_byte(const std::uint32_t value) {
+        return static_cast<std::uint32_t>(static_cast<std::int32_t>(static_cast<std::int8_t>(value)));
+    }
+
+    inline std::uint32_t sign_extend_half(const std::uint32_t value) {
+        return static_cast<std::uint32_t>(static_cast<std::int32_t>(static_cast<std::int16_t>(value)));
+    }
+
+    /**
+     * \brief Extend bytes 0 and 2 of the value to the two halfwords of the result.
+     */
+    inline std::uint32_t extend_byte_pairs(const std::uint32_t value, const bool is_signed) {
+        if (is_signed) {
+            return (sign_extend_byte(value) & 0xFFFF) | (sign_extend_byte(value >> 16) << 16);
+        }
+
+        return value & 0x00FF00FF;
+    }
+
+    inline std::uint32_t add_halves(const std::uint32_t a, const std::uint32_t b) {
+        return ((a + b) & 0xFFFF) | (((a >> 16) + (b >> 16)) << 16);
+    }
+
+    /**
+     * \brief Mask of bits lsb to msb. Empty if msb is lower than lsb.
+     */
+    inline std::uint32_t bitfield_mask(const std::uint32_t lsb, const std::uint32_t msb) {
+        if (msb < lsb) {
+            return 0;
+        }
+
+        const std::uint32_t width = msb - lsb + 1;
+        return ((width >= 32) ? 0xFFFFFFFF : ((1U << width) - 1)) << lsb;
+    }
+
+    /**
+     * \brief Expand each GE bit to a byte of ones, as SEL uses them.
+     */
+    inline std::uint32_t ge_byte_mask(const std::uint8_t ge) {
+        return ((ge & 1) ? 0x000000FF : 0) | ((ge & 2) ? 0x0000FF00 : 0) | ((ge & 4) ? 0x00FF0000 : 0)
+            | ((ge & 8) ? 0xFF000000 : 0);
+    }
+
+    inline std::uint32_t sum_absolute_byte_differences(const std::uint32_t a, const std::uint32_t b) {
+        std::uint32_t sum = 0;
+
+        for (std::uint32_t shift = 0; shift < 32; shift += 8) {
+            const std::int32_t difference = static_cast<std::int32_t>((a >> shift) & 0xFF) - static_cast<std::int32_t>((b >> shift) & 0xFF);
+            sum += static_cast<std::uint32_t>((difference < 0) ? -difference : difference);
+        }
+
+        return sum;
+    }
+
+    /**
+     * \brief Saturate a value to a signed integer of the given bit count, setting Q if it does not fit.
+     */
+    inline std::uint32_t signed_saturate(const std::int64_t value, const std::uint32_t bits, bool &q) {
+        const std::int64_t max = (static_cast<std::int64_t>(1) << (bits - 1)) - 1;
+        const std::int64_t min = -(static_cast<std::int64_t>(1) << (bits - 1));
+
+        if (value > max) {
+            q = true;
+            return static_cast<std::uint32_t>(max);
+        }
+
+        if (value < min) {
+            q = true;
+            return static_cast<std::uint32_t>(min);
+        }
+
+        return static_cast<std::uint32_t>(value);
+    }
+
+    /**
+     * \brief Saturate a value to an unsigned integer of the given bit count, setting Q if it does not fit.
+     */
+    inline std::uint32_t unsigned_saturate(const std::int64_t value, const std::uint32_t bits, bool &q) {
+        const std::int64_t max = (static_cast<std::int64_t>(1) << bits) - 1;
+
+        if (value > max) {
+            q = true;
+            return static_cast<std::uint32_t>(max);
+        }
+
+        if (value < 0) {
+            q = true;
+            return 0;
+        }
+
+        return static_cast<std::uint32_t>(value);
+    }
+
+    /**
+     * \brief Truncate a result to 32 bits, setting Q if it overflowed.
+     */
+    inline std::uint32_t wrap_and_set_q(const std::int64_t value, bool &q) {
+        if ((value > std::numeric_limits<std::int32_t>::max()) || (value < std::numeric_limits<std::int32_t>::min())) {
+            q = true;
+        }
+
+        return static_cast<std::uint32_t>(value);
+    }
+
+    enum parallel_variant {
+        parallel_signed,
+        parallel_unsigned,
+        parallel_signed_saturating,
+        parallel_unsigned_saturating,
+        parallel_signed_halving,
+        parallel_unsigned_halving
+    };
+
+    enum parallel_operation {
+        parallel_add8,
+        parallel_add16,
+        parallel_asx,
+        parallel_sax,
+        parallel_sub8,
+        parallel_sub16
+    };
+
+    /**
+     * \brief Execute a parallel add or subtract on the bytes or halfwords of two values.
+     *
+     * \param ge Receive the GE flags. Only the modular variants change them.
+     */
+    inline std::uint32_t parallel_add_sub(const parallel_variant variant, const parallel_operation operation,
+        const std::uint32_t a, const std::uint32_t b, std::uint8_t &ge) {
+        const bool on_bytes = (operation == parallel_add8) || (operation == parallel_sub8);
+        const std::uint32_t lane_bits = on_bytes ? 8 : 16;
+        const std::uint32_t lane_mask = (1U << lane_bits) - 1;
+        const std::uint32_t lane_count = 32 / lane_bits;
+
+        const bool is_signed = (variant == parallel_signed) || (variant == parallel_signed_saturating)
+            || (variant == parallel_signed_halving);
+
+        const auto lane = [&](const std::uint32_t value, const std::uint32_t index) -> std::int64_t {
+            const std::uint32_t bits = (value >> (index * lane_bits)) & lane_mask;
+
+            if (is_signed && (bits >> (lane_bits - 1))) {
+                return static_cast<std::int64_t>(bits) - (static_cast<std::int64_t>(1) << lane_bits);
+            }
+
+            return bits;
+        };
+
+        std::uint32_t result = 0;
+        std::uint8_t new_ge = 0;
+
+        for (std::uint32_t i = 0; i < lane_count; i++) {
+            // The exchanging forms pair each halfword with the other one of the second operand
+            bool subtract = (operation == parallel_sub8) || (operation == parallel_sub16);
+            std::uint32_t other_lane = i;
+
+            if ((operation == parallel_asx) || (operation == parallel_sax)) {
+                subtract = (operation == parallel_asx) ? (i == 0) : (i == 1);
+                other_lane = 1 - i;
+            }
+
+            const std::int64_t x = lane(a, i);
+            const std::int64_t y = lane(b, other_lane);
+            std::int64_t lane_result = subtract ? (x - y) : (x + y);
+
+            bool lane_ge = false;
+
+            switch (variant) {
+            case parallel_signed:
+                lane_ge = (lane_result >= 0);
+                break;
+
+            case parallel_unsigned:
+                lane_ge = subtract ? (lane_result >= 0) : (lane_result > lane_mask);
+                break;
+
+            case parallel_signed_saturating: {
+                const std::int64_t max = lane_mask >> 1;
+                lane_result = (lane_result > max) ? max : ((lane_result < -max - 1) ? (-max - 1) : lane_result);
+                break;
+            }
+
+            case parallel_unsigned_saturating:
+                lane_result = (lane_result > lane_mask) ? lane_mask : ((lane_result < 0) ? 0 : lane_result);
+                break;
+
+            default:
+                // Halving, rounded down
+                lane_result >>= 1;
+                break;
+            }
+
+            result |= (static_cast<std::uint32_t>(lane_result) & lane_mask) << (i * lane_bits);
+
+            if (lane_ge) {
+                new_ge |= (on_bytes ? 0b1 : 0b11) << (on_bytes ? i : (i * 2));
+            }
+        }
+
+        if ((variant == parallel_signed) || (variant == parallel_unsigned)) {
+            ge = new_ge;
+        }
+
+        return result;
+    }
+
+    template <typename T>
+    inline T read_fp(const std::uint32_t *ext_regs, const std::uint8_t index) {
+        T value;
+        std::memcpy(&value, ext_regs + index, sizeof(T));
+
+        return value;
+    }
+
+    template <typename T>
+    inline void write_fp(std::uint32_t *ext_regs, const std::uint8_t index, const T value) {
+        std::memcpy(ext_regs + index, &value, sizeof(T));
+    }
+
+    /**
+     * \brief Compare two floating point values, and give back the FPSCR with the result in its flags.
+     */
+    template <typename T>
+    inline std::uint32_t compare_fp(const std::uint32_t fpscr, const T a, const T b) {
+        std::uint32_t flags = 0;
+
+        if (std::isnan(a) || std::isnan(b)) {
+            flags = CPSR_C | CPSR_V;
+        } else if (a == b) {
+            flags = CPSR_Z | CPSR_C;
+        } else if (a < b) {
+            flags = CPSR_N;
+        } else {
+            flags = CPSR_C;
+        }
+
+        return (fpscr & ~(CPSR_N | CPSR_Z | CPSR_C | CPSR_V)) | flags;
+    }
+
+    /**
+     * \brief Convert a floating point value to a 32-bit integer, saturating when it's out of range.
+     *
+     * \param rounding One of the FPSCR rounding modes.
+     */
+    template <typename T>
+    inline std::uint32_t fp_to_integer(const T value, const std::uint32_t rounding, const bool is_signed) {
+        if (std::isnan(value)) {
+            return 0;
+        }
+
+        double rounded = static_cast<double>(value);
+
+        switch (rounding) {
+        case FPSCR_ROUND_TO_NEAREST: {
+            // Ties go to the even integer
+            const double floored = std::floor(rounded);
+            const double difference = rounded - floored;
+
+            if ((difference > 0.5) || ((difference == 0.5) && (std::fmod(floored, 2.0) != 0.0))) {
+                rounded = floored + 1.0;
+            } else {
+                rounded = floored;
+            }
+
+            break;
+        }
+
+        case FPSCR_ROUND_TOWARDS_PLUS_INFINITY:
+            rounded = std::ceil(rounded);
+            break;
+
+        case FPSCR_ROUND_TOWARDS_MINUS_INFINITY:
+            rounded = std::floor(rounded);
+            break;
+
+        default:
+            rounded = std::trunc(rounded);
+            break;
+        }
+
+        if (is_signed) {
+            if (rounded >= 2147483647.0) {
+                return 0x7FFFFFFF;
+            }
+
+            if (rounded <= -2147483648.0) {
+                return 0x80000000;
+            }
+
+            return static_cast<std::uint32_t>(static_cast<std::int32_t>(rounded));
+        }
+
+        if (rounded >= 4294967295.0) {
+            return 0xFFFFFFFF;
+        }
+
+        if (rounded <= 0.0) {
+            return 0;
+        }
+
+        return static_cast<std::uint32_t>(rounded);
+    }
+}
@@ -66,11 +66,17 @@ namespace eka2l1 {
             std::array<std::uint8_t *, Dynarmic::A32::UserConfig::NUM_PAGE_TABLE_ENTRIES>
                 page_dyn;
 
+            std::uint8_t *fastmem_arena_{ nullptr }; ///< Host view of the whole 4GB guest address space.
+
+            const thread_context *fpu_owner_{ nullptr }; ///< Context whose FPU state is still live in the JIT.
+            std::uint64_t fpu_save_stamp_{ 0 };
+
             std::uint32_t ticks_executed{ 0 };
             std::uint32_t ticks_target{ 0 };
 
         public:
-            explicit dynarmic_core(arm::exclusive_monitor *monitor);
+            explicit dynarmic_core(arm::exclusive_monitor *monitor, const bool enable_fastmem = false,
+                const std::size_t core_num = 0);
             ~dynarmic_core() override;
 
             void run(const std::uint32_t instruction_count) override;
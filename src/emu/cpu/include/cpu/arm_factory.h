@@ -35,9 +35,14 @@ namespace eka2l1 {
          * This factory methods provide various CPU translator backend for you to choose. The CPU must accompanies
          * with other system like kernel or timing, in order to help for emulation.
          * 
+         * \param enable_fastmem Map guest memory into a host view of the whole address space, so the backend
+         *                       can access memory directly. Ignored by backends that don't support it.
+         * \param core_num       Index of the core. Must be smaller than the core count of the exclusive monitor.
+         * 
          * \returns An instance to the CPU executor.
          */
-        core_instance create_core(exclusive_monitor *monitor, arm_emulator_type arm_type);
+        core_instance create_core(exclusive_monitor *monitor, arm_emulator_type arm_type, const bool enable_fastmem = false,
+            const std::size_t core_num = 0);
 
         exclusive_monitor_instance create_exclusive_monitor(arm_emulator_type arm_type, const std::size_t core_count); 
     }
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <memory>
 #include <functional>
 
@@ -39,14 +40,36 @@ namespace eka2l1::arm {
 
     using address = std::uint32_t;
 
-    using memory_operation_8bit_func = std::function<bool(address, std::uint8_t*)>;
-    using memory_operation_16bit_func = std::function<bool(address, std::uint16_t*)>;
-    using memory_operation_32bit_func = std::function<bool(address, std::uint32_t*)>;
-    using memory_operation_64bit_func = std::function<bool(address, std::uint64_t*)>;
-    using memory_operation_ew_8bit_func = std::function<std::int32_t(address, std::uint8_t, std::uint8_t)>;
-    using memory_operation_ew_16bit_func = std::function<std::int32_t(address, std::uint16_t, std::uint16_t)>;
-    using memory_operation_ew_32bit_func = std::function<std::int32_t(address, std::uint32_t, std::uint32_t)>;
-    using memory_operation_ew_64bit_func = std::function<std::int32_t(address, std::uint64_t, std::uint64_t)>;
+    template <typename T>
+    using memory_operation_func = bool (*)(void *userdata, address addr, T *data);
+
+    template <typename T>
+    using memory_operation_ew_func = std::int32_t (*)(void *userdata, address addr, T value, T expected);
+
+    /**
+     * @brief Table of memory accessors the CPU uses when an access misses its page table.
+     * 
+     * Plain function pointers with a shared context pointer, so the owner of the memory can install
+     * accessors specialized for its memory model, and each access only costs one indirect call.
+     */
+    struct memory_callbacks {
+        void *userdata = nullptr;
+
+        memory_operation_func<std::uint8_t> read_8bit = nullptr;
+        memory_operation_func<std::uint16_t> read_16bit = nullptr;
+        memory_operation_func<std::uint32_t> read_32bit = nullptr;
+        memory_operation_func<std::uint64_t> read_64bit = nullptr;
+
+        memory_operation_func<std::uint8_t> write_8bit = nullptr;
+        memory_operation_func<std::uint16_t> write_16bit = nullptr;
+        memory_operation_func<std::uint32_t> write_32bit = nullptr;
+        memory_operation_func<std::uint64_t> write_64bit = nullptr;
+
+        memory_operation_ew_func<std::uint8_t> exclusive_write_8bit = nullptr;
+        memory_operation_ew_func<std::uint16_t> exclusive_write_16bit = nullptr;
+        memory_operation_ew_func<std::uint32_t> exclusive_write_32bit = nullptr;
+        memory_operation_ew_func<std::uint64_t> exclusive_write_64bit = nullptr;
+    };
 
     using memory_read_with_core_8bit_func = std::function<bool(core*, address, std::uint8_t*)>;
     using memory_read_with_core_16bit_func = std::function<bool(core*, address, std::uint16_t*)>;
@@ -94,24 +117,67 @@ namespace eka2l1::arm {
     class core {
     private:
         std::size_t core_num_ = 0;
+        std::atomic<bool> halt_request_{ false };
+
+    protected:
+        memory_callbacks mem_cbs_;
+
+        void clear_halt_request() {
+            halt_request_.store(false, std::memory_order_relaxed);
+        }
 
     public:
-        memory_operation_8bit_func read_8bit;
-        memory_operation_8bit_func write_8bit;
+        void set_memory_callbacks(const memory_callbacks &callbacks) {
+            mem_cbs_ = callbacks;
+        }
+
+        bool read_8bit(const address addr, std::uint8_t *data) {
+            return mem_cbs_.read_8bit(mem_cbs_.userdata, addr, data);
+        }
+
+        bool read_16bit(const address addr, std::uint16_t *data) {
+            return mem_cbs_.read_16bit(mem_cbs_.userdata, addr, data);
+        }
+
+        bool read_32bit(const address addr, std::uint32_t *data) {
+            return mem_cbs_.read_32bit(mem_cbs_.userdata, addr, data);
+        }
+
+        bool read_64bit(const address addr, std::uint64_t *data) {
+            return mem_cbs_.read_64bit(mem_cbs_.userdata, addr, data);
+        }
+
+        bool write_8bit(const address addr, std::uint8_t *data) {
+            return mem_cbs_.write_8bit(mem_cbs_.userdata, addr, data);
+        }
+
+        bool write_16bit(const address addr, std::uint16_t *data) {
+            return mem_cbs_.write_16bit(mem_cbs_.userdata, addr, data);
+        }
 
-        memory_operation_16bit_func read_16bit;
-        memory_operation_16bit_func write_16bit;
+        bool write_32bit(const address addr, std::uint32_t *data) {
+            return mem_cbs_.write_32bit(mem_cbs_.userdata, addr, data);
+        }
 
-        memory_operation_32bit_func read_32bit;
-        memory_operation_32bit_func write_32bit;
+        bool write_64bit(const address addr, std::uint64_t *data) {
+            return mem_cbs_.write_64bit(mem_cbs_.userdata, addr, data);
+        }
 
-        memory_operation_64bit_func read_64bit;
-        memory_operation_64bit_func write_64bit;
+        std::int32_t exclusive_write_8bit(const address addr, std::uint8_t value, std::uint8_t expected) {
+            return mem_cbs_.exclusive_write_8bit(mem_cbs_.userdata, addr, value, expected);
+        }
 
-        memory_operation_ew_8bit_func exclusive_write_8bit;
-        memory_operation_ew_16bit_func exclusive_write_16bit;
-        memory_operation_ew_32bit_func exclusive_write_32bit;
-        memory_operation_ew_64bit_func exclusive_write_64bit;
+        std::int32_t exclusive_write_16bit(const address addr, std::uint16_t value, std::uint16_t expected) {
+            return mem_cbs_.exclusive_write_16bit(mem_cbs_.userdata, addr, value, expected);
+        }
+
+        std::int32_t exclusive_write_32bit(const address addr, std::uint32_t value, std::uint32_t expected) {
+            return mem_cbs_.exclusive_write_32bit(mem_cbs_.userdata, addr, value, expected);
+        }
+
+        std::int32_t exclusive_write_64bit(const address addr, std::uint64_t value, std::uint64_t expected) {
+            return mem_cbs_.exclusive_write_64bit(mem_cbs_.userdata, addr, value, expected);
+        }
 
         system_call_handler_func system_call_handler;
         handle_exception_func exception_handler;
@@ -125,9 +191,16 @@ namespace eka2l1::arm {
             std::uint32_t pc;
             std::uint32_t lr;
             std::uint32_t cpsr;
-            std::array<uint64_t, 32> fpu_registers;
+            std::array<uint32_t, 64> fpu_registers; ///< D0-D31 as pairs of words. S0-S31 alias D0-D15.
             std::uint32_t fpscr;
             std::uint32_t wrwr;
+
+            /**
+             * Set by the core when it saves the FPU state into this context. If the same context is
+             * loaded back with the stamp untouched, the core can skip restoring the FPU. Reset it to 0
+             * after modifying the FPU registers of a saved context.
+             */
+            std::uint64_t fpu_save_stamp = 0;
         };
 
         virtual ~core() {}
@@ -141,7 +214,24 @@ namespace eka2l1::arm {
         }
 
         virtual void run(const std::uint32_t instruction_count) = 0;
+
+        /**
+         * Stop the core. Only safe to call from the thread running it, for example from a callback.
+         */
         virtual void stop() = 0;
+
+        /**
+         * Ask the core to stop running. Unlike stop(), this is safe to call from any thread. The core
+         * notices it at its next callback or block boundary, and drops it once run() returns.
+         */
+        virtual void request_halt() {
+            halt_request_.store(true, std::memory_order_release);
+        }
+
+        bool halt_requested() const {
+            return halt_request_.load(std::memory_order_acquire);
+        }
+
         virtual void step() = 0;
         virtual uint32_t get_reg(size_t idx) = 0;
         virtual uint32_t get_sp() = 0;
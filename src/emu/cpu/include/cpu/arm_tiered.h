@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cpu/arm_interface.h>
+
+#include <memory>
+
+namespace eka2l1::arm {
+    namespace r12l1 {
+        class interpreter_core;
+    }
+
+    /**
+     * \brief Core that starts running code in the interpreter, and hands hot code to dynarmic.
+     *
+     * Code that only runs a few times, like static initializers, never pays for recompilation. When the
+     * interpreter enters a block often enough, the guest state moves to the JIT, which runs the rest of
+     * the time slice.
+     *
+     * Both backends share dynarmic's exclusive monitor, so the monitor given must be created for
+     * arm_emulator_type::tiered.
+     */
+    class tiered_core : public core {
+    public:
+        static constexpr std::uint32_t HOT_BLOCK_THRESHOLD = 32;
+
+    private:
+        std::unique_ptr<r12l1::interpreter_core> interpreter_;
+        std::unique_ptr<core> jit_;
+
+        core *active_; ///< The core holding the guest state.
+        thread_context transfer_context_;
+
+        std::uint32_t jit_ticks_executed_ = 0;
+
+        void switch_to(core *target);
+
+    public:
+        explicit tiered_core(exclusive_monitor *monitor, const bool enable_fastmem = false,
+            const std::size_t core_num = 0);
+        ~tiered_core() override;
+
+        void run(const std::uint32_t instruction_count) override;
+        void stop() override;
+        void request_halt() override;
+        void step() override;
+
+        /**
+         * \brief Check if the guest state is currently held by the JIT.
+         */
+        bool is_jit_active() const {
+            return active_ == jit_.get();
+        }
+
+        uint32_t get_reg(size_t idx) override;
+        uint32_t get_sp() override;
+        uint32_t get_pc() override;
+        uint32_t get_vfp(size_t idx) override;
+
+        void set_reg(size_t idx, uint32_t val) override;
+        void set_pc(uint32_t val) override;
+        void set_sp(uint32_t val) override;
+        void set_lr(uint32_t val) override;
+        void set_vfp(size_t idx, uint32_t val) override;
+
+        uint32_t get_cpsr() override;
+        uint32_t get_lr() override;
+        void set_cpsr(uint32_t val) override;
+
+        void save_context(thread_context &ctx) override;
+        void load_context(const thread_context &ctx) override;
+
+        void set_entry_point(address ep) override;
+        address get_entry_point() override;
+
+        void set_stack_top(address addr) override;
+        address get_stack_top() override;
+
+        void prepare_rescheduling() override;
+
+        bool is_thumb_mode() override;
+
+        void page_table_changed() override;
+
+        void map_backing_mem(address vaddr, size_t size, uint8_t *ptr, prot protection) override;
+        void unmap_memory(address addr, size_t size) override;
+
+        void clear_instruction_cache() override;
+        void imb_range(address addr, std::size_t size) override;
+
+        std::uint32_t get_num_instruction_executed() override;
+
+        bool should_clear_old_memory_map() const override;
+
+        void set_asid(std::uint8_t num) override;
+        std::uint8_t get_asid() const override;
+        std::uint8_t get_max_asid_available() const override;
+    };
+}
@@ -27,10 +27,14 @@ namespace eka2l1::arm {
     static constexpr const char *dynarmic_jit_backend_name = "dynarmic"; ///< Dynarmic recompiler backend name
     static constexpr const char *unicorn_jit_backend_name = "unicorn"; ///< Unicorn recompiler backend name
     static constexpr const char *earm_jit_backend_name = "earm"; ///< EKA2L1's ARM recompiler backend name
+    static constexpr const char *interpreter_backend_name = "12l1r"; ///< EKA2L1's ARM interpreter backend name
+    static constexpr const char *tiered_backend_name = "tiered"; ///< Interpreter, then dynarmic for hot code
 
     static constexpr const char *dynarmic_jit_backend_formal_name = "Dynarmic"; ///< Dynarmic recompiler backend name
     static constexpr const char *unicorn_jit_backend_formal_name = "Unicorn"; ///< Unicorn recompiler backend name
     static constexpr const char *earm_jit_backend_formal_name = "EARM"; ///< EKA2L1's ARM recompiler backend name
+    static constexpr const char *interpreter_backend_formal_name = "12L1R Interpreter"; ///< EKA2L1's ARM interpreter backend name
+    static constexpr const char *tiered_backend_formal_name = "12L1R + Dynarmic"; ///< Interpreter, then dynarmic for hot code
 
     /**
      * \brief Dump the given thread context to log.
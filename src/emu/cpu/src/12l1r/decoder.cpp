@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cpu/12l1r/decoder.h>
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace eka2l1::arm::r12l1 {
+    static const char *OP_NAMES[] = {
+#define OP(name) #name,
+#include <cpu/12l1r/ops.def>
+#undef OP
+    };
+
+    template <typename T, typename R>
+    struct matcher {
+        T mask_;
+        T expect_;
+        bool has_cond_;
+        R result_;
+
+        bool matches(const T inst) const {
+            return (inst & mask_) == expect_;
+        }
+    };
+
+    template <typename T, typename R>
+    static matcher<T, R> make_matcher(const char *bitstring, const R result) {
+        matcher<T, R> target{ 0, 0, false, result };
+        const std::size_t bit_count = std::strlen(bitstring);
+
+        for (std::size_t i = 0; i < bit_count; i++) {
+            const T bit = static_cast<T>(1) << (bit_count - i - 1);
+
+            switch (bitstring[i]) {
+            case '0':
+                target.mask_ |= bit;
+                break;
+
+            case '1':
+                target.mask_ |= bit;
+                target.expect_ |= bit;
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        target.has_cond_ = (bitstring[0] == 'c');
+        return target;
+    }
+
+    // Same as Dynarmic: an entry with more fixed bits is more specific, so try it first.
+    template <typename T, typename R>
+    static void sort_by_specificity(std::vector<matcher<T, R>> &table) {
+        std::stable_sort(table.begin(), table.end(), [](const matcher<T, R> &lhs, const matcher<T, R> &rhs) {
+            return std::bitset<32>(lhs.mask_).count() > std::bitset<32>(rhs.mask_).count();
+        });
+    }
+
+    using arm_matcher = matcher<std::uint32_t, op>;
+    using thumb16_matcher = matcher<std::uint16_t, thumb16_op>;
+
+    struct arm_decode_tables {
+        std::vector<arm_matcher> vfp_;
+        std::vector<arm_matcher> arm_;
+
+        explicit arm_decode_tables() {
+            std::unordered_map<std::string, op> op_lookup;
+
+            for (std::size_t i = 0; i < static_cast<std::size_t>(op::total_count); i++) {
+                op_lookup.emplace(OP_NAMES[i], static_cast<op>(i));
+            }
+
+            auto resolve = [&](const char *fn_name) {
+                auto result = op_lookup.find(fn_name);
+                return (result == op_lookup.end()) ? op::unimplemented : result->second;
+            };
+
+#define INST(fn, name, bitstring) vfp_.push_back(make_matcher<std::uint32_t>(bitstring, resolve(#fn)));
+#include <cpu/12l1r/encoding/vfp.inc>
+#undef INST
+
+#define INST(fn, name, bitstring) arm_.push_back(make_matcher<std::uint32_t>(bitstring, resolve(#fn)));
+#include <cpu/12l1r/encoding/arm.inc>
+#undef INST
+
+            sort_by_specificity(vfp_);
+            sort_by_specificity(arm_);
+        }
+    };
+
+    struct thumb16_decode_table {
+        std::vector<thumb16_matcher> thumb16_;
+
+        explicit thumb16_decode_table() {
+            static const std::pair<thumb16_op, const char *> ENTRIES[] = {
+#define INST(fn, name, bitstring) { thumb16_op::fn, bitstring }
+#include <cpu/12l1r/encoding/thumb16.inc>
+#undef INST
+            };
+
+            for (const auto &entry : ENTRIES) {
+                thumb16_.push_back(make_matcher<std::uint16_t>(entry.second, entry.first));
+            }
+
+            sort_by_specificity(thumb16_);
+        }
+    };
+
+    template <typename T, typename R>
+    static const matcher<T, R> *find_matcher(const std::vector<matcher<T, R>> &table, const T inst) {
+        for (const matcher<T, R> &entry : table) {
+            if (entry.matches(inst)) {
+                return &entry;
+            }
+        }
+
+        return nullptr;
+    }
+
+    op decode_arm(const std::uint32_t inst) {
+        static const arm_decode_tables tables;
+
+        const arm_matcher *result = find_matcher(tables.vfp_, inst);
+
+        if (!result) {
+            result = find_matcher(tables.arm_, inst);
+        }
+
+        if (!result) {
+            return op::unimplemented;
+        }
+
+        // Condition 0b1111 is the unconditional space. Entries with a condition field don't live there.
+        if (result->has_cond_ && ((inst >> 28) == 0b1111)) {
+            return op::unimplemented;
+        }
+
+        return result->result_;
+    }
+
+    thumb16_op decode_thumb16(const std::uint16_t inst) {
+        static const thumb16_decode_table table;
+
+        const thumb16_matcher *result = find_matcher(table.thumb16_, inst);
+        return result ? result->result_ : thumb16_op::unknown;
+    }
+
+    const char *op_name(const op target) {
+        if (target >= op::total_count) {
+            return "unknown";
+        }
+
+        return OP_NAMES[static_cast<std::size_t>(target)];
+    }
+}
@@ -0,0 +1,2093 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cpu/12l1r/interpreter.h>
+#include <cpu/12l1r/semantics.h>
+
+#include <common/log.h>
+
+#include <algorithm>
+#include <cstring>
+
+// Dispatch through label addresses where the compiler supports it. Every handler then ends with its own
+// indirect jump, which branch predictors track separately, instead of all going through one switch.
+#if defined(__GNUC__) || defined(__clang__)
+#define R12L1_COMPUTED_GOTO 1
+#else
+#define R12L1_COMPUTED_GOTO 0
+#endif
+
+namespace eka2l1::arm::r12l1 {
+    static constexpr std::uint8_t COND_ALWAYS = 0b1110;
+    static constexpr std::size_t COND_CHECK_HANDLER = static_cast<std::size_t>(op::total_count);
+
+    static std::uint64_t make_block_key(const address pc, const bool thumb, const std::uint8_t asid) {
+        return (static_cast<std::uint64_t>(asid) << 33) | (static_cast<std::uint64_t>(pc) << 1) | (thumb ? 1 : 0);
+    }
+
+    interpreter_exclusive_monitor::interpreter_exclusive_monitor(const std::size_t processor_count)
+        : reservations_(processor_count) {
+    }
+
+    template <typename T, typename F>
+    T interpreter_exclusive_monitor::read_and_mark(core *cc, const address vaddr, F read_func) {
+        const std::lock_guard<std::mutex> guard(lock_);
+
+        // TODO: Access violation if there is
+        T value = 0;
+        read_func(cc, vaddr, &value);
+
+        reservation &target = reservations_[cc->core_number()];
+        target.addr_ = vaddr;
+        target.value_ = value;
+        target.valid_ = true;
+
+        return value;
+    }
+
+    template <typename T, typename F>
+    bool interpreter_exclusive_monitor::write_if_marked(core *cc, const address vaddr, F write_func) {
+        const std::lock_guard<std::mutex> guard(lock_);
+        reservation &target = reservations_[cc->core_number()];
+
+        if (!target.valid_ || (target.addr_ != vaddr)) {
+            target.valid_ = false;
+            return false;
+        }
+
+        // TODO: Parse access violation errors
+        const bool result = write_func(static_cast<T>(target.value_)) > 0;
+
+        for (reservation &other : reservations_) {
+            if (other.addr_ == vaddr) {
+                other.valid_ = false;
+            }
+        }
+
+        return result;
+    }
+
+    std::uint8_t interpreter_exclusive_monitor::exclusive_read8(core *cc, address vaddr) {
+        return read_and_mark<std::uint8_t>(cc, vaddr, read_8bit);
+    }
+
+    std::uint16_t interpreter_exclusive_monitor::exclusive_read16(core *cc, address vaddr) {
+        return read_and_mark<std::uint16_t>(cc, vaddr, read_16bit);
+    }
+
+    std::uint32_t interpreter_exclusive_monitor::exclusive_read32(core *cc, address vaddr) {
+        return read_and_mark<std::uint32_t>(cc, vaddr, read_32bit);
+    }
+
+    std::uint64_t interpreter_exclusive_monitor::exclusive_read64(core *cc, address vaddr) {
+        return read_and_mark<std::uint64_t>(cc, vaddr, read_64bit);
+    }
+
+    void interpreter_exclusive_monitor::clear_exclusive() {
+        const std::lock_guard<std::mutex> guard(lock_);
+
+        for (reservation &target : reservations_) {
+            target.valid_ = false;
+        }
+    }
+
+    bool interpreter_exclusive_monitor::exclusive_write8(core *cc, address vaddr, std::uint8_t value) {
+        return write_if_marked<std::uint8_t>(cc, vaddr, [&](std::uint8_t expected) {
+            return write_8bit(cc, vaddr, value, expected);
+        });
+    }
+
+    bool interpreter_exclusive_monitor::exclusive_write16(core *cc, address vaddr, std::uint16_t value) {
+        return write_if_marked<std::uint16_t>(cc, vaddr, [&](std::uint16_t expected) {
+            return write_16bit(cc, vaddr, value, expected);
+        });
+    }
+
+    bool interpreter_exclusive_monitor::exclusive_write32(core *cc, address vaddr, std::uint32_t value) {
+        return write_if_marked<std::uint32_t>(cc, vaddr, [&](std::uint32_t expected) {
+            return write_32bit(cc, vaddr, value, expected);
+        });
+    }
+
+    bool interpreter_exclusive_monitor::exclusive_write64(core *cc, address vaddr, std::uint64_t value) {
+        return write_if_marked<std::uint64_t>(cc, vaddr, [&](std::uint64_t expected) {
+            return write_64bit(cc, vaddr, value, expected);
+        });
+    }
+
+    interpreter_core::interpreter_core(exclusive_monitor *monitor, const std::size_t core_num)
+        : monitor_(monitor)
+        , monitor_owner_(this)
+        , page_table_(1 << (32 - PAGE_BITS), nullptr) {
+        set_core_number(core_num);
+        fast_lookup_.fill(nullptr);
+    }
+
+    interpreter_core::~interpreter_core() {
+    }
+
+    template <typename T>
+    bool interpreter_core::read_memory(const address addr, T &value) {
+        std::uint8_t *page = page_table_[addr >> PAGE_BITS];
+
+        if (page && ((addr & PAGE_MASK) <= PAGE_SIZE - sizeof(T))) {
+            std::memcpy(&value, page + (addr & PAGE_MASK), sizeof(T));
+            return true;
+        }
+
+        bool result = false;
+
+        if constexpr (sizeof(T) == 1) {
+            std::uint8_t data = 0;
+            result = read_8bit(addr, &data);
+            value = static_cast<T>(data);
+        } else if constexpr (sizeof(T) == 2) {
+            std::uint16_t data = 0;
+            result = read_16bit(addr, &data);
+            value = static_cast<T>(data);
+        } else if constexpr (sizeof(T) == 4) {
+            std::uint32_t data = 0;
+            result = read_32bit(addr, &data);
+            value = static_cast<T>(data);
+        } else {
+            std::uint64_t data = 0;
+            result = read_64bit(addr, &data);
+            value = static_cast<T>(data);
+        }
+
+        return result;
+    }
+
+    template <typename T>
+    bool interpreter_core::write_memory(const address addr, T value) {
+        std::uint8_t *page = page_table_[addr >> PAGE_BITS];
+
+        if (page && ((addr & PAGE_MASK) <= PAGE_SIZE - sizeof(T))) {
+            std::memcpy(page + (addr & PAGE_MASK), &value, sizeof(T));
+            return true;
+        }
+
+        if constexpr (sizeof(T) == 1) {
+            std::uint8_t data = static_cast<std::uint8_t>(value);
+            return write_8bit(addr, &data);
+        } else if constexpr (sizeof(T) == 2) {
+            std::uint16_t data = static_cast<std::uint16_t>(value);
+            return write_16bit(addr, &data);
+        } else if constexpr (sizeof(T) == 4) {
+            std::uint32_t data = static_cast<std::uint32_t>(value);
+            return write_32bit(addr, &data);
+        } else {
+            std::uint64_t data = static_cast<std::uint64_t>(value);
+            return write_64bit(addr, &data);
+        }
+    }
+
+    bool interpreter_core::raise_memory_fault(const decoded_inst *inst, const exception_type type, const address fault_addr) {
+        // Like the JIT, report the fault and go on with the instruction, unless the handler stops the core
+        state_.regs_[15] = inst->addr();
+        exception_handler(type, fault_addr);
+
+        if (halt_requested_) {
+            return true;
+        }
+
+        state_.regs_[15] = inst->pc_read_;
+        return false;
+    }
+
+    void interpreter_core::translate(block &blk, const address pc, const bool thumb, const std::size_t max_insts,
+        const void *const *handlers) {
+        blk.start_ = pc;
+        blk.thumb_ = thumb;
+        blk.asid_ = asid_;
+        blk.hit_count_ = 0;
+        blk.insts_.clear();
+
+        const address page_end = (pc & ~PAGE_MASK) + PAGE_SIZE;
+        address current = pc;
+
+        while (blk.insts_.size() < max_insts) {
+            decoded_inst inst;
+            bool ends_block = false;
+            bool fetch_ok = true;
+
+            if (thumb) {
+                std::uint16_t first = 0;
+                std::uint16_t second = 0;
+
+                fetch_ok = read_memory(current, first);
+
+                if (fetch_ok) {
+                    // Only the BL/BLX prefix needs the next halfword
+                    const bool second_valid = ((first >> 11) == 0b11110) ? read_memory(current + 2, second) : false;
+                    ends_block = predecode_thumb(inst, first, second, second_valid, current);
+                }
+            } else {
+                std::uint32_t raw = 0;
+                fetch_ok = read_memory(current, raw);
+
+                if (fetch_ok) {
+                    ends_block = predecode_arm(inst, raw, current);
+                }
+            }
+
+            if (!fetch_ok) {
+                if (!blk.insts_.empty()) {
+                    // Let the fault happen when execution actually reaches the address
+                    break;
+                }
+
+                inst = decoded_inst{};
+                inst.opcode_ = op::fetch_fault;
+                inst.cond_ = COND_ALWAYS;
+                inst.size_ = thumb ? 2 : 4;
+                inst.flags_ = thumb ? inst_flag_thumb : 0;
+                inst.pc_read_ = current + (thumb ? 4 : 8);
+                inst.imm_ = current;
+
+                ends_block = true;
+            }
+
+            blk.insts_.push_back(inst);
+            current += inst.size_;
+
+            if (ends_block || (current >= page_end)) {
+                break;
+            }
+        }
+
+        decoded_inst end_inst{};
+        end_inst.opcode_ = op::block_end;
+        end_inst.cond_ = COND_ALWAYS;
+        end_inst.flags_ = thumb ? inst_flag_thumb : 0;
+        end_inst.pc_read_ = current + (thumb ? 4 : 8);
+
+        blk.insts_.push_back(end_inst);
+        blk.end_ = current;
+
+        if (handlers) {
+            for (decoded_inst &inst : blk.insts_) {
+                inst.handler_ = handlers[(inst.cond_ == COND_ALWAYS) ? static_cast<std::size_t>(inst.opcode_) : COND_CHECK_HANDLER];
+            }
+        }
+    }
+
+    block *interpreter_core::get_block(const address pc, const bool thumb, const void *const *handlers) {
+        block *&slot = fast_lookup_[(pc >> 1) & (FAST_LOOKUP_SIZE - 1)];
+
+        if (slot && (slot->start_ == pc) && (slot->thumb_ == thumb) && (slot->asid_ == asid_)) {
+            return slot;
+        }
+
+        const std::uint64_t key = make_block_key(pc, thumb, asid_);
+        auto result = blocks_.find(key);
+
+        if (result == blocks_.end()) {
+            auto new_block = std::make_unique<block>();
+            translate(*new_block, pc, thumb, MAX_BLOCK_INSTRUCTIONS, handlers);
+
+            if (new_block->insts_[0].opcode_ == op::fetch_fault) {
+                // The memory may be mapped later, don't keep the fault around
+                scratch_block_ = std::move(*new_block);
+                return &scratch_block_;
+            }
+
+            for (std::uint32_t page = new_block->start_ >> PAGE_BITS; page <= ((new_block->end_ - 1) >> PAGE_BITS); page++) {
+                page_blocks_[page].push_back(key);
+            }
+
+            result = blocks_.emplace(key, std::move(new_block)).first;
+        }
+
+        slot = result->second.get();
+        return slot;
+    }
+
+    void interpreter_core::retire_block(const std::uint64_t key) {
+        auto result = blocks_.find(key);
+
+        if (result == blocks_.end()) {
+            return;
+        }
+
+        // The block may be the one executing, if the invalidation comes from a system call
+        retired_blocks_.push_back(std::move(result->second));
+        blocks_.erase(result);
+    }
+
+    interpreter_core::exec_result interpreter_core::execute_block_transfer(const decoded_inst *inst) {
+        std::uint32_t *regs = state_.regs_.data();
+
+        const std::uint32_t list = inst->reg_list_;
+        const std::uint32_t size = static_cast<std::uint32_t>(popcount(list)) * 4;
+        const std::uint32_t base = regs[inst->rn_];
+
+        address target = base;
+        std::uint32_t written_back = base + size;
+
+        switch (inst->opcode_) {
+        case op::arm_LDMIB:
+        case op::arm_STMIB:
+            target = base + 4;
+            break;
+
+        case op::arm_LDMDA:
+        case op::arm_STMDA:
+            target = base - size + 4;
+            written_back = base - size;
+            break;
+
+        case op::arm_LDMDB:
+        case op::arm_STMDB:
+            target = base - size;
+            written_back = base - size;
+            break;
+
+        default:
+            break;
+        }
+
+        const bool is_load = (inst->opcode_ <= op::arm_LDMIB);
+
+        if (is_load) {
+            std::uint32_t loaded_pc = 0;
+
+            for (std::uint32_t i = 0; i < 16; i++) {
+                if (!(list & (1 << i))) {
+                    continue;
+                }
+
+                std::uint32_t value = 0;
+
+                if (!read_memory(target, value) && raise_memory_fault(inst, exception_type_access_violation_read, target)) {
+                    return exec_halt;
+                }
+
+                if (i == 15) {
+                    loaded_pc = value;
+                } else {
+                    regs[i] = value;
+                }
+
+                target += 4;
+            }
+
+            // The loaded value wins over the written back one
+            if ((inst->flags_ & inst_flag_write_back) && !(list & (1 << inst->rn_))) {
+                regs[inst->rn_] = written_back;
+            }
+
+            if (list & (1 << 15)) {
+                bx_write_pc(state_, loaded_pc);
+                return exec_branch;
+            }
+
+            return exec_next;
+        }
+
+        for (std::uint32_t i = 0; i < 16; i++) {
+            if (!(list & (1 << i))) {
+                continue;
+            }
+
+            if (!write_memory(target, regs[i]) && raise_memory_fault(inst, exception_type_access_violation_write, target)) {
+                return exec_halt;
+            }
+
+            target += 4;
+        }
+
+        if (inst->flags_ & inst_flag_write_back) {
+            regs[inst->rn_] = written_back;
+        }
+
+        return exec_next;
+    }
+
+    interpreter_core::exec_result interpreter_core::execute_exclusive(const decoded_inst *inst) {
+        std::uint32_t *regs = state_.regs_.data();
+        const address target = regs[inst->rn_];
+
+        // Without a monitor, there is nothing that can break the reservation
+        switch (inst->opcode_) {
+        case op::arm_LDREX:
+            if (monitor_) {
+                regs[inst->rd_] = monitor_->exclusive_read32(monitor_owner_, target);
+            } else if (!read_memory(target, regs[inst->rd_]) && raise_memory_fault(inst, exception_type_access_violation_read, target)) {
+                return exec_halt;
+            }
+
+            break;
+
+        case op::arm_LDREXB: {
+            std::uint8_t value = 0;
+
+            if (monitor_) {
+                value = monitor_->exclusive_read8(monitor_owner_, target);
+            } else if (!read_memory(target, value) && raise_memory_fault(inst, exception_type_access_violation_read, target)) {
+                return exec_halt;
+            }
+
+            regs[inst->rd_] = value;
+            break;
+        }
+
+        case op::arm_LDREXH: {
+            std::uint16_t value = 0;
+
+            if (monitor_) {
+                value = monitor_->exclusive_read16(monitor_owner_, target);
+            } else if (!read_memory(target, value) && raise_memory_fault(inst, exception_type_access_violation_read, target)) {
+                return exec_halt;
+            }
+
+            regs[inst->rd_] = value;
+            break;
+        }
+
+        case op::arm_LDREXD: {
+            std::uint64_t value = 0;
+
+            if (monitor_) {
+                value = monitor_->exclusive_read64(monitor_owner_, target);
+            } else if (!read_memory(target, value) && raise_memory_fault(inst, exception_type_access_violation_read, target)) {
+                return exec_halt;
+            }
+
+            regs[inst->rd_] = static_cast<std::uint32_t>(value);
+            regs[(inst->rd_ + 1) & 15] = static_cast<std::uint32_t>(value >> 32);
+            break;
+        }
+
+        case op::arm_STREX:
+        case op::arm_STREXB:
+        case op::arm_STREXH:
+        case op::arm_STREXD: {
+            const std::uint32_t value = regs[inst->rm_];
+            bool success = true;
+
+            if (monitor_) {
+                switch (inst->opcode_) {
+                case op::arm_STREX:
+                    success = monitor_->exclusive_write32(monitor_owner_, target, value);
+                    break;
+
+                case op::arm_STREXB:
+                    success = monitor_->exclusive_write8(monitor_owner_, target, static_cast<std::uint8_t>(value));
+                    break;
+
+                case op::arm_STREXH:
+                    success = monitor_->exclusive_write16(monitor_owner_, target, static_cast<std::uint16_t>(value));
+                    break;
+
+                default:
+                    success = monitor_->exclusive_write64(monitor_owner_, target, value
+                        | (static_cast<std::uint64_t>(regs[(inst->rm_ + 1) & 15]) << 32));
+                    break;
+                }
+            } else {
+                switch (inst->opcode_) {
+                case op::arm_STREX:
+                    success = write_memory(target, value);
+                    break;
+
+                case op::arm_STREXB:
+                    success = write_memory(target, static_cast<std::uint8_t>(value));
+                    break;
+
+                case op::arm_STREXH:
+                    success = write_memory(target, static_cast<std::uint16_t>(value));
+                    break;
+
+                default:
+                    success = write_memory(target, value | (static_cast<std::uint64_t>(regs[(inst->rm_ + 1) & 15]) << 32));
+                    break;
+                }
+
+                if (!success && raise_memory_fault(inst, exception_type_access_violation_write, target)) {
+                    return exec_halt;
+                }
+            }
+
+            regs[inst->rd_] = success ? 0 : 1;
+            break;
+        }
+
+        default:
+            if (monitor_) {
+                monitor_->clear_exclusive();
+            }
+
+            break;
+        }
+
+        return exec_next;
+    }
+
+    interpreter_core::exec_result interpreter_core::execute_coprocessor(const decoded_inst *inst) {
+        const std::uint32_t raw = inst->raw_;
+
+        const std::uint32_t coproc = (raw >> 8) & 0xF;
+        const std::uint32_t opc1 = (raw >> 21) & 0x7;
+        const std::uint32_t crn = (raw >> 16) & 0xF;
+        const std::uint32_t crm = raw & 0xF;
+        const std::uint32_t opc2 = (raw >> 5) & 0x7;
+
+        if (coproc == 15) {
+            // The software thread ID register, the same one the JIT exposes
+            if ((crn == 13) && (crm == 0) && (opc1 == 0) && (opc2 == 2)) {
+                if (inst->opcode_ == op::arm_MRC) {
+                    if (inst->rd_ == 15) {
+                        set_nzcv(state_, state_.wrwr_);
+                    } else {
+                        state_.regs_[inst->rd_] = state_.wrwr_;
+                    }
+                } else {
+                    state_.wrwr_ = state_.regs_[inst->rd_];
+                }
+
+                return exec_next;
+            }
+
+            // ARMv6 cache maintenance and barriers. Nothing to do, the cache is invalidated through IMB.
+            if ((inst->opcode_ == op::arm_MCR) && (crn == 7) && (opc1 == 0)) {
+                return exec_next;
+            }
+        }
+
+        state_.regs_[15] = inst->addr();
+        exception_handler(exception_type_undefined_inst, inst->addr());
+
+        return exec_branch;
+    }
+
+    interpreter_core::exec_result interpreter_core::execute_vfp_transfer(const decoded_inst *inst) {
+        std::uint32_t *regs = state_.regs_.data();
+        std::uint32_t *ext_regs = state_.ext_regs_.data();
+
+        const bool is_load = (inst->opcode_ == op::vfp_VLDR) || (inst->opcode_ == op::vfp_VPOP)
+            || (inst->opcode_ == op::vfp_VLDM_a1) || (inst->opcode_ == op::vfp_VLDM_a2);
+
+        address target = 0;
+        std::uint32_t count = 0;
+
+        if ((inst->opcode_ == op::vfp_VLDR) || (inst->opcode_ == op::vfp_VSTR)) {
+            const address base = (inst->rn_ == 15) ? (inst->pc_read_ & ~3U) : regs[inst->rn_];
+
+            target = (inst->flags_ & inst_flag_add_offset) ? (base + inst->imm_) : (base - inst->imm_);
+            count = (inst->flags_ & inst_flag_double) ? 2 : 1;
+        } else {
+            const address base = regs[inst->rn_];
+            const std::uint32_t size = inst->imm_ * 4;
+
+            target = (inst->flags_ & inst_flag_add_offset) ? base : (base - size);
+
+            // An odd count of double words carries one more unused word (FLDMX/FSTMX)
+            count = (inst->flags_ & inst_flag_double) ? (inst->imm_ & ~1U) : inst->imm_;
+
+            if (inst->flags_ & inst_flag_write_back) {
+                regs[inst->rn_] = (inst->flags_ & inst_flag_add_offset) ? (base + size) : (base - size);
+            }
+        }
+
+        for (std::uint32_t i = 0; i < count; i++, target += 4) {
+            std::uint32_t &reg = ext_regs[(inst->rd_ + i) & 63];
+
+            if (is_load) {
+                if (!read_memory(target, reg) && raise_memory_fault(inst, exception_type_access_violation_read, target)) {
+                    return exec_halt;
+                }
+            } else if (!write_memory(target, reg) && raise_memory_fault(inst, exception_type_access_violation_write, target)) {
+                return exec_halt;
+            }
+        }
+
+        return exec_next;
+    }
+
+    void interpreter_core::execute(const bool single_step) {
+        std::uint32_t *regs = state_.regs_.data();
+        std::uint32_t *ext_regs = state_.ext_regs_.data();
+
+        const decoded_inst *inst = nullptr;
+        bool stepped = false;
+
+#if R12L1_COMPUTED_GOTO
+#define HANDLER(name) handler_##name:
+#define DISPATCH() goto *inst->handler_
+#define DISPATCH_UNCONDITIONAL() goto *handler_table[static_cast<std::size_t>(inst->opcode_)]
+
+        static const void *const handler_table[] = {
+#define OP(name) &&handler_##name,
+#include <cpu/12l1r/ops.def>
+#undef OP
+            &&handler_cond_check
+        };
+
+        const void *const *handlers = handler_table;
+#else
+#define HANDLER(name) case op::name:
+#define DISPATCH() goto dispatch
+#define DISPATCH_UNCONDITIONAL() goto dispatch_unconditional
+
+        const void *const *handlers = nullptr;
+#endif
+
+#define NEXT()                          \
+    do {                                \
+        ++inst;                         \
+        regs[15] = inst->pc_read_;      \
+        DISPATCH();                     \
+    } while (0)
+
+#define HANDLE_RESULT(result)           \
+    switch (result) {                   \
+    case exec_next:                     \
+        NEXT();                         \
+                                        \
+    case exec_branch:                   \
+        goto block_lookup;              \
+                                        \
+    default:                            \
+        goto halted;                    \
+    }
+
+#define READ_OR_FAULT(where, value)                                                                                         \
+    if (!read_memory(where, value) && raise_memory_fault(inst, exception_type_access_violation_read, where)) {              \
+        goto halted;                                                                                                        \
+    }
+
+#define WRITE_OR_FAULT(where, value)                                                                                        \
+    if (!write_memory(where, value) && raise_memory_fault(inst, exception_type_access_violation_write, where)) {            \
+        goto halted;                                                                                                        \
+    }
+
+#define SET_NZ(value)                                   \
+    state_.n_ = (value) >> 31;                          \
+    state_.z_ = (value) == 0;
+
+#define WRITE_ALU_RESULT(value)                         \
+    if (inst->rd_ == 15) {                              \
+        alu_write_pc(state_, value);                    \
+        goto block_lookup;                              \
+    }                                                   \
+                                                        \
+    regs[inst->rd_] = value;                            \
+    NEXT();
+
+    block_lookup:
+        if (!retired_blocks_.empty()) {
+            retired_blocks_.clear();
+        }
+
+        if (halt_requested_ || halt_requested() || (ticks_executed_ >= ticks_target_)) {
+            goto halted;
+        }
+
+        {
+            block *blk = nullptr;
+
+            if (single_step) {
+                if (stepped) {
+                    goto halted;
+                }
+
+                translate(scratch_block_, regs[15], state_.t_, 1, handlers);
+                blk = &scratch_block_;
+                stepped = true;
+            } else {
+                blk = get_block(regs[15], state_.t_, handlers);
+
+                if (hot_block_threshold_ && (++blk->hit_count_ > hot_block_threshold_)) {
+                    exited_on_hot_block_ = true;
+                    goto halted;
+                }
+            }
+
+            // Counted ahead, so it's already right when a system call or an exception looks at it
+            ticks_executed_ += static_cast<std::uint32_t>(blk->insts_.size() - 1);
+
+            inst = blk->insts_.data();
+            regs[15] = inst->pc_read_;
+        }
+
+#if R12L1_COMPUTED_GOTO
+        DISPATCH();
+
+        {
+#else
+    dispatch:
+        if (inst->cond_ != COND_ALWAYS) {
+            goto handler_cond_check;
+        }
+
+    dispatch_unconditional:
+        switch (inst->opcode_) {
+#endif
+        HANDLER(block_end) {
+            regs[15] = inst->addr();
+            goto block_lookup;
+        }
+
+        HANDLER(unimplemented) {
+            if (inst->flags_ & inst_flag_thumb) {
+                LOG_ERROR(CPU, "Unimplemented Thumb instruction 0x{:04X} at 0x{:X}", inst->raw_, inst->addr());
+            } else {
+                LOG_ERROR(CPU, "Unimplemented ARM instruction 0x{:08X} at 0x{:X}", inst->raw_, inst->addr());
+            }
+
+            regs[15] = inst->addr();
+            exception_handler(exception_type_undefined_inst, inst->addr());
+
+            goto block_lookup;
+        }
+
+        HANDLER(fetch_fault) {
+            regs[15] = inst->addr();
+            exception_handler(exception_type_access_violation_read, inst->imm_);
+
+            goto block_lookup;
+        }
+
+        // Data processing
+#define OPERAND_imm                                                                             \
+    const std::uint32_t op2 = inst->imm_;                                                       \
+    [[maybe_unused]] const bool shifter_carry = inst->shift_imm_ ? (op2 >> 31) : state_.c_;
+
+#define OPERAND_reg                                                                             \
+    [[maybe_unused]] bool shifter_carry = false;                                                \
+    const std::uint32_t op2 = shift_with_carry(regs[inst->rm_], inst->shift_type_,              \
+        inst->shift_imm_, state_.c_, shifter_carry);
+
+#define OPERAND_rsr                                                                             \
+    [[maybe_unused]] bool shifter_carry = false;                                                \
+    const std::uint32_t op2 = shift_with_carry(regs[inst->rm_], inst->shift_type_,              \
+        regs[inst->rs_] & 0xFF, state_.c_, shifter_carry);
+
+#define LOGICAL(expr)                                   \
+    const std::uint32_t result = (expr);                \
+                                                        \
+    if (inst->flags_ & inst_flag_set_flags) {           \
+        SET_NZ(result)                                  \
+        state_.c_ = shifter_carry;                      \
+    }                                                   \
+                                                        \
+    WRITE_ALU_RESULT(result)
+
+#define ARITH(a, b, carry_in)                                                               \
+    bool carry_out = false;                                                                 \
+    bool overflow = false;                                                                  \
+    const std::uint32_t result = add_with_carry(a, b, carry_in, carry_out, overflow);      \
+                                                                                            \
+    if (inst->flags_ & inst_flag_set_flags) {                                               \
+        SET_NZ(result)                                                                      \
+        state_.c_ = carry_out;                                                              \
+        state_.v_ = overflow;                                                               \
+    }                                                                                       \
+                                                                                            \
+    WRITE_ALU_RESULT(result)
+
+#define TEST_LOGICAL(expr)                              \
+    const std::uint32_t result = (expr);                \
+    SET_NZ(result)                                      \
+    state_.c_ = shifter_carry;                          \
+    NEXT();
+
+#define TEST_ARITH(a, b, carry_in)                                                          \
+    bool carry_out = false;                                                                 \
+    bool overflow = false;                                                                  \
+    const std::uint32_t result = add_with_carry(a, b, carry_in, carry_out, overflow);      \
+    SET_NZ(result)                                                                          \
+    state_.c_ = carry_out;                                                                  \
+    state_.v_ = overflow;                                                                   \
+    NEXT();
+
+#define DP_HANDLERS(name, ...)                                  \
+        HANDLER(arm_##name##_imm) {                             \
+            OPERAND_imm                                         \
+            __VA_ARGS__                                         \
+        }                                                       \
+                                                                \
+        HANDLER(arm_##name##_reg) {                             \
+            OPERAND_reg                                         \
+            __VA_ARGS__                                         \
+        }                                                       \
+                                                                \
+        HANDLER(arm_##name##_rsr) {                             \
+            OPERAND_rsr                                         \
+            __VA_ARGS__                                         \
+        }
+
+        DP_HANDLERS(AND, LOGICAL(regs[inst->rn_] & op2))
+        DP_HANDLERS(EOR, LOGICAL(regs[inst->rn_] ^ op2))
+        DP_HANDLERS(ORR, LOGICAL(regs[inst->rn_] | op2))
+        DP_HANDLERS(BIC, LOGICAL(regs[inst->rn_] & ~op2))
+        DP_HANDLERS(MOV, LOGICAL(op2))
+        DP_HANDLERS(MVN, LOGICAL(~op2))
+        DP_HANDLERS(SUB, ARITH(regs[inst->rn_], ~op2, true))
+        DP_HANDLERS(RSB, ARITH(~regs[inst->rn_], op2, true))
+        DP_HANDLERS(ADD, ARITH(regs[inst->rn_], op2, false))
+        DP_HANDLERS(ADC, ARITH(regs[inst->rn_], op2, state_.c_))
+        DP_HANDLERS(SBC, ARITH(regs[inst->rn_], ~op2, state_.c_))
+        DP_HANDLERS(RSC, ARITH(~regs[inst->rn_], op2, state_.c_))
+        DP_HANDLERS(TST, TEST_LOGICAL(regs[inst->rn_] & op2))
+        DP_HANDLERS(TEQ, TEST_LOGICAL(regs[inst->rn_] ^ op2))
+        DP_HANDLERS(CMP, TEST_ARITH(regs[inst->rn_], ~op2, true))
+        DP_HANDLERS(CMN, TEST_ARITH(regs[inst->rn_], op2, false))
+
+#undef DP_HANDLERS
+#undef TEST_ARITH
+#undef TEST_LOGICAL
+#undef ARITH
+#undef LOGICAL
+#undef OPERAND_rsr
+#undef OPERAND_reg
+#undef OPERAND_imm
+
+        // Branches
+        HANDLER(arm_B) {
+            regs[15] = inst->imm_;
+            goto block_lookup;
+        }
+
+        HANDLER(arm_BL) {
+            regs[14] = inst->next_addr();
+            regs[15] = inst->imm_;
+
+            goto block_lookup;
+        }
+
+        HANDLER(arm_BLX_imm) {
+            regs[14] = inst->next_addr();
+            regs[15] = inst->imm_;
+            state_.t_ = true;
+
+            goto block_lookup;
+        }
+
+        HANDLER(arm_BLX_reg) {
+            const std::uint32_t target = regs[inst->rm_];
+            regs[14] = inst->next_addr() | (state_.t_ ? 1 : 0);
+
+            bx_write_pc(state_, target);
+            goto block_lookup;
+        }
+
+        HANDLER(arm_BX)
+        HANDLER(arm_BXJ) {
+            bx_write_pc(state_, regs[inst->rm_]);
+            goto block_lookup;
+        }
+
+        HANDLER(thumb32_BL) {
+            regs[14] = inst->next_addr() | 1;
+            regs[15] = inst->imm_;
+
+            goto block_lookup;
+        }
+
+        HANDLER(thumb32_BLX) {
+            regs[14] = inst->next_addr() | 1;
+            regs[15] = inst->imm_;
+            state_.t_ = false;
+
+            goto block_lookup;
+        }
+
+        HANDLER(thumb16_CBZ_CBNZ) {
+            const bool is_nonzero_branch = inst->shift_type_;
+            regs[15] = ((regs[inst->rn_] != 0) == is_nonzero_branch) ? inst->imm_ : inst->next_addr();
+
+            goto block_lookup;
+        }
+
+        // Exception generating
+        HANDLER(arm_SVC) {
+            regs[15] = inst->next_addr();
+            system_call_handler(inst->imm_);
+
+            goto block_lookup;
+        }
+
+        HANDLER(arm_BKPT) {
+            // The debugger decides what happens next. If it does nothing, the breakpoint is hit again.
+            regs[15] = inst->addr();
+            exception_handler(exception_type_breakpoint, inst->addr());
+
+            goto block_lookup;
+        }
+
+        HANDLER(arm_UDF) {
+            regs[15] = inst->addr();
+            exception_handler(exception_type_undefined_inst, inst->addr());
+
+            goto block_lookup;
+        }
+
+        HANDLER(arm_MCR)
+        HANDLER(arm_MRC) {
+            HANDLE_RESULT(execute_coprocessor(inst))
+        }
+
+        // Extension
+        HANDLER(arm_SXTB) {
+            regs[inst->rd_] = sign_extend_byte(rotate_right(regs[inst->rm_], inst->shift_imm_));
+            NEXT();
+        }
+
+        HANDLER(arm_SXTH) {
+            regs[inst->rd_] = sign_extend_half(rotate_right(regs[inst->rm_], inst->shift_imm_));
+            NEXT();
+        }
+
+        HANDLER(arm_SXTB16) {
+            regs[inst->rd_] = extend_byte_pairs(rotate_right(regs[inst->rm_], inst->shift_imm_), true);
+            NEXT();
+        }
+
+        HANDLER(arm_SXTAB) {
+            regs[inst->rd_] = regs[inst->rn_] + sign_extend_byte(rotate_right(regs[inst->rm_], inst->shift_imm_));
+            NEXT();
+        }
+
+        HANDLER(arm_SXTAH) {
+            regs[inst->rd_] = regs[inst->rn_] + sign_extend_half(rotate_right(regs[inst->rm_], inst->shift_imm_));
+            NEXT();
+        }
+
+        HANDLER(arm_SXTAB16) {
+            regs[inst->rd_] = add_halves(regs[inst->rn_], extend_byte_pairs(rotate_right(regs[inst->rm_], inst->shift_imm_), true));
+            NEXT();
+        }
+
+        HANDLER(arm_UXTB) {
+            regs[inst->rd_] = rotate_right(regs[inst->rm_], inst->shift_imm_) & 0xFF;
+            NEXT();
+        }
+
+        HANDLER(arm_UXTH) {
+            regs[inst->rd_] = rotate_right(regs[inst->rm_], inst->shift_imm_) & 0xFFFF;
+            NEXT();
+        }
+
+        HANDLER(arm_UXTB16) {
+            regs[inst->rd_] = extend_byte_pairs(rotate_right(regs[inst->rm_], inst->shift_imm_), false);
+            NEXT();
+        }
+
+        HANDLER(arm_UXTAB) {
+            regs[inst->rd_] = regs[inst->rn_] + (rotate_right(regs[inst->rm_], inst->shift_imm_) & 0xFF);
+            NEXT();
+        }
+
+        HANDLER(arm_UXTAH) {
+            regs[inst->rd_] = regs[inst->rn_] + (rotate_right(regs[inst->rm_], inst->shift_imm_) & 0xFFFF);
+            NEXT();
+        }
+
+        HANDLER(arm_UXTAB16) {
+            regs[inst->rd_] = add_halves(regs[inst->rn_], extend_byte_pairs(rotate_right(regs[inst->rm_], inst->shift_imm_), false));
+            NEXT();
+        }
+
+        // Hints and barriers. There is only one guest core running on each host thread.
+        HANDLER(arm_PLD_imm)
+        HANDLER(arm_PLD_reg)
+        HANDLER(arm_SEV)
+        HANDLER(arm_WFE)
+        HANDLER(arm_WFI)
+        HANDLER(arm_YIELD)
+        HANDLER(arm_NOP)
+        HANDLER(arm_DMB)
+        HANDLER(arm_DSB)
+        HANDLER(arm_ISB) {
+            NEXT();
+        }
+
+        // Synchronization
+        HANDLER(arm_CLREX)
+        HANDLER(arm_STREX)
+        HANDLER(arm_LDREX)
+        HANDLER(arm_STREXD)
+        HANDLER(arm_LDREXD)
+        HANDLER(arm_STREXB)
+        HANDLER(arm_LDREXB)
+        HANDLER(arm_STREXH)
+        HANDLER(arm_LDREXH) {
+            HANDLE_RESULT(execute_exclusive(inst))
+        }
+
+        HANDLER(arm_SWP) {
+            const address target = regs[inst->rn_];
+            std::uint32_t value = 0;
+
+            READ_OR_FAULT(target, value)
+            WRITE_OR_FAULT(target, regs[inst->rm_])
+
+            regs[inst->rd_] = value;
+            NEXT();
+        }
+
+        HANDLER(arm_SWPB) {
+            const address target = regs[inst->rn_];
+            std::uint8_t value = 0;
+
+            READ_OR_FAULT(target, value)
+            WRITE_OR_FAULT(target, static_cast<std::uint8_t>(regs[inst->rm_]))
+
+            regs[inst->rd_] = value;
+            NEXT();
+        }
+
+        // Load and store. Offset addressing writes back the computed address, post-indexing the offset one.
+#define LOAD_STORE_ADDRESS(offset)                                                                                  \
+    const std::uint32_t base = regs[inst->rn_];                                                                     \
+    const std::uint32_t offset_value = (offset);                                                                    \
+    const std::uint32_t offset_addr = (inst->flags_ & inst_flag_add_offset) ? (base + offset_value) : (base - offset_value); \
+    const address target = (inst->flags_ & inst_flag_pre_index) ? offset_addr : base;
+
+#define WRITE_BACK()                                    \
+    if (inst->flags_ & inst_flag_write_back) {          \
+        regs[inst->rn_] = offset_addr;                  \
+    }
+
+#define LOAD(type, extend)                              \
+    type value = 0;                                     \
+    READ_OR_FAULT(target, value)                        \
+    WRITE_BACK()                                        \
+                                                        \
+    if (inst->rd_ == 15) {                              \
+        bx_write_pc(state_, value);                     \
+        goto block_lookup;                              \
+    }                                                   \
+                                                        \
+    regs[inst->rd_] = extend(value);                    \
+    NEXT();
+
+#define STORE(type)                                                 \
+    WRITE_OR_FAULT(target, static_cast<type>(regs[inst->rd_]))      \
+    WRITE_BACK()                                                    \
+    NEXT();
+
+#define SHIFTED_OFFSET shift_value(regs[inst->rm_], inst->shift_type_, inst->shift_imm_, state_.c_)
+#define ZERO_EXTEND(value) static_cast<std::uint32_t>(value)
+#define SIGN_EXTEND(value) static_cast<std::uint32_t>(static_cast<std::int32_t>(value))
+
+        HANDLER(arm_LDR_lit)
+        HANDLER(arm_LDR_imm) {
+            LOAD_STORE_ADDRESS(inst->imm_)
+            LOAD(std::uint32_t, ZERO_EXTEND)
+        }
+
+        HANDLER(arm_LDR_reg) {
+            LOAD_STORE_ADDRESS(SHIFTED_OFFSET)
+            LOAD(std::uint32_t, ZERO_EXTEND)
+        }
+
+        HANDLER(arm_LDRB_lit)
+        HANDLER(arm_LDRB_imm) {
+            LOAD_STORE_ADDRESS(inst->imm_)
+            LOAD(std::uint8_t, ZERO_EXTEND)
+        }
+
+        HANDLER(arm_LDRB_reg) {
+            LOAD_STORE_ADDRESS(SHIFTED_OFFSET)
+            LOAD(std::uint8_t, ZERO_EXTEND)
+        }
+
+        HANDLER(arm_LDRH_lit)
+        HANDLER(arm_LDRH_imm) {
+            LOAD_STORE_ADDRESS(inst->imm_)
+            LOAD(std::uint16_t, ZERO_EXTEND)
+        }
+
+        HANDLER(arm_LDRH_reg) {
+            LOAD_STORE_ADDRESS(regs[inst->rm_])
+            LOAD(std::uint16_t, ZERO_EXTEND)
+        }
+
+        HANDLER(arm_LDRSB_lit)
+        HANDLER(arm_LDRSB_imm) {
+            LOAD_STORE_ADDRESS(inst->imm_)
+            LOAD(std::int8_t, SIGN_EXTEND)
+        }
+
+        HANDLER(arm_LDRSB_reg) {
+            LOAD_STORE_ADDRESS(regs[inst->rm_])
+            LOAD(std::int8_t, SIGN_EXTEND)
+        }
+
+        HANDLER(arm_LDRSH_lit)
+        HANDLER(arm_LDRSH_imm) {
+            LOAD_STORE_ADDRESS(inst->imm_)
+            LOAD(std::int16_t, SIGN_EXTEND)
+        }
+
+        HANDLER(arm_LDRSH_reg) {
+            LOAD_STORE_ADDRESS(regs[inst->rm_])
+            LOAD(std::int16_t, SIGN_EXTEND)
+        }
+
+        HANDLER(thumb16_LDR_literal) {
+            std::uint32_t value = 0;
+            READ_OR_FAULT(inst->imm_, value)
+
+            regs[inst->rd_] = value;
+            NEXT();
+        }
+
+        HANDLER(arm_STR_imm) {
+            LOAD_STORE_ADDRESS(inst->imm_)
+            STORE(std::uint32_t)
+        }
+
+        HANDLER(arm_STR_reg) {
+            LOAD_STORE_ADDRESS(SHIFTED_OFFSET)
+            STORE(std::uint32_t)
+        }
+
+        HANDLER(arm_STRB_imm) {
+            LOAD_STORE_ADDRESS(inst->imm_)
+            STORE(std::uint8_t)
+        }
+
+        HANDLER(arm_STRB_reg) {
+            LOAD_STORE_ADDRESS(SHIFTED_OFFSET)
+            STORE(std::uint8_t)
+        }
+
+        HANDLER(arm_STRH_imm) {
+            LOAD_STORE_ADDRESS(inst->imm_)
+            STORE(std::uint16_t)
+        }
+
+        HANDLER(arm_STRH_reg) {
+            LOAD_STORE_ADDRESS(regs[inst->rm_])
+            STORE(std::uint16_t)
+        }
+
+#define LOAD_DUAL()                                                 \
+    std::uint32_t low = 0;                                          \
+    std::uint32_t high = 0;                                         \
+                                                                    \
+    READ_OR_FAULT(target, low)                                      \
+    READ_OR_FAULT(target + 4, high)                                 \
+    WRITE_BACK()                                                    \
+                                                                    \
+    regs[inst->rd_] = low;                                          \
+                                                                    \
+    if (inst->rd_ == 14) {                                          \
+        bx_write_pc(state_, high);                                  \
+        goto block_lookup;                                          \
+    }                                                               \
+                                                                    \
+    regs[(inst->rd_ + 1) & 15] = high;                              \
+    NEXT();
+
+#define STORE_DUAL()                                                \
+    WRITE_OR_FAULT(target, regs[inst->rd_])                         \
+    WRITE_OR_FAULT(target + 4, regs[(inst->rd_ + 1) & 15])          \
+    WRITE_BACK()                                                    \
+    NEXT();
+
+        HANDLER(arm_LDRD_lit)
+        HANDLER(arm_LDRD_imm) {
+            LOAD_STORE_ADDRESS(inst->imm_)
+            LOAD_DUAL()
+        }
+
+        HANDLER(arm_LDRD_reg) {
+            LOAD_STORE_ADDRESS(regs[inst->rm_])
+            LOAD_DUAL()
+        }
+
+        HANDLER(arm_STRD_imm) {
+            LOAD_STORE_ADDRESS(inst->imm_)
+            STORE_DUAL()
+        }
+
+        HANDLER(arm_STRD_reg) {
+            LOAD_STORE_ADDRESS(regs[inst->rm_])
+            STORE_DUAL()
+        }
+
+#undef STORE_DUAL
+#undef LOAD_DUAL
+#undef SIGN_EXTEND
+#undef ZERO_EXTEND
+#undef SHIFTED_OFFSET
+#undef STORE
+#undef LOAD
+#undef WRITE_BACK
+#undef LOAD_STORE_ADDRESS
+
+        HANDLER(arm_LDM)
+        HANDLER(arm_LDMDA)
+        HANDLER(arm_LDMDB)
+        HANDLER(arm_LDMIB)
+        HANDLER(arm_STM)
+        HANDLER(arm_STMDA)
+        HANDLER(arm_STMDB)
+        HANDLER(arm_STMIB) {
+            HANDLE_RESULT(execute_block_transfer(inst))
+        }
+
+        // Miscellaneous
+        HANDLER(arm_BFC) {
+            regs[inst->rd_] &= ~bitfield_mask(inst->shift_imm_, inst->imm_);
+            NEXT();
+        }
+
+        HANDLER(arm_BFI) {
+            const std::uint32_t mask = bitfield_mask(inst->shift_imm_, inst->imm_);
+            regs[inst->rd_] = (regs[inst->rd_] & ~mask) | ((regs[inst->rm_] << inst->shift_imm_) & mask);
+
+            NEXT();
+        }
+
+        HANDLER(arm_CLZ) {
+            regs[inst->rd_] = count_leading_zeros(regs[inst->rm_]);
+            NEXT();
+        }
+
+        HANDLER(arm_MOVT) {
+            regs[inst->rd_] = (regs[inst->rd_] & 0xFFFF) | (inst->imm_ << 16);
+            NEXT();
+        }
+
+        HANDLER(arm_MOVW) {
+            regs[inst->rd_] = inst->imm_;
+            NEXT();
+        }
+
+        HANDLER(arm_SBFX) {
+            const std::uint32_t width = inst->imm_ + 1;
+            const std::uint32_t field = regs[inst->rm_] >> inst->shift_imm_;
+
+            regs[inst->rd_] = (width >= 32) ? field : static_cast<std::uint32_t>(static_cast<std::int32_t>(field << (32 - width)) >> (32 - width));
+            NEXT();
+        }
+
+        HANDLER(arm_UBFX) {
+            const std::uint32_t width = inst->imm_ + 1;
+            const std::uint32_t field = regs[inst->rm_] >> inst->shift_imm_;
+
+            regs[inst->rd_] = (width >= 32) ? field : (field & ((1U << width) - 1));
+            NEXT();
+        }
+
+        HANDLER(arm_SEL) {
+            const std::uint32_t mask = ge_byte_mask(state_.ge_);
+            regs[inst->rd_] = (regs[inst->rn_] & mask) | (regs[inst->rm_] & ~mask);
+
+            NEXT();
+        }
+
+        HANDLER(arm_USAD8) {
+            regs[inst->rd_] = sum_absolute_byte_differences(regs[inst->rn_], regs[inst->rm_]);
+            NEXT();
+        }
+
+        HANDLER(arm_USADA8) {
+            regs[inst->rd_] = regs[inst->rs_] + sum_absolute_byte_differences(regs[inst->rn_], regs[inst->rm_]);
+            NEXT();
+        }
+
+        HANDLER(arm_PKHBT) {
+            const std::uint32_t shifted = shift_value(regs[inst->rm_], inst->shift_type_, inst->shift_imm_, state_.c_);
+            regs[inst->rd_] = (regs[inst->rn_] & 0xFFFF) | (shifted & 0xFFFF0000);
+
+            NEXT();
+        }
+
+        HANDLER(arm_PKHTB) {
+            const std::uint32_t shifted = shift_value(regs[inst->rm_], inst->shift_type_, inst->shift_imm_, state_.c_);
+            regs[inst->rd_] = (regs[inst->rn_] & 0xFFFF0000) | (shifted & 0xFFFF);
+
+            NEXT();
+        }
+
+        HANDLER(arm_RBIT) {
+            regs[inst->rd_] = reverse_bits(regs[inst->rm_]);
+            NEXT();
+        }
+
+        HANDLER(arm_REV) {
+            regs[inst->rd_] = byte_swap(regs[inst->rm_]);
+            NEXT();
+        }
+
+        HANDLER(arm_REV16) {
+            const std::uint32_t value = regs[inst->rm_];
+            regs[inst->rd_] = ((value & 0x00FF00FF) << 8) | ((value & 0xFF00FF00) >> 8);
+
+            NEXT();
+        }
+
+        HANDLER(arm_REVSH) {
+            const std::uint32_t value = regs[inst->rm_];
+            regs[inst->rd_] = sign_extend_half(((value & 0xFF) << 8) | ((value >> 8) & 0xFF));
+
+            NEXT();
+        }
+
+        HANDLER(arm_SSAT) {
+            const std::uint32_t operand = shift_value(regs[inst->rm_], inst->shift_type_, inst->shift_imm_, state_.c_);
+            regs[inst->rd_] = signed_saturate(static_cast<std::int32_t>(operand), inst->imm_ + 1, state_.q_);
+
+            NEXT();
+        }
+
+        HANDLER(arm_USAT) {
+            const std::uint32_t operand = shift_value(regs[inst->rm_], inst->shift_type_, inst->shift_imm_, state_.c_);
+            regs[inst->rd_] = unsigned_saturate(static_cast<std::int32_t>(operand), inst->imm_, state_.q_);
+
+            NEXT();
+        }
+
+        HANDLER(arm_SSAT16) {
+            const std::uint32_t value = regs[inst->rm_];
+            const std::uint32_t low = signed_saturate(static_cast<std::int16_t>(value), inst->imm_ + 1, state_.q_);
+            const std::uint32_t high = signed_saturate(static_cast<std::int16_t>(value >> 16), inst->imm_ + 1, state_.q_);
+
+            regs[inst->rd_] = (low & 0xFFFF) | (high << 16);
+            NEXT();
+        }
+
+        HANDLER(arm_USAT16) {
+            const std::uint32_t value = regs[inst->rm_];
+            const std::uint32_t low = unsigned_saturate(static_cast<std::int16_t>(value), inst->imm_, state_.q_);
+            const std::uint32_t high = unsigned_saturate(static_cast<std::int16_t>(value >> 16), inst->imm_, state_.q_);
+
+            regs[inst->rd_] = low | (high << 16);
+            NEXT();
+        }
+
+        HANDLER(arm_SDIV) {
+            const std::int32_t dividend = static_cast<std::int32_t>(regs[inst->rn_]);
+            const std::int32_t divisor = static_cast<std::int32_t>(regs[inst->rm_]);
+
+            if (divisor == 0) {
+                regs[inst->rd_] = 0;
+            } else if ((divisor == -1) && (dividend == INT32_MIN)) {
+                regs[inst->rd_] = static_cast<std::uint32_t>(dividend);
+            } else {
+                regs[inst->rd_] = static_cast<std::uint32_t>(dividend / divisor);
+            }
+
+            NEXT();
+        }
+
+        HANDLER(arm_UDIV) {
+            const std::uint32_t divisor = regs[inst->rm_];
+            regs[inst->rd_] = divisor ? (regs[inst->rn_] / divisor) : 0;
+
+            NEXT();
+        }
+
+        // Multiply. The destination is in rd, the accumulator (or the low half of long results) in rs.
+#define SET_NZ_LONG(value)                              \
+    if (inst->flags_ & inst_flag_set_flags) {           \
+        state_.n_ = (value) >> 63;                      \
+        state_.z_ = (value) == 0;                       \
+    }
+
+#define WRITE_LONG(value)                                                   \
+    regs[inst->rs_] = static_cast<std::uint32_t>(value);                    \
+    regs[inst->rd_] = static_cast<std::uint32_t>((value) >> 32);            \
+    NEXT();
+
+#define LONG_ACCUMULATOR ((static_cast<std::uint64_t>(regs[inst->rd_]) << 32) | regs[inst->rs_])
+#define BOTTOM_OR_TOP(value, top) static_cast<std::int32_t>(static_cast<std::int16_t>((top) ? ((value) >> 16) : (value)))
+
+        HANDLER(arm_MUL) {
+            const std::uint32_t result = regs[inst->rn_] * regs[inst->rm_];
+
+            if (inst->flags_ & inst_flag_set_flags) {
+                SET_NZ(result)
+            }
+
+            regs[inst->rd_] = result;
+            NEXT();
+        }
+
+        HANDLER(arm_MLA) {
+            const std::uint32_t result = regs[inst->rn_] * regs[inst->rm_] + regs[inst->rs_];
+
+            if (inst->flags_ & inst_flag_set_flags) {
+                SET_NZ(result)
+            }
+
+            regs[inst->rd_] = result;
+            NEXT();
+        }
+
+        HANDLER(arm_MLS) {
+            regs[inst->rd_] = regs[inst->rs_] - regs[inst->rn_] * regs[inst->rm_];
+            NEXT();
+        }
+
+        HANDLER(arm_UMULL) {
+            const std::uint64_t result = static_cast<std::uint64_t>(regs[inst->rn_]) * regs[inst->rm_];
+            SET_NZ_LONG(result)
+            WRITE_LONG(result)
+        }
+
+        HANDLER(arm_UMLAL) {
+            const std::uint64_t result = static_cast<std::uint64_t>(regs[inst->rn_]) * regs[inst->rm_] + LONG_ACCUMULATOR;
+            SET_NZ_LONG(result)
+            WRITE_LONG(result)
+        }
+
+        HANDLER(arm_SMULL) {
+            const std::uint64_t result = static_cast<std::uint64_t>(static_cast<std::int64_t>(static_cast<std::int32_t>(regs[inst->rn_]))
+                * static_cast<std::int32_t>(regs[inst->rm_]));
+
+            SET_NZ_LONG(result)
+            WRITE_LONG(result)
+        }
+
+        HANDLER(arm_SMLAL) {
+            const std::uint64_t result = static_cast<std::uint64_t>(static_cast<std::int64_t>(static_cast<std::int32_t>(regs[inst->rn_]))
+                * static_cast<std::int32_t>(regs[inst->rm_])) + LONG_ACCUMULATOR;
+
+            SET_NZ_LONG(result)
+            WRITE_LONG(result)
+        }
+
+        HANDLER(arm_UMAAL) {
+            const std::uint64_t result = static_cast<std::uint64_t>(regs[inst->rn_]) * regs[inst->rm_]
+                + regs[inst->rd_] + regs[inst->rs_];
+
+            WRITE_LONG(result)
+        }
+
+        HANDLER(arm_SMULxy) {
+            const std::int32_t result = BOTTOM_OR_TOP(regs[inst->rn_], inst->raw_ & (1 << 5))
+                * BOTTOM_OR_TOP(regs[inst->rm_], inst->raw_ & (1 << 6));
+
+            regs[inst->rd_] = static_cast<std::uint32_t>(result);
+            NEXT();
+        }
+
+        HANDLER(arm_SMLAxy) {
+            const std::int64_t result = static_cast<std::int64_t>(BOTTOM_OR_TOP(regs[inst->rn_], inst->raw_ & (1 << 5))
+                * BOTTOM_OR_TOP(regs[inst->rm_], inst->raw_ & (1 << 6))) + static_cast<std::int32_t>(regs[inst->rs_]);
+
+            regs[inst->rd_] = wrap_and_set_q(result, state_.q_);
+            NEXT();
+        }
+
+        HANDLER(arm_SMLALxy) {
+            const std::uint64_t result = static_cast<std::uint64_t>(static_cast<std::int64_t>(BOTTOM_OR_TOP(regs[inst->rn_], inst->raw_ & (1 << 5))
+                * BOTTOM_OR_TOP(regs[inst->rm_], inst->raw_ & (1 << 6)))) + LONG_ACCUMULATOR;
+
+            WRITE_LONG(result)
+        }
+
+        HANDLER(arm_SMULWy) {
+            const std::int64_t product = static_cast<std::int64_t>(static_cast<std::int32_t>(regs[inst->rn_]))
+                * BOTTOM_OR_TOP(regs[inst->rm_], inst->raw_ & (1 << 6));
+
+            regs[inst->rd_] = static_cast<std::uint32_t>(product >> 16);
+            NEXT();
+        }
+
+        HANDLER(arm_SMLAWy) {
+            const std::int64_t product = static_cast<std::int64_t>(static_cast<std::int32_t>(regs[inst->rn_]))
+                * BOTTOM_OR_TOP(regs[inst->rm_], inst->raw_ & (1 << 6));
+
+            regs[inst->rd_] = wrap_and_set_q((product >> 16) + static_cast<std::int32_t>(regs[inst->rs_]), state_.q_);
+            NEXT();
+        }
+
+#define MOST_SIGNIFICANT(accumulate)                                                                                \
+    const std::int64_t product = static_cast<std::int64_t>(static_cast<std::int32_t>(regs[inst->rn_]))              \
+        * static_cast<std::int32_t>(regs[inst->rm_]);                                                               \
+    const std::int64_t rounding = (inst->raw_ & (1 << 5)) ? 0x80000000LL : 0;                                       \
+    regs[inst->rd_] = static_cast<std::uint32_t>(static_cast<std::uint64_t>(accumulate + rounding) >> 32);          \
+    NEXT();
+
+        HANDLER(arm_SMMUL) {
+            MOST_SIGNIFICANT(product)
+        }
+
+        HANDLER(arm_SMMLA) {
+            MOST_SIGNIFICANT((static_cast<std::int64_t>(static_cast<std::uint64_t>(regs[inst->rs_]) << 32) + product))
+        }
+
+        HANDLER(arm_SMMLS) {
+            MOST_SIGNIFICANT((static_cast<std::int64_t>(static_cast<std::uint64_t>(regs[inst->rs_]) << 32) - product))
+        }
+
+#undef MOST_SIGNIFICANT
+
+        // Dual 16-bit multiplies. The M bit swaps the halves of the second operand.
+#define DUAL_PRODUCTS                                                                                               \
+    const std::uint32_t first = regs[inst->rn_];                                                                    \
+    const std::uint32_t second = (inst->raw_ & (1 << 5)) ? rotate_right(regs[inst->rm_], 16) : regs[inst->rm_];     \
+    const std::int64_t low_product = BOTTOM_OR_TOP(first, false) * BOTTOM_OR_TOP(second, false);                    \
+    const std::int64_t high_product = BOTTOM_OR_TOP(first, true) * BOTTOM_OR_TOP(second, true);
+
+        HANDLER(arm_SMUAD) {
+            DUAL_PRODUCTS
+            regs[inst->rd_] = wrap_and_set_q(low_product + high_product, state_.q_);
+
+            NEXT();
+        }
+
+        HANDLER(arm_SMUSD) {
+            DUAL_PRODUCTS
+            regs[inst->rd_] = static_cast<std::uint32_t>(low_product - high_product);
+
+            NEXT();
+        }
+
+        HANDLER(arm_SMLAD) {
+            DUAL_PRODUCTS
+            regs[inst->rd_] = wrap_and_set_q(low_product + high_product + static_cast<std::int32_t>(regs[inst->rs_]), state_.q_);
+
+            NEXT();
+        }
+
+        HANDLER(arm_SMLSD) {
+            DUAL_PRODUCTS
+            regs[inst->rd_] = wrap_and_set_q(low_product - high_product + static_cast<std::int32_t>(regs[inst->rs_]), state_.q_);
+
+            NEXT();
+        }
+
+        HANDLER(arm_SMLALD) {
+            DUAL_PRODUCTS
+            const std::uint64_t result = static_cast<std::uint64_t>(low_product + high_product) + LONG_ACCUMULATOR;
+
+            WRITE_LONG(result)
+        }
+
+        HANDLER(arm_SMLSLD) {
+            DUAL_PRODUCTS
+            const std::uint64_t result = static_cast<std::uint64_t>(low_product - high_product) + LONG_ACCUMULATOR;
+
+            WRITE_LONG(result)
+        }
+
+#undef DUAL_PRODUCTS
+#undef BOTTOM_OR_TOP
+#undef LONG_ACCUMULATOR
+#undef WRITE_LONG
+#undef SET_NZ_LONG
+
+        // Parallel add and subtract. The table lists them in groups of six operations for each variant.
+        HANDLER(arm_SADD8) HANDLER(arm_SADD16) HANDLER(arm_SASX) HANDLER(arm_SSAX) HANDLER(arm_SSUB8) HANDLER(arm_SSUB16)
+        HANDLER(arm_UADD8) HANDLER(arm_UADD16) HANDLER(arm_UASX) HANDLER(arm_USAX) HANDLER(arm_USUB8) HANDLER(arm_USUB16)
+        HANDLER(arm_QADD8) HANDLER(arm_QADD16) HANDLER(arm_QASX) HANDLER(arm_QSAX) HANDLER(arm_QSUB8) HANDLER(arm_QSUB16)
+        HANDLER(arm_UQADD8) HANDLER(arm_UQADD16) HANDLER(arm_UQASX) HANDLER(arm_UQSAX) HANDLER(arm_UQSUB8) HANDLER(arm_UQSUB16)
+        HANDLER(arm_SHADD8) HANDLER(arm_SHADD16) HANDLER(arm_SHASX) HANDLER(arm_SHSAX) HANDLER(arm_SHSUB8) HANDLER(arm_SHSUB16)
+        HANDLER(arm_UHADD8) HANDLER(arm_UHADD16) HANDLER(arm_UHASX) HANDLER(arm_UHSAX) HANDLER(arm_UHSUB8) HANDLER(arm_UHSUB16) {
+            const std::size_t index = static_cast<std::size_t>(inst->opcode_) - static_cast<std::size_t>(op::arm_SADD8);
+            regs[inst->rd_] = parallel_add_sub(static_cast<parallel_variant>(index / 6), static_cast<parallel_operation>(index % 6),
+                regs[inst->rn_], regs[inst->rm_], state_.ge_);
+
+            NEXT();
+        }
+
+        // Saturating. The first operand is Rm, the second one Rn.
+        HANDLER(arm_QADD) {
+            const std::int64_t result = static_cast<std::int64_t>(static_cast<std::int32_t>(regs[inst->rm_])) + static_cast<std::int32_t>(regs[inst->rn_]);
+            regs[inst->rd_] = signed_saturate(result, 32, state_.q_);
+
+            NEXT();
+        }
+
+        HANDLER(arm_QSUB) {
+            const std::int64_t result = static_cast<std::int64_t>(static_cast<std::int32_t>(regs[inst->rm_])) - static_cast<std::int32_t>(regs[inst->rn_]);
+            regs[inst->rd_] = signed_saturate(result, 32, state_.q_);
+
+            NEXT();
+        }
+
+        HANDLER(arm_QDADD) {
+            const std::int64_t doubled = static_cast<std::int32_t>(signed_saturate(static_cast<std::int64_t>(static_cast<std::int32_t>(regs[inst->rn_])) * 2, 32, state_.q_));
+            regs[inst->rd_] = signed_saturate(static_cast<std::int32_t>(regs[inst->rm_]) + doubled, 32, state_.q_);
+
+            NEXT();
+        }
+
+        HANDLER(arm_QDSUB) {
+            const std::int64_t doubled = static_cast<std::int32_t>(signed_saturate(static_cast<std::int64_t>(static_cast<std::int32_t>(regs[inst->rn_])) * 2, 32, state_.q_));
+            regs[inst->rd_] = signed_saturate(static_cast<std::int32_t>(regs[inst->rm_]) - doubled, 32, state_.q_);
+
+            NEXT();
+        }
+
+        // Status register. Only the user mode writable parts are changed.
+        HANDLER(arm_MRS) {
+            regs[inst->rd_] = get_cpsr();
+            NEXT();
+        }
+
+        HANDLER(arm_MSR_imm) {
+            write_apsr(state_, inst->imm_, inst->rs_);
+            NEXT();
+        }
+
+        HANDLER(arm_MSR_reg) {
+            write_apsr(state_, regs[inst->rm_], inst->rs_);
+            NEXT();
+        }
+
+        // VFP data processing, done with the host floating point
+#define VFP_BINARY(name, expr)                                                                                      \
+        HANDLER(vfp_##name) {                                                                                       \
+            const auto func = [](const auto d, const auto n, const auto m) { return expr; };                       \
+                                                                                                                    \
+            if (inst->flags_ & inst_flag_double) {                                                                  \
+                write_fp(ext_regs, inst->rd_, func(read_fp<double>(ext_regs, inst->rd_),                            \
+                    read_fp<double>(ext_regs, inst->rn_), read_fp<double>(ext_regs, inst->rm_)));                   \
+            } else {                                                                                                \
+                write_fp(ext_regs, inst->rd_, func(read_fp<float>(ext_regs, inst->rd_),                             \
+                    read_fp<float>(ext_regs, inst->rn_), read_fp<float>(ext_regs, inst->rm_)));                     \
+            }                                                                                                       \
+                                                                                                                    \
+            NEXT();                                                                                                 \
+        }
+
+#define VFP_UNARY(name, expr)                                                                                       \
+        HANDLER(vfp_##name) {                                                                                       \
+            const auto func = [](const auto m) { return expr; };                                                    \
+                                                                                                                    \
+            if (inst->flags_ & inst_flag_double) {                                                                  \
+                write_fp(ext_regs, inst->rd_, func(read_fp<double>(ext_regs, inst->rm_)));                          \
+            } else {                                                                                                \
+                write_fp(ext_regs, inst->rd_, func(read_fp<float>(ext_regs, inst->rm_)));                           \
+            }                                                                                                       \
+                                                                                                                    \
+            NEXT();                                                                                                 \
+        }
+
+        VFP_BINARY(VMLA, d + n * m)
+        VFP_BINARY(VMLS, d - n * m)
+        VFP_BINARY(VNMLS, -d + n * m)
+        VFP_BINARY(VNMLA, -d - n * m)
+        VFP_BINARY(VMUL, ((void)d, n * m))
+        VFP_BINARY(VNMUL, ((void)d, -(n * m)))
+        VFP_BINARY(VADD, ((void)d, n + m))
+        VFP_BINARY(VSUB, ((void)d, n - m))
+        VFP_BINARY(VDIV, ((void)d, n / m))
+
+        VFP_UNARY(VMOV_reg, m)
+        VFP_UNARY(VABS, std::abs(m))
+        VFP_UNARY(VNEG, -m)
+        VFP_UNARY(VSQRT, std::sqrt(m))
+
+#undef VFP_UNARY
+#undef VFP_BINARY
+
+        HANDLER(vfp_VMOV_imm) {
+            // The immediate of doubles only fills the high word
+            if (inst->flags_ & inst_flag_double) {
+                ext_regs[inst->rd_] = 0;
+                ext_regs[inst->rd_ + 1] = inst->imm_;
+            } else {
+                ext_regs[inst->rd_] = inst->imm_;
+            }
+
+            NEXT();
+        }
+
+        HANDLER(vfp_VCMP) {
+            if (inst->flags_ & inst_flag_double) {
+                state_.fpscr_ = compare_fp(state_.fpscr_, read_fp<double>(ext_regs, inst->rd_), read_fp<double>(ext_regs, inst->rm_));
+            } else {
+                state_.fpscr_ = compare_fp(state_.fpscr_, read_fp<float>(ext_regs, inst->rd_), read_fp<float>(ext_regs, inst->rm_));
+            }
+
+            NEXT();
+        }
+
+        HANDLER(vfp_VCMP_zero) {
+            if (inst->flags_ & inst_flag_double) {
+                state_.fpscr_ = compare_fp(state_.fpscr_, read_fp<double>(ext_regs, inst->rd_), 0.0);
+            } else {
+                state_.fpscr_ = compare_fp(state_.fpscr_, read_fp<float>(ext_regs, inst->rd_), 0.0f);
+            }
+
+            NEXT();
+        }
+
+        HANDLER(vfp_VCVT_f_to_f) {
+            if (inst->flags_ & inst_flag_double) {
+                write_fp(ext_regs, inst->rd_, static_cast<float>(read_fp<double>(ext_regs, inst->rm_)));
+            } else {
+                write_fp(ext_regs, inst->rd_, static_cast<double>(read_fp<float>(ext_regs, inst->rm_)));
+            }
+
+            NEXT();
+        }
+
+        HANDLER(vfp_VCVT_from_int) {
+            const std::uint32_t value = ext_regs[inst->rm_];
+            const bool is_signed = inst->raw_ & (1 << 7);
+
+            if (inst->flags_ & inst_flag_double) {
+                write_fp(ext_regs, inst->rd_, is_signed ? static_cast<double>(static_cast<std::int32_t>(value)) : static_cast<double>(value));
+            } else {
+                write_fp(ext_regs, inst->rd_, is_signed ? static_cast<float>(static_cast<std::int32_t>(value)) : static_cast<float>(value));
+            }
+
+            NEXT();
+        }
+
+        HANDLER(vfp_VCVT_to_u32)
+        HANDLER(vfp_VCVT_to_s32) {
+            // Without the r bit (VCVTR), the rounding mode comes from the FPSCR
+            const std::uint32_t rounding = (inst->raw_ & (1 << 7)) ? FPSCR_ROUND_TOWARDS_ZERO : ((state_.fpscr_ >> 22) & 3);
+            const bool is_signed = (inst->opcode_ == op::vfp_VCVT_to_s32);
+
+            if (inst->flags_ & inst_flag_double) {
+                ext_regs[inst->rd_] = fp_to_integer(read_fp<double>(ext_regs, inst->rm_), rounding, is_signed);
+            } else {
+                ext_regs[inst->rd_] = fp_to_integer(read_fp<float>(ext_regs, inst->rm_), rounding, is_signed);
+            }
+
+            NEXT();
+        }
+
+        // VFP register transfers
+        HANDLER(vfp_VMOV_u32_f32)
+        HANDLER(vfp_VMOV_u32_f64)
+        HANDLER(vfp_VMOV_from_i32) {
+            ext_regs[inst->rn_] = regs[inst->rd_];
+            NEXT();
+        }
+
+        HANDLER(vfp_VMOV_f32_u32)
+        HANDLER(vfp_VMOV_f64_u32)
+        HANDLER(vfp_VMOV_to_i32) {
+            regs[inst->rd_] = ext_regs[inst->rn_];
+            NEXT();
+        }
+
+        HANDLER(vfp_VMOV_2u32_2f32)
+        HANDLER(vfp_VMOV_2u32_f64) {
+            ext_regs[inst->rm_] = regs[inst->rd_];
+            ext_regs[(inst->rm_ + 1) & 63] = regs[inst->rs_];
+
+            NEXT();
+        }
+
+        HANDLER(vfp_VMOV_2f32_2u32)
+        HANDLER(vfp_VMOV_f64_2u32) {
+            regs[inst->rd_] = ext_regs[inst->rm_];
+            regs[inst->rs_] = ext_regs[(inst->rm_ + 1) & 63];
+
+            NEXT();
+        }
+
+        HANDLER(vfp_VMSR) {
+            state_.fpscr_ = regs[inst->rd_];
+            NEXT();
+        }
+
+        HANDLER(vfp_VMRS) {
+            // To PC means the comparison flags go to the APSR
+            if (inst->rd_ == 15) {
+                set_nzcv(state_, state_.fpscr_);
+            } else {
+                regs[inst->rd_] = state_.fpscr_;
+            }
+
+            NEXT();
+        }
+
+        HANDLER(vfp_VPUSH)
+        HANDLER(vfp_VPOP)
+        HANDLER(vfp_VLDR)
+        HANDLER(vfp_VSTR)
+        HANDLER(vfp_VSTM_a1)
+        HANDLER(vfp_VSTM_a2)
+        HANDLER(vfp_VLDM_a1)
+        HANDLER(vfp_VLDM_a2) {
+            HANDLE_RESULT(execute_vfp_transfer(inst))
+        }
+
+#if !R12L1_COMPUTED_GOTO
+        default:
+            goto handler_unimplemented_fallback;
+#endif
+        }
+
+#if !R12L1_COMPUTED_GOTO
+    handler_unimplemented_fallback:
+        LOG_ERROR(CPU, "Operation {} has no handler", op_name(inst->opcode_));
+
+        regs[15] = inst->addr();
+        exception_handler(exception_type_undefined_inst, inst->addr());
+
+        goto block_lookup;
+#endif
+
+    handler_cond_check:
+        if (condition_passed(state_, inst->cond_)) {
+            DISPATCH_UNCONDITIONAL();
+        }
+
+        NEXT();
+
+    halted:
+        return;
+
+#undef WRITE_ALU_RESULT
+#undef SET_NZ
+#undef WRITE_OR_FAULT
+#undef READ_OR_FAULT
+#undef HANDLE_RESULT
+#undef NEXT
+#undef DISPATCH_UNCONDITIONAL
+#undef DISPATCH
+#undef HANDLER
+    }
+
+    void interpreter_core::run(const std::uint32_t instruction_count) {
+        ticks_executed_ = 0;
+        ticks_target_ = instruction_count;
+
+        halt_requested_ = false;
+        exited_on_hot_block_ = false;
+        executing_ = true;
+
+        execute(false);
+
+        executing_ = false;
+        clear_halt_request();
+    }
+
+    void interpreter_core::stop() {
+        halt_requested_ = true;
+    }
+
+    void interpreter_core::step() {
+        ticks_executed_ = 0;
+        ticks_target_ = 1;
+
+        halt_requested_ = false;
+        exited_on_hot_block_ = false;
+        executing_ = true;
+
+        execute(true);
+
+        executing_ = false;
+    }
+
+    uint32_t interpreter_core::get_reg(size_t idx) {
+        return state_.regs_[idx];
+    }
+
+    uint32_t interpreter_core::get_sp() {
+        return state_.regs_[13];
+    }
+
+    uint32_t interpreter_core::get_pc() {
+        return state_.regs_[15];
+    }
+
+    uint32_t interpreter_core::get_vfp(size_t idx) {
+        return state_.ext_regs_[idx];
+    }
+
+    void interpreter_core::set_reg(size_t idx, uint32_t val) {
+        state_.regs_[idx] = val;
+    }
+
+    void interpreter_core::set_pc(uint32_t val) {
+        state_.regs_[15] = val;
+    }
+
+    void interpreter_core::set_sp(uint32_t val) {
+        state_.regs_[13] = val;
+    }
+
+    void interpreter_core::set_lr(uint32_t val) {
+        state_.regs_[14] = val;
+    }
+
+    void interpreter_core::set_vfp(size_t idx, uint32_t val) {
+        state_.ext_regs_[idx] = val;
+    }
+
+    uint32_t interpreter_core::get_lr() {
+        return state_.regs_[14];
+    }
+
+    uint32_t interpreter_core::get_cpsr() {
+        return state_.cpsr_rest_ | (state_.n_ ? CPSR_N : 0) | (state_.z_ ? CPSR_Z : 0) | (state_.c_ ? CPSR_C : 0)
+            | (state_.v_ ? CPSR_V : 0) | (state_.q_ ? CPSR_Q : 0) | (static_cast<std::uint32_t>(state_.ge_) << 16)
+            | (state_.t_ ? CPSR_T : 0);
+    }
+
+    void interpreter_core::set_cpsr(uint32_t val) {
+        state_.n_ = val & CPSR_N;
+        state_.z_ = val & CPSR_Z;
+        state_.c_ = val & CPSR_C;
+        state_.v_ = val & CPSR_V;
+        state_.q_ = val & CPSR_Q;
+        state_.t_ = val & CPSR_T;
+        state_.ge_ = static_cast<std::uint8_t>((val >> 16) & 0xF);
+
+        state_.cpsr_rest_ = val & ~(CPSR_N | CPSR_Z | CPSR_C | CPSR_V | CPSR_Q | CPSR_GE | CPSR_T);
+    }
+
+    void interpreter_core::save_context(thread_context &ctx) {
+        std::copy(state_.regs_.begin(), state_.regs_.end(), ctx.cpu_registers.begin());
+
+        ctx.pc = get_pc();
+        ctx.sp = get_sp();
+        ctx.lr = get_lr();
+        ctx.cpsr = get_cpsr();
+        ctx.wrwr = state_.wrwr_;
+
+        std::copy(state_.ext_regs_.begin(), state_.ext_regs_.end(), ctx.fpu_registers.begin());
+        ctx.fpscr = state_.fpscr_;
+
+        // Nothing stays cached in the interpreter, so the FPU state is always restored
+        ctx.fpu_save_stamp = 0;
+    }
+
+    void interpreter_core::load_context(const thread_context &ctx) {
+        std::copy(ctx.cpu_registers.begin(), ctx.cpu_registers.begin() + 16, state_.regs_.begin());
+
+        set_sp(ctx.sp);
+        set_pc(ctx.pc);
+        set_lr(ctx.lr);
+        set_cpsr(ctx.cpsr);
+
+        state_.wrwr_ = ctx.wrwr;
+
+        std::copy(ctx.fpu_registers.begin(), ctx.fpu_registers.end(), state_.ext_regs_.begin());
+        state_.fpscr_ = ctx.fpscr;
+    }
+
+    void interpreter_core::set_entry_point(address ep) {
+    }
+
+    address interpreter_core::get_entry_point() {
+        return 0;
+    }
+
+    void interpreter_core::set_stack_top(address addr) {
+        set_sp(addr);
+    }
+
+    address interpreter_core::get_stack_top() {
+        return get_sp();
+    }
+
+    void interpreter_core::prepare_rescheduling() {
+        if (executing_) {
+            halt_requested_ = true;
+        }
+    }
+
+    bool interpreter_core::is_thumb_mode() {
+        return state_.t_;
+    }
+
+    void interpreter_core::page_table_changed() {
+    }
+
+    void interpreter_core::map_backing_mem(address vaddr, size_t size, uint8_t *ptr, prot protection) {
+        const std::uint32_t pstart = vaddr >> PAGE_BITS;
+
+        for (std::size_t i = 0; i < size >> PAGE_BITS; i++) {
+            page_table_[pstart + i] = ptr + (i << PAGE_BITS);
+        }
+    }
+
+    void interpreter_core::unmap_memory(address addr, size_t size) {
+        const std::uint32_t pstart = addr >> PAGE_BITS;
+
+        for (std::size_t i = 0; i < size >> PAGE_BITS; i++) {
+            page_table_[pstart + i] = nullptr;
+        }
+    }
+
+    void interpreter_core::clear_instruction_cache() {
+        for (auto &[key, blk] : blocks_) {
+            retired_blocks_.push_back(std::move(blk));
+        }
+
+        blocks_.clear();
+        page_blocks_.clear();
+        fast_lookup_.fill(nullptr);
+    }
+
+    void interpreter_core::imb_range(address addr, std::size_t size) {
+        if (size == 0) {
+            return;
+        }
+
+        const std::uint64_t range_end = static_cast<std::uint64_t>(addr) + size;
+
+        for (std::uint64_t page = addr >> PAGE_BITS; page <= ((range_end - 1) >> PAGE_BITS); page++) {
+            auto keys = page_blocks_.find(static_cast<std::uint32_t>(page));
+
+            if (keys == page_blocks_.end()) {
+                continue;
+            }
+
+            std::vector<std::uint64_t> &key_list = keys->second;
+
+            key_list.erase(std::remove_if(key_list.begin(), key_list.end(), [&](const std::uint64_t key) {
+                auto result = blocks_.find(key);
+
+                // Drop keys of blocks that are already gone too
+                if (result == blocks_.end()) {
+                    return true;
+                }
+
+                const block &blk = *result->second;
+
+                if ((blk.end_ <= addr) || (blk.start_ >= range_end)) {
+                    return false;
+                }
+
+                retire_block(key);
+                return true;
+            }), key_list.end());
+        }
+
+        fast_lookup_.fill(nullptr);
+    }
+
+    std::uint32_t interpreter_core::get_num_instruction_executed() {
+        return ticks_executed_;
+    }
+
+    void interpreter_core::set_asid(std::uint8_t num) {
+        asid_ = num;
+    }
+
+    std::uint8_t interpreter_core::get_asid() const {
+        return asid_;
+    }
+
+    std::uint8_t interpreter_core::get_max_asid_available() const {
+        return 255;
+    }
+}
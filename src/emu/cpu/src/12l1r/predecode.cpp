@@ -0,0 +1,883 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cpu/12l1r/block.h>
+
+namespace eka2l1::arm::r12l1 {
+    static constexpr std::uint8_t COND_ALWAYS = 0b1110;
+
+    static inline std::uint32_t bits(const std::uint32_t value, const int lo, const int hi) {
+        return (value >> lo) & ((1U << (hi - lo + 1)) - 1);
+    }
+
+    static inline bool bit(const std::uint32_t value, const int pos) {
+        return (value >> pos) & 1;
+    }
+
+    template <int N>
+    static inline std::uint32_t sign_extend(const std::uint32_t value) {
+        return static_cast<std::uint32_t>(static_cast<std::int32_t>(value << (32 - N)) >> (32 - N));
+    }
+
+    static inline std::uint32_t rotate_right(const std::uint32_t value, const std::uint32_t amount) {
+        return amount ? ((value >> amount) | (value << (32 - amount))) : value;
+    }
+
+    // Shift of register operands encoded with an immediate. LSR and ASR by 0 mean by 32, ROR by 0 is RRX.
+    static void decode_imm_shift(decoded_inst &inst, const std::uint32_t type, const std::uint32_t amount) {
+        inst.shift_type_ = static_cast<std::uint8_t>(type);
+        inst.shift_imm_ = static_cast<std::uint8_t>(amount);
+
+        switch (type) {
+        case shift_lsr:
+        case shift_asr:
+            if (amount == 0) {
+                inst.shift_imm_ = 32;
+            }
+
+            break;
+
+        case shift_ror:
+            if (amount == 0) {
+                inst.shift_type_ = shift_rrx;
+                inst.shift_imm_ = 1;
+            }
+
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // Fields of the multiply family, where the destination is at bit 16 and the accumulator at bit 12.
+    static void decode_multiply_fields(decoded_inst &inst, const std::uint32_t raw) {
+        inst.rd_ = static_cast<std::uint8_t>(bits(raw, 16, 19));
+        inst.rs_ = static_cast<std::uint8_t>(bits(raw, 12, 15));
+        inst.rm_ = static_cast<std::uint8_t>(bits(raw, 8, 11));
+        inst.rn_ = static_cast<std::uint8_t>(bits(raw, 0, 3));
+    }
+
+    // Index of the first word of a VFP register in the extension register file. Single registers
+    // take the extra bit as the lowest one, double registers as the highest one.
+    static std::uint8_t vfp_reg_index(const bool is_double, const std::uint32_t four_bits, const bool extra_bit) {
+        if (is_double) {
+            return static_cast<std::uint8_t>(((extra_bit ? 16 : 0) | four_bits) * 2);
+        }
+
+        return static_cast<std::uint8_t>((four_bits << 1) | (extra_bit ? 1 : 0));
+    }
+
+    static std::uint32_t vfp_expand_imm(const std::uint32_t imm8, const bool is_double) {
+        const std::uint32_t sign = bit(imm8, 7);
+        const std::uint32_t b6 = bit(imm8, 6);
+
+        if (is_double) {
+            // High word only, the low word of the expanded constant is always zero
+            const std::uint32_t exp = ((b6 ^ 1) << 10) | (b6 ? 0x3FC : 0) | bits(imm8, 4, 5);
+            return (sign << 31) | (exp << 20) | (bits(imm8, 0, 3) << 16);
+        }
+
+        const std::uint32_t exp = ((b6 ^ 1) << 7) | (b6 ? 0x7C : 0) | bits(imm8, 4, 5);
+        return (sign << 31) | (exp << 23) | (bits(imm8, 0, 3) << 19);
+    }
+
+    static bool predecode_vfp(decoded_inst &inst, const std::uint32_t raw) {
+        const bool is_double = bit(raw, 8);
+        const bool d_bit = bit(raw, 22);
+        const bool n_bit = bit(raw, 7);
+        const bool m_bit = bit(raw, 5);
+
+        const std::uint32_t vd = bits(raw, 12, 15);
+        const std::uint32_t vn = bits(raw, 16, 19);
+        const std::uint32_t vm = bits(raw, 0, 3);
+
+        if (is_double) {
+            inst.flags_ |= inst_flag_double;
+        }
+
+        switch (inst.opcode_) {
+        case op::vfp_VMLA:
+        case op::vfp_VMLS:
+        case op::vfp_VNMLS:
+        case op::vfp_VNMLA:
+        case op::vfp_VMUL:
+        case op::vfp_VNMUL:
+        case op::vfp_VADD:
+        case op::vfp_VSUB:
+        case op::vfp_VDIV:
+            inst.rd_ = vfp_reg_index(is_double, vd, d_bit);
+            inst.rn_ = vfp_reg_index(is_double, vn, n_bit);
+            inst.rm_ = vfp_reg_index(is_double, vm, m_bit);
+            break;
+
+        case op::vfp_VMOV_imm:
+            inst.rd_ = vfp_reg_index(is_double, vd, d_bit);
+            inst.imm_ = vfp_expand_imm((vn << 4) | vm, is_double);
+            break;
+
+        case op::vfp_VMOV_reg:
+        case op::vfp_VABS:
+        case op::vfp_VNEG:
+        case op::vfp_VSQRT:
+        case op::vfp_VCMP:
+        case op::vfp_VCMP_zero:
+            inst.rd_ = vfp_reg_index(is_double, vd, d_bit);
+            inst.rm_ = vfp_reg_index(is_double, vm, m_bit);
+            break;
+
+        case op::vfp_VCVT_f_to_f:
+            // Converts to the other precision
+            inst.rd_ = vfp_reg_index(!is_double, vd, d_bit);
+            inst.rm_ = vfp_reg_index(is_double, vm, m_bit);
+            break;
+
+        case op::vfp_VCVT_from_int:
+            inst.rd_ = vfp_reg_index(is_double, vd, d_bit);
+            inst.rm_ = vfp_reg_index(false, vm, m_bit);
+            break;
+
+        case op::vfp_VCVT_to_u32:
+        case op::vfp_VCVT_to_s32:
+            inst.rd_ = vfp_reg_index(false, vd, d_bit);
+            inst.rm_ = vfp_reg_index(is_double, vm, m_bit);
+            break;
+
+        case op::vfp_VMOV_u32_f32:
+        case op::vfp_VMOV_f32_u32:
+            inst.rd_ = static_cast<std::uint8_t>(vd);
+            inst.rn_ = vfp_reg_index(false, vn, n_bit);
+            inst.flags_ &= ~inst_flag_double;
+            break;
+
+        case op::vfp_VMOV_u32_f64:
+        case op::vfp_VMOV_f64_u32:
+        case op::vfp_VMOV_from_i32:
+        case op::vfp_VMOV_to_i32:
+            // Move to or from one half of a double register
+            inst.rd_ = static_cast<std::uint8_t>(vd);
+            inst.rn_ = static_cast<std::uint8_t>(vfp_reg_index(true, vn, n_bit) + (bit(raw, 21) ? 1 : 0));
+            inst.flags_ &= ~inst_flag_double;
+            break;
+
+        case op::vfp_VMOV_2u32_2f32:
+        case op::vfp_VMOV_2f32_2u32:
+        case op::vfp_VMOV_2u32_f64:
+        case op::vfp_VMOV_f64_2u32:
+            // Bit 8 tells if it's a pair of singles or a double, both are two consecutive words
+            inst.rd_ = static_cast<std::uint8_t>(vd);
+            inst.rs_ = static_cast<std::uint8_t>(vn);
+            inst.rm_ = vfp_reg_index(is_double, vm, m_bit);
+            break;
+
+        case op::vfp_VMSR:
+        case op::vfp_VMRS:
+            inst.rd_ = static_cast<std::uint8_t>(vd);
+            break;
+
+        case op::vfp_VLDR:
+        case op::vfp_VSTR:
+            inst.rd_ = vfp_reg_index(is_double, vd, d_bit);
+            inst.rn_ = static_cast<std::uint8_t>(vn);
+            inst.imm_ = bits(raw, 0, 7) * 4;
+            break;
+
+        case op::vfp_VPUSH:
+        case op::vfp_VPOP:
+        case op::vfp_VSTM_a1:
+        case op::vfp_VSTM_a2:
+        case op::vfp_VLDM_a1:
+        case op::vfp_VLDM_a2:
+            // Word count. An odd count on doubles is the FSTMX/FLDMX format, its extra word is skipped.
+            inst.rd_ = vfp_reg_index(is_double, vd, d_bit);
+            inst.rn_ = static_cast<std::uint8_t>(vn);
+            inst.imm_ = bits(raw, 0, 7);
+
+            inst.flags_ &= ~inst_flag_write_back;
+
+            if (bit(raw, 21)) {
+                inst.flags_ |= inst_flag_write_back;
+            }
+
+            break;
+
+        default:
+            return false;
+        }
+
+        return true;
+    }
+
+    bool predecode_arm(decoded_inst &inst, const std::uint32_t raw, const address addr) {
+        inst = decoded_inst{};
+        inst.raw_ = raw;
+        inst.pc_read_ = addr + 8;
+        inst.size_ = 4;
+        inst.opcode_ = decode_arm(raw);
+        inst.cond_ = static_cast<std::uint8_t>(raw >> 28);
+
+        // The decoder only gives back instructions without a condition field in the unconditional space
+        if (inst.cond_ == 0b1111) {
+            inst.cond_ = COND_ALWAYS;
+        }
+
+        inst.rn_ = static_cast<std::uint8_t>(bits(raw, 16, 19));
+        inst.rd_ = static_cast<std::uint8_t>(bits(raw, 12, 15));
+        inst.rs_ = static_cast<std::uint8_t>(bits(raw, 8, 11));
+        inst.rm_ = static_cast<std::uint8_t>(bits(raw, 0, 3));
+        inst.reg_list_ = static_cast<std::uint16_t>(raw & 0xFFFF);
+
+        if (bit(raw, 24)) {
+            inst.flags_ |= inst_flag_pre_index;
+        }
+
+        if (bit(raw, 23)) {
+            inst.flags_ |= inst_flag_add_offset;
+        }
+
+        // Post-indexed addressing always writes back
+        if (bit(raw, 21) || !bit(raw, 24)) {
+            inst.flags_ |= inst_flag_write_back;
+        }
+
+        const bool rd_is_pc = (inst.rd_ == 15);
+
+        switch (inst.opcode_) {
+        case op::unimplemented:
+            return true;
+
+#define DP_CASES(name) case op::arm_##name##_imm: case op::arm_##name##_reg: case op::arm_##name##_rsr:
+        DP_CASES(TST)
+        DP_CASES(TEQ)
+        DP_CASES(CMP)
+        DP_CASES(CMN)
+        DP_CASES(AND)
+        DP_CASES(EOR)
+        DP_CASES(SUB)
+        DP_CASES(RSB)
+        DP_CASES(ADD)
+        DP_CASES(ADC)
+        DP_CASES(SBC)
+        DP_CASES(RSC)
+        DP_CASES(ORR)
+        DP_CASES(MOV)
+        DP_CASES(BIC)
+        DP_CASES(MVN) {
+#undef DP_CASES
+            const bool is_test = (bits(raw, 23, 24) == 0b10);
+
+            if (bit(raw, 20)) {
+                inst.flags_ |= inst_flag_set_flags;
+            }
+
+            if (bit(raw, 25)) {
+                // Rotated immediate. The carry out is only taken from it when the rotation is not zero.
+                const std::uint32_t rotation = bits(raw, 8, 11) * 2;
+                inst.imm_ = rotate_right(bits(raw, 0, 7), rotation);
+                inst.shift_imm_ = static_cast<std::uint8_t>(rotation);
+            } else if (bit(raw, 4)) {
+                inst.shift_type_ = static_cast<std::uint8_t>(bits(raw, 5, 6));
+            } else {
+                decode_imm_shift(inst, bits(raw, 5, 6), bits(raw, 7, 11));
+            }
+
+            return rd_is_pc && !is_test;
+        }
+
+        case op::arm_B:
+        case op::arm_BL:
+            inst.imm_ = inst.pc_read_ + sign_extend<26>(bits(raw, 0, 23) << 2);
+            return true;
+
+        case op::arm_BLX_imm:
+            inst.imm_ = inst.pc_read_ + sign_extend<26>(bits(raw, 0, 23) << 2) + (bit(raw, 24) ? 2 : 0);
+            return true;
+
+        case op::arm_BX:
+        case op::arm_BXJ:
+        case op::arm_BLX_reg:
+            return true;
+
+        case op::arm_SVC:
+            inst.imm_ = bits(raw, 0, 23);
+            return true;
+
+        case op::arm_BKPT:
+            inst.imm_ = (bits(raw, 8, 19) << 4) | bits(raw, 0, 3);
+            return true;
+
+        case op::arm_UDF:
+            return true;
+
+        case op::arm_SXTB:
+        case op::arm_SXTB16:
+        case op::arm_SXTH:
+        case op::arm_SXTAB:
+        case op::arm_SXTAB16:
+        case op::arm_SXTAH:
+        case op::arm_UXTB:
+        case op::arm_UXTB16:
+        case op::arm_UXTH:
+        case op::arm_UXTAB:
+        case op::arm_UXTAB16:
+        case op::arm_UXTAH:
+            inst.shift_imm_ = static_cast<std::uint8_t>(bits(raw, 10, 11) * 8);
+            break;
+
+        case op::arm_LDR_lit:
+        case op::arm_LDR_imm:
+        case op::arm_LDRB_lit:
+        case op::arm_LDRB_imm:
+            inst.imm_ = bits(raw, 0, 11);
+            return rd_is_pc;
+
+        case op::arm_STR_imm:
+        case op::arm_STRB_imm:
+            inst.imm_ = bits(raw, 0, 11);
+            break;
+
+        case op::arm_LDR_reg:
+        case op::arm_LDRB_reg:
+            decode_imm_shift(inst, bits(raw, 5, 6), bits(raw, 7, 11));
+            return rd_is_pc;
+
+        case op::arm_STR_reg:
+        case op::arm_STRB_reg:
+            decode_imm_shift(inst, bits(raw, 5, 6), bits(raw, 7, 11));
+            break;
+
+        case op::arm_LDRH_lit:
+        case op::arm_LDRH_imm:
+        case op::arm_LDRSB_lit:
+        case op::arm_LDRSB_imm:
+        case op::arm_LDRSH_lit:
+        case op::arm_LDRSH_imm:
+            inst.imm_ = (bits(raw, 8, 11) << 4) | bits(raw, 0, 3);
+            return rd_is_pc;
+
+        case op::arm_LDRD_lit:
+        case op::arm_LDRD_imm:
+            inst.imm_ = (bits(raw, 8, 11) << 4) | bits(raw, 0, 3);
+            return (inst.rd_ >= 14);
+
+        case op::arm_STRH_imm:
+        case op::arm_STRD_imm:
+            inst.imm_ = (bits(raw, 8, 11) << 4) | bits(raw, 0, 3);
+            break;
+
+        case op::arm_LDRH_reg:
+        case op::arm_LDRSB_reg:
+        case op::arm_LDRSH_reg:
+            return rd_is_pc;
+
+        case op::arm_LDRD_reg:
+            return (inst.rd_ >= 14);
+
+        case op::arm_LDM:
+        case op::arm_LDMDA:
+        case op::arm_LDMDB:
+        case op::arm_LDMIB:
+        case op::arm_STM:
+        case op::arm_STMDA:
+        case op::arm_STMDB:
+        case op::arm_STMIB:
+            // Block transfers only write back with the W bit, the P bit is part of the addressing mode
+            inst.flags_ &= ~inst_flag_write_back;
+
+            if (bit(raw, 21)) {
+                inst.flags_ |= inst_flag_write_back;
+            }
+
+            return bit(raw, 20) && bit(raw, 15);
+
+        case op::arm_BFC:
+        case op::arm_BFI:
+            inst.imm_ = bits(raw, 16, 20);
+            inst.shift_imm_ = static_cast<std::uint8_t>(bits(raw, 7, 11));
+            break;
+
+        case op::arm_SBFX:
+        case op::arm_UBFX:
+            inst.imm_ = bits(raw, 16, 20);
+            inst.shift_imm_ = static_cast<std::uint8_t>(bits(raw, 7, 11));
+            break;
+
+        case op::arm_MOVW:
+        case op::arm_MOVT:
+            inst.imm_ = (bits(raw, 16, 19) << 12) | bits(raw, 0, 11);
+            break;
+
+        case op::arm_PKHBT:
+            decode_imm_shift(inst, shift_lsl, bits(raw, 7, 11));
+            break;
+
+        case op::arm_PKHTB:
+            decode_imm_shift(inst, shift_asr, bits(raw, 7, 11));
+            break;
+
+        case op::arm_SSAT:
+        case op::arm_USAT:
+            inst.imm_ = bits(raw, 16, 20);
+            decode_imm_shift(inst, bit(raw, 6) ? shift_asr : shift_lsl, bits(raw, 7, 11));
+            break;
+
+        case op::arm_SSAT16:
+        case op::arm_USAT16:
+            inst.imm_ = bits(raw, 16, 19);
+            break;
+
+        case op::arm_USAD8:
+        case op::arm_USADA8:
+        case op::arm_SDIV:
+        case op::arm_UDIV:
+        case op::arm_MLA:
+        case op::arm_MLS:
+        case op::arm_MUL:
+        case op::arm_SMLAL:
+        case op::arm_SMULL:
+        case op::arm_UMAAL:
+        case op::arm_UMLAL:
+        case op::arm_UMULL:
+        case op::arm_SMLALxy:
+        case op::arm_SMLAxy:
+        case op::arm_SMULxy:
+        case op::arm_SMLAWy:
+        case op::arm_SMULWy:
+        case op::arm_SMMUL:
+        case op::arm_SMMLA:
+        case op::arm_SMMLS:
+        case op::arm_SMLAD:
+        case op::arm_SMLALD:
+        case op::arm_SMLSD:
+        case op::arm_SMLSLD:
+        case op::arm_SMUAD:
+        case op::arm_SMUSD:
+            decode_multiply_fields(inst, raw);
+
+            if (bit(raw, 20)) {
+                inst.flags_ |= inst_flag_set_flags;
+            }
+
+            break;
+
+        case op::arm_MSR_imm:
+            inst.imm_ = rotate_right(bits(raw, 0, 7), bits(raw, 8, 11) * 2);
+            inst.rs_ = static_cast<std::uint8_t>(bits(raw, 16, 19));
+            break;
+
+        case op::arm_MSR_reg:
+            inst.rs_ = static_cast<std::uint8_t>(bits(raw, 16, 19));
+            break;
+
+        default:
+            if (predecode_vfp(inst, raw)) {
+                break;
+            }
+
+            // Every other operation reads its registers from the standard positions. Anything
+            // writing to PC there is unpredictable, but ending the block keeps it safe.
+            return rd_is_pc;
+        }
+
+        return false;
+    }
+
+    static void set_thumb_operands(decoded_inst &inst, const op opcode, const std::uint32_t rd, const std::uint32_t rn,
+        const std::uint32_t rm, const std::uint8_t flags = 0) {
+        inst.opcode_ = opcode;
+        inst.rd_ = static_cast<std::uint8_t>(rd);
+        inst.rn_ = static_cast<std::uint8_t>(rn);
+        inst.rm_ = static_cast<std::uint8_t>(rm);
+        inst.flags_ |= flags;
+    }
+
+    bool predecode_thumb(decoded_inst &inst, const std::uint16_t first, const std::uint16_t second,
+        const bool second_valid, const address addr) {
+        inst = decoded_inst{};
+        inst.raw_ = first;
+        inst.pc_read_ = addr + 4;
+        inst.size_ = 2;
+        inst.cond_ = COND_ALWAYS;
+        inst.flags_ = inst_flag_thumb;
+        inst.opcode_ = op::unimplemented;
+
+        if (bits(first, 11, 15) == 0b11110) {
+            // BL/BLX prefix, the other half carries the low bits of the offset
+            if (!second_valid) {
+                inst.opcode_ = op::fetch_fault;
+                inst.imm_ = addr + 2;
+
+                return true;
+            }
+
+            const std::uint32_t suffix = bits(second, 11, 15);
+
+            if ((suffix == 0b11111) || (suffix == 0b11101)) {
+                const std::uint32_t offset = sign_extend<23>((bits(first, 0, 10) << 12) | (bits(second, 0, 10) << 1));
+
+                inst.raw_ = (static_cast<std::uint32_t>(first) << 16) | second;
+                inst.size_ = 4;
+                inst.opcode_ = (suffix == 0b11111) ? op::thumb32_BL : op::thumb32_BLX;
+                inst.imm_ = inst.pc_read_ + offset;
+
+                if (inst.opcode_ == op::thumb32_BLX) {
+                    inst.imm_ &= ~3U;
+                }
+            }
+
+            return true;
+        }
+
+        const std::uint32_t low3 = bits(first, 0, 2);
+        const std::uint32_t mid3 = bits(first, 3, 5);
+        const std::uint32_t high3 = bits(first, 6, 8);
+        const std::uint32_t imm8 = bits(first, 0, 7);
+        const std::uint32_t imm5 = bits(first, 6, 10);
+        const std::uint32_t reg8 = bits(first, 8, 10);
+
+        const std::uint8_t set_flags = inst_flag_set_flags;
+        const std::uint8_t offset_addressing = inst_flag_pre_index | inst_flag_add_offset;
+
+        switch (decode_thumb16(first)) {
+        case thumb16_op::thumb16_LSL_imm:
+        case thumb16_op::thumb16_LSR_imm:
+        case thumb16_op::thumb16_ASR_imm:
+            set_thumb_operands(inst, op::arm_MOV_reg, low3, 0, mid3, set_flags);
+            decode_imm_shift(inst, bits(first, 11, 12), imm5);
+            break;
+
+        case thumb16_op::thumb16_ADD_reg_t1:
+            set_thumb_operands(inst, op::arm_ADD_reg, low3, mid3, high3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_SUB_reg:
+            set_thumb_operands(inst, op::arm_SUB_reg, low3, mid3, high3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_ADD_imm_t1:
+            set_thumb_operands(inst, op::arm_ADD_imm, low3, mid3, 0, set_flags);
+            inst.imm_ = high3;
+            break;
+
+        case thumb16_op::thumb16_SUB_imm_t1:
+            set_thumb_operands(inst, op::arm_SUB_imm, low3, mid3, 0, set_flags);
+            inst.imm_ = high3;
+            break;
+
+        case thumb16_op::thumb16_MOV_imm:
+            set_thumb_operands(inst, op::arm_MOV_imm, reg8, 0, 0, set_flags);
+            inst.imm_ = imm8;
+            break;
+
+        case thumb16_op::thumb16_CMP_imm:
+            set_thumb_operands(inst, op::arm_CMP_imm, 0, reg8, 0, set_flags);
+            inst.imm_ = imm8;
+            break;
+
+        case thumb16_op::thumb16_ADD_imm_t2:
+            set_thumb_operands(inst, op::arm_ADD_imm, reg8, reg8, 0, set_flags);
+            inst.imm_ = imm8;
+            break;
+
+        case thumb16_op::thumb16_SUB_imm_t2:
+            set_thumb_operands(inst, op::arm_SUB_imm, reg8, reg8, 0, set_flags);
+            inst.imm_ = imm8;
+            break;
+
+        case thumb16_op::thumb16_AND_reg:
+            set_thumb_operands(inst, op::arm_AND_reg, low3, low3, mid3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_EOR_reg:
+            set_thumb_operands(inst, op::arm_EOR_reg, low3, low3, mid3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_ADC_reg:
+            set_thumb_operands(inst, op::arm_ADC_reg, low3, low3, mid3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_SBC_reg:
+            set_thumb_operands(inst, op::arm_SBC_reg, low3, low3, mid3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_ORR_reg:
+            set_thumb_operands(inst, op::arm_ORR_reg, low3, low3, mid3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_BIC_reg:
+            set_thumb_operands(inst, op::arm_BIC_reg, low3, low3, mid3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_MVN_reg:
+            set_thumb_operands(inst, op::arm_MVN_reg, low3, 0, mid3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_LSL_reg:
+        case thumb16_op::thumb16_LSR_reg:
+        case thumb16_op::thumb16_ASR_reg:
+        case thumb16_op::thumb16_ROR_reg: {
+            static constexpr std::uint8_t SHIFT_TYPES[] = { shift_lsl, shift_lsr, shift_asr, 0, 0, shift_ror };
+
+            set_thumb_operands(inst, op::arm_MOV_rsr, low3, 0, low3, set_flags);
+            inst.rs_ = static_cast<std::uint8_t>(mid3);
+            inst.shift_type_ = SHIFT_TYPES[bits(first, 6, 9) - 0b0010];
+            break;
+        }
+
+        case thumb16_op::thumb16_TST_reg:
+            set_thumb_operands(inst, op::arm_TST_reg, 0, low3, mid3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_RSB_imm:
+            set_thumb_operands(inst, op::arm_RSB_imm, low3, mid3, 0, set_flags);
+            break;
+
+        case thumb16_op::thumb16_CMP_reg_t1:
+            set_thumb_operands(inst, op::arm_CMP_reg, 0, low3, mid3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_CMN_reg:
+            set_thumb_operands(inst, op::arm_CMN_reg, 0, low3, mid3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_MUL_reg:
+            set_thumb_operands(inst, op::arm_MUL, low3, mid3, low3, set_flags);
+            break;
+
+        case thumb16_op::thumb16_ADD_reg_t2: {
+            const std::uint32_t rdn = (bit(first, 7) << 3) | low3;
+            set_thumb_operands(inst, op::arm_ADD_reg, rdn, rdn, bits(first, 3, 6));
+
+            return (rdn == 15);
+        }
+
+        case thumb16_op::thumb16_CMP_reg_t2:
+            set_thumb_operands(inst, op::arm_CMP_reg, 0, (bit(first, 7) << 3) | low3, bits(first, 3, 6), set_flags);
+            break;
+
+        case thumb16_op::thumb16_MOV_reg: {
+            const std::uint32_t rd = (bit(first, 7) << 3) | low3;
+            set_thumb_operands(inst, op::arm_MOV_reg, rd, 0, bits(first, 3, 6));
+
+            return (rd == 15);
+        }
+
+        case thumb16_op::thumb16_LDR_literal:
+            set_thumb_operands(inst, op::thumb16_LDR_literal, reg8, 15, 0);
+            inst.imm_ = ((addr + 4) & ~3U) + imm8 * 4;
+            break;
+
+        case thumb16_op::thumb16_STR_reg:
+            set_thumb_operands(inst, op::arm_STR_reg, low3, mid3, high3, offset_addressing);
+            break;
+
+        case thumb16_op::thumb16_STRH_reg:
+            set_thumb_operands(inst, op::arm_STRH_reg, low3, mid3, high3, offset_addressing);
+            break;
+
+        case thumb16_op::thumb16_STRB_reg:
+            set_thumb_operands(inst, op::arm_STRB_reg, low3, mid3, high3, offset_addressing);
+            break;
+
+        case thumb16_op::thumb16_LDRSB_reg:
+            set_thumb_operands(inst, op::arm_LDRSB_reg, low3, mid3, high3, offset_addressing);
+            break;
+
+        case thumb16_op::thumb16_LDR_reg:
+            set_thumb_operands(inst, op::arm_LDR_reg, low3, mid3, high3, offset_addressing);
+            break;
+
+        case thumb16_op::thumb16_LDRH_reg:
+            set_thumb_operands(inst, op::arm_LDRH_reg, low3, mid3, high3, offset_addressing);
+            break;
+
+        case thumb16_op::thumb16_LDRB_reg:
+            set_thumb_operands(inst, op::arm_LDRB_reg, low3, mid3, high3, offset_addressing);
+            break;
+
+        case thumb16_op::thumb16_LDRSH_reg:
+            set_thumb_operands(inst, op::arm_LDRSH_reg, low3, mid3, high3, offset_addressing);
+            break;
+
+        case thumb16_op::thumb16_STR_imm_t1:
+            set_thumb_operands(inst, op::arm_STR_imm, low3, mid3, 0, offset_addressing);
+            inst.imm_ = imm5 * 4;
+            break;
+
+        case thumb16_op::thumb16_LDR_imm_t1:
+            set_thumb_operands(inst, op::arm_LDR_imm, low3, mid3, 0, offset_addressing);
+            inst.imm_ = imm5 * 4;
+            break;
+
+        case thumb16_op::thumb16_STRB_imm:
+            set_thumb_operands(inst, op::arm_STRB_imm, low3, mid3, 0, offset_addressing);
+            inst.imm_ = imm5;
+            break;
+
+        case thumb16_op::thumb16_LDRB_imm:
+            set_thumb_operands(inst, op::arm_LDRB_imm, low3, mid3, 0, offset_addressing);
+            inst.imm_ = imm5;
+            break;
+
+        case thumb16_op::thumb16_STRH_imm:
+            set_thumb_operands(inst, op::arm_STRH_imm, low3, mid3, 0, offset_addressing);
+            inst.imm_ = imm5 * 2;
+            break;
+
+        case thumb16_op::thumb16_LDRH_imm:
+            set_thumb_operands(inst, op::arm_LDRH_imm, low3, mid3, 0, offset_addressing);
+            inst.imm_ = imm5 * 2;
+            break;
+
+        case thumb16_op::thumb16_STR_imm_t2:
+            set_thumb_operands(inst, op::arm_STR_imm, reg8, 13, 0, offset_addressing);
+            inst.imm_ = imm8 * 4;
+            break;
+
+        case thumb16_op::thumb16_LDR_imm_t2:
+            set_thumb_operands(inst, op::arm_LDR_imm, reg8, 13, 0, offset_addressing);
+            inst.imm_ = imm8 * 4;
+            break;
+
+        case thumb16_op::thumb16_ADR:
+            set_thumb_operands(inst, op::arm_MOV_imm, reg8, 0, 0);
+            inst.imm_ = ((addr + 4) & ~3U) + imm8 * 4;
+            break;
+
+        case thumb16_op::thumb16_ADD_sp_t1:
+            set_thumb_operands(inst, op::arm_ADD_imm, reg8, 13, 0);
+            inst.imm_ = imm8 * 4;
+            break;
+
+        case thumb16_op::thumb16_ADD_sp_t2:
+            set_thumb_operands(inst, op::arm_ADD_imm, 13, 13, 0);
+            inst.imm_ = bits(first, 0, 6) * 4;
+            break;
+
+        case thumb16_op::thumb16_SUB_sp:
+            set_thumb_operands(inst, op::arm_SUB_imm, 13, 13, 0);
+            inst.imm_ = bits(first, 0, 6) * 4;
+            break;
+
+        case thumb16_op::thumb16_NOP:
+        case thumb16_op::thumb16_SEV:
+        case thumb16_op::thumb16_WFE:
+        case thumb16_op::thumb16_WFI:
+        case thumb16_op::thumb16_YIELD:
+            inst.opcode_ = op::arm_NOP;
+            break;
+
+        case thumb16_op::thumb16_SXTH:
+            set_thumb_operands(inst, op::arm_SXTH, low3, 0, mid3);
+            break;
+
+        case thumb16_op::thumb16_SXTB:
+            set_thumb_operands(inst, op::arm_SXTB, low3, 0, mid3);
+            break;
+
+        case thumb16_op::thumb16_UXTH:
+            set_thumb_operands(inst, op::arm_UXTH, low3, 0, mid3);
+            break;
+
+        case thumb16_op::thumb16_UXTB:
+            set_thumb_operands(inst, op::arm_UXTB, low3, 0, mid3);
+            break;
+
+        case thumb16_op::thumb16_REV:
+            set_thumb_operands(inst, op::arm_REV, low3, 0, mid3);
+            break;
+
+        case thumb16_op::thumb16_REV16:
+            set_thumb_operands(inst, op::arm_REV16, low3, 0, mid3);
+            break;
+
+        case thumb16_op::thumb16_REVSH:
+            set_thumb_operands(inst, op::arm_REVSH, low3, 0, mid3);
+            break;
+
+        case thumb16_op::thumb16_PUSH:
+            set_thumb_operands(inst, op::arm_STMDB, 0, 13, 0, inst_flag_write_back);
+            inst.reg_list_ = static_cast<std::uint16_t>(imm8 | (bit(first, 8) << 14));
+            break;
+
+        case thumb16_op::thumb16_POP:
+            set_thumb_operands(inst, op::arm_LDM, 0, 13, 0, inst_flag_write_back);
+            inst.reg_list_ = static_cast<std::uint16_t>(imm8 | (bit(first, 8) << 15));
+
+            return bit(first, 8);
+
+        case thumb16_op::thumb16_STMIA:
+            set_thumb_operands(inst, op::arm_STM, 0, reg8, 0, inst_flag_write_back);
+            inst.reg_list_ = static_cast<std::uint16_t>(imm8);
+            break;
+
+        case thumb16_op::thumb16_LDMIA:
+            // The base is not written back when it's also loaded
+            set_thumb_operands(inst, op::arm_LDM, 0, reg8, 0, bit(imm8, reg8) ? 0 : inst_flag_write_back);
+            inst.reg_list_ = static_cast<std::uint16_t>(imm8);
+            break;
+
+        case thumb16_op::thumb16_BKPT:
+            inst.opcode_ = op::arm_BKPT;
+            inst.imm_ = imm8;
+            return true;
+
+        case thumb16_op::thumb16_BX:
+            set_thumb_operands(inst, op::arm_BX, 0, 0, bits(first, 3, 6));
+            return true;
+
+        case thumb16_op::thumb16_BLX_reg:
+            set_thumb_operands(inst, op::arm_BLX_reg, 0, 0, bits(first, 3, 6));
+            return true;
+
+        case thumb16_op::thumb16_CBZ_CBNZ:
+            set_thumb_operands(inst, op::thumb16_CBZ_CBNZ, 0, low3, 0);
+            inst.imm_ = addr + 4 + ((bit(first, 9) << 6) | (bits(first, 3, 7) << 1));
+            inst.shift_type_ = bit(first, 11);
+
+            return true;
+
+        case thumb16_op::thumb16_UDF:
+            inst.opcode_ = op::arm_UDF;
+            return true;
+
+        case thumb16_op::thumb16_SVC:
+            inst.opcode_ = op::arm_SVC;
+            inst.imm_ = imm8;
+            return true;
+
+        case thumb16_op::thumb16_B_t1:
+            inst.opcode_ = op::arm_B;
+            inst.cond_ = static_cast<std::uint8_t>(bits(first, 8, 11));
+            inst.imm_ = addr + 4 + sign_extend<9>(imm8 << 1);
+            return true;
+
+        case thumb16_op::thumb16_B_t2:
+            inst.opcode_ = op::arm_B;
+            inst.imm_ = addr + 4 + sign_extend<12>(bits(first, 0, 10) << 1);
+            return true;
+
+        default:
+            // SETEND, CPS and unknown encodings
+            return true;
+        }
+
+        return false;
+    }
+}
@@ -20,6 +20,8 @@
 #include <common/algorithm.h>
 #include <common/configure.h>
 #include <common/log.h>
+#include <common/platform.h>
+#include <common/virtualmem.h>
 
 #include <cpu/arm_dynarmic.h>
 #include <cpu/arm_utils.h>
@@ -228,36 +230,72 @@ namespace eka2l1::arm {
         void AddTicks(uint64_t ticks) override {
             parent.ticks_executed += static_cast<std::uint32_t>(ticks - interpreted);
             interpreted = 0;
+
+            // We are on the thread running the JIT here, so halting it is fine
+            if (parent.halt_requested()) {
+                parent.jit->HaltExecution();
+            }
         }
 
         std::uint64_t GetTicksRemaining() override {
+            if (parent.halt_requested()) {
+                return 0;
+            }
+
             return static_cast<std::uint64_t>(common::max<std::int64_t>(static_cast<std::int64_t>(parent.ticks_target)
                     - parent.ticks_executed, 0));
         }
     };
 
+    static constexpr std::uint64_t FASTMEM_ARENA_SIZE = 0x100000000ULL;
+
     std::unique_ptr<Dynarmic::A32::Jit> make_jit(std::unique_ptr<dynarmic_core_callback> &callback, void *table,
-        std::shared_ptr<dynarmic_core_cp15> cp15, Dynarmic::ExclusiveMonitor *monitor) {
+        void *fastmem_arena, std::shared_ptr<dynarmic_core_cp15> cp15, Dynarmic::ExclusiveMonitor *monitor,
+        const std::size_t processor_id) {
         Dynarmic::A32::UserConfig config;
         config.callbacks = callback.get();
         config.coprocessors[15] = cp15;
         config.page_table = reinterpret_cast<decltype(config.page_table)>(table);
         config.global_monitor = monitor;
+        config.processor_id = processor_id;
+
+        if (fastmem_arena) {
+            // Accesses that fault in the arena (unmapped or protected) are redone through the page table
+            config.fastmem_pointer = fastmem_arena;
+            config.recompile_on_fastmem_failure = true;
+        }
 
         return std::make_unique<Dynarmic::A32::Jit>(config);
     }
 
-    dynarmic_core::dynarmic_core(arm::exclusive_monitor *monitor) {
+    dynarmic_core::dynarmic_core(arm::exclusive_monitor *monitor, const bool enable_fastmem, const std::size_t core_num) {
+        set_core_number(core_num);
+
         std::shared_ptr<dynarmic_core_cp15> cp15 = std::make_shared<dynarmic_core_cp15>();
         cb = std::make_unique<dynarmic_core_callback>(*this, cp15);
 
         std::fill(page_dyn.begin(), page_dyn.end(), nullptr);
 
+        if (enable_fastmem) {
+#if EKA2L1_ARCH(X64)
+            fastmem_arena_ = reinterpret_cast<std::uint8_t *>(common::map_memory(FASTMEM_ARENA_SIZE));
+
+            if (!fastmem_arena_) {
+                LOG_WARN(CPU, "Unable to reserve host address space for fastmem, falling back to page table");
+            }
+#else
+            LOG_WARN(CPU, "Fastmem is not supported on this host architecture");
+#endif
+        }
+
         auto monitor_bb = reinterpret_cast<dynarmic_exclusive_monitor*>(monitor);
-        jit = make_jit(cb, &page_dyn, cp15, &monitor_bb->monitor_);
+        jit = make_jit(cb, &page_dyn, fastmem_arena_, cp15, &monitor_bb->monitor_, core_num);
     }
 
     dynarmic_core::~dynarmic_core() {
+        if (fastmem_arena_) {
+            common::unmap_memory(fastmem_arena_, FASTMEM_ARENA_SIZE);
+        }
     }
 
     void dynarmic_core::run(const std::uint32_t instruction_count) {
@@ -265,6 +303,7 @@ namespace eka2l1::arm {
         ticks_target = instruction_count;
 
         jit->Run();
+        clear_halt_request();
     }
 
     void dynarmic_core::stop() {
@@ -288,7 +327,7 @@ namespace eka2l1::arm {
     }
 
     uint32_t dynarmic_core::get_vfp(size_t idx) {
-        return 0;
+        return jit->ExtRegs()[idx];
     }
 
     void dynarmic_core::set_reg(size_t idx, uint32_t val) {
@@ -308,6 +347,8 @@ namespace eka2l1::arm {
     }
 
     void dynarmic_core::set_vfp(size_t idx, uint32_t val) {
+        jit->ExtRegs()[idx] = val;
+        fpu_owner_ = nullptr;
     }
 
     uint32_t dynarmic_core::get_lr() {
@@ -338,6 +379,14 @@ namespace eka2l1::arm {
         }
 
         ctx.wrwr = cb->get_cp15()->get_wrwr();
+
+        const auto &ext_regs = jit->ExtRegs();
+        std::copy(ext_regs.begin(), ext_regs.end(), ctx.fpu_registers.begin());
+        ctx.fpscr = jit->Fpscr();
+
+        // The JIT keeps holding this FPU state until another context is loaded
+        ctx.fpu_save_stamp = ++fpu_save_stamp_;
+        fpu_owner_ = &ctx;
     }
 
     void dynarmic_core::load_context(const thread_context &ctx) {
@@ -351,6 +400,17 @@ namespace eka2l1::arm {
         set_cpsr(ctx.cpsr);
 
         cb->get_cp15()->set_wrwr(ctx.wrwr);
+
+        // Rescheduling to the thread that was just switched out is common. Its FPU state
+        // is still in the JIT, so don't copy it back.
+        if ((fpu_owner_ == &ctx) && (ctx.fpu_save_stamp == fpu_save_stamp_)) {
+            return;
+        }
+
+        std::copy(ctx.fpu_registers.begin(), ctx.fpu_registers.end(), jit->ExtRegs().begin());
+        jit->SetFpscr(ctx.fpscr);
+
+        fpu_owner_ = nullptr;
     }
 
     void dynarmic_core::set_entry_point(address ep) {
@@ -388,6 +448,18 @@ namespace eka2l1::arm {
         for (std::size_t i = 0; i < size / psize; i++) {
             page_dyn[pstart + i] = ptr + i * psize;
         }
+
+        if (fastmem_arena_) {
+            // The arena view never needs execute permission, the JIT only reads code through callbacks
+            const prot arena_prot = ((protection == prot::read_write) || (protection == prot::read_write_exec) || (protection == prot::write))
+                ? prot::read_write : prot::read;
+
+            // If the backing is not shareable (for example, the file-mapped ROM), the arena pages stay inaccessible,
+            // and accesses to them fault back to the page table path.
+            if (!common::map_alias(fastmem_arena_ + vaddr, ptr, size, arena_prot)) {
+                common::unmap_alias(fastmem_arena_ + vaddr, size);
+            }
+        }
     }
 
     void dynarmic_core::unmap_memory(address addr, size_t size) {
@@ -397,6 +469,10 @@ namespace eka2l1::arm {
         for (std::size_t i = 0; i < size / psize; i++) {
             page_dyn[pstart + i] = nullptr;
         }
+
+        if (fastmem_arena_) {
+            common::unmap_alias(fastmem_arena_ + addr, size);
+        }
     }
 
     void dynarmic_core::clear_instruction_cache() {
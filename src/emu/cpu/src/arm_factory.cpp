@@ -18,17 +18,27 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cpu/12l1r/interpreter.h>
 #include <cpu/arm_dynarmic.h>
 #include <cpu/arm_factory.h>
+#include <cpu/arm_tiered.h>
 
 namespace eka2l1::arm {
-    core_instance create_core(exclusive_monitor *monitor, arm_emulator_type arm_type) {
+    core_instance create_core(exclusive_monitor *monitor, arm_emulator_type arm_type, const bool enable_fastmem,
+        const std::size_t core_num) {
         switch (arm_type) {
         case arm_emulator_type::unicorn:
             return nullptr;
 
         case arm_emulator_type::dynarmic:
-            return std::make_unique<dynarmic_core>(monitor);
+            return std::make_unique<dynarmic_core>(monitor, enable_fastmem, core_num);
+
+        case arm_emulator_type::interpreter:
+            return std::make_unique<r12l1::interpreter_core>(monitor, core_num);
+
+        case arm_emulator_type::tiered:
+            return std::make_unique<tiered_core>(monitor, enable_fastmem, core_num);
+
         default:
             break;
         }
@@ -42,8 +52,13 @@ namespace eka2l1::arm {
             return nullptr;
 
         case arm_emulator_type::dynarmic:
+        // The tiered core shares dynarmic's monitor with its interpreter
+        case arm_emulator_type::tiered:
             return std::make_unique<dynarmic_exclusive_monitor>(core_count);
 
+        case arm_emulator_type::interpreter:
+            return std::make_unique<r12l1::interpreter_exclusive_monitor>(core_count);
+
         default:
             break;
         }
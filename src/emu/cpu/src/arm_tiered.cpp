@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cpu/12l1r/interpreter.h>
+#include <cpu/arm_dynarmic.h>
+#include <cpu/arm_tiered.h>
+
+#include <algorithm>
+
+namespace eka2l1::arm {
+    // Children cores access memory through the callbacks set on the tiered core.
+    static bool tiered_read_8bit(void *userdata, address addr, std::uint8_t *data) {
+        return reinterpret_cast<core *>(userdata)->read_8bit(addr, data);
+    }
+
+    static bool tiered_read_16bit(void *userdata, address addr, std::uint16_t *data) {
+        return reinterpret_cast<core *>(userdata)->read_16bit(addr, data);
+    }
+
+    static bool tiered_read_32bit(void *userdata, address addr, std::uint32_t *data) {
+        return reinterpret_cast<core *>(userdata)->read_32bit(addr, data);
+    }
+
+    static bool tiered_read_64bit(void *userdata, address addr, std::uint64_t *data) {
+        return reinterpret_cast<core *>(userdata)->read_64bit(addr, data);
+    }
+
+    static bool tiered_write_8bit(void *userdata, address addr, std::uint8_t *data) {
+        return reinterpret_cast<core *>(userdata)->write_8bit(addr, data);
+    }
+
+    static bool tiered_write_16bit(void *userdata, address addr, std::uint16_t *data) {
+        return reinterpret_cast<core *>(userdata)->write_16bit(addr, data);
+    }
+
+    static bool tiered_write_32bit(void *userdata, address addr, std::uint32_t *data) {
+        return reinterpret_cast<core *>(userdata)->write_32bit(addr, data);
+    }
+
+    static bool tiered_write_64bit(void *userdata, address addr, std::uint64_t *data) {
+        return reinterpret_cast<core *>(userdata)->write_64bit(addr, data);
+    }
+
+    static std::int32_t tiered_exclusive_write_8bit(void *userdata, address addr, std::uint8_t value, std::uint8_t expected) {
+        return reinterpret_cast<core *>(userdata)->exclusive_write_8bit(addr, value, expected);
+    }
+
+    static std::int32_t tiered_exclusive_write_16bit(void *userdata, address addr, std::uint16_t value, std::uint16_t expected) {
+        return reinterpret_cast<core *>(userdata)->exclusive_write_16bit(addr, value, expected);
+    }
+
+    static std::int32_t tiered_exclusive_write_32bit(void *userdata, address addr, std::uint32_t value, std::uint32_t expected) {
+        return reinterpret_cast<core *>(userdata)->exclusive_write_32bit(addr, value, expected);
+    }
+
+    static std::int32_t tiered_exclusive_write_64bit(void *userdata, address addr, std::uint64_t value, std::uint64_t expected) {
+        return reinterpret_cast<core *>(userdata)->exclusive_write_64bit(addr, value, expected);
+    }
+
+    tiered_core::tiered_core(exclusive_monitor *monitor, const bool enable_fastmem, const std::size_t core_num)
+        : interpreter_(std::make_unique<r12l1::interpreter_core>(monitor, core_num))
+        , jit_(std::make_unique<dynarmic_core>(monitor, enable_fastmem, core_num))
+        , active_(interpreter_.get())
+        , transfer_context_() {
+        set_core_number(core_num);
+
+        memory_callbacks callbacks;
+        callbacks.userdata = this;
+        callbacks.read_8bit = tiered_read_8bit;
+        callbacks.read_16bit = tiered_read_16bit;
+        callbacks.read_32bit = tiered_read_32bit;
+        callbacks.read_64bit = tiered_read_64bit;
+        callbacks.write_8bit = tiered_write_8bit;
+        callbacks.write_16bit = tiered_write_16bit;
+        callbacks.write_32bit = tiered_write_32bit;
+        callbacks.write_64bit = tiered_write_64bit;
+        callbacks.exclusive_write_8bit = tiered_exclusive_write_8bit;
+        callbacks.exclusive_write_16bit = tiered_exclusive_write_16bit;
+        callbacks.exclusive_write_32bit = tiered_exclusive_write_32bit;
+        callbacks.exclusive_write_64bit = tiered_exclusive_write_64bit;
+
+        for (core *child : { static_cast<core *>(interpreter_.get()), jit_.get() }) {
+            child->set_memory_callbacks(callbacks);
+
+            child->system_call_handler = [this](const std::uint32_t num) {
+                system_call_handler(num);
+            };
+
+            child->exception_handler = [this](exception_type type, const std::uint32_t data) {
+                exception_handler(type, data);
+            };
+        }
+
+        // The exclusive monitor finds the address space through the core it is given
+        interpreter_->set_monitor_owner(this);
+        interpreter_->set_hot_block_threshold(HOT_BLOCK_THRESHOLD);
+    }
+
+    tiered_core::~tiered_core() {
+    }
+
+    void tiered_core::switch_to(core *target) {
+        if (active_ == target) {
+            return;
+        }
+
+        active_->save_context(transfer_context_);
+        target->load_context(transfer_context_);
+
+        active_ = target;
+    }
+
+    void tiered_core::run(const std::uint32_t instruction_count) {
+        jit_ticks_executed_ = 0;
+
+        switch_to(interpreter_.get());
+        interpreter_->run(instruction_count);
+
+        if (!interpreter_->exited_on_hot_block()) {
+            return;
+        }
+
+        const std::uint32_t interpreted = interpreter_->get_num_instruction_executed();
+
+        if (interpreted >= instruction_count) {
+            return;
+        }
+
+        switch_to(jit_.get());
+
+        jit_->run(instruction_count - interpreted);
+        jit_ticks_executed_ = jit_->get_num_instruction_executed();
+    }
+
+    void tiered_core::stop() {
+        active_->stop();
+    }
+
+    void tiered_core::request_halt() {
+        // The active backend may change under us, so both get it. A leftover request only ends one run early.
+        interpreter_->request_halt();
+        jit_->request_halt();
+    }
+
+    void tiered_core::step() {
+        jit_ticks_executed_ = 0;
+
+        switch_to(interpreter_.get());
+        interpreter_->step();
+    }
+
+    uint32_t tiered_core::get_reg(size_t idx) {
+        return active_->get_reg(idx);
+    }
+
+    uint32_t tiered_core::get_sp() {
+        return active_->get_sp();
+    }
+
+    uint32_t tiered_core::get_pc() {
+        return active_->get_pc();
+    }
+
+    uint32_t tiered_core::get_vfp(size_t idx) {
+        return active_->get_vfp(idx);
+    }
+
+    void tiered_core::set_reg(size_t idx, uint32_t val) {
+        active_->set_reg(idx, val);
+    }
+
+    void tiered_core::set_pc(uint32_t val) {
+        active_->set_pc(val);
+    }
+
+    void tiered_core::set_sp(uint32_t val) {
+        active_->set_sp(val);
+    }
+
+    void tiered_core::set_lr(uint32_t val) {
+        active_->set_lr(val);
+    }
+
+    void tiered_core::set_vfp(size_t idx, uint32_t val) {
+        active_->set_vfp(idx, val);
+    }
+
+    uint32_t tiered_core::get_cpsr() {
+        return active_->get_cpsr();
+    }
+
+    uint32_t tiered_core::get_lr() {
+        return active_->get_lr();
+    }
+
+    void tiered_core::set_cpsr(uint32_t val) {
+        active_->set_cpsr(val);
+    }
+
+    void tiered_core::save_context(thread_context &ctx) {
+        active_->save_context(ctx);
+    }
+
+    void tiered_core::load_context(const thread_context &ctx) {
+        // Every run starts in the interpreter, so load the state there directly
+        interpreter_->load_context(ctx);
+        active_ = interpreter_.get();
+    }
+
+    void tiered_core::set_entry_point(address ep) {
+        active_->set_entry_point(ep);
+    }
+
+    address tiered_core::get_entry_point() {
+        return active_->get_entry_point();
+    }
+
+    void tiered_core::set_stack_top(address addr) {
+        active_->set_stack_top(addr);
+    }
+
+    address tiered_core::get_stack_top() {
+        return active_->get_stack_top();
+    }
+
+    void tiered_core::prepare_rescheduling() {
+        active_->prepare_rescheduling();
+    }
+
+    bool tiered_core::is_thumb_mode() {
+        return active_->is_thumb_mode();
+    }
+
+    void tiered_core::page_table_changed() {
+        interpreter_->page_table_changed();
+        jit_->page_table_changed();
+    }
+
+    void tiered_core::map_backing_mem(address vaddr, size_t size, uint8_t *ptr, prot protection) {
+        interpreter_->map_backing_mem(vaddr, size, ptr, protection);
+        jit_->map_backing_mem(vaddr, size, ptr, protection);
+    }
+
+    void tiered_core::unmap_memory(address addr, size_t size) {
+        interpreter_->unmap_memory(addr, size);
+        jit_->unmap_memory(addr, size);
+    }
+
+    void tiered_core::clear_instruction_cache() {
+        interpreter_->clear_instruction_cache();
+        jit_->clear_instruction_cache();
+    }
+
+    void tiered_core::imb_range(address addr, std::size_t size) {
+        interpreter_->imb_range(addr, size);
+        jit_->imb_range(addr, size);
+    }
+
+    std::uint32_t tiered_core::get_num_instruction_executed() {
+        return interpreter_->get_num_instruction_executed() + jit_ticks_executed_;
+    }
+
+    bool tiered_core::should_clear_old_memory_map() const {
+        return jit_->should_clear_old_memory_map();
+    }
+
+    void tiered_core::set_asid(std::uint8_t num) {
+        interpreter_->set_asid(num);
+        jit_->set_asid(num);
+    }
+
+    std::uint8_t tiered_core::get_asid() const {
+        return jit_->get_asid();
+    }
+
+    std::uint8_t tiered_core::get_max_asid_available() const {
+        return std::min(interpreter_->get_max_asid_available(), jit_->get_max_asid_available());
+    }
+}
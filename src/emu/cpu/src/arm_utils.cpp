@@ -44,6 +44,12 @@ namespace eka2l1::arm {
         case arm_emulator_type::unicorn:
             return unicorn_jit_backend_formal_name;
 
+        case arm_emulator_type::interpreter:
+            return interpreter_backend_formal_name;
+
+        case arm_emulator_type::tiered:
+            return tiered_backend_formal_name;
+
         default:
             break;
         }
@@ -60,6 +66,12 @@ namespace eka2l1::arm {
         if (backend_lowered == dynarmic_jit_backend_name)
             return arm_emulator_type::dynarmic;
 
+        if (backend_lowered == interpreter_backend_name)
+            return arm_emulator_type::interpreter;
+
+        if (backend_lowered == tiered_backend_name)
+            return arm_emulator_type::tiered;
+
         return arm_emulator_type::dynarmic;
     }
 }
\ No newline at end of file
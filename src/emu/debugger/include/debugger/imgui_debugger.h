@@ -59,6 +59,7 @@ namespace eka2l1 {
         bool should_show_threads;
         bool should_show_mutexs;
         bool should_show_chunks;
+        bool should_show_svc_stats;
         bool should_show_window_tree;
         bool should_show_rendered_bitmap;
 
@@ -178,6 +179,7 @@ namespace eka2l1 {
         void show_mutexs();
         void show_chunks();
         void show_timers();
+        void show_svc_stats();
         void show_disassembler();
         void show_menu();
         void show_preferences();
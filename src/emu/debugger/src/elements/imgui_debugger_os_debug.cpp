@@ -27,6 +27,7 @@
 #include <services/window/common.h>
 
 #include <kernel/kernel.h>
+#include <kernel/libmanager.h>
 #include <kernel/chunk.h>
 #include <kernel/mutex.h>
 #include <kernel/thread.h>
@@ -35,6 +36,7 @@
 #include <cpu/arm_utils.h>
 #include <disasm/disasm.h>
 #include <system/epoc.h>
+#include <config/config.h>
 #include <common/cvt.h>
 #include <imgui.h>
 
@@ -166,6 +168,17 @@ namespace eka2l1 {
         epoc::screen *scr = reinterpret_cast<epoc::screen *>(userdata);
         ImGui::Text("Screen number      %d", scr->number);
 
+        const epoc::composition_stats &stats = scr->last_composition_stats;
+
+        ImGui::Text("Last composition   %llu pixels, %u windows drawn, %u culled%s",
+            static_cast<unsigned long long>(stats.pixels_composed_), stats.windows_drawn_, stats.windows_culled_,
+            stats.full_ ? " (full)" : "");
+
+        if (scr->total_compositions) {
+            ImGui::Text("Average            %llu pixels per composition",
+                static_cast<unsigned long long>(scr->total_pixels_composed / scr->total_compositions));
+        }
+
         if (scr->screen_texture) {
             eka2l1::vec2 size = scr->size();
             ImGui::Image(reinterpret_cast<ImTextureID>(scr->screen_texture), ImVec2(static_cast<float>(size.x), static_cast<float>(size.y)));
@@ -247,7 +260,7 @@ namespace eka2l1 {
             ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s    %-32s    %-32s", "ID",
                 "Thread name", "State");
 
-            const std::lock_guard<std::mutex> guard(sys->get_kernel_system()->kern_lock_);
+            const std::lock_guard<common::counted_mutex> guard(sys->get_kernel_system()->kern_lock_);
 
             for (const auto &thr_obj : sys->get_kernel_system()->threads_) {
                 kernel::thread *thr = reinterpret_cast<kernel::thread *>(thr_obj.get());
@@ -266,7 +279,7 @@ namespace eka2l1 {
             ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s    %-32s", "ID",
                 "Mutex name");
 
-            const std::lock_guard<std::mutex> guard(sys->get_kernel_system()->kern_lock_);
+            const std::lock_guard<common::counted_mutex> guard(sys->get_kernel_system()->kern_lock_);
 
             for (const auto &mutex : sys->get_kernel_system()->mutexes_) {
                 ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X    %-32s", mutex->unique_id(),
@@ -282,7 +295,7 @@ namespace eka2l1 {
             ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-16s    %-24s         %-8s        %-8s      %-32s", "ID",
                 "Chunk name", "Committed", "Max", "Creator process");
 
-            const std::lock_guard<std::mutex> guard(sys->get_kernel_system()->kern_lock_);
+            const std::lock_guard<common::counted_mutex> guard(sys->get_kernel_system()->kern_lock_);
 
             for (const auto &chnk_obj : sys->get_kernel_system()->chunks_) {
                 kernel::chunk *chnk = reinterpret_cast<kernel::chunk *>(chnk_obj.get());
@@ -299,13 +312,79 @@ namespace eka2l1 {
     void imgui_debugger::show_timers() {
     }
 
+    void imgui_debugger::show_svc_stats() {
+        if (ImGui::Begin("System calls", &should_show_svc_stats)) {
+            config::state *conf = sys->get_config();
+            hle::lib_manager *mngr = sys->get_lib_manager();
+
+            ImGui::Checkbox("Profile", &conf->profile_svc);
+            ImGui::SameLine();
+
+            kernel_system *kern = sys->get_kernel_system();
+
+            if (ImGui::Button("Reset")) {
+                const std::lock_guard<common::counted_mutex> guard(kern->kern_lock_);
+                mngr->svc_funcs_.reset_stats();
+
+                kern->kern_lock_.reset_stats();
+
+                for (const auto &svr_obj : kern->servers_) {
+                    reinterpret_cast<service::server *>(svr_obj.get())->server_lock().reset_stats();
+                }
+            }
+
+            ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-10s    %-32s    %-10s    %-12s    %-10s    %s", "SVC",
+                "Name", "Calls", "Total (ms)", "Avg (us)", "Histogram (<256ns, x2 each)");
+
+            const std::lock_guard<common::counted_mutex> guard(kern->kern_lock_);
+
+            mngr->svc_funcs_.for_each([](const std::uint32_t svc_num, const hle::epoc_import_func &func, const hle::svc_stat &stat) {
+                if (!stat.calls_) {
+                    return;
+                }
+
+                std::string histogram;
+
+                for (const std::uint64_t bucket : stat.histogram_) {
+                    histogram += std::to_string(bucket) + " ";
+                }
+
+                ImGui::TextColored(GUI_COLOR_TEXT, "0x%08X    %-32s    %-10llu    %-12.3f    %-10.3f    %s", svc_num,
+                    func.name.c_str(), static_cast<unsigned long long>(stat.calls_), static_cast<double>(stat.total_ns_) / 1000000.0,
+                    static_cast<double>(stat.total_ns_) / static_cast<double>(stat.calls_) / 1000.0, histogram.c_str());
+            });
+
+            ImGui::NewLine();
+            ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%-32s    %-12s    %-12s    %s", "Lock", "Acquires", "Contended", "Wait (ms)");
+
+            auto show_lock_stats = [](const std::string &name, const common::lock_stats &stats) {
+                ImGui::TextColored(GUI_COLOR_TEXT, "%-32s    %-12llu    %-12llu    %.3f", name.c_str(),
+                    static_cast<unsigned long long>(stats.acquires_), static_cast<unsigned long long>(stats.contentions_),
+                    static_cast<double>(stats.wait_ns_) / 1000000.0);
+            };
+
+            show_lock_stats("Kernel", kern->kern_lock_.stats());
+
+            for (const auto &svr_obj : kern->servers_) {
+                service::server *svr = reinterpret_cast<service::server *>(svr_obj.get());
+                const common::lock_stats stats = svr->server_lock().stats();
+
+                if (svr->is_hle() && stats.acquires_) {
+                    show_lock_stats(svr->name(), stats);
+                }
+            }
+        }
+
+        ImGui::End();
+    }
+
     void imgui_debugger::show_disassembler() {
         if (ImGui::Begin("Disassembler", &should_show_disassembler)) {
             thread_ptr debug_thread = nullptr;
             kernel_system *kern = sys->get_kernel_system();
 
             if (!debug_thread_id) {
-                const std::lock_guard<std::mutex> guard(sys->get_kernel_system()->kern_lock_);
+                const std::lock_guard<common::counted_mutex> guard(sys->get_kernel_system()->kern_lock_);
 
                 if (kern->threads_.size() == 0) {
                     ImGui::End();
@@ -352,7 +431,8 @@ namespace eka2l1 {
                         ImGui::Text("0x%08x: %-10u    %s", pc, *reinterpret_cast<std::uint32_t *>(codeptr), dis.c_str());
                     } else {
                         const std::uint32_t svc_num = std::stoul(dis.substr(5), nullptr, 16);
-                        const std::string svc_call_name = sys->get_lib_manager()->svc_funcs_.find(svc_num) != sys->get_lib_manager()->svc_funcs_.end() ? sys->get_lib_manager()->svc_funcs_[svc_num].name : "Unknown";
+                        const hle::epoc_import_func *svc_func = sys->get_lib_manager()->svc_funcs_.get(svc_num);
+                        const std::string svc_call_name = svc_func ? svc_func->name : "Unknown";
 
                         ImGui::Text("0x%08x: %-10u    %s            ; %s", pc, *reinterpret_cast<std::uint32_t *>(codeptr), dis.c_str(), svc_call_name.c_str());
                     }
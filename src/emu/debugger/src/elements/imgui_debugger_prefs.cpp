@@ -314,6 +314,18 @@ namespace eka2l1 {
                 conf->serialize();
             }
 
+            if (ImGui::Selectable(arm::interpreter_backend_formal_name)) {
+                conf->cpu_backend = arm::interpreter_backend_name;
+                sys->set_cpu_executor_type(arm_emulator_type::interpreter);
+                conf->serialize();
+            }
+
+            if (ImGui::Selectable(arm::tiered_backend_formal_name)) {
+                conf->cpu_backend = arm::tiered_backend_name;
+                sys->set_cpu_executor_type(arm_emulator_type::tiered);
+                conf->serialize();
+            }
+
             ImGui::EndCombo();
         }
 
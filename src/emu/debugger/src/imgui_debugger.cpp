@@ -49,6 +49,7 @@
 #include <common/cvt.h>
 #include <common/language.h>
 #include <common/platform.h>
+#include <common/profiler.h>
 
 #include <yaml-cpp/yaml.h>
 #include <debugger/imgui_consts.h>
@@ -76,6 +77,7 @@ namespace eka2l1 {
         , should_reset(false)
         , should_show_threads(false)
         , should_show_mutexs(false)
+        , should_show_svc_stats(false)
         , should_show_chunks(false)
         , should_show_window_tree(false)
         , should_show_disassembler(false)
@@ -456,6 +458,20 @@ namespace eka2l1 {
 
                 ImGui::MenuItem(disassembler_item_name.c_str(), nullptr, &should_show_disassembler);
 
+                const std::string svc_stats_item_name = common::get_localised_string(localised_strings,
+                    "debugger_menu_svc_stats_item_name");
+
+                ImGui::MenuItem(svc_stats_item_name.c_str(), nullptr, &should_show_svc_stats);
+
+                if (common::is_profiler_available()) {
+                    const std::string dump_profile_item_name = common::get_localised_string(localised_strings,
+                        "debugger_menu_dump_profile_item_name");
+
+                    if (ImGui::MenuItem(dump_profile_item_name.c_str())) {
+                        common::dump_profiler_capture("profile_capture.html");
+                    }
+                }
+
                 if (ImGui::BeginMenu(object_submenu_name.c_str())) {
                     const std::string threads_item_name = common::get_localised_string(localised_strings,
                         "debugger_menu_objects_submenu_threads_item_name");
@@ -619,6 +635,10 @@ namespace eka2l1 {
             show_disassembler();
         }
 
+        if (should_show_svc_stats) {
+            show_svc_stats();
+        }
+
         if (should_show_preferences) {
             show_preferences();
         }
@@ -25,6 +25,8 @@
 #include <cstdint>
 
 namespace eka2l1::drivers {
+    class audio_mixer;
+
     class audio_driver : public driver {
     public:
         virtual ~audio_driver() {}
@@ -48,6 +50,15 @@ namespace eka2l1::drivers {
             = 0;
 
         virtual std::uint32_t native_sample_rate() = 0;
+
+        /**
+         * \brief Get the mixer that output streams are played through.
+         *
+         * \returns Nullptr if each output stream is played through its own host stream.
+         */
+        virtual audio_mixer *get_mixer() {
+            return nullptr;
+        }
     };
 
     enum class audio_driver_backend {
@@ -21,6 +21,10 @@
 
 #include <cubeb/cubeb.h>
 #include <drivers/audio/audio.h>
+#include <drivers/audio/mixer.h>
+
+#include <memory>
+#include <mutex>
 
 namespace eka2l1::drivers {
     struct cubeb_audio_driver : public audio_driver {
@@ -28,6 +32,11 @@ namespace eka2l1::drivers {
         cubeb *context_;
         bool init_;
 
+        std::mutex mixer_lock_;
+        std::unique_ptr<audio_mixer> mixer_;
+
+        audio_mixer *create_mixer();
+
     public:
         explicit cubeb_audio_driver();
 
@@ -35,5 +44,6 @@ namespace eka2l1::drivers {
         std::unique_ptr<audio_output_stream> new_output_stream(const std::uint32_t sample_rate,
             const std::uint8_t channels, data_callback callback) override;
         std::uint32_t native_sample_rate() override;
+        audio_mixer *get_mixer() override;
     };
 }
\ No newline at end of file
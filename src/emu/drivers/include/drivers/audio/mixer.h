@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <drivers/audio/stream.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace eka2l1::drivers {
+    class audio_mixer;
+
+    struct audio_mixer_statistics {
+        std::uint64_t callback_count_ = 0; ///< Number of times the host asked for data.
+        std::uint64_t underrun_count_ = 0; ///< Times a playing stream supplied fewer frames than needed.
+        std::uint64_t overtime_count_ = 0; ///< Callbacks where mixing took longer than the audio it produced.
+
+        std::uint32_t stream_count_ = 0; ///< Streams attached to the mixer.
+        std::uint32_t playing_stream_count_ = 0; ///< Streams mixed in the last callback.
+
+        double last_mix_time_us_ = 0.0;
+        double max_mix_time_us_ = 0.0;
+        double average_mix_time_us_ = 0.0;
+    };
+
+    /**
+     * \brief A guest audio stream, played through the mixer instead of its own host stream.
+     *
+     * Samples are pulled from the data callback at the stream's own rate and channel count,
+     * then converted to the mixer's output format.
+     */
+    struct mixer_output_stream : public audio_output_stream {
+    private:
+        friend class audio_mixer;
+
+        audio_mixer *mixer_;
+        data_callback callback_;
+
+        std::uint32_t sample_rate_;
+        std::uint8_t channels_;
+
+        std::atomic<float> volume_;
+        std::atomic<bool> playing_;
+
+        // Resampler state, only touched by the mixing thread. The carried frames are the source
+        // frames already pulled but not yet passed by the read position.
+        double position_frac_;
+        float carry_[2][2];
+        std::uint32_t carry_count_;
+
+        std::vector<std::int16_t> source_;
+        std::vector<float> source_float_;
+
+    public:
+        explicit mixer_output_stream(audio_mixer *mixer, const std::uint32_t sample_rate, const std::uint8_t channels,
+            data_callback callback);
+
+        ~mixer_output_stream() override;
+
+        bool start() override;
+        bool stop() override;
+
+        bool is_playing() override;
+
+        bool set_volume(const float volume) override;
+    };
+
+    /**
+     * \brief Mix all guest streams into a single host output stream.
+     *
+     * Each host stream comes with its own callback thread and latency, so instead of opening one
+     * per guest stream, the driver opens a single stereo stream at the native rate and lets the
+     * mixer fill it.
+     */
+    class audio_mixer {
+        friend struct mixer_output_stream;
+
+        std::uint32_t output_rate_;
+
+        std::mutex lock_;
+        std::vector<mixer_output_stream *> streams_;
+        std::vector<float> accumulator_;
+
+        std::mutex host_lock_;
+        std::unique_ptr<audio_output_stream> host_;
+
+        audio_mixer_statistics stats_;
+        double total_mix_time_us_;
+
+        void attach(mixer_output_stream *stream);
+        void detach(mixer_output_stream *stream);
+
+        void ensure_host_started();
+
+        bool mix_stream(mixer_output_stream *stream, const std::size_t frames);
+
+    public:
+        static constexpr std::uint8_t OUTPUT_CHANNELS = 2;
+
+        explicit audio_mixer(const std::uint32_t output_rate);
+        ~audio_mixer();
+
+        /**
+         * \brief Give the mixer the host stream to play through.
+         *
+         * The host stream's data callback should call mix(). It is started when the first guest stream
+         * starts playing.
+         */
+        void set_host_stream(std::unique_ptr<audio_output_stream> host);
+
+        /**
+         * \brief Create a new guest stream played through this mixer.
+         *
+         * \see audio_driver::new_output_stream
+         */
+        std::unique_ptr<audio_output_stream> new_stream(const std::uint32_t sample_rate, const std::uint8_t channels,
+            data_callback callback);
+
+        /**
+         * \brief Mix all playing streams into signed 16-bit interleaved stereo.
+         *
+         * \param output Destination, must hold frames * OUTPUT_CHANNELS samples.
+         * \param frames Number of frames to produce.
+         *
+         * \returns Number of frames wrote, always equal to frames.
+         */
+        std::size_t mix(std::int16_t *output, const std::size_t frames);
+
+        std::uint32_t output_rate() const {
+            return output_rate_;
+        }
+
+        audio_mixer_statistics get_statistics();
+    };
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace eka2l1::drivers {
+    /**
+     * \brief Linear allocator for payloads living as long as a command list.
+     *
+     * Memory is handed out from fixed-size chunks by bumping a cursor, so pointers stay valid
+     * until the arena is reset. Resetting keeps the chunks around, so a recycled arena
+     * does not touch the heap again once it has warmed up.
+     */
+    class command_arena {
+        struct chunk {
+            std::unique_ptr<std::uint8_t[]> data_;
+            std::size_t size_;
+        };
+
+        std::vector<chunk> chunks_;
+        std::size_t current_;
+        std::size_t cursor_;
+
+    public:
+        static constexpr std::size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+        explicit command_arena();
+
+        command_arena(command_arena &&rhs) = default;
+        command_arena &operator=(command_arena &&rhs) = default;
+
+        /**
+         * \brief Allocate memory from the arena.
+         *
+         * \param size   Size of the memory to allocate.
+         * \param align  Alignment of the memory. Must be a power of two.
+         *
+         * \returns Pointer to the allocated memory.
+         */
+        void *allocate(const std::size_t size, const std::size_t align = alignof(std::max_align_t));
+
+        /**
+         * \brief Free all allocations at once, keeping the chunks for later use.
+         */
+        void reset();
+
+        std::size_t capacity() const;
+    };
+
+    /**
+     * \brief Ring buffer holding large payloads until the driver is done with them.
+     *
+     * Command lists built on client threads allocate bitmap and buffer uploads here instead of
+     * making a heap copy for each of them. The allocation is handed back once the driver thread has
+     * executed the list. Lists may be submitted out of allocation order, so space is only reclaimed
+     * when everything before it has been released too.
+     */
+    class payload_ring {
+        struct allocation {
+            std::size_t end_;
+            std::size_t size_;
+            bool released_;
+        };
+
+        std::unique_ptr<std::uint8_t[]> data_;
+        std::size_t capacity_;
+
+        std::size_t head_;
+        std::size_t tail_;
+        std::size_t used_;
+
+        std::deque<allocation> allocations_;
+        std::uint64_t first_ticket_;
+
+        std::mutex lock_;
+
+    public:
+        static constexpr std::size_t DEFAULT_CAPACITY = 8 * 1024 * 1024;
+
+        explicit payload_ring(const std::size_t capacity = DEFAULT_CAPACITY);
+
+        /**
+         * \brief Allocate memory from the ring.
+         *
+         * \param size    Size of the memory to allocate.
+         * \param ticket  On success, receives the ticket used to release the memory.
+         *
+         * \returns Pointer to the memory, or nullptr if the ring does not have enough free space.
+         */
+        std::uint8_t *allocate(const std::size_t size, std::uint64_t &ticket);
+
+        /**
+         * \brief Hand back memory allocated from the ring.
+         * \param ticket The ticket returned by allocate.
+         */
+        void release(const std::uint64_t ticket);
+
+        std::size_t used();
+
+        std::size_t capacity() const {
+            return capacity_;
+        }
+    };
+}
@@ -21,7 +21,12 @@
 #pragma once
 
 #include <common/queue.h>
+#include <drivers/command_arena.h>
+
+#include <algorithm>
 #include <condition_variable>
+#include <mutex>
+#include <vector>
 
 namespace eka2l1::drivers {
     static constexpr std::uint32_t MAX_COMMAND_DATA_SIZE = 80;
@@ -33,20 +38,17 @@ namespace eka2l1::drivers {
         std::uint16_t opcode_;
         std::uint8_t data_[MAX_COMMAND_DATA_SIZE];
 
-        command *next_;
         int *status_;
 
         explicit command()
             : opcode_(0)
             , data_()
-            , next_(nullptr)
             , status_(nullptr) {
         }
 
         explicit command(const std::uint16_t opcode, int *status = nullptr)
             : opcode_(opcode)
             , data_()
-            , next_(nullptr)
             , status_(status) {
         }
     };
@@ -147,9 +149,123 @@ namespace eka2l1::drivers {
         }
     }
 
+    /**
+     * \brief A list of command, stored contiguously.
+     *
+     * Payloads too big to fit in a command (bitmap data, uniforms, buffer uploads...) are owned by the list too.
+     * Small ones are placed in the list's arena, large ones in the payload ring shared with the driver when
+     * there is one. All of them are freed when the list is reset, which the driver does after executing it.
+     */
+    struct command_list {
+        static constexpr std::size_t SMALL_PAYLOAD_SIZE = 4096;
+
+        std::vector<command> commands_;
+        command_arena arena_;
+
+        payload_ring *ring_;
+        std::vector<std::uint64_t> ring_tickets_;
+
+        explicit command_list(payload_ring *ring = nullptr)
+            : ring_(ring) {
+        }
+
+        ~command_list() {
+            reset();
+        }
+
+        command_list(const command_list &rhs) = delete;
+        command_list &operator=(const command_list &rhs) = delete;
+
+        command_list(command_list &&rhs)
+            : commands_(std::move(rhs.commands_))
+            , arena_(std::move(rhs.arena_))
+            , ring_(rhs.ring_)
+            , ring_tickets_(std::move(rhs.ring_tickets_)) {
+            rhs.commands_.clear();
+            rhs.ring_tickets_.clear();
+        }
+
+        command_list &operator=(command_list &&rhs) {
+            if (this != &rhs) {
+                reset();
+
+                commands_ = std::move(rhs.commands_);
+                arena_ = std::move(rhs.arena_);
+                ring_ = rhs.ring_;
+                ring_tickets_ = std::move(rhs.ring_tickets_);
+
+                rhs.commands_.clear();
+                rhs.ring_tickets_.clear();
+            }
+
+            return *this;
+        }
+
+        bool empty() const {
+            return commands_.empty();
+        }
+
+        /**
+         * \brief Append a new command to the list.
+         *
+         * The returned pointer is only valid until the next command is added.
+         */
+        command *add(const std::uint16_t opcode, int *status = nullptr) {
+            return &commands_.emplace_back(opcode, status);
+        }
+
+        /**
+         * \brief Allocate payload memory, living until the list is reset.
+         *
+         * \param size Size of the payload in bytes.
+         * \returns Pointer to the payload memory.
+         */
+        std::uint8_t *allocate_payload(const std::size_t size) {
+            if (ring_ && (size > SMALL_PAYLOAD_SIZE)) {
+                std::uint64_t ticket = 0;
+                std::uint8_t *data = ring_->allocate(size, ticket);
+
+                if (data) {
+                    ring_tickets_.push_back(ticket);
+                    return data;
+                }
+            }
+
+            return reinterpret_cast<std::uint8_t *>(arena_.allocate(size));
+        }
+
+        /**
+         * \brief Copy a payload into memory owned by this list.
+         *
+         * \param source Pointer to the data to copy.
+         * \param size   Size of the data in bytes.
+         *
+         * \returns Pointer to the copy.
+         */
+        void *copy_payload(const void *source, const std::size_t size) {
+            std::uint8_t *dest = allocate_payload(size);
+            std::copy(reinterpret_cast<const std::uint8_t *>(source), reinterpret_cast<const std::uint8_t *>(source) + size, dest);
+
+            return dest;
+        }
+
+        /**
+         * \brief Drop all commands and free their payloads, keeping the storage for reuse.
+         */
+        void reset() {
+            for (const std::uint64_t ticket : ring_tickets_) {
+                ring_->release(ticket);
+            }
+
+            ring_tickets_.clear();
+            commands_.clear();
+            arena_.reset();
+        }
+    };
+
     template <typename... Args>
-    command *make_command(const std::uint16_t opcode, int *status, Args... arguments) {
-        command *cmd = new command(opcode, status);
+    command *make_command(command_list &list, const std::uint16_t opcode, int *status, Args... arguments) {
+        command *cmd = list.add(opcode, status);
         command_helper helper(cmd);
 
         if constexpr (sizeof...(Args) > 0)
@@ -159,30 +275,50 @@ namespace eka2l1::drivers {
     }
 
     /**
-     * \brief A linked list of command.
+     * \brief Recycles executed command lists, so building a frame does not hit the heap once warmed up.
      */
-    struct command_list {
-        command *first_;
-        command *last_;
+    class command_list_pool {
+        payload_ring ring_;
 
-        explicit command_list()
-            : first_(nullptr) {
-        }
+        std::vector<command_list> free_lists_;
+        std::mutex lock_;
 
-        bool empty() const {
-            return !first_;
+    public:
+        static constexpr std::size_t MAX_FREE_LISTS = 16;
+
+        /**
+         * \brief Get an empty command list, backed by the pool's payload ring.
+         */
+        command_list acquire() {
+            {
+                const std::lock_guard<std::mutex> guard(lock_);
+
+                if (!free_lists_.empty()) {
+                    command_list list = std::move(free_lists_.back());
+                    free_lists_.pop_back();
+
+                    return list;
+                }
+            }
+
+            return command_list(&ring_);
         }
 
-        void add(command *cmd_) {
-            if (first_ == nullptr) {
-                first_ = cmd_;
-                last_ = cmd_;
+        /**
+         * \brief Free payloads of an executed list, and keep its storage for a later acquire.
+         */
+        void recycle(command_list &list) {
+            list.reset();
 
-                return;
+            const std::lock_guard<std::mutex> guard(lock_);
+
+            if ((list.ring_ == &ring_) && (free_lists_.size() < MAX_FREE_LISTS)) {
+                free_lists_.push_back(std::move(list));
             }
+        }
 
-            last_->next_ = cmd_;
-            last_ = cmd_;
+        payload_ring &get_payload_ring() {
+            return ring_;
         }
     };
 
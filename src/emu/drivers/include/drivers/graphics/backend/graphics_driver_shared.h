@@ -32,6 +32,8 @@
 #include <common/queue.h>
 #include <common/vecx.h>
 
+#include <atomic>
+
 namespace eka2l1::drivers {
     /**
      * \brief Bitmap is basically a texture. It can be drawn into and can be taken to draw.
@@ -68,6 +70,15 @@ namespace eka2l1::drivers {
         glm::mat4 projection_matrix;
         eka2l1::vecx<float, 4> brush_color;
 
+        graphics_frame_stats frame_stats;
+        std::atomic<std::uint32_t> last_frame_draw_calls;
+        std::atomic<std::uint64_t> last_frame_upload_bytes;
+
+        /**
+         * \brief Publish statistics of the frame being presented, and start counting a new one.
+         */
+        void end_frame_stats();
+
         drivers::handle append_graphics_object(graphics_object_instance &instance);
         bool delete_graphics_object(const drivers::handle handle);
         graphics_object *get_graphics_object(const drivers::handle num);
@@ -106,6 +117,8 @@ namespace eka2l1::drivers {
         void attach_descriptors(drivers::handle h, const int stride, const bool instance_move, const attribute_descriptor *descriptors,
             const int descriptor_count) override;
 
+        graphics_frame_stats get_last_frame_stats() const override;
+
         virtual void dispatch(command *cmd);
 
         virtual void bind_swapchain_framebuf() = 0;
@@ -29,6 +29,7 @@
 
 #include <memory>
 #include <queue>
+#include <vector>
 
 namespace eka2l1::drivers {
     struct ogl_state {
@@ -52,36 +53,68 @@ namespace eka2l1::drivers {
         GLboolean last_enable_scissor_test;
     };
 
+    /**
+     * \brief Vertex of a batched 2D draw. Position is already transformed to the target's pixel space.
+     */
+    struct ogl_batch_vertex {
+        float pos_[2];
+        float coord_[2];
+        float color_[4];
+    };
+
+    enum class ogl_batch_program {
+        none,
+        sprite,
+        mask,
+        fill
+    };
+
+    /**
+     * \brief Everything a batch of quads must share to be drawn in one call.
+     */
+    struct ogl_batch_state {
+        ogl_batch_program program_ = ogl_batch_program::none;
+        GLuint texture_ = 0;
+        GLuint mask_ = 0;
+        float flip_ = -1.0f;
+        float invert_ = 0.0f;
+
+        bool operator==(const ogl_batch_state &rhs) const {
+            return (program_ == rhs.program_) && (texture_ == rhs.texture_) && (mask_ == rhs.mask_)
+                && (flip_ == rhs.flip_) && (invert_ == rhs.invert_);
+        }
+
+        bool operator!=(const ogl_batch_state &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
     class ogl_graphics_driver : public shared_graphics_driver {
         eka2l1::request_queue<server_graphics_command_list> list_queue;
+        command_list_pool list_pool;
         std::unique_ptr<ogl_shader> sprite_program;
         std::unique_ptr<ogl_shader> fill_program;
         std::unique_ptr<ogl_shader> mask_program;
 
-        GLuint sprite_vao;
-        GLuint sprite_vbo;
-        GLuint sprite_ibo;
+        GLuint batch_vao;
+        GLuint batch_vbo;
+        GLuint batch_ibo;
 
-        GLuint fill_vao;
-        GLuint fill_vbo;
-
-        GLint color_loc;
         GLint proj_loc;
-        GLint model_loc;
         GLint flip_loc;
 
-        GLint color_loc_fill;
         GLint proj_loc_fill;
-        GLint model_loc_fill;
 
-        GLint color_loc_mask;
         GLint proj_loc_mask;
-        GLint model_loc_mask;
         GLint invert_loc_mask;
         GLint source_loc_mask;
         GLint mask_loc_mask;
         GLint flip_loc_mask;
 
+        std::vector<ogl_batch_vertex> batch_vertices;
+        ogl_batch_state batch_state;
+        std::size_t batch_stream_offset;
+
         ogl_state backup;
         std::atomic_bool should_stop;
 
@@ -106,6 +139,9 @@ namespace eka2l1::drivers {
         void set_stencil_mask(command_helper &helper);
         void display(command_helper &helper);
 
+        void queue_batch_quad(const ogl_batch_state &state, const ogl_batch_vertex *verts);
+        void flush_batch();
+
         void save_gl_state();
         void load_gl_state();
 
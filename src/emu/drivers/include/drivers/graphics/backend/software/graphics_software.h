@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <drivers/graphics/backend/graphics_driver_shared.h>
+#include <drivers/graphics/backend/software/fb_software.h>
+#include <drivers/graphics/backend/software/texture_software.h>
+
+#include <common/queue.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace eka2l1::drivers {
+    struct software_blend_state {
+        bool enabled_ = false;
+
+        blend_equation rgb_equation_ = blend_equation::add;
+        blend_equation a_equation_ = blend_equation::add;
+        blend_factor rgb_src_ = blend_factor::one;
+        blend_factor rgb_dest_ = blend_factor::zero;
+        blend_factor a_src_ = blend_factor::one;
+        blend_factor a_dest_ = blend_factor::zero;
+    };
+
+    /**
+     * \brief Stencil state. Front and back faces are not told apart, 2D draws have no real facing.
+     */
+    struct software_stencil_state {
+        bool enabled_ = false;
+
+        condition_func func_ = condition_func::always;
+        std::uint8_t ref_ = 0;
+        std::uint8_t read_mask_ = 0xFF;
+        std::uint8_t write_mask_ = 0xFF;
+
+        stencil_action on_fail_ = stencil_action::keep;
+        stencil_action on_pass_ = stencil_action::keep;
+    };
+
+    /**
+     * \brief Render state kept across a backup and restore, like the OpenGL driver's ogl_state.
+     */
+    struct software_state {
+        eka2l1::rect viewport_;
+        eka2l1::rect scissor_;
+        bool clipping_ = false;
+
+        software_blend_state blend_;
+        software_stencil_state stencil_;
+    };
+
+    /**
+     * \brief A quad ready to be rasterized.
+     *
+     * Position and texture coordinates are affine in the quad's (u, v) parameter, which goes from 0 to 1
+     * along both edges. Positions are in framebuffer pixels, origin at the bottom.
+     */
+    struct software_quad {
+        float origin_[2];
+        float axis_u_[2];
+        float axis_v_[2];
+
+        float tex_origin_[2];
+        float tex_axis_u_[2];
+        float tex_axis_v_[2];
+
+        float color_[4];
+
+        software_texture *texture_ = nullptr;
+        software_texture *mask_ = nullptr;
+        bool invert_mask_ = false;
+    };
+
+    /**
+     * \brief Graphics driver drawing on the CPU, for hosts without a GPU.
+     *
+     * Implements the immediate mode used by the window server and font atlas: bitmaps, rectangles,
+     * clipping, stencil and blending. Presenting copies the swapchain into memory instead of a window,
+     * where it can be read back. Shader programs are accepted but draws using them are skipped.
+     */
+    class software_graphics_driver : public shared_graphics_driver {
+        friend class software_framebuffer;
+
+        eka2l1::request_queue<server_graphics_command_list> list_queue;
+        command_list_pool list_pool;
+        std::atomic_bool should_stop;
+
+        std::unique_ptr<software_texture> swapchain;
+        software_framebuffer *read_fb;
+        software_framebuffer *draw_fb;
+
+        // Both in framebuffer pixels, origin at the bottom like OpenGL
+        eka2l1::rect viewport;
+        eka2l1::rect scissor;
+        bool clipping;
+
+        software_blend_state blend;
+        software_stencil_state stencil;
+
+        software_state backup;
+
+        std::mutex frame_lock;
+        std::vector<std::uint32_t> presented_frame;
+        eka2l1::vec2 presented_size;
+        std::uint64_t present_count;
+
+        bool warned_indexed_draw;
+
+        software_texture *get_target_color();
+        software_texture *get_target_depth_stencil();
+
+        void to_framebuffer_coords(const float x, const float y, const float flip, float *result);
+        void draw_quad(const software_quad &quad);
+
+        void resize_swapchain();
+
+        void clear(command_helper &helper);
+        void draw_bitmap(command_helper &helper);
+        void draw_rectangle(command_helper &helper);
+        void draw_indexed(command_helper &helper);
+        void set_clipping(command_helper &helper);
+        void clip_rect(command_helper &helper);
+        void set_viewport(command_helper &helper);
+        void set_blend(command_helper &helper);
+        void blend_formula(command_helper &helper);
+        void set_stencil(command_helper &helper);
+        void set_stencil_action(command_helper &helper);
+        void set_stencil_pass_condition(command_helper &helper);
+        void set_stencil_mask(command_helper &helper);
+        void display(command_helper &helper);
+
+        void save_state();
+        void load_state();
+
+    public:
+        explicit software_graphics_driver();
+        ~software_graphics_driver() override;
+
+        void set_viewport(const eka2l1::rect &viewport) override;
+        std::unique_ptr<graphics_command_list> new_command_list() override;
+        void submit_command_list(graphics_command_list &command_list) override;
+        std::unique_ptr<graphics_command_list_builder> new_command_builder(graphics_command_list *list) override;
+
+        void run() override;
+        void abort() override;
+        void dispatch(command *cmd) override;
+        void bind_swapchain_framebuf() override;
+
+        /**
+         * \brief Copy the content of a bitmap, as RGBA8 with the first row at the top.
+         *
+         * Safe to call from any thread. The bitmap is read between two command lists.
+         *
+         * \returns False if the handle is not a bitmap.
+         */
+        bool read_bitmap(const drivers::handle h, std::vector<std::uint32_t> &pixels, eka2l1::vec2 &size);
+
+        /**
+         * \brief Copy the last presented frame, as RGBA8 with the first row at the top.
+         *
+         * \returns Number of frames presented so far.
+         */
+        std::uint64_t read_presented_frame(std::vector<std::uint32_t> &pixels, eka2l1::vec2 &size);
+    };
+}
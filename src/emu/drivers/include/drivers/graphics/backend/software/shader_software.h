@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <drivers/graphics/shader.h>
+
+namespace eka2l1::drivers {
+    /**
+     * \brief Placeholder shader, programs can't run on the software driver.
+     *
+     * Creating one succeeds, so code waiting for the program handle does not stall. Draws using it
+     * are skipped by the driver.
+     */
+    class software_shader : public shader {
+    public:
+        bool create(graphics_driver *driver, const char *vert_data, const std::size_t vert_size,
+            const char *frag_data, const std::size_t frag_size) override;
+
+        bool use(graphics_driver *driver) override;
+        bool set(graphics_driver *driver, const int binding, const shader_set_var_type var_type, const void *data) override;
+
+        std::optional<int> get_uniform_location(const std::string &name) override;
+        std::optional<int> get_attrib_location(const std::string &name) override;
+    };
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <common/vecx.h>
+#include <drivers/graphics/texture.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace eka2l1::drivers {
+    /**
+     * \brief Pack a RGBA color into the layout software textures store pixels in.
+     *
+     * Pixels are 32-bit, red in the lowest byte, so in memory they read as RGBA8.
+     */
+    inline std::uint32_t software_pack_rgba(const std::uint32_t r, const std::uint32_t g, const std::uint32_t b, const std::uint32_t a) {
+        return r | (g << 8) | (b << 16) | (a << 24);
+    }
+
+    /**
+     * \brief Texture living in host memory.
+     *
+     * Uploaded data of every supported format is converted to RGBA8 once, the same way an OpenGL
+     * driver would expand it, so drawing only ever deals with one pixel format. Rows are stored in
+     * upload order, which is also how OpenGL lays out a texture: row 0 is at the bottom of a framebuffer.
+     *
+     * Depth stencil textures only keep the stencil part.
+     */
+    class software_texture : public texture {
+        int dimensions;
+        vec2 tex_size;
+        texture_format internal_format;
+        texture_format format;
+        texture_data_type tex_data_type;
+        void *tex_data;
+        int mip_level;
+        std::size_t pixels_per_line;
+
+        filter_option min_filter;
+        filter_option mag_filter;
+
+        // Index of the source channel for each output channel. 4 is zero, 5 is one.
+        std::array<std::uint8_t, 4> swizzle;
+        bool swizzle_identity;
+
+        std::vector<std::uint32_t> pixels;
+        std::vector<std::uint8_t> stencil;
+
+        void allocate_storage();
+
+    public:
+        explicit software_texture();
+        ~software_texture() override;
+
+        bool tex(graphics_driver *driver, const bool is_first = false) override;
+
+        bool create(graphics_driver *driver, const int dim, const int miplvl, const vec3 &size, const texture_format internal_format,
+            const texture_format format, const texture_data_type data_type, void *data, const std::size_t pixels_per_line = 0) override;
+
+        void change_size(const vec3 &new_size) override;
+        void change_data(const texture_data_type data_type, void *data) override;
+        void change_texture_format(const texture_format format) override;
+
+        void set_filter_minmag(const bool min, const filter_option op) override;
+        void set_channel_swizzle(channel_swizzles swizz) override;
+
+        void bind(graphics_driver *driver, const int binding) override;
+        void unbind(graphics_driver *driver) override;
+
+        void update_data(graphics_driver *driver, const int mip_lvl, const vec3 &offset, const vec3 &size, const std::size_t pixels_per_line,
+            const texture_format data_format, const texture_data_type data_type, const void *data) override;
+
+        vec2 get_size() const override {
+            return tex_size;
+        }
+
+        texture_format get_format() const override {
+            return internal_format;
+        }
+
+        texture_data_type get_data_type() const override {
+            return tex_data_type;
+        }
+
+        int get_mip_level() const override {
+            return mip_level;
+        }
+
+        int get_total_dimensions() const override {
+            return dimensions;
+        }
+
+        void *get_data_ptr() const override {
+            return tex_data;
+        }
+
+        std::uint64_t texture_handle() override {
+            return reinterpret_cast<std::uint64_t>(this);
+        }
+
+        bool is_depth_stencil() const {
+            return (internal_format == texture_format::depth24_stencil8) || (internal_format == texture_format::depth_stencil);
+        }
+
+        std::uint32_t *color_data() {
+            return pixels.data();
+        }
+
+        const std::uint32_t *color_data() const {
+            return pixels.data();
+        }
+
+        std::uint8_t *stencil_data() {
+            return stencil.data();
+        }
+
+        /**
+         * \brief Read a texel with the channel swizzle applied. Coordinates must be in range.
+         */
+        std::uint32_t sample(const int x, const int y) const {
+            const std::uint32_t raw = pixels[static_cast<std::size_t>(y) * tex_size.x + x];
+
+            if (swizzle_identity) {
+                return raw;
+            }
+
+            const std::uint32_t channels[6] = { raw & 0xFF, (raw >> 8) & 0xFF, (raw >> 16) & 0xFF, raw >> 24, 0, 0xFF };
+            return software_pack_rgba(channels[swizzle[0]], channels[swizzle[1]], channels[swizzle[2]], channels[swizzle[3]]);
+        }
+    };
+}
@@ -83,6 +83,14 @@ namespace eka2l1::drivers {
 
     using display_hook = std::function<void()>;
 
+    /**
+     * \brief Work done by the driver between two presents.
+     */
+    struct graphics_frame_stats {
+        std::uint32_t draw_calls_ = 0;
+        std::uint64_t upload_bytes_ = 0;
+    };
+
     class graphics_driver : public driver {
         graphic_api api_;
 
@@ -128,6 +136,13 @@ namespace eka2l1::drivers {
 
         virtual void set_viewport(const eka2l1::rect &viewport) = 0;
 
+        /**
+         * \brief Get statistics of the last presented frame.
+         */
+        virtual graphics_frame_stats get_last_frame_stats() const {
+            return graphics_frame_stats{};
+        }
+
         virtual std::unique_ptr<graphics_command_list> new_command_list() = 0;
 
         virtual std::unique_ptr<graphics_command_list_builder> new_command_builder(graphics_command_list *list) = 0;
@@ -135,7 +150,8 @@ namespace eka2l1::drivers {
         /**
          * \brief Submit a command list.
          * 
-         * The list object will be copied within the function, and can be safely delete after.
+         * The content of the list object is moved within the function. The list is left empty, and
+         * can be safely deleted or reused after.
          *
          * \param command_list     Command list to submit.
          */
@@ -121,6 +121,15 @@ namespace eka2l1::drivers {
     struct server_graphics_command_list : public graphics_command_list {
         command_list list_;
 
+        server_graphics_command_list() = default;
+
+        explicit server_graphics_command_list(command_list &&list)
+            : list_(std::move(list)) {
+        }
+
+        server_graphics_command_list(server_graphics_command_list &&rhs) = default;
+        server_graphics_command_list &operator=(server_graphics_command_list &&rhs) = default;
+
         ~server_graphics_command_list() override {
         }
 
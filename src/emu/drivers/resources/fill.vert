@@ -1,11 +1,14 @@
 #version 330
 
 layout (location = 0) in vec2 in_position;
+layout (location = 2) in vec4 in_color;
+
+out vec4 r_color;
 
 uniform mat4 u_proj;
-uniform mat4 u_model;
 
 void main() {
-    gl_Position = u_proj * u_model * vec4(in_position, 0.0, 1.0);
+    gl_Position = u_proj * vec4(in_position, 0.0, 1.0);
     gl_Position.y = -gl_Position.y;
+    r_color = in_color;
 }
\ No newline at end of file
@@ -1,12 +1,12 @@
 #version 330
 
 uniform sampler2D u_tex;
-uniform vec4 u_color;
 
 in vec2 r_texcoord;
+in vec4 r_color;
 
 out vec4 o_color;
 
 void main() {
-    o_color = texture(u_tex, r_texcoord) * (u_color / 255.0);
+    o_color = texture(u_tex, r_texcoord) * (r_color / 255.0);
 }
\ No newline at end of file
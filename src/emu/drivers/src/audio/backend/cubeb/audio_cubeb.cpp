@@ -39,6 +39,9 @@ namespace eka2l1::drivers {
     }
 
     cubeb_audio_driver::~cubeb_audio_driver() {
+        // The mixer owns the host stream, which must go before the context
+        mixer_.reset();
+
         if (context_) {
             cubeb_destroy(context_);
         }
@@ -66,6 +69,46 @@ namespace eka2l1::drivers {
             return nullptr;
         }
 
-        return std::make_unique<cubeb_audio_output_stream>(context_, sample_rate, channels, callback);
+        audio_mixer *mixer = create_mixer();
+
+        if (!mixer) {
+            return nullptr;
+        }
+
+        return mixer->new_stream(sample_rate, channels, callback);
+    }
+
+    audio_mixer *cubeb_audio_driver::create_mixer() {
+        const std::lock_guard<std::mutex> guard(mixer_lock_);
+
+        if (mixer_) {
+            return mixer_.get();
+        }
+
+        std::uint32_t output_rate = native_sample_rate();
+
+        if (output_rate == 0) {
+            LOG_WARN(DRIVER_AUD, "Can't get the native sample rate, mixing at 48000Hz");
+            output_rate = 48000;
+        }
+
+        // All guest streams are mixed into this one
+        auto mixer = std::make_unique<audio_mixer>(output_rate);
+        audio_mixer *mixer_ptr = mixer.get();
+
+        auto host = std::make_unique<cubeb_audio_output_stream>(context_, output_rate, audio_mixer::OUTPUT_CHANNELS,
+            [mixer_ptr](std::int16_t *output, const std::size_t frames) {
+                return mixer_ptr->mix(output, frames);
+            });
+
+        mixer->set_host_stream(std::move(host));
+        mixer_ = std::move(mixer);
+
+        return mixer_.get();
+    }
+
+    audio_mixer *cubeb_audio_driver::get_mixer() {
+        const std::lock_guard<std::mutex> guard(mixer_lock_);
+        return mixer_.get();
     }
 };
\ No newline at end of file
@@ -18,6 +18,7 @@
  */
 
 #include <common/log.h>
+#include <common/profiler.h>
 #include <drivers/audio/backend/dsp_shared.h>
 
 namespace eka2l1::drivers {
@@ -159,6 +160,7 @@ namespace eka2l1::drivers {
     }
 
     std::size_t dsp_output_stream_shared::data_callback(std::int16_t *buffer, const std::size_t frame_count) {
+        EKA2L1_PROFILE_SCOPE("Audio", "DSP output", 0x20B2AA);
         std::size_t frame_wrote = 0;
 
         while (frame_wrote < frame_count) {
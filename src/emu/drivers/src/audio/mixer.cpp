@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <drivers/audio/mixer.h>
+
+#include <common/log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace eka2l1::drivers {
+    mixer_output_stream::mixer_output_stream(audio_mixer *mixer, const std::uint32_t sample_rate, const std::uint8_t channels,
+        data_callback callback)
+        : mixer_(mixer)
+        , callback_(callback)
+        , sample_rate_(sample_rate)
+        , channels_(channels)
+        , volume_(1.0f)
+        , playing_(false)
+        , position_frac_(0.0)
+        , carry_count_(1) {
+        std::fill(&carry_[0][0], &carry_[0][0] + 4, 0.0f);
+        mixer_->attach(this);
+    }
+
+    mixer_output_stream::~mixer_output_stream() {
+        if (mixer_) {
+            // Waits for the mixing thread to be done with us
+            mixer_->detach(this);
+        }
+    }
+
+    bool mixer_output_stream::start() {
+        if (!mixer_) {
+            return false;
+        }
+
+        playing_ = true;
+        mixer_->ensure_host_started();
+
+        return true;
+    }
+
+    bool mixer_output_stream::stop() {
+        playing_ = false;
+        return true;
+    }
+
+    bool mixer_output_stream::is_playing() {
+        return playing_;
+    }
+
+    bool mixer_output_stream::set_volume(const float volume) {
+        volume_ = std::max(volume, 0.0f);
+        return true;
+    }
+
+    audio_mixer::audio_mixer(const std::uint32_t output_rate)
+        : output_rate_(output_rate)
+        , total_mix_time_us_(0.0) {
+    }
+
+    audio_mixer::~audio_mixer() {
+        {
+            // Stop the host callbacks first, so nothing is mixing anymore
+            const std::lock_guard<std::mutex> guard(host_lock_);
+            host_.reset();
+        }
+
+        const std::lock_guard<std::mutex> guard(lock_);
+
+        for (mixer_output_stream *stream : streams_) {
+            stream->mixer_ = nullptr;
+        }
+
+        streams_.clear();
+    }
+
+    void audio_mixer::attach(mixer_output_stream *stream) {
+        const std::lock_guard<std::mutex> guard(lock_);
+        streams_.push_back(stream);
+    }
+
+    void audio_mixer::detach(mixer_output_stream *stream) {
+        const std::lock_guard<std::mutex> guard(lock_);
+        streams_.erase(std::remove(streams_.begin(), streams_.end(), stream), streams_.end());
+    }
+
+    void audio_mixer::set_host_stream(std::unique_ptr<audio_output_stream> host) {
+        const std::lock_guard<std::mutex> guard(host_lock_);
+        host_ = std::move(host);
+    }
+
+    void audio_mixer::ensure_host_started() {
+        // The host stream is left running once started. Stopping it when the last guest stream stops
+        // would mean calling into the host from its own callback, and it is only silence anyway.
+        const std::lock_guard<std::mutex> guard(host_lock_);
+
+        if (host_ && !host_->is_playing()) {
+            if (!host_->start()) {
+                LOG_ERROR(DRIVER_AUD, "Unable to start the mixer's host output stream!");
+            }
+        }
+    }
+
+    std::unique_ptr<audio_output_stream> audio_mixer::new_stream(const std::uint32_t sample_rate, const std::uint8_t channels,
+        data_callback callback) {
+        if ((channels != 1) && (channels != 2)) {
+            LOG_ERROR(DRIVER_AUD, "Unsupported channel count for mixing: {}", channels);
+            return nullptr;
+        }
+
+        if ((sample_rate == 0) || !callback) {
+            return nullptr;
+        }
+
+        return std::make_unique<mixer_output_stream>(this, sample_rate, channels, callback);
+    }
+
+    bool audio_mixer::mix_stream(mixer_output_stream *stream, const std::size_t frames) {
+        const std::uint8_t channels = stream->channels_;
+        const float volume = stream->volume_.load(std::memory_order_relaxed);
+
+        float *acc = accumulator_.data();
+
+        if (stream->sample_rate_ == output_rate_) {
+            // Fast path, no conversion needed
+            stream->source_.resize(frames * channels);
+
+            const std::size_t got = std::min<std::size_t>(stream->callback_(stream->source_.data(), frames), frames);
+            const std::int16_t *source = stream->source_.data();
+
+            if (channels == 1) {
+                for (std::size_t i = 0; i < got; i++) {
+                    const float sample = static_cast<float>(source[i]) * volume;
+
+                    acc[i * 2] += sample;
+                    acc[i * 2 + 1] += sample;
+                }
+            } else {
+                for (std::size_t i = 0; i < got * 2; i++) {
+                    acc[i] += static_cast<float>(source[i]) * volume;
+                }
+            }
+
+            return (got == frames);
+        }
+
+        // Linear interpolation. Output frame i sits at position_frac + i * step in the source buffer,
+        // whose first frames are carried from the last callback.
+        const double step = static_cast<double>(stream->sample_rate_) / output_rate_;
+        const double start = stream->position_frac_;
+
+        const double last_pos = start + static_cast<double>(frames - 1) * step;
+        const double next_pos = start + static_cast<double>(frames) * step;
+
+        const std::size_t total = std::max<std::size_t>(static_cast<std::size_t>(last_pos) + 2,
+            static_cast<std::size_t>(next_pos) + 1);
+
+        const std::size_t carried = stream->carry_count_;
+        const std::size_t to_pull = total - carried;
+
+        stream->source_.resize(to_pull * channels);
+
+        std::size_t got = 0;
+
+        if (to_pull != 0) {
+            got = std::min<std::size_t>(stream->callback_(stream->source_.data(), to_pull), to_pull);
+        }
+
+        // Missing frames are silence
+        std::fill(stream->source_.begin() + got * channels, stream->source_.end(), static_cast<std::int16_t>(0));
+
+        stream->source_float_.resize(total * 2);
+
+        float *buffer = stream->source_float_.data();
+        const std::int16_t *source = stream->source_.data();
+
+        std::memcpy(buffer, stream->carry_, carried * 2 * sizeof(float));
+
+        if (channels == 1) {
+            for (std::size_t i = 0; i < to_pull; i++) {
+                buffer[(carried + i) * 2] = static_cast<float>(source[i]);
+                buffer[(carried + i) * 2 + 1] = static_cast<float>(source[i]);
+            }
+        } else {
+            for (std::size_t i = 0; i < to_pull * 2; i++) {
+                buffer[carried * 2 + i] = static_cast<float>(source[i]);
+            }
+        }
+
+        for (std::size_t i = 0; i < frames; i++) {
+            const double pos = start + static_cast<double>(i) * step;
+            const std::size_t index = static_cast<std::size_t>(pos);
+            const float t = static_cast<float>(pos - static_cast<double>(index));
+
+            const float *first = buffer + index * 2;
+            const float *second = first + 2;
+
+            acc[i * 2] += (first[0] + (second[0] - first[0]) * t) * volume;
+            acc[i * 2 + 1] += (first[1] + (second[1] - first[1]) * t) * volume;
+        }
+
+        // Carry everything from the next read position onward, which is one or two frames
+        const std::size_t next_index = static_cast<std::size_t>(next_pos);
+
+        stream->carry_count_ = static_cast<std::uint32_t>(total - next_index);
+        stream->position_frac_ = next_pos - static_cast<double>(next_index);
+
+        std::memcpy(stream->carry_, buffer + next_index * 2, stream->carry_count_ * 2 * sizeof(float));
+
+        return (got == to_pull);
+    }
+
+    std::size_t audio_mixer::mix(std::int16_t *output, const std::size_t frames) {
+        if (frames == 0) {
+            return 0;
+        }
+
+        const auto mix_start = std::chrono::steady_clock::now();
+        const std::size_t samples = frames * OUTPUT_CHANNELS;
+
+        const std::lock_guard<std::mutex> guard(lock_);
+
+        accumulator_.resize(samples);
+        std::fill(accumulator_.begin(), accumulator_.end(), 0.0f);
+
+        std::uint32_t playing_count = 0;
+
+        for (mixer_output_stream *stream : streams_) {
+            if (!stream->playing_) {
+                continue;
+            }
+
+            playing_count++;
+
+            if (!mix_stream(stream, frames)) {
+                // Same as a host stream returning less than asked: the stream is drained
+                stream->playing_ = false;
+                stats_.underrun_count_++;
+            }
+        }
+
+        const float *acc = accumulator_.data();
+
+        for (std::size_t i = 0; i < samples; i++) {
+            const float sample = std::min(std::max(acc[i], -32768.0f), 32767.0f);
+            output[i] = static_cast<std::int16_t>(sample);
+        }
+
+        const double mix_time_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - mix_start).count();
+        const double audio_time_us = static_cast<double>(frames) * 1000000.0 / output_rate_;
+
+        stats_.callback_count_++;
+        stats_.playing_stream_count_ = playing_count;
+        stats_.last_mix_time_us_ = mix_time_us;
+        stats_.max_mix_time_us_ = std::max(stats_.max_mix_time_us_, mix_time_us);
+
+        total_mix_time_us_ += mix_time_us;
+        stats_.average_mix_time_us_ = total_mix_time_us_ / static_cast<double>(stats_.callback_count_);
+
+        if (mix_time_us > audio_time_us) {
+            stats_.overtime_count_++;
+        }
+
+        return frames;
+    }
+
+    audio_mixer_statistics audio_mixer::get_statistics() {
+        const std::lock_guard<std::mutex> guard(lock_);
+
+        audio_mixer_statistics result = stats_;
+        result.stream_count_ = static_cast<std::uint32_t>(streams_.size());
+
+        return result;
+    }
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <drivers/command_arena.h>
+
+#include <algorithm>
+
+namespace eka2l1::drivers {
+    static constexpr std::size_t PAYLOAD_RING_ALIGN = 16;
+
+    command_arena::command_arena()
+        : current_(0)
+        , cursor_(0) {
+    }
+
+    void *command_arena::allocate(const std::size_t size, const std::size_t align) {
+        while (current_ < chunks_.size()) {
+            chunk &current_chunk = chunks_[current_];
+            const std::size_t start = (cursor_ + align - 1) & ~(align - 1);
+
+            if (start + size <= current_chunk.size_) {
+                cursor_ = start + size;
+                return current_chunk.data_.get() + start;
+            }
+
+            current_++;
+            cursor_ = 0;
+        }
+
+        // Chunk base is aligned by new, so allocating from offset 0 is always aligned
+        chunk new_chunk;
+        new_chunk.size_ = std::max(DEFAULT_CHUNK_SIZE, size);
+        new_chunk.data_ = std::make_unique<std::uint8_t[]>(new_chunk.size_);
+
+        chunks_.push_back(std::move(new_chunk));
+
+        current_ = chunks_.size() - 1;
+        cursor_ = size;
+
+        return chunks_.back().data_.get();
+    }
+
+    void command_arena::reset() {
+        // Oversized chunks were made for a single big payload. Don't let the arena hold onto them.
+        chunks_.erase(std::remove_if(chunks_.begin(), chunks_.end(), [](const chunk &c) {
+            return c.size_ > DEFAULT_CHUNK_SIZE;
+        }),
+            chunks_.end());
+
+        current_ = 0;
+        cursor_ = 0;
+    }
+
+    std::size_t command_arena::capacity() const {
+        std::size_t total = 0;
+
+        for (const chunk &c : chunks_) {
+            total += c.size_;
+        }
+
+        return total;
+    }
+
+    payload_ring::payload_ring(const std::size_t capacity)
+        : data_(std::make_unique<std::uint8_t[]>(capacity))
+        , capacity_(capacity)
+        , head_(0)
+        , tail_(0)
+        , used_(0)
+        , first_ticket_(0) {
+    }
+
+    std::uint8_t *payload_ring::allocate(const std::size_t size, std::uint64_t &ticket) {
+        const std::size_t aligned_size = (size + PAYLOAD_RING_ALIGN - 1) & ~(PAYLOAD_RING_ALIGN - 1);
+        const std::lock_guard<std::mutex> guard(lock_);
+
+        if (allocations_.empty()) {
+            head_ = 0;
+            tail_ = 0;
+        }
+
+        std::size_t start = head_;
+        std::size_t wasted = 0;
+
+        if (allocations_.empty() || (head_ > tail_)) {
+            // Free space is from head to the end, then from the beginning to tail
+            if (capacity_ - head_ < aligned_size) {
+                if (allocations_.empty() || (tail_ < aligned_size)) {
+                    return nullptr;
+                }
+
+                // Skip the end of the ring. The gap is reclaimed together with this allocation.
+                wasted = capacity_ - head_;
+                start = 0;
+            }
+        } else if (tail_ - head_ < aligned_size) {
+            return nullptr;
+        }
+
+        head_ = start + aligned_size;
+        used_ += wasted + aligned_size;
+
+        ticket = first_ticket_ + allocations_.size();
+        allocations_.push_back({ head_, wasted + aligned_size, false });
+
+        return data_.get() + start;
+    }
+
+    void payload_ring::release(const std::uint64_t ticket) {
+        const std::lock_guard<std::mutex> guard(lock_);
+
+        if ((ticket < first_ticket_) || (ticket >= first_ticket_ + allocations_.size())) {
+            return;
+        }
+
+        allocations_[ticket - first_ticket_].released_ = true;
+
+        while (!allocations_.empty() && allocations_.front().released_) {
+            tail_ = allocations_.front().end_;
+            used_ -= allocations_.front().size_;
+
+            allocations_.pop_front();
+            first_ticket_++;
+        }
+    }
+
+    std::size_t payload_ring::used() {
+        const std::lock_guard<std::mutex> guard(lock_);
+        return used_;
+    }
+}
@@ -162,12 +162,29 @@ namespace eka2l1::drivers {
         : graphics_driver(gr_api)
         , binding(nullptr)
         , brush_color({ 255.0f, 255.0f, 255.0f, 255.0f })
-        , current_fb_height(0) {
+        , current_fb_height(0)
+        , last_frame_draw_calls(0)
+        , last_frame_upload_bytes(0) {
     }
 
     shared_graphics_driver::~shared_graphics_driver() {
     }
 
+    void shared_graphics_driver::end_frame_stats() {
+        last_frame_draw_calls = frame_stats.draw_calls_;
+        last_frame_upload_bytes = frame_stats.upload_bytes_;
+
+        frame_stats = graphics_frame_stats{};
+    }
+
+    graphics_frame_stats shared_graphics_driver::get_last_frame_stats() const {
+        graphics_frame_stats stats;
+        stats.draw_calls_ = last_frame_draw_calls;
+        stats.upload_bytes_ = last_frame_upload_bytes;
+
+        return stats;
+    }
+
 #define HANDLE_BITMAP (1ULL << 32)
 
     bitmap *shared_graphics_driver::get_bitmap(const drivers::handle h) {
@@ -288,8 +305,7 @@ namespace eka2l1::drivers {
         helper.pop(pixels_per_line);
 
         update_bitmap(handle, size, offset, dim, data, pixels_per_line);
-
-        delete data;
+        frame_stats.upload_bytes_ += size;
     }
 
     void shared_graphics_driver::create_bitmap(command_helper &helper) {
@@ -539,8 +555,6 @@ namespace eka2l1::drivers {
         }
 
         shobj->set(this, binding, var_type, data);
-
-        delete data;
     }
 
     void shared_graphics_driver::set_swizzle(command_helper &helper) {
@@ -633,8 +647,7 @@ namespace eka2l1::drivers {
         }
 
         bufobj->update_data(this, data, offset, size);
-
-        delete data;
+        frame_stats.upload_bytes_ += size;
     }
 
     void shared_graphics_driver::attach_descriptors(drivers::handle h, const int stride, const bool instance_move,
@@ -662,8 +675,6 @@ namespace eka2l1::drivers {
         helper.pop(descriptor_count);
 
         attach_descriptors(h, stride, instance_move, descriptors, descriptor_count);
-
-        delete descriptors;
     }
 
     void shared_graphics_driver::destroy_object(command_helper &helper) {
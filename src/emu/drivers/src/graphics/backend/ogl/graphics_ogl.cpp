@@ -20,6 +20,11 @@
 #include <common/algorithm.h>
 #include <common/log.h>
 #include <common/platform.h>
+#include <common/profiler.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
@@ -32,6 +37,10 @@
 namespace eka2l1::drivers {
     ogl_graphics_driver::ogl_graphics_driver()
         : shared_graphics_driver(graphic_api::opengl)
+        , batch_vao(0)
+        , batch_vbo(0)
+        , batch_ibo(0)
+        , batch_stream_offset(0)
         , should_stop(false)
         , is_gles(false) {
         init_graphics_library(eka2l1::drivers::graphic_api::opengl);
@@ -79,53 +88,52 @@ namespace eka2l1::drivers {
     static constexpr const char *fill_v_path = "resources//fill.vert";
     static constexpr const char *fill_f_path = "resources//fill.frag";
 
+    static constexpr std::size_t MAX_BATCH_QUADS = 4096;
+    static constexpr std::size_t BATCH_STREAM_BUFFER_SIZE = 4 * 1024 * 1024;
+
     void ogl_graphics_driver::do_init() {
         sprite_program = std::make_unique<ogl_shader>(sprite_norm_v_path, sprite_norm_f_path);
         mask_program = std::make_unique<ogl_shader>(sprite_norm_v_path, sprite_mask_f_path);
         fill_program = std::make_unique<ogl_shader>(fill_v_path, fill_f_path);
 
-        static GLushort indices[] = {
-            0, 1, 2,
-            0, 3, 1
-        };
+        // Every quad uses the same pattern, so the index buffer never changes
+        std::vector<GLushort> indices(MAX_BATCH_QUADS * 6);
 
-        // Make sprite VAO and VBO
-        glGenVertexArrays(1, &sprite_vao);
-        glGenBuffers(1, &sprite_vbo);
-        glBindVertexArray(sprite_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, sprite_vbo);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid *)0);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid *)(2 * sizeof(GLfloat)));
-        glBindVertexArray(0);
+        for (std::size_t i = 0; i < MAX_BATCH_QUADS; i++) {
+            const GLushort base = static_cast<GLushort>(i * 4);
+
+            indices[i * 6] = base;
+            indices[i * 6 + 1] = base + 1;
+            indices[i * 6 + 2] = base + 2;
+            indices[i * 6 + 3] = base;
+            indices[i * 6 + 4] = base + 3;
+            indices[i * 6 + 5] = base + 1;
+        }
 
-        // Make fill VAO and VBO
-        glGenVertexArrays(1, &fill_vao);
-        glGenBuffers(1, &fill_vbo);
-        glBindVertexArray(fill_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, fill_vbo);
+        // Make batch VAO, streaming VBO and IBO
+        glGenVertexArrays(1, &batch_vao);
+        glGenBuffers(1, &batch_vbo);
+        glGenBuffers(1, &batch_ibo);
+
+        glBindVertexArray(batch_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, batch_vbo);
+        glBufferData(GL_ARRAY_BUFFER, BATCH_STREAM_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (GLvoid *)0);
+        glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(2);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch_ibo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
         glBindVertexArray(0);
 
-        glGenBuffers(1, &sprite_ibo);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sprite_ibo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        batch_vertices.reserve(MAX_BATCH_QUADS * 4);
+        batch_stream_offset = 0;
 
-        color_loc = sprite_program->get_uniform_location("u_color").value_or(-1);
         proj_loc = sprite_program->get_uniform_location("u_proj").value_or(-1);
-        model_loc = sprite_program->get_uniform_location("u_model").value_or(-1);
         flip_loc = sprite_program->get_uniform_location("u_flip").value_or(-1);
 
-        color_loc_fill = fill_program->get_uniform_location("u_color").value_or(-1);
         proj_loc_fill = fill_program->get_uniform_location("u_proj").value_or(-1);
-        model_loc_fill = fill_program->get_uniform_location("u_model").value_or(-1);
 
-        color_loc_mask = mask_program->get_uniform_location("u_color").value_or(-1);
         proj_loc_mask = mask_program->get_uniform_location("u_proj").value_or(-1);
-        model_loc_mask = mask_program->get_uniform_location("u_model").value_or(-1);
         invert_loc_mask = mask_program->get_uniform_location("u_invert").value_or(-1);
         source_loc_mask = mask_program->get_uniform_location("u_tex").value_or(-1);
         mask_loc_mask = mask_program->get_uniform_location("u_mask").value_or(-1);
@@ -136,6 +144,110 @@ namespace eka2l1::drivers {
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
+    void ogl_graphics_driver::queue_batch_quad(const ogl_batch_state &state, const ogl_batch_vertex *verts) {
+        if (!batch_vertices.empty() && ((state != batch_state) || (batch_vertices.size() >= MAX_BATCH_QUADS * 4))) {
+            flush_batch();
+        }
+
+        batch_state = state;
+        batch_vertices.insert(batch_vertices.end(), verts, verts + 4);
+    }
+
+    void ogl_graphics_driver::flush_batch() {
+        if (batch_vertices.empty()) {
+            return;
+        }
+
+        const std::size_t upload_size = batch_vertices.size() * sizeof(ogl_batch_vertex);
+
+        glBindVertexArray(batch_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, batch_vbo);
+
+        if (batch_stream_offset + upload_size > BATCH_STREAM_BUFFER_SIZE) {
+            // Orphan the storage. Draws still using the old one keep it alive, and we don't have to wait for them.
+            glBufferData(GL_ARRAY_BUFFER, BATCH_STREAM_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+            batch_stream_offset = 0;
+        }
+
+        // Nothing in flight touches this range, so the map does not need to synchronize
+        void *dest = glMapBufferRange(GL_ARRAY_BUFFER, batch_stream_offset, upload_size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+        if (dest) {
+            std::memcpy(dest, batch_vertices.data(), upload_size);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        } else {
+            glBufferSubData(GL_ARRAY_BUFFER, batch_stream_offset, upload_size, batch_vertices.data());
+        }
+
+        const GLsizei stride = static_cast<GLsizei>(sizeof(ogl_batch_vertex));
+        const std::uint64_t base = batch_stream_offset;
+
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid *>(base + offsetof(ogl_batch_vertex, pos_)));
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid *>(base + offsetof(ogl_batch_vertex, coord_)));
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid *>(base + offsetof(ogl_batch_vertex, color_)));
+
+        switch (batch_state.program_) {
+        case ogl_batch_program::fill:
+            fill_program->use(this);
+            glUniformMatrix4fv(proj_loc_fill, 1, false, glm::value_ptr(projection_matrix));
+
+            break;
+
+        case ogl_batch_program::sprite:
+            sprite_program->use(this);
+            glUniformMatrix4fv(proj_loc, 1, false, glm::value_ptr(projection_matrix));
+            glUniform1f(flip_loc, batch_state.flip_);
+
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, batch_state.texture_);
+
+            break;
+
+        case ogl_batch_program::mask:
+            mask_program->use(this);
+            glUniformMatrix4fv(proj_loc_mask, 1, false, glm::value_ptr(projection_matrix));
+            glUniform1f(flip_loc_mask, batch_state.flip_);
+            glUniform1f(invert_loc_mask, batch_state.invert_);
+            glUniform1i(source_loc_mask, 0);
+            glUniform1i(mask_loc_mask, 1);
+
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, batch_state.texture_);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, batch_state.mask_);
+
+            break;
+
+        default:
+            break;
+        }
+
+        if (batch_state.program_ != ogl_batch_program::fill) {
+            // For unknown reason my intel driver go out for an all out attack and garbage the filter...
+            // so i have to set it here...
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(batch_vertices.size() / 4 * 6), GL_UNSIGNED_SHORT, 0);
+        glBindVertexArray(0);
+
+        frame_stats.draw_calls_++;
+        frame_stats.upload_bytes_ += upload_size;
+
+        batch_stream_offset += upload_size;
+        batch_vertices.clear();
+    }
+
+    // Corners of the unit quad, in the order the index pattern expects: bottom left, top right, top left, bottom right
+    static constexpr float QUAD_CORNERS[4][2] = {
+        { 0.0f, 1.0f },
+        { 1.0f, 0.0f },
+        { 0.0f, 0.0f },
+        { 1.0f, 1.0f }
+    };
+
     void ogl_graphics_driver::draw_rectangle(command_helper &helper) {
         if (!fill_program) {
             do_init();
@@ -144,41 +256,21 @@ namespace eka2l1::drivers {
         eka2l1::rect fill_rect;
         helper.pop(fill_rect);
 
-        fill_program->use(this);
-
-        // Build model matrix
-        glm::mat4 model_matrix = glm::identity<glm::mat4>();
-        model_matrix = glm::translate(model_matrix, { fill_rect.top.x, fill_rect.top.y, 0.0f });
-        model_matrix = glm::scale(model_matrix, { fill_rect.size.x, fill_rect.size.y, 0.0f });
-
-        glUniformMatrix4fv(model_loc_fill, 1, false, glm::value_ptr(model_matrix));
-        glUniformMatrix4fv(proj_loc_fill, 1, false, glm::value_ptr(projection_matrix));
-
-        // Supply brush
-        glUniform4fv(color_loc_fill, 1, brush_color.elements.data());
-
-        static GLfloat fill_verts_default[] = {
-            0.0f,
-            1.0f,
-            1.0f,
-            0.0f,
-            0.0f,
-            0.0f,
-            1.0f,
-            1.0f,
-        };
-
-        glBindVertexArray(fill_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, fill_vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(fill_verts_default), nullptr, GL_STATIC_DRAW);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(fill_verts_default), fill_verts_default, GL_STATIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (GLvoid *)0);
+        ogl_batch_vertex verts[4];
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sprite_ibo);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
+        for (int i = 0; i < 4; i++) {
+            verts[i].pos_[0] = fill_rect.top.x + QUAD_CORNERS[i][0] * fill_rect.size.x;
+            verts[i].pos_[1] = fill_rect.top.y + QUAD_CORNERS[i][1] * fill_rect.size.y;
+            verts[i].coord_[0] = QUAD_CORNERS[i][0];
+            verts[i].coord_[1] = QUAD_CORNERS[i][1];
 
-        glBindVertexArray(0);
+            std::copy(brush_color.elements.begin(), brush_color.elements.end(), verts[i].color_);
+        }
+
+        ogl_batch_state state;
+        state.program_ = ogl_batch_program::fill;
+
+        queue_batch_quad(state, verts);
     }
 
     void ogl_graphics_driver::draw_bitmap(command_helper &helper) {
@@ -214,12 +306,6 @@ namespace eka2l1::drivers {
         eka2l1::rect dest_rect;
         helper.pop(dest_rect);
 
-        if (mask_bmp) {
-            mask_program->use(this);
-        } else {
-            sprite_program->use(this);
-        }
-
         // Build texcoords
         eka2l1::rect source_rect;
         helper.pop(source_rect);
@@ -230,98 +316,26 @@ namespace eka2l1::drivers {
         float rotation = 0.0f;
         helper.pop(rotation);
 
-        struct sprite_vertex {
-            float top[2];
-            float coord[2];
-        } verts[4];
-
-        static GLfloat verts_default[] = {
-            0.0f,
-            1.0f,
-            0.0f,
-            1.0f,
-            1.0f,
-            0.0f,
-            1.0f,
-            0.0f,
-            0.0f,
-            0.0f,
-            0.0f,
-            0.0f,
-            1.0f,
-            1.0f,
-            1.0f,
-            1.0f,
-        };
-
-        void *vert_pointer = verts_default;
-
-        if (!source_rect.empty()) {
-            const float texel_width = 1.0f / bmp->tex->get_size().x;
-            const float texel_height = 1.0f / bmp->tex->get_size().y;
-
-            // Bottom left
-            verts[0].top[0] = 0.0f;
-            verts[0].top[1] = 1.0f;
-
-            verts[0].coord[0] = source_rect.top.x * texel_width;
-            verts[0].coord[1] = (source_rect.top.y + source_rect.size.y) * texel_height;
-
-            // Top right
-            verts[1].top[0] = 1.0f;
-            verts[1].top[1] = 0.0f;
-
-            verts[1].coord[0] = (source_rect.top.x + source_rect.size.x) * texel_width;
-            verts[1].coord[1] = source_rect.top.y * texel_height;
-
-            // Top left
-            verts[2].top[0] = 0.0f;
-            verts[2].top[1] = 0.0f;
-
-            verts[2].coord[0] = source_rect.top.x * texel_width;
-            verts[2].coord[1] = source_rect.top.y * texel_height;
-
-            // Bottom right
-            verts[3].top[0] = 1.0f;
-            verts[3].top[1] = 1.0f;
-
-            verts[3].coord[0] = (source_rect.top.x + source_rect.size.x) * texel_width;
-            verts[3].coord[1] = (source_rect.top.y + source_rect.size.y) * texel_height;
-
-            vert_pointer = verts;
-        }
+        std::uint32_t flags = 0;
+        helper.pop(flags);
 
-        glBindVertexArray(sprite_vao);
-        glBindBuffer(GL_ARRAY_BUFFER, sprite_vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(verts), nullptr, GL_STATIC_DRAW);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(verts), vert_pointer, GL_STATIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid *)0);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (GLvoid *)(2 * sizeof(GLfloat)));
+        ogl_batch_vertex verts[4];
 
-        if (mask_bmp) {
-            glUniform1i(source_loc_mask, 0);
-            glUniform1i(mask_loc_mask, 1);
+        for (int i = 0; i < 4; i++) {
+            verts[i].coord_[0] = QUAD_CORNERS[i][0];
+            verts[i].coord_[1] = QUAD_CORNERS[i][1];
         }
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(bmp->tex->texture_handle()));
+        if (!source_rect.empty()) {
+            const float texel_width = 1.0f / bmp->tex->get_size().x;
+            const float texel_height = 1.0f / bmp->tex->get_size().y;
 
-        if (mask_bmp) {
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(mask_bmp->tex->texture_handle()));
+            for (int i = 0; i < 4; i++) {
+                verts[i].coord_[0] = (source_rect.top.x + QUAD_CORNERS[i][0] * source_rect.size.x) * texel_width;
+                verts[i].coord_[1] = (source_rect.top.y + QUAD_CORNERS[i][1] * source_rect.size.y) * texel_height;
+            }
         }
 
-        // For unknown reason my intel driver go out for an all out attack and garbage the filter...
-        // so i have to set it here...
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        // Build model matrix
-        glm::mat4 model_matrix = glm::identity<glm::mat4>();
-        model_matrix = glm::translate(model_matrix, { dest_rect.top.x, dest_rect.top.y, 0.0f });
-
         if (source_rect.size.x == 0) {
             source_rect.size.x = bmp->tex->get_size().x;
         }
@@ -338,37 +352,35 @@ namespace eka2l1::drivers {
             dest_rect.size.y = source_rect.size.y;
         }
 
-        model_matrix = glm::translate(model_matrix, glm::vec3(static_cast<float>(origin.x), static_cast<float>(origin.y), 0.0f)); 
-        model_matrix = glm::rotate(model_matrix, glm::radians(rotation), glm::vec3(0.0f, 0.0f, 1.0f));
-        model_matrix = glm::translate(model_matrix, glm::vec3(static_cast<float>(-origin.x), static_cast<float>(-origin.y), 0.0f));
+        // Transform on CPU: scale to destination size, then rotate around the origin, then move to the destination
+        const float rotation_rad = rotation * 3.14159265358979f / 180.0f;
+        const float rotation_cos = std::cos(rotation_rad);
+        const float rotation_sin = std::sin(rotation_rad);
 
-        model_matrix = glm::scale(model_matrix, glm::vec3(dest_rect.size.x, dest_rect.size.y, 1.0f));
+        const GLfloat white[] = { 255.0f, 255.0f, 255.0f, 255.0f };
+        const GLfloat *color = (flags & bitmap_draw_flag_use_brush) ? brush_color.elements.data() : white;
 
-        glUniformMatrix4fv((mask_bmp ? model_loc_mask : model_loc), 1, false, glm::value_ptr(model_matrix));
-        glUniformMatrix4fv((mask_bmp ? proj_loc_mask : proj_loc), 1, false, glm::value_ptr(projection_matrix));
+        for (int i = 0; i < 4; i++) {
+            const float x = QUAD_CORNERS[i][0] * dest_rect.size.x - origin.x;
+            const float y = QUAD_CORNERS[i][1] * dest_rect.size.y - origin.y;
 
-        // Supply brush
-        std::uint32_t flags = 0;
-        helper.pop(flags);
+            verts[i].pos_[0] = dest_rect.top.x + origin.x + x * rotation_cos - y * rotation_sin;
+            verts[i].pos_[1] = dest_rect.top.y + origin.y + x * rotation_sin + y * rotation_cos;
 
-        const GLfloat color[] = { 255.0f, 255.0f, 255.0f, 255.0f };
-
-        if (flags & bitmap_draw_flag_use_brush) {
-            glUniform4fv((mask_bmp ? color_loc_mask : color_loc), 1, brush_color.elements.data());
-        } else {
-            glUniform4fv((mask_bmp ? color_loc_mask : color_loc), 1, color);
+            std::copy(color, color + 4, verts[i].color_);
         }
 
-        glUniform1f((mask_bmp ? flip_loc_mask : flip_loc), (flags & bitmap_draw_flag_no_flip) ? 1.0f : -1.0f);
+        ogl_batch_state state;
+        state.program_ = mask_bmp ? ogl_batch_program::mask : ogl_batch_program::sprite;
+        state.texture_ = static_cast<GLuint>(bmp->tex->texture_handle());
+        state.flip_ = (flags & bitmap_draw_flag_no_flip) ? 1.0f : -1.0f;
 
         if (mask_bmp) {
-            glUniform1f(invert_loc_mask, (flags & bitmap_draw_flag_invert_mask) ? 1.0f : 0.0f);
+            state.mask_ = static_cast<GLuint>(mask_bmp->tex->texture_handle());
+            state.invert_ = (flags & bitmap_draw_flag_invert_mask) ? 1.0f : 0.0f;
         }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sprite_ibo);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, 0);
-
-        glBindVertexArray(0);
+        queue_batch_quad(state, verts);
     }
 
     void ogl_graphics_driver::set_clipping(command_helper &helper) {
@@ -422,6 +434,8 @@ namespace eka2l1::drivers {
         } else {
             glDrawElementsBaseVertex(prim_mode_to_gl_enum(prim_mode), count, data_format_to_gl_enum(val_type), reinterpret_cast<GLvoid *>(index_off_64), vert_off);
         }
+
+        frame_stats.draw_calls_++;
     }
 
     void ogl_graphics_driver::set_viewport(const eka2l1::rect &viewport) {
@@ -760,7 +774,7 @@ namespace eka2l1::drivers {
     }
 
     std::unique_ptr<graphics_command_list> ogl_graphics_driver::new_command_list() {
-        return std::make_unique<server_graphics_command_list>();
+        return std::make_unique<server_graphics_command_list>(list_pool.acquire());
     }
 
     std::unique_ptr<graphics_command_list_builder> ogl_graphics_driver::new_command_builder(graphics_command_list *list) {
@@ -768,17 +782,25 @@ namespace eka2l1::drivers {
     }
 
     void ogl_graphics_driver::submit_command_list(graphics_command_list &command_list) {
-        list_queue.push(static_cast<server_graphics_command_list &>(command_list));
+        list_queue.push(std::move(static_cast<server_graphics_command_list &>(command_list)));
     }
 
     void ogl_graphics_driver::display(command_helper &helper) {
         disp_hook_();
+        end_frame_stats();
         helper.finish(this, 0);
     }
 
     void ogl_graphics_driver::dispatch(command *cmd) {
+        EKA2L1_PROFILE_SCOPE("Graphics", "Dispatch", 0xDA70D6);
         command_helper helper(cmd);
 
+        // Consecutive 2D draws are batched. Anything else may change state the batch depends on.
+        if ((cmd->opcode_ != graphics_driver_draw_bitmap) && (cmd->opcode_ != graphics_driver_draw_rectangle)
+            && (cmd->opcode_ != graphics_driver_set_brush_color)) {
+            flush_batch();
+        }
+
         switch (cmd->opcode_) {
         case graphics_driver_draw_bitmap: {
             draw_bitmap(helper);
@@ -881,18 +903,14 @@ namespace eka2l1::drivers {
                 break;
             }
 
-            command *cmd = list->list_.first_;
-            command *next = nullptr;
+            for (command &cmd : list->list_.commands_) {
+                dispatch(&cmd);
+            }
 
-            while (cmd) {
-                dispatch(cmd);
-                next = cmd->next_;
+            flush_batch();
 
-                // TODO: If any command list requires not rebuilding the buffer, dont delete the command.
-                // For now, not likely
-                delete cmd;
-                cmd = next;
-            }
+            // Done with this frame: payloads are freed here, and the storage goes back for the next list
+            list_pool.recycle(list->list_);
         }
     }
 
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <drivers/graphics/backend/software/buffer_software.h>
+
+#include <cstring>
+
+namespace eka2l1::drivers {
+    software_buffer::software_buffer()
+        : hint_(buffer_hint::none) {
+    }
+
+    void software_buffer::bind(graphics_driver *driver) {
+    }
+
+    void software_buffer::unbind(graphics_driver *driver) {
+    }
+
+    void software_buffer::attach_descriptors(graphics_driver *driver, const int stride, const bool instance_move,
+        const attribute_descriptor *descriptors, const int total) {
+    }
+
+    bool software_buffer::create(graphics_driver *driver, const std::size_t initial_size, const buffer_hint hint, const buffer_upload_hint use_hint) {
+        hint_ = hint;
+        data_.resize(initial_size);
+
+        return true;
+    }
+
+    void software_buffer::update_data(graphics_driver *driver, const void *data, const std::size_t offset, const std::size_t size) {
+        if (offset + size > data_.size()) {
+            data_.resize(offset + size);
+        }
+
+        std::memcpy(data_.data() + offset, data, size);
+    }
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <drivers/graphics/backend/software/fb_software.h>
+#include <drivers/graphics/backend/software/graphics_software.h>
+#include <drivers/graphics/backend/software/texture_software.h>
+
+#include <common/log.h>
+
+#include <algorithm>
+
+namespace eka2l1::drivers {
+    software_framebuffer::software_framebuffer(software_graphics_driver *driver, std::initializer_list<texture *> color_buffer_list,
+        texture *depth_and_stencil_buffer)
+        : framebuffer(color_buffer_list, depth_and_stencil_buffer)
+        , driver_(driver)
+        , last_read_(nullptr)
+        , last_draw_(nullptr)
+        , bound_(false)
+        , read_attachment_(0)
+        , draw_attachment_(0) {
+    }
+
+    software_framebuffer::~software_framebuffer() {
+        // Do not leave the driver drawing into freed textures
+        if (driver_->read_fb == this) {
+            driver_->read_fb = nullptr;
+        }
+
+        if (driver_->draw_fb == this) {
+            driver_->draw_fb = nullptr;
+        }
+    }
+
+    void software_framebuffer::bind(graphics_driver *driver, const framebuffer_bind_type type_bind) {
+        last_read_ = driver_->read_fb;
+        last_draw_ = driver_->draw_fb;
+        bound_ = true;
+
+        if (type_bind & framebuffer_bind_read) {
+            driver_->read_fb = this;
+        }
+
+        if (type_bind & framebuffer_bind_draw) {
+            driver_->draw_fb = this;
+        }
+    }
+
+    void software_framebuffer::unbind(graphics_driver *driver) {
+        if (!bound_) {
+            return;
+        }
+
+        driver_->read_fb = last_read_;
+        driver_->draw_fb = last_draw_;
+
+        bound_ = false;
+    }
+
+    std::int32_t software_framebuffer::set_color_buffer(texture *tex, const std::int32_t position) {
+        std::int32_t attachment_id = position;
+
+        if (position == -1) {
+            auto free_slot = std::find(color_buffers.begin(), color_buffers.end(), nullptr);
+            attachment_id = static_cast<std::int32_t>(std::distance(color_buffers.begin(), free_slot));
+        }
+
+        if (attachment_id >= static_cast<std::int32_t>(color_buffers.size())) {
+            color_buffers.resize(attachment_id + 1, nullptr);
+        }
+
+        color_buffers[attachment_id] = tex;
+        return attachment_id;
+    }
+
+    bool software_framebuffer::set_depth_stencil_buffer(texture *tex) {
+        depth_and_stencil_buffer = tex;
+        return true;
+    }
+
+    bool software_framebuffer::set_draw_buffer(const std::int32_t attachment_id) {
+        if (!is_attachment_id_valid(attachment_id)) {
+            return false;
+        }
+
+        draw_attachment_ = attachment_id;
+        return true;
+    }
+
+    bool software_framebuffer::set_read_buffer(const std::int32_t attachment_id) {
+        if (!is_attachment_id_valid(attachment_id)) {
+            return false;
+        }
+
+        read_attachment_ = attachment_id;
+        return true;
+    }
+
+    bool software_framebuffer::remove_color_buffer(const std::int32_t position) {
+        if (!is_attachment_id_valid(position)) {
+            return false;
+        }
+
+        color_buffers[position] = nullptr;
+        return true;
+    }
+
+    software_texture *software_framebuffer::get_color_buffer(const bool for_read) {
+        const std::int32_t attachment_id = for_read ? read_attachment_ : draw_attachment_;
+
+        if (!is_attachment_id_valid(attachment_id)) {
+            return nullptr;
+        }
+
+        return static_cast<software_texture *>(color_buffers[attachment_id]);
+    }
+
+    software_texture *software_framebuffer::get_depth_stencil_buffer() {
+        return static_cast<software_texture *>(depth_and_stencil_buffer);
+    }
+
+    template <typename T>
+    static void blit_plane(const T *source, const eka2l1::vec2 &source_size, const eka2l1::rect &source_rect, T *dest,
+        const eka2l1::vec2 &dest_size, const eka2l1::rect &dest_rect) {
+        for (int y = 0; y < dest_rect.size.y; y++) {
+            const int dy = dest_rect.top.y + y;
+
+            if ((dy < 0) || (dy >= dest_size.y)) {
+                continue;
+            }
+
+            // Nearest, sampled at the center of each destination pixel
+            const int sy = source_rect.top.y + static_cast<int>((y + 0.5f) * source_rect.size.y / dest_rect.size.y);
+
+            if ((sy < 0) || (sy >= source_size.y)) {
+                continue;
+            }
+
+            for (int x = 0; x < dest_rect.size.x; x++) {
+                const int dx = dest_rect.top.x + x;
+                const int sx = source_rect.top.x + static_cast<int>((x + 0.5f) * source_rect.size.x / dest_rect.size.x);
+
+                if ((dx < 0) || (dx >= dest_size.x) || (sx < 0) || (sx >= source_size.x)) {
+                    continue;
+                }
+
+                dest[static_cast<std::size_t>(dy) * dest_size.x + dx] = source[static_cast<std::size_t>(sy) * source_size.x + sx];
+            }
+        }
+    }
+
+    bool software_framebuffer::blit(const eka2l1::rect &source_rect, const eka2l1::rect &dest_rect, const std::uint32_t flags,
+        const filter_option copy_filter) {
+        if ((source_rect.size.x <= 0) || (source_rect.size.y <= 0) || (dest_rect.size.x <= 0) || (dest_rect.size.y <= 0)) {
+            return false;
+        }
+
+        // The filter is ignored, copies are always nearest
+        if (flags & draw_buffer_bit_color_buffer) {
+            software_texture *source = get_color_buffer(true);
+            software_texture *dest = driver_->get_target_color();
+
+            if (!source || !dest) {
+                LOG_ERROR(DRIVER_GRAPHICS, "Blit source or destination has no color buffer!");
+                return false;
+            }
+
+            blit_plane(source->color_data(), source->get_size(), source_rect, dest->color_data(), dest->get_size(), dest_rect);
+        }
+
+        if (flags & draw_buffer_bit_stencil_buffer) {
+            software_texture *source = get_depth_stencil_buffer();
+            software_texture *dest = driver_->get_target_depth_stencil();
+
+            if (source && dest) {
+                blit_plane(source->stencil_data(), source->get_size(), source_rect, dest->stencil_data(), dest->get_size(), dest_rect);
+            }
+        }
+
+        return true;
+    }
+}
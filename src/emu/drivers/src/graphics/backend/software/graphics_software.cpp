@@ -0,0 +1,882 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <drivers/graphics/backend/software/graphics_software.h>
+
+#include <common/algorithm.h>
+#include <common/log.h>
+#include <common/profiler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace eka2l1::drivers {
+    software_graphics_driver::software_graphics_driver()
+        : shared_graphics_driver(graphic_api::software)
+        , should_stop(false)
+        , read_fb(nullptr)
+        , draw_fb(nullptr)
+        , clipping(false)
+        , present_count(0)
+        , warned_indexed_draw(false) {
+        list_queue.max_pending_count_ = 128;
+
+        swapchain = std::make_unique<software_texture>();
+        swapchain->create(this, 2, 0, eka2l1::vec3(0, 0, 0), texture_format::rgba, texture_format::rgba, texture_data_type::ubyte,
+            nullptr);
+    }
+
+    software_graphics_driver::~software_graphics_driver() {
+        // Bitmaps own framebuffers pointing back to us, free them while we are still whole
+        bmp_textures.clear();
+        graphic_objects.clear();
+    }
+
+    software_texture *software_graphics_driver::get_target_color() {
+        if (draw_fb) {
+            return draw_fb->get_color_buffer();
+        }
+
+        return swapchain.get();
+    }
+
+    software_texture *software_graphics_driver::get_target_depth_stencil() {
+        if (draw_fb) {
+            return draw_fb->get_depth_stencil_buffer();
+        }
+
+        // The presented swapchain has no stencil
+        return nullptr;
+    }
+
+    void software_graphics_driver::bind_swapchain_framebuf() {
+        read_fb = nullptr;
+        draw_fb = nullptr;
+    }
+
+    void software_graphics_driver::resize_swapchain() {
+        // Frontends set the size every frame, keep the content if nothing changed
+        if (swapchain->get_size() != swapchain_size) {
+            swapchain->change_size(eka2l1::vec3(swapchain_size.x, swapchain_size.y, 0));
+            swapchain->tex(this);
+        }
+
+        if (!binding) {
+            viewport = eka2l1::rect(eka2l1::vec2(0, 0), swapchain_size);
+        }
+    }
+
+    void software_graphics_driver::set_viewport(const eka2l1::rect &viewport) {
+        this->viewport = eka2l1::rect(eka2l1::vec2(viewport.top.x, current_fb_height - (viewport.top.y + viewport.size.y)),
+            viewport.size);
+    }
+
+    void software_graphics_driver::to_framebuffer_coords(const float x, const float y, const float flip, float *result) {
+        // Same path a vertex takes on the GPU: projection, the flip done by the vertex shaders, then viewport
+        const float *proj = glm::value_ptr(projection_matrix);
+
+        const float clip_x = proj[0] * x + proj[4] * y + proj[12];
+        const float clip_y = (proj[1] * x + proj[5] * y + proj[13]) * flip;
+
+        result[0] = viewport.top.x + (clip_x + 1.0f) * 0.5f * viewport.size.x;
+        result[1] = viewport.top.y + (clip_y + 1.0f) * 0.5f * viewport.size.y;
+    }
+
+    static std::uint32_t get_blend_factor(const blend_factor factor, const std::uint32_t source_alpha, const std::uint32_t dest_alpha) {
+        switch (factor) {
+        case blend_factor::one:
+            return 255;
+
+        case blend_factor::zero:
+            return 0;
+
+        case blend_factor::frag_out_alpha:
+            return source_alpha;
+
+        case blend_factor::one_minus_frag_out_alpha:
+            return 255 - source_alpha;
+
+        case blend_factor::current_alpha:
+            return dest_alpha;
+
+        case blend_factor::one_minus_current_alpha:
+            return 255 - dest_alpha;
+
+        default:
+            break;
+        }
+
+        return 0;
+    }
+
+    static std::uint32_t blend_channel(const blend_equation equation, const std::uint32_t source, const std::uint32_t source_factor,
+        const std::uint32_t dest, const std::uint32_t dest_factor) {
+        const int source_term = static_cast<int>(source * source_factor);
+        const int dest_term = static_cast<int>(dest * dest_factor);
+
+        int result = 0;
+
+        switch (equation) {
+        case blend_equation::add:
+            result = source_term + dest_term;
+            break;
+
+        case blend_equation::sub:
+            result = source_term - dest_term;
+            break;
+
+        case blend_equation::isub:
+            result = dest_term - source_term;
+            break;
+
+        default:
+            break;
+        }
+
+        return static_cast<std::uint32_t>(common::clamp(0, 255, (result + 127) / 255));
+    }
+
+    static std::uint32_t blend_pixel(const software_blend_state &state, const std::uint32_t source, const std::uint32_t dest) {
+        const std::uint32_t source_alpha = source >> 24;
+        const std::uint32_t dest_alpha = dest >> 24;
+
+        const std::uint32_t rgb_source_factor = get_blend_factor(state.rgb_src_, source_alpha, dest_alpha);
+        const std::uint32_t rgb_dest_factor = get_blend_factor(state.rgb_dest_, source_alpha, dest_alpha);
+        const std::uint32_t a_source_factor = get_blend_factor(state.a_src_, source_alpha, dest_alpha);
+        const std::uint32_t a_dest_factor = get_blend_factor(state.a_dest_, source_alpha, dest_alpha);
+
+        std::uint32_t result = 0;
+
+        for (int i = 0; i < 3; i++) {
+            const std::uint32_t shift = i * 8;
+            result |= blend_channel(state.rgb_equation_, (source >> shift) & 0xFF, rgb_source_factor, (dest >> shift) & 0xFF,
+                rgb_dest_factor) << shift;
+        }
+
+        result |= blend_channel(state.a_equation_, source_alpha, a_source_factor, dest_alpha, a_dest_factor) << 24;
+        return result;
+    }
+
+    static bool stencil_test(const condition_func func, const std::uint8_t ref, const std::uint8_t value) {
+        switch (func) {
+        case condition_func::never:
+            return false;
+
+        case condition_func::less:
+            return ref < value;
+
+        case condition_func::less_or_equal:
+            return ref <= value;
+
+        case condition_func::greater:
+            return ref > value;
+
+        case condition_func::greater_or_equal:
+            return ref >= value;
+
+        case condition_func::equal:
+            return ref == value;
+
+        case condition_func::not_equal:
+            return ref != value;
+
+        case condition_func::always:
+            return true;
+
+        default:
+            break;
+        }
+
+        return false;
+    }
+
+    static std::uint8_t stencil_apply(const stencil_action action, const std::uint8_t ref, const std::uint8_t value) {
+        switch (action) {
+        case stencil_action::keep:
+            return value;
+
+        case stencil_action::replace:
+            return ref;
+
+        case stencil_action::invert:
+            return ~value;
+
+        case stencil_action::increment:
+            return (value == 0xFF) ? value : value + 1;
+
+        case stencil_action::increment_wrap:
+            return value + 1;
+
+        case stencil_action::decrement:
+            return (value == 0) ? value : value - 1;
+
+        case stencil_action::decrement_wrap:
+            return value - 1;
+
+        case stencil_action::set_to_zero:
+            return 0;
+
+        default:
+            break;
+        }
+
+        return value;
+    }
+
+    static std::uint32_t modulate(const std::uint32_t texel, const std::uint32_t *color) {
+        std::uint32_t result = 0;
+
+        for (int i = 0; i < 4; i++) {
+            const std::uint32_t shift = i * 8;
+            result |= ((((texel >> shift) & 0xFF) * color[i] + 127) / 255) << shift;
+        }
+
+        return result;
+    }
+
+    void software_graphics_driver::draw_quad(const software_quad &quad) {
+        software_texture *target = get_target_color();
+
+        if (!target || (target->get_size().x <= 0) || (target->get_size().y <= 0)) {
+            return;
+        }
+
+        software_texture *ds = stencil.enabled_ ? get_target_depth_stencil() : nullptr;
+        const eka2l1::vec2 target_size = target->get_size();
+
+        // Fragments are limited to the target, the viewport and the scissor box
+        int min_x = std::max(0, viewport.top.x);
+        int min_y = std::max(0, viewport.top.y);
+        int max_x = std::min(target_size.x, viewport.top.x + viewport.size.x);
+        int max_y = std::min(target_size.y, viewport.top.y + viewport.size.y);
+
+        if (clipping) {
+            min_x = std::max(min_x, scissor.top.x);
+            min_y = std::max(min_y, scissor.top.y);
+            max_x = std::min(max_x, scissor.top.x + scissor.size.x);
+            max_y = std::min(max_y, scissor.top.y + scissor.size.y);
+        }
+
+        float corners_x[4] = { quad.origin_[0], quad.origin_[0] + quad.axis_u_[0], quad.origin_[0] + quad.axis_v_[0],
+            quad.origin_[0] + quad.axis_u_[0] + quad.axis_v_[0] };
+        float corners_y[4] = { quad.origin_[1], quad.origin_[1] + quad.axis_u_[1], quad.origin_[1] + quad.axis_v_[1],
+            quad.origin_[1] + quad.axis_u_[1] + quad.axis_v_[1] };
+
+        min_x = std::max(min_x, static_cast<int>(std::floor(*std::min_element(corners_x, corners_x + 4))));
+        min_y = std::max(min_y, static_cast<int>(std::floor(*std::min_element(corners_y, corners_y + 4))));
+        max_x = std::min(max_x, static_cast<int>(std::ceil(*std::max_element(corners_x, corners_x + 4))));
+        max_y = std::min(max_y, static_cast<int>(std::ceil(*std::max_element(corners_y, corners_y + 4))));
+
+        const float det = quad.axis_u_[0] * quad.axis_v_[1] - quad.axis_u_[1] * quad.axis_v_[0];
+
+        if ((min_x >= max_x) || (min_y >= max_y) || (std::abs(det) < 1e-6f)) {
+            return;
+        }
+
+        frame_stats.draw_calls_++;
+
+        std::uint32_t color[4];
+        bool color_is_white = true;
+
+        for (int i = 0; i < 4; i++) {
+            color[i] = static_cast<std::uint32_t>(common::clamp(0.0f, 255.0f, quad.color_[i]) + 0.5f);
+            color_is_white = color_is_white && (color[i] == 255);
+        }
+
+        const std::uint32_t flat_color = software_pack_rgba(color[0], color[1], color[2], color[3]);
+
+        const eka2l1::vec2 tex_size = quad.texture_ ? quad.texture_->get_size() : eka2l1::vec2(0, 0);
+        const eka2l1::vec2 mask_size = quad.mask_ ? quad.mask_->get_size() : eka2l1::vec2(0, 0);
+
+        std::uint32_t *target_pixels = target->color_data();
+        std::uint8_t *stencil_pixels = (ds && (ds->get_size() == target_size)) ? ds->stencil_data() : nullptr;
+
+        const std::uint8_t stencil_ref = stencil.ref_ & stencil.read_mask_;
+
+        for (int y = min_y; y < max_y; y++) {
+            for (int x = min_x; x < max_x; x++) {
+                // Solve origin + u * axis_u + v * axis_v = pixel center
+                const float dx = x + 0.5f - quad.origin_[0];
+                const float dy = y + 0.5f - quad.origin_[1];
+
+                const float u = (dx * quad.axis_v_[1] - dy * quad.axis_v_[0]) / det;
+                const float v = (quad.axis_u_[0] * dy - quad.axis_u_[1] * dx) / det;
+
+                if ((u < 0.0f) || (u >= 1.0f) || (v < 0.0f) || (v >= 1.0f)) {
+                    continue;
+                }
+
+                const std::size_t offset = static_cast<std::size_t>(y) * target_size.x + x;
+
+                if (stencil_pixels) {
+                    std::uint8_t &value = stencil_pixels[offset];
+                    const bool passed = stencil_test(stencil.func_, stencil_ref, value & stencil.read_mask_);
+                    const std::uint8_t result = stencil_apply(passed ? stencil.on_pass_ : stencil.on_fail_, stencil.ref_, value);
+
+                    value = (value & ~stencil.write_mask_) | (result & stencil.write_mask_);
+
+                    if (!passed) {
+                        continue;
+                    }
+                }
+
+                std::uint32_t fragment = flat_color;
+                const float tex_x = quad.tex_origin_[0] + u * quad.tex_axis_u_[0] + v * quad.tex_axis_v_[0];
+                const float tex_y = quad.tex_origin_[1] + u * quad.tex_axis_u_[1] + v * quad.tex_axis_v_[1];
+
+                if (quad.texture_) {
+                    if ((tex_size.x <= 0) || (tex_size.y <= 0)) {
+                        continue;
+                    }
+
+                    const int texel_x = common::clamp(0, tex_size.x - 1, static_cast<int>(std::floor(tex_x * tex_size.x)));
+                    const int texel_y = common::clamp(0, tex_size.y - 1, static_cast<int>(std::floor(tex_y * tex_size.y)));
+
+                    fragment = quad.texture_->sample(texel_x, texel_y);
+
+                    if (!color_is_white) {
+                        fragment = modulate(fragment, color);
+                    }
+                }
+
+                if (quad.mask_ && (mask_size.x > 0) && (mask_size.y > 0)) {
+                    const int texel_x = common::clamp(0, mask_size.x - 1, static_cast<int>(std::floor(tex_x * mask_size.x)));
+                    const int texel_y = common::clamp(0, mask_size.y - 1, static_cast<int>(std::floor(tex_y * mask_size.y)));
+
+                    const std::uint32_t mask_value = quad.mask_->sample(texel_x, texel_y) & 0xFF;
+                    const std::uint32_t coverage = quad.invert_mask_ ? (255 - mask_value) : mask_value;
+
+                    fragment = (fragment & 0x00FFFFFF) | ((((fragment >> 24) * coverage + 127) / 255) << 24);
+                }
+
+                target_pixels[offset] = blend.enabled_ ? blend_pixel(blend, fragment, target_pixels[offset]) : fragment;
+            }
+        }
+    }
+
+    // Corners of the unit quad that define its axes: origin, end of the u axis, end of the v axis
+    static constexpr float QUAD_AXIS_CORNERS[3][2] = {
+        { 0.0f, 0.0f },
+        { 1.0f, 0.0f },
+        { 0.0f, 1.0f }
+    };
+
+    static void fill_quad_axes(const float corners[3][2], float *origin, float *axis_u, float *axis_v) {
+        origin[0] = corners[0][0];
+        origin[1] = corners[0][1];
+        axis_u[0] = corners[1][0] - corners[0][0];
+        axis_u[1] = corners[1][1] - corners[0][1];
+        axis_v[0] = corners[2][0] - corners[0][0];
+        axis_v[1] = corners[2][1] - corners[0][1];
+    }
+
+    void software_graphics_driver::draw_rectangle(command_helper &helper) {
+        eka2l1::rect fill_rect;
+        helper.pop(fill_rect);
+
+        software_quad quad;
+        float corners[3][2];
+
+        for (int i = 0; i < 3; i++) {
+            // The fill vertex shader always flips
+            to_framebuffer_coords(fill_rect.top.x + QUAD_AXIS_CORNERS[i][0] * fill_rect.size.x,
+                fill_rect.top.y + QUAD_AXIS_CORNERS[i][1] * fill_rect.size.y, -1.0f, corners[i]);
+        }
+
+        fill_quad_axes(corners, quad.origin_, quad.axis_u_, quad.axis_v_);
+        fill_quad_axes(QUAD_AXIS_CORNERS, quad.tex_origin_, quad.tex_axis_u_, quad.tex_axis_v_);
+
+        std::copy(brush_color.elements.begin(), brush_color.elements.end(), quad.color_);
+        draw_quad(quad);
+    }
+
+    void software_graphics_driver::draw_bitmap(command_helper &helper) {
+        // Get bitmap to draw
+        drivers::handle to_draw = 0;
+        helper.pop(to_draw);
+
+        bitmap *bmp = get_bitmap(to_draw);
+
+        if (!bmp) {
+            LOG_ERROR(DRIVER_GRAPHICS, "Invalid bitmap handle to draw");
+            return;
+        }
+
+        drivers::handle mask_to_use = 0;
+        helper.pop(mask_to_use);
+
+        bitmap *mask_bmp = nullptr;
+
+        if (mask_to_use) {
+            mask_bmp = get_bitmap(mask_to_use);
+
+            if (!mask_bmp) {
+                LOG_ERROR(DRIVER_GRAPHICS, "Mask handle was provided but invalid!");
+                return;
+            }
+        }
+
+        eka2l1::rect dest_rect;
+        helper.pop(dest_rect);
+
+        eka2l1::rect source_rect;
+        helper.pop(source_rect);
+
+        eka2l1::vec2 origin = eka2l1::vec2(0, 0);
+        helper.pop(origin);
+
+        float rotation = 0.0f;
+        helper.pop(rotation);
+
+        std::uint32_t flags = 0;
+        helper.pop(flags);
+
+        software_quad quad;
+        float tex_corners[3][2];
+
+        for (int i = 0; i < 3; i++) {
+            tex_corners[i][0] = QUAD_AXIS_CORNERS[i][0];
+            tex_corners[i][1] = QUAD_AXIS_CORNERS[i][1];
+        }
+
+        if (!source_rect.empty()) {
+            const float texel_width = 1.0f / bmp->tex->get_size().x;
+            const float texel_height = 1.0f / bmp->tex->get_size().y;
+
+            for (int i = 0; i < 3; i++) {
+                tex_corners[i][0] = (source_rect.top.x + QUAD_AXIS_CORNERS[i][0] * source_rect.size.x) * texel_width;
+                tex_corners[i][1] = (source_rect.top.y + QUAD_AXIS_CORNERS[i][1] * source_rect.size.y) * texel_height;
+            }
+        }
+
+        if (source_rect.size.x == 0) {
+            source_rect.size.x = bmp->tex->get_size().x;
+        }
+
+        if (source_rect.size.y == 0) {
+            source_rect.size.y = bmp->tex->get_size().y;
+        }
+
+        if (dest_rect.size.x == 0) {
+            dest_rect.size.x = source_rect.size.x;
+        }
+
+        if (dest_rect.size.y == 0) {
+            dest_rect.size.y = source_rect.size.y;
+        }
+
+        // Scale to destination size, then rotate around the origin, then move to the destination
+        const float rotation_rad = rotation * 3.14159265358979f / 180.0f;
+        const float rotation_cos = std::cos(rotation_rad);
+        const float rotation_sin = std::sin(rotation_rad);
+
+        const float flip = (flags & bitmap_draw_flag_no_flip) ? 1.0f : -1.0f;
+        float corners[3][2];
+
+        for (int i = 0; i < 3; i++) {
+            const float x = QUAD_AXIS_CORNERS[i][0] * dest_rect.size.x - origin.x;
+            const float y = QUAD_AXIS_CORNERS[i][1] * dest_rect.size.y - origin.y;
+
+            to_framebuffer_coords(dest_rect.top.x + origin.x + x * rotation_cos - y * rotation_sin,
+                dest_rect.top.y + origin.y + x * rotation_sin + y * rotation_cos, flip, corners[i]);
+        }
+
+        fill_quad_axes(corners, quad.origin_, quad.axis_u_, quad.axis_v_);
+        fill_quad_axes(tex_corners, quad.tex_origin_, quad.tex_axis_u_, quad.tex_axis_v_);
+
+        if (flags & bitmap_draw_flag_use_brush) {
+            std::copy(brush_color.elements.begin(), brush_color.elements.end(), quad.color_);
+        } else {
+            std::fill(quad.color_, quad.color_ + 4, 255.0f);
+        }
+
+        quad.texture_ = static_cast<software_texture *>(bmp->tex.get());
+
+        if (mask_bmp) {
+            quad.mask_ = static_cast<software_texture *>(mask_bmp->tex.get());
+            quad.invert_mask_ = (flags & bitmap_draw_flag_invert_mask);
+        }
+
+        draw_quad(quad);
+    }
+
+    void software_graphics_driver::draw_indexed(command_helper &helper) {
+        // Vertex data is only meaningful to shader programs, which this driver can not run
+        if (!warned_indexed_draw) {
+            LOG_WARN(DRIVER_GRAPHICS, "Indexed draws are not supported by the software graphics driver, skipping them");
+            warned_indexed_draw = true;
+        }
+    }
+
+    void software_graphics_driver::set_clipping(command_helper &helper) {
+        bool enable = false;
+        helper.pop(enable);
+
+        clipping = enable;
+    }
+
+    void software_graphics_driver::clip_rect(command_helper &helper) {
+        eka2l1::rect clip_rect;
+        helper.pop(clip_rect);
+
+        scissor = eka2l1::rect(eka2l1::vec2(clip_rect.top.x, (clip_rect.size.y < 0) ? (current_fb_height - (clip_rect.top.y - clip_rect.size.y))
+            : clip_rect.top.y), eka2l1::vec2(clip_rect.size.x, common::abs(clip_rect.size.y)));
+    }
+
+    void software_graphics_driver::set_viewport(command_helper &helper) {
+        eka2l1::rect viewport;
+        helper.pop(viewport);
+
+        set_viewport(viewport);
+    }
+
+    void software_graphics_driver::set_blend(command_helper &helper) {
+        bool enable = true;
+        helper.pop(enable);
+
+        blend.enabled_ = enable;
+    }
+
+    void software_graphics_driver::blend_formula(command_helper &helper) {
+        helper.pop(blend.rgb_equation_);
+        helper.pop(blend.a_equation_);
+        helper.pop(blend.rgb_src_);
+        helper.pop(blend.rgb_dest_);
+        helper.pop(blend.a_src_);
+        helper.pop(blend.a_dest_);
+    }
+
+    void software_graphics_driver::set_stencil(command_helper &helper) {
+        bool enable = true;
+        helper.pop(enable);
+
+        stencil.enabled_ = enable;
+    }
+
+    void software_graphics_driver::set_stencil_action(command_helper &helper) {
+        stencil_face face_to_operate = stencil_face::back_and_front;
+        stencil_action on_stencil_fail = stencil_action::keep;
+        stencil_action on_stencil_pass_depth_fail = stencil_action::keep;
+        stencil_action on_stencil_depth_pass = stencil_action::replace;
+
+        helper.pop(face_to_operate);
+        helper.pop(on_stencil_fail);
+        helper.pop(on_stencil_pass_depth_fail);
+        helper.pop(on_stencil_depth_pass);
+
+        // There is no depth test, so the depth pass action is the one used on stencil pass
+        stencil.on_fail_ = on_stencil_fail;
+        stencil.on_pass_ = on_stencil_depth_pass;
+    }
+
+    void software_graphics_driver::set_stencil_pass_condition(command_helper &helper) {
+        condition_func pass_func = condition_func::always;
+        stencil_face face_to_operate = stencil_face::back_and_front;
+        std::int32_t ref_value = 0;
+        std::uint32_t mask = 0xFF;
+
+        helper.pop(face_to_operate);
+        helper.pop(pass_func);
+        helper.pop(ref_value);
+        helper.pop(mask);
+
+        stencil.func_ = pass_func;
+        stencil.ref_ = static_cast<std::uint8_t>(common::clamp(0, 0xFF, ref_value));
+        stencil.read_mask_ = static_cast<std::uint8_t>(mask);
+    }
+
+    void software_graphics_driver::set_stencil_mask(command_helper &helper) {
+        stencil_face face_to_operate = stencil_face::back_and_front;
+        std::uint32_t mask = 0xFF;
+
+        helper.pop(face_to_operate);
+        helper.pop(mask);
+
+        stencil.write_mask_ = static_cast<std::uint8_t>(mask);
+    }
+
+    void software_graphics_driver::clear(command_helper &helper) {
+        std::uint32_t color_to_clear;
+        std::uint8_t clear_bits = 0;
+
+        helper.pop(color_to_clear);
+        helper.pop(clear_bits);
+
+        software_texture *target = get_target_color();
+
+        if (!target) {
+            return;
+        }
+
+        // Clears only obey the scissor box
+        eka2l1::vec2 target_size = target->get_size();
+
+        int min_x = 0;
+        int min_y = 0;
+        int max_x = target_size.x;
+        int max_y = target_size.y;
+
+        if (clipping) {
+            min_x = std::max(min_x, scissor.top.x);
+            min_y = std::max(min_y, scissor.top.y);
+            max_x = std::min(max_x, scissor.top.x + scissor.size.x);
+            max_y = std::min(max_y, scissor.top.y + scissor.size.y);
+        }
+
+        if ((min_x >= max_x) || (min_y >= max_y)) {
+            return;
+        }
+
+        if (clear_bits & draw_buffer_bit_color_buffer) {
+            const std::uint32_t color = software_pack_rgba((color_to_clear & 0xFF000000) >> 24, (color_to_clear & 0x00FF0000) >> 16,
+                (color_to_clear & 0x0000FF00) >> 8, color_to_clear & 0x000000FF);
+
+            std::uint32_t *pixels = target->color_data();
+
+            for (int y = min_y; y < max_y; y++) {
+                std::fill(pixels + static_cast<std::size_t>(y) * target_size.x + min_x,
+                    pixels + static_cast<std::size_t>(y) * target_size.x + max_x, color);
+            }
+        }
+
+        software_texture *ds = get_target_depth_stencil();
+
+        if ((clear_bits & draw_buffer_bit_stencil_buffer) && ds && (ds->get_size() == target_size)) {
+            const std::uint8_t value = static_cast<std::uint8_t>((color_to_clear & 0xFF000000) >> 24);
+            std::uint8_t *stencil_pixels = ds->stencil_data();
+
+            for (int y = min_y; y < max_y; y++) {
+                for (int x = min_x; x < max_x; x++) {
+                    std::uint8_t &current = stencil_pixels[static_cast<std::size_t>(y) * target_size.x + x];
+                    current = (current & ~stencil.write_mask_) | (value & stencil.write_mask_);
+                }
+            }
+        }
+    }
+
+    std::unique_ptr<graphics_command_list> software_graphics_driver::new_command_list() {
+        return std::make_unique<server_graphics_command_list>(list_pool.acquire());
+    }
+
+    std::unique_ptr<graphics_command_list_builder> software_graphics_driver::new_command_builder(graphics_command_list *list) {
+        return std::make_unique<server_graphics_command_list_builder>(list);
+    }
+
+    void software_graphics_driver::submit_command_list(graphics_command_list &command_list) {
+        list_queue.push(std::move(static_cast<server_graphics_command_list &>(command_list)));
+    }
+
+    void software_graphics_driver::display(command_helper &helper) {
+        const eka2l1::vec2 size = swapchain->get_size();
+        const std::uint32_t *source = swapchain->color_data();
+
+        presented_frame.resize(static_cast<std::size_t>(size.x) * size.y);
+
+        // The swapchain is bottom-up like a window's framebuffer, the frame in memory is top-down
+        for (int y = 0; y < size.y; y++) {
+            std::memcpy(presented_frame.data() + static_cast<std::size_t>(y) * size.x,
+                source + static_cast<std::size_t>(size.y - 1 - y) * size.x, size.x * sizeof(std::uint32_t));
+        }
+
+        presented_size = size;
+        present_count++;
+
+        if (disp_hook_) {
+            disp_hook_();
+        }
+
+        end_frame_stats();
+        helper.finish(this, 0);
+    }
+
+    void software_graphics_driver::save_state() {
+        backup.viewport_ = viewport;
+        backup.scissor_ = scissor;
+        backup.clipping_ = clipping;
+        backup.blend_ = blend;
+        backup.stencil_ = stencil;
+    }
+
+    void software_graphics_driver::load_state() {
+        viewport = backup.viewport_;
+        scissor = backup.scissor_;
+        clipping = backup.clipping_;
+        blend = backup.blend_;
+        stencil = backup.stencil_;
+    }
+
+    void software_graphics_driver::dispatch(command *cmd) {
+        EKA2L1_PROFILE_SCOPE("Graphics", "Dispatch", 0xDA70D6);
+        command_helper helper(cmd);
+
+        switch (cmd->opcode_) {
+        case graphics_driver_draw_bitmap: {
+            draw_bitmap(helper);
+            break;
+        }
+
+        case graphics_driver_set_clipping: {
+            set_clipping(helper);
+            break;
+        }
+
+        case graphics_driver_clip_rect: {
+            clip_rect(helper);
+            break;
+        }
+
+        case graphics_driver_draw_indexed: {
+            draw_indexed(helper);
+            break;
+        }
+
+        case graphics_driver_backup_state: {
+            save_state();
+            break;
+        }
+
+        case graphics_driver_restore_state: {
+            load_state();
+            break;
+        }
+
+        case graphics_driver_set_depth:
+        case graphics_driver_set_cull: {
+            // No depth buffer and no facing
+            break;
+        }
+
+        case graphics_driver_blend_formula: {
+            blend_formula(helper);
+            break;
+        }
+
+        case graphics_driver_set_stencil:
+            set_stencil(helper);
+            break;
+
+        case graphics_driver_stencil_set_action:
+            set_stencil_action(helper);
+            break;
+
+        case graphics_driver_stencil_pass_condition:
+            set_stencil_pass_condition(helper);
+            break;
+
+        case graphics_driver_stencil_set_mask:
+            set_stencil_mask(helper);
+            break;
+
+        case graphics_driver_set_blend: {
+            set_blend(helper);
+            break;
+        }
+
+        case graphics_driver_clear: {
+            clear(helper);
+            break;
+        }
+
+        case graphics_driver_set_viewport: {
+            set_viewport(helper);
+            break;
+        }
+
+        case graphics_driver_display: {
+            display(helper);
+            break;
+        }
+
+        case graphics_driver_draw_rectangle: {
+            draw_rectangle(helper);
+            break;
+        }
+
+        case graphics_driver_set_swapchain_size: {
+            shared_graphics_driver::dispatch(cmd);
+            resize_swapchain();
+            break;
+        }
+
+        default:
+            shared_graphics_driver::dispatch(cmd);
+            break;
+        }
+    }
+
+    void software_graphics_driver::run() {
+        while (!should_stop) {
+            std::optional<server_graphics_command_list> list = list_queue.pop();
+
+            if (!list) {
+                if (!should_stop) {
+                    LOG_ERROR(DRIVER_GRAPHICS, "Corrupted graphics command list! Emulation halt.");
+                }
+
+                break;
+            }
+
+            {
+                // Readers see bitmaps between lists, never half drawn
+                const std::lock_guard<std::mutex> guard(frame_lock);
+
+                for (command &cmd : list->list_.commands_) {
+                    dispatch(&cmd);
+                }
+            }
+
+            list_pool.recycle(list->list_);
+        }
+    }
+
+    void software_graphics_driver::abort() {
+        should_stop = true;
+        list_queue.abort();
+    }
+
+    bool software_graphics_driver::read_bitmap(const drivers::handle h, std::vector<std::uint32_t> &pixels, eka2l1::vec2 &size) {
+        const std::lock_guard<std::mutex> guard(frame_lock);
+        bitmap *bmp = get_bitmap(h);
+
+        if (!bmp) {
+            return false;
+        }
+
+        software_texture *tex = static_cast<software_texture *>(bmp->tex.get());
+        size = tex->get_size();
+
+        pixels.resize(static_cast<std::size_t>(size.x) * size.y);
+
+        for (std::size_t i = 0; i < pixels.size(); i++) {
+            pixels[i] = tex->sample(static_cast<int>(i % size.x), static_cast<int>(i / size.x));
+        }
+
+        return true;
+    }
+
+    std::uint64_t software_graphics_driver::read_presented_frame(std::vector<std::uint32_t> &pixels, eka2l1::vec2 &size) {
+        const std::lock_guard<std::mutex> guard(frame_lock);
+
+        pixels = presented_frame;
+        size = presented_size;
+
+        return present_count;
+    }
+}
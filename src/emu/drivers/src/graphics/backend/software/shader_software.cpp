@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <drivers/graphics/backend/software/shader_software.h>
+
+namespace eka2l1::drivers {
+    bool software_shader::create(graphics_driver *driver, const char *vert_data, const std::size_t vert_size,
+        const char *frag_data, const std::size_t frag_size) {
+        return true;
+    }
+
+    bool software_shader::use(graphics_driver *driver) {
+        return true;
+    }
+
+    bool software_shader::set(graphics_driver *driver, const int binding, const shader_set_var_type var_type, const void *data) {
+        return true;
+    }
+
+    std::optional<int> software_shader::get_uniform_location(const std::string &name) {
+        return std::nullopt;
+    }
+
+    std::optional<int> software_shader::get_attrib_location(const std::string &name) {
+        return std::nullopt;
+    }
+}
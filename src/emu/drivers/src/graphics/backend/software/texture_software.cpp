@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <drivers/graphics/backend/software/texture_software.h>
+
+#include <common/log.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace eka2l1::drivers {
+    // Same as the default unpack alignment of OpenGL
+    static constexpr std::size_t ROW_ALIGNMENT = 4;
+
+    static std::size_t get_bytes_per_pixel(const texture_format format, const texture_data_type data_type) {
+        switch (data_type) {
+        case texture_data_type::ushort_4_4_4_4:
+        case texture_data_type::ushort_5_6_5:
+            return 2;
+
+        case texture_data_type::uint_24_8:
+            return 4;
+
+        case texture_data_type::ubyte:
+            break;
+
+        default:
+            return 0;
+        }
+
+        switch (format) {
+        case texture_format::r:
+        case texture_format::r8:
+            return 1;
+
+        case texture_format::rg:
+            return 2;
+
+        case texture_format::rgb:
+        case texture_format::bgr:
+            return 3;
+
+        case texture_format::rgba:
+        case texture_format::bgra:
+            return 4;
+
+        default:
+            break;
+        }
+
+        return 0;
+    }
+
+    static std::uint32_t expand_bits(const std::uint32_t value, const std::uint32_t bits) {
+        return (value * 255 + ((1 << bits) - 1) / 2) / ((1 << bits) - 1);
+    }
+
+    // Convert a row of uploaded pixels to RGBA8, the way OpenGL fills in missing components
+    static void decode_row(std::uint32_t *dest, const std::uint8_t *source, const int count, const texture_format format,
+        const texture_data_type data_type) {
+        if (data_type == texture_data_type::ushort_4_4_4_4) {
+            for (int i = 0; i < count; i++) {
+                const std::uint32_t v = source[i * 2] | (source[i * 2 + 1] << 8);
+                dest[i] = software_pack_rgba(((v >> 12) & 0xF) * 17, ((v >> 8) & 0xF) * 17, ((v >> 4) & 0xF) * 17, (v & 0xF) * 17);
+            }
+
+            return;
+        }
+
+        if (data_type == texture_data_type::ushort_5_6_5) {
+            for (int i = 0; i < count; i++) {
+                const std::uint32_t v = source[i * 2] | (source[i * 2 + 1] << 8);
+                dest[i] = software_pack_rgba(expand_bits((v >> 11) & 0x1F, 5), expand_bits((v >> 5) & 0x3F, 6),
+                    expand_bits(v & 0x1F, 5), 0xFF);
+            }
+
+            return;
+        }
+
+        switch (format) {
+        case texture_format::r:
+        case texture_format::r8:
+            for (int i = 0; i < count; i++) {
+                dest[i] = software_pack_rgba(source[i], 0, 0, 0xFF);
+            }
+
+            break;
+
+        case texture_format::rg:
+            for (int i = 0; i < count; i++) {
+                dest[i] = software_pack_rgba(source[i * 2], source[i * 2 + 1], 0, 0xFF);
+            }
+
+            break;
+
+        case texture_format::rgb:
+            for (int i = 0; i < count; i++) {
+                dest[i] = software_pack_rgba(source[i * 3], source[i * 3 + 1], source[i * 3 + 2], 0xFF);
+            }
+
+            break;
+
+        case texture_format::bgr:
+            for (int i = 0; i < count; i++) {
+                dest[i] = software_pack_rgba(source[i * 3 + 2], source[i * 3 + 1], source[i * 3], 0xFF);
+            }
+
+            break;
+
+        case texture_format::rgba:
+            std::memcpy(dest, source, count * sizeof(std::uint32_t));
+            break;
+
+        case texture_format::bgra:
+            for (int i = 0; i < count; i++) {
+                dest[i] = software_pack_rgba(source[i * 4 + 2], source[i * 4 + 1], source[i * 4], source[i * 4 + 3]);
+            }
+
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    software_texture::software_texture()
+        : dimensions(2)
+        , internal_format(texture_format::none)
+        , format(texture_format::none)
+        , tex_data_type(texture_data_type::ubyte)
+        , tex_data(nullptr)
+        , mip_level(0)
+        , pixels_per_line(0)
+        , min_filter(filter_option::linear)
+        , mag_filter(filter_option::linear)
+        , swizzle({ 0, 1, 2, 3 })
+        , swizzle_identity(true) {
+    }
+
+    software_texture::~software_texture() {
+    }
+
+    void software_texture::allocate_storage() {
+        const std::size_t total = static_cast<std::size_t>(std::max(tex_size.x, 0)) * std::max(tex_size.y, 0);
+
+        if (is_depth_stencil()) {
+            pixels.clear();
+            stencil.assign(total, 0);
+        } else {
+            stencil.clear();
+            pixels.assign(total, 0);
+        }
+    }
+
+    bool software_texture::tex(graphics_driver *driver, const bool is_first) {
+        if ((dimensions != 1) && (dimensions != 2)) {
+            LOG_ERROR(DRIVER_GRAPHICS, "Software textures can only have one or two dimensions (requested {})", dimensions);
+            return false;
+        }
+
+        allocate_storage();
+
+        if (tex_data) {
+            update_data(driver, mip_level, vec3(0, 0, 0), vec3(tex_size.x, tex_size.y, 0), pixels_per_line, format,
+                tex_data_type, tex_data);
+        }
+
+        return true;
+    }
+
+    bool software_texture::create(graphics_driver *driver, const int dim, const int miplvl, const vec3 &size, const texture_format internal_format,
+        const texture_format format, const texture_data_type data_type, void *data, const std::size_t ppl) {
+        dimensions = dim;
+        tex_size = vec2(size.x, (dim == 1) ? 1 : size.y);
+        tex_data_type = data_type;
+        tex_data = data;
+        mip_level = miplvl;
+        pixels_per_line = ppl;
+
+        this->internal_format = internal_format;
+        this->format = format;
+
+        return tex(driver, true);
+    }
+
+    void software_texture::change_size(const vec3 &new_size) {
+        tex_size = vec2(new_size.x, (dimensions == 1) ? 1 : new_size.y);
+    }
+
+    void software_texture::change_data(const texture_data_type data_type, void *data) {
+        tex_data_type = data_type;
+        tex_data = data;
+    }
+
+    void software_texture::change_texture_format(const texture_format format) {
+        this->format = format;
+    }
+
+    void software_texture::set_filter_minmag(const bool min, const filter_option op) {
+        // Sampling is always nearest. Kept so the state can still be queried later.
+        if (min) {
+            min_filter = op;
+        } else {
+            mag_filter = op;
+        }
+    }
+
+    void software_texture::set_channel_swizzle(channel_swizzles swizz) {
+        for (int i = 0; i < 4; i++) {
+            swizzle[i] = static_cast<std::uint8_t>(swizz[i]);
+        }
+
+        swizzle_identity = (swizzle[0] == 0) && (swizzle[1] == 1) && (swizzle[2] == 2) && (swizzle[3] == 3);
+    }
+
+    void software_texture::bind(graphics_driver *driver, const int binding) {
+        // Nothing to bind, draws reference textures directly
+    }
+
+    void software_texture::unbind(graphics_driver *driver) {
+    }
+
+    void software_texture::update_data(graphics_driver *driver, const int mip_lvl, const vec3 &offset, const vec3 &size, const std::size_t ppl,
+        const texture_format data_format, const texture_data_type data_type, const void *data) {
+        if (!data || (mip_lvl != mip_level)) {
+            return;
+        }
+
+        const std::size_t bytes_per_pixel = get_bytes_per_pixel(data_format, data_type);
+
+        if (bytes_per_pixel == 0) {
+            LOG_ERROR(DRIVER_GRAPHICS, "Unsupported upload format {} (data type {}) for software texture",
+                static_cast<int>(data_format), static_cast<int>(data_type));
+            return;
+        }
+
+        const int height = (dimensions == 1) ? 1 : size.y;
+        const int offset_y = (dimensions == 1) ? 0 : offset.y;
+
+        // Clip the update to the texture
+        const int start_x = std::max(offset.x, 0);
+        const int start_y = std::max(offset_y, 0);
+        const int end_x = std::min(offset.x + size.x, tex_size.x);
+        const int end_y = std::min(offset_y + height, tex_size.y);
+
+        if ((start_x >= end_x) || (start_y >= end_y)) {
+            return;
+        }
+
+        const std::size_t row_pixels = (ppl == 0) ? static_cast<std::size_t>(size.x) : ppl;
+        const std::size_t row_stride = (row_pixels * bytes_per_pixel + ROW_ALIGNMENT - 1) & ~(ROW_ALIGNMENT - 1);
+
+        const std::uint8_t *source = reinterpret_cast<const std::uint8_t *>(data);
+
+        for (int y = start_y; y < end_y; y++) {
+            const std::uint8_t *source_row = source + (y - offset_y) * row_stride + (start_x - offset.x) * bytes_per_pixel;
+            const std::size_t dest_offset = static_cast<std::size_t>(y) * tex_size.x + start_x;
+
+            if (data_type == texture_data_type::uint_24_8) {
+                if (stencil.empty()) {
+                    return;
+                }
+
+                for (int x = 0; x < end_x - start_x; x++) {
+                    stencil[dest_offset + x] = source_row[x * 4];
+                }
+
+                continue;
+            }
+
+            if (pixels.empty()) {
+                return;
+            }
+
+            decode_row(&pixels[dest_offset], source_row, end_x - start_x, data_format, data_type);
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include <drivers/graphics/backend/ogl/buffer_ogl.h>
+#include <drivers/graphics/backend/software/buffer_software.h>
 #include <drivers/graphics/buffer.h>
 #include <drivers/graphics/graphics.h>
 
@@ -9,6 +10,10 @@ namespace eka2l1::drivers {
             return std::make_unique<ogl_buffer>();
         }
 
+        case graphic_api::software: {
+            return std::make_unique<software_buffer>();
+        }
+
         default:
             break;
         }
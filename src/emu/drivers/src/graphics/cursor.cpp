@@ -17,13 +17,20 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <common/configure.h>
+#include <drivers/graphics/cursor.h>
+
+#if ENABLE_WINDOW
 #include <drivers/graphics/backend/cursor_glfw.h>
+#endif
 
 namespace eka2l1::drivers {
     std::unique_ptr<cursor_controller> make_new_cursor_controller(const window_api api) {
         switch (api) {
+#if ENABLE_WINDOW
         case window_api::glfw:
             return std::make_unique<cursor_controller_glfw>();
+#endif
         default:
             break;
         }
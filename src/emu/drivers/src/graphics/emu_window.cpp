@@ -17,16 +17,25 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <drivers/graphics/backend/emu_window_glfw.h>
+#include <common/configure.h>
 #include <drivers/graphics/emu_window.h>
 
+#if ENABLE_WINDOW
+#include <drivers/graphics/backend/emu_window_glfw.h>
+#endif
+
 namespace eka2l1 {
     namespace drivers {
         std::unique_ptr<emu_window> new_emu_window(const window_api win_type) {
             switch (win_type) {
+#if ENABLE_WINDOW
             case window_api::glfw: {
                 return std::make_unique<emu_window_glfw3>();
             }
+#endif
+
+            default:
+                break;
             }
 
             return nullptr;
@@ -34,8 +43,10 @@ namespace eka2l1 {
 
         bool init_window_library(const window_api win_type) {
             switch (win_type) {
+#if ENABLE_WINDOW
             case window_api::glfw:
                 return glfwInit() == GLFW_TRUE ? true : false;
+#endif
 
             default:
                 break;
@@ -46,9 +57,11 @@ namespace eka2l1 {
 
         bool destroy_window_library(const window_api win_type) {
             switch (win_type) {
+#if ENABLE_WINDOW
             case window_api::glfw:
                 glfwTerminate();
                 return true;
+#endif
 
             default:
                 break;
@@ -18,6 +18,8 @@
  */
 
 #include <drivers/graphics/backend/ogl/fb_ogl.h>
+#include <drivers/graphics/backend/software/fb_software.h>
+#include <drivers/graphics/backend/software/graphics_software.h>
 #include <drivers/graphics/fb.h>
 #include <drivers/graphics/graphics.h>
 
@@ -42,6 +44,12 @@ namespace eka2l1::drivers {
             break;
         }
 
+        case graphic_api::software: {
+            return std::make_unique<software_framebuffer>(static_cast<software_graphics_driver *>(driver), color_buffer_list,
+                depth_and_stencil_buffer);
+            break;
+        }
+
         default:
             break;
         }
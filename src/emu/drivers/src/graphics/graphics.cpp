@@ -18,6 +18,7 @@
  */
 
 #include <drivers/graphics/backend/ogl/graphics_ogl.h>
+#include <drivers/graphics/backend/software/graphics_software.h>
 #include <drivers/graphics/graphics.h>
 
 #include <common/log.h>
@@ -45,6 +46,10 @@ namespace eka2l1::drivers {
             return true;
         }
 
+        case graphic_api::software:
+            // Nothing to load, everything is drawn on the CPU
+            return true;
+
         default:
             break;
         }
@@ -58,6 +63,10 @@ namespace eka2l1::drivers {
             return std::make_unique<ogl_graphics_driver>();
         }
 
+        case graphic_api::software: {
+            return std::make_unique<software_graphics_driver>();
+        }
+
         default:
             break;
         }
@@ -19,6 +19,7 @@
  */
 
 #include <drivers/graphics/backend/ogl/shader_ogl.h>
+#include <drivers/graphics/backend/software/shader_software.h>
 #include <drivers/graphics/graphics.h>
 #include <drivers/graphics/shader.h>
 
@@ -31,6 +32,10 @@ namespace eka2l1::drivers {
             return std::make_unique<ogl_shader>();
         }
 
+        case graphic_api::software: {
+            return std::make_unique<software_shader>();
+        }
+
         default:
             break;
         }
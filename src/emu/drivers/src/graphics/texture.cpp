@@ -18,6 +18,7 @@
  */
 
 #include <drivers/graphics/backend/ogl/texture_ogl.h>
+#include <drivers/graphics/backend/software/texture_software.h>
 #include <drivers/graphics/graphics.h>
 #include <drivers/graphics/texture.h>
 
@@ -29,6 +30,11 @@ namespace eka2l1::drivers {
             break;
         }
 
+        case graphic_api::software: {
+            return std::make_unique<software_texture>();
+            break;
+        }
+
         default:
             break;
         }
@@ -17,16 +17,25 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <drivers/input/backend/emu_controller_glfw.h>
+#include <common/configure.h>
 #include <drivers/input/emu_controller.h>
 
+#if ENABLE_WINDOW
+#include <drivers/input/backend/emu_controller_glfw.h>
+#endif
+
 namespace eka2l1 {
     namespace drivers {
         emu_controller_ptr new_emu_controller(controller_type ctl_type) {
             switch (ctl_type) {
+#if ENABLE_WINDOW
             case controller_type::glfw: {
                 return std::make_unique<emu_controller_glfw3>();
             }
+#endif
+
+            default:
+                break;
             }
 
             return nullptr;
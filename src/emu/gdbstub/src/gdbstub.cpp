@@ -138,6 +138,9 @@ namespace eka2l1 {
         } else if (id == FPSCR_REGISTER) {
             thread->get_thread_context().fpscr = static_cast<std::uint32_t>(val);
         }
+
+        // Force the CPU to reload the FPU state on next context load
+        thread->get_thread_context().fpu_save_stamp = 0;
     }
 
     static std::uint8_t hex_char_to_value(std::uint8_t hex) {
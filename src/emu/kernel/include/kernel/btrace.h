@@ -19,12 +19,26 @@
 
 #pragma once
 
+#include <common/queue.h>
 #include <vfs/vfs.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace eka2l1 {
     class kernel_system;
     class io_system;
+
+    namespace common {
+        class ro_stream;
+    }
 }
 
 namespace eka2l1::kernel {
@@ -35,20 +49,114 @@ namespace eka2l1::kernel {
         btrace_header_subcategory_index = 3
     };
 
-    struct btrace {
+    /**
+     * \brief A trace record, with the four words given to BTrace::Out.
+     */
+    struct btrace_frame {
+        std::uint32_t header_;
+        std::uint32_t a1_;
+        std::uint32_t a2_;
+        std::uint32_t a3_;
+
+        std::uint8_t header_field(const btrace_header_structure index) const {
+            return static_cast<std::uint8_t>(header_ >> (index * 8));
+        }
+    };
+
+    static constexpr std::uint32_t BTRACE_FILE_MAGIC = 0x43525442; ///< BTRC
+    static constexpr std::uint32_t BTRACE_FILE_VERSION = 1;
+    static constexpr std::uint32_t BTRACE_CATEGORY_COUNT = 256;
+
+    /**
+     * \brief Header of a trace file. The frames follow it, in the order they were traced.
+     */
+    struct btrace_file_header {
+        std::uint32_t magic_;
+        std::uint32_t version_;
+        std::uint32_t frame_size_;
+        std::uint32_t reserved_;
+    };
+
+    /**
+     * \brief Format a trace record as readable text.
+     */
+    std::string format_btrace_frame(const btrace_frame &frame);
+
+    /**
+     * \brief Read all frames of a trace file.
+     *
+     * \param stream The stream to read the trace file from.
+     * \param frames Vector to append the frames to.
+     *
+     * \returns False if the header is not valid.
+     */
+    bool read_btrace_file(common::ro_stream *stream, std::vector<btrace_frame> &frames);
+
+    /**
+     * \brief Collects BTrace records and writes them to a binary trace file on the host.
+     *
+     * Records are pushed into a lock-free ring buffer, and a separate thread drains it to the file,
+     * so tracing threads never wait on I/O. Records of filtered out categories are dropped before
+     * anything else is done with them. When the buffer is full, new records are dropped and counted.
+     */
+    class btrace {
+    public:
+        static constexpr std::size_t RING_CAPACITY = 1 << 14;
+        static constexpr std::size_t DRAIN_BATCH_SIZE = 512;
+
+    private:
         io_system *io_;
         kernel_system *kern_;
 
-        symfile trace_;
+        std::array<std::atomic<std::uint32_t>, BTRACE_CATEGORY_COUNT / 32> filter_;
+
+        std::unique_ptr<lockfree_ring_buffer<btrace_frame, RING_CAPACITY>> frames_;
+        std::atomic<std::uint64_t> dropped_count_;
+
+        std::ofstream trace_;
+        std::thread drain_thread_;
+
+        std::mutex drain_lock_;
+        std::condition_variable drain_cond_;
+        bool drain_stop_;
+
+        bool session_active_; ///< Only touched by the tracing side. The drain thread owns the file while it runs.
+
+        void drain_loop();
+        void drain_pending();
 
     public:
         explicit btrace(kernel_system *kern, io_system *io);
         ~btrace();
 
+        /**
+         * \brief Open a trace file and start writing records to it.
+         *
+         * \param trace_path Path of the trace file, on the guest filesystem.
+         * \returns False if a session is already running, or the file can't be created.
+         */
         bool start_trace_session(const std::u16string &trace_path);
         bool close_trace_session();
 
+        /**
+         * \brief Enable or disable tracing of a category.
+         */
+        void set_filter(const std::uint8_t category, const bool enable);
+
+        /**
+         * \brief Check if records of a category are traced.
+         */
+        bool filter(const std::uint8_t category) const;
+
+        /**
+         * \brief Trace a record.
+         * \returns False if the category is filtered out, or no session could be started.
+         */
         bool out(const std::uint32_t a0, const std::uint32_t a1, const std::uint32_t a2,
             const std::uint32_t a3);
+
+        std::uint64_t dropped_count() const {
+            return dropped_count_.load(std::memory_order_relaxed);
+        }
     };
-}
\ No newline at end of file
+}
@@ -31,6 +31,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace eka2l1 {
     using address = uint32_t;
@@ -161,6 +162,40 @@ namespace eka2l1 {
             const std::uint32_t top_offset() const;
 
             void *host_base();
+
+            /*! \brief Track guest writes to this chunk at page granularity.
+             *
+             * Only works for chunks with the same base address in every process.
+             * \returns false if the chunk can't be tracked.
+            */
+            bool enable_write_tracking();
+            bool is_write_tracked() const;
+
+            /*! \brief Collect the ranges written by the guest since the given stamp.
+             *
+             * \param offset The offset of the region to check, relative to the chunk base.
+             * \param size The size of the region to check.
+             * \param since Stamp returned by the last collection of this region, 0 for the first time.
+             * \param written Receive the written ranges.
+             * \returns The stamp to use on the next collection of this region.
+            */
+            std::uint64_t collect_written_pages(const std::size_t offset, const std::size_t size, const std::uint64_t since,
+                std::vector<mem::written_range> &written);
+
+            /*! \brief Fill the pages of this chunk only when they are first accessed.
+             *
+             * The chunk must be committed as a single range, and not run yet.
+             * \param handler Called to fill a range of the chunk, with the offset and size of the range
+             *                and its host pointer.
+             * \returns false if the chunk can't be demand paged.
+            */
+            bool enable_demand_paging(mem::mem_model_chunk::page_in_handler handler);
+
+            /*! \brief Fill all pages of a demand paged chunk not present yet.
+             *
+             * Call before accessing the chunk through its host base.
+            */
+            void page_in_all();
         };
     }
 }
@@ -24,10 +24,15 @@
 #include <mem/ptr.h>
 #include <utils/sec.h>
 
+#include <memory>
 #include <tuple>
 #include <vector>
 
 namespace eka2l1 {
+    namespace common {
+        class bytepair_page_store;
+    }
+
     namespace kernel {
         class chunk;
         class process;
@@ -80,8 +85,14 @@ namespace eka2l1::kernel {
 
         std::uint8_t *constant_data;
         std::uint8_t *code_data;
+
+        // If set, code loaded in RAM is decompressed from these pages when the guest first touches it,
+        // and code_data is not used.
+        std::shared_ptr<common::bytepair_page_store> code_pages;
     };
 
+    struct code_fixup;
+
     enum codeseg_state {
         codeseg_state_none,
         codeseg_state_attaching,
@@ -115,6 +126,7 @@ namespace eka2l1::kernel {
 
         std::unique_ptr<std::uint8_t[]> constant_data;
         std::unique_ptr<std::uint8_t[]> code_data;
+        std::shared_ptr<common::bytepair_page_store> code_pages;
 
         bool mark{ false };
 
@@ -133,6 +145,12 @@ namespace eka2l1::kernel {
 
         bool export_table_fixed_;
 
+        /*! \brief Decompress the code of an attach only when the guest touches it, applying the fixups then.
+         *
+         * Falls back to decompressing and fixing everything now if the chunk can't be demand paged.
+        */
+        void setup_code_demand_paging(chunk_ptr code_chunk, std::uint8_t *code_base_ptr, std::vector<code_fixup> fixups);
+
     public:
         /*! \brief Create a new codeseg
          *
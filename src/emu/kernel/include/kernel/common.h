@@ -39,8 +39,10 @@ namespace eka2l1 {
 }
 
 namespace eka2l1::hle {
+    using import_func = void (*)(kernel_system *, kernel::process *, arm::core *);
+
     struct epoc_import_func {
-        std::function<void(kernel_system *, kernel::process *, arm::core *)> func;
+        import_func func = nullptr;
         std::string name;
     };
 
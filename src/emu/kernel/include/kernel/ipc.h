@@ -23,7 +23,9 @@
 #include <kernel/common.h>
 
 #include <mem/ptr.h>
-#include <memory>
+
+#include <cstdint>
+#include <vector>
 
 namespace eka2l1 {
     namespace kernel {
@@ -129,5 +131,55 @@ namespace eka2l1 {
         explicit ipc_msg(kernel::thread *own);
     };
 
-    using ipc_msg_ptr = std::shared_ptr<ipc_msg>;
+    using ipc_msg_ptr = ipc_msg *;
+
+    /**
+     * @brief Fixed-size pool of IPC messages.
+     *
+     * All messages are allocated once and recycled through a free list, so creating and freeing
+     * a message never touches the heap. The handle given to the guest packs the slot index with
+     * a generation that is bumped each time the slot is reused, so stale handles are rejected
+     * instead of silently referring to a newer message. A valid handle is never zero.
+     */
+    class ipc_msg_pool {
+        static constexpr std::uint32_t HANDLE_INDEX_BITS = 12;
+        static constexpr std::uint32_t HANDLE_INDEX_MASK = (1 << HANDLE_INDEX_BITS) - 1;
+        static constexpr std::uint32_t HANDLE_GENERATION_MASK = 0x7FFFF;
+
+        std::vector<ipc_msg> msgs_;
+        std::vector<std::uint32_t> free_slots_;
+        std::vector<std::uint32_t> generations_;
+
+    public:
+        static constexpr std::uint32_t MAX_MESSAGES = 1 << HANDLE_INDEX_BITS;
+
+        explicit ipc_msg_pool();
+
+        /**
+         * @brief Take a free message from the pool.
+         *
+         * @param own The thread owning the message.
+         * @returns The message, or nullptr if the pool is exhausted.
+         */
+        ipc_msg_ptr allocate(kernel::thread *own);
+
+        /**
+         * @brief Return a message to the pool.
+         *
+         * Messages locked with ipc_msg::lock_free are left untouched.
+         *
+         * @param msg The message to free.
+         */
+        void free(ipc_msg_ptr msg);
+
+        /**
+         * @brief Get the message corresponding to a handle.
+         * @returns The message, or nullptr if the handle is invalid or out of date.
+         */
+        ipc_msg_ptr get(const std::int32_t handle);
+
+        std::size_t free_count() const {
+            return free_slots_.size();
+        }
+    };
 }
@@ -31,9 +31,12 @@
 #include <kernel/msgqueue.h>
 #include <kernel/mutex.h>
 #include <kernel/object_ix.h>
+#include <kernel/object_lookup.h>
 #include <kernel/process.h>
 #include <kernel/scheduler.h>
 #include <kernel/sema.h>
+#include <kernel/smp/balancer.h>
+#include <kernel/smp/core.h>
 #include <kernel/timer.h>
 
 #include <kernel/property.h>
@@ -43,6 +46,7 @@
 #include <common/types.h>
 #include <common/container.h>
 #include <common/hash.h>
+#include <common/sync.h>
 #include <common/wildcard.h>
 
 #include <kernel/ipc.h>
@@ -238,6 +242,16 @@ namespace eka2l1 {
         void reset();
     };
 
+    /**
+     * @brief Snapshot of the work the guest has done since the kernel was created.
+     */
+    struct kernel_statistics {
+        std::uint64_t instructions_retired_ = 0;
+        std::uint64_t svc_calls_ = 0;
+        std::uint64_t ipc_messages_ = 0;
+        std::uint64_t context_switches_ = 0;
+    };
+
     class kernel_system {
     private:
         friend class debugger_base;
@@ -245,8 +259,8 @@ namespace eka2l1 {
         friend class gdbstub;
         friend class kernel::process;
 
-        std::array<ipc_msg_ptr, 0x1000> msgs_;
-        std::mutex kern_lock_;
+        ipc_msg_pool msg_pool_;
+        common::counted_mutex kern_lock_;
 
         std::vector<kernel_obj_unq_ptr> threads_;
         std::vector<kernel_obj_unq_ptr> processes_;
@@ -265,9 +279,19 @@ namespace eka2l1 {
         std::vector<kernel_obj_unq_ptr> logical_devices_;
         std::vector<kernel_obj_unq_ptr> logical_channels_;
 
+        kernel::object_id_table id_table_;
+        kernel::object_name_index name_index_;
+
+        void index_object(kernel_obj_ptr obj);
+        void unindex_object(kernel_obj_ptr obj);
+        void rebuild_name_index(const kernel::object_type type);
+
+        std::vector<kernel_obj_unq_ptr> *get_object_container(const kernel::object_type type);
+
         std::unique_ptr<kernel::btrace> btrace_inst_;
         std::unique_ptr<hle::lib_manager> lib_mngr_;
-        std::unique_ptr<kernel::thread_scheduler> thr_sch_;
+        std::vector<std::unique_ptr<kernel::thread_scheduler>> thr_schs_; ///< Sub-scheduler of each core.
+        std::unique_ptr<kernel::smp::load_balancer> balancer_;
 
         ntimer *timing_;
         memory_system *mem_;
@@ -277,7 +301,7 @@ namespace eka2l1 {
         config::app_settings *app_settings_;
         disasm *disassembler_;
 
-        arm::core *cpu_;
+        std::vector<arm::core *> cores_;
         loader::rom *rom_info_;
 
         //! Handles for some globally shared processes
@@ -286,6 +310,7 @@ namespace eka2l1 {
 
         mutable std::atomic<kernel::uid> uid_counter_;
         void *rom_map_;
+        std::size_t rom_map_size_;
         std::uint64_t base_time_;
 
         epocver kern_ver_;
@@ -315,6 +340,12 @@ namespace eka2l1 {
         std::uint64_t inactivity_starts_;
         kernel::process *nanokern_pr_;
 
+        // Written by every core, so relaxed atomics rather than the kernel lock
+        std::atomic<std::uint64_t> instructions_retired_;
+        std::atomic<std::uint64_t> svc_calls_;
+        std::atomic<std::uint64_t> ipc_messages_;
+        std::atomic<std::uint64_t> context_switches_;
+
     protected:
         void setup_new_process(process_ptr pr);
         void setup_nanokern_controller();
@@ -324,17 +355,61 @@ namespace eka2l1 {
 
     public:
         explicit kernel_system(system *esys, ntimer *timing, io_system *io_sys, config::state *conf,
-            config::app_settings *settings, loader::rom *rom_info, arm::core *cpu, disasm *diassembler);
+            config::app_settings *settings, loader::rom *rom_info, const std::vector<arm::core *> &cores,
+            disasm *diassembler);
 
         ~kernel_system();
 
         void wipeout();
         void reset();
 
+        /**
+         * @brief Get the sub-scheduler of the core that the calling host thread runs.
+         */
         kernel::thread_scheduler *get_thread_scheduler() {
-            return thr_sch_.get();
+            return thr_schs_[kernel::smp::current_core()].get();
+        }
+
+        kernel::thread_scheduler *get_thread_scheduler(const std::uint32_t core_index) {
+            return thr_schs_[core_index].get();
         }
 
+        /**
+         * @brief Choose the sub-scheduler that a new thread will run on.
+         * 
+         * The least loaded core is picked. The thread stays on this core for its lifetime.
+         */
+        kernel::thread_scheduler *pick_thread_scheduler();
+
+        kernel::smp::load_balancer *get_load_balancer() {
+            return balancer_.get();
+        }
+
+        std::uint32_t get_core_count() const {
+            return static_cast<std::uint32_t>(cores_.size());
+        }
+
+        void add_instructions_retired(const std::uint64_t count) {
+            instructions_retired_.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        void count_svc_call() {
+            svc_calls_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void count_ipc_message() {
+            ipc_messages_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void count_context_switch() {
+            context_switches_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Get the guest throughput counters. Not reset when the kernel is reset.
+         */
+        kernel_statistics get_statistics() const;
+
         void cpu_exception_handler(arm::core *core, arm::exception_type exception_type, const std::uint32_t exception_data);
 
         void call_ipc_send_callbacks(const std::string &server_name, const int ord, const ipc_arg &args,
@@ -367,6 +442,18 @@ namespace eka2l1 {
         ldd::factory_instantiate_func suitable_ldd_instantiate_func(const char *name);
 
         kernel::uid next_uid() const;
+
+        /**
+         * @brief Notify that the full name of an object may have changed.
+         *
+         * Must be called after anything that affects kernel_obj::full_name of a registered object,
+         * such as a rename or an owner/access type change, so that the name index stays correct.
+         *
+         * @param obj The object whose name changed.
+         */
+        void object_name_changed(kernel_obj_ptr obj);
+
+        kernel_obj_ptr get_by_full_name_raw(const std::string &name, const kernel::object_type obj_type);
         std::uint64_t home_time();
         void set_base_time(std::uint64_t time);
 
@@ -449,6 +536,18 @@ namespace eka2l1 {
          */
         arm::core *get_cpu();
 
+        arm::core *get_cpu(const std::uint32_t core_index) {
+            return cores_[core_index];
+        }
+
+        /**
+         * @brief Invalidate translated code of an address range, on all cores.
+         * 
+         * @param addr The start address of the range.
+         * @param size The size of the range.
+         */
+        void imb_range(const address addr, const std::uint32_t size);
+
         int get_ipc_realtime_signal_event() const {
             return realtime_ipc_signal_evt_;
         }
@@ -527,43 +626,7 @@ namespace eka2l1 {
 
         template <typename T>
         T *get_by_name_and_type(const std::string &name, const kernel::object_type obj_type) {
-            switch (obj_type) {
-#define OBJECT_SEARCH(obj_type, obj_map)                                               \
-    case kernel::object_type::obj_type: {                                              \
-        auto res = std::find_if(obj_map.begin(), obj_map.end(), [&](const auto &rhs) { \
-            std::string the_full_name;                                                 \
-            rhs->full_name(the_full_name);                                             \
-            return the_full_name == name;                                              \
-        });                                                                            \
-        if (res == obj_map.end())                                                      \
-            return nullptr;                                                            \
-        return reinterpret_cast<T *>(res->get());                                      \
-    }
-
-                OBJECT_SEARCH(mutex, mutexes_)
-                OBJECT_SEARCH(sema, semas_)
-                OBJECT_SEARCH(chunk, chunks_)
-                OBJECT_SEARCH(thread, threads_)
-                OBJECT_SEARCH(process, processes_)
-                OBJECT_SEARCH(change_notifier, change_notifiers_)
-                OBJECT_SEARCH(library, libraries_)
-                OBJECT_SEARCH(codeseg, codesegs_)
-                OBJECT_SEARCH(server, servers_)
-                OBJECT_SEARCH(prop, props_)
-                OBJECT_SEARCH(prop_ref, prop_refs_)
-                OBJECT_SEARCH(session, sessions_)
-                OBJECT_SEARCH(timer, timers_)
-                OBJECT_SEARCH(msg_queue, message_queues_)
-                OBJECT_SEARCH(logical_device, logical_devices_)
-                OBJECT_SEARCH(logical_channel, logical_channels_)
-
-#undef OBJECT_SEARCH
-
-            default:
-                break;
-            }
-
-            return nullptr;
+            return reinterpret_cast<T *>(get_by_full_name_raw(name, obj_type));
         }
 
         /*! \brief Get kernel object by name
@@ -578,46 +641,13 @@ namespace eka2l1 {
         */
         template <typename T>
         T *get_by_id(const kernel::uid uid) {
-            const kernel::object_type obj_type = get_object_type<T>();
-
-            switch (obj_type) {
-                // It's gurantee that object are sorted by unique id, by just adding it
-                // Deletion will not affect that fact.
-#define OBJECT_SEARCH(obj_type, obj_map)                                                                             \
-    case kernel::object_type::obj_type: {                                                                            \
-        auto res = std::lower_bound(obj_map.begin(), obj_map.end(), nullptr, [&](const auto &lhs, const auto &rhs) { \
-            return lhs->unique_id() < uid;                                                                           \
-        });                                                                                                          \
-        if (res != obj_map.end()) {                                                                                  \
-            return reinterpret_cast<T *>(res->get());                                                                \
-        }                                                                                                            \
-        return nullptr;                                                                                              \
-    }
+            kernel_obj_ptr obj = id_table_.get(uid);
 
-                OBJECT_SEARCH(mutex, mutexes_)
-                OBJECT_SEARCH(sema, semas_)
-                OBJECT_SEARCH(chunk, chunks_)
-                OBJECT_SEARCH(thread, threads_)
-                OBJECT_SEARCH(process, processes_)
-                OBJECT_SEARCH(change_notifier, change_notifiers_)
-                OBJECT_SEARCH(library, libraries_)
-                OBJECT_SEARCH(codeseg, codesegs_)
-                OBJECT_SEARCH(server, servers_)
-                OBJECT_SEARCH(prop, props_)
-                OBJECT_SEARCH(prop_ref, prop_refs_)
-                OBJECT_SEARCH(session, sessions_)
-                OBJECT_SEARCH(timer, timers_)
-                OBJECT_SEARCH(msg_queue, message_queues_)
-                OBJECT_SEARCH(logical_device, logical_devices_)
-                OBJECT_SEARCH(logical_channel, logical_channels_)
-
-#undef OBJECT_SEARCH
-
-            default:
-                break;
+            if (!obj || (obj->get_object_type() != get_object_type<T>())) {
+                return nullptr;
             }
 
-            return nullptr;
+            return reinterpret_cast<T *>(obj);
         }
 
         template <typename T>
@@ -628,6 +658,7 @@ namespace eka2l1 {
     case type:                                                     \
         additional_setup;                                          \
         container.push_back(std::move(obj));                       \
+        index_object(container.back().get());                      \
         return reinterpret_cast<T *>(container.back().get());
 
             switch (obj_type) {
@@ -693,6 +724,10 @@ namespace eka2l1 {
             kern_lock_.unlock();
         }
 
+        common::counted_mutex &get_kernel_lock() {
+            return kern_lock_;
+        }
+
         void stop_cores_idling();
         bool should_core_idle_when_inactive();
 
@@ -127,19 +127,19 @@ namespace eka2l1 {
                 return access;
             }
 
-            void set_access_type(kernel::access_type acc) {
-                access = acc;
-            }
+            void set_access_type(kernel::access_type acc);
 
             object_type get_object_type() const {
                 return obj_type;
             }
 
-            // WARNING: This function have not ever set child owner. Child owner stays the same.
-            void set_owner(kernel_obj *new_owner) {
-                owner = new_owner;
+            kernel_obj *get_owner() const {
+                return owner;
             }
 
+            // WARNING: This function have not ever set child owner. Child owner stays the same.
+            void set_owner(kernel_obj *new_owner);
+
             void full_name(std::string &name_will_full);
 
             void increase_access_count() { access_count++; }
@@ -155,9 +155,7 @@ namespace eka2l1 {
              * @brief Rename the kernel object. 
              * @param new_name The new name of object.
              */
-            virtual void rename(const std::string &new_name) {
-                obj_name = new_name;
-            }
+            virtual void rename(const std::string &new_name);
 
             virtual void do_state(common::chunkyseri &seri);
         };
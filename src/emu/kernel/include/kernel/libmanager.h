@@ -24,6 +24,7 @@
 #include <common/container.h>
 
 #include <kernel/common.h>
+#include <kernel/svc_table.h>
 #include <mem/ptr.h>
 
 #include <functional>
@@ -127,7 +128,7 @@ namespace eka2l1 {
             void apply_trick_or_treat_algo();
 
         public:
-            std::map<sid, epoc_import_func> svc_funcs_;
+            svc_table svc_funcs_;
             std::vector<std::u16string> search_paths;
 
             explicit lib_manager(kernel_system *kern, io_system *ios, memory_system *mems);
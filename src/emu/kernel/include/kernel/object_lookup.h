@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <kernel/common.h>
+#include <kernel/kernel_obj.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace eka2l1::kernel {
+    static constexpr std::size_t OBJECT_TYPE_COUNT = static_cast<std::size_t>(object_type::unk) + 1;
+
+    /**
+     * @brief Map from unique ID to live kernel object, by direct indexing.
+     *
+     * IDs come from a monotonic counter, so the ID space is split into fixed-size slabs.
+     * Each slab is a flat array of object pointers, and is freed once its last object is removed.
+     */
+    class object_id_table {
+        static constexpr std::uint32_t SLAB_SHIFT = 10;
+        static constexpr std::uint32_t SLAB_SIZE = 1 << SLAB_SHIFT;
+        static constexpr std::uint32_t SLAB_MASK = SLAB_SIZE - 1;
+
+        struct slab {
+            std::array<kernel_obj *, SLAB_SIZE> objects_{};
+            std::uint32_t live_count_ = 0;
+        };
+
+        std::vector<std::unique_ptr<slab>> slabs_;
+
+    public:
+        void add(kernel_obj *obj);
+        void remove(kernel_obj *obj);
+        void clear();
+
+        kernel_obj *get(const kernel::uid id) const {
+            const std::uint64_t slab_index = id >> SLAB_SHIFT;
+
+            if ((slab_index >= slabs_.size()) || !slabs_[slab_index]) {
+                return nullptr;
+            }
+
+            return slabs_[slab_index]->objects_[id & SLAB_MASK];
+        }
+    };
+
+    /**
+     * @brief Hash index of kernel objects by their full name, per object type.
+     *
+     * Full names depend on the owner chain, so an object changing name (or its owner changing name)
+     * makes the entries of it and its children outdated. Every rename goes through the kernel, which
+     * reindexes the object and its children, so a lookup miss can be trusted.
+     *
+     * Candidates are still verified against their current full name on lookup. A mismatch marks
+     * the type stale instead of returning a wrong object, and a stale type is rebuilt on its next lookup.
+     */
+    class object_name_index {
+        std::array<std::unordered_multimap<std::string, kernel_obj *>, OBJECT_TYPE_COUNT> names_;
+        std::unordered_map<kernel_obj *, std::string> keys_;
+
+        std::array<bool, OBJECT_TYPE_COUNT> stale_{};
+
+    public:
+        void add(kernel_obj *obj);
+        void remove(kernel_obj *obj);
+
+        /**
+         * @brief Remove all entries of an object type, and mark the type as fresh.
+         * @param type The object type to clear.
+         */
+        void clear(const object_type type);
+        void clear();
+
+        /**
+         * @brief Update the index entries of an object and the objects it owns, after its name changed.
+         * @param obj The object to reindex.
+         */
+        void reindex(kernel_obj *obj);
+
+        /**
+         * @brief Check if an object's full name differs from the one it is indexed with.
+         * @param obj The object to check.
+         * @returns False if the name is the same, or the object is not indexed.
+         */
+        bool name_changed(kernel_obj *obj);
+
+        /**
+         * @brief Find the object with lowest unique ID having the given full name.
+         *
+         * @param full_name The full name to search for.
+         * @param type      The type of object to search in.
+         *
+         * @returns The object on success. Nullptr if there is none, or the type turned out to be stale.
+         */
+        kernel_obj *find(const std::string &full_name, const object_type type);
+
+        bool stale(const object_type type) const {
+            return stale_[static_cast<std::size_t>(type)];
+        }
+    };
+}
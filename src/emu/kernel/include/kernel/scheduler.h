@@ -76,6 +76,18 @@ namespace eka2l1 {
         protected:
             kernel::thread *next_ready_thread();
             void switch_context(kernel::thread *oldt, kernel::thread *newt);
+
+            /**
+             * \brief Check if the core should sleep while it has no thread to run.
+             * 
+             * Secondary cores always do, there is nothing else for their host thread to do.
+             */
+            bool idles_when_inactive() const;
+
+            /**
+             * \brief Stop the core so it reschedules, from whichever host thread we are on.
+             */
+            void halt_core();
             void call_process_switch_callbacks(kernel::process *old, kernel::process *new_one);
 
         public:
@@ -25,6 +25,9 @@
 
 #include <utils/reqsts.h>
 
+#include <common/profiler.h>
+#include <common/sync.h>
+
 #include <functional>
 #include <queue>
 #include <string>
@@ -47,7 +50,7 @@ namespace eka2l1 {
         struct ipc_context;
 
         using ipc_func_wrapper = std::function<void(ipc_context &)>;
-        using ipc_msg_ptr = std::shared_ptr<ipc_msg>;
+        using ipc_msg_ptr = ipc_msg *;
 
         /*! \brief A class represents an IPC function */
         struct ipc_func {
@@ -114,6 +117,9 @@ namespace eka2l1 {
             ipc_msg_ptr process_msg;
             std::unordered_map<int, ipc_func> ipc_funcs;
 
+            /** Timer of message processing, one per server */
+            common::profile_token profile_token_;
+
         private:
             eka2l1::ptr<epoc::request_status> request_status = 0;
             eka2l1::ptr<message2> request_data;
@@ -126,6 +132,8 @@ namespace eka2l1 {
             bool hle = false;
             bool unhandle_callback_enable = false;
 
+            common::counted_mutex server_lock_;
+
         protected:
             bool is_msg_delivered(ipc_msg_ptr &msg);
             bool ready();
@@ -181,6 +189,17 @@ namespace eka2l1 {
             bool is_hle() const {
                 return hle;
             }
+
+            /*! \brief Get the lock guarding the state of this server.
+             *
+             *  HLE messages are processed with both the kernel lock and this lock held. Host threads that only
+             *  touch the server state can take this lock alone, and not stall system calls to other servers.
+             *
+             *  The kernel lock must always be taken first. Never take the kernel lock while holding this one.
+            */
+            common::counted_mutex &server_lock() {
+                return server_lock_;
+            }
         };
     }
 }
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace eka2l1::kernel::smp {
+    /**
+     * \brief Calculate the load unit of an activity over a period.
+     * 
+     * Unit = ((delta * 4095) + (delta_time / 2)) / delta_time, with both inputs shifted down to 20 bits
+     * first. Half of the period is added so that a small but non-zero activity does not round down to 0.
+     * 
+     * \param delta      Time spent in the activity during the period.
+     * \param delta_time The length of the period.
+     * 
+     * \returns The load unit, from 0 to 4095.
+     */
+    std::uint32_t calculate_load_unit(std::uint64_t delta, std::uint64_t delta_time);
+
+    /**
+     * \brief Pick the core that new threads are placed on.
+     * 
+     * The load of each core is the time it spent running guest code between the last two balances, in
+     * load units. A thread placed on a core counts as extra load until the next balance, so a burst of
+     * new threads spreads across cores instead of piling on the core that was idle.
+     * 
+     * Threads are not migrated once placed. See the README for the rest of the Symbian balancer.
+     */
+    class load_balancer {
+        std::vector<std::atomic<std::uint64_t>> run_ticks_; ///< Ticks each core ran since last balance.
+        std::vector<std::uint32_t> loads_; ///< Load units of each core, measured in last balance.
+        std::vector<std::uint32_t> placed_; ///< Load units placed on each core since last balance.
+
+        std::uint64_t balance_period_;
+        std::uint64_t last_balance_;
+
+    public:
+        static constexpr std::uint32_t NEW_THREAD_LOAD_UNIT = 256;
+
+        /**
+         * \brief Construct the balancer.
+         * 
+         * \param num_cores      Number of cores to balance between.
+         * \param balance_period Minimum number of ticks between two balances.
+         */
+        explicit load_balancer(const std::uint32_t num_cores, const std::uint64_t balance_period);
+
+        /**
+         * \brief Account ticks that a core spent running guest code. Safe to call from any core.
+         * 
+         * \param core_index The index of the core.
+         * \param ticks      Number of ticks executed.
+         */
+        void add_run_ticks(const std::uint32_t core_index, const std::uint64_t ticks);
+
+        /**
+         * \brief Measure load of all cores, if a balance period has passed since the last measure.
+         * \param now Current ticks.
+         */
+        void balance(const std::uint64_t now);
+
+        /**
+         * \brief   Choose the least loaded core, and account a new thread on it.
+         * \returns The index of the core.
+         */
+        std::uint32_t pick_core();
+
+        std::uint32_t get_load(const std::uint32_t core_index) const;
+
+        std::uint32_t num_cores() const {
+            return static_cast<std::uint32_t>(loads_.size());
+        }
+    };
+}
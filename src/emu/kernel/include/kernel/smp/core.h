@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace eka2l1::kernel::smp {
+    static constexpr std::uint32_t MAX_CORE_COUNT = 8;
+
+    /**
+     * \brief Bind the calling host thread to a guest core.
+     * 
+     * Each guest core runs on its own host thread. Kernel calls that depend on the running core (current
+     * thread, current process, the CPU) use the core bound to the calling thread. Host threads that
+     * never bind to a core, like the timer or the UI, see core 0.
+     * 
+     * \param core_index The index of the core.
+     */
+    void set_current_core(const std::uint32_t core_index);
+
+    /**
+     * \brief   Get the guest core bound to the calling host thread.
+     * \returns The index of the core.
+     */
+    std::uint32_t current_core();
+
+    /**
+     * \brief   Check if the calling host thread is the one running a guest core, as bound by set_current_core.
+     */
+    bool is_core_thread();
+}
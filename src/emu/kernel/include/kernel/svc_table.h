@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <kernel/common.h>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace eka2l1::hle {
+    static constexpr std::uint32_t SVC_HISTOGRAM_BUCKET_COUNT = 16;
+
+    /**
+     * @brief Profiling data of a supervisor call.
+     *
+     * Histogram bucket 0 counts calls shorter than 256ns. Each next bucket doubles the upper bound,
+     * and the last bucket takes everything longer.
+     */
+    struct svc_stat {
+        std::uint64_t calls_ = 0;
+        std::uint64_t total_ns_ = 0;
+        std::array<std::uint64_t, SVC_HISTOGRAM_BUCKET_COUNT> histogram_{};
+
+        void record(const std::uint64_t ns);
+    };
+
+    /**
+     * @brief Dense dispatch table of HLE supervisor calls.
+     *
+     * SVC numbers are split into banks by bits 16-23, like the executive call ranges on real hardware:
+     * bank 0x00 holds slow executive calls, bank 0x80 holds fast executive calls (and 0xC0 the EKA1
+     * leaving calls). Each bank is a flat array indexed by the low 16 bits of the SVC number,
+     * so a call is dispatched with two array lookups.
+     */
+    class svc_table {
+        static constexpr std::uint32_t BANK_SHIFT = 16;
+        static constexpr std::uint32_t BANK_COUNT = 256;
+        static constexpr std::uint32_t BANK_INDEX_MASK = (1 << BANK_SHIFT) - 1;
+
+        struct svc_bank {
+            std::vector<epoc_import_func> funcs_;
+            std::vector<svc_stat> stats_;
+        };
+
+        std::array<std::unique_ptr<svc_bank>, BANK_COUNT> banks_;
+
+    public:
+        using svc_iterate_func = std::function<void(const std::uint32_t, const epoc_import_func &, const svc_stat &)>;
+
+        void add(const std::uint32_t svc_num, const epoc_import_func &func);
+        void add(const func_map &funcs);
+        void clear();
+
+        const epoc_import_func *get(const std::uint32_t svc_num) const {
+            if (svc_num >= (BANK_COUNT << BANK_SHIFT)) {
+                return nullptr;
+            }
+
+            const svc_bank *bank = banks_[svc_num >> BANK_SHIFT].get();
+            const std::uint32_t index = svc_num & BANK_INDEX_MASK;
+
+            if (!bank || (index >= bank->funcs_.size()) || !bank->funcs_[index].func) {
+                return nullptr;
+            }
+
+            return &bank->funcs_[index];
+        }
+
+        /**
+         * @brief Record the time spent in a supervisor call.
+         *
+         * @param svc_num The SVC number. Must have been added to the table.
+         * @param ns      The call duration, in nanoseconds.
+         */
+        void record(const std::uint32_t svc_num, const std::uint64_t ns) {
+            banks_[svc_num >> BANK_SHIFT]->stats_[svc_num & BANK_INDEX_MASK].record(ns);
+        }
+
+        void reset_stats();
+
+        /**
+         * @brief Iterate through all registered supervisor calls, in ascending order.
+         * @param func The callback receiving the SVC number, its function and statistics.
+         */
+        void for_each(svc_iterate_func func) const;
+    };
+}
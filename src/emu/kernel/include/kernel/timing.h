@@ -27,6 +27,7 @@
 #include <functional>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace eka2l1 {
@@ -59,6 +60,71 @@ namespace eka2l1 {
         class chunkyseri;
     }
 
+    /**
+     * @brief Priority queue of timed events, ordered by fire time.
+     * 
+     * This is an indexed 4-ary min-heap. Each scheduled event is also indexed by its
+     * (event type, userdata) key, so both scheduling and cancelling are O(log n), and peeking
+     * the next event is O(1). Events with the same fire time are fired in the order they were scheduled.
+     */
+    class event_queue {
+    private:
+        static constexpr std::uint32_t INVALID_SLOT = 0xFFFFFFFF;
+        static constexpr std::size_t HEAP_ARITY = 4;
+
+        struct event_slot {
+            event evt_;
+            std::uint64_t sequence_;
+            std::size_t heap_pos_;
+            std::uint32_t next_same_key_;
+        };
+
+        struct event_key_hash {
+            std::size_t operator()(const std::pair<int, std::uint64_t> &key) const {
+                return std::hash<std::uint64_t>{}(key.second * 0x9E3779B97F4A7C15ULL ^ static_cast<std::uint64_t>(key.first));
+            }
+        };
+
+        std::vector<event_slot> slots_;
+        std::vector<std::uint32_t> free_slots_;
+        std::vector<std::uint32_t> heap_;
+
+        std::unordered_map<std::pair<int, std::uint64_t>, std::uint32_t, event_key_hash> key_index_;
+        std::uint64_t sequence_counter_;
+
+        bool is_before(const std::uint32_t lhs, const std::uint32_t rhs) const;
+
+        void place(const std::size_t pos, const std::uint32_t slot);
+        void sift_up(std::size_t pos);
+        void sift_down(std::size_t pos);
+
+        void unlink_key(const std::uint32_t slot);
+        void remove_at(const std::size_t pos);
+
+    public:
+        explicit event_queue();
+
+        void push(const event &evt);
+
+        /**
+         * @brief Remove one scheduled event with the given key.
+         * @returns True if an event was found and removed.
+         */
+        bool remove(const int event_type, const std::uint64_t userdata);
+
+        const event &top() const;
+        void pop();
+        void clear();
+
+        bool empty() const {
+            return heap_.empty();
+        }
+
+        std::size_t size() const {
+            return heap_.size();
+        }
+    };
+
     class ntimer;
 
     /**
@@ -66,7 +132,7 @@ namespace eka2l1 {
      */
     class ntimer {
     private:
-        std::vector<event> events_;
+        event_queue events_;
         std::mutex lock_;
 
         common::event new_event_evt_;
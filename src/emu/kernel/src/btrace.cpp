@@ -1,61 +1,238 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <common/buffer.h>
+#include <common/cvt.h>
 #include <common/log.h>
+#include <common/thread.h>
+
+#include <config/config.h>
 #include <kernel/btrace.h>
+#include <kernel/kernel.h>
+
+#include <chrono>
 
 namespace eka2l1::kernel {
+    static constexpr const char *BTRACE_DRAIN_THREAD_NAME = "BTrace drain thread";
+    static constexpr std::chrono::milliseconds BTRACE_DRAIN_INTERVAL(20);
+
+    std::string format_btrace_frame(const btrace_frame &frame) {
+        return fmt::format("Trace out (data size = {}, flags = {}, category = {}, subcategory = {}):\n"
+                           "\ta1 = 0x{:X}\n"
+                           "\ta2 = 0x{:X}\n"
+                           "\ta3 = 0x{:X}\n",
+            frame.header_field(btrace_header_size_index), frame.header_field(btrace_header_flag_index),
+            frame.header_field(btrace_header_category_index), frame.header_field(btrace_header_subcategory_index),
+            frame.a1_, frame.a2_, frame.a3_);
+    }
+
+    bool read_btrace_file(common::ro_stream *stream, std::vector<btrace_frame> &frames) {
+        btrace_file_header header;
+
+        if (stream->read(&header, sizeof(header)) != sizeof(header)) {
+            return false;
+        }
+
+        if ((header.magic_ != BTRACE_FILE_MAGIC) || (header.version_ != BTRACE_FILE_VERSION)
+            || (header.frame_size_ != sizeof(btrace_frame))) {
+            return false;
+        }
+
+        btrace_frame frame;
+
+        while (stream->read(&frame, sizeof(frame)) == sizeof(frame)) {
+            frames.push_back(frame);
+        }
+
+        return true;
+    }
+
     btrace::btrace(kernel_system *kern, io_system *io)
         : io_(io)
         , kern_(kern)
-        , trace_(nullptr) {
+        , dropped_count_(0)
+        , drain_stop_(false)
+        , session_active_(false) {
+        for (auto &filter_bits : filter_) {
+            filter_bits.store(0xFFFFFFFF, std::memory_order_relaxed);
+        }
+
+        config::state *conf = kern_ ? kern_->get_config() : nullptr;
+
+        // An empty list traces every category
+        if (conf && !conf->btrace_categories.empty()) {
+            for (auto &filter_bits : filter_) {
+                filter_bits.store(0, std::memory_order_relaxed);
+            }
+
+            for (const int category : conf->btrace_categories) {
+                if ((category >= 0) && (category < static_cast<int>(BTRACE_CATEGORY_COUNT))) {
+                    set_filter(static_cast<std::uint8_t>(category), true);
+                }
+            }
+        }
     }
 
     btrace::~btrace() {
         close_trace_session();
     }
 
+    void btrace::set_filter(const std::uint8_t category, const bool enable) {
+        const std::uint32_t mask = 1u << (category & 31);
+
+        if (enable) {
+            filter_[category >> 5].fetch_or(mask, std::memory_order_relaxed);
+        } else {
+            filter_[category >> 5].fetch_and(~mask, std::memory_order_relaxed);
+        }
+    }
+
+    bool btrace::filter(const std::uint8_t category) const {
+        return filter_[category >> 5].load(std::memory_order_relaxed) & (1u << (category & 31));
+    }
+
     bool btrace::start_trace_session(const std::u16string &trace_path) {
-        if (trace_) {
+        if (session_active_) {
+            return false;
+        }
+
+        const std::optional<std::u16string> host_path = io_->get_raw_path(trace_path);
+
+        if (!host_path) {
+            LOG_ERROR(KERNEL, "Can't find the host path of BTrace file {}", common::ucs2_to_utf8(trace_path));
+            return false;
+        }
+
+        trace_.open(common::ucs2_to_utf8(host_path.value()), std::ios::binary | std::ios::trunc);
+
+        if (!trace_.is_open()) {
+            LOG_ERROR(KERNEL, "Unable to create BTrace file {}", common::ucs2_to_utf8(host_path.value()));
             return false;
         }
 
-        trace_ = io_->open_file(trace_path, WRITE_MODE);
-        return (trace_ != nullptr);
+        btrace_file_header header;
+        header.magic_ = BTRACE_FILE_MAGIC;
+        header.version_ = BTRACE_FILE_VERSION;
+        header.frame_size_ = sizeof(btrace_frame);
+        header.reserved_ = 0;
+
+        trace_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        if (!frames_) {
+            frames_ = std::make_unique<lockfree_ring_buffer<btrace_frame, RING_CAPACITY>>();
+        }
+
+        dropped_count_ = 0;
+        drain_stop_ = false;
+        session_active_ = true;
+
+        drain_thread_ = std::thread([this]() {
+            drain_loop();
+        });
+
+        return true;
     }
 
     bool btrace::close_trace_session() {
-        if (!trace_) {
+        if (!session_active_) {
             return false;
         }
 
-        return trace_->close();
+        session_active_ = false;
+
+        {
+            const std::lock_guard<std::mutex> guard(drain_lock_);
+            drain_stop_ = true;
+        }
+
+        drain_cond_.notify_one();
+        drain_thread_.join();
+
+        // Records pushed while the thread was stopping
+        drain_pending();
+
+        if (dropped_count_ != 0) {
+            LOG_WARN(KERNEL, "{} BTrace records were dropped because the trace buffer was full", dropped_count_.load());
+        }
+
+        trace_.close();
+        return true;
     }
 
-    static const std::u16string DEFAULT_TRACE_FILE = u"c:\\btrace.txt";
+    void btrace::drain_pending() {
+        std::array<btrace_frame, DRAIN_BATCH_SIZE> batch;
+        std::size_t count = 0;
+
+        do {
+            count = 0;
+
+            while ((count < batch.size()) && frames_->pop(batch[count])) {
+                count++;
+            }
+
+            if (count != 0) {
+                trace_.write(reinterpret_cast<const char *>(batch.data()), count * sizeof(btrace_frame));
+            }
+        } while (count == batch.size());
+
+        trace_.flush();
+    }
+
+    void btrace::drain_loop() {
+        common::set_thread_name(BTRACE_DRAIN_THREAD_NAME);
+
+        std::unique_lock<std::mutex> ulock(drain_lock_);
+
+        while (!drain_stop_) {
+            drain_cond_.wait_for(ulock, BTRACE_DRAIN_INTERVAL);
+
+            ulock.unlock();
+            drain_pending();
+            ulock.lock();
+        }
+    }
+
+    static const std::u16string DEFAULT_TRACE_FILE = u"c:\\btrace.bin";
 
     bool btrace::out(const std::uint32_t a0, const std::uint32_t a1, const std::uint32_t a2,
         const std::uint32_t a3) {
-        if (!trace_ && !start_trace_session(DEFAULT_TRACE_FILE)) {
+        // Filter first, so disabled categories cost nothing more
+        const std::uint8_t category = static_cast<std::uint8_t>(a0 >> (btrace_header_category_index * 8));
+
+        if (!filter(category)) {
             return false;
         }
 
-        // Check out the header
-        const std::uint32_t args_size = (a0 >> (btrace_header_size_index * 8)) & 0xFF;
-        const std::uint32_t flags = (a0 >> (btrace_header_flag_index * 8)) & 0xFF;
-        const std::uint32_t category = (a0 >> (btrace_header_category_index * 8)) & 0xFF;
-        const std::uint32_t subcategory = (a0 >> (btrace_header_subcategory_index * 8)) & 0xFF;
-
-        if (trace_) {
-            std::string message = "Trace out (data size = {}, flags = {}, category = {}, subcategory = {}):\n"
-                                  "\ta1 = 0x{:X}\n"
-                                  "\ta2 = 0x{:X}\n"
-                                  "\ta3 = 0x{:X}\n"
-                                  "\n";
+        if (!session_active_ && !start_trace_session(DEFAULT_TRACE_FILE)) {
+            return false;
+        }
 
-            message = fmt::format(message, args_size, flags, category, subcategory, a1, a2, a3);
-            trace_->write_file(&message[0], static_cast<std::uint32_t>(message.size()), 1);
+        if (!frames_->push(btrace_frame{ a0, a1, a2, a3 })) {
+            dropped_count_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
 
-            trace_->flush();
+        // Wake the drain thread early, before the buffer fills up
+        if (frames_->size() == RING_CAPACITY / 2) {
+            drain_cond_.notify_one();
         }
 
         return true;
     }
-}
\ No newline at end of file
+}
@@ -213,5 +213,26 @@ namespace eka2l1 {
         void *chunk::host_base() {
             return mmc_impl_->host_base();
         }
+
+        bool chunk::enable_write_tracking() {
+            return mmc_impl_->enable_write_tracking();
+        }
+
+        bool chunk::is_write_tracked() const {
+            return mmc_impl_->is_write_tracked();
+        }
+
+        std::uint64_t chunk::collect_written_pages(const std::size_t offset, const std::size_t size, const std::uint64_t since,
+            std::vector<mem::written_range> &written) {
+            return mmc_impl_->collect_written_pages(offset, size, since, written);
+        }
+
+        bool chunk::enable_demand_paging(mem::mem_model_chunk::page_in_handler handler) {
+            return mmc_impl_->enable_demand_paging(owner ? get_own_process()->get_mem_model() : nullptr, std::move(handler));
+        }
+
+        void chunk::page_in_all() {
+            mmc_impl_->page_in_all();
+        }
     }
 }
@@ -19,6 +19,7 @@
  */
 
 #include <common/algorithm.h>
+#include <common/bytepair.h>
 #include <common/log.h>
 #include <kernel/kernel.h>
 #include <kernel/codeseg.h>
@@ -27,6 +28,25 @@
 #include <algorithm>
 
 namespace eka2l1::kernel {
+    // A patch to a word of code, which is done only once its page gets decompressed
+    struct code_fixup {
+        std::uint32_t offset_;
+        std::uint32_t value_;
+        bool relative_;
+    };
+
+    static void apply_code_fixups(std::uint8_t *code, const std::vector<code_fixup> &fixups, const std::size_t begin,
+        const std::size_t end) {
+        auto ite = std::lower_bound(fixups.begin(), fixups.end(), begin, [](const code_fixup &fixup, const std::size_t offset) {
+            return fixup.offset_ < offset;
+        });
+
+        for (; (ite != fixups.end()) && (ite->offset_ < end); ite++) {
+            std::uint32_t *to_fix_ptr = reinterpret_cast<std::uint32_t *>(&code[ite->offset_]);
+            *to_fix_ptr = ite->relative_ ? (*to_fix_ptr + ite->value_) : ite->value_;
+        }
+    }
+
     codeseg::codeseg(kernel_system *kern, const std::string &name, codeseg_create_info &info)
         : kernel_obj(kern, name, nullptr, kernel::access_type::global_access)
         , state(codeseg_state_none)
@@ -58,8 +78,12 @@ namespace eka2l1::kernel {
         }
 
         if (code_addr == 0) {
-            code_data = std::make_unique<std::uint8_t[]>(info.code_size);
-            std::copy(info.code_data, info.code_data + info.code_size, code_data.get());
+            if (info.code_pages) {
+                code_pages = std::move(info.code_pages);
+            } else {
+                code_data = std::make_unique<std::uint8_t[]>(info.code_size);
+                std::copy(info.code_data, info.code_data + info.code_size, code_data.get());
+            }
         }
 
         relocation_list = info.relocation_list;
@@ -104,9 +128,12 @@ namespace eka2l1::kernel {
 
             the_addr_of_code_run = code_chunk->base(new_foe).ptr_address();
 
-            // Copy data
             code_base_ptr = reinterpret_cast<std::uint8_t *>(code_chunk->host_base());
-            std::copy(code_data.get(), code_data.get() + code_size, code_base_ptr); // .code
+
+            // Demand paged code is decompressed later, page by page
+            if (!code_pages) {
+                std::copy(code_data.get(), code_data.get() + code_size, code_base_ptr); // .code
+            }
         } else {
             the_addr_of_code_run = code_addr;
             code_base_ptr = reinterpret_cast<std::uint8_t *>(kern->get_memory_system()->get_real_pointer(code_addr));
@@ -150,6 +177,10 @@ namespace eka2l1::kernel {
         LOG_INFO(KERNEL, "{} runtime data: 0x{:x}", name(), the_addr_of_data_run);
 
         attaches.push_back({ new_foe, dt_chunk, code_chunk });
+
+        // Fixups of demand paged code wait until their page is decompressed
+        const bool demand_page_code = (code_addr == 0) && code_pages;
+        std::vector<code_fixup> code_fixups;
         
         // Attach all of its dependencies
         for (auto &dependency: dependencies) {
@@ -167,7 +198,11 @@ namespace eka2l1::kernel {
                         LOG_ERROR(KERNEL, "Invalid ordinal {}, requested from {}", ord, dependency.dep_->name());
                     }
 
-                    *reinterpret_cast<std::uint32_t*>(&code_base_ptr[offset_to_apply]) = addr + adj;
+                    if (demand_page_code) {
+                        code_fixups.push_back({ offset_to_apply, addr + adj, false });
+                    } else {
+                        *reinterpret_cast<std::uint32_t*>(&code_base_ptr[offset_to_apply]) = addr + adj;
+                    }
                 }
             }
         }
@@ -208,6 +243,11 @@ namespace eka2l1::kernel {
 
                 switch (sect_type) {
                 case loader::relocate_section_text:
+                    if (demand_page_code) {
+                        code_fixups.push_back({ offset_to_relocate, the_delta, true });
+                        continue;
+                    }
+
                     base_ptr = code_base_ptr;
                     break;
 
@@ -224,12 +264,54 @@ namespace eka2l1::kernel {
             }
         }
 
+        if (demand_page_code) {
+            setup_code_demand_paging(code_chunk, code_base_ptr, std::move(code_fixups));
+        }
+
         state = codeseg_state_attached;
         kern->run_codeseg_loaded_callback(obj_name, new_foe, this);
 
         return true;
     }
 
+    void codeseg::setup_code_demand_paging(chunk_ptr code_chunk, std::uint8_t *code_base_ptr, std::vector<code_fixup> fixups) {
+        // Same offset keeps its order, imports before relocations
+        std::stable_sort(fixups.begin(), fixups.end(), [](const code_fixup &lhs, const code_fixup &rhs) {
+            return lhs.offset_ < rhs.offset_;
+        });
+
+        const std::size_t page_size = kern->get_memory_system()->get_page_size();
+
+        const bool can_demand_page = std::all_of(fixups.begin(), fixups.end(), [=](const code_fixup &fixup) {
+            return (fixup.offset_ / page_size) == ((fixup.offset_ + 3) / page_size);
+        });
+
+        if (can_demand_page) {
+            std::shared_ptr<common::bytepair_page_store> pages = code_pages;
+            auto shared_fixups = std::make_shared<std::vector<code_fixup>>(std::move(fixups));
+
+            // Only owns what it needs, so it stays valid whoever goes away first
+            const bool result = code_chunk->enable_demand_paging([pages, shared_fixups](const std::size_t offset, const std::size_t size,
+                std::uint8_t *data) {
+                std::uint8_t *code = data - offset;
+
+                pages->decompress(reinterpret_cast<char *>(code), offset, size);
+                apply_code_fixups(code, *shared_fixups, offset, offset + size);
+            });
+
+            if (result) {
+                return;
+            }
+
+            fixups = std::move(*shared_fixups);
+        }
+
+        LOG_WARN(KERNEL, "Can't demand page code of {}, decompressing all of it", name());
+
+        code_pages->decompress(reinterpret_cast<char *>(code_base_ptr), 0, code_size);
+        apply_code_fixups(code_base_ptr, fixups, 0, code_size);
+    }
+
     bool codeseg::detach(kernel::process *de_foe) {
         auto attach_info = common::find_and_ret_if(attaches, [=](const attached_info &info) {
             return info.attached_process == de_foe;
@@ -277,6 +359,8 @@ namespace eka2l1::kernel {
         }
 
         if (base) {
+            // The caller reads the code through the host, which doesn't fault
+            attach_info->code_chunk->page_in_all();
             *base = reinterpret_cast<std::uint8_t *>(attach_info->code_chunk->host_base());
         }
 
@@ -62,6 +62,65 @@ namespace eka2l1 {
         , msg_status(ipc_message_status::none)
         , id(0)
         , attrib(0)
-        , thread_handle_low(0) {
+        , thread_handle_low(0)
+        , free(true) {
+    }
+
+    ipc_msg_pool::ipc_msg_pool()
+        : generations_(MAX_MESSAGES, 0) {
+        msgs_.reserve(MAX_MESSAGES);
+        free_slots_.reserve(MAX_MESSAGES);
+
+        for (std::uint32_t i = 0; i < MAX_MESSAGES; i++) {
+            msgs_.emplace_back(nullptr);
+
+            // Hand out lower slots first
+            free_slots_.push_back(MAX_MESSAGES - i - 1);
+        }
+    }
+
+    ipc_msg_ptr ipc_msg_pool::allocate(kernel::thread *own) {
+        if (free_slots_.empty()) {
+            return nullptr;
+        }
+
+        const std::uint32_t slot = free_slots_.back();
+        free_slots_.pop_back();
+
+        // Generation zero is skipped, so no handle is ever zero (null message in the guest)
+        std::uint32_t generation = (generations_[slot] + 1) & HANDLE_GENERATION_MASK;
+
+        if (generation == 0) {
+            generation = 1;
+        }
+
+        generations_[slot] = generation;
+
+        ipc_msg &msg = msgs_[slot];
+        msg.own_thr = own;
+        msg.free = false;
+        msg.attrib = 0;
+        msg.id = (generation << HANDLE_INDEX_BITS) | slot;
+
+        return &msg;
+    }
+
+    void ipc_msg_pool::free(ipc_msg_ptr msg) {
+        if (!msg || msg->locked() || msg->free) {
+            return;
+        }
+
+        msg->free = true;
+        free_slots_.push_back(msg->id & HANDLE_INDEX_MASK);
+    }
+
+    ipc_msg_ptr ipc_msg_pool::get(const std::int32_t handle) {
+        const std::uint32_t slot = static_cast<std::uint32_t>(handle) & HANDLE_INDEX_MASK;
+
+        if ((handle <= 0) || (msgs_[slot].id != static_cast<std::uint32_t>(handle))) {
+            return nullptr;
+        }
+
+        return &msgs_[slot];
     }
 }
\ No newline at end of file
@@ -34,6 +34,7 @@
 #include <common/fileutils.h>
 #include <common/log.h>
 #include <common/path.h>
+#include <common/profiler.h>
 #include <common/virtualmem.h>
 
 #include <disasm/disasm.h>
@@ -61,29 +62,34 @@ namespace eka2l1 {
     }
 
     kernel_system::kernel_system(system *esys, ntimer *timing, io_system *io_sys,
-        config::state *old_conf, config::app_settings *settings, loader::rom *rom_info, arm::core *cpu, disasm *disassembler)
+        config::state *old_conf, config::app_settings *settings, loader::rom *rom_info, const std::vector<arm::core *> &cores,
+        disasm *disassembler)
         : btrace_inst_(nullptr)
         , lib_mngr_(nullptr)
-        , thr_sch_(nullptr)
         , timing_(timing)
         , io_(io_sys)
         , sys_(esys)
         , conf_(old_conf)
         , app_settings_(settings)
         , disassembler_(disassembler)
-        , cpu_(cpu)
+        , cores_(cores)
         , rom_info_(rom_info)
         , kernel_handles_(this, kernel::handle_array_owner::kernel)
         , realtime_ipc_signal_evt_(0)
         , uid_counter_(0)
         , rom_map_(nullptr)
+        , rom_map_size_(0)
         , kern_ver_(epocver::epoc94)
         , lang_(language::en)
         , global_data_chunk_(nullptr)
         , dll_global_data_chunk_(nullptr)
         , dll_global_data_last_offset_(0)
         , inactivity_starts_(0)
-        , nanokern_pr_(nullptr) {
+        , nanokern_pr_(nullptr)
+        , instructions_retired_(0)
+        , svc_calls_(0)
+        , ipc_messages_(0)
+        , context_switches_(0) {
         reset();
     }
 
@@ -95,7 +101,7 @@ namespace eka2l1 {
         timing_->remove_event(realtime_ipc_signal_evt_);
 
         if (rom_map_) {
-            common::unmap_file(rom_map_);
+            common::unmap_file(rom_map_, rom_map_size_);
         }
 
         rom_map_ = nullptr;
@@ -124,6 +130,9 @@ namespace eka2l1 {
         OBJECT_CONTAINER_CLEANUP(logical_channels_);
         OBJECT_CONTAINER_CLEANUP(logical_devices_);
 
+        id_table_.clear();
+        name_index_.clear();
+
         if (btrace_inst_)
             btrace_inst_->close_trace_session();
     }
@@ -131,7 +140,17 @@ namespace eka2l1 {
     void kernel_system::reset() {
         wipeout();
 
-        thr_sch_ = std::make_unique<kernel::thread_scheduler>(this, timing_, cpu_);
+        // Each core gets its own sub-scheduler, ready queue and current thread
+        thr_schs_.clear();
+
+        for (arm::core *core : cores_) {
+            thr_schs_.push_back(std::make_unique<kernel::thread_scheduler>(this, timing_, core));
+        }
+
+        // Rebalance period is 107 nanokernel ticks
+        static constexpr std::uint32_t REBALANCE_PERIOD_MS = 107;
+        balancer_ = std::make_unique<kernel::smp::load_balancer>(static_cast<std::uint32_t>(cores_.size()),
+            timing_->ms_to_cycles(static_cast<int>(REBALANCE_PERIOD_MS)));
 
         // Instantiate btrace
         btrace_inst_ = std::make_unique<kernel::btrace>(this, io_);
@@ -153,7 +172,9 @@ namespace eka2l1 {
         dll_global_data_chunk_ = nullptr;
 
         // Clear CPU caches. No reason to keep it.
-        cpu_->clear_instruction_cache();
+        for (arm::core *core : cores_) {
+            core->clear_instruction_cache();
+        }
     }
 
     void kernel_system::cpu_exception_thread_handle(arm::core *core) {
@@ -324,24 +345,26 @@ namespace eka2l1 {
         lib_mngr_ = std::make_unique<hle::lib_manager>(this, io_, mem_);
 
         // Set CPU SVC handler
-        cpu_->system_call_handler = [this](const std::uint32_t ordinal) {
-            get_lib_manager()->call_svc(ordinal);
+        for (arm::core *core : cores_) {
+            core->system_call_handler = [this, core](const std::uint32_t ordinal) {
+                get_lib_manager()->call_svc(ordinal);
 
-            // EKA1 does not use BX LR to jump back, they let kernel do it
-            if (is_eka1()) {
-                const std::uint32_t jump_back = cpu_->get_lr();
+                // EKA1 does not use BX LR to jump back, they let kernel do it
+                if (is_eka1()) {
+                    const std::uint32_t jump_back = core->get_lr();
 
-                // Set pc and ARM/thumb flag
-                cpu_->set_pc(jump_back & ~0b1);
-                cpu_->set_cpsr(cpu_->get_cpsr() | ((jump_back & 0b1) ? 0x20 : 0));
-            }
+                    // Set pc and ARM/thumb flag
+                    core->set_pc(jump_back & ~0b1);
+                    core->set_cpsr(core->get_cpsr() | ((jump_back & 0b1) ? 0x20 : 0));
+                }
 
-            crr_thread()->add_last_syscall(ordinal);
-        };
+                crr_thread()->add_last_syscall(ordinal);
+            };
 
-        cpu_->exception_handler = [this](arm::exception_type exception_type, const std::uint32_t data) {
-            cpu_exception_handler(cpu_, exception_type, data);
-        };
+            core->exception_handler = [this, core](arm::exception_type exception_type, const std::uint32_t data) {
+                cpu_exception_handler(core, exception_type, data);
+            };
+        }
     }
 
     eka2l1::ptr<kernel_global_data> kernel_system::get_global_user_data_pointer() {
@@ -362,31 +385,57 @@ namespace eka2l1 {
     }
     
     kernel::thread *kernel_system::crr_thread() {
-        return thr_sch_->current_thread();
+        return get_thread_scheduler()->current_thread();
     }
 
     kernel::process *kernel_system::crr_process() {
-        return thr_sch_->current_process();
+        return get_thread_scheduler()->current_process();
     }
 
     arm::core *kernel_system::get_cpu() {
-        return cpu_;
+        return cores_[kernel::smp::current_core()];
+    }
+
+    kernel::thread_scheduler *kernel_system::pick_thread_scheduler() {
+        return thr_schs_[balancer_->pick_core()].get();
+    }
+
+    void kernel_system::imb_range(const address addr, const std::uint32_t size) {
+        for (arm::core *core : cores_) {
+            core->imb_range(addr, size);
+        }
     }
 
     void kernel_system::reschedule() {
+        EKA2L1_PROFILE_SCOPE("Kernel", "Reschedule", 0xFF8C00);
         lock();
-        thr_sch_->reschedule();
+
+        if (kernel::smp::current_core() == 0) {
+            balancer_->balance(timing_->ticks());
+        }
+
+        get_thread_scheduler()->reschedule();
         unlock();
     }
 
     void kernel_system::unschedule_wakeup() {
-        thr_sch_->unschedule_wakeup();
+        get_thread_scheduler()->unschedule_wakeup();
     }
     
     void kernel_system::prepare_reschedule() {
         get_cpu()->stop();
     }
 
+    kernel_statistics kernel_system::get_statistics() const {
+        kernel_statistics stats;
+        stats.instructions_retired_ = instructions_retired_.load(std::memory_order_relaxed);
+        stats.svc_calls_ = svc_calls_.load(std::memory_order_relaxed);
+        stats.ipc_messages_ = ipc_messages_.load(std::memory_order_relaxed);
+        stats.context_switches_ = context_switches_.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+
     void kernel_system::call_ipc_send_callbacks(const std::string &server_name, const int ord, const ipc_arg &args,
         kernel::thread *callee) {
         for (auto &ipc_send_callback_func: ipc_send_callbacks_) {
@@ -500,31 +549,11 @@ namespace eka2l1 {
     }
 
     ipc_msg_ptr kernel_system::create_msg(kernel::owner_type owner) {
-        auto slot_free = std::find_if(msgs_.begin(), msgs_.end(),
-            [](auto slot) { return !slot || slot->free; });
-
-        if (slot_free != msgs_.end()) {
-            if (!*slot_free) {
-                ipc_msg_ptr msg = std::make_shared<ipc_msg>(crr_thread());
-                *slot_free = std::move(msg);
-            }
-
-            slot_free->get()->own_thr = crr_thread();
-            slot_free->get()->free = false;
-            slot_free->get()->id = static_cast<std::uint32_t>(slot_free - msgs_.begin());
-
-            return *slot_free;
-        }
-
-        return nullptr;
+        return msg_pool_.allocate(crr_thread());
     }
 
     ipc_msg_ptr kernel_system::get_msg(int handle) {
-        if (msgs_.size() <= handle) {
-            return nullptr;
-        }
-
-        return msgs_[handle];
+        return msg_pool_.get(handle);
     }
 
     bool kernel_system::destroy(kernel_obj_ptr obj) {
@@ -534,9 +563,10 @@ namespace eka2l1 {
         auto res = std::lower_bound(obj_map.begin(), obj_map.end(), obj, [&](const auto &lhs, const auto &rhs) { \
             return lhs->unique_id() < rhs->unique_id();                                                          \
         });                                                                                                      \
-        if (res == obj_map.end())                                                                                \
+        if ((res == obj_map.end()) || (res->get() != obj))                                                       \
             return false;                                                                                        \
         (*res)->destroy();                                                                                       \
+        unindex_object(obj);                                                                                     \
         obj_map.erase(res);                                                                                      \
         return true;                                                                                             \
     }
@@ -722,16 +752,13 @@ namespace eka2l1 {
     }
 
     void kernel_system::free_msg(ipc_msg_ptr msg) {
-        if (msg->locked()) {
-            return;
-        }
-
-        msg->free = true;
+        msg_pool_.free(msg);
     }
 
     /*! \brief Completely destroy a message. */
     void kernel_system::destroy_msg(ipc_msg_ptr msg) {
-        (msgs_.begin() + msg->id)->reset();
+        msg->unlock_free();
+        msg_pool_.free(msg);
     }
 
     property_ptr kernel_system::get_prop(int category, int key) {
@@ -768,6 +795,7 @@ namespace eka2l1 {
         }
 
         property_ptr prop_ptr = reinterpret_cast<property_ptr>(prop_res->get());
+        unindex_object(prop_ptr);
         props_.erase(prop_res);
 
         return prop_ptr;
@@ -873,6 +901,79 @@ namespace eka2l1 {
         return uid_counter_.load();
     }
 
+    std::vector<kernel_obj_unq_ptr> *kernel_system::get_object_container(const kernel::object_type type) {
+        switch (type) {
+#define OBJECT_CONTAINER(obj_type, obj_map) \
+    case kernel::object_type::obj_type:     \
+        return &obj_map;
+
+            OBJECT_CONTAINER(mutex, mutexes_)
+            OBJECT_CONTAINER(sema, semas_)
+            OBJECT_CONTAINER(chunk, chunks_)
+            OBJECT_CONTAINER(thread, threads_)
+            OBJECT_CONTAINER(process, processes_)
+            OBJECT_CONTAINER(change_notifier, change_notifiers_)
+            OBJECT_CONTAINER(library, libraries_)
+            OBJECT_CONTAINER(codeseg, codesegs_)
+            OBJECT_CONTAINER(server, servers_)
+            OBJECT_CONTAINER(prop, props_)
+            OBJECT_CONTAINER(prop_ref, prop_refs_)
+            OBJECT_CONTAINER(session, sessions_)
+            OBJECT_CONTAINER(timer, timers_)
+            OBJECT_CONTAINER(msg_queue, message_queues_)
+            OBJECT_CONTAINER(logical_device, logical_devices_)
+            OBJECT_CONTAINER(logical_channel, logical_channels_)
+
+#undef OBJECT_CONTAINER
+
+        default:
+            break;
+        }
+
+        return nullptr;
+    }
+
+    void kernel_system::index_object(kernel_obj_ptr obj) {
+        id_table_.add(obj);
+
+        // Even into a stale type, so renames of this object are still noticed before the rebuild
+        name_index_.add(obj);
+    }
+
+    void kernel_system::unindex_object(kernel_obj_ptr obj) {
+        id_table_.remove(obj);
+        name_index_.remove(obj);
+    }
+
+    void kernel_system::rebuild_name_index(const kernel::object_type type) {
+        name_index_.clear(type);
+
+        if (std::vector<kernel_obj_unq_ptr> *container = get_object_container(type)) {
+            for (auto &obj : *container) {
+                name_index_.add(obj.get());
+            }
+        }
+    }
+
+    void kernel_system::object_name_changed(kernel_obj_ptr obj) {
+        // Processes and threads come here while being constructed too, with no name change that matters
+        if (name_index_.name_changed(obj)) {
+            name_index_.reindex(obj);
+        }
+    }
+
+    kernel_obj_ptr kernel_system::get_by_full_name_raw(const std::string &name, const kernel::object_type obj_type) {
+        if (!get_object_container(obj_type)) {
+            return nullptr;
+        }
+
+        if (name_index_.stale(obj_type)) {
+            rebuild_name_index(obj_type);
+        }
+
+        return name_index_.find(name, obj_type);
+    }
+
     void kernel_system::setup_new_process(process_ptr pr) {
         // TODO(pent0): Hope i can enable this server again, it's currently buggy
         // std::unique_ptr<service::server> ps_srv = std::make_unique<eka2l1::posix_server>(sys, pr);
@@ -994,11 +1095,17 @@ namespace eka2l1 {
     }
 
     bool kernel_system::should_terminate() {
-        return thr_sch_->should_terminate();
+        for (auto &sched : thr_schs_) {
+            if (sched->should_terminate()) {
+                return true;
+            }
+        }
+
+        return false;
     }
 
     bool kernel_system::map_rom(const mem::vm_address addr, const std::string &path) {
-        rom_map_ = common::map_file(path, prot::read_write, 0, true);
+        rom_map_ = common::map_file(path, prot::read_write, 0, true, &rom_map_size_);
         const std::size_t rom_size = common::file_size(path);
 
         if (!rom_map_) {
@@ -1015,7 +1122,7 @@ namespace eka2l1 {
         if (!rom_chunk) {
             LOG_ERROR(KERNEL, "Can't create ROM chunk!");
 
-            common::unmap_file(rom_map_);
+            common::unmap_file(rom_map_, rom_map_size_);
             return false;
         }
 
@@ -1023,8 +1130,9 @@ namespace eka2l1 {
     }
 
     void kernel_system::stop_cores_idling() {
-        if (should_core_idle_when_inactive()) {
-            thr_sch_->stop_idling();
+        // Secondary cores idle regardless of the setting, each scheduler knows if it does
+        for (auto &sched : thr_schs_) {
+            sched->stop_idling();
         }
     }
 
@@ -38,6 +38,30 @@ namespace eka2l1 {
             }
         }
 
+        void kernel_obj::set_access_type(kernel::access_type acc) {
+            access = acc;
+
+            if (kern) {
+                kern->object_name_changed(this);
+            }
+        }
+
+        void kernel_obj::set_owner(kernel_obj *new_owner) {
+            owner = new_owner;
+
+            if (kern) {
+                kern->object_name_changed(this);
+            }
+        }
+
+        void kernel_obj::rename(const std::string &new_name) {
+            obj_name = new_name;
+
+            if (kern) {
+                kern->object_name_changed(this);
+            }
+        }
+
         void kernel_obj::do_state(common::chunkyseri &seri) {
             auto s = seri.section("KernelObject", 1);
 
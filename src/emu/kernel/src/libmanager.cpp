@@ -24,6 +24,7 @@
 #include <common/ini.h>
 #include <common/log.h>
 #include <common/path.h>
+#include <common/profiler.h>
 #include <common/random.h>
 
 #include <kernel/common.h>
@@ -43,6 +44,7 @@
 #include <kernel/codeseg.h>
 
 #include <cctype>
+#include <chrono>
 
 namespace eka2l1::hle {
     // Given relocation entries, relocate the code and data
@@ -224,6 +226,7 @@ namespace eka2l1::hle {
 
         info.constant_data = reinterpret_cast<std::uint8_t *>(&img->data[img->header.data_offset]);
         info.code_data = reinterpret_cast<std::uint8_t *>(&img->data[img->header.code_offset]);
+        info.code_pages = img->code_pages;
         
         // Add relocation info in
         build_relocation_list(info.relocation_list, img);
@@ -746,7 +749,7 @@ namespace eka2l1::hle {
 
                 eka2l1::ro_file_stream image_data_stream(f.get());
 
-                auto parse_result = loader::parse_e32img(reinterpret_cast<common::ro_stream *>(&image_data_stream));
+                auto parse_result = loader::parse_e32img(reinterpret_cast<common::ro_stream *>(&image_data_stream), true, true);
                 if (parse_result != std::nullopt) {
                     f->close();
                     result.first = std::move(parse_result);
@@ -829,7 +832,7 @@ namespace eka2l1::hle {
 
                     return load_as_romimg(*romimg, lib_path);
                 } else {
-                    auto e32img = loader::parse_e32img(reinterpret_cast<common::ro_stream *>(&image_data_stream));
+                    auto e32img = loader::parse_e32img(reinterpret_cast<common::ro_stream *>(&image_data_stream), true, true);
                     if (!e32img) {
                         return nullptr;
                     }
@@ -908,24 +911,35 @@ namespace eka2l1::hle {
     }
 
     bool lib_manager::call_svc(sid svcnum) {
+        EKA2L1_PROFILE_SCOPE("Kernel", "SVC", 0xFFD700);
+
         // Lock the kernel so SVC call can operate in safety
         kern_->lock();
-        auto res = svc_funcs_.find(svcnum);
+        const epoc_import_func *func = svc_funcs_.get(svcnum);
+        kern_->count_svc_call();
 
-        if (res == svc_funcs_.end()) {
+        if (!func) {
             LOG_ERROR(KERNEL, "Unimplement system call: 0x{:X}!", svcnum);
 
             kern_->unlock();
             return false;
         }
 
-        epoc_import_func func = res->second;
+        config::state *conf = kern_->get_config();
 
-        if (kern_->get_config()->log_svc) {
-            LOG_TRACE(KERNEL, "Calling SVC 0x{:x} {}", svcnum, func.name);
+        if (conf->log_svc) {
+            LOG_TRACE(KERNEL, "Calling SVC 0x{:x} {}", svcnum, func->name);
         }
 
-        func.func(kern_, kern_->crr_process(), kern_->get_cpu());
+        if (conf->profile_svc) {
+            const auto start = std::chrono::steady_clock::now();
+            func->func(kern_, kern_->crr_process(), kern_->get_cpu());
+            const auto end = std::chrono::steady_clock::now();
+
+            svc_funcs_.record(svcnum, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        } else {
+            func->func(kern_, kern_->crr_process(), kern_->get_cpu());
+        }
 
         kern_->unlock();
         return true;
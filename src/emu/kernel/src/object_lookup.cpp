@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/object_lookup.h>
+
+namespace eka2l1::kernel {
+    void object_id_table::add(kernel_obj *obj) {
+        const kernel::uid id = obj->unique_id();
+        const std::uint64_t slab_index = id >> SLAB_SHIFT;
+
+        if (slab_index >= slabs_.size()) {
+            slabs_.resize(slab_index + 1);
+        }
+
+        if (!slabs_[slab_index]) {
+            slabs_[slab_index] = std::make_unique<slab>();
+        }
+
+        kernel_obj *&slot = slabs_[slab_index]->objects_[id & SLAB_MASK];
+
+        if (!slot) {
+            slabs_[slab_index]->live_count_++;
+        }
+
+        slot = obj;
+    }
+
+    void object_id_table::remove(kernel_obj *obj) {
+        const kernel::uid id = obj->unique_id();
+        const std::uint64_t slab_index = id >> SLAB_SHIFT;
+
+        if ((slab_index >= slabs_.size()) || !slabs_[slab_index]) {
+            return;
+        }
+
+        kernel_obj *&slot = slabs_[slab_index]->objects_[id & SLAB_MASK];
+
+        if (slot != obj) {
+            return;
+        }
+
+        slot = nullptr;
+
+        if (--slabs_[slab_index]->live_count_ == 0) {
+            slabs_[slab_index].reset();
+        }
+    }
+
+    void object_id_table::clear() {
+        slabs_.clear();
+    }
+
+    void object_name_index::add(kernel_obj *obj) {
+        std::string key;
+        obj->full_name(key);
+
+        names_[static_cast<std::size_t>(obj->get_object_type())].emplace(key, obj);
+        keys_[obj] = std::move(key);
+    }
+
+    void object_name_index::remove(kernel_obj *obj) {
+        auto key_ite = keys_.find(obj);
+
+        if (key_ite == keys_.end()) {
+            return;
+        }
+
+        auto &names = names_[static_cast<std::size_t>(obj->get_object_type())];
+        auto range = names.equal_range(key_ite->second);
+
+        for (auto ite = range.first; ite != range.second; ite++) {
+            if (ite->second == obj) {
+                names.erase(ite);
+                break;
+            }
+        }
+
+        keys_.erase(key_ite);
+    }
+
+    void object_name_index::reindex(kernel_obj *obj) {
+        // Full names of owned objects start with ours, so they changed too
+        std::vector<kernel_obj *> changed;
+
+        for (auto &[indexed, key] : keys_) {
+            for (kernel_obj *ancestor = indexed; ancestor; ancestor = ancestor->get_owner()) {
+                if (ancestor == obj) {
+                    changed.push_back(indexed);
+                    break;
+                }
+            }
+        }
+
+        for (kernel_obj *changed_obj : changed) {
+            remove(changed_obj);
+            add(changed_obj);
+        }
+    }
+
+    bool object_name_index::name_changed(kernel_obj *obj) {
+        auto key_ite = keys_.find(obj);
+
+        if (key_ite == keys_.end()) {
+            return false;
+        }
+
+        std::string current_name;
+        obj->full_name(current_name);
+
+        return current_name != key_ite->second;
+    }
+
+    void object_name_index::clear(const object_type type) {
+        auto &names = names_[static_cast<std::size_t>(type)];
+
+        for (auto &[name, obj] : names) {
+            keys_.erase(obj);
+        }
+
+        names.clear();
+        stale_[static_cast<std::size_t>(type)] = false;
+    }
+
+    void object_name_index::clear() {
+        for (auto &names : names_) {
+            names.clear();
+        }
+
+        keys_.clear();
+        stale_.fill(false);
+    }
+
+    kernel_obj *object_name_index::find(const std::string &full_name, const object_type type) {
+        const std::size_t type_index = static_cast<std::size_t>(type);
+        auto range = names_[type_index].equal_range(full_name);
+        kernel_obj *result = nullptr;
+
+        for (auto ite = range.first; ite != range.second; ite++) {
+            std::string current_name;
+            ite->second->full_name(current_name);
+
+            if (current_name != full_name) {
+                // Someone changed the name without telling us. Do not trust the rest of the index.
+                stale_[type_index] = true;
+                return nullptr;
+            }
+
+            // Keep the same order as a container scan: lowest ID wins
+            if (!result || (ite->second->unique_id() < result->unique_id())) {
+                result = ite->second;
+            }
+        }
+
+        return result;
+    }
+}
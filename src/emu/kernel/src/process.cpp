@@ -91,6 +91,9 @@ namespace eka2l1::kernel {
         uids = codeseg->get_uids();
         priority = pri;
 
+        // Process name includes the third UID
+        kern->object_name_changed(this);
+
         if (kern->get_epoc_version() >= epocver::eka2) {
             std::string all_caps;
 
@@ -214,6 +217,8 @@ namespace eka2l1::kernel {
     void process::set_uid_type(const process_uid_type &type) {
         uids = std::move(type);
         generation_ = refresh_generation();
+
+        kern->object_name_changed(this);
         
         reload_compat_setting();
 
@@ -242,7 +247,7 @@ namespace eka2l1::kernel {
     }
 
     bool process::run() {
-        return kern->get_thread_scheduler()->schedule(&(*primary_thread));
+        return primary_thread->get_scheduler()->schedule(&(*primary_thread));
     }
 
     std::uint32_t process::get_entry_point_address() {
@@ -26,6 +26,7 @@
 
 #include <kernel/kernel.h>
 #include <kernel/scheduler.h>
+#include <kernel/smp/core.h>
 #include <kernel/thread.h>
 #include <mem/mem.h>
 #include <mem/mmu.h>
@@ -63,8 +64,21 @@ namespace eka2l1::kernel {
         stop_idling();
     }
 
+    bool thread_scheduler::idles_when_inactive() const {
+        return kern->should_core_idle_when_inactive() || (run_core->core_number() != 0);
+    }
+
+    void thread_scheduler::halt_core() {
+        // Only the host thread running the core may stop it directly
+        if (smp::is_core_thread() && (smp::current_core() == run_core->core_number())) {
+            run_core->stop();
+        } else {
+            run_core->request_halt();
+        }
+    }
+
     void thread_scheduler::stop_idling() {
-        if (kern->should_core_idle_when_inactive()) {
+        if (idles_when_inactive()) {
             idle_sema.notify();
         }
     }
@@ -87,6 +101,10 @@ namespace eka2l1::kernel {
         }
 
         if (newt) {
+            if (newt != oldt) {
+                kern->count_context_switch();
+            }
+
             // cancel wake up
             // timing->unschedule_event(wakeup_evt, newt->unique_id());
             crr_thread = newt;
@@ -117,7 +135,7 @@ namespace eka2l1::kernel {
             crr_thread = nullptr;
 
             // Let free access to kernel now
-            if (kern->should_core_idle_when_inactive()) {
+            if (idles_when_inactive()) {
                 kern->unlock();
                 idle_sema.wait();
                 kern->lock();
@@ -177,7 +195,7 @@ namespace eka2l1::kernel {
                 queue_thread_ready(old_friend);
             }
             
-            if (!next_thread && kern->should_core_idle_when_inactive()) {
+            if (!next_thread && idles_when_inactive()) {
                 // Use our old outdated friend, it seems only one thread exists
                 next_thread = old_friend;
             }
@@ -196,7 +214,7 @@ namespace eka2l1::kernel {
             thr->scheduler_link.previous = thr;
 
             // Well no need to idle anymore :D
-            if (kern->should_core_idle_when_inactive() && !crr_thread)
+            if (idles_when_inactive() && !crr_thread)
                 idle_sema.notify();
 
             return;
@@ -214,7 +232,7 @@ namespace eka2l1::kernel {
         readys[thr->real_priority]->scheduler_link.previous = thr;
 
         // Well no need to idle anymore :D
-        if (kern->should_core_idle_when_inactive() && !crr_thread)
+        if (idles_when_inactive() && !crr_thread)
             idle_sema.notify();
     }
 
@@ -296,7 +314,7 @@ namespace eka2l1::kernel {
         }
 
         dequeue_thread_from_ready(thr);
-        kern->prepare_reschedule();
+        halt_core();
 
         return true;
     }
@@ -321,7 +339,7 @@ namespace eka2l1::kernel {
         
         queue_thread_ready(thr);
         
-        kern->prepare_reschedule();
+        halt_core();
 
         return true;
     }
@@ -358,7 +376,7 @@ namespace eka2l1::kernel {
         }
 
         if (crr_thread == thr) {
-            kern->prepare_reschedule();
+            halt_core();
         }
 
         return true;
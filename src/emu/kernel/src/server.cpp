@@ -46,6 +46,7 @@ namespace eka2l1 {
         server::server(kernel_system *kern, system *sys, const std::string name, bool hle, bool unhandle_callback_enable)
             : kernel_obj(kern, name, nullptr, kernel::access_type::global_access)
             , sys(sys)
+            , profile_token_(common::get_profile_token("Services", name, 0x6495ED))
             , hle(hle)
             , unhandle_callback_enable(unhandle_callback_enable) {
             process_msg = kern->create_msg(kernel::owner_type::process);
@@ -104,6 +105,8 @@ namespace eka2l1 {
         }
 
         int server::deliver(server_msg msg) {
+            kern->count_ipc_message();
+
             // Is ready
             if (ready()) {
                 msg.dest_msg = request_msg;
@@ -169,7 +172,11 @@ namespace eka2l1 {
         void server::receive_async_lle(eka2l1::ptr<epoc::request_status> msg_request_status,
             eka2l1::ptr<message2> data) {
             ipc_msg_ptr msg = kern->create_msg(kernel::owner_type::process);
-            msg->free = false;
+
+            if (!msg) {
+                LOG_ERROR(KERNEL, "Message pool exhausted, can't receive message for server {}", obj_name);
+                return;
+            }
 
             int res = receive(msg);
 
@@ -145,6 +145,7 @@ namespace eka2l1 {
             send_receive_sync(standard_ipc_message_disconnect, arg, 0);
             
             if (svr->is_hle()) {
+                const std::lock_guard<common::counted_mutex> guard(svr->server_lock());
                 svr->process_accepted_msg();
             }
         }
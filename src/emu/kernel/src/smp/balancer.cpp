@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/smp/avail.h>
+#include <kernel/smp/balancer.h>
+
+namespace eka2l1::kernel::smp {
+    std::uint32_t calculate_load_unit(std::uint64_t delta, std::uint64_t delta_time) {
+        if (delta_time == 0) {
+            return 0;
+        }
+
+        while (delta_time >= (1ULL << 20)) {
+            delta >>= 1;
+            delta_time >>= 1;
+        }
+
+        if (delta > delta_time) {
+            delta = delta_time;
+        }
+
+        return static_cast<std::uint32_t>(((delta * cpu_availability::idle_unit) + (delta_time / 2)) / delta_time);
+    }
+
+    load_balancer::load_balancer(const std::uint32_t num_cores, const std::uint64_t balance_period)
+        : run_ticks_(num_cores)
+        , loads_(num_cores, 0)
+        , placed_(num_cores, 0)
+        , balance_period_(balance_period)
+        , last_balance_(0) {
+    }
+
+    void load_balancer::add_run_ticks(const std::uint32_t core_index, const std::uint64_t ticks) {
+        run_ticks_[core_index].fetch_add(ticks, std::memory_order_relaxed);
+    }
+
+    void load_balancer::balance(const std::uint64_t now) {
+        if (now < last_balance_ + balance_period_) {
+            return;
+        }
+
+        const std::uint64_t delta_time = now - last_balance_;
+
+        for (std::size_t i = 0; i < loads_.size(); i++) {
+            loads_[i] = calculate_load_unit(run_ticks_[i].exchange(0, std::memory_order_relaxed), delta_time);
+            placed_[i] = 0;
+        }
+
+        last_balance_ = now;
+    }
+
+    std::uint32_t load_balancer::pick_core() {
+        cpu_availability avail(num_cores());
+
+        for (std::uint32_t i = 0; i < num_cores(); i++) {
+            avail.add_load(i, loads_[i] + placed_[i]);
+        }
+
+        const std::uint32_t picked = avail.find_lowest_load();
+        placed_[picked] += NEW_THREAD_LOAD_UNIT;
+
+        return picked;
+    }
+
+    std::uint32_t load_balancer::get_load(const std::uint32_t core_index) const {
+        return loads_[core_index];
+    }
+}
@@ -635,10 +635,10 @@ namespace eka2l1::epoc {
         if (kern->get_config()->log_ipc)
             LOG_TRACE(KERNEL, "Message completed with code: {}, thread to signal: {}", val, msg->own_thr->name());
 
-        kern->call_ipc_complete_callbacks(msg.get(), val);
+        kern->call_ipc_complete_callbacks(msg, val);
 
-        // Free the message
-        msg->free = true;
+        // Return the slot to the pool, so long running servers do not exhaust it
+        kern->free_msg(msg);
     }
 
      BRIDGE_FUNC(void, message_complete_handle, std::int32_t msg_handle, std::int32_t handle) {
@@ -654,10 +654,10 @@ namespace eka2l1::epoc {
         if (kern->get_config()->log_ipc)
             LOG_TRACE(KERNEL, "Message completed with code: {}, thread to signal: {}", dup_handle, msg->own_thr->name());
 
-        kern->call_ipc_complete_callbacks(msg.get(), dup_handle);
+        kern->call_ipc_complete_callbacks(msg, dup_handle);
 
-        // Free the message
-        msg->free = true;
+        // Return the slot to the pool, so long running servers do not exhaust it
+        kern->free_msg(msg);
     }
 
     BRIDGE_FUNC(void, message_kill, kernel::handle h, kernel::entity_exit_type etype, std::int32_t reason, eka2l1::ptr<desc8> cage) {
@@ -1004,6 +1004,7 @@ namespace eka2l1::epoc {
 
         if (ss->get_server()->is_hle()) {
             // Process it right away.
+            const std::lock_guard<common::counted_mutex> guard(ss->get_server()->server_lock());
             ss->get_server()->process_accepted_msg();
         }
 
@@ -1229,7 +1230,7 @@ namespace eka2l1::epoc {
             }
         }
 
-        kern->get_cpu()->imb_range(addr.ptr_address(), size);
+        kern->imb_range(addr.ptr_address(), size);
     }
 
     /********************/
@@ -1865,7 +1866,7 @@ namespace eka2l1::epoc {
 
         switch (thr->current_state()) {
         case kernel::thread_state::create: {
-            kern->get_thread_scheduler()->schedule(&(*thr));
+            thr->get_scheduler()->schedule(&(*thr));
             break;
         }
 
@@ -2550,7 +2551,7 @@ namespace eka2l1::epoc {
         codeseg_ptr ss = get_codeseg_from_addr(kern, process_to_operate, addr, false);
 
         if (ss) {
-            kern->get_cpu()->imb_range(addr, len);
+            kern->imb_range(addr, len);
         }
 
         return epoc::error_none;
@@ -3610,6 +3611,9 @@ namespace eka2l1::epoc {
             
             existing = kern->add_object(factory_inst);
             existing->install();
+
+            // Factories are allowed to pick their name on install
+            kern->object_name_changed(existing);
         }
 
         if (!existing) {
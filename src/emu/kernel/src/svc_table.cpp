@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/svc_table.h>
+
+#include <common/log.h>
+
+#include <algorithm>
+
+namespace eka2l1::hle {
+    void svc_stat::record(const std::uint64_t ns) {
+        static constexpr std::uint64_t FIRST_BUCKET_LIMIT_NS = 256;
+
+        calls_++;
+        total_ns_ += ns;
+
+        std::uint32_t bucket = 0;
+
+        for (std::uint64_t limit = FIRST_BUCKET_LIMIT_NS; (ns >= limit) && (bucket < SVC_HISTOGRAM_BUCKET_COUNT - 1);
+             limit <<= 1) {
+            bucket++;
+        }
+
+        histogram_[bucket]++;
+    }
+
+    void svc_table::add(const std::uint32_t svc_num, const epoc_import_func &func) {
+        if (svc_num >= (BANK_COUNT << BANK_SHIFT)) {
+            LOG_ERROR(KERNEL, "SVC number 0x{:X} is out of dispatch table range", svc_num);
+            return;
+        }
+
+        std::unique_ptr<svc_bank> &bank = banks_[svc_num >> BANK_SHIFT];
+
+        if (!bank) {
+            bank = std::make_unique<svc_bank>();
+        }
+
+        const std::uint32_t index = svc_num & BANK_INDEX_MASK;
+
+        if (index >= bank->funcs_.size()) {
+            bank->funcs_.resize(index + 1);
+            bank->stats_.resize(index + 1);
+        }
+
+        bank->funcs_[index] = func;
+    }
+
+    void svc_table::add(const func_map &funcs) {
+        for (const auto &[svc_num, func] : funcs) {
+            add(svc_num, func);
+        }
+    }
+
+    void svc_table::clear() {
+        for (auto &bank : banks_) {
+            bank.reset();
+        }
+    }
+
+    void svc_table::reset_stats() {
+        for (auto &bank : banks_) {
+            if (bank) {
+                std::fill(bank->stats_.begin(), bank->stats_.end(), svc_stat{});
+            }
+        }
+    }
+
+    void svc_table::for_each(svc_iterate_func func) const {
+        for (std::uint32_t i = 0; i < BANK_COUNT; i++) {
+            if (!banks_[i]) {
+                continue;
+            }
+
+            for (std::uint32_t j = 0; j < banks_[i]->funcs_.size(); j++) {
+                if (banks_[i]->funcs_[j].func) {
+                    func((i << BANK_SHIFT) | j, banks_[i]->funcs_[j], banks_[i]->stats_[j]);
+                }
+            }
+        }
+    }
+}
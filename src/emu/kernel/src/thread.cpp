@@ -158,6 +158,8 @@ namespace eka2l1 {
             const bool initial) {
             std::fill(ctx.cpu_registers.begin(), ctx.cpu_registers.end(), 0);
             std::fill(ctx.fpu_registers.begin(), ctx.fpu_registers.end(), 0);
+            ctx.fpscr = 0;
+            ctx.fpu_save_stamp = 0;
 
             /* Userland process and thread are all initialized with _E32Startup, which is the first
                entry point of an process. _E32Startup required:
@@ -322,7 +324,7 @@ namespace eka2l1 {
             }
 
             reset_thread_ctx(epa, stack_top, local_data_chunk->base(owner).ptr_address(), initial);
-            scheduler = kern->get_thread_scheduler();
+            scheduler = kern->pick_thread_scheduler();
 
             // Add thread to process's thread list
             owner->get_thread_list().push(&process_thread_link);
@@ -627,6 +629,7 @@ namespace eka2l1 {
         void thread::owning_process(kernel::process *pr) {
             owner = reinterpret_cast<kernel_obj *>(pr);
             owning_process()->increase_thread_count();
+            kern->object_name_changed(this);
 
             name_chunk->set_owner(pr);
             stack_chunk->set_owner(pr);
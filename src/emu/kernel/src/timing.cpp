@@ -21,6 +21,7 @@
 #include <common/algorithm.h>
 #include <common/chunkyseri.h>
 #include <common/log.h>
+#include <common/profiler.h>
 #include <common/thread.h>
 #include <common/platform.h>
 
@@ -32,6 +33,184 @@
 #include <vector>
 
 namespace eka2l1 {
+    event_queue::event_queue()
+        : sequence_counter_(0) {
+    }
+
+    bool event_queue::is_before(const std::uint32_t lhs, const std::uint32_t rhs) const {
+        const event_slot &lhs_slot = slots_[lhs];
+        const event_slot &rhs_slot = slots_[rhs];
+
+        if (lhs_slot.evt_.event_time != rhs_slot.evt_.event_time) {
+            return lhs_slot.evt_.event_time < rhs_slot.evt_.event_time;
+        }
+
+        return lhs_slot.sequence_ < rhs_slot.sequence_;
+    }
+
+    void event_queue::place(const std::size_t pos, const std::uint32_t slot) {
+        heap_[pos] = slot;
+        slots_[slot].heap_pos_ = pos;
+    }
+
+    void event_queue::sift_up(std::size_t pos) {
+        const std::uint32_t slot = heap_[pos];
+
+        while (pos > 0) {
+            const std::size_t parent = (pos - 1) / HEAP_ARITY;
+
+            if (!is_before(slot, heap_[parent])) {
+                break;
+            }
+
+            place(pos, heap_[parent]);
+            pos = parent;
+        }
+
+        place(pos, slot);
+    }
+
+    void event_queue::sift_down(std::size_t pos) {
+        const std::uint32_t slot = heap_[pos];
+        const std::size_t count = heap_.size();
+
+        while (true) {
+            const std::size_t first_child = pos * HEAP_ARITY + 1;
+
+            if (first_child >= count) {
+                break;
+            }
+
+            const std::size_t last_child = std::min(first_child + HEAP_ARITY, count);
+            std::size_t best_child = first_child;
+
+            for (std::size_t child = first_child + 1; child < last_child; child++) {
+                if (is_before(heap_[child], heap_[best_child])) {
+                    best_child = child;
+                }
+            }
+
+            if (!is_before(heap_[best_child], slot)) {
+                break;
+            }
+
+            place(pos, heap_[best_child]);
+            pos = best_child;
+        }
+
+        place(pos, slot);
+    }
+
+    void event_queue::unlink_key(const std::uint32_t slot) {
+        const event &evt = slots_[slot].evt_;
+        auto key_ite = key_index_.find({ evt.event_type, evt.event_user_data });
+
+        if (key_ite == key_index_.end()) {
+            return;
+        }
+
+        if (key_ite->second == slot) {
+            if (slots_[slot].next_same_key_ == INVALID_SLOT) {
+                key_index_.erase(key_ite);
+            } else {
+                key_ite->second = slots_[slot].next_same_key_;
+            }
+
+            return;
+        }
+
+        // Same key scheduled multiple times, rare case. Walk the chain
+        std::uint32_t prev = key_ite->second;
+
+        while (slots_[prev].next_same_key_ != INVALID_SLOT) {
+            if (slots_[prev].next_same_key_ == slot) {
+                slots_[prev].next_same_key_ = slots_[slot].next_same_key_;
+                break;
+            }
+
+            prev = slots_[prev].next_same_key_;
+        }
+    }
+
+    void event_queue::remove_at(const std::size_t pos) {
+        const std::uint32_t slot = heap_[pos];
+
+        unlink_key(slot);
+        free_slots_.push_back(slot);
+
+        const std::uint32_t last_slot = heap_.back();
+        heap_.pop_back();
+
+        if (pos == heap_.size()) {
+            return;
+        }
+
+        place(pos, last_slot);
+
+        if ((pos > 0) && is_before(last_slot, heap_[(pos - 1) / HEAP_ARITY])) {
+            sift_up(pos);
+        } else {
+            sift_down(pos);
+        }
+    }
+
+    void event_queue::push(const event &evt) {
+        std::uint32_t slot = 0;
+
+        if (!free_slots_.empty()) {
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+        } else {
+            slot = static_cast<std::uint32_t>(slots_.size());
+            slots_.emplace_back();
+        }
+
+        event_slot &target = slots_[slot];
+        target.evt_ = evt;
+        target.sequence_ = sequence_counter_++;
+        target.next_same_key_ = INVALID_SLOT;
+
+        auto key_result = key_index_.emplace(std::make_pair(evt.event_type, evt.event_user_data), slot);
+
+        if (!key_result.second) {
+            target.next_same_key_ = key_result.first->second;
+            key_result.first->second = slot;
+        }
+
+        heap_.push_back(slot);
+        sift_up(heap_.size() - 1);
+    }
+
+    bool event_queue::remove(const int event_type, const std::uint64_t userdata) {
+        auto key_ite = key_index_.find({ event_type, userdata });
+
+        if (key_ite == key_index_.end()) {
+            return false;
+        }
+
+        remove_at(slots_[key_ite->second].heap_pos_);
+        return true;
+    }
+
+    const event &event_queue::top() const {
+        return slots_[heap_.front()].evt_;
+    }
+
+    void event_queue::pop() {
+        if (!heap_.empty()) {
+            remove_at(0);
+        }
+    }
+
+    void event_queue::clear() {
+        slots_.clear();
+        free_slots_.clear();
+        heap_.clear();
+        key_index_.clear();
+
+        sequence_counter_ = 0;
+    }
+
     ntimer::ntimer(const std::uint32_t cpu_hz) {
         CPU_HZ_ = cpu_hz;
         should_stop_ = false;
@@ -103,6 +282,7 @@ namespace eka2l1 {
         static const char *TIMING_THREAD_NAME = "Timing thread";
 
         common::set_thread_name(TIMING_THREAD_NAME);
+        common::profiler_register_thread(TIMING_THREAD_NAME);
         common::set_thread_priority(common::thread_priority_very_high);
 
         while (!should_stop_) {
@@ -140,16 +320,13 @@ namespace eka2l1 {
     }
 
     std::optional<std::uint64_t> ntimer::advance() {
+        EKA2L1_PROFILE_SCOPE("Timing", "Advance", 0x9ACD32);
         std::unique_lock<std::mutex> unq(lock_);
         std::uint64_t global_timer = teletimer_->microseconds();
 
-        while (!events_.empty() && events_.back().event_time <= global_timer) {
-            event evt = std::move(events_.back());
-            events_.pop_back();
-
-            std::stable_sort(events_.begin(), events_.end(), [](const event &lhs, const event &rhs) {
-                return lhs.event_time > rhs.event_time;
-            });
+        while (!events_.empty() && events_.top().event_time <= global_timer) {
+            const event evt = events_.top();
+            events_.pop();
 
             unq.unlock();
 
@@ -162,7 +339,7 @@ namespace eka2l1 {
         }
 
         if (!events_.empty()) {
-            return static_cast<std::uint64_t>(events_.back().event_time - global_timer);
+            return static_cast<std::uint64_t>(events_.top().event_time - global_timer);
         }
 
         return std::nullopt;
@@ -177,12 +354,8 @@ namespace eka2l1 {
         evt.event_type = event_type;
         evt.event_user_data = userdata;
 
-        bool should_nof = (events_.empty()) ||  (events_.back().event_time > evt.event_time);
-        events_.push_back(evt);
-
-        std::stable_sort(events_.begin(), events_.end(), [](const event &lhs, const event &rhs) {
-            return lhs.event_time > rhs.event_time;
-        });
+        bool should_nof = (events_.empty()) || (events_.top().event_time > evt.event_time);
+        events_.push(evt);
 
         if (should_nof) {
             new_event_evt_.set();
@@ -191,21 +364,7 @@ namespace eka2l1 {
 
     bool ntimer::unschedule_event(int event_type, uint64_t userdata) {
         const std::lock_guard<std::mutex> guard(lock_);
-
-        auto res = std::find_if(events_.begin(), events_.end(),
-            [&](auto evt) { return (evt.event_type == event_type) && (evt.event_user_data == userdata); });
-
-        if (res != events_.end()) {
-            events_.erase(res);
-
-            std::stable_sort(events_.begin(), events_.end(), [](const event &lhs, const event &rhs) {
-                return lhs.event_time > rhs.event_time;
-            });
-
-            return true;
-        }
-
-        return false;
+        return events_.remove(event_type, userdata);
     }
 
     bool ntimer::set_clock_frequency_mhz(const std::uint32_t cpu_mhz) {
@@ -35,6 +35,7 @@ namespace eka2l1 {
 
     namespace common {
         class ro_stream;
+        class bytepair_page_store;
     }
 
     /*! \brief Contains the loader for E32Image, ROMImage, SIS. */
@@ -178,6 +179,10 @@ namespace eka2l1 {
 
             std::vector<char> data;
             uint32_t uncompressed_size;
+
+            // Compressed code pages, when the code is decompressed on demand. Only the parts
+            // of the code the loader reads itself are present in data.
+            std::shared_ptr<common::bytepair_page_store> code_pages;
             e32_import_section import_section;
 
             e32_reloc_section code_reloc_section;
@@ -199,10 +204,13 @@ namespace eka2l1 {
          * 
          * @param stream     The stream to parse from.
          * @param read_reloc If this is true, relocation section will be parsed.
+         * @param demand_page_code If this is true and the image is bytepair compressed, the code is
+         *                         kept compressed in code_pages, to be decompressed when first accessed.
          * 
          * @returns An optional contains E32 Image. Nullopt if invalid.
          */
-        std::optional<e32img> parse_e32img(common::ro_stream *stream, bool read_reloc = true);
+        std::optional<e32img> parse_e32img(common::ro_stream *stream, bool read_reloc = true,
+            const bool demand_page_code = false);
 
         /**
          * @brief Check if the stream content is E32 Image.
@@ -171,7 +171,14 @@ namespace eka2l1::loader {
         return result;
     }
 
-    std::optional<e32img> parse_e32img(common::ro_stream *stream, bool read_reloc) {
+    // Make sure a range of demand paged code is present in the image data, for the loader to read
+    static void commit_code_range(e32img &img, const std::uint32_t offset, const std::uint32_t size) {
+        if (img.code_pages) {
+            img.code_pages->decompress(&img.data[img.header.code_offset], offset, size);
+        }
+    }
+
+    std::optional<e32img> parse_e32img(common::ro_stream *stream, bool read_reloc, const bool demand_page_code) {
         if (!stream) {
             return std::nullopt;
         }
@@ -323,17 +330,25 @@ namespace eka2l1::loader {
                 auto read = inflate_machine.read(reinterpret_cast<uint8_t *>(&img.data[img.header.code_offset]),
                     img.uncompressed_size);
             } else if (ctype == compress_type::byte_pair_c) {
-                auto crr_pos = stream->tell();
-
-                std::vector<char> temp(stream->size() - img.header.code_offset);
-                stream->seek(img.header.code_offset, common::seek_where::beg);
-                stream->read(temp.data(), static_cast<uint32_t>(temp.size()));
-
-                common::ro_buf_stream raw_bp_stream(reinterpret_cast<std::uint8_t *>(&temp[0]), temp.size());
+                // The compressed image is already in memory, no need to read it again
+                common::ro_buf_stream raw_bp_stream(reinterpret_cast<std::uint8_t *>(&temp_buf[0]), temp_buf.size());
                 common::ibytepair_stream bpstream(reinterpret_cast<common::ro_stream *>(&raw_bp_stream));
 
-                auto codesize = bpstream.read_pages(&img.data[img.header.code_offset], img.header.code_size);
-                auto restsize = bpstream.read_pages(&img.data[img.header.code_offset + img.header.code_size], img.uncompressed_size);
+                // Code and the rest are two separate runs of pages, each decompressed in parallel.
+                // Demand paged code stays compressed, to be decompressed page by page later.
+                if (demand_page_code) {
+                    img.code_pages = std::make_shared<common::bytepair_page_store>();
+
+                    if (!img.code_pages->load(bpstream, img.header.code_size)) {
+                        LOG_ERROR(LOADER, "Can't read the compressed code pages");
+                        return std::nullopt;
+                    }
+                } else {
+                    bpstream.read_pages(&img.data[img.header.code_offset], img.header.code_size);
+                }
+
+                auto restsize = bpstream.read_pages(&img.data[img.header.code_offset + img.header.code_size],
+                    img.uncompressed_size - img.header.code_size);
             }
         } else {
             img.uncompressed_size = static_cast<uint32_t>(file_size);
@@ -345,6 +360,13 @@ namespace eka2l1::loader {
 
         const std::uint32_t import_export_table_size = img.header.code_size - img.header.text_size;
 
+        // The import address table and the export directory live after the text
+        commit_code_range(img, img.header.text_size, import_export_table_size);
+
+        if (img.header.export_dir_offset != 0) {
+            commit_code_range(img, img.header.export_dir_offset - img.header.code_offset, img.header.export_dir_count * 4);
+        }
+
         parse_export_dir(img);
         parse_iat(img);
 
@@ -387,6 +409,11 @@ namespace eka2l1::loader {
 
             for (auto &oridinal : import.ordinals) {
                 decompressed_stream.read(reinterpret_cast<void *>(&oridinal), 4);
+
+                // On ELF images these are offsets to the code words holding the import info
+                if (static_cast<int>(img.epoc_ver) >= static_cast<int>(epocver::epoc93)) {
+                    commit_code_range(img, oridinal, 4);
+                }
             }
         }
 
@@ -264,7 +264,7 @@ namespace eka2l1::loader {
             return false;
         }
 
-        common::unmap_file(buf);
+        common::unmap_file(buf, bitmap_file_size);
 
         return true;
     }
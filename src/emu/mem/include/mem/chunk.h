@@ -24,7 +24,10 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace eka2l1::common {
     struct bitmap_allocator;
@@ -36,6 +39,14 @@ namespace eka2l1::mem {
 
     struct mem_model_process;
 
+    /**
+     * \brief A range of chunk memory written since a given write stamp.
+     */
+    struct written_range {
+        std::size_t offset_;
+        std::size_t size_;
+    };
+
     struct mem_model_chunk {
         prot permission_;
 
@@ -46,19 +57,62 @@ namespace eka2l1::mem {
         vm_address bottom_;
         vm_address top_;
 
+        std::uint64_t cpu_map_generation_; ///< Changes whenever committed pages change. Unique across chunks.
+
+        bool write_tracked_;                            ///< Guest writes to this chunk are tracked per page.
+        std::vector<std::uint64_t> page_write_stamps_;  ///< Write stamp of each page's latest tracked write.
+        std::vector<bool> page_write_protected_;        ///< Pages which the CPU can't write without us knowing.
+        std::uint64_t write_stamp_counter_;
+        std::mutex write_track_lock_;
+
+        bool demand_paged_;                             ///< Pages are filled on their first access.
+        vm_address demand_paged_base_;                  ///< Base address the chunk is demand paged at.
+        std::vector<bool> page_present_;                ///< Pages which have been filled.
+        std::function<void(const std::size_t, const std::size_t, std::uint8_t *)> page_in_handler_;
+        std::mutex demand_page_lock_;
+
         void manipulate_cpu_map(common::bitmap_allocator *allocator, mem_model_process *process,
             mmu_base *mmu, const bool map);
 
+        /**
+         * \brief Mark that the CPU's view of this chunk needs to be rebuilt on the next sync.
+         */
+        void mark_cpu_map_dirty();
+
+        /**
+         * \brief Unmap write protected pages of this chunk from the CPU, after the chunk has just been mapped.
+         */
+        void apply_write_protection(mmu_base *mmu, const vm_address base_addr);
+
+        /**
+         * \brief Unmap pages of this chunk not filled yet from the CPU, after the chunk has just been mapped.
+         */
+        void apply_demand_paging(mmu_base *mmu, const vm_address base_addr);
+
+        /**
+         * \brief Fill a page if it is not present yet. Must be called with the demand page lock held.
+         */
+        void page_in_locked(const std::size_t page_index);
+
+        /**
+         * \brief Account newly committed pages for write tracking.
+         * 
+         * These pages are mapped to the CPU without protection, so they are treated as written.
+         */
+        void track_committed_pages(const vm_address offset, const std::size_t size);
+
     public:
-        explicit mem_model_chunk(control_base *control, const asid id)
-            : control_(control)
-            , addr_space_id_(id)
-            , bottom_(0)
-            , top_(0) {
-        }
+        /**
+         * \brief Fill a range of a demand paged chunk.
+         * 
+         * The arguments are the offset and size of the range, relative to the chunk's base, and the host
+         * pointer of that offset.
+         */
+        using page_in_handler = std::function<void(const std::size_t, const std::size_t, std::uint8_t *)>;
 
-        virtual ~mem_model_chunk() {
-        }
+        explicit mem_model_chunk(control_base *control, const asid id);
+
+        virtual ~mem_model_chunk();
 
         virtual int do_create(const mem_model_chunk_creation_info &create_info) = 0;
 
@@ -97,6 +151,86 @@ namespace eka2l1::mem {
          * This is support for some JIT's context switching.
          */
         virtual void map_to_cpu(mem_model_process *process, mmu_base *mmu) = 0;
+
+        /**
+         * \brief Make sure the CPU's page table reflects this chunk as mapped in the given process.
+         * 
+         * Does nothing if the CPU still holds this chunk's mapping from the last sync and no page
+         * was committed or decommitted since. Otherwise the whole chunk range is refreshed.
+         */
+        void sync_to_cpu(mem_model_process *process, mmu_base *mmu);
+
+        /**
+         * \brief Start tracking guest writes to this chunk at page granularity.
+         * 
+         * Committed pages are unmapped from the CPU's fast path, so the first write to each of them
+         * goes through the MMU callbacks, where the page is stamped and mapped back. Only chunks
+         * which have the same base address in every process can be tracked.
+         * 
+         * Writes done by the host directly to the chunk memory are not seen.
+         * 
+         * \returns True on success.
+         */
+        bool enable_write_tracking();
+
+        bool is_write_tracked() const {
+            return write_tracked_;
+        }
+
+        /**
+         * \brief Called by the MMU when the CPU writes to a page of this chunk through the slow path.
+         * 
+         * \param mmu  The MMU of the CPU doing the write.
+         * \param addr The virtual address being written.
+         */
+        void handle_cpu_write(mmu_base *mmu, const vm_address addr);
+
+        /**
+         * \brief Collect pages in a region which have been written since the given stamp.
+         * 
+         * Collected pages are write protected again, so later writes to them are noticed.
+         * 
+         * \param offset  Offset of the region, relative to the chunk's base.
+         * \param size    Size of the region.
+         * \param since   Write stamp returned by the last collection of this region. 0 for everything.
+         * \param written Receive the written ranges, merged and clamped to the region.
+         * 
+         * \returns The stamp to pass on the next collection of this region.
+         */
+        std::uint64_t collect_written_pages(const std::size_t offset, const std::size_t size, const std::uint64_t since,
+            std::vector<written_range> &written);
+
+        /**
+         * \brief Fill the pages of this chunk only when they are first accessed.
+         * 
+         * All pages are unmapped from the CPU's fast path. The first access to a page, from the CPU or from
+         * the host getting a pointer through the memory control, calls the handler to fill it, then maps it
+         * back. Only the committed pages are paged, and they must form a single range, like in normal chunks.
+         * The chunk must not be run before this is called.
+         * 
+         * \param process The process the chunk is mapped in, for chunks without a fixed base address.
+         * \param handler The handler filling the pages.
+         * 
+         * \returns True on success.
+         */
+        bool enable_demand_paging(mem_model_process *process, page_in_handler handler);
+
+        bool is_demand_paged() const {
+            return demand_paged_;
+        }
+
+        /**
+         * \brief Fill the page of an address if it is not present yet.
+         * 
+         * \param addr The virtual address being accessed.
+         * \param mmu  The MMU of the CPU doing the access, to map the page to. Null for host accesses.
+         */
+        void page_in(const vm_address addr, mmu_base *mmu);
+
+        /**
+         * \brief Fill all pages not present yet, so the host can access the chunk memory directly.
+         */
+        void page_in_all();
     };
 
     using mem_model_chunk_impl = std::unique_ptr<mem_model_chunk>;
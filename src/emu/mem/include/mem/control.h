@@ -24,6 +24,10 @@
 #include <mem/common.h>
 #include <mem/page.h>
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 namespace eka2l1 {
     namespace config {
         struct state;
@@ -45,6 +49,7 @@ namespace eka2l1::mem {
     };
 
     class mmu_base;
+    struct mem_model_chunk;
 
     class control_base {
     protected:
@@ -53,6 +58,29 @@ namespace eka2l1::mem {
 
         arm::exclusive_monitor *exclusive_monitor_;
 
+        struct write_tracked_chunk {
+            mem_model_chunk *chunk_;
+            vm_address start_;
+            vm_address end_;
+        };
+
+        std::vector<write_tracked_chunk> write_tracked_chunks_;
+        std::atomic<std::uint32_t> write_tracked_count_;
+        std::mutex write_tracked_lock_;
+
+        struct demand_paged_chunk {
+            mem_model_chunk *chunk_;
+            vm_address start_;
+            vm_address end_;
+            asid asid_;
+        };
+
+        std::vector<demand_paged_chunk> demand_paged_chunks_;
+        std::atomic<std::uint32_t> demand_paged_count_;
+        std::atomic<vm_address> demand_paged_low_;      ///< Lowest address any demand paged chunk ever covered.
+        std::atomic<vm_address> demand_paged_high_;     ///< End of the highest demand paged chunk ever registered.
+        std::mutex demand_paged_lock_;
+
     public:
         std::size_t page_size_bits_; ///< The number of bits of page size.
         std::uint32_t offset_mask_;
@@ -87,6 +115,69 @@ namespace eka2l1::mem {
             return mem_map_old_;
         }
 
+        /**
+         * \brief Reserve host memory that will back guest memory.
+         * 
+         * With fastmem enabled, the memory is shareable, so the CPU can alias it into its
+         * host view of the guest address space.
+         */
+        void *reserve_host_memory(const std::size_t size);
+
+        /**
+         * \brief Register a chunk whose guest writes should be tracked.
+         * 
+         * \param chunk The chunk.
+         * \param base  Virtual base address of the chunk, same in all address spaces.
+         * \param size  Maximum size of the chunk.
+         */
+        void add_write_tracked_chunk(mem_model_chunk *chunk, const vm_address base, const std::size_t size);
+        void remove_write_tracked_chunk(mem_model_chunk *chunk);
+
+        bool has_write_tracked_chunks() const {
+            return write_tracked_count_.load(std::memory_order_relaxed) != 0;
+        }
+
+        /**
+         * \brief Notify write tracked chunks of a CPU write that went through the slow path.
+         */
+        void handle_cpu_write(mmu_base *mmu, const vm_address addr);
+
+        /**
+         * \brief Register a chunk whose pages are filled on first access.
+         * 
+         * \param chunk The chunk.
+         * \param base  Virtual base address of the chunk.
+         * \param size  Maximum size of the chunk.
+         * \param id    The address space the chunk is mapped at this address in. -1 for all of them.
+         */
+        void add_demand_paged_chunk(mem_model_chunk *chunk, const vm_address base, const std::size_t size, const asid id);
+        void remove_demand_paged_chunk(mem_model_chunk *chunk);
+
+        /**
+         * \brief Cheap check done before every page in, so addresses far from demand paged chunks
+         *        don't pay for the lookup.
+         */
+        bool may_be_demand_paged(const vm_address addr) const {
+            return (demand_paged_count_.load(std::memory_order_relaxed) != 0) && (addr >= demand_paged_low_.load(std::memory_order_relaxed))
+                && (addr < demand_paged_high_.load(std::memory_order_relaxed));
+        }
+
+        /**
+         * \brief Fill the page of an address, if it belongs to a demand paged chunk and is not present yet.
+         * 
+         * \param id   The address space being accessed.
+         * \param addr The virtual address being accessed.
+         * \param mmu  The MMU of the CPU doing the access, to map the page to. Null for host accesses.
+         */
+        void page_in(const asid id, const vm_address addr, mmu_base *mmu = nullptr);
+
+        /**
+         * \brief Unmap a region from the view of all CPUs managed by this control.
+         * 
+         * The page tables are not touched, so accesses still succeed through the MMU callbacks.
+         */
+        virtual void unmap_from_all_cpus(const vm_address addr, const std::size_t size) = 0;
+
         /**
          * \brief Get a page table by its ID.
          */
@@ -20,13 +20,13 @@
 #pragma once
 
 #include <common/atomic.h>
+#include <common/configure.h>
 
+#include <cpu/arm_interface.h>
+#include <mem/control.h>
 #include <mem/page.h>
 #include <memory>
-
-namespace eka2l1::arm {
-    class core;
-}
+#include <vector>
 
 namespace eka2l1::config {
     struct state;
@@ -34,6 +34,7 @@ namespace eka2l1::config {
 
 namespace eka2l1::mem {
     class control_base;
+    struct mem_model_chunk;
 
     /**
      * \brief The base of memory management unit.
@@ -44,15 +45,118 @@ namespace eka2l1::mem {
 
         control_base *manager_;
 
-        bool read_8bit_data(const vm_address addr, std::uint8_t *data);
-        bool read_16bit_data(const vm_address addr, std::uint16_t *data);
-        bool read_32bit_data(const vm_address addr, std::uint32_t *data);
-        bool read_64bit_data(const vm_address addr, std::uint64_t *data);
+        struct cpu_resident_chunk {
+            const mem_model_chunk *chunk_;
+            vm_address start_;
+            vm_address end_;
+            std::uint64_t generation_;
+            bool kept_; ///< Wanted by the incoming process, during a process switch.
+        };
+
+        std::vector<cpu_resident_chunk> cpu_resident_chunks_; ///< Chunk ranges the CPU page table currently holds.
+
+        /**
+         * \brief Log a memory access done by the CPU. Only called in memory tracing builds.
+         */
+        void trace_access(const vm_address addr, const std::size_t size, const bool is_write);
+
+        template <typename mmu_type, typename control_type>
+        static void *cpu_host_pointer(mmu_type *self, const vm_address addr) {
+            if (self->manager_->may_be_demand_paged(addr)) {
+                // Also maps the page back, so the next access doesn't come here
+                self->manager_->page_in(self->mmu_type::current_addr_space(), addr, self);
+            }
+
+            // Qualified calls, so there is no virtual dispatch on the CPU slow path
+            return static_cast<control_type *>(self->manager_)->control_type::get_host_pointer(
+                self->mmu_type::current_addr_space(), addr);
+        }
+
+        template <typename mmu_type, typename control_type, typename T>
+        static bool cpu_read(void *userdata, const vm_address addr, T *data) {
+            mmu_type *self = reinterpret_cast<mmu_type *>(userdata);
+            T *ptr = reinterpret_cast<T *>(cpu_host_pointer<mmu_type, control_type>(self, addr));
+
+            if (!ptr) {
+                return false;
+            }
+
+            *data = *ptr;
+
+#ifdef ENABLE_MEMORY_TRACE
+            self->trace_access(addr, sizeof(T), false);
+#endif
+
+            return true;
+        }
+
+        template <typename mmu_type, typename control_type, typename T>
+        static bool cpu_write(void *userdata, const vm_address addr, T *data) {
+            mmu_type *self = reinterpret_cast<mmu_type *>(userdata);
+            T *ptr = reinterpret_cast<T *>(cpu_host_pointer<mmu_type, control_type>(self, addr));
+
+            if (!ptr) {
+                return false;
+            }
+
+            *ptr = *data;
+
+            if (self->manager_->has_write_tracked_chunks()) {
+                self->manager_->handle_cpu_write(self, addr);
+            }
+
+#ifdef ENABLE_MEMORY_TRACE
+            self->trace_access(addr, sizeof(T), true);
+#endif
+
+            return true;
+        }
 
-        bool write_8bit_data(const vm_address addr, std::uint8_t *data);
-        bool write_16bit_data(const vm_address addr, std::uint16_t *data);
-        bool write_32bit_data(const vm_address addr, std::uint32_t *data);
-        bool write_64bit_data(const vm_address addr, std::uint64_t *data);
+        template <typename mmu_type, typename control_type, typename T>
+        static std::int32_t cpu_write_exclusive(void *userdata, const vm_address addr, T value, T expected) {
+            mmu_type *self = reinterpret_cast<mmu_type *>(userdata);
+            auto *real_ptr = reinterpret_cast<volatile T *>(self->mmu_type::get_host_pointer(addr));
+
+            if (!real_ptr) {
+                return -1;
+            }
+
+            const std::int32_t result = static_cast<std::int32_t>(common::atomic_compare_and_swap<T>(real_ptr, value, expected));
+
+            if ((result > 0) && self->manager_->has_write_tracked_chunks()) {
+                self->manager_->handle_cpu_write(self, addr);
+            }
+
+            return result;
+        }
+
+        /**
+         * \brief Give the CPU memory accessors specialized for the memory model.
+         * 
+         * Each memory model's MMU calls this in its constructor.
+         */
+        template <typename mmu_type, typename control_type>
+        void install_cpu_memory_callbacks(mmu_type *self) {
+            arm::memory_callbacks callbacks;
+            callbacks.userdata = self;
+
+            callbacks.read_8bit = cpu_read<mmu_type, control_type, std::uint8_t>;
+            callbacks.read_16bit = cpu_read<mmu_type, control_type, std::uint16_t>;
+            callbacks.read_32bit = cpu_read<mmu_type, control_type, std::uint32_t>;
+            callbacks.read_64bit = cpu_read<mmu_type, control_type, std::uint64_t>;
+
+            callbacks.write_8bit = cpu_write<mmu_type, control_type, std::uint8_t>;
+            callbacks.write_16bit = cpu_write<mmu_type, control_type, std::uint16_t>;
+            callbacks.write_32bit = cpu_write<mmu_type, control_type, std::uint32_t>;
+            callbacks.write_64bit = cpu_write<mmu_type, control_type, std::uint64_t>;
+
+            callbacks.exclusive_write_8bit = cpu_write_exclusive<mmu_type, control_type, std::uint8_t>;
+            callbacks.exclusive_write_16bit = cpu_write_exclusive<mmu_type, control_type, std::uint16_t>;
+            callbacks.exclusive_write_32bit = cpu_write_exclusive<mmu_type, control_type, std::uint32_t>;
+            callbacks.exclusive_write_64bit = cpu_write_exclusive<mmu_type, control_type, std::uint64_t>;
+
+            cpu_->set_memory_callbacks(callbacks);
+        }
 
     public:
         arm::core *cpu_;
@@ -65,6 +169,50 @@ namespace eka2l1::mem {
         void map_to_cpu(const vm_address addr, const std::size_t size, void *ptr, const prot perm);
         void unmap_from_cpu(const vm_address addr, const std::size_t size);
 
+        /**
+         * \brief Check if the CPU page table still holds the given chunk mapping, unchanged.
+         */
+        bool is_chunk_resident_in_cpu(const mem_model_chunk *chunk, const vm_address base, const std::uint64_t generation) const;
+
+        /**
+         * \brief Remember that the CPU page table now holds the given chunk mapping.
+         * 
+         * Mappings of other chunks overlapping the range are forgotten, since they got overwritten.
+         */
+        void mark_chunk_resident_in_cpu(const mem_model_chunk *chunk, const vm_address base, const std::size_t size,
+            const std::uint64_t generation);
+
+        /**
+         * \brief Remember that the CPU page table may hold the given chunk mapping.
+         * 
+         * For chunks that were mapped outside of a sync, so that a process switch still knows to drop
+         * them. Their content is considered unknown, so the next sync refreshes the whole range.
+         */
+        void note_chunk_in_cpu(const mem_model_chunk *chunk, const vm_address base, const std::size_t size);
+
+        /**
+         * \brief Start a process switch. All chunk mappings the CPU page table holds are marked as unwanted.
+         */
+        void begin_chunk_switch();
+
+        /**
+         * \brief Mark a chunk mapping as wanted by the incoming process.
+         */
+        void keep_chunk_in_cpu(const mem_model_chunk *chunk, const vm_address base);
+
+        /**
+         * \brief Unmap from the CPU all chunk mappings not marked as wanted since the switch started.
+         * 
+         * Needed for CPUs that keep old mappings, or the incoming process could reach the private
+         * chunks of the previous one.
+         */
+        void drop_unkept_chunks();
+
+        /**
+         * \brief Forget all chunk mappings the CPU page table holds.
+         */
+        void clear_chunk_residency();
+
         /**
          * \brief Get host pointer of a virtual address, in the specified address space.
          */
@@ -82,7 +230,13 @@ namespace eka2l1::mem {
                 return -1;
             }
 
-            return static_cast<std::int32_t>(common::atomic_compare_and_swap<T>(real_ptr, value, expected));
+            const std::int32_t result = static_cast<std::int32_t>(common::atomic_compare_and_swap<T>(real_ptr, value, expected));
+
+            if ((result > 0) && manager_->has_write_tracked_chunks()) {
+                manager_->handle_cpu_write(this, addr);
+            }
+
+            return result;
         }
 
         /**
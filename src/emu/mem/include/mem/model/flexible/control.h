@@ -62,6 +62,8 @@ namespace eka2l1::mem::flexible {
          */
         void *get_host_pointer(const asid id, const vm_address addr) override;
 
+        void unmap_from_all_cpus(const vm_address addr, const std::size_t size) override;
+
         /**
          * \brief Create or renew an address space if possible.
          * 
@@ -22,12 +22,320 @@
 #include <mem/mmu.h>
 #include <mem/model/flexible/chunk.h>
 #include <mem/model/multiple/chunk.h>
+#include <mem/process.h>
 
 #include <common/algorithm.h>
 #include <common/allocator.h>
 #include <common/log.h>
+#include <cpu/arm_interface.h>
+
+#include <algorithm>
+#include <atomic>
 
 namespace eka2l1::mem {
+    static std::atomic<std::uint64_t> cpu_map_generation_counter{ 0 };
+
+    mem_model_chunk::mem_model_chunk(control_base *control, const asid id)
+        : control_(control)
+        , addr_space_id_(id)
+        , bottom_(0)
+        , top_(0)
+        , cpu_map_generation_(++cpu_map_generation_counter)
+        , write_tracked_(false)
+        , write_stamp_counter_(0)
+        , demand_paged_(false)
+        , demand_paged_base_(0) {
+    }
+
+    mem_model_chunk::~mem_model_chunk() {
+        if (write_tracked_) {
+            control_->remove_write_tracked_chunk(this);
+        }
+
+        if (demand_paged_) {
+            control_->remove_demand_paged_chunk(this);
+        }
+    }
+
+    void mem_model_chunk::mark_cpu_map_dirty() {
+        cpu_map_generation_ = ++cpu_map_generation_counter;
+    }
+
+    void mem_model_chunk::sync_to_cpu(mem_model_process *process, mmu_base *mmu) {
+        const vm_address base_addr = base(process);
+
+        if (mmu->is_chunk_resident_in_cpu(this, base_addr, cpu_map_generation_)) {
+            return;
+        }
+
+        if (!mmu->cpu_->should_clear_old_memory_map()) {
+            // The CPU keeps old mappings around, so this range may still hold pages of another
+            // process's chunk, or pages we decommitted while not being mapped. Clear them.
+            mmu->unmap_from_cpu(base_addr, max());
+        }
+
+        map_to_cpu(process, mmu);
+        mmu->mark_chunk_resident_in_cpu(this, base_addr, max(), cpu_map_generation_);
+    }
+
+    bool mem_model_chunk::enable_write_tracking() {
+        if (write_tracked_) {
+            return true;
+        }
+
+        const vm_address base_addr = base(nullptr);
+
+        if (!base_addr) {
+            LOG_ERROR(MEMORY, "Chunk does not have a fixed base address, can't track writes to it!");
+            return false;
+        }
+
+        const std::lock_guard<std::mutex> guard(write_track_lock_);
+        const std::size_t total_pages = max() >> control_->page_size_bits_;
+
+        // Everything is considered written once, so the first collection of any region reports it all
+        write_stamp_counter_ = 1;
+
+        page_write_stamps_.assign(total_pages, write_stamp_counter_);
+        page_write_protected_.assign(total_pages, true);
+
+        write_tracked_ = true;
+
+        control_->unmap_from_all_cpus(base_addr, max());
+        control_->add_write_tracked_chunk(this, base_addr, max());
+
+        return true;
+    }
+
+    void mem_model_chunk::apply_write_protection(mmu_base *mmu, const vm_address base_addr) {
+        const std::lock_guard<std::mutex> guard(write_track_lock_);
+        const std::size_t total_pages = page_write_protected_.size();
+
+        for (std::size_t i = 0; i < total_pages; i++) {
+            if (!page_write_protected_[i]) {
+                continue;
+            }
+
+            const std::size_t run_start = i;
+
+            while ((i < total_pages) && page_write_protected_[i]) {
+                i++;
+            }
+
+            mmu->unmap_from_cpu(static_cast<vm_address>(base_addr + (run_start << control_->page_size_bits_)),
+                (i - run_start) << control_->page_size_bits_);
+        }
+    }
+
+    void mem_model_chunk::track_committed_pages(const vm_address offset, const std::size_t size) {
+        if (!write_tracked_ || !size) {
+            return;
+        }
+
+        const std::lock_guard<std::mutex> guard(write_track_lock_);
+
+        const std::size_t first_page = offset >> control_->page_size_bits_;
+        const std::size_t last_page = common::min<std::size_t>((offset + size - 1) >> control_->page_size_bits_,
+            page_write_stamps_.size() - 1);
+
+        write_stamp_counter_++;
+
+        for (std::size_t i = first_page; i <= last_page; i++) {
+            page_write_stamps_[i] = write_stamp_counter_;
+            page_write_protected_[i] = false;
+        }
+    }
+
+    void mem_model_chunk::handle_cpu_write(mmu_base *mmu, const vm_address addr) {
+        const std::lock_guard<std::mutex> guard(write_track_lock_);
+
+        const vm_address base_addr = base(nullptr);
+        const std::size_t page_index = (addr - base_addr) >> control_->page_size_bits_;
+
+        if (page_index >= page_write_stamps_.size()) {
+            return;
+        }
+
+        if (page_write_protected_[page_index]) {
+            page_write_stamps_[page_index] = ++write_stamp_counter_;
+            page_write_protected_[page_index] = false;
+        }
+
+        // Map the page back for this CPU, so later writes are fast again. Other CPUs will come
+        // here on their own first write.
+        const std::size_t page_offset = page_index << control_->page_size_bits_;
+        mmu->map_to_cpu(static_cast<vm_address>(base_addr + page_offset), control_->page_size(),
+            reinterpret_cast<std::uint8_t *>(host_base()) + page_offset, permission_);
+    }
+
+    std::uint64_t mem_model_chunk::collect_written_pages(const std::size_t offset, const std::size_t size, const std::uint64_t since,
+        std::vector<written_range> &written) {
+        written.clear();
+
+        if (!write_tracked_ || !size) {
+            return since;
+        }
+
+        const std::lock_guard<std::mutex> guard(write_track_lock_);
+
+        const vm_address base_addr = base(nullptr);
+        const std::size_t psize = control_->page_size();
+        const std::size_t first_page = offset >> control_->page_size_bits_;
+        const std::size_t last_page = common::min<std::size_t>((offset + size - 1) >> control_->page_size_bits_,
+            page_write_stamps_.size() - 1);
+
+        const std::size_t region_end = offset + size;
+
+        // Writes stamped after this point are not covered by this collection
+        const std::uint64_t collect_stamp = write_stamp_counter_;
+
+        for (std::size_t i = first_page; i <= last_page; i++) {
+            if (page_write_stamps_[i] <= since) {
+                continue;
+            }
+
+            const std::size_t page_start = i << control_->page_size_bits_;
+            const std::size_t range_start = common::max(page_start, offset);
+            const std::size_t range_end = common::min(page_start + psize, region_end);
+
+            if (!written.empty() && (written.back().offset_ + written.back().size_ == range_start)) {
+                written.back().size_ += range_end - range_start;
+            } else {
+                written.push_back({ range_start, range_end - range_start });
+            }
+
+            if (!page_write_protected_[i]) {
+                page_write_protected_[i] = true;
+                control_->unmap_from_all_cpus(static_cast<vm_address>(base_addr + page_start), psize);
+            }
+        }
+
+        return collect_stamp;
+    }
+
+    bool mem_model_chunk::enable_demand_paging(mem_model_process *process, page_in_handler handler) {
+        if (demand_paged_) {
+            return true;
+        }
+
+        // Only the committed range is paged, so it must be a single one
+        if (!handler || !committed() || (committed() != top() - bottom())) {
+            LOG_ERROR(MEMORY, "Only chunks committed as a single range can be demand paged!");
+            return false;
+        }
+
+        vm_address base_addr = base(nullptr);
+        asid id = -1;
+
+        if (!base_addr && process) {
+            // Mapped in a single process, so the base address must be matched with its address space
+            base_addr = base(process);
+            id = process->address_space_id();
+        }
+
+        if (!base_addr) {
+            LOG_ERROR(MEMORY, "Chunk does not have a base address, can't demand page it!");
+            return false;
+        }
+
+        {
+            const std::lock_guard<std::mutex> guard(demand_page_lock_);
+
+            page_present_.assign(max() >> control_->page_size_bits_, true);
+            std::fill(page_present_.begin() + bottom_, page_present_.begin() + top_, false);
+
+            page_in_handler_ = std::move(handler);
+            demand_paged_base_ = base_addr;
+            demand_paged_ = true;
+        }
+
+        control_->unmap_from_all_cpus(base_addr + bottom(), committed());
+        control_->add_demand_paged_chunk(this, base_addr + bottom(), committed(), id);
+
+        return true;
+    }
+
+    void mem_model_chunk::page_in_locked(const std::size_t page_index) {
+        if (page_present_[page_index]) {
+            return;
+        }
+
+        const std::size_t page_offset = page_index << control_->page_size_bits_;
+
+        page_in_handler_(page_offset, control_->page_size(), reinterpret_cast<std::uint8_t *>(host_base()) + page_offset);
+        page_present_[page_index] = true;
+    }
+
+    void mem_model_chunk::page_in(const vm_address addr, mmu_base *mmu) {
+        const std::lock_guard<std::mutex> guard(demand_page_lock_);
+
+        if (!demand_paged_ || (addr < demand_paged_base_)) {
+            return;
+        }
+
+        const std::size_t page_index = (addr - demand_paged_base_) >> control_->page_size_bits_;
+
+        if (page_index >= page_present_.size()) {
+            return;
+        }
+
+        page_in_locked(page_index);
+
+        if (mmu) {
+            // Map the page for this CPU, so later accesses are fast. Other CPUs will come here on their own.
+            const std::size_t page_offset = page_index << control_->page_size_bits_;
+            mmu->map_to_cpu(static_cast<vm_address>(demand_paged_base_ + page_offset), control_->page_size(),
+                reinterpret_cast<std::uint8_t *>(host_base()) + page_offset, permission_);
+        }
+    }
+
+    void mem_model_chunk::page_in_all() {
+        const std::lock_guard<std::mutex> guard(demand_page_lock_);
+
+        if (!demand_paged_) {
+            return;
+        }
+
+        const std::size_t total_pages = page_present_.size();
+
+        for (std::size_t i = 0; i < total_pages; i++) {
+            if (page_present_[i]) {
+                continue;
+            }
+
+            const std::size_t run_start = i;
+
+            while ((i < total_pages) && !page_present_[i]) {
+                page_present_[i++] = true;
+            }
+
+            // Fill the run in one go, the handler may do it faster than page by page
+            const std::size_t run_offset = run_start << control_->page_size_bits_;
+            page_in_handler_(run_offset, (i - run_start) << control_->page_size_bits_,
+                reinterpret_cast<std::uint8_t *>(host_base()) + run_offset);
+        }
+    }
+
+    void mem_model_chunk::apply_demand_paging(mmu_base *mmu, const vm_address base_addr) {
+        const std::lock_guard<std::mutex> guard(demand_page_lock_);
+        const std::size_t total_pages = page_present_.size();
+
+        for (std::size_t i = 0; i < total_pages; i++) {
+            if (page_present_[i]) {
+                continue;
+            }
+
+            const std::size_t run_start = i;
+
+            while ((i < total_pages) && !page_present_[i]) {
+                i++;
+            }
+
+            mmu->unmap_from_cpu(static_cast<vm_address>(base_addr + (run_start << control_->page_size_bits_)),
+                (i - run_start) << control_->page_size_bits_);
+        }
+    }
+
     const vm_address mem_model_chunk::bottom() const {
         return bottom_ << control_->page_size_bits_;
     }
@@ -95,6 +403,15 @@ namespace eka2l1::mem {
         if (!allocator) {
             // Contigious types. Just unmap/map directly
             do_the_map(bottom_, top_ - bottom_);
+
+            if (map && write_tracked_) {
+                apply_write_protection(mmu, base_addr);
+            }
+
+            if (map && demand_paged_) {
+                apply_demand_paging(mmu, base_addr);
+            }
+
             return;
         }
 
@@ -126,6 +443,14 @@ namespace eka2l1::mem {
                 }
             }
         }
+
+        if (map && write_tracked_) {
+            apply_write_protection(mmu, base_addr);
+        }
+
+        if (map && demand_paged_) {
+            apply_demand_paging(mmu, base_addr);
+        }
     }
     
     mem_model_chunk_impl make_new_mem_model_chunk(control_base *control, const asid addr_space_id,
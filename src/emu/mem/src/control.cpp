@@ -17,14 +17,20 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <common/algorithm.h>
+#include <common/virtualmem.h>
+#include <config/config.h>
 #include <cpu/arm_interface.h>
 
+#include <mem/chunk.h>
 #include <mem/control.h>
 #include <mem/mmu.h>
 
 #include <mem/model/flexible/control.h>
 #include <mem/model/multiple/control.h>
 
+#include <algorithm>
+
 namespace eka2l1::mem {
     control_base::control_base(arm::exclusive_monitor *monitor, page_table_allocator *alloc, config::state *conf,
         std::size_t psize_bits, const bool mem_map_old)
@@ -32,7 +38,11 @@ namespace eka2l1::mem {
         , conf_(conf)
         , page_size_bits_(psize_bits)
         , mem_map_old_(mem_map_old)
-        , exclusive_monitor_(monitor) {
+        , exclusive_monitor_(monitor)
+        , write_tracked_count_(0)
+        , demand_paged_count_(0)
+        , demand_paged_low_(0xFFFFFFFF)
+        , demand_paged_high_(0) {
         if (psize_bits == 20) {
             offset_mask_ = OFFSET_MASK_20B;
             page_table_index_shift_ = PAGE_TABLE_INDEX_SHIFT_20B;
@@ -56,22 +66,22 @@ namespace eka2l1::mem {
         if (exclusive_monitor_) {
             exclusive_monitor_->read_8bit = [this](arm::core *core, const vm_address addr, std::uint8_t* data) {
                 mmu_base *mm = get_or_create_mmu(core);
-                return mm->read_8bit_data(addr, data);
+                return mm->cpu_->read_8bit(addr, data);
             };
             
             exclusive_monitor_->read_16bit = [this](arm::core *core, const vm_address addr, std::uint16_t* data) {
                 mmu_base *mm = get_or_create_mmu(core);
-                return mm->read_16bit_data(addr, data); 
+                return mm->cpu_->read_16bit(addr, data);
             };
 
             exclusive_monitor_->read_32bit = [this](arm::core *core, const vm_address addr, std::uint32_t* data) {
                 mmu_base *mm = get_or_create_mmu(core);
-                return mm->read_32bit_data(addr, data);
+                return mm->cpu_->read_32bit(addr, data);
             };
 
             exclusive_monitor_->read_64bit = [this](arm::core *core, const vm_address addr, std::uint64_t* data) {
                 mmu_base *mm = get_or_create_mmu(core);
-                return mm->read_64bit_data(addr, data);
+                return mm->cpu_->read_64bit(addr, data);
             };
 
             exclusive_monitor_->write_8bit = [this](arm::core *core, const vm_address addr, std::uint8_t value, std::uint8_t expected) {
@@ -99,6 +109,72 @@ namespace eka2l1::mem {
     control_base::~control_base() {
     }
     
+    void *control_base::reserve_host_memory(const std::size_t size) {
+        if (conf_ && conf_->fastmem) {
+            return common::map_memory_shareable(size);
+        }
+
+        return common::map_memory(size);
+    }
+
+    void control_base::add_write_tracked_chunk(mem_model_chunk *chunk, const vm_address base, const std::size_t size) {
+        const std::lock_guard<std::mutex> guard(write_tracked_lock_);
+
+        write_tracked_chunks_.push_back({ chunk, base, static_cast<vm_address>(base + size) });
+        write_tracked_count_ = static_cast<std::uint32_t>(write_tracked_chunks_.size());
+    }
+
+    void control_base::remove_write_tracked_chunk(mem_model_chunk *chunk) {
+        const std::lock_guard<std::mutex> guard(write_tracked_lock_);
+
+        write_tracked_chunks_.erase(std::remove_if(write_tracked_chunks_.begin(), write_tracked_chunks_.end(),
+            [chunk](const write_tracked_chunk &tracked) { return tracked.chunk_ == chunk; }), write_tracked_chunks_.end());
+
+        write_tracked_count_ = static_cast<std::uint32_t>(write_tracked_chunks_.size());
+    }
+
+    void control_base::handle_cpu_write(mmu_base *mmu, const vm_address addr) {
+        const std::lock_guard<std::mutex> guard(write_tracked_lock_);
+
+        for (const write_tracked_chunk &tracked : write_tracked_chunks_) {
+            if ((addr >= tracked.start_) && (addr < tracked.end_)) {
+                tracked.chunk_->handle_cpu_write(mmu, addr);
+                return;
+            }
+        }
+    }
+
+    void control_base::add_demand_paged_chunk(mem_model_chunk *chunk, const vm_address base, const std::size_t size, const asid id) {
+        const std::lock_guard<std::mutex> guard(demand_paged_lock_);
+
+        demand_paged_chunks_.push_back({ chunk, base, static_cast<vm_address>(base + size), id });
+
+        // The bounds are never shrunk, they only filter out accesses that can't possibly need a page in
+        demand_paged_low_ = common::min<vm_address>(demand_paged_low_, base);
+        demand_paged_high_ = common::max<vm_address>(demand_paged_high_, static_cast<vm_address>(base + size));
+        demand_paged_count_ = static_cast<std::uint32_t>(demand_paged_chunks_.size());
+    }
+
+    void control_base::remove_demand_paged_chunk(mem_model_chunk *chunk) {
+        const std::lock_guard<std::mutex> guard(demand_paged_lock_);
+
+        demand_paged_chunks_.erase(std::remove_if(demand_paged_chunks_.begin(), demand_paged_chunks_.end(),
+            [chunk](const demand_paged_chunk &paged) { return paged.chunk_ == chunk; }), demand_paged_chunks_.end());
+
+        demand_paged_count_ = static_cast<std::uint32_t>(demand_paged_chunks_.size());
+    }
+
+    void control_base::page_in(const asid id, const vm_address addr, mmu_base *mmu) {
+        const std::lock_guard<std::mutex> guard(demand_paged_lock_);
+
+        for (const demand_paged_chunk &paged : demand_paged_chunks_) {
+            if ((addr >= paged.start_) && (addr < paged.end_) && ((paged.asid_ < 0) || (paged.asid_ == id))) {
+                paged.chunk_->page_in(addr, mmu);
+                return;
+            }
+        }
+    }
+
     page_table *control_base::create_new_page_table() {
         return alloc_->create_new(page_size_bits_);
     }
@@ -35,14 +35,16 @@
 namespace eka2l1 {
     memory_system::memory_system(arm::exclusive_monitor *monitor, config::state *conf,
         const mem::mem_model_type model_type, const bool mem_map_old)
-        : conf_(conf) {
+        : rom_map_(nullptr)
+        , rom_size_(0)
+        , conf_(conf) {
         alloc_ = std::make_unique<mem::basic_page_table_allocator>();
         impl_ = mem::make_new_control(monitor, alloc_.get(), conf_, 12, mem_map_old, model_type);
     }
 
     memory_system::~memory_system() {
         if (rom_map_) {
-            common::unmap_file(rom_map_);
+            common::unmap_file(rom_map_, rom_size_);
         }
     }
 
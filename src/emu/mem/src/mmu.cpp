@@ -26,37 +26,13 @@
 #include <mem/model/flexible/mmu.h>
 #include <mem/model/multiple/mmu.h>
 
+#include <algorithm>
+
 namespace eka2l1::mem {
     mmu_base::mmu_base(control_base *manager, arm::core *cpu, config::state *conf)
         : manager_(manager)
         , cpu_(cpu)
         , conf_(conf) {
-        // Set CPU read/write functions
-        cpu->read_8bit = [this](const vm_address addr, std::uint8_t* data) { return read_8bit_data(addr, data); };
-        cpu->read_16bit = [this](const vm_address addr, std::uint16_t* data) { return read_16bit_data(addr, data); };
-        cpu->read_32bit = [this](const vm_address addr, std::uint32_t* data) { return read_32bit_data(addr, data); };
-        cpu->read_64bit = [this](const vm_address addr, std::uint64_t* data) { return read_64bit_data(addr, data); };
-
-        cpu->write_8bit = [this](const vm_address addr, std::uint8_t* data) { return write_8bit_data(addr, data); };
-        cpu->write_16bit = [this](const vm_address addr, std::uint16_t* data) { return write_16bit_data(addr, data); };
-        cpu->write_32bit = [this](const vm_address addr, std::uint32_t* data) { return write_32bit_data(addr, data); };
-        cpu->write_64bit = [this](const vm_address addr, std::uint64_t* data) { return write_64bit_data(addr, data); };
-
-        cpu->exclusive_write_8bit = [this](const vm_address addr, std::uint8_t value, std::uint8_t expected) {
-            return write_exclusive<std::uint8_t>(addr, value, expected);
-        };
-
-        cpu->exclusive_write_16bit = [this](const vm_address addr, std::uint16_t value, std::uint16_t expected) {
-            return write_exclusive<std::uint16_t>(addr, value, expected);
-        };
-
-        cpu->exclusive_write_32bit = [this](const vm_address addr, std::uint32_t value, std::uint32_t expected) {
-            return write_exclusive<std::uint32_t>(addr, value, expected);
-        };
-
-        cpu->exclusive_write_64bit = [this](const vm_address addr, std::uint64_t value, std::uint64_t expected) {
-            return write_exclusive<std::uint64_t>(addr, value, expected);
-        };
     }
 
     void mmu_base::map_to_cpu(const vm_address addr, const std::size_t size, void *ptr, const prot perm) {
@@ -67,141 +43,79 @@ namespace eka2l1::mem {
         cpu_->unmap_memory(addr, size);
     }
 
-    /// ================== MISCS ====================
-
-    bool mmu_base::read_8bit_data(const vm_address addr, std::uint8_t *data) {
-        std::uint8_t *ptr = reinterpret_cast<std::uint8_t*>(manager_->
-            get_host_pointer(current_addr_space(), addr));
-
-        if (!ptr) {
-            return false;
-        }
-
-        *data = *ptr;
-
-        if (conf_->log_read) {
-            LOG_TRACE(MEMORY, "Read 1 byte from address 0x{:X}", addr);
+    bool mmu_base::is_chunk_resident_in_cpu(const mem_model_chunk *chunk, const vm_address base, const std::uint64_t generation) const {
+        for (const cpu_resident_chunk &resident : cpu_resident_chunks_) {
+            if ((resident.chunk_ == chunk) && (resident.start_ == base)) {
+                return (resident.generation_ == generation);
+            }
         }
 
-        return true;
+        return false;
     }
 
-    bool mmu_base::read_16bit_data(const vm_address addr, std::uint16_t *data) {
-        std::uint16_t *ptr = reinterpret_cast<std::uint16_t*>(manager_->
-            get_host_pointer(current_addr_space(), addr));
-
-        if (!ptr) {
-            return false;
-        }
+    void mmu_base::mark_chunk_resident_in_cpu(const mem_model_chunk *chunk, const vm_address base, const std::size_t size,
+        const std::uint64_t generation) {
+        const vm_address end = static_cast<vm_address>(base + size);
 
-        *data = *ptr;
-
-        if (conf_->log_read) {
-            LOG_TRACE(MEMORY, "Read 2 bytes from address 0x{:X}", addr);
-        }
+        cpu_resident_chunks_.erase(std::remove_if(cpu_resident_chunks_.begin(), cpu_resident_chunks_.end(),
+            [&](const cpu_resident_chunk &resident) {
+                return (resident.chunk_ == chunk) || ((resident.start_ < end) && (base < resident.end_));
+            }), cpu_resident_chunks_.end());
 
-        return true;
+        cpu_resident_chunks_.push_back({ chunk, base, end, generation, true });
     }
 
-    bool mmu_base::read_32bit_data(const vm_address addr, std::uint32_t *data) {
-        std::uint32_t *ptr = reinterpret_cast<std::uint32_t*>(manager_->
-            get_host_pointer(current_addr_space(), addr));
-
-        if (!ptr) {
-            return false;
+    void mmu_base::note_chunk_in_cpu(const mem_model_chunk *chunk, const vm_address base, const std::size_t size) {
+        for (const cpu_resident_chunk &resident : cpu_resident_chunks_) {
+            if ((resident.chunk_ == chunk) && (resident.start_ == base)) {
+                return;
+            }
         }
 
-        *data = *ptr;
-
-        if (conf_->log_read) {
-            LOG_TRACE(MEMORY, "Read 4 bytes from address 0x{:X}", addr);
-        }
-
-        return true;
+        // Generation 0 is never given to a chunk, so the next sync does a full refresh
+        cpu_resident_chunks_.push_back({ chunk, base, static_cast<vm_address>(base + size), 0, true });
     }
 
-    bool mmu_base::read_64bit_data(const vm_address addr, std::uint64_t *data) {
-        std::uint64_t *ptr = reinterpret_cast<std::uint64_t*>(manager_->
-            get_host_pointer(current_addr_space(), addr));
-
-        if (!ptr) {
-            return false;
+    void mmu_base::begin_chunk_switch() {
+        for (cpu_resident_chunk &resident : cpu_resident_chunks_) {
+            resident.kept_ = false;
         }
-
-        *data = *ptr;
-
-        if (conf_->log_read) {
-            LOG_TRACE(MEMORY, "Read 8 bytes from address 0x{:X}", addr);
-        }
-
-        return true;
     }
 
-    bool mmu_base::write_8bit_data(const vm_address addr, std::uint8_t *data) {
-        std::uint8_t *ptr = reinterpret_cast<std::uint8_t*>(manager_->
-            get_host_pointer(current_addr_space(), addr));
-
-        if (!ptr) {
-            return false;
+    void mmu_base::keep_chunk_in_cpu(const mem_model_chunk *chunk, const vm_address base) {
+        for (cpu_resident_chunk &resident : cpu_resident_chunks_) {
+            if ((resident.chunk_ == chunk) && (resident.start_ == base)) {
+                resident.kept_ = true;
+                return;
+            }
         }
-
-        *ptr = *data;
-
-        if (conf_->log_write) {
-            LOG_TRACE(MEMORY, "Write 1 byte to address 0x{:X}", addr);
-        }
-
-        return true;
     }
 
-    bool mmu_base::write_16bit_data(const vm_address addr, std::uint16_t *data) {
-        std::uint16_t *ptr = reinterpret_cast<std::uint16_t*>(manager_->
-            get_host_pointer(current_addr_space(), addr));
-
-        if (!ptr) {
-            return false;
-        }
-
-        *ptr = *data;
+    void mmu_base::drop_unkept_chunks() {
+        cpu_resident_chunks_.erase(std::remove_if(cpu_resident_chunks_.begin(), cpu_resident_chunks_.end(),
+            [this](const cpu_resident_chunk &resident) {
+                if (resident.kept_) {
+                    return false;
+                }
 
-        if (conf_->log_write) {
-            LOG_TRACE(MEMORY, "Write 2 bytes to address 0x{:X}", addr);
-        }
-
-        return true;
+                unmap_from_cpu(resident.start_, resident.end_ - resident.start_);
+                return true;
+            }), cpu_resident_chunks_.end());
     }
 
-    bool mmu_base::write_32bit_data(const vm_address addr, std::uint32_t *data) {
-        std::uint32_t *ptr = reinterpret_cast<std::uint32_t*>(manager_->get_host_pointer(
-            current_addr_space(), addr));
-
-        if (!ptr) {
-            return false;
-        }
-
-        *ptr = *data;
-
-        if (conf_->log_write) {
-            LOG_TRACE(MEMORY, "Write 4 bytes to address 0x{:X}", addr);
-        }
-
-        return true;
+    void mmu_base::clear_chunk_residency() {
+        cpu_resident_chunks_.clear();
     }
 
-    bool mmu_base::write_64bit_data(const vm_address addr, std::uint64_t *data) {
-        std::uint64_t *ptr = reinterpret_cast<std::uint64_t*>(manager_->
-            get_host_pointer(current_addr_space(), addr));
-
-        if (!ptr) {
-            return false;
+    void mmu_base::trace_access(const vm_address addr, const std::size_t size, const bool is_write) {
+        if (is_write) {
+            if (conf_->log_write) {
+                LOG_TRACE(MEMORY, "Write {} bytes to address 0x{:X}", size, addr);
+            }
+        } else {
+            if (conf_->log_read) {
+                LOG_TRACE(MEMORY, "Read {} bytes from address 0x{:X}", size, addr);
+            }
         }
-
-        *ptr = *data;
-
-        if (conf_->log_write) {
-            LOG_TRACE(MEMORY, "Write 8 bytes to address 0x{:X}", addr);
-        }
-
-        return true;
     }
 }
@@ -87,6 +87,8 @@ namespace eka2l1::mem::flexible {
             page_bma_->force_fill(dropping_place, total_page_to_commit);
         }
 
+        track_committed_pages(offset, static_cast<std::size_t>(total_page_to_commit) << control_->page_size_bits_);
+        mark_cpu_map_dirty();
         return total_page_to_commit;
     }
 
@@ -106,6 +108,7 @@ namespace eka2l1::mem::flexible {
         }
 
         committed_ -= static_cast<std::uint32_t>(total_page_to_decommit << control_->page_size_bits_);
+        mark_cpu_map_dirty();
     }
 
     bool flexible_mem_model_chunk::allocate(const std::size_t size) {
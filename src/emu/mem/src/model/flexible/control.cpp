@@ -61,7 +61,19 @@ namespace eka2l1::mem::flexible {
         return mmus_.back().get();
     }
 
+    void control_flexible::unmap_from_all_cpus(const vm_address addr, const std::size_t size) {
+        for (auto &inst: mmus_) {
+            if (inst) {
+                inst->unmap_from_cpu(addr, size);
+            }
+        }
+    }
+
     void *control_flexible::get_host_pointer(const asid id, const vm_address addr) {
+        if (may_be_demand_paged(addr)) {
+            page_in(id, addr);
+        }
+
         if ((id <= 0) || (addr >= (mem_map_old_ ? rom_eka1 : rom))) {
             // Directory của kernel
             return kern_addr_space_->dir_->get_pointer(addr);
@@ -151,6 +151,7 @@ namespace eka2l1::mem::flexible {
             if (!tbl) {
                 // Oops, you are unmapping something that has not even mapped
                 // LOG_WARN(MEMORY, "Trying to unmap a region that doesn't have a page table!");
+                start_addr = next_end_addr;
                 continue;
             }
 
@@ -35,7 +35,7 @@ namespace eka2l1::mem::flexible {
         if (data_) {
             external_ = true;
         } else {
-            data_ = common::map_memory(page_count * ctrl->page_size());
+            data_ = ctrl->reserve_host_memory(page_count * ctrl->page_size());
 
             if (!data_) {
                 LOG_ERROR(MEMORY, "Unable to allocate virtual memory for this memory object (page count = {})",
@@ -80,8 +80,6 @@ namespace eka2l1::mem::flexible {
                     // Map it to CPU right away
                     mm->map_to_cpu(mapping->base_ + start_offset, size_to_commit, reinterpret_cast<std::uint8_t*>(data_) +
                         start_offset, perm);
-
-                    break;
                 }
             }
         }
@@ -118,7 +116,6 @@ namespace eka2l1::mem::flexible {
                 if (mapping->owner_->id() == mm->current_addr_space()) {
                     // Unmap from to CPU right away
                     mm->unmap_from_cpu(mapping->base_ + start_offset, size_to_decommit);
-                    break;
                 }
             }
         }
@@ -28,6 +28,8 @@ namespace eka2l1::mem::flexible {
         // Set kernel directory as the first one active
         control_flexible *ctrl_fx = reinterpret_cast<control_flexible*>(manager_);
         set_current_addr_space(ctrl_fx->kern_addr_space_->id());
+
+        install_cpu_memory_callbacks<mmu_flexible, control_flexible>(this);
     }
     
     const asid mmu_flexible::current_addr_space() const {
@@ -53,6 +55,10 @@ namespace eka2l1::mem::flexible {
             return nullptr;
         }
 
+        if (manager_->may_be_demand_paged(addr)) {
+            manager_->page_in(current_addr_space(), addr, this);
+        }
+
         return cur_dir_->get_pointer(addr);
     }
 }
\ No newline at end of file
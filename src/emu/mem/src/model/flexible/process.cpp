@@ -77,6 +77,10 @@ namespace eka2l1::mem::flexible {
     }
 
     void *flexible_mem_model_process::get_pointer(const vm_address addr) {
+        if (control_->may_be_demand_paged(addr)) {
+            control_->page_in(address_space_id(), addr);
+        }
+
         return addr_space_->dir_->get_pointer(addr);
     }
 
@@ -139,19 +143,44 @@ namespace eka2l1::mem::flexible {
     }
 
     void flexible_mem_model_process::unmap_from_cpu(mmu_base *mmu) {
+        if (!mmu->cpu_->should_clear_old_memory_map()) {
+            // Leave the mappings in, but make sure they are known. The next process unmaps
+            // what it does not share with us before syncing its own chunks.
+            for (auto &attached: attachs_) {
+                if (should_do_cpu_manipulate(attached.chunk_->flags_)) {
+                    mmu->note_chunk_in_cpu(attached.chunk_, attached.chunk_->base(this), attached.chunk_->max());
+                }
+            }
+
+            return;
+        }
+
         for (auto &attached: attachs_) {
             if (should_do_cpu_manipulate(attached.chunk_->flags_)) {
                 // This chunk has it address not fixed, so unmap from the CPU
                 attached.chunk_->unmap_from_cpu(this, mmu);
             }
         }
+
+        mmu->clear_chunk_residency();
     }
 
     void flexible_mem_model_process::remap_to_cpu(mmu_base *mmu) {
+        // Drop what the previous process left in the CPU and we don't have, it may be its private chunks
+        mmu->begin_chunk_switch();
+
+        for (auto &attached: attachs_) {
+            if (should_do_cpu_manipulate(attached.chunk_->flags_)) {
+                mmu->keep_chunk_in_cpu(attached.chunk_, attached.chunk_->base(this));
+            }
+        }
+
+        mmu->drop_unkept_chunks();
+
         for (auto &attached: attachs_) {
             if (should_do_cpu_manipulate(attached.chunk_->flags_)) {
-                // This chunk has it address not fixed, so map to the CPU
-                attached.chunk_->map_to_cpu(this, mmu);
+                // This chunk has it address not fixed, so map to the CPU if it changed
+                attached.chunk_->sync_to_cpu(this, mmu);
             }
         }
     }
@@ -94,7 +94,6 @@ namespace eka2l1::mem {
                         for (auto &mm: mul_ctrl->mmus_) {
                             if (!own_process_ || mul_process->addr_space_id_ == mm->current_addr_space()) {
                                 mm->map_to_cpu(off_start_just_mapped, size_just_mapped, host_start_just_mapped, permission_);
-                                break;
                             }
                         }
 
@@ -110,7 +109,6 @@ namespace eka2l1::mem {
                 for (auto &mm: mul_ctrl->mmus_) {
                     if (!own_process_ || mul_process->addr_space_id_ == mm->current_addr_space()) {
                         mm->map_to_cpu(off_start_just_mapped, size_just_mapped, host_start_just_mapped, permission_);
-                        break;
                     }
                 }
                 //LOG_TRACE(MEMORY, "Mapped to CPU: 0x{:X}, size 0x{:X}", off_start_just_mapped, size_just_mapped);
@@ -132,6 +130,9 @@ namespace eka2l1::mem {
             running_offset += (page_num << control_->page_size_bits_);
         }
 
+        track_committed_pages(offset, running_offset - offset);
+        mark_cpu_map_dirty();
+
         return running_offset - offset;
     }
 
@@ -192,7 +193,6 @@ namespace eka2l1::mem {
                         for (auto &mm: mul_ctrl->mmus_) {
                             if (!own_process_ || mul_process->addr_space_id_ == mm->current_addr_space()) {
                                 mm->unmap_from_cpu(off_start_just_unmapped, size_just_unmapped);
-                                break;
                             }
                         }
 
@@ -208,7 +208,6 @@ namespace eka2l1::mem {
                 for (auto &mm: mul_ctrl->mmus_) {
                     if (!own_process_ || mul_process->addr_space_id_ == mm->current_addr_space()) {
                         mm->unmap_from_cpu(off_start_just_unmapped, size_just_unmapped);
-                        break;
                     }
                 }
             }
@@ -228,6 +227,8 @@ namespace eka2l1::mem {
 
             running_offset += (page_num << control_->page_size_bits_);
         }
+
+        mark_cpu_map_dirty();
     }
 
     bool multiple_mem_model_chunk::allocate(const std::size_t size) {
@@ -344,7 +345,7 @@ namespace eka2l1::mem {
             host_base_ = create_info.host_map;
             is_external_host = true;
         } else {
-            host_base_ = common::map_memory(max_size_);
+            host_base_ = control_->reserve_host_memory(max_size_);
             is_external_host = false;
         }
 
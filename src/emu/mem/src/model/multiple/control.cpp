@@ -120,11 +120,23 @@ namespace eka2l1::mem {
         }
     }
 
+    void control_multiple::unmap_from_all_cpus(const vm_address addr, const std::size_t size) {
+        for (auto &inst: mmus_) {
+            if (inst) {
+                inst->unmap_from_cpu(addr, size);
+            }
+        }
+    }
+
     void *control_multiple::get_host_pointer(const asid id, const vm_address addr) {
         if (id > 0 && dirs_.size() < id) {
             return nullptr;
         }
 
+        if (may_be_demand_paged(addr)) {
+            page_in(id, addr);
+        }
+
         if ((mem_map_old_ && (((addr >= shared_data_eka1) && (addr <= rom_eka1_end)) || addr >= ram_code_addr_eka1)) ||
             addr >= shared_data) {
             return global_dir_.get_pointer(addr);
@@ -26,6 +26,7 @@ namespace eka2l1::mem {
         : mmu_base(manager, cpu, conf)
         , cur_dir_(nullptr) {
         cur_dir_ = &(reinterpret_cast<control_multiple*>(manager)->global_dir_);
+        install_cpu_memory_callbacks<mmu_multiple, control_multiple>(this);
     }
 
     bool mmu_multiple::set_current_addr_space(const asid id) {
@@ -61,6 +62,10 @@ namespace eka2l1::mem {
             return nullptr;
         }
 
+        if (manager_->may_be_demand_paged(addr)) {
+            manager_->page_in(current_addr_space(), addr, this);
+        }
+
         return cur_dir_->get_pointer(addr);
     }
 }
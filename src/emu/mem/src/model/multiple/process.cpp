@@ -153,6 +153,14 @@ namespace eka2l1::mem {
 
     void multiple_mem_model_process::unmap_from_cpu(mmu_base *mmu) {
         if (!mmu->cpu_->should_clear_old_memory_map()) {
+            // Leave the mappings in, but make sure they are known. The next process unmaps
+            // what it does not share with us before syncing its own chunks.
+            for (auto &c : chunks_) {
+                if (c && (c->is_local || c->is_code)) {
+                    mmu->note_chunk_in_cpu(c.get(), c->base(this), c->max());
+                }
+            }
+
             return;
         }
 
@@ -162,13 +170,26 @@ namespace eka2l1::mem {
                 c->unmap_from_cpu(this, mmu);
             }
         }
+
+        mmu->clear_chunk_residency();
     }
 
     void multiple_mem_model_process::remap_to_cpu(mmu_base *mmu) {
+        // Drop what the previous process left in the CPU and we don't have, it may be its private chunks
+        mmu->begin_chunk_switch();
+
         for (auto &c : chunks_) {
             if (c && (c->is_local || c->is_code)) {
-                // Local
-                c->map_to_cpu(this, mmu);
+                mmu->keep_chunk_in_cpu(c.get(), c->base(this));
+            }
+        }
+
+        mmu->drop_unkept_chunks();
+
+        for (auto &c : chunks_) {
+            if (c && (c->is_local || c->is_code)) {
+                // Local. Only resync what changed since this chunk was last in the CPU
+                c->sync_to_cpu(this, mmu);
             }
         }
     }
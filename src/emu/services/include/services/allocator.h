@@ -32,7 +32,7 @@ namespace eka2l1 {
 }
 
 namespace eka2l1::epoc {
-    class chunk_allocator : public common::block_allocator {
+    class chunk_allocator : public common::tlsf_allocator {
         chunk_ptr target_chunk;
 
     public:
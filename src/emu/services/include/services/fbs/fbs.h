@@ -48,6 +48,8 @@ namespace eka2l1 {
     struct file;
     struct directory;
 
+    class window_server;
+
     using symfile = std::unique_ptr<file>;
 
     namespace drivers {
@@ -305,6 +307,7 @@ namespace eka2l1 {
         friend struct fbsfont;
 
         server_ptr fs_server;
+        window_server *winserv_;
 
         chunk_ptr shared_chunk;
         chunk_ptr large_chunk;
@@ -415,6 +418,10 @@ namespace eka2l1 {
             return base_large_chunk;
         }
 
+        chunk_ptr get_large_chunk() {
+            return large_chunk;
+        }
+
         std::uint8_t *get_large_chunk_pointer(const std::uint64_t start_offset) {
             return base_large_chunk + start_offset;
         }
@@ -25,8 +25,14 @@
 #include <common/types.h>
 
 namespace eka2l1::epoc {
+    using palette_16 = std::array<common::rgb, 16>;
     using palette_256 = std::array<common::rgb, 256>;
 
+    static palette_16 color_16_palette = {
+        0x00000000, 0x00555555, 0x00000080, 0x00008080, 0x00008000, 0x000000ff, 0x0000ffff, 0x0000ff00,
+        0x00ffff00, 0x00ff0000, 0x00ff00ff, 0x00800080, 0x00800000, 0x00808000, 0x00aaaaaa, 0x00ffffff
+    };
+
     static palette_256 color_256_palette_old = {
         0, 0xCCFFFF, 0x99FFFF, 0x66FFFF, 0x33FFFF, 0xFFFF, 0xFFCCFF,
         0xCCCCFF, 0x99CCFF, 0x66CCFF, 0x33CCFF, 0xCCFF, 0xFF99FF,
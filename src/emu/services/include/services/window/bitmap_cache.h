@@ -27,9 +27,12 @@
 
 #include <drivers/graphics/common.h>
 #include <drivers/itc.h>
+#include <mem/chunk.h>
 #include <services/fbs/bitmap.h>
 
 #include <array>
+#include <mutex>
+#include <vector>
 
 namespace eka2l1 {
     class kernel_system;
@@ -45,6 +48,7 @@ namespace eka2l1::epoc {
         using bitmap_array = std::array<epoc::bitwise_bitmap *, MAX_CACHE_SIZE>;
         using timestamps_array = std::array<std::uint64_t, MAX_CACHE_SIZE>;
         using hashes_array = timestamps_array;
+        using write_stamps_array = timestamps_array;
         using sizes_array = std::array<std::pair<std::uint64_t, std::uint32_t>, MAX_CACHE_SIZE>;
 
     private:
@@ -52,8 +56,11 @@ namespace eka2l1::epoc {
         bitmap_array bitmaps;
         timestamps_array timestamps;
         hashes_array hashes;
+        write_stamps_array write_stamps;
         sizes_array bitmap_sizes;
 
+        std::vector<mem::written_range> written_ranges;
+
         fbs_server *fbss_;
 
         kernel_system *kern;
@@ -61,8 +68,20 @@ namespace eka2l1::epoc {
 
         std::int64_t last_free{ 0 };
 
+        /**
+         * Bitmaps are added from drawing without the kernel lock held, and removed by FBS under it,
+         * so every access to the arrays above goes through this.
+         */
+        std::mutex lock_;
+
     protected:
-        std::uint64_t hash_bitwise_bitmap(epoc::bitwise_bitmap *bw_bmp);
+        std::uint64_t hash_bitwise_bitmap(epoc::bitwise_bitmap *bw_bmp, const bool include_data);
+
+        /**
+         * \brief Upload the rows of a bitmap touched by the ranges last collected from the large chunk.
+         */
+        void upload_written_rows(drivers::graphics_command_list_builder *builder, drivers::handle texture,
+            epoc::bitwise_bitmap *bmp, char *data_pointer, const std::size_t data_chunk_offset);
 
     public:
         explicit bitmap_cache(kernel_system *kern_);
@@ -83,8 +102,9 @@ namespace eka2l1::epoc {
          * 
          * If the cache is full, this will find the least used bitmap (by sorting out 
          * last used timestamp). Also, since bitwise bitmap modify itself by user's will
-         * without a method to notify the user, this also hashes bitmap data (using xxHash),
-         * and will reupload the bitmap to driver if the texture data is different.
+         * without a method to notify the user, this checks which pages of the FBS large chunk
+         * were written by the guest since the last upload, and reuploads only the rows touched.
+         * Bitmaps outside of the large chunk have their data hashed (using xxHash) instead.
          * 
          * \param   driver  Pointer
          * \param   bmp     The pointer to bitwise bitmap.
@@ -95,6 +115,10 @@ namespace eka2l1::epoc {
 
         /**
          * \brief   Remove the bitmap from cache.
+         * 
+         * The slot is marked least recently used, so it is the first to be taken by a new bitmap.
+         * This waits for any upload in progress, so the bitmap memory can be freed once it returns.
+         * 
          * \returns True if success. False if bitmap not found. Likely that the bitmap has been
          *          purged from cache
          */
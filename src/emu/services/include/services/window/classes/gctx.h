@@ -81,6 +81,8 @@ namespace eka2l1::epoc {
         eka2l1::rect clipping_rect;
         common::region clipping_region;
 
+        eka2l1::rect damage_clip; ///< Bound of the area drawing is clipped to, in window coordinates.
+
         void flush_queue_to_driver();
 
         enum class set_color_type {
@@ -103,6 +105,11 @@ namespace eka2l1::epoc {
         
         void do_submit_clipping();
 
+        /**
+         * \brief Report an area drawn to the attached window, so the screen composes it again.
+         */
+        void do_damage(const eka2l1::rect &area);
+
         void active(service::ipc_context &context, ws_cmd cmd);
         void deactive(service::ipc_context &context, ws_cmd &cmd);
         void draw_bitmap(service::ipc_context &context, ws_cmd &cmd);
@@ -67,6 +67,8 @@ namespace eka2l1::epoc {
         common::region redraw_region;
         eka2l1::rect redraw_rect_curr;
 
+        common::region damaged_region; ///< Area drawn to since the last screen composition, in window coordinates.
+
         dsa *direct;
 
         int shadow_height;
@@ -79,6 +81,13 @@ namespace eka2l1::epoc {
         void invalidate(const eka2l1::rect &irect);
         void wipeout();
 
+        /**
+         * \brief Mark an area of the window content as changed, so the screen composes it again.
+         * 
+         * \param area The area, in window coordinates.
+         */
+        void damage(const eka2l1::rect &area);
+
         explicit window_user(window_server_client_ptr client, screen *scr, window *parent,
             const epoc::window_type type_of_window, const epoc::display_mode dmode,
             const std::uint32_t client_handle);
@@ -27,6 +27,10 @@ namespace eka2l1 {
     class ntimer;
     class kernel_system;
 
+    namespace common {
+        class counted_mutex;
+    }
+
     namespace drivers {
         class graphics_driver;
     }
@@ -81,6 +85,7 @@ namespace eka2l1::epoc {
 
         ntimer *timing_;
         kernel_system *kern_;
+        common::counted_mutex *serv_lock_; ///< Lock of the window server, guarding the window tree.
 
         sched_scan_callback_data scan_callback_data_;
 
@@ -93,7 +98,7 @@ namespace eka2l1::epoc {
         void schedule_scans(drivers::graphics_driver *driver);
 
     public:
-        explicit animation_scheduler(kernel_system *kern, ntimer *timing, const int total_screen);
+        explicit animation_scheduler(kernel_system *kern, common::counted_mutex *serv_lock, ntimer *timing, const int total_screen);
         ~animation_scheduler();
 
         /**
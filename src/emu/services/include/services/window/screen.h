@@ -48,6 +48,32 @@ namespace eka2l1::epoc {
     struct window;
     struct window_group;
 
+    /**
+     * \brief A window drawn on the screen by the last composition.
+     */
+    struct composed_window {
+        drivers::handle driver_win_id_;
+        eka2l1::rect rect_; ///< Area the window covers on the screen.
+
+        bool operator==(const composed_window &rhs) const {
+            return (driver_win_id_ == rhs.driver_win_id_) && (rect_.top == rhs.rect_.top) && (rect_.size == rhs.rect_.size);
+        }
+
+        bool operator!=(const composed_window &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    /**
+     * \brief Work done by a screen composition.
+     */
+    struct composition_stats {
+        std::uint64_t pixels_composed_ = 0; ///< Pixels drawn to the screen texture.
+        std::uint32_t windows_drawn_ = 0;
+        std::uint32_t windows_culled_ = 0; ///< Windows skipped because windows in front cover their damaged part.
+        bool full_ = false; ///< The whole screen was composed.
+    };
+
     struct screen {
         int number;
         int ui_rotation; ///< Rotation for UI display. So nikita can skip neck day.
@@ -79,6 +105,13 @@ namespace eka2l1::epoc {
 
         std::mutex screen_mutex;
 
+        bool full_damage; ///< The whole screen must be composed on next redraw.
+
+        std::vector<composed_window> last_composition;
+        composition_stats last_composition_stats;
+        std::uint64_t total_pixels_composed;
+        std::uint64_t total_compositions;
+
         // Position of this screen in graphics driver
         // Update in graphics driver thread and read in os thread
         eka2l1::vec2 absolute_pos;
@@ -158,6 +191,19 @@ namespace eka2l1::epoc {
         void resize(drivers::graphics_driver *driver, const eka2l1::vec2 &new_size);
 
         void deinit(drivers::graphics_driver *driver);
+
+        /**
+         * \brief Mark the whole screen to be composed again on next redraw.
+         */
+        void damage_all();
+
+        /**
+         * \brief Compose damaged parts of the screen.
+         * 
+         * Only the area windows have drawn to since the last composition is drawn again. If windows were
+         * added, removed, moved, resized or reordered, the whole screen is composed. Windows that are
+         * fully covered by windows in front of them are skipped.
+         */
         void redraw(drivers::graphics_command_list_builder *builder, const bool need_bind);
 
         /**
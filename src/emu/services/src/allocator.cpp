@@ -22,7 +22,7 @@
 
 namespace eka2l1::epoc {
     chunk_allocator::chunk_allocator(chunk_ptr de_chunk)
-        : block_allocator(reinterpret_cast<std::uint8_t*>(de_chunk->host_base()), de_chunk->committed())
+        : tlsf_allocator(reinterpret_cast<std::uint8_t*>(de_chunk->host_base()), de_chunk->committed())
         , target_chunk(std::move(de_chunk)) {
     }
 
@@ -77,6 +77,8 @@ namespace eka2l1 {
         ver.build = 3;
 
         dev_session_->send_receive_sync(-1, eka2l1::ipc_arg{ static_cast<int>(ver.u32), 0, 0, 0 }, 0);
+
+        const std::lock_guard<common::counted_mutex> guard(dev_serv->server_lock());
         dev_serv->process_accepted_msg();
     }
 
@@ -339,6 +339,7 @@ namespace eka2l1 {
         // Processed asynchronously, use for HLE service where accepted function
         // is fetched imm
         void server::process_accepted_msg() {
+            common::profile_scope profile(profile_token_);
             int res = receive(process_msg);
 
             if (res == -1) {
@@ -238,6 +238,7 @@ namespace eka2l1 {
     fbs_server::fbs_server(eka2l1::system *sys)
         : service::typical_server(sys, epoc::get_fbs_server_name_by_epocver(sys->get_symbian_version_use()))
         , persistent_font_store(sys->get_io_system())
+        , winserv_(nullptr)
         , shared_chunk(nullptr)
         , large_chunk(nullptr)
         , fntstr_seg(nullptr)
@@ -296,6 +297,11 @@ namespace eka2l1 {
             return;
         }
 
+        // The window server looks at which pages got written to reupload only the changed part of bitmaps
+        if (!large_chunk->enable_write_tracking()) {
+            LOG_WARN(SERVICE_FBS, "Unable to track writes to large chunk, bitmaps will be hashed to detect changes");
+        }
+
         large_bitmap_access_mutex = kern->create<kernel::mutex>(kern->get_ntimer(),
             "FbsLargeBitmapAccess", false, kernel::access_type::global_access);
 
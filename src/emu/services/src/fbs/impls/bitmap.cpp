@@ -31,6 +31,7 @@
 #include <services/fbs/palette.h>
 #include <services/fs/fs.h>
 #include <services/window/common.h>
+#include <services/window/window.h>
 
 #include <system/epoc.h>
 #include <kernel/kernel.h>
@@ -671,6 +672,16 @@ namespace eka2l1 {
 
         const std::size_t reserved_bytes = bmp->reserved_height_each_side_ * bmp->bitmap_->byte_width_;
 
+        // Textures are cached by bitwise bitmap address, which a new bitmap may take after this.
+        if (!winserv_) {
+            winserv_ = reinterpret_cast<window_server *>(kern->get_by_name<service::server>(
+                get_winserv_name_by_epocver(kern->get_epoc_version())));
+        }
+
+        if (winserv_) {
+            winserv_->get_bitmap_cache()->remove(bmp->bitmap_);
+        }
+
         // First, free the bitmap pixels.
         if (bmp->bitmap_->offset_from_me_) {
             if (!shared_chunk_allocator->free(bmp->bitmap_->data_pointer(this) - reserved_bytes)) {
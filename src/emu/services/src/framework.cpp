@@ -72,6 +72,7 @@ namespace eka2l1::service {
     }
 
     void typical_server::process_accepted_msg() {
+        common::profile_scope profile(profile_token_);
         int res = receive(process_msg);
 
         if (res == -1) {
@@ -481,6 +481,16 @@ namespace eka2l1 {
             read_len = static_cast<int>(size - read_pos);
         }
 
+        std::uint32_t view_size = 0;
+
+        // Memory backed files (ROM, mapped files) can be copied straight into the descriptor
+        if (const std::uint8_t *view = vfs_file->read_view(static_cast<std::uint32_t>(read_len), view_size)) {
+            ctx->write_data_to_descriptor_argument(0, view, view_size);
+            ctx->complete(epoc::error_none);
+
+            return;
+        }
+
         std::vector<char> read_data;
         read_data.resize(read_len);
 
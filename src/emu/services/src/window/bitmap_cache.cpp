@@ -36,6 +36,7 @@
 
 #include <common/buffer.h>
 #include <common/log.h>
+#include <common/pixel.h>
 #include <common/runlen.h>
 #include <common/time.h>
 
@@ -48,9 +49,12 @@ namespace eka2l1::epoc {
         , kern(kern_) {
         std::fill(driver_textures.begin(), driver_textures.end(), 0);
         std::fill(hashes.begin(), hashes.end(), 0);
+        std::fill(write_stamps.begin(), write_stamps.end(), 0);
     }
 
     void bitmap_cache::clean(drivers::graphics_driver *drv) {
+        const std::lock_guard<std::mutex> guard(lock_);
+
         auto llist = drv->new_command_list();
         auto builder = drv->new_command_builder(llist.get());
 
@@ -63,83 +67,98 @@ namespace eka2l1::epoc {
         drv->submit_command_list(*llist);
     }
 
-    bool is_palette_bitmap(epoc::bitwise_bitmap *bw_bmp) {
+    static epoc::display_mode get_bitmap_display_mode(epoc::bitwise_bitmap *bw_bmp) {
         epoc::display_mode dsp = bw_bmp->settings_.current_display_mode();
         if (dsp == epoc::display_mode::none) {
             dsp = bw_bmp->settings_.initial_display_mode();
         }
 
-        return (dsp == epoc::display_mode::color16) || (dsp == epoc::display_mode::color256);
+        return dsp;
     }
 
-    static char *converted_one_bpp_to_twenty_four_bpp_bitmap(epoc::bitwise_bitmap *bw_bmp,
-        const std::uint32_t *original_ptr, std::vector<char> &converted_pool) {
-        std::uint32_t byte_width_converted = common::align(bw_bmp->header_.size_pixels.x * 3, 4);
-        converted_pool.resize(byte_width_converted * bw_bmp->header_.size_pixels.y);
+    /**
+     * \brief Get the pixel format of a bitmap that the GPU can't take as is.
+     *
+     * These bitmaps are converted to 32-bit ARGB on the CPU before uploading.
+     *
+     * \returns False if the bitmap can be uploaded without conversion.
+     */
+    static bool get_cpu_conversion_format(epoc::bitwise_bitmap *bw_bmp, common::pixel_format &format) {
+        switch (get_bitmap_display_mode(bw_bmp)) {
+        case epoc::display_mode::color16:
+            format = common::pixel_format::color16;
+            return true;
+
+        case epoc::display_mode::color256:
+            format = common::pixel_format::color256;
+            return true;
+
+        default:
+            break;
+        }
 
-        char *return_ptr = &converted_pool[0];
+        switch (bw_bmp->header_.bit_per_pixels) {
+        case 1:
+            format = common::pixel_format::gray2;
+            return true;
 
-        for (std::size_t y = 0; y < bw_bmp->header_.size_pixels.y; y++) {
-            for (std::size_t x = 0; x < bw_bmp->header_.size_pixels.x; x++) {
-                std::uint32_t word_per_line = (bw_bmp->header_.size_pixels.x + 31) / 32;
-                std::uint32_t color = original_ptr[y * word_per_line + x / 32];
-                std::uint32_t converted_color =  0;
-                if (color & (1 << (x & 0x1F))) {
-                    converted_color = 0xFFFFFF;
-                }
+        case 2:
+            format = common::pixel_format::gray4;
+            return true;
 
-                std::memcpy(return_ptr + byte_width_converted * y + x * 3, reinterpret_cast<const char *>(&converted_color), 3);
-            }
-        }
-        return return_ptr;
-    }
+        case 4:
+            format = common::pixel_format::gray16;
+            return true;
 
-    static char *converted_palette_bitmap_to_twenty_four_bitmap(epoc::bitwise_bitmap *bw_bmp,
-        const std::uint8_t *original_ptr, std::vector<char> &converted_pool, epoc::palette_256 &the_palette) {
-        std::uint32_t byte_width_converted = common::align(bw_bmp->header_.size_pixels.x * 3, 4);
-        converted_pool.resize(byte_width_converted * bw_bmp->header_.size_pixels.y);
+        default:
+            break;
+        }
 
-        char *return_ptr = &converted_pool[0];
+        return false;
+    }
 
-        epoc::display_mode dsp = bw_bmp->settings_.current_display_mode();
-        if (dsp == epoc::display_mode::none) {
-            dsp = bw_bmp->settings_.initial_display_mode();
-        }
+    static std::uint32_t *convert_bitmap_to_argb8888(epoc::bitwise_bitmap *bw_bmp, const common::pixel_format format,
+        const std::uint8_t *original_ptr, std::vector<std::uint32_t> &converted_pool, const epocver ver) {
+        const std::size_t width = bw_bmp->header_.size_pixels.x;
+        const std::size_t height = bw_bmp->header_.size_pixels.y;
 
-        for (std::size_t y = 0; y < bw_bmp->header_.size_pixels.y; y++) {
-            for (std::size_t x = 0; x < bw_bmp->header_.size_pixels.x; x++) {
-                switch (dsp) {
-                case epoc::display_mode::color256: {
-                    const std::uint8_t palette_index = original_ptr[y * bw_bmp->byte_width_ + x];
-                    const std::uint32_t palette_color = the_palette[palette_index];
-                    const std::size_t location = byte_width_converted * y + x * 3;
+        converted_pool.resize(width * height);
 
-                    return_ptr[location + 2] = palette_color & 0xFF;
-                    return_ptr[location + 1] = (palette_color >> 8) & 0xFF;
-                    return_ptr[location] = (palette_color >> 16) & 0xFF;
+        // Palettes are stored as 0x00BBGGRR, the converter wants 0xAARRGGBB
+        std::array<std::uint32_t, 256> palette;
+        const common::rgb *source_palette = nullptr;
+        std::size_t palette_size = 0;
 
-                    break;
-                }
+        if (format == common::pixel_format::color16) {
+            source_palette = epoc::color_16_palette.data();
+            palette_size = epoc::color_16_palette.size();
+        } else if (format == common::pixel_format::color256) {
+            source_palette = epoc::get_suitable_palette_256(ver).data();
+            palette_size = palette.size();
+        }
 
-                default:
-                    LOG_ERROR(SERVICE_WINDOW, "Unhandled display mode to convert {}", static_cast<int>(dsp));
-                    break;
-                }
-            }
+        for (std::size_t i = 0; i < palette_size; i++) {
+            const common::rgb color = source_palette[i];
+            palette[i] = 0xFF000000 | ((color & 0xFF) << 16) | (color & 0xFF00) | ((color >> 16) & 0xFF);
         }
 
-        return return_ptr;
+        common::convert_to_argb8888(format, original_ptr, bw_bmp->byte_width_, converted_pool.data(), width, width,
+            height, palette.data());
+
+        return converted_pool.data();
     }
 
     static std::uint32_t get_suitable_bpp_for_bitmap(epoc::bitwise_bitmap *bmp) {
-        if (is_palette_bitmap(bmp) || (bmp->header_.bit_per_pixels == 1)) {
-            return 24;
+        common::pixel_format format;
+
+        if (get_cpu_conversion_format(bmp, format)) {
+            return 32;
         }
 
         return bmp->header_.bit_per_pixels;
     }
 
-    std::uint64_t bitmap_cache::hash_bitwise_bitmap(epoc::bitwise_bitmap *bw_bmp) {
+    std::uint64_t bitmap_cache::hash_bitwise_bitmap(epoc::bitwise_bitmap *bw_bmp, const bool include_data) {
         std::uint64_t hash = 0xB1711A3F;
 
         // Hash using XXHASH
@@ -149,12 +168,15 @@ namespace eka2l1::epoc {
         // First, hash the single bitmap header
         XXH64_update(state, reinterpret_cast<const void *>(&bw_bmp->header_), sizeof(loader::sbm_header));
 
-        // Now, hash the byte width and UID, if it changes, we need to update
+        // Now, hash the byte width, UID and data location, if it changes, we need to update
         XXH64_update(state, reinterpret_cast<const void *>(&bw_bmp->byte_width_), sizeof(bw_bmp->byte_width_));
         XXH64_update(state, reinterpret_cast<const void *>(&bw_bmp->uid_), sizeof(bw_bmp->uid_));
+        XXH64_update(state, reinterpret_cast<const void *>(&bw_bmp->data_offset_), sizeof(bw_bmp->data_offset_));
 
         // Lastly, we needs to hash the data, to see if anything changed
-        XXH64_update(state, bw_bmp->data_pointer(fbss_), bw_bmp->header_.bitmap_size - sizeof(bw_bmp->header_));
+        if (include_data) {
+            XXH64_update(state, bw_bmp->data_pointer(fbss_), bw_bmp->header_.bitmap_size - sizeof(bw_bmp->header_));
+        }
 
         hash = XXH64_digest(state);
         XXH64_freeState(state);
@@ -182,8 +204,38 @@ namespace eka2l1::epoc {
         return oldest_timestamp_idx;
     }
 
+    void bitmap_cache::upload_written_rows(drivers::graphics_command_list_builder *builder, drivers::handle texture,
+        epoc::bitwise_bitmap *bmp, char *data_pointer, const std::size_t data_chunk_offset) {
+        const std::size_t byte_width = bmp->byte_width_;
+        const std::size_t total_rows = bmp->header_.size_pixels.y;
+
+        std::size_t pixels_per_line = 0;
+
+        if ((bmp->header_.bit_per_pixels % 8) == 0) {
+            pixels_per_line = byte_width / (bmp->header_.bit_per_pixels >> 3);
+        }
+
+        for (const mem::written_range &range : written_ranges) {
+            const std::size_t first_row = (range.offset_ - data_chunk_offset) / byte_width;
+            const std::size_t last_row = std::min<std::size_t>((range.offset_ + range.size_ - 1 - data_chunk_offset) / byte_width,
+                total_rows - 1);
+
+            if (first_row > last_row) {
+                // Only the padding after the last row was written
+                continue;
+            }
+
+            const std::size_t row_count = last_row - first_row + 1;
+
+            builder->update_bitmap(texture, data_pointer + first_row * byte_width, row_count * byte_width,
+                { 0, static_cast<int>(first_row) }, { bmp->header_.size_pixels.x, static_cast<int>(row_count) }, pixels_per_line);
+        }
+    }
+
     drivers::handle bitmap_cache::add_or_get(drivers::graphics_driver *driver, drivers::graphics_command_list_builder *builder,
         epoc::bitwise_bitmap *bmp) {
+        const std::lock_guard<std::mutex> guard(lock_);
+
         if (!fbss_) {
             server_ptr ss = kern->get_by_name<service::server>(epoc::get_fbs_server_name_by_epocver(
                 kern->get_epoc_version()));
@@ -202,6 +254,18 @@ namespace eka2l1::epoc {
         const std::uint32_t suit_bpp = get_suitable_bpp_for_bitmap(bmp);
         auto bitmap_ite = std::find(bitmaps.begin(), bitmaps.end(), bmp);
 
+        // Large bitmaps live in a chunk where guest writes are tracked. For those, only the header
+        // is hashed, and the pages written since the last upload tell if and what to reupload.
+        kernel::chunk *large_chunk = fbss_->get_large_chunk();
+        std::uint8_t *large_chunk_base = fbss_->get_large_chunk_base();
+        std::uint8_t *bitmap_data = bmp->data_pointer(fbss_);
+
+        const std::size_t data_size = bmp->header_.bitmap_size - bmp->header_.header_len;
+        const bool write_tracked = large_chunk && large_chunk->is_write_tracked() && (bitmap_data >= large_chunk_base)
+            && (bitmap_data + data_size <= large_chunk_base + large_chunk->max_size());
+
+        const std::size_t data_chunk_offset = write_tracked ? (bitmap_data - large_chunk_base) : 0;
+
         if (bitmap_ite == bitmaps.end()) {
             // If the bitmap is not in the bitmap array
             if (last_free < MAX_CACHE_SIZE) {
@@ -211,15 +275,15 @@ namespace eka2l1::epoc {
                 idx = get_suitable_bitmap_index();
             }
 
+            // The texture of the previous bitmap in this slot is destroyed when recreating below
             bitmaps[idx] = bmp;
-            driver_textures[idx] = 0;
-            hash = (hashes[idx] == 0) ? hash_bitwise_bitmap(bmp) : hashes[idx];
+            hash = (hashes[idx] == 0) ? hash_bitwise_bitmap(bmp, !write_tracked) : hashes[idx];
         } else {
             // Else, get the index
             idx = std::distance(bitmaps.begin(), bitmap_ite);
 
             // Check if we should upload or not, by calculating the hash
-            hash = hash_bitwise_bitmap(bmp);
+            hash = hash_bitwise_bitmap(bmp, !write_tracked);
             should_upload = hash != (hashes[idx]);
 
             const std::uint32_t bitmap_bpp = static_cast<std::uint32_t>(bitmap_sizes[idx].first >> 32);
@@ -228,6 +292,31 @@ namespace eka2l1::epoc {
             should_recreate = (bmp->header_.size_pixels != bitmap_stored_size) && (bitmap_bpp == suit_bpp);
         }
 
+        bool partial_upload = false;
+
+        if (write_tracked) {
+            // If the texture content is not reusable, collect anyway so the pages are protected again
+            const bool texture_up_to_date = (bitmap_ite != bitmaps.end()) && !should_upload && !should_recreate;
+
+            written_ranges.clear();
+            write_stamps[idx] = large_chunk->collect_written_pages(data_chunk_offset, data_size,
+                texture_up_to_date ? write_stamps[idx] : 0, written_ranges);
+
+            if (texture_up_to_date) {
+                should_upload = !written_ranges.empty();
+
+                // Converted or compressed bitmaps do not map rows to the data one to one
+                common::pixel_format format;
+                partial_upload = should_upload && (bmp->compression_type() == bitmap_file_no_compression)
+                    && !get_cpu_conversion_format(bmp, format);
+            }
+        }
+
+        if (partial_upload) {
+            upload_written_rows(builder, driver_textures[idx], bmp, reinterpret_cast<char *>(bitmap_data), data_chunk_offset);
+            should_upload = false;
+        }
+
         if (should_recreate) {
             if (driver_textures[idx])
                 builder->destroy_bitmap(driver_textures[idx]);
@@ -236,7 +325,7 @@ namespace eka2l1::epoc {
         }
 
         if (should_upload) {
-            char *data_pointer = reinterpret_cast<char *>(bmp->data_pointer(fbss_));
+            char *data_pointer = reinterpret_cast<char *>(bitmap_data);
 
             std::vector<std::uint8_t> decompressed;
             std::uint32_t raw_size = 0;
@@ -279,7 +368,7 @@ namespace eka2l1::epoc {
                 raw_size = bmp->header_.bitmap_size - bmp->header_.header_len;
             }
 
-            std::vector<char> converted;
+            std::vector<std::uint32_t> converted;
             std::uint32_t bpp = bmp->header_.bit_per_pixels;
             std::size_t pixels_per_line = 0;
 
@@ -288,40 +377,23 @@ namespace eka2l1::epoc {
             }
 
             // GPU don't support them. Convert them on CPU
-            if (is_palette_bitmap(bmp)) {
-                data_pointer = converted_palette_bitmap_to_twenty_four_bitmap(bmp, reinterpret_cast<const std::uint8_t *>(data_pointer),
-                    converted, epoc::get_suitable_palette_256(kern->get_epoc_version()));
+            common::pixel_format format;
 
-                bpp = 24;
-                raw_size = static_cast<std::uint32_t>(converted.size());
+            if (get_cpu_conversion_format(bmp, format)) {
+                data_pointer = reinterpret_cast<char *>(convert_bitmap_to_argb8888(bmp, format,
+                    reinterpret_cast<const std::uint8_t *>(data_pointer), converted, kern->get_epoc_version()));
 
-                // Use default
-                pixels_per_line = 0;
-            }
+                bpp = 32;
+                raw_size = static_cast<std::uint32_t>(converted.size() * sizeof(std::uint32_t));
 
-            switch (bpp) {
-            case 1:
-                data_pointer = converted_one_bpp_to_twenty_four_bpp_bitmap(bmp, reinterpret_cast<const std::uint32_t *>(data_pointer),
-                    converted);
-                bpp = 24;
-                raw_size = static_cast<std::uint32_t>(converted.size());
+                // Use default
                 pixels_per_line = 0;
-
-                break;
-
-            default:
-                break;
             }
 
             builder->update_bitmap(driver_textures[idx], data_pointer, raw_size, { 0, 0 }, bmp->header_.size_pixels, pixels_per_line);
             hashes[idx] = hash;
 
-            epoc::display_mode dsp = bmp->settings_.current_display_mode();
-            if (dsp == epoc::display_mode::none) {
-                dsp = bmp->settings_.initial_display_mode();
-            }
-            
-            if (dsp == epoc::display_mode::color16mu) {
+            if (get_bitmap_display_mode(bmp) == epoc::display_mode::color16mu) {
                 builder->set_swizzle(driver_textures[idx], drivers::channel_swizzle::red, drivers::channel_swizzle::green,
                     drivers::channel_swizzle::blue, drivers::channel_swizzle::one);
             }
@@ -334,4 +406,24 @@ namespace eka2l1::epoc {
 
         return driver_textures[idx];
     }
+
+    bool bitmap_cache::remove(epoc::bitwise_bitmap *bmp) {
+        const std::lock_guard<std::mutex> guard(lock_);
+        auto bitmap_ite = std::find(bitmaps.begin(), bitmaps.end(), bmp);
+
+        if (bitmap_ite == bitmaps.end()) {
+            return false;
+        }
+
+        const std::int64_t idx = std::distance(bitmaps.begin(), bitmap_ite);
+
+        // A new bitmap may be made at the same address. Forget what was uploaded, so it is not
+        // taken for this one. The texture is left for the next bitmap using this slot.
+        bitmaps[idx] = nullptr;
+        hashes[idx] = 0;
+        write_stamps[idx] = 0;
+        timestamps[idx] = 0;
+
+        return true;
+    }
 }
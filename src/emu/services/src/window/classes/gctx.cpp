@@ -58,14 +58,18 @@ namespace eka2l1::epoc {
         // Add first command list, binding our window bitmap
         if (attached_window->driver_win_id == 0) {
             kernel_system *kern = context.sys->get_kernel_system();
+            common::counted_mutex &serv_lock = client->get_ws().server_lock();
 
             // We already completed our request, so it's no fear to unlock the kernel now!
+            // The screen redraw may be waiting for the server lock on the driver thread, so let it go too.
+            serv_lock.unlock();
             kern->unlock();
 
             attached_window->driver_win_id = drivers::create_bitmap(drv, attached_window->size, 32);
             attached_window->resize_needed = false;
 
             kern->lock();
+            serv_lock.lock();
         }
 
         recording = true;
@@ -97,6 +101,15 @@ namespace eka2l1::epoc {
     void graphic_context::do_command_draw_bitmap(service::ipc_context &ctx, drivers::handle h,
         const eka2l1::rect &source_rect, const eka2l1::rect &dest_rect) {
         cmd_builder->draw_bitmap(h, 0, dest_rect, source_rect, eka2l1::vec2(0, 0), 0.0f, 0);
+
+        // Zero destination size means the bitmap is drawn unscaled
+        eka2l1::rect drawn_area = dest_rect;
+
+        if (drawn_area.size == eka2l1::vec2(0, 0)) {
+            drawn_area.size = source_rect.size;
+        }
+
+        do_damage(drawn_area);
         ctx.complete(epoc::error_none);
     }
 
@@ -123,12 +136,19 @@ namespace eka2l1::epoc {
         ctx.complete(epoc::error_none);
 
         kernel_system *kern = client->get_ws().get_kernel_system();
+        common::counted_mutex &serv_lock = client->get_ws().server_lock();
 
+        serv_lock.unlock();
         kern->unlock();
+
         text_font->atlas.draw_text(text, area, align, client->get_ws().get_graphics_driver(),
             cmd_builder.get());
 
         kern->lock();
+        serv_lock.lock();
+
+        // Glyphs go above the baseline and past the box, so the exact area is not known here
+        do_damage(damage_clip);
     }
 
     bool graphic_context::do_command_set_brush_color() {
@@ -205,6 +225,8 @@ namespace eka2l1::epoc {
                 the_clip = attached_window->redraw_rect_curr;
                 use_clipping = true;
             } else {
+                damage_clip = attached_window->bounding_rect();
+
                 // Developement document says that when not being redrawn, drawing is clipped to non-invalid part.
                 // But so far, I have not been able to see any open source code points to that being true. Even simple test can prove that's false.
                 // So for now, we let drawing happens on the window with no restrictions. Invalid region will still be invalidated.
@@ -250,12 +272,14 @@ namespace eka2l1::epoc {
         }
 
         if (use_clipping) {
+            damage_clip = the_clip;
             cmd_builder->set_clipping(true);
 
             if (the_clip.valid()) {
                 cmd_builder->clip_rect(the_clip);
             }
         } else {
+            damage_clip = the_region->bounding_rect();
             cmd_builder->set_stencil(true);
 
             // Try to fill region rects with 1 in stencil buffer.
@@ -282,6 +306,12 @@ namespace eka2l1::epoc {
         }
     }
 
+    void graphic_context::do_damage(const eka2l1::rect &area) {
+        if (attached_window) {
+            attached_window->damage(area.intersect(damage_clip));
+        }
+    }
+
     void graphic_context::flush_queue_to_driver() {
         if (!flushed) {
             drivers::graphics_driver *driver = client->get_ws().get_graphics_driver();
@@ -337,9 +367,15 @@ namespace eka2l1::epoc {
 
         // This call maybe unsafe, as someone may delete our thread before request complete! :((
         // TODO: Safer condition for unlocking.
+        common::counted_mutex &serv_lock = client->get_ws().server_lock();
+
+        serv_lock.unlock();
         kern->unlock();
+
         drivers::handle h = cacher->add_or_get(driver, cmd_builder.get(), bmp);
+
         kern->lock();
+        serv_lock.lock();
 
         return h;
     }
@@ -405,6 +441,8 @@ namespace eka2l1::epoc {
             0.0f, flags);
         cmd_builder->set_blend_mode(false);
 
+        do_damage(dest_rect);
+
         if (swizzle_alteration) {
             cmd_builder->set_swizzle(bmp_mask_driver_handle, drivers::channel_swizzle::red, drivers::channel_swizzle::green,
                 drivers::channel_swizzle::blue, drivers::channel_swizzle::alpha);
@@ -450,6 +488,8 @@ namespace eka2l1::epoc {
             cmd_builder->set_brush_color({ 255, 255, 255 });
             cmd_builder->draw_rectangle(dest_rect);
 
+            do_damage(dest_rect);
+
             source_rect.size.y = bmp->header_.size_pixels.y;
             dest_rect.size.y = source_rect.size.y;
         }
@@ -494,6 +534,7 @@ namespace eka2l1::epoc {
             backup_border.size += pen_size;
 
             cmd_builder->draw_rectangle(backup_border);
+            do_damage(backup_border);
         }
 
         context.complete(epoc::error_none);
@@ -517,11 +558,13 @@ namespace eka2l1::epoc {
             backup_border.size += pen_size * 2;
 
             cmd_builder->draw_rectangle(backup_border);
+            do_damage(backup_border);
         }
 
         // Draw the real rectangle! Hurray!
         if (do_command_set_brush_color()) {
             cmd_builder->draw_rectangle(area);
+            do_damage(area);
         }
 
         context.complete(epoc::error_none);
@@ -540,6 +583,7 @@ namespace eka2l1::epoc {
 
         if (do_command_set_brush_color()) {
             cmd_builder->draw_rectangle(area);
+            do_damage(area);
         }
 
         fill_mode = previous_brush_type;
@@ -564,6 +608,7 @@ namespace eka2l1::epoc {
 
         if (do_command_set_brush_color()) {
             cmd_builder->draw_rectangle(area);
+            do_damage(area);
         }
 
         fill_mode = previous_brush_type;
@@ -129,6 +129,26 @@ namespace eka2l1::epoc {
         return bound;
     }
 
+    void window_user::damage(const eka2l1::rect &area) {
+        // Past this, the region costs more to walk than composing the bounding rect
+        static constexpr std::size_t MAX_DAMAGE_RECTS = 8;
+
+        const eka2l1::rect clipped = area.intersect(bounding_rect());
+
+        if ((clipped.size.x <= 0) || (clipped.size.y <= 0)) {
+            return;
+        }
+
+        damaged_region.add_rect(clipped);
+
+        if (damaged_region.rects_.size() > MAX_DAMAGE_RECTS) {
+            const eka2l1::rect bound = damaged_region.bounding_rect();
+
+            damaged_region.make_empty();
+            damaged_region.add_rect(bound);
+        }
+    }
+
     void window_user::queue_event(const epoc::event &evt) {
         if (!is_visible()) {
             // TODO: Im not sure... I think it can certainly receive
@@ -17,6 +17,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <common/sync.h>
 #include <kernel/kernel.h>
 #include <kernel/timing.h>
 #include <services/window/scheduler.h>
@@ -35,9 +36,10 @@ namespace eka2l1::epoc {
         callback->sched->idle_callback(callback->driver);
     }
 
-    animation_scheduler::animation_scheduler(kernel_system *kern, ntimer *timing, const int total_screen)
-        : kern_(kern)
-        , timing_(timing)
+    animation_scheduler::animation_scheduler(kernel_system *kern, common::counted_mutex *serv_lock, ntimer *timing, const int total_screen)
+        : timing_(timing)
+        , kern_(kern)
+        , serv_lock_(serv_lock)
         , callback_scheduled_(false) {
         anim_due_evt_ = timing_->register_event("anim_sched_anim_due_evt", on_anim_due);
         callback_evt_ = timing->register_event("anim_sched_callback_evt", on_scan_callback);
@@ -196,15 +198,16 @@ namespace eka2l1::epoc {
         lock_.unlock();
 
         {
-            kern_->lock();
+            // Bitmaps drawn here are freed and resized by FBS, and window events are queued, under the kernel
+            // lock only. Take it first, then the window server lock, same order as message dispatch.
+            const std::lock_guard<common::counted_mutex> kern_guard(kern_->get_kernel_lock());
+            const std::lock_guard<common::counted_mutex> serv_guard(*serv_lock_);
 
             // Do redraw, now!
             {
                 const std::lock_guard<std::mutex> guard(scr->screen_mutex);
                 scr->redraw(driver);
             }
-
-            kern_->unlock();
         }
 
         // Transtition the state to inactive.
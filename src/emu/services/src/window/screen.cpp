@@ -31,14 +31,9 @@
 #include <thread>
 
 namespace eka2l1::epoc {
-    struct window_drawer_walker : public window_tree_walker {
-        drivers::graphics_command_list_builder *builder_;
-        std::uint32_t total_redrawed_;
-
-        explicit window_drawer_walker(drivers::graphics_command_list_builder *builder)
-            : builder_(builder)
-            , total_redrawed_(0) {
-        }
+    struct window_composition_walker : public window_tree_walker {
+        std::vector<composed_window> windows_;
+        common::region damage_;
 
         bool do_it(window *win) {
             if (win->type != window_kind::client) {
@@ -47,7 +42,15 @@ namespace eka2l1::epoc {
 
             window_user *winuser = reinterpret_cast<window_user *>(win);
 
-            if (!winuser || !winuser->driver_win_id || !winuser->is_visible()) {
+            if (!winuser) {
+                return false;
+            }
+
+            // Take the content changes, even of windows not drawn. Showing them later changes the composition anyway
+            common::region window_damage;
+            std::swap(window_damage, winuser->damaged_region);
+
+            if (!winuser->driver_win_id || !winuser->is_visible()) {
                 // No need to redraw this window yet. It doesn't even have any content ready.
                 return false;
             }
@@ -58,11 +61,12 @@ namespace eka2l1::epoc {
                 return false;
             }
 
-            // Draw it onto current binding buffer
-            builder_->draw_bitmap(winuser->driver_win_id, 0, eka2l1::rect(winuser->pos, { 0, 0 }),
-                eka2l1::rect({ 0, 0 }, winuser->size), eka2l1::vec2(0, 0), 0.0f, 0);
+            for (eka2l1::rect damaged_rect : window_damage.rects_) {
+                damaged_rect.top += winuser->pos;
+                damage_.add_rect(damaged_rect);
+            }
 
-            total_redrawed_++;
+            windows_.push_back({ winuser->driver_win_id, eka2l1::rect(winuser->pos, winuser->size) });
 
             return false;
         }
@@ -83,7 +87,10 @@ namespace eka2l1::epoc {
         , crr_mode(1)
         , next(nullptr)
         , screen_buffer_chunk(nullptr)
-        , focus(nullptr) {
+        , focus(nullptr)
+        , full_damage(true)
+        , total_pixels_composed(0)
+        , total_compositions(0) {
         root = std::make_unique<epoc::window>(nullptr, this, nullptr);
         disp_mode = scr_conf.disp_mode;
 
@@ -94,19 +101,109 @@ namespace eka2l1::epoc {
         }
     }
 
+    void screen::damage_all() {
+        full_damage = true;
+    }
+
     void screen::redraw(drivers::graphics_command_list_builder *cmd_builder, const bool need_bind) {
+        static constexpr std::size_t MAX_FRAME_DAMAGE_RECTS = 16;
+
+        // Walk through the window tree in recursive order, collecting the windows to draw and what they changed
+        window_composition_walker walker;
+        root->walk_tree_back_to_front(&walker);
+
+        // Windows were added, removed, moved, resized or reordered. Uncovered parts are only known by comparing
+        // the whole composition, so just draw everything.
+        if (walker.windows_ != last_composition) {
+            full_damage = true;
+        }
+
+        const eka2l1::rect screen_rect({ 0, 0 }, current_mode().size);
+        common::region frame_damage;
+
+        if (full_damage) {
+            frame_damage.add_rect(screen_rect);
+        } else {
+            for (const eka2l1::rect &damaged_rect : walker.damage_.rects_) {
+                frame_damage.add_rect(damaged_rect.intersect(screen_rect));
+            }
+
+            // Many small rectangles cost more draws than composing the area around them
+            if (frame_damage.rects_.size() > MAX_FRAME_DAMAGE_RECTS) {
+                const eka2l1::rect bound = frame_damage.bounding_rect();
+
+                frame_damage.make_empty();
+                frame_damage.add_rect(bound);
+            }
+        }
+
+        composition_stats stats;
+        stats.full_ = full_damage;
+
+        full_damage = false;
+        last_composition = walker.windows_;
+
+        if (frame_damage.empty()) {
+            last_composition_stats = stats;
+            return;
+        }
+
+        // Front to back, skip windows whose damaged part is fully covered by windows in front.
+        // Composition draws without blending, so every window is opaque here.
+        std::vector<bool> culled(walker.windows_.size(), false);
+        common::region covered;
+
+        for (std::size_t i = walker.windows_.size(); i > 0; i--) {
+            const eka2l1::rect &win_rect = walker.windows_[i - 1].rect_;
+
+            common::region win_region;
+            win_region.add_rect(win_rect);
+
+            common::region visible = frame_damage.intersect(win_region);
+            visible.eliminate(covered);
+
+            if (visible.empty()) {
+                culled[i - 1] = true;
+                stats.windows_culled_++;
+            }
+
+            covered.add_rect(win_rect);
+        }
+
         if (need_bind) {
             cmd_builder->bind_bitmap(screen_texture);
         }
 
-        // Walk through the window tree in recursive order, and do draw
-        // We dont care about visible regions. Nowadays, detect visible region to reduce pixel plotting is
-        // just not really worth the time, since GPU draws so fast. Symbian code still has it though.
-        window_drawer_walker adrawwalker(cmd_builder);
-        root->walk_tree_back_to_front(&adrawwalker);
+        // Back to front, draw only the damaged parts of each window
+        for (std::size_t i = 0; i < walker.windows_.size(); i++) {
+            if (culled[i]) {
+                continue;
+            }
+
+            const composed_window &composed = walker.windows_[i];
+
+            for (const eka2l1::rect &damaged_rect : frame_damage.rects_) {
+                const eka2l1::rect part = damaged_rect.intersect(composed.rect_);
+
+                if ((part.size.x <= 0) || (part.size.y <= 0)) {
+                    continue;
+                }
+
+                cmd_builder->draw_bitmap(composed.driver_win_id_, 0, part, eka2l1::rect(part.top - composed.rect_.top, part.size),
+                    eka2l1::vec2(0, 0), 0.0f, 0);
+
+                stats.pixels_composed_ += static_cast<std::uint64_t>(part.size.x) * part.size.y;
+            }
+
+            stats.windows_drawn_++;
+        }
 
         // Done! Unbind and submit this to the driver
         cmd_builder->bind_bitmap(0);
+
+        last_composition_stats = stats;
+        total_pixels_composed += stats.pixels_composed_;
+        total_compositions++;
     }
 
     void screen::redraw(drivers::graphics_driver *driver) {
@@ -153,6 +250,9 @@ namespace eka2l1::epoc {
 
         bool need_bind = true;
 
+        // The screen texture content is lost
+        damage_all();
+
         if (!screen_texture) {
             // Create new one!
             screen_texture = drivers::create_bitmap(driver, new_size, 32);
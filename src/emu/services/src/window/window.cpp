@@ -1272,7 +1272,7 @@ namespace eka2l1 {
     window_server::window_server(system *sys)
         : service::server(sys->get_kernel_system(), sys, get_winserv_name_by_epocver(sys->get_symbian_version_use()), true, true)
         , bmp_cache(sys->get_kernel_system())
-        , anim_sched(sys->get_kernel_system(), sys->get_ntimer(), 1)
+        , anim_sched(sys->get_kernel_system(), &server_lock(), sys->get_ntimer(), 1)
         , screens(nullptr)
         , focus_screen_(nullptr)
         , key_shipper(this)
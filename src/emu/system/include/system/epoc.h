@@ -27,6 +27,7 @@
 #include <mutex>
 #include <optional>
 #include <tuple>
+#include <vector>
 
 namespace eka2l1 {
     class memory_system;
@@ -126,6 +127,14 @@ namespace eka2l1 {
 
         int loop();
 
+        /**
+         * @brief Get the host CPU time used by the thread of each secondary core, in microseconds.
+         * 
+         * Core 0 runs on the thread that calls loop(), so it is not included. Empty until
+         * the secondary cores have been started.
+         */
+        std::vector<std::uint64_t> get_secondary_core_cpu_times();
+
         void do_state(common::chunkyseri &seri);
 
         device_manager *get_device_manager();
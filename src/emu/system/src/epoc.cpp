@@ -28,7 +28,9 @@
 #include <common/log.h>
 #include <common/path.h>
 #include <common/platform.h>
+#include <common/profiler.h>
 #include <common/random.h>
+#include <common/thread.h>
 
 #include <disasm/disasm.h>
 
@@ -42,9 +44,13 @@
 #include <scripting/manager.h>
 #endif
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <shared_mutex>
 #include <string>
+#include <thread>
 
 #include <disasm/disasm.h>
 #include <drivers/itc.h>
@@ -90,11 +96,19 @@ namespace eka2l1 {
     }
     
     class system_impl {
-        std::mutex mut;
+        // Guest cores take this shared while they run, access to the system takes it exclusively
+        std::shared_mutex mut;
 
-        arm::core_instance cpu;
+        std::vector<arm::core_instance> cpus;
         arm::exclusive_monitor_instance exmonitor;
 
+        std::vector<std::thread> core_threads;
+        std::mutex core_threads_mut;
+        std::atomic<bool> core_threads_quit = false;
+
+        std::mutex core_wait_mut;
+        std::condition_variable core_wait_cond;
+
         arm_emulator_type cpu_type;
 
         drivers::graphics_driver *gdriver;
@@ -144,6 +158,8 @@ namespace eka2l1 {
         explicit system_impl(system *parent, system_create_components &param);
 
         ~system_impl() {
+            stop_secondary_cores();
+
             // Reset dispatchers...
             dispatcher_.reset();
 
@@ -229,6 +245,11 @@ namespace eka2l1 {
             mem_ = std::make_unique<memory_system>(exmonitor.get(), conf_, (kern_->get_epoc_version() >= epocver::epoc95) ?
                 mem::mem_model_type::flexible : mem::mem_model_type::multiple, is_epocver_eka1(ever) ? true : false);
 
+            // Create the MMU of every core now. Cores look them up concurrently later on.
+            for (auto &core : cpus) {
+                mem_->get_mmu(core.get());
+            }
+
             io_->install_memory(mem_.get());
 
             // Install memory to the kernel, then set epoc version
@@ -249,6 +270,8 @@ namespace eka2l1 {
         void end_access() {
             paused = false;
             mut.unlock();
+
+            wake_secondary_cores();
         }
 
         bool set_device(const std::uint8_t idx) {
@@ -378,7 +401,7 @@ namespace eka2l1 {
         }
 
         void prepare_reschedule() {
-            cpu->prepare_rescheduling();
+            cpus[kernel::smp::current_core()]->prepare_rescheduling();
             reschedule_pending = true;
         }
 
@@ -394,6 +417,12 @@ namespace eka2l1 {
         bool load(const std::u16string &path, const std::u16string &cmd_arg);
         int loop();
 
+        void start_secondary_cores();
+        void stop_secondary_cores();
+        void wake_secondary_cores();
+        void secondary_core_loop(const std::uint32_t core_index);
+        std::vector<std::uint64_t> get_secondary_core_cpu_times();
+
         bool pause();
         bool unpause();
 
@@ -434,7 +463,7 @@ namespace eka2l1 {
         }
 
         arm::core *get_cpu() {
-            return cpu.get();
+            return cpus[0].get();
         }
 
         dispatch::dispatcher *get_dispatcher() {
@@ -497,10 +526,23 @@ namespace eka2l1 {
         file_system_inst physical_fs = create_physical_filesystem(epocver::epoc94, "");
         physical_fs_id_ = io_->add_filesystem(physical_fs);
 
-        exmonitor = arm::create_exclusive_monitor(cpu_type, 1);
-        cpu = arm::create_core(exmonitor.get(), cpu_type);
+        std::uint32_t core_count = static_cast<std::uint32_t>(std::clamp<int>(conf_->cpu_core_count, 1,
+            kernel::smp::MAX_CORE_COUNT));
 
-        kern_ = std::make_unique<kernel_system>(parent_, timing_.get(), io_.get(), conf_, app_settings_, &romf_, cpu.get(),
+        if ((core_count > 1) && conf_->enable_gdbstub) {
+            LOG_WARN(SYSTEM, "GDB stub only follows one core, running guest on a single core");
+            core_count = 1;
+        }
+
+        exmonitor = arm::create_exclusive_monitor(cpu_type, core_count);
+        std::vector<arm::core *> cores;
+
+        for (std::uint32_t i = 0; i < core_count; i++) {
+            cpus.push_back(arm::create_core(exmonitor.get(), cpu_type, conf_->fastmem, i));
+            cores.push_back(cpus.back().get());
+        }
+
+        kern_ = std::make_unique<kernel_system>(parent_, timing_.get(), io_.get(), conf_, app_settings_, &romf_, cores,
             disassembler_.get());
 
         epoc::init_panic_descriptions();
@@ -547,6 +589,11 @@ namespace eka2l1 {
         }
 
         pr->run();
+
+        const io_statistics stats = io_->get_statistics();
+        LOG_INFO(SYSTEM, "Boot IO: {} bytes read, {} path lookups of which {} were answered by the path cache without a host call",
+            stats.bytes_read_, stats.path_cache_hits_ + stats.path_cache_misses_, stats.path_cache_hits_);
+
         return true;
     }
 
@@ -556,7 +603,7 @@ namespace eka2l1 {
         if (kern_)
             kern_->stop_cores_idling();
 
-        const std::lock_guard<std::mutex> guard(mut);
+        const std::lock_guard<std::shared_mutex> guard(mut);
 
         if (timing_)
             timing_->set_paused(true);
@@ -567,21 +614,151 @@ namespace eka2l1 {
     bool system_impl::unpause() {
         paused = false;
 
-        const std::lock_guard<std::mutex> guard(mut);
+        {
+            const std::lock_guard<std::shared_mutex> guard(mut);
 
-        if (timing_)
-            timing_->set_paused(false);
+            if (timing_)
+                timing_->set_paused(false);
+        }
 
+        wake_secondary_cores();
         return true;
     }
 
+    void system_impl::start_secondary_cores() {
+        const std::lock_guard<std::mutex> guard(core_threads_mut);
+
+        // May have been set by a previous stop
+        core_threads_quit = false;
+
+        for (std::uint32_t i = 1; i < static_cast<std::uint32_t>(cpus.size()); i++) {
+            core_threads.emplace_back([this, i]() {
+                secondary_core_loop(i);
+            });
+        }
+    }
+
+    void system_impl::stop_secondary_cores() {
+        if (core_threads.empty()) {
+            return;
+        }
+
+        core_threads_quit = true;
+        wake_secondary_cores();
+
+        for (auto &core : cpus) {
+            core->request_halt();
+        }
+
+        if (kern_) {
+            kern_->stop_cores_idling();
+        }
+
+        const std::lock_guard<std::mutex> guard(core_threads_mut);
+
+        for (auto &thr : core_threads) {
+            thr.join();
+        }
+
+        core_threads.clear();
+    }
+
+    std::vector<std::uint64_t> system_impl::get_secondary_core_cpu_times() {
+        const std::lock_guard<std::mutex> guard(core_threads_mut);
+        std::vector<std::uint64_t> times;
+
+        for (auto &thr : core_threads) {
+            times.push_back(common::get_thread_cpu_time_us(thr));
+        }
+
+        return times;
+    }
+
+    void system_impl::wake_secondary_cores() {
+        {
+            const std::lock_guard<std::mutex> guard(core_wait_mut);
+        }
+
+        core_wait_cond.notify_all();
+    }
+
+    void system_impl::secondary_core_loop(const std::uint32_t core_index) {
+        const std::string thread_name = fmt::format("Guest core {}", core_index);
+
+        common::set_thread_name(thread_name.c_str());
+        common::profiler_register_thread(thread_name.c_str());
+        kernel::smp::set_current_core(core_index);
+
+        arm::core *core = cpus[core_index].get();
+
+        while (!core_threads_quit) {
+            if (paused || exit) {
+                std::unique_lock<std::mutex> unq(core_wait_mut);
+                core_wait_cond.wait(unq, [this]() {
+                    return (!paused && !exit) || core_threads_quit;
+                });
+
+                continue;
+            }
+
+            const std::shared_lock<std::shared_mutex> guard(mut);
+
+            if (paused || exit) {
+                continue;
+            }
+
+            // Guest code runs without the kernel lock. Only SVCs and the bookkeeping around the run take it.
+            kern_->lock();
+
+            kernel::thread *thr = kern_->crr_thread();
+            const kernel::uid thr_id = thr ? thr->unique_id() : 0;
+            const std::uint32_t ticks = thr ? thr->get_remaining_screenticks() : 0;
+
+            kern_->unlock();
+
+            if (thr) {
+                core->run(ticks);
+
+                const std::uint32_t executed = core->get_num_instruction_executed();
+
+                kern_->lock();
+
+                // Another core may have killed and freed the thread while it ran
+                if (kern_->get_by_id<kernel::thread>(thr_id) == thr) {
+                    thr->add_ticks(executed);
+                }
+
+                kern_->unlock();
+
+                kern_->get_load_balancer()->add_run_ticks(core_index, executed);
+                kern_->add_instructions_retired(executed);
+            }
+
+            if (kern_->should_terminate()) {
+                break;
+            }
+
+            kern_->reschedule();
+        }
+    }
+
     int system_impl::loop() {
-        const std::lock_guard<std::mutex> guard(mut);
+        EKA2L1_PROFILE_SCOPE("System", "Loop", 0x4169E1);
+        const std::shared_lock<std::shared_mutex> guard(mut);
 
         if (paused) {
             return 1;
         }
 
+        if (core_threads.size() + 1 < cpus.size()) {
+            start_secondary_cores();
+        }
+
+        // Whoever calls us runs core 0
+        kernel::smp::set_current_core(0);
+
+        arm::core *cpu = cpus[0].get();
+
         bool should_step = false;
         bool script_hits_the_feels = false;
 
@@ -612,14 +789,34 @@ namespace eka2l1 {
             }
         }
 
-        if (kern_->crr_thread() == nullptr) {
+        // Same as the other cores, guest code runs without the kernel lock
+        kern_->lock();
+
+        kernel::thread *thr = kern_->crr_thread();
+        const kernel::uid thr_id = thr ? thr->unique_id() : 0;
+        const std::uint32_t ticks = thr ? thr->get_remaining_screenticks() : 0;
+
+        kern_->unlock();
+
+        if (thr == nullptr) {
             prepare_reschedule();
         } else {
-            kernel::thread *thr = kern_->crr_thread();
-
             if (!should_step) {
-                cpu->run(thr->get_remaining_screenticks());
-                thr->add_ticks(cpu->get_num_instruction_executed());
+                cpu->run(ticks);
+
+                const std::uint32_t executed = cpu->get_num_instruction_executed();
+
+                kern_->lock();
+
+                // Another core may have killed and freed the thread while it ran
+                if (kern_->get_by_id<kernel::thread>(thr_id) == thr) {
+                    thr->add_ticks(executed);
+                }
+
+                kern_->unlock();
+
+                kern_->get_load_balancer()->add_run_ticks(0, executed);
+                kern_->add_instructions_retired(executed);
             } else {
                 cpu->step();
 
@@ -627,11 +824,18 @@ namespace eka2l1 {
                 if (script_hits_the_feels) {
                     should_step = true;
                     script_hits_the_feels = true;
-                    scripter->reset_breakpoint_hit(cpu.get(), kern_->crr_thread());
+                    scripter->reset_breakpoint_hit(cpu, kern_->crr_thread());
                 }
 #endif
 
-                thr->add_ticks(1);
+                kern_->lock();
+
+                if (kern_->get_by_id<kernel::thread>(thr_id) == thr) {
+                    thr->add_ticks(1);
+                }
+
+                kern_->unlock();
+                kern_->add_instructions_retired(1);
             }
         }
 
@@ -702,8 +906,11 @@ namespace eka2l1 {
     }
 
     void system_impl::request_exit() {
-        cpu->stop();
         exit = true;
+
+        for (auto &core : cpus) {
+            core->request_halt();
+        }
     }
 
     bool system_impl::reset(const bool lock_sys) {
@@ -737,10 +944,14 @@ namespace eka2l1 {
         }
 
         io_->set_product_code(dvc->firmware_code);
+        io_->reset_statistics();
+
         set_symbian_version_use(dvc->ver);
 
-        cpu->clear_instruction_cache();
-        
+        for (auto &core : cpus) {
+            core->clear_instruction_cache();
+        }
+
         // Load ROM
         const std::string rom_path = add_path(conf_->storage, add_path(preset::ROM_FOLDER_PATH, add_path(
             common::lowercase_string(dvc->firmware_code), preset::ROM_FILENAME)));
@@ -868,6 +1079,10 @@ namespace eka2l1 {
         return impl->get_kernel_system();
     }
 
+    std::vector<std::uint64_t> system::get_secondary_core_cpu_times() {
+        return impl->get_secondary_core_cpu_times();
+    }
+
     hle::lib_manager *system::get_lib_manager() {
         return impl->get_lib_manager();
     }
@@ -172,6 +172,21 @@ namespace eka2l1 {
 
         virtual bool flush();
 
+        /*! \brief Get the data at the seek cursor directly, if the file is backed by memory.
+         *
+         * The seek cursor is advanced as if the data was read. This lets callers copy straight
+         * from the file to their destination, without a temporary buffer.
+         *
+         * \param size      Number of bytes wanted.
+         * \param view_size Number of bytes available in the returned view.
+         *
+         * Like read_file, a view shorter than asked for marks the end of file. On memory mapped files,
+         * valid() then returns false until the cursor is moved back with seek().
+         *
+         * \returns Pointer to the data, or null if the file is not memory backed. Use read_file then.
+         */
+        virtual const std::uint8_t *read_view(const std::uint32_t size, std::uint32_t &view_size);
+
         virtual bool valid() = 0;
 
         virtual std::uint64_t last_modify_since_1ad() = 0;
@@ -318,6 +333,23 @@ namespace eka2l1 {
     using filesystem_id = std::size_t;
 
     using drive_change_callback_and_data = std::pair<drive_change_notify_callback, void*>;
+
+    /*! \brief Counters of file reads done through the VFS, across all file systems. */
+    struct io_statistics {
+        std::uint64_t bytes_read_ = 0;          ///< Total bytes given out by reads.
+        std::uint64_t host_read_calls_ = 0;     ///< Reads that went to the host file API.
+        std::uint64_t memory_read_calls_ = 0;   ///< Reads served from mapped files or ROM, without host calls.
+        std::uint64_t files_mapped_ = 0;        ///< Read-only host files opened as memory mappings.
+        std::uint64_t files_mapped_failed_ = 0; ///< Host files that could not be mapped and fell back to stdio.
+        std::uint64_t path_cache_hits_ = 0;     ///< Host entry lookups answered by the path cache, each one a host call saved.
+        std::uint64_t path_cache_misses_ = 0;   ///< Host entry lookups that had to ask the host.
+
+        /*! \brief Ratio of reads served from memory. */
+        double memory_hit_ratio() const {
+            const std::uint64_t total = host_read_calls_ + memory_read_calls_;
+            return (total == 0) ? 0.0 : static_cast<double>(memory_read_calls_) / static_cast<double>(total);
+        }
+    };
     
     class io_system {
     private:
@@ -444,6 +476,11 @@ namespace eka2l1 {
         bool unwatch_directory(const std::int64_t handle);
 
         bool install_memory(memory_system *mem);
+
+        /*! \brief Get a snapshot of the read statistics. */
+        io_statistics get_statistics() const;
+
+        void reset_statistics();
     };
 
     symfile physical_file_proxy(const std::string &path, int mode);
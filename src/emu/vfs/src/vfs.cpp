@@ -24,6 +24,7 @@
 #include <common/log.h>
 #include <common/path.h>
 #include <common/platform.h>
+#include <common/virtualmem.h>
 #include <common/wildcard.h>
 
 #include <loader/rom.h>
@@ -32,6 +33,7 @@
 #include <vfs/vfs.h>
 
 #include <array>
+#include <atomic>
 #include <cwctype>
 #include <iostream>
 #include <map>
@@ -39,10 +41,34 @@
 #include <regex>
 #include <thread>
 #include <stack>
+#include <unordered_map>
 
 #include <string.h>
 
 namespace eka2l1 {
+    struct io_statistics_counters {
+        std::atomic<std::uint64_t> bytes_read_{ 0 };
+        std::atomic<std::uint64_t> host_read_calls_{ 0 };
+        std::atomic<std::uint64_t> memory_read_calls_{ 0 };
+        std::atomic<std::uint64_t> files_mapped_{ 0 };
+        std::atomic<std::uint64_t> files_mapped_failed_{ 0 };
+        std::atomic<std::uint64_t> path_cache_hits_{ 0 };
+        std::atomic<std::uint64_t> path_cache_misses_{ 0 };
+    };
+
+    // Files are created by file systems that do not know the IO system, so the counters are shared
+    static io_statistics_counters io_stats;
+
+    static void count_host_read(const std::size_t bytes) {
+        io_stats.host_read_calls_.fetch_add(1, std::memory_order_relaxed);
+        io_stats.bytes_read_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static void count_memory_read(const std::size_t bytes) {
+        io_stats.memory_read_calls_.fetch_add(1, std::memory_order_relaxed);
+        io_stats.bytes_read_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
     file::file(const std::uint32_t attrib)
         : io_component(io_component_type::file, attrib) {
     }
@@ -59,6 +85,10 @@ namespace eka2l1 {
         return true;
     }
 
+    const std::uint8_t *file::read_view(const std::uint32_t size, std::uint32_t &view_size) {
+        return nullptr;
+    }
+
     std::size_t file::read_file(const std::uint64_t offset, void *buf, std::uint32_t size,
         std::uint32_t count) {
         const std::uint64_t last_offset = tell();
@@ -107,10 +137,26 @@ namespace eka2l1 {
             memcpy(data, &file_ptr[crr_pos], will_read);
 
             crr_pos += will_read;
+            count_memory_read(will_read);
 
             return static_cast<int>(will_read);
         }
 
+        const std::uint8_t *read_view(const std::uint32_t size, std::uint32_t &view_size) override {
+            if (crr_pos >= file.size) {
+                view_size = 0;
+                return file_ptr + file.size;
+            }
+
+            view_size = static_cast<std::uint32_t>(std::min<std::uint64_t>(size, file.size - crr_pos));
+
+            const std::uint8_t *view = file_ptr + crr_pos;
+            crr_pos += view_size;
+
+            count_memory_read(view_size);
+            return view;
+        }
+
         int file_mode() const override {
             return READ_MODE;
         }
@@ -322,7 +368,10 @@ namespace eka2l1 {
         size_t read_file(void *data, uint32_t size, uint32_t count) override {
             WARN_CLOSE
 
-            return fread(data, size, count, file) * size;
+            const std::size_t readed = fread(data, size, count, file) * size;
+            count_host_read(readed);
+
+            return readed;
         }
 
         std::uint64_t size() const override {
@@ -430,6 +479,190 @@ namespace eka2l1 {
         }
     };
 
+    /**
+     * \brief Read-only host file, mapped to memory.
+     *
+     * Reads are a copy from the mapped view, with no stdio buffering or system call involved.
+     * The mapping is private, so only files that can't change under us (read-only drives, host
+     * files opened for reading by the emulator itself) should be opened this way.
+     */
+    struct mapped_physical_file : public file {
+        std::uint8_t *view;
+        std::size_t view_size;
+
+        std::uint64_t crr_pos;
+        bool eof;
+
+        std::u16string input_name;
+        std::u16string physical_path;
+
+        int fmode;
+
+        explicit mapped_physical_file(const utf16_str &vfs_path, const utf16_str &real_path, const int mode)
+            : file(io_attrib_none)
+            , view(nullptr)
+            , view_size(0)
+            , crr_pos(0)
+            , eof(false)
+            , input_name(vfs_path)
+            , physical_path(real_path)
+            , fmode(mode) {
+            view = reinterpret_cast<std::uint8_t *>(common::map_file(common::ucs2_to_utf8(real_path), prot::read, 0,
+                true, &view_size));
+        }
+
+        ~mapped_physical_file() override {
+            close();
+        }
+
+        bool is_mapped() const {
+            return view != nullptr;
+        }
+
+        bool valid() override {
+            return view && !eof;
+        }
+
+        int file_mode() const override {
+            return fmode;
+        }
+
+        size_t write_file(const void *data, uint32_t size, uint32_t count) override {
+            LOG_ERROR(VFS, "Can't write into a file opened for reading only!");
+            return -1;
+        }
+
+        size_t read_file(void *data, uint32_t size, uint32_t count) override {
+            const std::uint64_t wanted = static_cast<std::uint64_t>(size) * count;
+            const std::uint64_t will_read = (crr_pos >= view_size) ? 0 : std::min<std::uint64_t>(wanted, view_size - crr_pos);
+
+            if (will_read < wanted) {
+                eof = true;
+            }
+
+            std::memcpy(data, view + crr_pos, will_read);
+            crr_pos += will_read;
+
+            count_memory_read(will_read);
+
+            // Only whole elements are reported, like fread
+            return (size == 0) ? 0 : (will_read / size) * size;
+        }
+
+        const std::uint8_t *read_view(const std::uint32_t size, std::uint32_t &view_size_out) override {
+            const std::uint64_t available = (crr_pos >= view_size) ? 0 : std::min<std::uint64_t>(size, view_size - crr_pos);
+
+            if (available < size) {
+                eof = true;
+            }
+
+            view_size_out = static_cast<std::uint32_t>(available);
+
+            const std::uint8_t *result = view + common::min<std::uint64_t>(crr_pos, view_size);
+            crr_pos += available;
+
+            count_memory_read(available);
+            return result;
+        }
+
+        std::uint64_t size() const override {
+            return view_size;
+        }
+
+        bool close() override {
+            if (view) {
+                common::unmap_file(view, view_size);
+                view = nullptr;
+            }
+
+            return true;
+        }
+
+        uint64_t tell() override {
+            return crr_pos;
+        }
+
+        std::uint64_t seek(std::int64_t seek_off, file_seek_mode where) override {
+            std::int64_t new_pos = 0;
+
+            switch (where) {
+            case file_seek_mode::beg:
+                new_pos = seek_off;
+                break;
+
+            case file_seek_mode::crr:
+                new_pos = static_cast<std::int64_t>(crr_pos) + seek_off;
+                break;
+
+            case file_seek_mode::end:
+                new_pos = static_cast<std::int64_t>(view_size) + seek_off;
+                break;
+
+            default:
+                return 0xFFFFFFFFFFFFFFFF;
+            }
+
+            if (new_pos < 0) {
+                LOG_ERROR(VFS, "Attempting to seek to a negative offset ({})", new_pos);
+                return 0xFFFFFFFFFFFFFFFF;
+            }
+
+            crr_pos = static_cast<std::uint64_t>(new_pos);
+            eof = false;
+
+            return crr_pos;
+        }
+
+        std::u16string file_name() const override {
+            return input_name;
+        }
+
+        bool resize(const std::size_t new_size) override {
+            return false;
+        }
+
+        std::uint64_t last_modify_since_1ad() override {
+            return common::get_last_modifiy_since_ad(physical_path);
+        }
+
+        std::string get_error_descriptor() override {
+            return "no";
+        }
+
+        bool is_in_rom() const override {
+            return false;
+        }
+
+        address rom_address() const override {
+            return 0;
+        }
+    };
+
+    /**
+     * \brief Open a host file, as a memory mapping if allowed and possible.
+     *
+     * \param allow_map True if the file can't be modified while it's open, so a mapping may be used.
+     */
+    static std::unique_ptr<file> open_physical_file(const utf16_str &vfs_path, const utf16_str &real_path, const int mode,
+        const bool allow_map) {
+        // Text mode may translate line endings on some hosts, keep those going through stdio
+        if (allow_map && (mode & BIN_MODE) && !(mode & (WRITE_MODE | APPEND_MODE))) {
+            auto mapped = std::make_unique<mapped_physical_file>(vfs_path, real_path, mode);
+
+            if (mapped->is_mapped()) {
+                io_stats.files_mapped_.fetch_add(1, std::memory_order_relaxed);
+                return mapped;
+            }
+
+            // Empty files can't be mapped, don't count them as failures
+            if (common::file_size(common::ucs2_to_utf8(real_path)) > 0) {
+                io_stats.files_mapped_failed_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        return std::make_unique<physical_file>(vfs_path, real_path, mode);
+    }
+
     /* DIRECTORY VFS */
     class physical_directory : public directory {
         std::regex filter;
@@ -526,10 +759,20 @@ namespace eka2l1 {
         }
     };
 
+    // Clear a drive's cache when it grows past this, instead of tracking usage
+    static constexpr std::size_t MAX_PATH_CACHE_ENTRIES_PER_DRIVE = 8192;
+
     class physical_file_system : public abstract_file_system {
         std::mutex fs_mutex;
         std::unique_ptr<common::directory_watcher> watcher_;
 
+        // Host entry type of resolved paths, per drive. Missing entries are cached too (FILE_INVALID),
+        // since most lookups done by the guest are probes through search paths that fail.
+        std::array<std::unordered_map<std::string, common::file_type>, drive_z + 1> path_caches_;
+        std::array<std::int64_t, drive_z + 1> path_cache_watches_;
+        std::array<std::uint64_t, drive_z + 1> path_cache_generations_; ///< Bumped on every invalidation of the drive's cache.
+        std::mutex path_cache_lock_;
+
     protected:
         std::string firmcode;
         epocver ver;
@@ -538,6 +781,97 @@ namespace eka2l1 {
         std::array<std::pair<drive, bool>, drive_z + 1> mappings;
         std::map<drive_number, std::vector<std::int64_t>> watches;
 
+        void invalidate_path_cache(const drive_number drv) {
+            const std::lock_guard<std::mutex> guard(path_cache_lock_);
+            path_caches_[static_cast<int>(drv)].clear();
+            path_cache_generations_[static_cast<int>(drv)]++;
+        }
+
+        void invalidate_all_path_caches() {
+            const std::lock_guard<std::mutex> guard(path_cache_lock_);
+
+            for (auto &cache : path_caches_) {
+                cache.clear();
+            }
+
+            for (auto &generation : path_cache_generations_) {
+                generation++;
+            }
+        }
+
+        static void on_drive_content_changed(void *userdata, common::directory_changes &changes) {
+            auto *cache_watch = reinterpret_cast<std::pair<physical_file_system *, drive_number> *>(userdata);
+            cache_watch->first->invalidate_path_cache(cache_watch->second);
+        }
+
+        std::array<std::pair<physical_file_system *, drive_number>, drive_z + 1> path_cache_watch_userdatas_;
+
+        /**
+         * \brief Get the type of a host entry, going through the drive's path cache.
+         *
+         * \returns FILE_INVALID if the entry doesn't exist.
+         */
+        common::file_type get_host_entry_type(const drive_number drv, const std::string &real_path) {
+            if (path_cache_watches_[static_cast<int>(drv)] < 0) {
+                return common::get_file_type(real_path);
+            }
+
+            auto &cache = path_caches_[static_cast<int>(drv)];
+            std::uint64_t generation = 0;
+
+            {
+                const std::lock_guard<std::mutex> guard(path_cache_lock_);
+                auto ite = cache.find(real_path);
+
+                if (ite != cache.end()) {
+                    io_stats.path_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+                    return ite->second;
+                }
+
+                generation = path_cache_generations_[static_cast<int>(drv)];
+            }
+
+            const common::file_type type = common::get_file_type(real_path);
+            io_stats.path_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+
+            const std::lock_guard<std::mutex> guard(path_cache_lock_);
+
+            // The entry may have changed while we looked at it. The result is still right for this call,
+            // but caching it could hide the change.
+            if (path_cache_generations_[static_cast<int>(drv)] != generation) {
+                return type;
+            }
+
+            if (cache.size() >= MAX_PATH_CACHE_ENTRIES_PER_DRIVE) {
+                cache.clear();
+            }
+
+            cache.emplace(real_path, type);
+            return type;
+        }
+
+        void watch_drive_for_path_cache(const drive_number drv) {
+            if (!watcher_) {
+                watcher_ = std::make_unique<common::directory_watcher>();
+            }
+
+            path_cache_watch_userdatas_[static_cast<int>(drv)] = { this, drv };
+            const std::int32_t handle = watcher_->watch(mappings[static_cast<int>(drv)].first.real_path,
+                on_drive_content_changed, &path_cache_watch_userdatas_[static_cast<int>(drv)],
+                common::directory_change_move | common::directory_change_creation | common::directory_change_last_write);
+
+            if (handle <= 0) {
+                // Changes from outside would go unnoticed, don't cache this drive
+                LOG_WARN(VFS, "Unable to watch drive {} for changes, host path lookups on it will not be cached",
+                    drive_number_to_ascii(drv));
+
+                path_cache_watches_[static_cast<int>(drv)] = -1;
+                return;
+            }
+
+            path_cache_watches_[static_cast<int>(drv)] = handle;
+        }
+
         constexpr char drive_number_to_ascii(const drive_number drv) {
             return static_cast<char>(drv) + 0x61;
         }
@@ -569,10 +903,13 @@ namespace eka2l1 {
             // Mark as mapped
             mappings[static_cast<int>(drv)].second = true;
 
+            invalidate_path_cache(drv);
+            watch_drive_for_path_cache(drv);
+
             return true;
         }
 
-        std::optional<std::u16string> get_real_physical_path(const std::u16string &vert_path) {
+        std::optional<std::u16string> get_real_physical_path(const std::u16string &vert_path, drive_number *drv_out = nullptr) {
             std::string path_ucs8 = common::ucs2_to_utf8(vert_path);
             const std::string root = eka2l1::root_name(path_ucs8);
             std::u16string vert_path_copy = vert_path;
@@ -581,6 +918,10 @@ namespace eka2l1 {
                 return std::nullopt;
             }
 
+            if (drv_out) {
+                *drv_out = ascii_to_drive_number(static_cast<char>(std::towlower(root[0])));
+            }
+
             drive &drv = mappings[ascii_to_drive_number(static_cast<char>(std::towlower(root[0])))].first;
             std::u16string map_path = common::utf8_to_ucs2(drv.real_path);
 
@@ -622,65 +963,99 @@ namespace eka2l1 {
             for (auto &[drv, mapped] : mappings) {
                 mapped = false;
             }
+
+            path_cache_watches_.fill(-1);
+            path_cache_generations_.fill(0);
+        }
+
+        ~physical_file_system() {
+            // Stop the watcher first, its callbacks touch the path caches
+            watcher_.reset();
         }
 
         void set_epoc_ver(const epocver ever) override {
             ver = ever;
+            invalidate_all_path_caches();
         }
 
         std::optional<std::u16string> get_raw_path(const std::u16string &path) override {
-            return get_real_physical_path(path);
+            drive_number drv = drive_z;
+            std::optional<std::u16string> real_path = get_real_physical_path(path, &drv);
+
+            // The caller may modify the host entry directly, without the VFS knowing
+            if (real_path && !(mappings[static_cast<int>(drv)].first.attribute & io_attrib_write_protected)
+                && (mappings[static_cast<int>(drv)].first.media_type != drive_media::rom)) {
+                invalidate_path_cache(drv);
+            }
+
+            return real_path;
         }
 
         bool delete_entry(const std::u16string &path) override {
-            std::optional<std::u16string> path_real = get_real_physical_path(path);
+            drive_number drv = drive_z;
+            std::optional<std::u16string> path_real = get_real_physical_path(path, &drv);
 
             if (!path_real) {
                 return false;
             }
 
+            invalidate_path_cache(drv);
             return common::remove(common::ucs2_to_utf8(*path_real));
         }
 
         void set_product_code(const std::string &pc) override {
             firmcode = pc;
+            invalidate_all_path_caches();
         }
 
         bool exists(const std::u16string &path) override {
-            std::optional<std::u16string> real_path = get_real_physical_path(path);
-            return real_path ? eka2l1::exists(common::ucs2_to_utf8(*real_path)) : false;
+            drive_number drv = drive_z;
+            std::optional<std::u16string> real_path = get_real_physical_path(path, &drv);
+
+            return real_path ? (get_host_entry_type(drv, common::ucs2_to_utf8(*real_path)) != common::FILE_INVALID) : false;
         }
 
         bool replace(const std::u16string &old_path, const std::u16string &new_path) override {
-            std::optional<std::u16string> old_path_real = get_real_physical_path(old_path);
-            std::optional<std::u16string> new_path_real = get_real_physical_path(new_path);
+            drive_number old_drv = drive_z;
+            drive_number new_drv = drive_z;
+
+            std::optional<std::u16string> old_path_real = get_real_physical_path(old_path, &old_drv);
+            std::optional<std::u16string> new_path_real = get_real_physical_path(new_path, &new_drv);
 
             if (!old_path_real || !new_path_real) {
                 return false;
             }
 
+            invalidate_path_cache(old_drv);
+            invalidate_path_cache(new_drv);
+
             return common::move_file(common::ucs2_to_utf8(*old_path_real),
                 common::ucs2_to_utf8(*new_path_real));
         }
 
         bool create_directories(const std::u16string &path) override {
-            std::optional<std::u16string> real_path = get_real_physical_path(path);
+            drive_number drv = drive_z;
+            std::optional<std::u16string> real_path = get_real_physical_path(path, &drv);
 
             if (!real_path) {
                 return false;
             }
 
+            invalidate_path_cache(drv);
             eka2l1::create_directories(common::ucs2_to_utf8(*real_path));
+
             return true;
         }
 
         bool create_directory(const std::u16string &path) override {
-            std::optional<std::u16string> real_path = get_real_physical_path(path);
+            drive_number drv = drive_z;
+            std::optional<std::u16string> real_path = get_real_physical_path(path, &drv);
 
             if (!real_path) {
                 return false;
             }
 
+            invalidate_path_cache(drv);
             eka2l1::create_directory(common::ucs2_to_utf8(*real_path));
 
             return true;
@@ -699,6 +1074,13 @@ namespace eka2l1 {
             if (mappings[static_cast<int>(drv)].second) {
                 mappings[static_cast<int>(drv)].second = false;
 
+                if (watcher_ && (path_cache_watches_[static_cast<int>(drv)] >= 0)) {
+                    watcher_->unwatch(static_cast<std::int32_t>(path_cache_watches_[static_cast<int>(drv)]));
+                    path_cache_watches_[static_cast<int>(drv)] = -1;
+                }
+
+                invalidate_path_cache(drv);
+
                 for (auto &watch_handle: watches[drv]) {
                     if (watcher_) {
                         watcher_->unwatch(static_cast<std::int32_t>(watch_handle));
@@ -745,7 +1127,8 @@ namespace eka2l1 {
                 vir_path.erase(vir_path.begin() + pos_check + 1, vir_path.end());
             }
 
-            auto new_path = get_real_physical_path(vir_path);
+            drive_number drv = drive_z;
+            auto new_path = get_real_physical_path(vir_path, &drv);
 
             if (!new_path) {
                 return std::unique_ptr<directory>(nullptr);
@@ -753,7 +1136,7 @@ namespace eka2l1 {
 
             std::string new_path_utf8 = common::ucs2_to_utf8(*new_path);
 
-            if (!eka2l1::exists(new_path_utf8)) {
+            if (get_host_entry_type(drv, new_path_utf8) == common::FILE_INVALID) {
                 return std::unique_ptr<directory>(nullptr);
             }
 
@@ -762,21 +1145,23 @@ namespace eka2l1 {
         }
 
         std::optional<entry_info> get_entry_info(const std::u16string &path) override {
-            std::optional<std::u16string> real_path = get_real_physical_path(path);
+            drive_number path_drv = drive_z;
+            std::optional<std::u16string> real_path = get_real_physical_path(path, &path_drv);
 
             if (!real_path) {
                 return std::nullopt;
             }
 
             std::string real_path_utf8 = common::ucs2_to_utf8(*real_path);
+            const common::file_type type = get_host_entry_type(path_drv, real_path_utf8);
 
-            if (!eka2l1::exists(real_path_utf8)) {
+            if (type == common::FILE_INVALID) {
                 return std::nullopt;
             }
 
             entry_info info;
 
-            if (common::is_file(real_path_utf8, common::FILE_DIRECTORY)) {
+            if (type == common::FILE_DIRECTORY) {
                 info.type = io_component_type::dir;
                 info.size = 0;
             } else {
@@ -820,7 +1205,8 @@ namespace eka2l1 {
                 }
             }
 
-            std::optional<std::u16string> real_path = get_real_physical_path(path);
+            drive_number path_drv = drive_z;
+            std::optional<std::u16string> real_path = get_real_physical_path(path, &path_drv);
 
             if (!real_path) {
                 return nullptr;
@@ -828,11 +1214,28 @@ namespace eka2l1 {
 
             std::string real_path_utf8 = common::ucs2_to_utf8(*real_path);
 
-            if (!(mode & WRITE_MODE) && (!eka2l1::exists(real_path_utf8) || common::is_file(real_path_utf8, common::FILE_DIRECTORY))) {
-                return nullptr;
+            if (!(mode & WRITE_MODE)) {
+                const common::file_type type = get_host_entry_type(path_drv, real_path_utf8);
+
+                if ((type == common::FILE_INVALID) || (type == common::FILE_DIRECTORY)) {
+                    return nullptr;
+                }
+            }
+
+            if (mode & (WRITE_MODE | APPEND_MODE)) {
+                // The file may be created
+                invalidate_path_cache(path_drv);
+            }
+
+            // Nothing can write to files on read-only drives while they are open, so they can be mapped
+            bool can_map = false;
+
+            if (!root.empty()) {
+                const drive &drv = mappings[static_cast<int>(char16_to_drive(root[0]))].first;
+                can_map = (drv.media_type == drive_media::rom) || (drv.attribute & io_attrib_write_protected);
             }
 
-            return std::make_unique<physical_file>(path, *real_path, mode);
+            return open_physical_file(path, *real_path, mode, can_map);
         }
 
         std::int64_t watch_directory(const std::u16string &path, common::directory_watcher_callback callback,
@@ -851,8 +1254,8 @@ namespace eka2l1 {
             }
 
             const std::int64_t handle = watcher_->watch(common::ucs2_to_utf8(real_path.value()), callback, callback_userdata, filters);
-            if (handle < 0) {
-                return handle;
+            if (handle <= 0) {
+                return -1;
             }
 
             watches[drv].push_back(handle);
@@ -879,6 +1282,8 @@ namespace eka2l1 {
         }
         
         void validate_for_host() override {
+            invalidate_all_path_caches();
+
            if (common::is_platform_case_sensitive()) {
                 LOG_INFO(VFS, "Iterating through all emulated drive to lowercase all filesystem entities!");
 
@@ -1024,11 +1429,18 @@ namespace eka2l1 {
             }
 
             auto entry = burn_tree_find_entry(common::ucs2_to_utf8(new_path));
-            auto ff = physical_file_system::open_file(new_path, mode);
 
-            // Dont change order!
-            if (!entry || ((mode & PREFER_PHYSICAL) && (ff->size() != entry->size))) {
-                return ff;
+            // Only open the host file when it may be used, ROM entries are read from memory
+            if (!entry) {
+                return physical_file_system::open_file(new_path, mode);
+            }
+
+            if (mode & PREFER_PHYSICAL) {
+                auto ff = physical_file_system::open_file(new_path, mode);
+
+                if (ff && (ff->size() != entry->size)) {
+                    return ff;
+                }
             }
 
             return std::make_unique<rom_file>(mem, rom_cache, *entry, path);
@@ -1391,8 +1803,34 @@ namespace eka2l1 {
         }
     }
 
+    io_statistics io_system::get_statistics() const {
+        io_statistics stats;
+
+        stats.bytes_read_ = io_stats.bytes_read_.load(std::memory_order_relaxed);
+        stats.host_read_calls_ = io_stats.host_read_calls_.load(std::memory_order_relaxed);
+        stats.memory_read_calls_ = io_stats.memory_read_calls_.load(std::memory_order_relaxed);
+        stats.files_mapped_ = io_stats.files_mapped_.load(std::memory_order_relaxed);
+        stats.files_mapped_failed_ = io_stats.files_mapped_failed_.load(std::memory_order_relaxed);
+        stats.path_cache_hits_ = io_stats.path_cache_hits_.load(std::memory_order_relaxed);
+        stats.path_cache_misses_ = io_stats.path_cache_misses_.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+
+    void io_system::reset_statistics() {
+        io_stats.bytes_read_ = 0;
+        io_stats.host_read_calls_ = 0;
+        io_stats.memory_read_calls_ = 0;
+        io_stats.files_mapped_ = 0;
+        io_stats.files_mapped_failed_ = 0;
+        io_stats.path_cache_hits_ = 0;
+        io_stats.path_cache_misses_ = 0;
+    }
+
     symfile physical_file_proxy(const std::string &path, int mode) {
-        return std::make_unique<physical_file>(common::utf8_to_ucs2(path), common::utf8_to_ucs2(path), mode);
+        // The emulator's own host files (ROM images, packages...) are not modified while being read
+        const std::u16string path16 = common::utf8_to_ucs2(path);
+        return open_physical_file(path16, path16, mode, true);
     }
 
     void ro_file_stream::seek(const std::int64_t amount, common::seek_where wh) {
@@ -11,6 +11,7 @@
 void IpcReadWriteDescriptorWithoutOffsetL();
 void IpcWriteDescriptorWithoutOffsetL();
 void IpcWriteDescriptorWithOffsetL();
+void IpcRoundTripBenchmarkL();
 
 void AddIpcTestCasesL();
 
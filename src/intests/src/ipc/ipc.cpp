@@ -107,9 +107,41 @@ void IpcReadWithOffsetAndWriteWithoutOffsetL() {
     session.Close();
 }
 
+// Hammer the dummy server with small synchronous requests. Timing goes to the debug
+// output only, what gets verified is that every round trip returned the right hash.
+void IpcRoundTripBenchmarkL() {
+    const TInt KRoundTrips = 10000;
+
+    RDummySession session;
+    session.ConnectL();
+
+    TInt mismatched = 0;
+    const TUint32 startTick = User::NTickCount();
+
+    for (TInt i = 0; i < KRoundTrips; i++) {
+        TInt value = i & 0x7FFF;
+        TInt result = session.GetHash(value);
+
+        if ((result != KErrNone) || (value != (((i & 0x7FFF) << 16) + 0x5972))) {
+            mismatched++;
+        }
+    }
+
+    const TUint32 elapsedTicks = User::NTickCount() - startTick;
+    RDebug::Printf("IPC round trip benchmark: %d round trips in %u nanokernel ticks", KRoundTrips, elapsedTicks);
+
+    TBuf8<70> expectedLine;
+    expectedLine.Format(_L8("DummyServ: %d round trips, %d mismatched"), KRoundTrips, mismatched);
+
+    EXPECT_INPUT_EQUAL_L(expectedLine);
+
+    session.Close();
+}
+
 void AddIpcTestCasesL() {
     ADD_TEST_CASE_L(ReadWriteDescriptorWithoutOffset, IPC, IpcReadWriteDescriptorWithoutOffsetL);
     ADD_TEST_CASE_L(WriteDescriptorWithoutOffset, IPC, IpcWriteDescriptorWithoutOffsetL);
     ADD_TEST_CASE_L(WriteDescriptorWithOffset, IPC, IpcWriteDescriptorWithOffsetL);
     ADD_TEST_CASE_L(ReadWithOffsetWriteDescriptorWithoutOffset, IPC, IpcReadWithOffsetAndWriteWithoutOffsetL);
+    ADD_TEST_CASE_L(RoundTripBenchmark, IPC, IpcRoundTripBenchmarkL);
 }
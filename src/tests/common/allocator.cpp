@@ -18,10 +18,15 @@
  */
 
 #include <catch2/catch.hpp>
+#include <common/algorithm.h>
 #include <common/allocator.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
 
 using namespace eka2l1;
 
@@ -128,4 +133,222 @@ TEST_CASE("bitmap_count_unaligned_start_end", "bitmap_allocator") {
     // First bitmap has 4 valid bits on (from offset 2), plus with bitmap 2 and 3 (4 bits before offset 70),
     // we got 4 + 12 + 4 = 20 bits 
     REQUIRE(alloc.allocated_count(2, 70) == 20);
-}
\ No newline at end of file
+}
+
+namespace {
+    // Space that can grow up to the size of its buffer
+    class expandable_tlsf_allocator : public common::tlsf_allocator {
+        std::size_t capacity_;
+
+    public:
+        explicit expandable_tlsf_allocator(std::uint8_t *sptr, const std::size_t initial_size, const std::size_t capacity)
+            : common::tlsf_allocator(sptr, initial_size)
+            , capacity_(capacity) {
+        }
+
+        bool expand(std::size_t target) override {
+            return target <= capacity_;
+        }
+    };
+}
+
+TEST_CASE("tlsf_alloc_coalesce_neighbours", "tlsf_allocator") {
+    std::vector<std::uint8_t> space(0x10000);
+    common::tlsf_allocator alloc(space.data(), space.size());
+
+    void *first = alloc.allocate(1000);
+    void *second = alloc.allocate(1000);
+    void *third = alloc.allocate(1000);
+
+    REQUIRE(first);
+    REQUIRE(second);
+    REQUIRE(third);
+
+    // Sizes are only rounded to the alignment
+    REQUIRE(alloc.get_statistics().used_size_ == 3000);
+
+    REQUIRE(alloc.free(second));
+    REQUIRE(alloc.get_statistics().free_block_count_ == 2);
+
+    // Merged with the free block in the middle
+    REQUIRE(alloc.free(first));
+    REQUIRE(alloc.get_statistics().free_block_count_ == 2);
+
+    REQUIRE(alloc.free(third));
+
+    const auto stats = alloc.get_statistics();
+    REQUIRE(stats.free_block_count_ == 1);
+    REQUIRE(stats.largest_free_block_ == space.size());
+    REQUIRE(stats.fragmentation() == 0.0);
+}
+
+TEST_CASE("tlsf_reuse_freed_block", "tlsf_allocator") {
+    std::vector<std::uint8_t> space(0x1000);
+    common::tlsf_allocator alloc(space.data(), space.size());
+
+    void *first = alloc.allocate(0x800);
+    REQUIRE(alloc.allocate(0x800));
+    REQUIRE(alloc.allocate(8) == nullptr);
+
+    REQUIRE(alloc.free(first));
+    REQUIRE(alloc.allocate(0x400) == first);
+}
+
+TEST_CASE("tlsf_free_invalid", "tlsf_allocator") {
+    std::vector<std::uint8_t> space(0x1000);
+    common::tlsf_allocator alloc(space.data(), space.size());
+
+    std::uint8_t *block = reinterpret_cast<std::uint8_t *>(alloc.allocate(64));
+
+    REQUIRE_FALSE(alloc.free(block + 8));
+    REQUIRE_FALSE(alloc.free(space.data() + space.size()));
+    REQUIRE(alloc.free(block));
+    REQUIRE_FALSE(alloc.free(block));
+}
+
+TEST_CASE("tlsf_expand_space", "tlsf_allocator") {
+    std::vector<std::uint8_t> space(0x3000);
+    expandable_tlsf_allocator alloc(space.data(), 0x1000, space.size());
+
+    void *first = alloc.allocate(0xC00);
+    void *second = alloc.allocate(0xC00);
+
+    REQUIRE(first);
+    REQUIRE(second);
+    REQUIRE(alloc.get_max_size() == 0x2000);
+
+    // Doubling is over the limit, but what is needed still fits. The free tail covers part of it.
+    void *third = alloc.allocate(0x1000);
+
+    REQUIRE(third);
+    REQUIRE(alloc.get_max_size() == 0x2800);
+    REQUIRE(alloc.allocate(0x1000) == nullptr);
+}
+
+TEST_CASE("tlsf_expand_near_limit", "tlsf_allocator") {
+    std::vector<std::uint8_t> space(0x1000 + 1000);
+
+    {
+        expandable_tlsf_allocator alloc(space.data(), 0x1000, space.size());
+        REQUIRE(alloc.allocate(0x1000));
+
+        // The grown block is exactly what is asked, smaller than the list search rounds up to
+        REQUIRE(alloc.allocate(1000));
+        REQUIRE(alloc.get_max_size() == space.size());
+    }
+
+    {
+        expandable_tlsf_allocator alloc(space.data(), 0x1000, space.size());
+        REQUIRE(alloc.allocate(0xC00));
+
+        // Only the part not covered by the free tail has to fit in the limit
+        REQUIRE(alloc.allocate(2000));
+        REQUIRE(alloc.get_max_size() == 0xC00 + 2000);
+    }
+}
+
+TEST_CASE("tlsf_stress_random", "tlsf_allocator") {
+    struct live_allocation {
+        std::uint8_t *ptr_;
+        std::size_t size_;
+        std::uint8_t pattern_;
+    };
+
+    std::vector<std::uint8_t> space(0x100000);
+    expandable_tlsf_allocator alloc(space.data(), 0x10000, space.size());
+
+    std::mt19937 rng(0x7157);
+    std::vector<live_allocation> lives;
+    std::size_t live_size = 0;
+
+    for (int i = 0; i < 20000; i++) {
+        const bool should_free = !lives.empty() && ((rng() % 100) < 45);
+
+        if (should_free) {
+            const std::size_t victim = rng() % lives.size();
+            const live_allocation allocation = lives[victim];
+
+            // Any overlap with another allocation would have overwritten the pattern
+            const bool intact = std::all_of(allocation.ptr_, allocation.ptr_ + allocation.size_,
+                [&](const std::uint8_t b) { return b == allocation.pattern_; });
+
+            REQUIRE(intact);
+            REQUIRE(alloc.free(allocation.ptr_));
+
+            live_size -= common::align(allocation.size_, common::tlsf_allocator::ALIGNMENT);
+
+            lives[victim] = lives.back();
+            lives.pop_back();
+        } else {
+            // Mostly small structures, sometimes a bitmap-sized block
+            const std::size_t size = ((rng() % 8) == 0) ? (rng() % 0x4000 + 1) : (rng() % 256 + 1);
+            std::uint8_t *ptr = reinterpret_cast<std::uint8_t *>(alloc.allocate(size));
+
+            if (!ptr) {
+                continue;
+            }
+
+            REQUIRE(reinterpret_cast<std::uintptr_t>(ptr) % common::tlsf_allocator::ALIGNMENT == 0);
+            REQUIRE(ptr + size <= space.data() + alloc.get_max_size());
+
+            const std::uint8_t pattern = static_cast<std::uint8_t>(i);
+            std::memset(ptr, pattern, size);
+
+            lives.push_back({ ptr, size, pattern });
+            live_size += common::align(size, common::tlsf_allocator::ALIGNMENT);
+        }
+
+        if (i % 1000 == 0) {
+            const auto stats = alloc.get_statistics();
+
+            REQUIRE(stats.used_size_ == live_size);
+            REQUIRE(stats.used_block_count_ == lives.size());
+            REQUIRE(stats.largest_free_block_ <= stats.free_size_);
+        }
+    }
+
+    for (const live_allocation &allocation : lives) {
+        REQUIRE(alloc.free(allocation.ptr_));
+    }
+
+    // Everything is merged back
+    const auto stats = alloc.get_statistics();
+
+    REQUIRE(stats.used_size_ == 0);
+    REQUIRE(stats.free_block_count_ == 1);
+    REQUIRE(stats.largest_free_block_ == alloc.get_max_size());
+}
+
+TEST_CASE("tlsf_churn", "[.][benchmark]") {
+    std::vector<std::uint8_t> space(0x400000);
+    std::vector<std::size_t> sizes(4096);
+    std::vector<void *> ptrs(sizes.size());
+
+    std::mt19937 rng(0xC4A5);
+
+    for (std::size_t &size : sizes) {
+        size = ((rng() % 8) == 0) ? (rng() % 0x4000 + 1) : (rng() % 256 + 1);
+    }
+
+    common::tlsf_allocator alloc(space.data(), space.size());
+
+    BENCHMARK("Allocate and free 4096 blocks, interleaved") {
+        for (std::size_t i = 0; i < sizes.size(); i++) {
+            ptrs[i] = alloc.allocate(sizes[i]);
+
+            // Free every other one early to leave holes
+            if ((i % 2 == 1) && ptrs[i - 1]) {
+                alloc.free(ptrs[i - 1]);
+                ptrs[i - 1] = nullptr;
+            }
+        }
+
+        for (void *ptr : ptrs) {
+            if (ptr) {
+                alloc.free(ptr);
+            }
+        }
+
+        return alloc.get_max_size();
+    };
+}
@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <common/buffer.h>
+#include <common/bytepair.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace eka2l1;
+
+// Minimal bytepair compressor, good enough to produce valid pages for the decoder
+static std::vector<std::uint8_t> compress_page(const std::uint8_t *data, const std::size_t size, const std::size_t max_pairs) {
+    std::array<bool, 256> used{};
+
+    for (std::size_t i = 0; i < size; i++) {
+        used[data[i]] = true;
+    }
+
+    std::vector<std::uint8_t> free_bytes;
+
+    for (int b = 0; b < 256; b++) {
+        if (!used[b]) {
+            free_bytes.push_back(static_cast<std::uint8_t>(b));
+        }
+    }
+
+    std::vector<std::uint8_t> result;
+
+    if (free_bytes.empty()) {
+        result.push_back(0);
+        result.insert(result.end(), data, data + size);
+        return result;
+    }
+
+    const std::uint8_t marker = free_bytes.back();
+    free_bytes.pop_back();
+
+    std::vector<std::uint8_t> stream(data, data + size);
+    std::map<std::uint8_t, std::pair<std::uint8_t, std::uint8_t>> pairs;
+
+    while ((pairs.size() < max_pairs) && !free_bytes.empty()) {
+        std::map<std::uint16_t, std::size_t> counts;
+
+        for (std::size_t i = 0; i + 1 < stream.size(); i++) {
+            counts[static_cast<std::uint16_t>((stream[i] << 8) | stream[i + 1])]++;
+        }
+
+        std::uint16_t best_pair = 0;
+        std::size_t best_count = 0;
+
+        for (const auto &[pair, count] : counts) {
+            if (count > best_count) {
+                best_pair = pair;
+                best_count = count;
+            }
+        }
+
+        if (best_count < 3) {
+            break;
+        }
+
+        const std::uint8_t token = free_bytes.back();
+        free_bytes.pop_back();
+
+        const std::uint8_t p1 = static_cast<std::uint8_t>(best_pair >> 8);
+        const std::uint8_t p2 = static_cast<std::uint8_t>(best_pair & 0xFF);
+
+        std::vector<std::uint8_t> replaced;
+
+        for (std::size_t i = 0; i < stream.size(); i++) {
+            if ((i + 1 < stream.size()) && (stream[i] == p1) && (stream[i + 1] == p2)) {
+                replaced.push_back(token);
+                i++;
+            } else {
+                replaced.push_back(stream[i]);
+            }
+        }
+
+        stream = std::move(replaced);
+        pairs[token] = { p1, p2 };
+    }
+
+    result.push_back(static_cast<std::uint8_t>(pairs.size()));
+
+    if (pairs.empty()) {
+        result.insert(result.end(), stream.begin(), stream.end());
+        return result;
+    }
+
+    result.push_back(marker);
+
+    if (pairs.size() < 32) {
+        for (const auto &[token, pair] : pairs) {
+            result.push_back(token);
+            result.push_back(pair.first);
+            result.push_back(pair.second);
+        }
+    } else {
+        std::array<std::uint8_t, 32> mask{};
+
+        for (const auto &[token, pair] : pairs) {
+            mask[token >> 3] |= (1 << (token & 7));
+        }
+
+        result.insert(result.end(), mask.begin(), mask.end());
+
+        for (const auto &[token, pair] : pairs) {
+            result.push_back(pair.first);
+            result.push_back(pair.second);
+        }
+    }
+
+    result.insert(result.end(), stream.begin(), stream.end());
+    return result;
+}
+
+// Lay out a bytepair section: the index table, followed by the compressed pages
+static void append_section(std::vector<std::uint8_t> &section, const std::vector<std::uint8_t> &data, const std::size_t max_pairs) {
+    std::vector<std::vector<std::uint8_t>> pages;
+
+    for (std::size_t offset = 0; offset < data.size(); offset += common::BYTEPAIR_PAGE_SIZE) {
+        const std::size_t size = std::min<std::size_t>(data.size() - offset, common::BYTEPAIR_PAGE_SIZE);
+        pages.push_back(compress_page(data.data() + offset, size, max_pairs));
+    }
+
+    std::uint32_t compressed_size = 0;
+
+    for (const auto &page : pages) {
+        compressed_size += static_cast<std::uint32_t>(page.size());
+    }
+
+    const std::uint32_t decompressed_size = static_cast<std::uint32_t>(data.size());
+    const std::uint16_t page_count = static_cast<std::uint16_t>(pages.size());
+
+    const std::size_t header_pos = section.size();
+    section.resize(header_pos + 10);
+
+    std::memcpy(&section[header_pos], &compressed_size, 4);
+    std::memcpy(&section[header_pos + 4], &decompressed_size, 4);
+    std::memcpy(&section[header_pos + 8], &page_count, 2);
+
+    for (const auto &page : pages) {
+        const std::uint16_t page_size = static_cast<std::uint16_t>(page.size());
+        section.push_back(static_cast<std::uint8_t>(page_size & 0xFF));
+        section.push_back(static_cast<std::uint8_t>(page_size >> 8));
+    }
+
+    for (const auto &page : pages) {
+        section.insert(section.end(), page.begin(), page.end());
+    }
+}
+
+// Something that looks a bit like code: a small alphabet with repeating patterns
+static std::vector<std::uint8_t> make_compressible_data(const std::size_t size, const std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::uint8_t> data(size);
+
+    static const std::uint8_t patterns[4][4] = {
+        { 0x00, 0x48, 0x2D, 0xE9 },
+        { 0x04, 0x00, 0xA0, 0xE1 },
+        { 0x1E, 0xFF, 0x2F, 0xE1 },
+        { 0x10, 0x40, 0xBD, 0xE8 }
+    };
+
+    for (std::size_t i = 0; i < size; i += 4) {
+        const std::uint32_t choice = rng() % 6;
+
+        for (std::size_t j = 0; (j < 4) && (i + j < size); j++) {
+            data[i + j] = (choice < 4) ? patterns[choice][j] : static_cast<std::uint8_t>(rng() % 48);
+        }
+    }
+
+    return data;
+}
+
+TEST_CASE("bytepair_parallel_matches_serial", "bytepair") {
+    // Code and data sections like an E32 image. Neither is a multiple of the page size.
+    const auto code = make_compressible_data(37 * common::BYTEPAIR_PAGE_SIZE + 123, 0xC0DE);
+    const auto rest = make_compressible_data(19 * common::BYTEPAIR_PAGE_SIZE + 7, 0xDA7A);
+
+    std::vector<std::uint8_t> image;
+    append_section(image, code, 20);
+    append_section(image, rest, 20);
+
+    for (const std::uint32_t threads : { 1, 2, 4, 0 }) {
+        INFO("threads " << threads);
+
+        common::ro_buf_stream raw_stream(image.data(), image.size());
+        common::ibytepair_stream bpstream(&raw_stream);
+
+        std::vector<char> result(code.size() + rest.size(), 0);
+
+        REQUIRE(bpstream.read_pages(result.data(), code.size(), threads) == code.size());
+        REQUIRE(bpstream.read_pages(result.data() + code.size(), rest.size(), threads) == rest.size());
+
+        REQUIRE(std::memcmp(result.data(), code.data(), code.size()) == 0);
+        REQUIRE(std::memcmp(result.data() + code.size(), rest.data(), rest.size()) == 0);
+    }
+}
+
+TEST_CASE("bytepair_many_pairs_table", "bytepair") {
+    // Enough pairs to switch the page table to the bitmask format
+    const auto data = make_compressible_data(4 * common::BYTEPAIR_PAGE_SIZE, 0xB17);
+
+    std::vector<std::uint8_t> image;
+    append_section(image, data, 150);
+
+    common::ro_buf_stream raw_stream(image.data(), image.size());
+    common::ibytepair_stream bpstream(&raw_stream);
+
+    std::vector<char> result(data.size(), 0);
+
+    REQUIRE(bpstream.read_pages(result.data(), result.size()) == data.size());
+    REQUIRE(std::memcmp(result.data(), data.data(), data.size()) == 0);
+}
+
+TEST_CASE("bytepair_page_store_decompresses_ranges", "bytepair") {
+    const auto code = make_compressible_data(9 * common::BYTEPAIR_PAGE_SIZE + 57, 0x5E6);
+
+    std::vector<std::uint8_t> image;
+    append_section(image, code, 20);
+
+    common::ro_buf_stream raw_stream(image.data(), image.size());
+    common::ibytepair_stream bpstream(&raw_stream);
+
+    common::bytepair_page_store store;
+    REQUIRE(store.load(bpstream, code.size()));
+    REQUIRE(store.decompressed_size() == code.size());
+
+    std::vector<char> result(code.size(), 0);
+
+    // Only the pages overlapping the range are written
+    REQUIRE(store.decompress(result.data(), common::BYTEPAIR_PAGE_SIZE + 100, common::BYTEPAIR_PAGE_SIZE));
+    REQUIRE(std::memcmp(result.data() + common::BYTEPAIR_PAGE_SIZE, code.data() + common::BYTEPAIR_PAGE_SIZE,
+        2 * common::BYTEPAIR_PAGE_SIZE) == 0);
+
+    REQUIRE(result[0] == 0);
+    REQUIRE(result[3 * common::BYTEPAIR_PAGE_SIZE] == 0);
+
+    // The partial last page, and ranges running past the end, stop at the decompressed size
+    REQUIRE(store.decompress(result.data(), code.size() - 1, 0x10000));
+    REQUIRE(std::memcmp(result.data() + 9 * common::BYTEPAIR_PAGE_SIZE, code.data() + 9 * common::BYTEPAIR_PAGE_SIZE,
+        57) == 0);
+
+    REQUIRE(store.decompress(result.data(), 0, code.size()));
+    REQUIRE(std::memcmp(result.data(), code.data(), code.size()) == 0);
+}
+
+TEST_CASE("bytepair_decompress_throughput", "[.][benchmark]") {
+    // About the size of a large ROFS executable
+    const auto data = make_compressible_data(256 * common::BYTEPAIR_PAGE_SIZE, 0xBE7C);
+
+    std::vector<std::uint8_t> image;
+    append_section(image, data, 64);
+
+    std::vector<char> result(data.size());
+
+    for (const std::uint32_t threads : { 1, 0 }) {
+        BENCHMARK(threads == 1 ? "Decompress 1MB serially" : "Decompress 1MB in parallel") {
+            common::ro_buf_stream raw_stream(image.data(), image.size());
+            common::ibytepair_stream bpstream(&raw_stream);
+
+            return bpstream.read_pages(result.data(), result.size(), threads);
+        };
+    }
+}
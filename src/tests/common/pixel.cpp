@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <common/pixel.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace eka2l1;
+
+static const std::array<common::pixel_format, 12> ALL_PIXEL_FORMATS = {
+    common::pixel_format::gray2, common::pixel_format::gray4, common::pixel_format::gray16,
+    common::pixel_format::gray256, common::pixel_format::color16, common::pixel_format::color256,
+    common::pixel_format::color4k, common::pixel_format::color64k, common::pixel_format::color16m,
+    common::pixel_format::color16mu, common::pixel_format::color16ma, common::pixel_format::color16map
+};
+
+static const std::array<const char *, 12> PIXEL_FORMAT_NAMES = {
+    "gray2", "gray4", "gray16", "gray256", "color16", "color256", "color4k", "color64k", "color16m",
+    "color16mu", "color16ma", "color16map"
+};
+
+static std::uint32_t make_argb(const std::uint32_t a, const std::uint32_t r, const std::uint32_t g, const std::uint32_t b) {
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+static std::uint32_t scale_bits(const std::uint32_t value, const std::uint32_t bits) {
+    return (value * 255 + ((1 << bits) - 1) / 2) / ((1 << bits) - 1);
+}
+
+// Straightforward per-pixel conversion, to check the vectorized paths against
+static std::uint32_t reference_convert(const common::pixel_format format, const std::uint8_t *source, const std::size_t x,
+    const std::uint32_t *palette, const bool premultiplied) {
+    const std::uint32_t bpp = common::get_pixel_format_bpp(format);
+    std::uint32_t value = 0;
+
+    if (bpp < 8) {
+        value = (source[(x * bpp) / 8] >> ((x * bpp) % 8)) & ((1 << bpp) - 1);
+    } else {
+        const std::size_t bytes = bpp / 8;
+
+        for (std::size_t i = 0; i < bytes; i++) {
+            value |= source[x * bytes + i] << (i * 8);
+        }
+    }
+
+    switch (format) {
+    case common::pixel_format::gray2:
+    case common::pixel_format::gray4:
+    case common::pixel_format::gray16:
+    case common::pixel_format::gray256: {
+        const std::uint32_t gray = scale_bits(value, bpp);
+        return make_argb(255, gray, gray, gray);
+    }
+
+    case common::pixel_format::color16:
+    case common::pixel_format::color256:
+        return palette[value];
+
+    case common::pixel_format::color4k:
+        return make_argb(255, scale_bits((value >> 8) & 0xF, 4), scale_bits((value >> 4) & 0xF, 4), scale_bits(value & 0xF, 4));
+
+    case common::pixel_format::color64k:
+        return make_argb(255, ((value >> 11) << 3) | ((value >> 11) >> 2), (((value >> 5) & 0x3F) << 2) | (((value >> 5) & 0x3F) >> 4),
+            ((value & 0x1F) << 3) | ((value & 0x1F) >> 2));
+
+    case common::pixel_format::color16m:
+    case common::pixel_format::color16mu:
+        return value | 0xFF000000;
+
+    case common::pixel_format::color16ma:
+    case common::pixel_format::color16map: {
+        const std::uint32_t a = value >> 24;
+        std::uint32_t channels[3] = { (value >> 16) & 0xFF, (value >> 8) & 0xFF, value & 0xFF };
+
+        if ((format == common::pixel_format::color16ma) && premultiplied) {
+            for (auto &c : channels) {
+                c = (c * a + 127) / 255;
+            }
+        } else if ((format == common::pixel_format::color16map) && !premultiplied) {
+            if (a == 0) {
+                return 0;
+            }
+
+            for (auto &c : channels) {
+                c = std::min<std::uint32_t>(255, (c * 255 + a / 2) / a);
+            }
+        }
+
+        return make_argb(a, channels[0], channels[1], channels[2]);
+    }
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+static std::vector<std::uint8_t> make_random_row(const common::pixel_format format, const std::size_t width, std::mt19937 &rng) {
+    std::vector<std::uint8_t> row((width * common::get_pixel_format_bpp(format) + 31) / 8);
+
+    for (auto &byte : row) {
+        byte = static_cast<std::uint8_t>(rng());
+    }
+
+    return row;
+}
+
+static std::array<std::uint32_t, 256> make_test_palette() {
+    std::array<std::uint32_t, 256> palette;
+
+    for (std::uint32_t i = 0; i < 256; i++) {
+        palette[i] = make_argb(255, i, 255 - i, (i * 7) & 0xFF);
+    }
+
+    return palette;
+}
+
+TEST_CASE("pixel_convert_matches_reference", "pixel") {
+    std::mt19937 rng(0xB17A);
+    const auto palette = make_test_palette();
+
+    // Odd widths, so the scalar tails after the vector loops are covered too
+    for (const std::size_t width : { 1, 7, 13, 64, 131 }) {
+        for (const common::pixel_format format : ALL_PIXEL_FORMATS) {
+            for (const bool premultiplied : { false, true }) {
+                const std::vector<std::uint8_t> source = make_random_row(format, width, rng);
+                std::vector<std::uint32_t> dest(width + 1, 0xDEADBEEF);
+
+                common::convert_row_to_argb8888(format, source.data(), dest.data(), width, palette.data(), premultiplied);
+
+                for (std::size_t x = 0; x < width; x++) {
+                    INFO("format " << PIXEL_FORMAT_NAMES[static_cast<int>(format)] << ", width " << width << ", pixel " << x);
+                    REQUIRE(dest[x] == reference_convert(format, source.data(), x, palette.data(), premultiplied));
+                }
+
+                // Nothing written past the row
+                REQUIRE(dest[width] == 0xDEADBEEF);
+            }
+        }
+    }
+}
+
+TEST_CASE("pixel_convert_known_values", "pixel") {
+    std::uint32_t dest[4] = {};
+
+    const std::uint8_t mono[1] = { 0b0101 };
+    common::convert_row_to_argb8888(common::pixel_format::gray2, mono, dest, 4);
+
+    REQUIRE(dest[0] == 0xFFFFFFFF);
+    REQUIRE(dest[1] == 0xFF000000);
+    REQUIRE(dest[2] == 0xFFFFFFFF);
+
+    // Pure red, green and blue in RGB565
+    const std::uint16_t rgb565[3] = { 0xF800, 0x07E0, 0x001F };
+    common::convert_row_to_argb8888(common::pixel_format::color64k, reinterpret_cast<const std::uint8_t *>(rgb565), dest, 3);
+
+    REQUIRE(dest[0] == 0xFFFF0000);
+    REQUIRE(dest[1] == 0xFF00FF00);
+    REQUIRE(dest[2] == 0xFF0000FF);
+
+    // 0x0RGB, each pixel in a 16-bit word
+    const std::uint16_t rgb444[2] = { 0x0F00, 0x00F8 };
+    common::convert_row_to_argb8888(common::pixel_format::color4k, reinterpret_cast<const std::uint8_t *>(rgb444), dest, 2);
+
+    REQUIRE(common::get_pixel_format_bpp(common::pixel_format::color4k) == 16);
+    REQUIRE(dest[0] == 0xFFFF0000);
+    REQUIRE(dest[1] == 0xFF00FF88);
+
+    // Half transparent white
+    const std::uint32_t straight[1] = { 0x80FFFFFF };
+    common::convert_row_to_argb8888(common::pixel_format::color16ma, reinterpret_cast<const std::uint8_t *>(straight), dest, 1,
+        nullptr, true);
+
+    REQUIRE(dest[0] == 0x80808080);
+
+    common::convert_row_to_argb8888(common::pixel_format::color16map, reinterpret_cast<const std::uint8_t *>(dest), dest, 1);
+    REQUIRE(dest[0] == 0x80FFFFFF);
+}
+
+TEST_CASE("pixel_convert_2d_stride", "pixel") {
+    // 3x2 color16m with a padded source stride
+    const std::uint8_t source[] = {
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xAA, 0xAA, 0xAA,
+        0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xAA, 0xAA, 0xAA
+    };
+
+    std::uint32_t dest[8] = {};
+    common::convert_to_argb8888(common::pixel_format::color16m, source, 12, dest, 4, 3, 2);
+
+    REQUIRE(dest[0] == 0xFF030201);
+    REQUIRE(dest[2] == 0xFF090807);
+    REQUIRE(dest[3] == 0);
+    REQUIRE(dest[4] == 0xFF131211);
+    REQUIRE(dest[6] == 0xFF191817);
+}
+
+TEST_CASE("pixel_convert_throughput", "[.][benchmark]") {
+    // A full-screen bitmap of a nHD device
+    static constexpr std::size_t WIDTH = 640;
+    static constexpr std::size_t HEIGHT = 360;
+
+    std::mt19937 rng(0x5EED);
+    const auto palette = make_test_palette();
+
+    std::vector<std::uint32_t> dest(WIDTH * HEIGHT);
+
+    for (std::size_t i = 0; i < ALL_PIXEL_FORMATS.size(); i++) {
+        const common::pixel_format format = ALL_PIXEL_FORMATS[i];
+        std::vector<std::uint8_t> source;
+        const std::size_t stride = (WIDTH * common::get_pixel_format_bpp(format) + 31) / 32 * 4;
+
+        for (std::size_t y = 0; y < HEIGHT; y++) {
+            const auto row = make_random_row(format, WIDTH, rng);
+            source.insert(source.end(), row.begin(), row.begin() + stride);
+        }
+
+        BENCHMARK(std::string("Convert 640x360 ") + PIXEL_FORMAT_NAMES[i]) {
+            common::convert_to_argb8888(format, source.data(), stride, dest.data(), WIDTH, WIDTH, HEIGHT,
+                palette.data(), format == common::pixel_format::color16ma);
+
+            return dest[0];
+        };
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <common/queue.h>
+
+#include <thread>
+#include <vector>
+
+using namespace eka2l1;
+
+TEST_CASE("ring_buffer_full_and_empty", "lockfree_ring_buffer") {
+    lockfree_ring_buffer<int, 4> buffer;
+    int value = 0;
+
+    REQUIRE(!buffer.pop(value));
+
+    for (int i = 0; i < 4; i++) {
+        REQUIRE(buffer.push(i));
+    }
+
+    REQUIRE(!buffer.push(4));
+    REQUIRE(buffer.size() == 4);
+
+    // Wrap around a few times, order must be kept
+    for (int i = 0; i < 10; i++) {
+        REQUIRE(buffer.pop(value));
+        REQUIRE(value == i);
+        REQUIRE(buffer.push(i + 4));
+    }
+
+    REQUIRE(buffer.size() == 4);
+}
+
+TEST_CASE("ring_buffer_multiple_producers", "lockfree_ring_buffer") {
+    static constexpr int PRODUCER_COUNT = 4;
+    static constexpr int VALUE_PER_PRODUCER = 20000;
+
+    lockfree_ring_buffer<int, 256> buffer;
+    std::vector<std::thread> producers;
+
+    for (int i = 0; i < PRODUCER_COUNT; i++) {
+        producers.emplace_back([&buffer, i]() {
+            for (int j = 0; j < VALUE_PER_PRODUCER; j++) {
+                while (!buffer.push(i * VALUE_PER_PRODUCER + j)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> last_seen(PRODUCER_COUNT, -1);
+    int received = 0;
+    int value = 0;
+
+    while (received < PRODUCER_COUNT * VALUE_PER_PRODUCER) {
+        if (!buffer.pop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Values of each producer come out in the order they were pushed
+        const int producer = value / VALUE_PER_PRODUCER;
+        REQUIRE(value % VALUE_PER_PRODUCER == last_seen[producer] + 1);
+
+        last_seen[producer] = value % VALUE_PER_PRODUCER;
+        received++;
+    }
+
+    for (std::thread &producer : producers) {
+        producer.join();
+    }
+
+    REQUIRE(!buffer.pop(value));
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <common/region.h>
+
+using namespace eka2l1;
+
+static int region_area(const common::region &reg) {
+    int area = 0;
+
+    for (const eka2l1::rect &rect : reg.rects_) {
+        area += rect.size.x * rect.size.y;
+    }
+
+    return area;
+}
+
+TEST_CASE("region_eliminate_middle", "region") {
+    common::region reg;
+    reg.add_rect(eka2l1::rect({ 0, 0 }, { 100, 100 }));
+
+    // Punch a hole, four pieces around it are left
+    reg.eliminate(eka2l1::rect({ 25, 25 }, { 50, 50 }));
+
+    REQUIRE(reg.rects_.size() == 4);
+    REQUIRE(region_area(reg) == 100 * 100 - 50 * 50);
+
+    for (const eka2l1::rect &rect : reg.rects_) {
+        REQUIRE(rect.intersect(eka2l1::rect({ 25, 25 }, { 50, 50 })).empty());
+    }
+}
+
+TEST_CASE("region_eliminate_consecutive_rects", "region") {
+    common::region reg;
+    reg.rects_.push_back(eka2l1::rect({ 0, 0 }, { 10, 10 }));
+    reg.rects_.push_back(eka2l1::rect({ 10, 0 }, { 10, 10 }));
+    reg.rects_.push_back(eka2l1::rect({ 20, 0 }, { 10, 10 }));
+
+    // Covers all of them
+    reg.eliminate(eka2l1::rect({ 0, 0 }, { 30, 10 }));
+
+    REQUIRE(reg.empty());
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <console/bench.h>
+
+#include <string>
+#include <vector>
+
+using namespace eka2l1;
+
+TEST_CASE("bench_input_script_parses_events", "console") {
+    const std::string script = "# Open the menu\n"
+                               "\n"
+                               "1500 key_down 13\n"
+                               "  1600 key_up 13\n"
+                               "200 touch_down 10 20\n"
+                               "200 touch_move 15 25\n"
+                               "250 touch_up 15 25\n";
+
+    std::vector<desktop::bench_input> inputs;
+    std::string err;
+
+    REQUIRE(desktop::parse_bench_input_script(script, inputs, &err));
+    REQUIRE(inputs.size() == 5);
+
+    // Sorted by time, events given at the same time keep their order
+    REQUIRE(inputs[0].time_us_ == 200000);
+    REQUIRE(inputs[0].evt_.type_ == drivers::input_event_type::touch);
+    REQUIRE(inputs[0].evt_.mouse_.action_ == drivers::mouse_action_press);
+    REQUIRE(inputs[0].evt_.mouse_.button_ == drivers::mouse_button_left);
+    REQUIRE(inputs[0].evt_.mouse_.pos_x_ == 10);
+    REQUIRE(inputs[0].evt_.mouse_.pos_y_ == 20);
+
+    REQUIRE(inputs[1].time_us_ == 200000);
+    REQUIRE(inputs[1].evt_.mouse_.action_ == drivers::mouse_action_repeat);
+
+    REQUIRE(inputs[2].time_us_ == 250000);
+    REQUIRE(inputs[2].evt_.mouse_.action_ == drivers::mouse_action_release);
+
+    REQUIRE(inputs[3].time_us_ == 1500000);
+    REQUIRE(inputs[3].evt_.type_ == drivers::input_event_type::key);
+    REQUIRE(inputs[3].evt_.key_.code_ == 13);
+    REQUIRE(inputs[3].evt_.key_.state_ == drivers::key_state::pressed);
+
+    REQUIRE(inputs[4].time_us_ == 1600000);
+    REQUIRE(inputs[4].evt_.key_.state_ == drivers::key_state::released);
+}
+
+TEST_CASE("bench_input_script_reports_bad_lines", "console") {
+    std::vector<desktop::bench_input> inputs;
+    std::string err;
+
+    REQUIRE(!desktop::parse_bench_input_script("100 key_down 4\nkey_up 4\n", inputs, &err));
+    REQUIRE(err.find("Line 2") == 0);
+
+    REQUIRE(!desktop::parse_bench_input_script("100 key_down\n", inputs, &err));
+    REQUIRE(err.find("key code") != std::string::npos);
+
+    REQUIRE(!desktop::parse_bench_input_script("100 touch_down 5\n", inputs, &err));
+    REQUIRE(err.find("position") != std::string::npos);
+
+    REQUIRE(!desktop::parse_bench_input_script("100 shake\n", inputs, &err));
+    REQUIRE(err.find("unknown action shake") != std::string::npos);
+}
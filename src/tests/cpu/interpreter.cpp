@@ -0,0 +1,509 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <cpu/12l1r/interpreter.h>
+#include <cpu/12l1r/semantics.h>
+#include <cpu/arm_factory.h>
+#include <cpu/arm_tiered.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace eka2l1;
+
+static constexpr arm::address CODE_BASE = 0x10000;
+static constexpr arm::address DATA_BASE = 0x20000;
+static constexpr std::size_t MEMORY_SIZE = 0x20000;
+
+/**
+ * \brief Guest memory from 0x10000 to 0x30000, with code at the start and data in the second half.
+ */
+struct test_machine {
+    std::vector<std::uint8_t> memory_;
+
+    arm::exclusive_monitor_instance monitor_;
+    arm::core_instance core_;
+
+    std::vector<std::pair<arm::exception_type, std::uint32_t>> exceptions_;
+    std::uint32_t last_svc_ = 0xFFFFFFFF;
+
+    template <typename T>
+    static bool read(void *userdata, const arm::address addr, T *data) {
+        test_machine *self = reinterpret_cast<test_machine *>(userdata);
+
+        if ((addr < CODE_BASE) || (addr + sizeof(T) > CODE_BASE + MEMORY_SIZE)) {
+            return false;
+        }
+
+        std::memcpy(data, self->memory_.data() + addr - CODE_BASE, sizeof(T));
+        return true;
+    }
+
+    template <typename T>
+    static bool write(void *userdata, const arm::address addr, T *data) {
+        test_machine *self = reinterpret_cast<test_machine *>(userdata);
+
+        if ((addr < CODE_BASE) || (addr + sizeof(T) > CODE_BASE + MEMORY_SIZE)) {
+            return false;
+        }
+
+        std::memcpy(self->memory_.data() + addr - CODE_BASE, data, sizeof(T));
+        return true;
+    }
+
+    template <typename T>
+    static std::int32_t exclusive_write(void *userdata, const arm::address addr, T value, T expected) {
+        T current = 0;
+
+        if (!read(userdata, addr, &current)) {
+            return -1;
+        }
+
+        if (current != expected) {
+            return 0;
+        }
+
+        write(userdata, addr, &value);
+        return 1;
+    }
+
+    explicit test_machine(const arm_emulator_type type = arm_emulator_type::interpreter)
+        : memory_(MEMORY_SIZE, 0) {
+        monitor_ = arm::create_exclusive_monitor(type, 1);
+        core_ = arm::create_core(monitor_.get(), type);
+
+        if (!core_ || !monitor_) {
+            return;
+        }
+
+        arm::memory_callbacks callbacks;
+        callbacks.userdata = this;
+        callbacks.read_8bit = read<std::uint8_t>;
+        callbacks.read_16bit = read<std::uint16_t>;
+        callbacks.read_32bit = read<std::uint32_t>;
+        callbacks.read_64bit = read<std::uint64_t>;
+        callbacks.write_8bit = write<std::uint8_t>;
+        callbacks.write_16bit = write<std::uint16_t>;
+        callbacks.write_32bit = write<std::uint32_t>;
+        callbacks.write_64bit = write<std::uint64_t>;
+        callbacks.exclusive_write_8bit = exclusive_write<std::uint8_t>;
+        callbacks.exclusive_write_16bit = exclusive_write<std::uint16_t>;
+        callbacks.exclusive_write_32bit = exclusive_write<std::uint32_t>;
+        callbacks.exclusive_write_64bit = exclusive_write<std::uint64_t>;
+
+        core_->set_memory_callbacks(callbacks);
+
+        monitor_->read_8bit = [this](arm::core *, arm::address addr, std::uint8_t *data) { return read(this, addr, data); };
+        monitor_->read_16bit = [this](arm::core *, arm::address addr, std::uint16_t *data) { return read(this, addr, data); };
+        monitor_->read_32bit = [this](arm::core *, arm::address addr, std::uint32_t *data) { return read(this, addr, data); };
+        monitor_->read_64bit = [this](arm::core *, arm::address addr, std::uint64_t *data) { return read(this, addr, data); };
+        monitor_->write_8bit = [this](arm::core *, arm::address addr, std::uint8_t value, std::uint8_t expected) {
+            return exclusive_write(this, addr, value, expected);
+        };
+        monitor_->write_16bit = [this](arm::core *, arm::address addr, std::uint16_t value, std::uint16_t expected) {
+            return exclusive_write(this, addr, value, expected);
+        };
+        monitor_->write_32bit = [this](arm::core *, arm::address addr, std::uint32_t value, std::uint32_t expected) {
+            return exclusive_write(this, addr, value, expected);
+        };
+        monitor_->write_64bit = [this](arm::core *, arm::address addr, std::uint64_t value, std::uint64_t expected) {
+            return exclusive_write(this, addr, value, expected);
+        };
+
+        // Only the code half goes in the page table, data accesses take the callbacks
+        core_->map_backing_mem(CODE_BASE, DATA_BASE - CODE_BASE, memory_.data(), prot::read_write_exec);
+
+        core_->system_call_handler = [this](const std::uint32_t svc) {
+            last_svc_ = svc;
+            core_->stop();
+        };
+
+        core_->exception_handler = [this](arm::exception_type type, const std::uint32_t data) {
+            exceptions_.emplace_back(type, data);
+            core_->stop();
+        };
+
+        core_->set_cpsr(0x10);
+    }
+
+    void load(const std::vector<std::uint32_t> &words, const arm::address where = CODE_BASE) {
+        std::memcpy(memory_.data() + where - CODE_BASE, words.data(), words.size() * sizeof(std::uint32_t));
+    }
+
+    std::uint32_t data_word(const arm::address addr) {
+        std::uint32_t value = 0;
+        read(this, addr, &value);
+
+        return value;
+    }
+
+    void run_from(const arm::address pc, const std::uint32_t limit = 100000) {
+        core_->set_pc(pc);
+        core_->run(limit);
+    }
+};
+
+TEST_CASE("data_processing_and_conditions", "interpreter") {
+    test_machine machine;
+
+    // mov r0, #0 / mov r1, #5 / cmp r1, #3 / movgt r0, #1 / movle r0, #2 / mvn r2, #0 / adds r3, r2, #1
+    // movcs r4, #7 / movcc r4, #8 / mov r5, #0x80000000 / movs r6, r5, lsl #1 / moveq r7, #1 / movne r7, #2
+    // mov r8, #3 / rsb r9, r8, #10 / sub r10, r8, r8, lsl #2 / mov r11, #1 / mov r12, r11, ror #1 / svc #0
+    machine.load({ 0xE3A00000, 0xE3A01005, 0xE3510003, 0xC3A00001, 0xD3A00002, 0xE3E02000, 0xE2923001,
+        0x23A04007, 0x33A04008, 0xE3A05102, 0xE1B06085, 0x03A07001, 0x13A07002, 0xE3A08003, 0xE268900A,
+        0xE048A108, 0xE3A0B001, 0xE1A0C0EB, 0xEF000000 });
+
+    machine.run_from(CODE_BASE);
+
+    arm::core *core = machine.core_.get();
+
+    REQUIRE(machine.last_svc_ == 0);
+    REQUIRE(core->get_pc() == CODE_BASE + 19 * 4);
+    REQUIRE(core->get_reg(0) == 1);
+    REQUIRE(core->get_reg(3) == 0);
+    REQUIRE(core->get_reg(4) == 7);
+    REQUIRE(core->get_reg(6) == 0);
+    REQUIRE(core->get_reg(7) == 1);
+    REQUIRE(core->get_reg(9) == 7);
+    REQUIRE(core->get_reg(10) == 0xFFFFFFF7);
+    REQUIRE(core->get_reg(12) == 0x80000000);
+
+    // Z and C from the last flag setting instruction
+    REQUIRE((core->get_cpsr() & 0x60000000) == 0x60000000);
+}
+
+TEST_CASE("loop_counts_instructions", "interpreter") {
+    test_machine machine;
+
+    // mov r0, #0 / mov r1, #100 / loop: add r0, r0, r1 / subs r1, r1, #1 / bne loop / svc #0
+    machine.load({ 0xE3A00000, 0xE3A01064, 0xE0800001, 0xE2511001, 0x1AFFFFFC, 0xEF000000 });
+    machine.run_from(CODE_BASE);
+
+    REQUIRE(machine.core_->get_reg(0) == 5050);
+    REQUIRE(machine.core_->get_num_instruction_executed() == 2 + 100 * 3 + 1);
+}
+
+TEST_CASE("load_store_addressing", "interpreter") {
+    test_machine machine;
+
+    // ldr r0, =0x11A2B3C4 / mov r1, #0x20000 / str r0, [r1, #4]! / ldrb r2, [r1, #1] / ldrh r3, [r1], #4
+    // ldrsb r11, [r1, #-3] / mov r5, #1 / mov r6, #2 / mov r7, #3 / stmdb r1!, {r5-r7} / ldmia r1, {r8-r10}
+    // strd r6, r7, [r1, #16] / ldrd r4, r5, [r1, #16] / svc #0
+    machine.load({ 0xE59F0030, 0xE3A01802, 0xE5A10004, 0xE5D12001, 0xE0D130B4, 0xE151B0D3, 0xE3A05001,
+        0xE3A06002, 0xE3A07003, 0xE92100E0, 0xE8910700, 0xE1C161F0, 0xE1C141D0, 0xEF000000, 0x11A2B3C4 });
+
+    machine.run_from(CODE_BASE);
+
+    arm::core *core = machine.core_.get();
+
+    REQUIRE(core->get_reg(1) == DATA_BASE + 8 - 12);
+    REQUIRE(core->get_reg(2) == 0xB3);
+    REQUIRE(core->get_reg(3) == 0xB3C4);
+    REQUIRE(core->get_reg(11) == 0xFFFFFFB3);
+    REQUIRE(core->get_reg(8) == 1);
+    REQUIRE(core->get_reg(9) == 2);
+    REQUIRE(core->get_reg(10) == 3);
+    REQUIRE(core->get_reg(4) == 2);
+    REQUIRE(core->get_reg(5) == 3);
+    REQUIRE(machine.data_word(DATA_BASE + 4) == 3);
+}
+
+TEST_CASE("arm_thumb_interworking", "interpreter") {
+    test_machine machine;
+
+    // ARM: mov r0, #10 / mov sp, #0x21000 / blx thumb_func / add r0, r0, #1 / svc #0
+    // Thumb: push {r4, lr} / movs r4, #5 / lsls r4, r4, #2 / adds r0, r4, r0 / bl helper / ldr r1, =0x12345678
+    // lsrs r2, r1, #28 / mvns r3, r2 / cmp r0, #31 / beq 1f / movs r0, #0 / 1: pop {r4, pc}
+    // helper: adds r0, #1 / bx lr
+    machine.load({ 0xE3A0000A, 0xE3A0DA21, 0xFA000001, 0xE2800001, 0xEF000000, 0x2405B510, 0x182000A4,
+        0xF807F000, 0x0F0A4904, 0x281F43D3, 0x2000D000, 0x3001BD10, 0x00004770, 0x12345678 });
+
+    machine.run_from(CODE_BASE);
+
+    arm::core *core = machine.core_.get();
+
+    REQUIRE(machine.exceptions_.empty());
+    REQUIRE(core->get_reg(0) == 32);
+    REQUIRE(core->get_reg(2) == 1);
+    REQUIRE(core->get_reg(3) == 0xFFFFFFFE);
+    REQUIRE(core->get_sp() == 0x21000);
+    REQUIRE(!core->is_thumb_mode());
+}
+
+TEST_CASE("multiply_family", "interpreter") {
+    test_machine machine;
+
+    // mov r0, #0x80000001 / mov r1, #4 / umull r2, r3, r0, r1 / smull r4, r5, r0, r1 / mov r6, #3
+    // mla r7, r1, r6, r1 / smlal r4, r5, r1, r6 / mov r8, #0x10000 / mvn r9, #0 / smulbb r10, r9, r9
+    // smultb r11, r8, r1 / mul r12, r0, r1 / svc #0
+    machine.load({ 0xE3A00106, 0xE3A01004, 0xE0832190, 0xE0C54190, 0xE3A06003, 0xE0271691, 0xE0E54691,
+        0xE3A08801, 0xE3E09000, 0xE16A0989, 0xE16B01A8, 0xE00C0190, 0xEF000000 });
+
+    machine.run_from(CODE_BASE);
+
+    arm::core *core = machine.core_.get();
+
+    REQUIRE(core->get_reg(2) == 4);
+    REQUIRE(core->get_reg(3) == 2);
+    REQUIRE(core->get_reg(4) == 16);
+    REQUIRE(core->get_reg(5) == 0xFFFFFFFE);
+    REQUIRE(core->get_reg(7) == 16);
+    REQUIRE(core->get_reg(10) == 1);
+    REQUIRE(core->get_reg(11) == 4);
+    REQUIRE(core->get_reg(12) == 4);
+}
+
+TEST_CASE("exclusive_and_media", "interpreter") {
+    test_machine machine;
+
+    // mov r0, #0x20000 / mov r3, #0 / loop: ldrex r1, [r0] / add r1, r1, #1 / strex r2, r1, [r0] / cmp r2, #0
+    // bne loop / add r3, r3, #1 / cmp r3, #10 / bne loop / ldr r4, =0x01FF7F80 / ldr r5, =0x01018080
+    // uadd8 r6, r4, r5 / sel r7, r4, r5 / qadd16 r8, r4, r5 / clz r9, r5 / rev r10, r4 / uxtb r11, r4, ror #8
+    // sxth r12, r4 / svc #0
+    machine.load({ 0xE3A00802, 0xE3A03000, 0xE1901F9F, 0xE2811001, 0xE1802F91, 0xE3520000, 0x1AFFFFFA,
+        0xE2833001, 0xE353000A, 0x1AFFFFF7, 0xE59F4020, 0xE59F5020, 0xE6546F95, 0xE6847FB5, 0xE6248F15,
+        0xE16F9F15, 0xE6BFAF34, 0xE6EFB474, 0xE6BFC074, 0xEF000000, 0x01FF7F80, 0x01018080 });
+
+    machine.run_from(CODE_BASE);
+
+    arm::core *core = machine.core_.get();
+
+    REQUIRE(machine.data_word(DATA_BASE) == 10);
+    REQUIRE(core->get_reg(6) == 0x0200FF00);
+    REQUIRE(((core->get_cpsr() >> 16) & 0xF) == 0b0101);
+    REQUIRE(core->get_reg(7) == 0x01FF8080);
+    REQUIRE(core->get_reg(8) == 0x03000000);
+    REQUIRE(core->get_reg(9) == 7);
+    REQUIRE(core->get_reg(10) == 0x807FFF01);
+    REQUIRE(core->get_reg(11) == 0x7F);
+    REQUIRE(core->get_reg(12) == 0x7F80);
+}
+
+TEST_CASE("vfp_arithmetic_and_transfers", "interpreter") {
+    test_machine machine;
+
+    // mov r0, #7 / vmov s0, r0 / vcvt.f64.s32 d1, s0 / vmul.f64 d2, d1, d1 / vcvt.s32.f64 s6, d2 / vmov r1, s6
+    // vmov.f32 s8, #1.5 / vadd.f32 s9, s8, s8 / vcvt.s32.f32 s10, s9 / vmov r2, s10 / vcmp.f32 s8, s9
+    // vmrs APSR_nzcv, fpscr / movlt r3, #1 / movge r3, #2 / vmov d5, r0, r1 / vmov r4, r5, d5 / mov r6, #0x20000
+    // vstmia r6!, {d1-d2} / vldmdb r6!, {s20-s23} / vmov r7, r8, d11 / vldr d6, [r6, #8] / vsqrt.f64 d7, d6
+    // vcvt.u32.f64 s16, d7 / vmov r9, s16 / svc #0
+    machine.load({ 0xE3A00007, 0xEE000A10, 0xEEB81BC0, 0xEE212B01, 0xEEBD3BC2, 0xEE131A10, 0xEEB74A08,
+        0xEE744A04, 0xEEBD5AE4, 0xEE152A10, 0xEEB44A64, 0xEEF1FA10, 0xB3A03001, 0xA3A03002, 0xEC410B15,
+        0xEC554B15, 0xE3A06802, 0xECA61B04, 0xED36AA04, 0xEC587B1B, 0xED966B02, 0xEEB17BC6, 0xEEBC8BC7,
+        0xEE189A10, 0xEF000000 });
+
+    machine.run_from(CODE_BASE);
+
+    arm::core *core = machine.core_.get();
+
+    REQUIRE(machine.exceptions_.empty());
+    REQUIRE(core->get_reg(1) == 49);
+    REQUIRE(core->get_reg(2) == 3);
+    REQUIRE(core->get_reg(3) == 1);
+    REQUIRE(core->get_reg(4) == 7);
+    REQUIRE(core->get_reg(5) == 49);
+    REQUIRE(core->get_reg(6) == DATA_BASE);
+    REQUIRE(core->get_reg(7) == 0);
+    REQUIRE(core->get_reg(8) == 0x40488000);
+    REQUIRE(core->get_reg(9) == 7);
+}
+
+TEST_CASE("single_step", "interpreter") {
+    test_machine machine;
+    machine.load({ 0xE3A00000, 0xE3A01064, 0xE0800001, 0xE2511001, 0x1AFFFFFC, 0xEF000000 });
+
+    arm::core *core = machine.core_.get();
+    core->set_pc(CODE_BASE);
+
+    for (int i = 0; i < 3; i++) {
+        core->step();
+        REQUIRE(core->get_num_instruction_executed() == 1);
+    }
+
+    REQUIRE(core->get_pc() == CODE_BASE + 12);
+    REQUIRE(core->get_reg(0) == 100);
+    REQUIRE(core->get_reg(1) == 100);
+
+    // Taken branch
+    core->step();
+    core->step();
+
+    REQUIRE(core->get_pc() == CODE_BASE + 8);
+    REQUIRE(core->get_reg(1) == 99);
+}
+
+TEST_CASE("imb_range_retranslates", "interpreter") {
+    test_machine machine;
+
+    // mov r0, #1 / svc #0
+    machine.load({ 0xE3A00001, 0xEF000000 });
+    machine.run_from(CODE_BASE);
+
+    REQUIRE(machine.core_->get_reg(0) == 1);
+
+    // mov r0, #2
+    machine.load({ 0xE3A00002 });
+    machine.core_->imb_range(CODE_BASE, 4);
+    machine.run_from(CODE_BASE);
+
+    REQUIRE(machine.core_->get_reg(0) == 2);
+}
+
+TEST_CASE("memory_fault_reports_address", "interpreter") {
+    test_machine machine;
+
+    // mov r0, #0x40000000 / ldr r1, [r0] / svc #0
+    machine.load({ 0xE3A00101, 0xE5901000, 0xEF000000 });
+    machine.run_from(CODE_BASE);
+
+    REQUIRE(machine.exceptions_.size() == 1);
+    REQUIRE(machine.exceptions_[0].first == arm::exception_type_access_violation_read);
+    REQUIRE(machine.exceptions_[0].second == 0x40000000);
+    REQUIRE(machine.core_->get_pc() == CODE_BASE + 4);
+    REQUIRE(machine.last_svc_ == 0xFFFFFFFF);
+}
+
+TEST_CASE("hot_block_threshold", "interpreter") {
+    test_machine machine;
+    machine.load({ 0xE3A00000, 0xE3A01064, 0xE0800001, 0xE2511001, 0x1AFFFFFC, 0xEF000000 });
+
+    auto interpreter = static_cast<arm::r12l1::interpreter_core *>(machine.core_.get());
+    interpreter->set_hot_block_threshold(10);
+
+    machine.run_from(CODE_BASE);
+
+    // The first iteration runs in the entry block, then the loop block is entered 10 times
+    REQUIRE(interpreter->exited_on_hot_block());
+    REQUIRE(interpreter->get_pc() == CODE_BASE + 8);
+    REQUIRE(interpreter->get_reg(1) == 89);
+}
+
+TEST_CASE("parallel_add_sub_semantics", "interpreter") {
+    std::uint8_t ge = 0;
+
+    REQUIRE(arm::r12l1::parallel_add_sub(arm::r12l1::parallel_signed_halving, arm::r12l1::parallel_add16,
+        0xFFFF0003, 0xFFFF0004, ge) == 0xFFFF0003);
+    REQUIRE(arm::r12l1::parallel_add_sub(arm::r12l1::parallel_unsigned_saturating, arm::r12l1::parallel_sub8,
+        0x10203040, 0x20103040, ge) == 0x00100000);
+
+    // GE of the signed forms comes from the sign of each result
+    arm::r12l1::parallel_add_sub(arm::r12l1::parallel_signed, arm::r12l1::parallel_asx, 0x00010001, 0x00020002, ge);
+    REQUIRE(ge == 0b1100);
+}
+
+TEST_CASE("tiered_matches_interpreter", "interpreter") {
+    // mov r0, #0 / mov r1, #100 / mov r6, #0x20000 / vmov s0, r0 / vcvt.f64.s32 d4, s0
+    // loop: add r0, r0, r1 / vmov s2, r1 / vcvt.f64.s32 d2, s2 / vadd.f64 d4, d4, d2 / str r0, [r6], #4
+    // eor r2, r2, r0, ror #3 / subs r1, r1, #1 / bne loop
+    // vcvt.s32.f64 s6, d4 / vmov r3, s6 / vcmp.f64 d4, d2 / vmrs APSR_nzcv, fpscr / movgt r5, #1 / adds r4, r2, r0 / svc #0
+    const std::vector<std::uint32_t> program = { 0xE3A00000, 0xE3A01064, 0xE3A06802, 0xEE000A10, 0xEEB84BC0,
+        0xE0800001, 0xEE011A10, 0xEEB82BC1, 0xEE344B02, 0xE4860004, 0xE02221E0, 0xE2511001, 0x1AFFFFF7,
+        0xEEBD3BC4, 0xEE133A10, 0xEEB44B42, 0xEEF1FA10, 0xC3A05001, 0xE0924000, 0xEF000000 };
+
+    test_machine reference;
+    test_machine tiered(arm_emulator_type::tiered);
+
+    REQUIRE(tiered.core_);
+
+    reference.load(program);
+    tiered.load(program);
+
+    reference.run_from(CODE_BASE);
+    tiered.run_from(CODE_BASE);
+
+    // The loop runs more times than the hot block threshold, so the JIT finishes the program
+    REQUIRE(100 > arm::tiered_core::HOT_BLOCK_THRESHOLD);
+    REQUIRE(static_cast<arm::tiered_core *>(tiered.core_.get())->is_jit_active());
+
+    REQUIRE(reference.last_svc_ == 0);
+    REQUIRE(tiered.last_svc_ == 0);
+    REQUIRE(tiered.exceptions_.empty());
+
+    REQUIRE(reference.core_->get_reg(0) == 5050);
+    REQUIRE(reference.core_->get_reg(3) == 5050);
+    REQUIRE(reference.core_->get_reg(5) == 1);
+
+    arm::core::thread_context expected;
+    arm::core::thread_context actual;
+
+    reference.core_->save_context(expected);
+    tiered.core_->save_context(actual);
+
+    for (std::size_t i = 0; i < 13; i++) {
+        INFO("r" << i);
+        REQUIRE(actual.cpu_registers[i] == expected.cpu_registers[i]);
+    }
+
+    REQUIRE(actual.sp == expected.sp);
+    REQUIRE(actual.lr == expected.lr);
+    REQUIRE(actual.pc == expected.pc);
+    REQUIRE(actual.cpsr == expected.cpsr);
+
+    for (std::size_t i = 0; i < expected.fpu_registers.size(); i++) {
+        INFO("fpu word " << i);
+        REQUIRE(actual.fpu_registers[i] == expected.fpu_registers[i]);
+    }
+
+    REQUIRE(actual.fpscr == expected.fpscr);
+
+    // Both stored the running sum of every iteration
+    for (std::uint32_t i = 0; i < 100; i++) {
+        REQUIRE(tiered.data_word(DATA_BASE + i * 4) == reference.data_word(DATA_BASE + i * 4));
+    }
+}
+
+// A loop with loads, stores and a conditional instruction, running until the instruction budget ends.
+static const std::vector<std::uint32_t> BENCHMARK_LOOP = { 0xE3A00000, 0xE3A01802, 0xE5912000, 0xE0822000, 0xE0223180,
+    0xE5813004, 0xE2800001, 0xE31000FF, 0x02822001, 0xE5812000, 0xEAFFFFF6 };
+
+static void benchmark_backend(const arm_emulator_type type, const char *name) {
+    test_machine machine(type);
+
+    if (!machine.core_) {
+        return;
+    }
+
+    machine.load(BENCHMARK_LOOP);
+
+    // Straight line code that only runs once, the cost of translating it dominates
+    std::vector<std::uint32_t> straight_line(4096, 0xE2800001);
+    straight_line.push_back(0xEF000000);
+
+    BENCHMARK(std::string(name) + ": 1M instructions of a hot loop") {
+        machine.run_from(CODE_BASE, 1000000);
+        return machine.core_->get_num_instruction_executed();
+    };
+
+    BENCHMARK(std::string(name) + ": 4096 instructions run once") {
+        machine.load(straight_line, CODE_BASE + 0x1000);
+        machine.core_->clear_instruction_cache();
+        machine.run_from(CODE_BASE + 0x1000, 1000000);
+
+        return machine.core_->get_num_instruction_executed();
+    };
+}
+
+TEST_CASE("interpreter_instruction_rate", "[.][benchmark]") {
+    benchmark_backend(arm_emulator_type::interpreter, "Interpreter");
+    benchmark_backend(arm_emulator_type::dynarmic, "Dynarmic");
+    benchmark_backend(arm_emulator_type::tiered, "Tiered");
+}
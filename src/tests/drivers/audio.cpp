@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <drivers/audio/mixer.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using namespace eka2l1;
+
+static drivers::data_callback constant_source(const std::int16_t value, const std::uint8_t channels) {
+    return [=](std::int16_t *buffer, const std::size_t frames) {
+        std::fill(buffer, buffer + frames * channels, value);
+        return frames;
+    };
+}
+
+TEST_CASE("mixer_volume_and_mono_to_stereo", "audio_mixer") {
+    drivers::audio_mixer mixer(48000);
+
+    auto stream = mixer.new_stream(48000, 1, constant_source(1000, 1));
+    REQUIRE(stream);
+
+    stream->set_volume(0.5f);
+    stream->start();
+
+    std::vector<std::int16_t> output(256 * 2);
+    REQUIRE(mixer.mix(output.data(), 256) == 256);
+
+    REQUIRE(std::all_of(output.begin(), output.end(), [](const std::int16_t s) { return s == 500; }));
+}
+
+TEST_CASE("mixer_sums_and_saturates", "audio_mixer") {
+    drivers::audio_mixer mixer(44100);
+
+    auto first = mixer.new_stream(44100, 2, constant_source(30000, 2));
+    auto second = mixer.new_stream(44100, 2, constant_source(10000, 2));
+    auto third = mixer.new_stream(44100, 2, constant_source(-20000, 2));
+
+    first->start();
+    second->start();
+
+    std::vector<std::int16_t> output(128 * 2);
+    mixer.mix(output.data(), 128);
+
+    REQUIRE(std::all_of(output.begin(), output.end(), [](const std::int16_t s) { return s == 32767; }));
+
+    // Stopped streams are not mixed in, started ones are
+    first->stop();
+    third->start();
+
+    mixer.mix(output.data(), 128);
+
+    REQUIRE(std::all_of(output.begin(), output.end(), [](const std::int16_t s) { return s == -10000; }));
+
+    const auto stats = mixer.get_statistics();
+    REQUIRE(stats.stream_count_ == 3);
+    REQUIRE(stats.playing_stream_count_ == 2);
+    REQUIRE(stats.callback_count_ == 2);
+    REQUIRE(stats.underrun_count_ == 0);
+}
+
+TEST_CASE("mixer_resample_consumes_source_at_its_rate", "audio_mixer") {
+    drivers::audio_mixer mixer(48000);
+
+    std::size_t pulled = 0;
+
+    auto stream = mixer.new_stream(22050, 1, [&](std::int16_t *buffer, const std::size_t frames) {
+        std::fill(buffer, buffer + frames, static_cast<std::int16_t>(-1234));
+        pulled += frames;
+
+        return frames;
+    });
+
+    stream->start();
+
+    std::vector<std::int16_t> output(480 * 2);
+
+    // One second of audio, in odd sized chunks
+    for (int i = 0; i < 100; i++) {
+        mixer.mix(output.data(), 480);
+    }
+
+    // The first frame is interpolated from silence, after that the signal must stay constant
+    REQUIRE(std::all_of(output.begin(), output.end(), [](const std::int16_t s) { return s == -1234; }));
+
+    // Never more than one frame ahead of the read position
+    REQUIRE(pulled >= 22050);
+    REQUIRE(pulled <= 22052);
+}
+
+TEST_CASE("mixer_downsample_ramp", "audio_mixer") {
+    drivers::audio_mixer mixer(8000);
+
+    std::int16_t next_value = 0;
+
+    // A ramp at 16kHz becomes a ramp with twice the slope at 8kHz
+    auto stream = mixer.new_stream(16000, 2, [&](std::int16_t *buffer, const std::size_t frames) {
+        for (std::size_t i = 0; i < frames; i++) {
+            buffer[i * 2] = next_value;
+            buffer[i * 2 + 1] = -next_value;
+            next_value++;
+        }
+
+        return frames;
+    });
+
+    stream->start();
+
+    std::vector<std::int16_t> output(100 * 2);
+    mixer.mix(output.data(), 100);
+    mixer.mix(output.data(), 100);
+
+    // Position 0 of the source buffer is the carried frame, so the output lags one source frame
+    for (std::size_t i = 0; i < 100; i++) {
+        REQUIRE(output[i * 2] == static_cast<std::int16_t>(199 + i * 2));
+        REQUIRE(output[i * 2 + 1] == static_cast<std::int16_t>(-(199 + static_cast<int>(i) * 2)));
+    }
+}
+
+TEST_CASE("mixer_counts_underrun_and_drains", "audio_mixer") {
+    drivers::audio_mixer mixer(48000);
+
+    std::size_t left = 300;
+
+    auto stream = mixer.new_stream(48000, 2, [&](std::int16_t *buffer, const std::size_t frames) {
+        const std::size_t to_give = std::min(frames, left);
+
+        std::fill(buffer, buffer + to_give * 2, static_cast<std::int16_t>(100));
+        left -= to_give;
+
+        return to_give;
+    });
+
+    stream->start();
+
+    std::vector<std::int16_t> output(256 * 2);
+
+    mixer.mix(output.data(), 256);
+    REQUIRE(stream->is_playing());
+
+    mixer.mix(output.data(), 256);
+    REQUIRE(!stream->is_playing());
+
+    // What the stream had is played, the rest is silence
+    REQUIRE(output[0] == 100);
+    REQUIRE(output[44 * 2 - 1] == 100);
+    REQUIRE(output[44 * 2] == 0);
+    REQUIRE(output.back() == 0);
+
+    const auto stats = mixer.get_statistics();
+    REQUIRE(stats.underrun_count_ == 1);
+    REQUIRE(stats.callback_count_ == 2);
+}
+
+TEST_CASE("mixer_stream_detaches_on_destroy", "audio_mixer") {
+    drivers::audio_mixer mixer(48000);
+
+    {
+        auto stream = mixer.new_stream(32000, 1, constant_source(1, 1));
+        REQUIRE(mixer.get_statistics().stream_count_ == 1);
+    }
+
+    REQUIRE(mixer.get_statistics().stream_count_ == 0);
+    REQUIRE(!mixer.new_stream(48000, 6, constant_source(0, 6)));
+}
+
+TEST_CASE("mixer_throughput", "[.][benchmark]") {
+    drivers::audio_mixer mixer(48000);
+
+    std::vector<std::unique_ptr<drivers::audio_output_stream>> streams;
+
+    // Music plus a few effects, at the rates games usually use
+    streams.push_back(mixer.new_stream(44100, 2, constant_source(1000, 2)));
+    streams.push_back(mixer.new_stream(22050, 1, constant_source(2000, 1)));
+    streams.push_back(mixer.new_stream(16000, 1, constant_source(3000, 1)));
+    streams.push_back(mixer.new_stream(48000, 2, constant_source(4000, 2)));
+
+    for (auto &stream : streams) {
+        stream->start();
+    }
+
+    std::vector<std::int16_t> output(512 * 2);
+
+    BENCHMARK("Mix 512 frames of 4 streams") {
+        return mixer.mix(output.data(), 512);
+    };
+}
@@ -0,0 +1,465 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <drivers/command_arena.h>
+#include <drivers/driver.h>
+#include <drivers/graphics/backend/software/graphics_software.h>
+#include <drivers/graphics/graphics.h>
+#include <drivers/itc.h>
+
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace eka2l1;
+
+TEST_CASE("payload_ring_release_out_of_order", "command_arena") {
+    drivers::payload_ring ring(256);
+
+    std::uint64_t first = 0;
+    std::uint64_t second = 0;
+    std::uint64_t third = 0;
+
+    REQUIRE(ring.allocate(100, first));
+    REQUIRE(ring.allocate(100, second));
+
+    // 112 + 112 used, only 32 left
+    REQUIRE(ring.allocate(100, third) == nullptr);
+
+    // Second one is done first, but it is stuck behind the first
+    ring.release(second);
+    REQUIRE(ring.used() == 224);
+
+    ring.release(first);
+    REQUIRE(ring.used() == 0);
+}
+
+TEST_CASE("payload_ring_wrap_around", "command_arena") {
+    drivers::payload_ring ring(256);
+
+    std::uint64_t first = 0;
+    std::uint64_t second = 0;
+    std::uint64_t third = 0;
+
+    std::uint8_t *first_data = ring.allocate(96, first);
+    REQUIRE(first_data);
+    REQUIRE(ring.allocate(96, second));
+
+    ring.release(first);
+
+    // Does not fit at the end, must go back to the beginning
+    REQUIRE(ring.allocate(80, third) == first_data);
+    REQUIRE(ring.used() == 96 + 64 + 80);
+
+    ring.release(second);
+    ring.release(third);
+
+    REQUIRE(ring.used() == 0);
+}
+
+TEST_CASE("command_list_payload_placement", "command_arena") {
+    drivers::command_list_pool pool;
+    drivers::command_list list = pool.acquire();
+
+    std::vector<std::uint8_t> small(64, 0xAB);
+    std::vector<std::uint8_t> large(drivers::command_list::SMALL_PAYLOAD_SIZE * 2, 0xCD);
+
+    const std::uint8_t *small_copy = reinterpret_cast<std::uint8_t *>(list.copy_payload(small.data(), small.size()));
+    const std::uint8_t *large_copy = reinterpret_cast<std::uint8_t *>(list.copy_payload(large.data(), large.size()));
+
+    REQUIRE(std::memcmp(small_copy, small.data(), small.size()) == 0);
+    REQUIRE(std::memcmp(large_copy, large.data(), large.size()) == 0);
+
+    // Only the large one lives in the ring
+    REQUIRE(pool.get_payload_ring().used() == large.size());
+
+    pool.recycle(list);
+    REQUIRE(pool.get_payload_ring().used() == 0);
+    REQUIRE(list.empty());
+
+    // Storage gets reused
+    drivers::command_list reused = pool.acquire();
+    REQUIRE(reused.arena_.capacity() == drivers::command_arena::DEFAULT_CHUNK_SIZE);
+}
+
+static constexpr std::size_t SYNTHETIC_FRAME_COMMAND_COUNT = 5000;
+
+static void record_synthetic_frame(drivers::graphics_command_list_builder &builder, const std::vector<char> &small_bitmap,
+    const std::vector<char> &large_bitmap) {
+    eka2l1::rect dest_rect{ { 0, 0 }, { 32, 32 } };
+    eka2l1::rect source_rect{ { 0, 0 }, { 32, 32 } };
+
+    builder.bind_bitmap(1);
+
+    for (std::size_t i = 1; i < SYNTHETIC_FRAME_COMMAND_COUNT; i++) {
+        if (i % 1000 == 0) {
+            builder.update_bitmap(2, large_bitmap.data(), large_bitmap.size(), { 0, 0 }, { 128, 128 });
+            continue;
+        }
+
+        if (i % 50 == 0) {
+            builder.update_bitmap(3, small_bitmap.data(), small_bitmap.size(), { 0, 0 }, { 8, 8 });
+            continue;
+        }
+
+        switch (i % 3) {
+        case 0:
+            builder.set_brush_color({ 255, 0, static_cast<int>(i & 0xFF) });
+            break;
+
+        case 1:
+            builder.draw_rectangle(dest_rect);
+            break;
+
+        default:
+            builder.draw_bitmap(4, 0, dest_rect, source_rect);
+            break;
+        }
+    }
+}
+
+static std::uint64_t replay_synthetic_frame(drivers::command_list &list) {
+    std::uint64_t checksum = 0;
+
+    for (drivers::command &cmd : list.commands_) {
+        drivers::command_helper helper(&cmd);
+        drivers::handle h = 0;
+
+        switch (cmd.opcode_) {
+        case drivers::graphics_driver_update_bitmap: {
+            std::uint8_t *data = nullptr;
+            std::size_t size = 0;
+
+            helper.pop(h);
+            helper.pop(data);
+            helper.pop(size);
+
+            checksum += data[size - 1];
+            break;
+        }
+
+        case drivers::graphics_driver_draw_rectangle: {
+            eka2l1::rect rect;
+            helper.pop(rect);
+
+            checksum += rect.size.x;
+            break;
+        }
+
+        default:
+            helper.pop(h);
+            checksum += h;
+
+            break;
+        }
+    }
+
+    return checksum;
+}
+
+TEST_CASE("command_list_record_replay", "command_arena") {
+    drivers::command_list_pool pool;
+    drivers::server_graphics_command_list list(pool.acquire());
+    drivers::server_graphics_command_list_builder builder(&list);
+
+    std::vector<char> small_bitmap(8 * 8 * 4, 1);
+    std::vector<char> large_bitmap(128 * 128 * 4, 2);
+
+    record_synthetic_frame(builder, small_bitmap, large_bitmap);
+
+    REQUIRE(list.list_.commands_.size() == SYNTHETIC_FRAME_COMMAND_COUNT);
+    REQUIRE(pool.get_payload_ring().used() == large_bitmap.size() * 4);
+
+    // Payloads are copies: changing the source after recording must not matter
+    std::fill(large_bitmap.begin(), large_bitmap.end(), 0);
+
+    const std::uint64_t checksum = replay_synthetic_frame(list.list_);
+    REQUIRE(checksum > 0);
+
+    pool.recycle(list.list_);
+    REQUIRE(pool.get_payload_ring().used() == 0);
+}
+
+TEST_CASE("command_list_5k_frame", "[.][benchmark]") {
+    drivers::command_list_pool pool;
+
+    std::vector<char> small_bitmap(8 * 8 * 4, 1);
+    std::vector<char> large_bitmap(128 * 128 * 4, 2);
+
+    BENCHMARK("Record and replay 5k commands") {
+        drivers::server_graphics_command_list list(pool.acquire());
+        drivers::server_graphics_command_list_builder builder(&list);
+
+        record_synthetic_frame(builder, small_bitmap, large_bitmap);
+
+        const std::uint64_t checksum = replay_synthetic_frame(list.list_);
+        pool.recycle(list.list_);
+
+        return checksum;
+    };
+}
+
+// Runs the software driver on its own thread, the same way frontends do
+struct software_driver_runner {
+    std::unique_ptr<drivers::graphics_driver> driver;
+    std::thread driver_thread;
+
+    explicit software_driver_runner()
+        : driver(drivers::create_graphics_driver(drivers::graphic_api::software))
+        , driver_thread([this]() { driver->run(); }) {
+    }
+
+    ~software_driver_runner() {
+        driver->abort();
+        driver_thread.join();
+    }
+
+    drivers::software_graphics_driver *software() {
+        return static_cast<drivers::software_graphics_driver *>(driver.get());
+    }
+
+    void execute(std::function<void(drivers::graphics_command_list_builder &)> record) {
+        std::unique_ptr<drivers::graphics_command_list> list = driver->new_command_list();
+        std::unique_ptr<drivers::graphics_command_list_builder> builder = driver->new_command_builder(list.get());
+
+        record(*builder);
+
+        int status = -100;
+        builder->present(&status);
+
+        driver->submit_command_list(*list);
+        driver->wait_for(&status);
+    }
+
+    std::uint32_t pixel_at(const drivers::handle h, const int x, const int y) {
+        std::vector<std::uint32_t> pixels;
+        eka2l1::vec2 size;
+
+        REQUIRE(software()->read_bitmap(h, pixels, size));
+        return pixels[y * size.x + x];
+    }
+};
+
+// Pixels read back are RGBA8, red in the lowest byte
+static constexpr std::uint32_t rgba(const std::uint32_t r, const std::uint32_t g, const std::uint32_t b, const std::uint32_t a) {
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+TEST_CASE("software_driver_update_and_draw_bitmap", "graphics_software") {
+    software_driver_runner runner;
+
+    const drivers::handle source = drivers::create_bitmap(runner.driver.get(), { 4, 4 }, 32);
+    const drivers::handle target = drivers::create_bitmap(runner.driver.get(), { 8, 8 }, 32);
+
+    REQUIRE(source);
+    REQUIRE(target);
+
+    // 32bpp bitmaps are uploaded as BGRA
+    std::vector<std::uint8_t> data(4 * 4 * 4);
+
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+            std::uint8_t *pixel = &data[(y * 4 + x) * 4];
+
+            pixel[0] = static_cast<std::uint8_t>(x * 10);
+            pixel[1] = static_cast<std::uint8_t>(y * 10);
+            pixel[2] = 100;
+            pixel[3] = 255;
+        }
+    }
+
+    runner.execute([&](drivers::graphics_command_list_builder &builder) {
+        builder.update_bitmap(source, reinterpret_cast<const char *>(data.data()), data.size(), { 0, 0 }, { 4, 4 });
+
+        builder.bind_bitmap(target);
+
+        // Components go alpha first
+        builder.clear({ 255, 0, 0, 200 }, drivers::draw_buffer_bit_color_buffer);
+        builder.draw_bitmap(source, 0, eka2l1::rect({ 2, 2 }, { 4, 4 }), eka2l1::rect({ 0, 0 }, { 0, 0 }));
+        builder.bind_bitmap(0);
+    });
+
+    REQUIRE(runner.pixel_at(source, 3, 1) == rgba(100, 10, 30, 255));
+
+    REQUIRE(runner.pixel_at(target, 2, 2) == rgba(100, 0, 0, 255));
+    REQUIRE(runner.pixel_at(target, 5, 3) == rgba(100, 10, 30, 255));
+    REQUIRE(runner.pixel_at(target, 5, 5) == rgba(100, 30, 30, 255));
+
+    REQUIRE(runner.pixel_at(target, 1, 1) == rgba(200, 0, 0, 255));
+    REQUIRE(runner.pixel_at(target, 6, 6) == rgba(200, 0, 0, 255));
+}
+
+TEST_CASE("software_driver_blend_and_clip", "graphics_software") {
+    software_driver_runner runner;
+
+    const drivers::handle target = drivers::create_bitmap(runner.driver.get(), { 8, 8 }, 32);
+
+    runner.execute([&](drivers::graphics_command_list_builder &builder) {
+        builder.bind_bitmap(target);
+        builder.clear({ 255, 0, 0, 0 }, drivers::draw_buffer_bit_color_buffer);
+
+        builder.set_blend_mode(true);
+        builder.blend_formula(drivers::blend_equation::add, drivers::blend_equation::add, drivers::blend_factor::frag_out_alpha,
+            drivers::blend_factor::one_minus_frag_out_alpha, drivers::blend_factor::one, drivers::blend_factor::one_minus_frag_out_alpha);
+
+        // Only the left half may be touched
+        eka2l1::rect clip({ 0, 0 }, { 4, 8 });
+
+        builder.set_clipping(true);
+        builder.clip_rect(clip);
+
+        builder.set_brush_color_detail({ 255, 255, 255, 128 });
+        builder.draw_rectangle(eka2l1::rect({ 0, 0 }, { 8, 8 }));
+
+        builder.set_clipping(false);
+        builder.set_blend_mode(false);
+        builder.bind_bitmap(0);
+    });
+
+    REQUIRE(runner.pixel_at(target, 0, 0) == rgba(128, 128, 128, 255));
+    REQUIRE(runner.pixel_at(target, 3, 7) == rgba(128, 128, 128, 255));
+    REQUIRE(runner.pixel_at(target, 4, 0) == rgba(0, 0, 0, 255));
+    REQUIRE(runner.pixel_at(target, 7, 7) == rgba(0, 0, 0, 255));
+}
+
+TEST_CASE("software_driver_stencil", "graphics_software") {
+    software_driver_runner runner;
+
+    const drivers::handle target = drivers::create_bitmap(runner.driver.get(), { 8, 8 }, 32);
+
+    runner.execute([&](drivers::graphics_command_list_builder &builder) {
+        builder.bind_bitmap(target);
+        builder.clear({ 255, 0, 0, 0 }, drivers::draw_buffer_bit_color_buffer | drivers::draw_buffer_bit_stencil_buffer);
+
+        // Mark the top left corner in the stencil buffer
+        builder.set_stencil(true);
+        builder.set_stencil_action(drivers::stencil_face::back_and_front, drivers::stencil_action::keep,
+            drivers::stencil_action::keep, drivers::stencil_action::replace);
+        builder.set_stencil_pass_condition(drivers::stencil_face::back_and_front, drivers::condition_func::always, 1, 0xFF);
+        builder.set_stencil_mask(drivers::stencil_face::back_and_front, 0xFF);
+
+        builder.set_brush_color_detail({ 0, 0, 255, 255 });
+        builder.draw_rectangle(eka2l1::rect({ 0, 0 }, { 4, 4 }));
+
+        // Then only draw where it is marked
+        builder.set_stencil_action(drivers::stencil_face::back_and_front, drivers::stencil_action::keep,
+            drivers::stencil_action::keep, drivers::stencil_action::keep);
+        builder.set_stencil_pass_condition(drivers::stencil_face::back_and_front, drivers::condition_func::equal, 1, 0xFF);
+
+        builder.set_brush_color_detail({ 0, 255, 0, 255 });
+        builder.draw_rectangle(eka2l1::rect({ 2, 2 }, { 6, 6 }));
+
+        builder.set_stencil(false);
+        builder.bind_bitmap(0);
+    });
+
+    REQUIRE(runner.pixel_at(target, 0, 0) == rgba(0, 0, 255, 255));
+    REQUIRE(runner.pixel_at(target, 3, 3) == rgba(0, 255, 0, 255));
+    REQUIRE(runner.pixel_at(target, 2, 5) == rgba(0, 0, 0, 255));
+    REQUIRE(runner.pixel_at(target, 6, 6) == rgba(0, 0, 0, 255));
+}
+
+TEST_CASE("software_driver_backup_state", "graphics_software") {
+    software_driver_runner runner;
+
+    const drivers::handle target = drivers::create_bitmap(runner.driver.get(), { 8, 8 }, 32);
+
+    runner.execute([&](drivers::graphics_command_list_builder &builder) {
+        builder.bind_bitmap(target);
+        builder.clear({ 255, 0, 0, 0 }, drivers::draw_buffer_bit_color_buffer);
+        builder.backup_state();
+
+        builder.set_blend_mode(true);
+        builder.blend_formula(drivers::blend_equation::add, drivers::blend_equation::add, drivers::blend_factor::frag_out_alpha,
+            drivers::blend_factor::one_minus_frag_out_alpha, drivers::blend_factor::one, drivers::blend_factor::one_minus_frag_out_alpha);
+
+        eka2l1::rect clip({ 0, 0 }, { 4, 8 });
+
+        builder.set_clipping(true);
+        builder.clip_rect(clip);
+
+        builder.set_brush_color_detail({ 255, 255, 255, 128 });
+        builder.draw_rectangle(eka2l1::rect({ 0, 0 }, { 8, 8 }));
+
+        // Back to no clipping and no blending
+        builder.load_backup_state();
+
+        builder.set_brush_color_detail({ 0, 0, 255, 128 });
+        builder.draw_rectangle(eka2l1::rect({ 4, 0 }, { 4, 8 }));
+        builder.bind_bitmap(0);
+    });
+
+    REQUIRE(runner.pixel_at(target, 0, 0) == rgba(128, 128, 128, 255));
+    REQUIRE(runner.pixel_at(target, 4, 0) == rgba(0, 0, 255, 128));
+    REQUIRE(runner.pixel_at(target, 7, 7) == rgba(0, 0, 255, 128));
+}
+
+TEST_CASE("software_driver_present_to_memory", "graphics_software") {
+    software_driver_runner runner;
+
+    const drivers::handle screen = drivers::create_bitmap(runner.driver.get(), { 4, 2 }, 32);
+
+    // Top row red, bottom row blue, in BGRA
+    std::vector<std::uint8_t> data = {
+        0, 0, 255, 255, 0, 0, 255, 255, 0, 0, 255, 255, 0, 0, 255, 255,
+        255, 0, 0, 255, 255, 0, 0, 255, 255, 0, 0, 255, 255, 0, 0, 255
+    };
+
+    runner.execute([&](drivers::graphics_command_list_builder &builder) {
+        builder.update_bitmap(screen, reinterpret_cast<const char *>(data.data()), data.size(), { 0, 0 }, { 4, 2 });
+
+        builder.bind_bitmap(0);
+        builder.set_swapchain_size({ 4, 2 });
+        builder.draw_bitmap(screen, 0, eka2l1::rect({ 0, 0 }, { 4, 2 }), eka2l1::rect({ 0, 0 }, { 4, 2 }), eka2l1::vec2(0, 0),
+            0.0f, drivers::bitmap_draw_flag_no_flip);
+    });
+
+    std::vector<std::uint32_t> frame;
+    eka2l1::vec2 size;
+
+    REQUIRE(runner.software()->read_presented_frame(frame, size) == 1);
+    REQUIRE(size == eka2l1::vec2(4, 2));
+
+    // Presented frames are upright, like the window would show them
+    REQUIRE(frame[0] == rgba(255, 0, 0, 255));
+    REQUIRE(frame[3] == rgba(255, 0, 0, 255));
+    REQUIRE(frame[4] == rgba(0, 0, 255, 255));
+    REQUIRE(frame[7] == rgba(0, 0, 255, 255));
+}
+
+TEST_CASE("software_driver_fill_rate", "[.][benchmark]") {
+    software_driver_runner runner;
+
+    const drivers::handle source = drivers::create_bitmap(runner.driver.get(), { 240, 320 }, 32);
+    const drivers::handle target = drivers::create_bitmap(runner.driver.get(), { 240, 320 }, 32);
+
+    BENCHMARK("Blend a 240x320 bitmap over another") {
+        runner.execute([&](drivers::graphics_command_list_builder &builder) {
+            builder.bind_bitmap(target);
+            builder.set_blend_mode(true);
+            builder.blend_formula(drivers::blend_equation::add, drivers::blend_equation::add, drivers::blend_factor::frag_out_alpha,
+                drivers::blend_factor::one_minus_frag_out_alpha, drivers::blend_factor::one, drivers::blend_factor::one_minus_frag_out_alpha);
+            builder.draw_bitmap(source, 0, eka2l1::rect({ 0, 0 }, { 240, 320 }), eka2l1::rect({ 0, 0 }, { 0, 0 }));
+            builder.set_blend_mode(false);
+            builder.bind_bitmap(0);
+        });
+    };
+}
@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <common/buffer.h>
+#include <kernel/btrace.h>
+#include <kernel/ipc.h>
+#include <kernel/object_lookup.h>
+#include <kernel/smp/balancer.h>
+#include <kernel/svc_table.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace eka2l1;
+
+// Kernel objects are normally made by the kernel system, which we do not want to spin up here.
+class test_object : public kernel::kernel_obj {
+public:
+    explicit test_object(const std::string &name, const kernel::uid id, const kernel::object_type type,
+        kernel::kernel_obj *owner = nullptr)
+        : kernel::kernel_obj(nullptr, owner) {
+        obj_name = name;
+        uid = id;
+        obj_type = type;
+        access = kernel::access_type::local_access;
+    }
+
+    void set_name_silently(const std::string &new_name) {
+        obj_name = new_name;
+    }
+};
+
+TEST_CASE("object_id_table_lookup", "kernel_lookup") {
+    kernel::object_id_table table;
+
+    test_object first("First", 5, kernel::object_type::sema);
+    test_object second("Second", 5000, kernel::object_type::mutex);
+
+    table.add(&first);
+    table.add(&second);
+
+    REQUIRE(table.get(5) == &first);
+    REQUIRE(table.get(5000) == &second);
+    REQUIRE(table.get(6) == nullptr);
+    REQUIRE(table.get(1ULL << 40) == nullptr);
+
+    table.remove(&second);
+    REQUIRE(table.get(5000) == nullptr);
+    REQUIRE(table.get(5) == &first);
+}
+
+TEST_CASE("object_name_index_full_name", "kernel_lookup") {
+    kernel::object_name_index index;
+
+    test_object pr("Proc", 1, kernel::object_type::process);
+    test_object sema("Sema", 3, kernel::object_type::sema, &pr);
+    test_object sema_dup("Sema", 2, kernel::object_type::sema, &pr);
+    test_object server("Server", 4, kernel::object_type::server);
+
+    index.add(&pr);
+    index.add(&sema);
+    index.add(&sema_dup);
+    index.add(&server);
+
+    REQUIRE(index.find("Proc::Sema", kernel::object_type::sema) == &sema_dup);
+    REQUIRE(index.find("Server", kernel::object_type::server) == &server);
+    REQUIRE(index.find("Server", kernel::object_type::sema) == nullptr);
+    REQUIRE(index.find("Sema", kernel::object_type::sema) == nullptr);
+
+    index.remove(&sema_dup);
+    REQUIRE(index.find("Proc::Sema", kernel::object_type::sema) == &sema);
+
+    server.set_name_silently("Server2");
+    index.reindex(&server);
+
+    REQUIRE(index.find("Server", kernel::object_type::server) == nullptr);
+    REQUIRE(index.find("Server2", kernel::object_type::server) == &server);
+}
+
+TEST_CASE("object_name_index_detect_stale", "kernel_lookup") {
+    kernel::object_name_index index;
+
+    test_object pr("Proc", 1, kernel::object_type::process);
+    test_object mut("Mutex", 2, kernel::object_type::mutex, &pr);
+
+    index.add(&pr);
+    index.add(&mut);
+
+    // The owner changes name without the index knowing
+    pr.set_name_silently("Proc2");
+
+    REQUIRE(index.find("Proc::Mutex", kernel::object_type::mutex) == nullptr);
+    REQUIRE(index.stale(kernel::object_type::mutex));
+
+    index.clear(kernel::object_type::mutex);
+    index.add(&mut);
+
+    REQUIRE_FALSE(index.stale(kernel::object_type::mutex));
+    REQUIRE(index.find("Proc2::Mutex", kernel::object_type::mutex) == &mut);
+}
+
+TEST_CASE("object_name_index_name_changed", "kernel_lookup") {
+    kernel::object_name_index index;
+
+    test_object pr("Proc", 1, kernel::object_type::process);
+    test_object thr("Thread", 2, kernel::object_type::thread, &pr);
+
+    // Not indexed yet, as while being constructed
+    REQUIRE_FALSE(index.name_changed(&pr));
+
+    index.add(&pr);
+    index.add(&thr);
+
+    REQUIRE_FALSE(index.name_changed(&pr));
+    REQUIRE_FALSE(index.name_changed(&thr));
+
+    pr.set_name_silently("Proc2");
+
+    REQUIRE(index.name_changed(&pr));
+    REQUIRE(index.name_changed(&thr));
+
+    // Searching the new name misses without noticing anything
+    REQUIRE(index.find("Proc2::Thread", kernel::object_type::thread) == nullptr);
+    REQUIRE_FALSE(index.stale(kernel::object_type::thread));
+
+    // Reindexing the owner brings the objects it owns along
+    index.reindex(&pr);
+
+    REQUIRE(index.find("Proc2", kernel::object_type::process) == &pr);
+    REQUIRE(index.find("Proc2::Thread", kernel::object_type::thread) == &thr);
+    REQUIRE(index.find("Proc::Thread", kernel::object_type::thread) == nullptr);
+    REQUIRE_FALSE(index.name_changed(&thr));
+}
+
+TEST_CASE("ipc_msg_pool_reuse_generation", "ipc_msg_pool") {
+    ipc_msg_pool pool;
+
+    ipc_msg_ptr msg = pool.allocate(nullptr);
+    REQUIRE(msg);
+    REQUIRE(msg->id != 0);
+
+    const std::uint32_t old_handle = msg->id;
+    REQUIRE(pool.get(old_handle) == msg);
+
+    pool.free(msg);
+    pool.free(msg);
+
+    REQUIRE(pool.free_count() == ipc_msg_pool::MAX_MESSAGES);
+
+    // The slot is reused, but the old handle must not reach the new message
+    ipc_msg_ptr new_msg = pool.allocate(nullptr);
+    REQUIRE(new_msg == msg);
+    REQUIRE(new_msg->id != old_handle);
+    REQUIRE(pool.get(old_handle) == nullptr);
+    REQUIRE(pool.get(new_msg->id) == new_msg);
+    REQUIRE(pool.get(0) == nullptr);
+
+    new_msg->lock_free();
+    pool.free(new_msg);
+
+    REQUIRE_FALSE(new_msg->free);
+}
+
+TEST_CASE("ipc_msg_pool_exhaust", "ipc_msg_pool") {
+    ipc_msg_pool pool;
+
+    for (std::uint32_t i = 0; i < ipc_msg_pool::MAX_MESSAGES; i++) {
+        REQUIRE(pool.allocate(nullptr));
+    }
+
+    REQUIRE(pool.allocate(nullptr) == nullptr);
+}
+
+TEST_CASE("ipc_msg_pool_complete_more_than_capacity", "ipc_msg_pool") {
+    ipc_msg_pool pool;
+
+    // Receive and complete as a LLE server does, well past the pool size
+    for (std::uint32_t i = 0; i < ipc_msg_pool::MAX_MESSAGES * 2 + 1; i++) {
+        ipc_msg_ptr msg = pool.allocate(nullptr);
+        REQUIRE(msg);
+
+        pool.free(msg);
+    }
+
+    REQUIRE(pool.free_count() == ipc_msg_pool::MAX_MESSAGES);
+}
+
+static void test_svc_stub(kernel_system *kern, kernel::process *pr, arm::core *cpu) {
+}
+
+TEST_CASE("svc_table_banks", "svc_table") {
+    hle::svc_table table;
+
+    table.add(0x4D, hle::epoc_import_func{ test_svc_stub, "SlowCall" });
+    table.add(0x800015, hle::epoc_import_func{ test_svc_stub, "FastCall" });
+
+    REQUIRE(table.get(0x4D)->name == "SlowCall");
+    REQUIRE(table.get(0x800015)->name == "FastCall");
+    REQUIRE(table.get(0x4C) == nullptr);
+    REQUIRE(table.get(0x15) == nullptr);
+    REQUIRE(table.get(0x800016) == nullptr);
+    REQUIRE(table.get(0xC10000) == nullptr);
+    REQUIRE(table.get(0xFFFFFFFF) == nullptr);
+
+    table.record(0x800015, 100);
+    table.record(0x800015, 300);
+    table.record(0x800015, 1ULL << 40);
+
+    std::uint32_t visited = 0;
+
+    table.for_each([&](const std::uint32_t num, const hle::epoc_import_func &func, const hle::svc_stat &stat) {
+        if (num == 0x800015) {
+            REQUIRE(stat.calls_ == 3);
+            REQUIRE(stat.histogram_[0] == 1);
+            REQUIRE(stat.histogram_[1] == 1);
+            REQUIRE(stat.histogram_[hle::SVC_HISTOGRAM_BUCKET_COUNT - 1] == 1);
+        } else {
+            REQUIRE(stat.calls_ == 0);
+        }
+
+        visited++;
+    });
+
+    REQUIRE(visited == 2);
+}
+
+TEST_CASE("smp_load_unit", "smp") {
+    REQUIRE(kernel::smp::calculate_load_unit(0, 1000) == 0);
+    REQUIRE(kernel::smp::calculate_load_unit(1000, 1000) == 4095);
+    REQUIRE(kernel::smp::calculate_load_unit(500, 1000) == 2048);
+
+    // Tiny activity must not round down to nothing
+    REQUIRE(kernel::smp::calculate_load_unit(1, 4000) == 1);
+
+    // Large periods are shifted down before calculation
+    REQUIRE(kernel::smp::calculate_load_unit(1ULL << 40, 1ULL << 41) == 2048);
+}
+
+TEST_CASE("smp_balancer_pick_least_loaded", "smp") {
+    kernel::smp::load_balancer balancer(3, 100);
+
+    // New threads spread across idle cores
+    REQUIRE(balancer.pick_core() == 0);
+    REQUIRE(balancer.pick_core() == 1);
+    REQUIRE(balancer.pick_core() == 2);
+
+    balancer.add_run_ticks(0, 100);
+    balancer.add_run_ticks(1, 10);
+    balancer.add_run_ticks(2, 50);
+
+    // Not a full period yet, nothing is measured
+    balancer.balance(50);
+    REQUIRE(balancer.get_load(0) == 0);
+
+    balancer.balance(100);
+    REQUIRE(balancer.get_load(0) == 4095);
+    REQUIRE(balancer.get_load(1) == 410);
+    REQUIRE(balancer.get_load(2) == 2048);
+
+    REQUIRE(balancer.pick_core() == 1);
+}
+
+TEST_CASE("kernel_lookup_10k_objects", "[.][benchmark]") {
+    static constexpr std::size_t TOTAL_OBJECTS = 10000;
+
+    kernel::object_id_table table;
+    kernel::object_name_index index;
+
+    std::vector<std::unique_ptr<test_object>> objects;
+
+    for (std::size_t i = 0; i < TOTAL_OBJECTS; i++) {
+        objects.push_back(std::make_unique<test_object>("Server" + std::to_string(i), i + 1,
+            kernel::object_type::server));
+
+        table.add(objects.back().get());
+        index.add(objects.back().get());
+    }
+
+    const std::string last_name = "Server" + std::to_string(TOTAL_OBJECTS - 1);
+
+    BENCHMARK("Linear scan by full name (previous behaviour)") {
+        for (auto &obj : objects) {
+            std::string the_full_name;
+            obj->full_name(the_full_name);
+
+            if (the_full_name == last_name) {
+                return obj.get();
+            }
+        }
+
+        return static_cast<test_object *>(nullptr);
+    };
+
+    BENCHMARK("Name index lookup") {
+        return index.find(last_name, kernel::object_type::server);
+    };
+
+    BENCHMARK("ID table lookup") {
+        return table.get(TOTAL_OBJECTS);
+    };
+}
+
+TEST_CASE("btrace_file_read_back", "kernel_btrace") {
+    kernel::btrace_file_header header{ kernel::BTRACE_FILE_MAGIC, kernel::BTRACE_FILE_VERSION,
+        sizeof(kernel::btrace_frame), 0 };
+
+    // Size 12, category 3, subcategory 1
+    const kernel::btrace_frame frames[2] = { { 0x0103000C, 1, 2, 3 }, { 0x0203000C, 4, 5, 6 } };
+
+    std::vector<std::uint8_t> file(sizeof(header) + sizeof(frames));
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + sizeof(header), frames, sizeof(frames));
+
+    common::ro_buf_stream stream(file.data(), file.size());
+    std::vector<kernel::btrace_frame> read_frames;
+
+    REQUIRE(kernel::read_btrace_file(&stream, read_frames));
+    REQUIRE(read_frames.size() == 2);
+    REQUIRE(read_frames[1].a2_ == 5);
+    REQUIRE(read_frames[1].header_field(kernel::btrace_header_category_index) == 3);
+    REQUIRE(read_frames[1].header_field(kernel::btrace_header_subcategory_index) == 2);
+
+    REQUIRE(kernel::format_btrace_frame(read_frames[0]) == "Trace out (data size = 12, flags = 0, category = 3, subcategory = 1):\n"
+                                                           "\ta1 = 0x1\n"
+                                                           "\ta2 = 0x2\n"
+                                                           "\ta3 = 0x3\n");
+
+    // Wrong magic
+    file[0] = 0;
+    common::ro_buf_stream bad_stream(file.data(), file.size());
+
+    REQUIRE(!kernel::read_btrace_file(&bad_stream, read_frames));
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ *
+ * This file is part of EKA2L1 project.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <config/config.h>
+#include <cpu/arm_interface.h>
+#include <mem/allocator/std_page_allocator.h>
+#include <mem/chunk.h>
+#include <mem/control.h>
+#include <mem/mmu.h>
+#include <mem/process.h>
+
+#include <map>
+#include <vector>
+
+using namespace eka2l1;
+
+// Core that only records its page table. Like the dynarmic backend, it keeps old mappings around.
+class page_table_core : public arm::core {
+public:
+    std::map<arm::address, std::uint8_t *> pages_;
+
+    void map_backing_mem(arm::address vaddr, size_t size, uint8_t *ptr, prot protection) override {
+        for (std::size_t i = 0; i < size; i += 0x1000) {
+            pages_[static_cast<arm::address>(vaddr + i)] = ptr + i;
+        }
+    }
+
+    void unmap_memory(arm::address addr, size_t size) override {
+        for (std::size_t i = 0; i < size; i += 0x1000) {
+            pages_.erase(static_cast<arm::address>(addr + i));
+        }
+    }
+
+    bool should_clear_old_memory_map() const override {
+        return false;
+    }
+
+    void run(const std::uint32_t instruction_count) override {}
+    void stop() override {}
+    void step() override {}
+    uint32_t get_reg(size_t idx) override { return 0; }
+    uint32_t get_sp() override { return 0; }
+    uint32_t get_pc() override { return 0; }
+    uint32_t get_vfp(size_t idx) override { return 0; }
+    void set_reg(size_t idx, uint32_t val) override {}
+    void set_cpsr(uint32_t val) override {}
+    void set_pc(uint32_t val) override {}
+    void set_lr(uint32_t val) override {}
+    void set_sp(uint32_t val) override {}
+    void set_vfp(size_t idx, uint32_t val) override {}
+    uint32_t get_lr() override { return 0; }
+    void set_entry_point(arm::address ep) override {}
+    arm::address get_entry_point() override { return 0; }
+    uint32_t get_cpsr() override { return 0; }
+    void save_context(thread_context &ctx) override {}
+    void load_context(const thread_context &ctx) override {}
+    void set_stack_top(arm::address addr) override {}
+    arm::address get_stack_top() override { return 0; }
+    void prepare_rescheduling() override {}
+    bool is_thumb_mode() override { return false; }
+    void page_table_changed() override {}
+    void clear_instruction_cache() override {}
+    void imb_range(arm::address addr, std::size_t size) override {}
+    void set_asid(std::uint8_t num) override {}
+    std::uint8_t get_asid() const override { return 0; }
+    std::uint8_t get_max_asid_available() const override { return 0; }
+    std::uint32_t get_num_instruction_executed() override { return 0; }
+};
+
+TEST_CASE("mem_process_switch_drops_private_chunks", "mem") {
+    config::state conf;
+    mem::basic_page_table_allocator alloc;
+    mem::control_impl control = mem::make_new_control(nullptr, &alloc, &conf, 12, false, mem::mem_model_type::flexible);
+
+    page_table_core core;
+    mem::mmu_base *mmu = control->get_or_create_mmu(&core);
+
+    mem::mem_model_process_impl process_a = mem::make_new_mem_model_process(control.get(), mem::mem_model_type::flexible);
+    mem::mem_model_process_impl process_b = mem::make_new_mem_model_process(control.get(), mem::mem_model_type::flexible);
+
+    mem::mem_model_chunk_creation_info create_info;
+    create_info.size = 0x10000;
+    create_info.perm = prot::read_write;
+
+    create_info.flags = mem::MEM_MODEL_CHUNK_REGION_USER_LOCAL | mem::MEM_MODEL_CHUNK_TYPE_NORMAL;
+    mem::mem_model_chunk *private_chunk = nullptr;
+    REQUIRE(process_a->create_chunk(private_chunk, create_info) == 0);
+    REQUIRE(private_chunk->adjust(0, 0x2000));
+
+    create_info.flags = mem::MEM_MODEL_CHUNK_REGION_USER_GLOBAL | mem::MEM_MODEL_CHUNK_TYPE_NORMAL;
+    mem::mem_model_chunk *shared_chunk = nullptr;
+    REQUIRE(process_a->create_chunk(shared_chunk, create_info) == 0);
+    REQUIRE(shared_chunk->adjust(0, 0x1000));
+    REQUIRE(process_b->attach_chunk(shared_chunk));
+
+    mmu->set_current_addr_space(process_a->address_space_id());
+    process_a->remap_to_cpu(mmu);
+
+    const mem::vm_address private_base = private_chunk->base(process_a.get());
+    const mem::vm_address shared_base = shared_chunk->base(process_b.get());
+
+    REQUIRE(core.pages_.count(private_base));
+    REQUIRE(core.pages_.count(private_base + 0x1000));
+    REQUIRE(core.pages_.count(shared_base));
+
+    process_a->unmap_from_cpu(mmu);
+    mmu->set_current_addr_space(process_b->address_space_id());
+    process_b->remap_to_cpu(mmu);
+
+    // The old pages must not be reachable from the new process
+    REQUIRE(!core.pages_.count(private_base));
+    REQUIRE(!core.pages_.count(private_base + 0x1000));
+    REQUIRE(core.pages_.count(shared_base));
+
+    // Switching back brings the private chunk in again
+    process_b->unmap_from_cpu(mmu);
+    mmu->set_current_addr_space(process_a->address_space_id());
+    process_a->remap_to_cpu(mmu);
+
+    REQUIRE(core.pages_.count(private_base));
+    REQUIRE(core.pages_.count(shared_base));
+
+    process_b->detach_chunk(shared_chunk);
+    process_a->delete_chunk(shared_chunk);
+    process_a->delete_chunk(private_chunk);
+}
+
+TEST_CASE("mem_demand_paged_chunk_fills_on_first_access", "mem") {
+    config::state conf;
+    mem::basic_page_table_allocator alloc;
+    mem::control_impl control = mem::make_new_control(nullptr, &alloc, &conf, 12, false, mem::mem_model_type::flexible);
+
+    page_table_core core;
+    mem::mmu_base *mmu = control->get_or_create_mmu(&core);
+
+    mem::mem_model_process_impl process = mem::make_new_mem_model_process(control.get(), mem::mem_model_type::flexible);
+
+    mem::mem_model_chunk_creation_info create_info;
+    create_info.size = 0x3000;
+    create_info.perm = prot::read_write_exec;
+    create_info.flags = mem::MEM_MODEL_CHUNK_REGION_USER_CODE | mem::MEM_MODEL_CHUNK_TYPE_NORMAL;
+
+    mem::mem_model_chunk *code_chunk = nullptr;
+    REQUIRE(process->create_chunk(code_chunk, create_info) == 0);
+    REQUIRE(code_chunk->adjust(0, 0x3000));
+
+    mmu->set_current_addr_space(process->address_space_id());
+    process->remap_to_cpu(mmu);
+
+    const mem::vm_address code_base = code_chunk->base(process.get());
+    REQUIRE(core.pages_.count(code_base));
+
+    std::vector<std::size_t> filled;
+
+    REQUIRE(code_chunk->enable_demand_paging(process.get(), [&](const std::size_t offset, const std::size_t size, std::uint8_t *data) {
+        for (std::size_t i = 0; i < size; i += 4) {
+            *reinterpret_cast<std::uint32_t *>(data + i) = static_cast<std::uint32_t>(offset + i) | 0xC0DE0000;
+        }
+
+        filled.push_back(offset);
+    }));
+
+    // Nothing is filled nor mapped until touched, even after a remap
+    process->unmap_from_cpu(mmu);
+    process->remap_to_cpu(mmu);
+
+    REQUIRE(filled.empty());
+    REQUIRE(!core.pages_.count(code_base));
+    REQUIRE(!core.pages_.count(code_base + 0x1000));
+
+    // The CPU slow path fills the page and maps it back
+    std::uint32_t value = 0;
+    REQUIRE(core.read_32bit(code_base + 0x1008, &value));
+    REQUIRE(value == (0xC0DE0000 | 0x1008));
+    REQUIRE(filled == std::vector<std::size_t>{ 0x1000 });
+    REQUIRE(core.pages_.count(code_base + 0x1000));
+    REQUIRE(!core.pages_.count(code_base));
+
+    // Host pointers of the owning process fill the page too, but leave the CPU mapping alone
+    std::uint32_t *host_ptr = reinterpret_cast<std::uint32_t *>(process->get_pointer(code_base + 0x2004));
+    REQUIRE(host_ptr);
+    REQUIRE(*host_ptr == (0xC0DE0000 | 0x2004));
+    REQUIRE(!core.pages_.count(code_base + 0x2000));
+
+    // Another address space doesn't see this chunk, so it must not fill it
+    REQUIRE(!control->get_host_pointer(0, code_base));
+    REQUIRE(filled.size() == 2);
+
+    code_chunk->page_in_all();
+    REQUIRE(filled.size() == 3);
+    REQUIRE(*reinterpret_cast<std::uint32_t *>(code_chunk->host_base()) == 0xC0DE0000);
+
+    process->delete_chunk(code_chunk);
+}
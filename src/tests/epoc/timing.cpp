@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project.
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+#include <kernel/timing.h>
+
+#include <cstdint>
+#include <random>
+
+using namespace eka2l1;
+
+static event make_test_event(const std::uint64_t time, const int type, const std::uint64_t userdata) {
+    event evt;
+    evt.event_time = time;
+    evt.event_type = type;
+    evt.event_user_data = userdata;
+
+    return evt;
+}
+
+TEST_CASE("event_queue_fire_order", "event_queue") {
+    event_queue queue;
+
+    queue.push(make_test_event(50, 0, 1));
+    queue.push(make_test_event(10, 0, 2));
+    queue.push(make_test_event(30, 1, 3));
+    queue.push(make_test_event(10, 1, 4));
+    queue.push(make_test_event(20, 0, 5));
+
+    const std::uint64_t expected_userdata[] = { 2, 4, 5, 3, 1 };
+
+    for (const std::uint64_t userdata : expected_userdata) {
+        REQUIRE(!queue.empty());
+        REQUIRE(queue.top().event_user_data == userdata);
+        queue.pop();
+    }
+
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("event_queue_cancel", "event_queue") {
+    event_queue queue;
+
+    for (std::uint64_t i = 0; i < 64; i++) {
+        queue.push(make_test_event(1000 - i * 10, 2, i));
+    }
+
+    REQUIRE(queue.remove(2, 63));
+    REQUIRE(queue.remove(2, 10));
+    REQUIRE_FALSE(queue.remove(2, 10));
+    REQUIRE_FALSE(queue.remove(3, 0));
+    REQUIRE(queue.size() == 62);
+
+    std::uint64_t last_time = 0;
+
+    while (!queue.empty()) {
+        const event &evt = queue.top();
+
+        REQUIRE(evt.event_user_data != 63);
+        REQUIRE(evt.event_user_data != 10);
+        REQUIRE(evt.event_time >= last_time);
+
+        last_time = evt.event_time;
+        queue.pop();
+    }
+}
+
+TEST_CASE("event_queue_cancel_duplicate_key", "event_queue") {
+    event_queue queue;
+
+    queue.push(make_test_event(40, 0, 7));
+    queue.push(make_test_event(20, 0, 7));
+    queue.push(make_test_event(30, 0, 8));
+
+    REQUIRE(queue.remove(0, 7));
+    REQUIRE(queue.remove(0, 7));
+    REQUIRE_FALSE(queue.remove(0, 7));
+
+    REQUIRE(queue.size() == 1);
+    REQUIRE(queue.top().event_user_data == 8);
+}
+
+TEST_CASE("event_queue_schedule_cancel_100k", "[.][benchmark]") {
+    static constexpr std::uint64_t EVENT_COUNT = 100000;
+
+    std::mt19937_64 rng(0xE4A2);
+    std::vector<std::uint64_t> times(EVENT_COUNT);
+
+    for (auto &time : times) {
+        time = rng() % 10000000;
+    }
+
+    BENCHMARK("schedule and cancel 100k events") {
+        event_queue queue;
+
+        for (std::uint64_t i = 0; i < EVENT_COUNT; i++) {
+            queue.push(make_test_event(times[i], static_cast<int>(i & 7), i));
+        }
+
+        for (std::uint64_t i = 0; i < EVENT_COUNT; i++) {
+            queue.remove(static_cast<int>(i & 7), i);
+        }
+
+        return queue.size();
+    };
+
+    BENCHMARK("schedule and fire 100k events") {
+        event_queue queue;
+
+        for (std::uint64_t i = 0; i < EVENT_COUNT; i++) {
+            queue.push(make_test_event(times[i], static_cast<int>(i & 7), i));
+        }
+
+        std::uint64_t fired = 0;
+
+        while (!queue.empty()) {
+            fired += queue.top().event_user_data;
+            queue.pop();
+        }
+
+        return fired;
+    };
+}
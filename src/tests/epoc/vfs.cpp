@@ -1,9 +1,16 @@
 #include <catch2/catch.hpp>
 #include <common/algorithm.h>
+#include <common/fileutils.h>
 #include <common/path.h>
 #include <common/types.h>
 #include <vfs/vfs.h>
 
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+
 struct io_scope_guard {
     eka2l1::io_system *io;
 
@@ -37,3 +44,158 @@ TEST_CASE("get_physical", "vfs") {
 
     REQUIRE(eka2l1::common::compare_ignore_case(*actual_path_b, std::u16string(u"drive_b") + static_cast<char16_t>(eka2l1::get_separator()) + u"despacito3leak") == 0);
 }
+
+TEST_CASE("read_only_drive_files_are_mapped", "vfs") {
+    eka2l1::io_system io;
+    io_scope_guard guard(io);
+
+    eka2l1::create_directories("drive_mapped_ro");
+    eka2l1::create_directories("drive_mapped_rw");
+
+    const std::string content = "Symbian OS files on a read-only drive can't change while open";
+
+    for (const char *dir : { "drive_mapped_ro", "drive_mapped_rw" }) {
+        std::ofstream out(std::string(dir) + static_cast<char>(eka2l1::get_separator()) + "data.bin", std::ios::binary);
+        out << content;
+    }
+
+    io.mount_physical_path(drive_number::drive_y, drive_media::physical, io_attrib_internal | io_attrib_write_protected,
+        u"drive_mapped_ro");
+    io.mount_physical_path(drive_number::drive_x, drive_media::physical, io_attrib_internal, u"drive_mapped_rw");
+
+    io.reset_statistics();
+
+    {
+        eka2l1::symfile f = io.open_file(u"Y:\\data.bin", READ_MODE | BIN_MODE);
+        REQUIRE(f);
+        REQUIRE(f->size() == content.size());
+
+        std::uint32_t view_size = 0;
+        const std::uint8_t *view = f->read_view(7, view_size);
+
+        REQUIRE(view);
+        REQUIRE(view_size == 7);
+        REQUIRE(std::memcmp(view, content.data(), 7) == 0);
+        REQUIRE(f->tell() == 7);
+
+        // Reading past the end only gives whole elements back, like stdio
+        char buf[128] = {};
+        REQUIRE(f->read_file(buf, 1, 3) == 3);
+        REQUIRE(std::memcmp(buf, content.data() + 7, 3) == 0);
+        REQUIRE(f->valid());
+
+        REQUIRE(f->read_file(buf, static_cast<std::uint32_t>(content.size()), 1) == 0);
+        REQUIRE(!f->valid());
+
+        f->seek(-4, eka2l1::file_seek_mode::end);
+        REQUIRE(f->valid());
+        REQUIRE(f->read_file(buf, 1, 4) == 4);
+        REQUIRE(std::memcmp(buf, content.data() + content.size() - 4, 4) == 0);
+    }
+
+    {
+        // Writable drives keep going through the host file API
+        eka2l1::symfile f = io.open_file(u"X:\\data.bin", READ_MODE | BIN_MODE);
+        REQUIRE(f);
+
+        std::uint32_t view_size = 0;
+        REQUIRE(f->read_view(4, view_size) == nullptr);
+
+        char buf[4] = {};
+        REQUIRE(f->read_file(buf, 1, 4) == 4);
+    }
+
+    const eka2l1::io_statistics stats = io.get_statistics();
+
+    REQUIRE(stats.files_mapped_ == 1);
+    REQUIRE(stats.host_read_calls_ == 1);
+    REQUIRE(stats.memory_read_calls_ == 4);
+    REQUIRE(stats.bytes_read_ == content.size() + 4 + 4);
+
+    io.unmount(drive_number::drive_y);
+    io.unmount(drive_number::drive_x);
+
+    for (const char *dir : { "drive_mapped_ro", "drive_mapped_rw" }) {
+        eka2l1::common::remove(std::string(dir) + static_cast<char>(eka2l1::get_separator()) + "data.bin");
+        eka2l1::common::remove(std::string(dir) + static_cast<char>(eka2l1::get_separator()));
+    }
+}
+
+TEST_CASE("path_cache_negative_lookups", "vfs") {
+    eka2l1::io_system io;
+    io_scope_guard guard(io);
+
+    eka2l1::create_directories("drive_path_cache");
+    io.mount_physical_path(drive_number::drive_w, drive_media::physical, io_attrib_internal, u"drive_path_cache");
+
+    io.reset_statistics();
+
+    // Probing a missing file twice only asks the host once
+    REQUIRE(!io.exist(u"W:\\probe.dll"));
+    REQUIRE(!io.exist(u"W:\\probe.dll"));
+    REQUIRE(!io.open_file(u"W:\\probe.dll", READ_MODE | BIN_MODE));
+
+    eka2l1::io_statistics stats = io.get_statistics();
+
+    REQUIRE(stats.path_cache_misses_ == 1);
+    REQUIRE(stats.path_cache_hits_ == 2);
+
+    // Creating the file through the VFS drops the stale negative entry
+    {
+        eka2l1::symfile f = io.open_file(u"W:\\probe.dll", WRITE_MODE | BIN_MODE);
+        REQUIRE(f);
+        REQUIRE(f->write_file("EKA2", 1, 4) == 4);
+    }
+
+    REQUIRE(io.exist(u"W:\\probe.dll"));
+    REQUIRE(io.delete_entry(u"W:\\probe.dll"));
+    REQUIRE(!io.exist(u"W:\\probe.dll"));
+
+    // Directories are cached as such, and can't be opened as files
+    REQUIRE(io.create_directory(u"W:\\sys\\"));
+    REQUIRE(io.is_directory(u"W:\\sys\\"));
+    REQUIRE(!io.open_file(u"W:\\sys\\", READ_MODE | BIN_MODE));
+
+    io.unmount(drive_number::drive_w);
+
+    eka2l1::common::remove(std::string("drive_path_cache") + static_cast<char>(eka2l1::get_separator()) + "sys" + static_cast<char>(eka2l1::get_separator()));
+    eka2l1::common::remove(std::string("drive_path_cache") + static_cast<char>(eka2l1::get_separator()));
+}
+
+TEST_CASE("path_cache_host_changes_in_subdirectories", "vfs") {
+    eka2l1::io_system io;
+    io_scope_guard guard(io);
+
+    const std::string root = "drive_path_cache_watch";
+    const std::string sub_dir = eka2l1::add_path(root, "sys");
+    const std::string host_file = eka2l1::add_path(sub_dir, "probe.dll");
+
+    eka2l1::create_directories(root);
+    io.mount_physical_path(drive_number::drive_v, drive_media::physical, io_attrib_internal, u"drive_path_cache_watch");
+
+    // The directory is created after the drive is watched, the file in it must still be noticed
+    eka2l1::create_directories(sub_dir);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    REQUIRE(!io.exist(u"V:\\sys\\probe.dll"));
+
+    {
+        std::ofstream probe(host_file, std::ios::binary);
+        probe << "EKA2";
+    }
+
+    bool found = false;
+
+    for (int i = 0; (i < 50) && !found; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        found = io.exist(u"V:\\sys\\probe.dll");
+    }
+
+    REQUIRE(found);
+
+    io.unmount(drive_number::drive_v);
+
+    eka2l1::common::remove(host_file);
+    eka2l1::common::remove(sub_dir + static_cast<char>(eka2l1::get_separator()));
+    eka2l1::common::remove(root + static_cast<char>(eka2l1::get_separator()));
+}
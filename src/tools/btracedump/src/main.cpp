@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020 EKA2L1 Team.
+ * 
+ * This file is part of EKA2L1 project
+ * (see bentokun.github.com/EKA2L1).
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <kernel/btrace.h>
+
+#include <common/buffer.h>
+#include <common/log.h>
+
+#include <array>
+#include <cstdlib>
+#include <iostream>
+
+int main(int argc, char **argv) {
+    eka2l1::log::setup_log(nullptr);
+
+    if (argc <= 1) {
+        LOG_ERROR(eka2l1::SYSTEM, "No file provided!");
+        LOG_INFO(eka2l1::SYSTEM, "Usage: btracedump [filename] [category...].");
+
+        return -1;
+    }
+
+    eka2l1::common::ro_std_file_stream stream(argv[1], true);
+
+    if (!stream.valid()) {
+        LOG_ERROR(eka2l1::SYSTEM, "Unable to open trace file {}!", argv[1]);
+        return -2;
+    }
+
+    std::vector<eka2l1::kernel::btrace_frame> frames;
+
+    if (!eka2l1::kernel::read_btrace_file(&stream, frames)) {
+        LOG_ERROR(eka2l1::SYSTEM, "{} is not a BTrace file, or was written by another version!", argv[1]);
+        return -3;
+    }
+
+    // Print every category when none is given
+    std::array<bool, eka2l1::kernel::BTRACE_CATEGORY_COUNT> wanted;
+    wanted.fill(argc <= 2);
+
+    for (int i = 2; i < argc; i++) {
+        const int category = std::atoi(argv[i]);
+
+        if ((category >= 0) && (category < static_cast<int>(wanted.size()))) {
+            wanted[category] = true;
+        }
+    }
+
+    std::array<std::size_t, eka2l1::kernel::BTRACE_CATEGORY_COUNT> counts{};
+
+    for (const eka2l1::kernel::btrace_frame &frame : frames) {
+        const std::uint8_t category = frame.header_field(eka2l1::kernel::btrace_header_category_index);
+
+        if (!wanted[category]) {
+            continue;
+        }
+
+        counts[category]++;
+        std::cout << eka2l1::kernel::format_btrace_frame(frame) << std::endl;
+    }
+
+    std::cout << "Records per category:" << std::endl;
+
+    for (std::size_t i = 0; i < counts.size(); i++) {
+        if (counts[i] != 0) {
+            std::cout << "\t" << i << ": " << counts[i] << std::endl;
+        }
+    }
+
+    return 0;
+}